@@ -0,0 +1,402 @@
+#include "Harness.hpp"
+#include "Synthetic.hpp"
+
+#include "rebel/assembly/AssemblyHistory.hpp"
+#include "rebel/assembly/AssemblyIndex.hpp"
+#include "rebel/assembly/ClashDetector.hpp"
+#include "rebel/assembly/DistanceQuery.hpp"
+#include "rebel/assembly/MateSolver.hpp"
+#include "rebel/assembly/Part.hpp"
+#include "rebel/brep/Tessellator.hpp"
+#include "rebel/core/TaskScheduler.hpp"
+#include "rebel/io/MeshExport.hpp"
+#include "rebel/io/NativeFile.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <random>
+#include <string>
+
+namespace rebel::bench {
+namespace {
+
+/// Loading a 10k-occurrence assembly of 100 unique parts: part BVHs,
+/// assembly tree and the two-level index. Meshes are decoded up front so
+/// only engine work is timed.
+class AssemblyLoadWorkload final : public Workload {
+public:
+    explicit AssemblyLoadWorkload(double scale)
+        : meshes_(syntheticPartMeshes(std::max<std::size_t>(4, static_cast<std::size_t>(100 * scale)), 0.002, 21)),
+          occurrences_(std::max<std::size_t>(16, static_cast<std::size_t>(10000 * scale))) {}
+
+    std::size_t run() override {
+        std::vector<assembly::PartPtr> parts(meshes_.size());
+        core::parallelFor(0, meshes_.size(), 1, [&](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) {
+                parts[i] = assembly::Part::create("part" + std::to_string(i), meshes_[i]);
+            }
+        });
+        const SyntheticAssembly model = syntheticAssembly(parts, occurrences_, 2.5, 100, 3);
+        assembly::AssemblyIndex index(*model.assembly, *model.library);
+        index.update();
+        return index.occurrenceCount();
+    }
+
+private:
+    std::vector<geometry::Mesh> meshes_;
+    std::size_t occurrences_;
+};
+
+/// The same assembly opened from a native file: mapping, tables, zero-copy
+/// parts and the index. Compare with `assembly.load` for what the format
+/// saves over rebuilding from meshes. Parts are stored with their B-rep and
+/// two coarser levels of detail, which `LoadDetail::Graphics` reads instead.
+class AssemblyOpenWorkload final : public Workload {
+public:
+    AssemblyOpenWorkload(double scale, io::LoadDetail detail)
+        : path_((std::filesystem::temp_directory_path() /
+                 (detail == io::LoadDetail::Full ? "rebelcad-bench-open.rbl" : "rebelcad-bench-graphics.rbl"))
+                    .string()) {
+        options_.detail = detail;
+        brep::TessellationOptions tessellation;
+        tessellation.chordalTolerance = 0.002;
+        const std::vector<brep::Body> bodies =
+            syntheticBodies(std::max<std::size_t>(4, static_cast<std::size_t>(100 * scale)), 21);
+        io::NativeWriter writer;
+        std::vector<assembly::PartPtr> parts;
+        for (const brep::Body& body : bodies) {
+            const brep::Tessellation levels = brep::tessellate(body, tessellation);
+            const std::string name = "part" + std::to_string(parts.size());
+            std::vector<assembly::PartPtr> lods;
+            for (std::size_t l = 1; l < levels.levels.size(); ++l) {
+                lods.push_back(assembly::Part::create(name, levels.levels[l].merged()));
+            }
+            parts.push_back(assembly::Part::create(name, levels.levels[0].merged()));
+            writer.addPart(parts.back(), &body, std::move(lods));
+        }
+        const SyntheticAssembly model =
+            syntheticAssembly(parts, std::max<std::size_t>(16, static_cast<std::size_t>(10000 * scale)), 2.5, 100, 3);
+        writer.setAssembly(*model.assembly, *model.library);
+        writer.write(path_);
+    }
+
+    ~AssemblyOpenWorkload() override {
+        std::error_code ignored;
+        std::filesystem::remove(path_, ignored);
+    }
+
+    std::size_t run() override {
+        const auto doc = io::NativeDocument::open(path_);
+        assembly::PartLibrary library;
+        assembly::Assembly assembly;
+        doc->loadAssembly(assembly, library, options_);
+        assembly::AssemblyIndex index(assembly, library);
+        index.update();
+        return index.occurrenceCount();
+    }
+
+private:
+    std::string path_;
+    io::NativeLoadOptions options_;
+};
+
+/// Exporting a 2k-occurrence assembly of 100 unique parts for review or
+/// printing. STL flattens every occurrence; 3MF and glTF store each part
+/// once, so compare the three for what keeping instances saves.
+class AssemblyExportWorkload final : public Workload {
+public:
+    AssemblyExportWorkload(double scale, io::MeshFormat format)
+        : path_((std::filesystem::temp_directory_path() /
+                 (format == io::MeshFormat::Stl       ? "rebelcad-bench-export.stl"
+                  : format == io::MeshFormat::ThreeMf ? "rebelcad-bench-export.3mf"
+                                                      : "rebelcad-bench-export.glb"))
+                    .string()),
+          format_(format) {
+        for (geometry::Mesh& mesh :
+             syntheticPartMeshes(std::max<std::size_t>(4, static_cast<std::size_t>(100 * scale)), 0.002, 21)) {
+            parts_.push_back(assembly::Part::create("part" + std::to_string(parts_.size()), std::move(mesh)));
+        }
+        model_ =
+            syntheticAssembly(parts_, std::max<std::size_t>(16, static_cast<std::size_t>(2000 * scale)), 2.5, 100, 3);
+    }
+
+    ~AssemblyExportWorkload() override {
+        std::error_code ignored;
+        std::filesystem::remove(path_, ignored);
+    }
+
+    std::size_t run() override {
+        return io::exportMesh(*model_.assembly, *model_.library, path_, format_).occurrences;
+    }
+
+private:
+    std::string path_;
+    io::MeshFormat format_;
+    std::vector<assembly::PartPtr> parts_;
+    SyntheticAssembly model_;
+};
+
+/// Closest-hit rays through an indexed assembly, as for picking and
+/// measurement probes.
+class AssemblyRaycastWorkload final : public Workload {
+public:
+    explicit AssemblyRaycastWorkload(double scale) {
+        for (geometry::Mesh& mesh : syntheticPartMeshes(40, 0.002, 23)) {
+            parts_.push_back(assembly::Part::create("part" + std::to_string(parts_.size()), std::move(mesh)));
+        }
+        model_ = syntheticAssembly(parts_, 10000, 2.5, 100, 5);
+        index_ = std::make_unique<assembly::AssemblyIndex>(*model_.assembly, *model_.library);
+        index_->update();
+
+        const math::Aabb box = index_->bvh().topLevel().nodes()[0].bounds;
+        std::mt19937 rng(9);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        rays_.resize(std::max<std::size_t>(1024, static_cast<std::size_t>(200000 * scale)));
+        for (math::Ray& ray : rays_) {
+            const math::Vec3f e = box.extent();
+            const math::Vec3f target = box.min + math::Vec3f{unit(rng) * e.x, unit(rng) * e.y, unit(rng) * e.z};
+            ray.origin = target - math::Vec3f{0.3f, 0.5f, 1.0f} * (2.0f * math::length(e));
+            ray.direction = math::normalize(target - ray.origin);
+        }
+    }
+
+    std::size_t run() override {
+        std::atomic<std::size_t> hits{0};
+        core::parallelFor(0, rays_.size(), 1024, [&](std::size_t first, std::size_t last) {
+            std::size_t local = 0;
+            for (std::size_t i = first; i < last; ++i) {
+                local += index_->raycast(rays_[i]).hit() ? 1 : 0;
+            }
+            hits.fetch_add(local, std::memory_order_relaxed);
+        });
+        return rays_.size();
+    }
+
+private:
+    std::vector<assembly::PartPtr> parts_;
+    SyntheticAssembly model_;
+    std::unique_ptr<assembly::AssemblyIndex> index_;
+    std::vector<math::Ray> rays_;
+};
+
+/// Clash detection over a densely packed assembly. The full run checks
+/// every pair; the incremental one moves a few occurrences per run, as
+/// when dragging a component, and re-checks only their pairs.
+class AssemblyClashWorkload final : public Workload {
+public:
+    AssemblyClashWorkload(double scale, bool incremental) : incremental_(incremental) {
+        for (geometry::Mesh& mesh : syntheticPartMeshes(40, 0.005, 29)) {
+            parts_.push_back(assembly::Part::create("part" + std::to_string(parts_.size()), std::move(mesh)));
+        }
+        model_ = syntheticAssembly(parts_, std::max<std::size_t>(64, static_cast<std::size_t>(10000 * scale)), 0.9,
+                                   100, 7);
+        index_ = std::make_unique<assembly::AssemblyIndex>(*model_.assembly, *model_.library);
+        index_->update();
+        detector_ = std::make_unique<assembly::ClashDetector>(*index_);
+        detector_->detectAll();
+    }
+
+    std::size_t run() override {
+        if (!incremental_) {
+            detector_->detectAll();
+            return index_->occurrenceCount();
+        }
+        // Nudge a handful of occurrences back and forth so every run does
+        // the same amount of work.
+        const float offset = (step_++ % 2 == 0) ? 0.05f : -0.05f;
+        for (std::size_t k = 0; k < kDragged; ++k) {
+            const assembly::NodeId node = model_.occurrences[(k * 7919) % model_.occurrences.size()];
+            model_.assembly->setLocalTransform(node, math::Mat4f::translation({offset, 0.0f, 0.0f}) *
+                                                         model_.assembly->node(node).local);
+        }
+        detector_->update(index_->update());
+        return kDragged;
+    }
+
+private:
+    static constexpr std::size_t kDragged = 8;
+
+    bool incremental_;
+    std::vector<assembly::PartPtr> parts_;
+    SyntheticAssembly model_;
+    std::unique_ptr<assembly::AssemblyIndex> index_;
+    std::unique_ptr<assembly::ClashDetector> detector_;
+    std::size_t step_ = 0;
+};
+
+/// Clearance check over a loosely packed assembly: every pair of
+/// occurrences closer than a service gap, measured exactly or to a
+/// tolerance, as in a design review.
+class AssemblyClearanceWorkload final : public Workload {
+public:
+    AssemblyClearanceWorkload(double scale, bool approximate) {
+        for (geometry::Mesh& mesh : syntheticPartMeshes(40, 0.005, 31)) {
+            parts_.push_back(assembly::Part::create("part" + std::to_string(parts_.size()), std::move(mesh)));
+        }
+        model_ = syntheticAssembly(parts_, std::max<std::size_t>(64, static_cast<std::size_t>(10000 * scale)), 1.1,
+                                   100, 13);
+        index_ = std::make_unique<assembly::AssemblyIndex>(*model_.assembly, *model_.library);
+        index_->update();
+        assembly::DistanceOptions options;
+        if (approximate) {
+            options.absoluteTolerance = 0.005;
+            options.relativeTolerance = 0.05;
+        }
+        query_ = std::make_unique<assembly::DistanceQuery>(*index_, options);
+    }
+
+    std::size_t run() override {
+        query_->closerThan(0.1);
+        return query_->stats().pairs;
+    }
+
+private:
+    std::vector<assembly::PartPtr> parts_;
+    SyntheticAssembly model_;
+    std::unique_ptr<assembly::AssemblyIndex> index_;
+    std::unique_ptr<assembly::DistanceQuery> query_;
+};
+
+/// Undo steps on a large assembly: each run moves a few occurrences,
+/// commits the step, undoes it and brings the index up to date. With
+/// snapshots sharing the tree this costs the same whatever the assembly's
+/// size, where copying the tree per step would cost its full size.
+class AssemblyUndoWorkload final : public Workload {
+public:
+    explicit AssemblyUndoWorkload(double scale) {
+        for (geometry::Mesh& mesh : syntheticPartMeshes(8, 0.05, 31)) {
+            parts_.push_back(assembly::Part::create("part" + std::to_string(parts_.size()), std::move(mesh)));
+        }
+        model_ = syntheticAssembly(parts_, std::max<std::size_t>(64, static_cast<std::size_t>(200000 * scale)), 2.0,
+                                   100, 13);
+        index_ = std::make_unique<assembly::AssemblyIndex>(*model_.assembly, *model_.library);
+        index_->update();
+        history_ = std::make_unique<assembly::AssemblyHistory>(*model_.assembly);
+    }
+
+    std::size_t run() override {
+        for (std::size_t k = 0; k < kMoved; ++k) {
+            const assembly::NodeId node = model_.occurrences[(step_ * 7919 + k * 104729) % model_.occurrences.size()];
+            model_.assembly->setLocalTransform(node, math::Mat4f::translation({0.5f, 0.0f, 0.0f}) *
+                                                         model_.assembly->node(node).local);
+        }
+        ++step_;
+        history_->commit("move");
+        index_->update();
+        history_->undo();
+        index_->update();
+        return 1;
+    }
+
+private:
+    static constexpr std::size_t kMoved = 8;
+
+    std::vector<assembly::PartPtr> parts_;
+    SyntheticAssembly model_;
+    std::unique_ptr<assembly::AssemblyIndex> index_;
+    std::unique_ptr<assembly::AssemblyHistory> history_;
+    std::size_t step_ = 0;
+};
+
+/// Mate solving over chains of hinged links hanging off a fixed ground,
+/// each chain an independent component. The full solve starts every run
+/// from freshly scrambled placements; the drag turns the last link of one
+/// chain, which re-solves that chain alone from the previous solution.
+class AssemblyMateWorkload final : public Workload {
+public:
+    AssemblyMateWorkload(double scale, bool drag) : drag_(drag) {
+        chains_ = std::max<std::size_t>(4, static_cast<std::size_t>(200 * scale));
+        solver_ = std::make_unique<assembly::MateSolver>(assembly_);
+        for (std::size_t c = 0; c < chains_; ++c) {
+            const auto x = static_cast<float>(3 * c);
+            assembly::NodeId previous = assembly_.addOccurrence(assembly_.root(), 0, math::Mat4f::translation({x, 0, 0}));
+            solver_->setFixed(previous);
+            for (std::size_t i = 0; i < kLinks; ++i) {
+                const assembly::NodeId link = assembly_.addOccurrence(
+                    assembly_.root(), 0, math::Mat4f::translation({x, 0, static_cast<float>(i + 1)}));
+                links_.push_back(link);
+                assembly::Mate axis{assembly::MateType::Concentric, {previous, {0, 0, 0}, {0, 0, 1}},
+                                    {link, {0, 0, 0}, {0, 0, 1}}};
+                assembly::Mate face{assembly::MateType::Planar, {previous, {0, 0, 0.5}, {0, 0, 1}},
+                                    {link, {0, 0, -0.5}, {0, 0, -1}}};
+                solver_->addMate(axis);
+                solver_->addMate(face);
+                previous = link;
+            }
+        }
+        scramble();
+        solver_->solve();
+    }
+
+    std::size_t run() override {
+        if (!drag_) {
+            scramble();
+            solver_->solve();
+            return solver_->mateCount();
+        }
+        const assembly::NodeId last = links_[kLinks - 1];
+        solver_->drag(last, assembly_.worldTransform(last) * math::Mat4f::rotation({0, 0, 1}, 0.05f));
+        return 1;
+    }
+
+private:
+    static constexpr std::size_t kLinks = 20;
+
+    void scramble() {
+        std::mt19937 rng(11);
+        std::uniform_real_distribution<float> jitter(-0.2f, 0.2f);
+        for (const assembly::NodeId link : links_) {
+            assembly_.setLocalTransform(link, assembly_.node(link).local *
+                                                  math::Mat4f::translation({jitter(rng), jitter(rng), jitter(rng)}) *
+                                                  math::Mat4f::rotation({1, 0, 0}, jitter(rng)));
+        }
+    }
+
+    bool drag_;
+    std::size_t chains_ = 0;
+    assembly::Assembly assembly_;
+    std::unique_ptr<assembly::MateSolver> solver_;
+    std::vector<assembly::NodeId> links_;
+};
+
+} // namespace
+
+void registerAssemblyBenchmarks(Registry& registry) {
+    registry.add({"assembly.load", "10k occurrences of 100 parts: part BVHs, tree and index", "occurrences",
+                  [](double scale) { return std::make_unique<AssemblyLoadWorkload>(scale); }});
+    registry.add({"assembly.open_native", "the assembly.load model opened from a mapped native file",
+                  "occurrences",
+                  [](double scale) { return std::make_unique<AssemblyOpenWorkload>(scale, io::LoadDetail::Full); }});
+    registry.add({"assembly.open_graphics", "the assembly.load model opened graphics-only, at stored LOD 0",
+                  "occurrences",
+                  [](double scale) { return std::make_unique<AssemblyOpenWorkload>(scale, io::LoadDetail::Graphics); }});
+    registry.add({"assembly.export_stl", "2k occurrences of 100 parts flattened into binary STL", "occurrences",
+                  [](double scale) { return std::make_unique<AssemblyExportWorkload>(scale, io::MeshFormat::Stl); }});
+    registry.add({"assembly.export_3mf", "the assembly.export_stl model as a 3MF package, parts stored once",
+                  "occurrences", [](double scale) {
+                      return std::make_unique<AssemblyExportWorkload>(scale, io::MeshFormat::ThreeMf);
+                  }});
+    registry.add({"assembly.export_glb", "the assembly.export_stl model as binary glTF, parts stored once",
+                  "occurrences",
+                  [](double scale) { return std::make_unique<AssemblyExportWorkload>(scale, io::MeshFormat::Gltf); }});
+    registry.add({"assembly.clash", "all-pairs clash detection over 10k densely packed occurrences", "occurrences",
+                  [](double scale) { return std::make_unique<AssemblyClashWorkload>(scale, false); }});
+    registry.add({"assembly.clash_drag", "incremental clash re-check after moving 8 of the assembly.clash occurrences",
+                  "moved occurrences",
+                  [](double scale) { return std::make_unique<AssemblyClashWorkload>(scale, true); }});
+    registry.add({"assembly.clearance", "pairs closer than 0.1 among 10k occurrences, exact distances", "pairs",
+                  [](double scale) { return std::make_unique<AssemblyClearanceWorkload>(scale, false); }});
+    registry.add({"assembly.clearance_approx", "assembly.clearance to within 0.005 + 5% of each distance", "pairs",
+                  [](double scale) { return std::make_unique<AssemblyClearanceWorkload>(scale, true); }});
+    registry.add({"assembly.mate_solve", "mate solve of 200 scrambled 20-link hinge chains", "mates",
+                  [](double scale) { return std::make_unique<AssemblyMateWorkload>(scale, false); }});
+    registry.add({"assembly.mate_drag", "dragging the end of one assembly.mate_solve chain", "drags",
+                  [](double scale) { return std::make_unique<AssemblyMateWorkload>(scale, true); }});
+    registry.add({"assembly.undo", "commit and undo of 8 moved occurrences in a 200k-occurrence assembly", "steps",
+                  [](double scale) { return std::make_unique<AssemblyUndoWorkload>(scale); }});
+    registry.add({"assembly.raycast", "200k closest-hit rays into a 10k-occurrence assembly", "rays",
+                  [](double scale) { return std::make_unique<AssemblyRaycastWorkload>(scale); }});
+}
+
+} // namespace rebel::bench
@@ -0,0 +1,80 @@
+#include "Harness.hpp"
+#include "Synthetic.hpp"
+
+#include "rebel/boolean/MeshBoolean.hpp"
+#include "rebel/brep/Body.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace rebel::bench {
+namespace {
+
+/// Appends a disjoint closed mesh to `into`.
+void append(geometry::Mesh& into, const geometry::Mesh& mesh) {
+    const auto base = static_cast<geometry::VertexIndex>(into.vertexCount());
+    for (std::size_t i = 0; i < mesh.vertexCount(); ++i) {
+        into.addVertex(mesh.position(static_cast<geometry::VertexIndex>(i)));
+    }
+    for (std::size_t t = 0; t < mesh.triangleCount(); ++t) {
+        const auto c = static_cast<geometry::CornerIndex>(3 * t);
+        into.addTriangle(base + mesh.vertex(c), base + mesh.vertex(c + 1), base + mesh.vertex(c + 2));
+    }
+}
+
+/// A plate drilled by a square grid of pins running through it, as one
+/// difference; every pin wall cuts the plate's top and bottom faces.
+class DrillWorkload final : public Workload {
+public:
+    explicit DrillWorkload(double scale) {
+        const auto side = std::max<std::size_t>(2, static_cast<std::size_t>(std::lround(16 * std::sqrt(scale))));
+        const double size = static_cast<double>(side);
+        plate_ = bodyMesh(brep::makeBox({0.0, 0.0, 0.0}, {size, size, 0.5}), 0.01);
+        for (std::size_t i = 0; i < side; ++i) {
+            for (std::size_t j = 0; j < side; ++j) {
+                const math::Vec3d base{static_cast<double>(i) + 0.5, static_cast<double>(j) + 0.5, -0.25};
+                append(pins_, bodyMesh(brep::makeCylinder(base, 0.3, 1.0), 0.0005));
+            }
+        }
+    }
+
+    std::size_t run() override {
+        boolean::meshBoolean(plate_.view(), pins_.view(), boolean::BooleanOp::Difference);
+        return pins_.triangleCount();
+    }
+
+private:
+    geometry::Mesh plate_;
+    geometry::Mesh pins_;
+};
+
+/// Union of two finely tessellated curved solids whose surfaces cross along
+/// long intersection curves.
+class BlendWorkload final : public Workload {
+public:
+    explicit BlendWorkload(double scale) {
+        const double tolerance = 0.0001 / std::max(scale, 0.01);
+        a_ = bodyMesh(brep::makeSphere({0.0, 0.0, 0.0}, 1.0), tolerance);
+        b_ = bodyMesh(brep::makeTorus({0.3, 0.2, 0.1}, 1.0, 0.35), tolerance);
+    }
+
+    std::size_t run() override {
+        boolean::meshBoolean(a_.view(), b_.view(), boolean::BooleanOp::Union);
+        return a_.triangleCount() + b_.triangleCount();
+    }
+
+private:
+    geometry::Mesh a_;
+    geometry::Mesh b_;
+};
+
+} // namespace
+
+void registerBooleanBenchmarks(Registry& registry) {
+    registry.add({"boolean.drill", "subtract a 16x16 grid of pins (~160k triangles) from a plate", "triangles",
+                  [](double scale) { return std::make_unique<DrillWorkload>(scale); }});
+    registry.add({"boolean.blend", "union of a fine sphere and torus (~330k triangles)", "triangles",
+                  [](double scale) { return std::make_unique<BlendWorkload>(scale); }});
+}
+
+} // namespace rebel::bench
@@ -0,0 +1,199 @@
+#include "Harness.hpp"
+
+#include "rebel/brep/Body.hpp"
+#include "rebel/brep/Tessellator.hpp"
+#include "rebel/feature/FeatureGraph.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+namespace rebel::bench {
+namespace {
+
+/// Circle sketch: solves to its radius.
+class SketchOp final : public feature::FeatureOp {
+public:
+    std::string_view type() const override { return "bench.sketch"; }
+    feature::ResultPtr evaluate(const feature::Parameters& p, const std::vector<feature::ResultPtr>&) const override {
+        return std::make_shared<feature::ValueResult>(std::vector<double>{p.number("radius")});
+    }
+};
+
+/// Extrudes the sketched circle into a tessellated cylinder.
+class ExtrudeOp final : public feature::FeatureOp {
+public:
+    std::string_view type() const override { return "bench.extrude"; }
+    feature::ResultPtr evaluate(const feature::Parameters& p,
+                                const std::vector<feature::ResultPtr>& inputs) const override {
+        const double radius = static_cast<const feature::ValueResult&>(*inputs.at(0)).values().at(0);
+        brep::TessellationOptions options;
+        options.chordalTolerance = 0.0002;
+        const brep::Body body = brep::makeCylinder({0.0, 0.0, 0.0}, radius, p.number("height"));
+        return std::make_shared<feature::MeshResult>(brep::tessellateLevel(body, options, 0).merged());
+    }
+};
+
+/// Volume of a closed mesh.
+class MeasureOp final : public feature::FeatureOp {
+public:
+    std::string_view type() const override { return "bench.measure"; }
+    feature::ResultPtr evaluate(const feature::Parameters&,
+                                const std::vector<feature::ResultPtr>& inputs) const override {
+        const geometry::Mesh& mesh = static_cast<const feature::MeshResult&>(*inputs.at(0)).mesh();
+        double volume = 0.0;
+        for (std::size_t t = 0; t < mesh.triangleCount(); ++t) {
+            const auto c = static_cast<geometry::CornerIndex>(3 * t);
+            const math::Vec3d a(mesh.position(mesh.vertex(c)));
+            const math::Vec3d b(mesh.position(mesh.vertex(c + 1)));
+            const math::Vec3d d(mesh.position(mesh.vertex(c + 2)));
+            volume += math::dot(a, math::cross(b, d)) / 6.0;
+        }
+        return std::make_shared<feature::ValueResult>(std::vector<double>{volume});
+    }
+};
+
+class SumOp final : public feature::FeatureOp {
+public:
+    std::string_view type() const override { return "bench.sum"; }
+    feature::ResultPtr evaluate(const feature::Parameters&,
+                                const std::vector<feature::ResultPtr>& inputs) const override {
+        double sum = 0.0;
+        for (const feature::ResultPtr& r : inputs) {
+            sum += static_cast<const feature::ValueResult&>(*r).values().at(0);
+        }
+        return std::make_shared<feature::ValueResult>(std::vector<double>{sum});
+    }
+};
+
+/// N independent sketch -> extrude -> measure chains feeding one total.
+class FeatureModel {
+public:
+    explicit FeatureModel(double scale, std::shared_ptr<feature::ResultCache> cache = nullptr) {
+        graph.setCache(std::move(cache));
+        const auto chains = std::max<std::size_t>(4, static_cast<std::size_t>(256 * scale));
+        const auto sketch = std::make_shared<SketchOp>();
+        const auto extrude = std::make_shared<ExtrudeOp>();
+        const auto measure = std::make_shared<MeasureOp>();
+        std::vector<feature::FeatureId> measures;
+        for (std::size_t i = 0; i < chains; ++i) {
+            feature::Parameters sp;
+            sp.set("radius", 0.5 + 0.001 * static_cast<double>(i));
+            const feature::FeatureId s = graph.add("sketch" + std::to_string(i), sketch, sp);
+            feature::Parameters ep;
+            ep.set("height", 2.0);
+            const feature::FeatureId e = graph.add("extrude" + std::to_string(i), extrude, ep, {s});
+            measures.push_back(graph.add("measure" + std::to_string(i), measure, {}, {e}));
+            sketches.push_back(s);
+        }
+        graph.add("total", std::make_shared<SumOp>(), {}, measures);
+        graph.regenerate();
+    }
+
+    feature::FeatureGraph graph;
+    std::vector<feature::FeatureId> sketches;
+};
+
+/// Regeneration after editing a single dimension: only one chain and the
+/// total re-evaluate, everything else is skipped by hash.
+class SingleEditWorkload final : public Workload {
+public:
+    explicit SingleEditWorkload(double scale) : model_(scale) {}
+
+    std::size_t run() override {
+        const feature::FeatureId target = model_.sketches[model_.sketches.size() / 2];
+        toggle_ = !toggle_;
+        model_.graph.setParameter(target, "radius", toggle_ ? 0.75 : 0.5);
+        return model_.graph.regenerate().evaluated;
+    }
+
+private:
+    FeatureModel model_;
+    bool toggle_ = false;
+};
+
+/// Forced regeneration of the whole tree; waves of independent chains run
+/// in parallel.
+class FullRegenerationWorkload final : public Workload {
+public:
+    explicit FullRegenerationWorkload(double scale) : model_(scale) {}
+
+    std::size_t run() override {
+        for (feature::FeatureId id = 0; id < model_.graph.size(); ++id) {
+            model_.graph.invalidate(id);
+        }
+        return model_.graph.regenerate().evaluated;
+    }
+
+private:
+    FeatureModel model_;
+};
+
+/// Reopening the model with a warm persistent result cache: a fresh graph
+/// and an empty memory tier, so every feature is fetched from disk.
+class ReopenWorkload final : public Workload {
+public:
+    explicit ReopenWorkload(double scale)
+        : scale_(scale),
+          directory_((std::filesystem::temp_directory_path() / "rebelcad-bench-result-cache").string()) {
+        std::error_code ignored;
+        std::filesystem::remove_all(directory_, ignored);
+        feature::ResultCacheOptions options;
+        options.directory = directory_;
+        FeatureModel warm(scale_, std::make_shared<feature::ResultCache>(options));
+    }
+
+    ~ReopenWorkload() override {
+        std::error_code ignored;
+        std::filesystem::remove_all(directory_, ignored);
+    }
+
+    std::size_t run() override {
+        feature::ResultCacheOptions options;
+        options.directory = directory_;
+        FeatureModel model(scale_, std::make_shared<feature::ResultCache>(options));
+        return model.graph.size();
+    }
+
+private:
+    double scale_;
+    std::string directory_;
+};
+
+/// Undo and redo of one dimension edit with a memory result cache: both
+/// states were computed before, so nothing re-evaluates.
+class UndoRedoWorkload final : public Workload {
+public:
+    explicit UndoRedoWorkload(double scale) : model_(scale, std::make_shared<feature::ResultCache>()) {
+        edit();
+    }
+
+    std::size_t run() override { return edit(); }
+
+private:
+    std::size_t edit() {
+        const feature::FeatureId target = model_.sketches[model_.sketches.size() / 2];
+        toggle_ = !toggle_;
+        model_.graph.setParameter(target, "radius", toggle_ ? 0.75 : 0.5);
+        return model_.graph.regenerate().visited;
+    }
+
+    FeatureModel model_;
+    bool toggle_ = false;
+};
+
+} // namespace
+
+void registerFeatureBenchmarks(Registry& registry) {
+    registry.add({"feature.single_edit", "regenerate 256-chain feature tree after one dimension edit", "features",
+                  [](double scale) { return std::make_unique<SingleEditWorkload>(scale); }});
+    registry.add({"feature.full_regeneration", "forced regeneration of the 256-chain feature tree", "features",
+                  [](double scale) { return std::make_unique<FullRegenerationWorkload>(scale); }});
+    registry.add({"feature.reopen_cached", "reopen the 256-chain feature tree from a warm on-disk result cache",
+                  "features", [](double scale) { return std::make_unique<ReopenWorkload>(scale); }});
+    registry.add({"feature.undo_redo", "undo/redo of one feature.single_edit edit with an in-memory result cache",
+                  "features", [](double scale) { return std::make_unique<UndoRedoWorkload>(scale); }});
+}
+
+} // namespace rebel::bench
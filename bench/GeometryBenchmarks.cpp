@@ -0,0 +1,190 @@
+#include "Harness.hpp"
+#include "Synthetic.hpp"
+
+#include "rebel/brep/Nurbs.hpp"
+#include "rebel/brep/Tessellator.hpp"
+#include "rebel/core/TaskScheduler.hpp"
+#include "rebel/spatial/Bvh.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <random>
+
+namespace rebel::bench {
+namespace {
+
+/// Every LOD of a few hundred bodies at a fine tolerance, as when opening a
+/// large model.
+class TessellationWorkload final : public Workload {
+public:
+    explicit TessellationWorkload(double scale)
+        : bodies_(syntheticBodies(std::max<std::size_t>(4, static_cast<std::size_t>(256 * scale)), 11)) {
+        options_.chordalTolerance = 0.0005;
+    }
+
+    std::size_t run() override {
+        std::atomic<std::size_t> triangles{0};
+        core::parallelFor(0, bodies_.size(), 1, [&](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) {
+                const brep::Tessellation t = brep::tessellate(bodies_[i], options_);
+                std::size_t n = 0;
+                for (const brep::TessellationLevel& level : t.levels) {
+                    n += level.triangleCount();
+                }
+                triangles.fetch_add(n, std::memory_order_relaxed);
+            }
+        });
+        return triangles.load();
+    }
+
+private:
+    std::vector<brep::Body> bodies_;
+    brep::TessellationOptions options_;
+};
+
+/// SAH build over a million scattered boxes.
+class BvhBuildWorkload final : public Workload {
+public:
+    explicit BvhBuildWorkload(double scale) {
+        std::mt19937 rng(5);
+        std::uniform_real_distribution<float> pos(0.0f, 100.0f);
+        std::uniform_real_distribution<float> size(0.05f, 1.0f);
+        boxes_.resize(std::max<std::size_t>(1024, static_cast<std::size_t>(1000000 * scale)));
+        for (math::Aabb& box : boxes_) {
+            const math::Vec3f p{pos(rng), pos(rng), pos(rng)};
+            box.expand(p);
+            box.expand(p + math::Vec3f{size(rng), size(rng), size(rng)});
+        }
+    }
+
+    std::size_t run() override {
+        const spatial::Bvh bvh = spatial::Bvh::build(boxes_.data(), boxes_.size());
+        return bvh.primitiveCount();
+    }
+
+private:
+    std::vector<math::Aabb> boxes_;
+};
+
+/// Rational bicubic surface over a 32 x 32 net with gentle waves, the size
+/// of a freeform body panel.
+brep::NurbsSurface waveSurface() {
+    constexpr int kNet = 32;
+    constexpr unsigned kDegree = 3;
+    std::vector<double> knots(kDegree, 0.0);
+    for (int i = 0; i <= kNet - static_cast<int>(kDegree); ++i) {
+        knots.push_back(i);
+    }
+    knots.insert(knots.end(), kDegree, knots.back());
+    std::mt19937 rng(17);
+    std::uniform_real_distribution<double> weight(0.8, 1.25);
+    std::vector<math::Vec3d> points;
+    std::vector<double> weights;
+    for (int j = 0; j < kNet; ++j) {
+        for (int i = 0; i < kNet; ++i) {
+            points.push_back({static_cast<double>(i), static_cast<double>(j), std::sin(0.4 * i) * std::cos(0.3 * j)});
+            weights.push_back(weight(rng));
+        }
+    }
+    return brep::NurbsSurface(brep::KnotVector(kDegree, knots), brep::KnotVector(kDegree, knots), points, weights);
+}
+
+/// Points and normals on a dense (u, v) grid, as tessellation samples it.
+class NurbsGridWorkload final : public Workload {
+public:
+    explicit NurbsGridWorkload(double scale)
+        : surface_(waveSurface()), n_(std::max<std::size_t>(32, static_cast<std::size_t>(1024 * std::sqrt(scale)))) {
+        for (std::size_t i = 0; i < n_; ++i) {
+            u_.push_back(surface_.uKnots().last() * static_cast<double>(i) / static_cast<double>(n_ - 1));
+        }
+        points_.resize(n_ * n_);
+        normals_.resize(n_ * n_);
+    }
+
+    std::size_t run() override {
+        surface_.evaluateGrid(u_.data(), n_, u_.data(), n_, points_.data(), normals_.data());
+        return points_.size();
+    }
+
+private:
+    brep::NurbsSurface surface_;
+    std::size_t n_;
+    std::vector<double> u_;
+    std::vector<math::Vec3d> points_;
+    std::vector<math::Vec3d> normals_;
+};
+
+/// Scattered samples with derivatives and normals, as fillet tracing and
+/// toolpath generation ask for them.
+class NurbsScatteredWorkload final : public Workload {
+public:
+    explicit NurbsScatteredWorkload(double scale) : surface_(waveSurface()) {
+        std::mt19937 rng(23);
+        std::uniform_real_distribution<double> param(0.0, surface_.uKnots().last());
+        uv_.resize(std::max<std::size_t>(1024, static_cast<std::size_t>(1000000 * scale)));
+        for (math::Vec2d& uv : uv_) {
+            uv = {param(rng), param(rng)};
+        }
+        points_.resize(uv_.size());
+        du_.resize(uv_.size());
+        dv_.resize(uv_.size());
+        normals_.resize(uv_.size());
+    }
+
+    std::size_t run() override {
+        surface_.evaluate(uv_.data(), uv_.size(), {points_.data(), du_.data(), dv_.data(), normals_.data()});
+        return uv_.size();
+    }
+
+private:
+    brep::NurbsSurface surface_;
+    std::vector<math::Vec2d> uv_;
+    std::vector<math::Vec3d> points_;
+    std::vector<math::Vec3d> du_;
+    std::vector<math::Vec3d> dv_;
+    std::vector<math::Vec3d> normals_;
+};
+
+/// Projection of points scattered around the surface, as measurement and
+/// probing do.
+class NurbsClosestWorkload final : public Workload {
+public:
+    explicit NurbsClosestWorkload(double scale) : surface_(waveSurface()) {
+        std::mt19937 rng(29);
+        std::uniform_real_distribution<double> along(0.0, 31.0);
+        std::uniform_real_distribution<double> off(-1.5, 1.5);
+        queries_.resize(std::max<std::size_t>(256, static_cast<std::size_t>(20000 * scale)));
+        for (math::Vec3d& q : queries_) {
+            q = {along(rng), along(rng), off(rng)};
+        }
+        out_.resize(queries_.size());
+    }
+
+    std::size_t run() override {
+        surface_.closestPoints(queries_.data(), queries_.size(), out_.data());
+        return queries_.size();
+    }
+
+private:
+    brep::NurbsSurface surface_;
+    std::vector<math::Vec3d> queries_;
+    std::vector<brep::SurfaceClosestPoint> out_;
+};
+
+} // namespace
+
+void registerGeometryBenchmarks(Registry& registry) {
+    registry.add({"tessellation.large", "all LODs of 256 B-rep bodies at 0.0005 chordal tolerance", "triangles",
+                  [](double scale) { return std::make_unique<TessellationWorkload>(scale); }});
+    registry.add({"spatial.bvh_build", "binned SAH BVH over 1M boxes", "primitives",
+                  [](double scale) { return std::make_unique<BvhBuildWorkload>(scale); }});
+    registry.add({"geometry.nurbs_grid", "points and normals of a bicubic NURBS on a 1024 x 1024 grid", "samples",
+                  [](double scale) { return std::make_unique<NurbsGridWorkload>(scale); }});
+    registry.add({"geometry.nurbs_scattered", "1M scattered NURBS samples with derivatives and normals", "samples",
+                  [](double scale) { return std::make_unique<NurbsScatteredWorkload>(scale); }});
+    registry.add({"geometry.nurbs_closest", "20k closest-point queries on a bicubic NURBS", "queries",
+                  [](double scale) { return std::make_unique<NurbsClosestWorkload>(scale); }});
+}
+
+} // namespace rebel::bench
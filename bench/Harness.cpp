@@ -0,0 +1,141 @@
+#include "Harness.hpp"
+
+#include "rebel/core/TaskScheduler.hpp"
+#include "rebel/core/Trace.hpp"
+#include "rebel/math/Batch.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ostream>
+#include <thread>
+
+namespace rebel::bench {
+
+std::vector<unsigned> defaultThreadCounts() {
+    const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> counts;
+    for (unsigned t = 1; t < hw; t *= 2) {
+        counts.push_back(t);
+    }
+    counts.push_back(hw);
+    return counts;
+}
+
+std::vector<Measurement> runBenchmarks(const Registry& registry, const RunOptions& options, std::ostream& log) {
+    using Clock = std::chrono::steady_clock;
+    std::vector<Measurement> results;
+    std::vector<unsigned> threadCounts = options.threadCounts.empty() ? defaultThreadCounts() : options.threadCounts;
+    std::sort(threadCounts.begin(), threadCounts.end());
+    const std::size_t repetitions = std::max<std::size_t>(options.repetitions, 1);
+
+    for (const BenchmarkInfo& info : registry.all()) {
+        if (!options.filter.empty() && info.name.find(options.filter) == std::string::npos) {
+            continue;
+        }
+        log << info.name << ": setting up\n" << std::flush;
+        std::unique_ptr<Workload> workload = [&] {
+            REBEL_TRACE_ZONE_DETAIL("bench.setup", info.name);
+            return info.create(options.scale);
+        }();
+        double referenceMs = 0.0;
+        unsigned referenceThreads = 0;
+        for (unsigned threads : threadCounts) {
+            core::TaskScheduler::setGlobalThreadCount(threads);
+            for (std::size_t i = 0; i < options.warmup; ++i) {
+                workload->run();
+            }
+            std::vector<double> times;
+            std::size_t items = 0;
+            for (std::size_t i = 0; i < repetitions; ++i) {
+                REBEL_TRACE_ZONE_DETAIL("bench.run", info.name);
+                const auto start = Clock::now();
+                items = workload->run();
+                times.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+            }
+            std::sort(times.begin(), times.end());
+
+            Measurement m;
+            m.name = info.name;
+            m.unit = info.unit;
+            m.threads = threads;
+            m.repetitions = repetitions;
+            m.items = items;
+            m.minMs = times.front();
+            m.medianMs = times.size() % 2 ? times[times.size() / 2]
+                                          : 0.5 * (times[times.size() / 2 - 1] + times[times.size() / 2]);
+            double sum = 0.0;
+            for (double t : times) {
+                sum += t;
+            }
+            m.meanMs = sum / static_cast<double>(times.size());
+            if (referenceThreads == 0) {
+                referenceThreads = threads;
+                referenceMs = m.medianMs;
+            }
+            m.speedup = m.medianMs > 0.0 ? referenceMs / m.medianMs : 1.0;
+            m.efficiency = m.speedup * referenceThreads / threads;
+
+            char line[160];
+            std::snprintf(line, sizeof(line), "  %2u threads  median %10.3f ms  min %10.3f ms  speedup %5.2f  %zu %s\n",
+                          threads, m.medianMs, m.minMs, m.speedup, items, info.unit.c_str());
+            log << line << std::flush;
+            results.push_back(std::move(m));
+        }
+    }
+    return results;
+}
+
+core::Json toJson(const std::vector<Measurement>& results, const RunOptions& options) {
+    core::Json report = core::Json::object();
+    report["schema"] = 1;
+    report["simd"] = math::batch::backendName(math::batch::activeBackend());
+    report["hardwareThreads"] = std::max(1u, std::thread::hardware_concurrency());
+    report["scale"] = options.scale;
+    core::Json entries = core::Json::array();
+    for (const Measurement& m : results) {
+        core::Json e = core::Json::object();
+        e["name"] = m.name;
+        e["unit"] = m.unit;
+        e["threads"] = m.threads;
+        e["repetitions"] = static_cast<std::uint64_t>(m.repetitions);
+        e["items"] = static_cast<std::uint64_t>(m.items);
+        e["minMs"] = m.minMs;
+        e["medianMs"] = m.medianMs;
+        e["meanMs"] = m.meanMs;
+        e["itemsPerSecond"] = m.medianMs > 0.0 ? static_cast<double>(m.items) * 1000.0 / m.medianMs : 0.0;
+        e["speedup"] = m.speedup;
+        e["efficiency"] = m.efficiency;
+        entries.push(std::move(e));
+    }
+    report["results"] = std::move(entries);
+    return report;
+}
+
+std::vector<Comparison> compareWithBaseline(const std::vector<Measurement>& results, const core::Json& baseline,
+                                            double tolerance) {
+    std::vector<Comparison> out;
+    const core::Json& entries = baseline["results"];
+    if (!entries.isArray()) {
+        return out;
+    }
+    for (const Measurement& m : results) {
+        for (const core::Json& e : entries.asArray()) {
+            if (e.string("name", {}) != m.name || static_cast<unsigned>(e.number("threads", 0)) != m.threads) {
+                continue;
+            }
+            Comparison c;
+            c.name = m.name;
+            c.threads = m.threads;
+            c.baselineMs = e.number("medianMs", 0.0);
+            c.currentMs = m.medianMs;
+            c.ratio = c.baselineMs > 0.0 ? c.currentMs / c.baselineMs : 1.0;
+            c.regressed = c.ratio > 1.0 + tolerance;
+            out.push_back(c);
+            break;
+        }
+    }
+    return out;
+}
+
+} // namespace rebel::bench
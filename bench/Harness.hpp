@@ -0,0 +1,103 @@
+#pragma once
+
+#include "rebel/core/Json.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace rebel::bench {
+
+/// One benchmark kernel. Built once (untimed), then `run()` is timed
+/// repeatedly at every thread count. Engines pick the thread count up from
+/// `core::TaskScheduler::global()`, so workloads must not cache scheduler
+/// state between runs.
+class Workload {
+public:
+    virtual ~Workload() = default;
+
+    /// One timed iteration; returns the number of items processed
+    /// (triangles, occurrences, features, ...) for throughput reporting.
+    virtual std::size_t run() = 0;
+};
+
+struct BenchmarkInfo {
+    std::string name;
+    std::string description;
+    /// What `run()` counts, e.g. "triangles".
+    std::string unit;
+    /// Builds the workload; `scale` shrinks or grows its problem size
+    /// (1.0 is the reference size, CI smoke runs use less).
+    std::function<std::unique_ptr<Workload>(double scale)> create;
+};
+
+class Registry {
+public:
+    void add(BenchmarkInfo info) { benchmarks_.push_back(std::move(info)); }
+    const std::vector<BenchmarkInfo>& all() const { return benchmarks_; }
+
+private:
+    std::vector<BenchmarkInfo> benchmarks_;
+};
+
+struct RunOptions {
+    std::vector<unsigned> threadCounts;
+    std::size_t warmup = 1;
+    std::size_t repetitions = 5;
+    double scale = 1.0;
+    /// Substring a benchmark name must contain; empty runs everything.
+    std::string filter;
+};
+
+struct Measurement {
+    std::string name;
+    std::string unit;
+    unsigned threads = 1;
+    std::size_t repetitions = 0;
+    std::size_t items = 0;
+    double minMs = 0.0;
+    double medianMs = 0.0;
+    double meanMs = 0.0;
+    /// Relative to the same benchmark at the smallest thread count.
+    double speedup = 1.0;
+    /// `speedup` divided by the thread ratio; 1.0 is perfect scaling.
+    double efficiency = 1.0;
+};
+
+struct Comparison {
+    std::string name;
+    unsigned threads = 1;
+    double baselineMs = 0.0;
+    double currentMs = 0.0;
+    /// current / baseline; above 1 is slower.
+    double ratio = 1.0;
+    bool regressed = false;
+};
+
+/// Powers of two up to the hardware thread count, plus that count itself.
+std::vector<unsigned> defaultThreadCounts();
+
+/// Runs the selected benchmarks, printing progress to `log`.
+std::vector<Measurement> runBenchmarks(const Registry& registry, const RunOptions& options, std::ostream& log);
+
+/// Machine-readable report: environment plus one entry per measurement.
+core::Json toJson(const std::vector<Measurement>& results, const RunOptions& options);
+
+/// Compares medians against a report written by `toJson`. Entries missing
+/// from the baseline are skipped; a ratio above `1 + tolerance` regresses.
+std::vector<Comparison> compareWithBaseline(const std::vector<Measurement>& results, const core::Json& baseline,
+                                            double tolerance);
+
+/// Registration hooks, one per workload family.
+void registerGeometryBenchmarks(Registry& registry);
+void registerAssemblyBenchmarks(Registry& registry);
+void registerFeatureBenchmarks(Registry& registry);
+void registerSketchBenchmarks(Registry& registry);
+void registerBooleanBenchmarks(Registry& registry);
+void registerRenderBenchmarks(Registry& registry);
+void registerSyncBenchmarks(Registry& registry);
+
+} // namespace rebel::bench
@@ -0,0 +1,285 @@
+#include "Harness.hpp"
+#include "Synthetic.hpp"
+
+#include "rebel/assembly/AssemblyIndex.hpp"
+#include "rebel/assembly/Part.hpp"
+#include "rebel/brep/Tessellator.hpp"
+#include "rebel/io/NativeFile.hpp"
+#include "rebel/io/ResourceBundle.hpp"
+#include "rebel/render/CullPass.hpp"
+#include "rebel/render/DrawScene.hpp"
+#include "rebel/render/Picker.hpp"
+#include "rebel/render/SectionView.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <random>
+#include <string>
+
+namespace rebel::bench {
+namespace {
+
+/// Picking in the 10k-occurrence assembly of assembly.raycast, seen whole
+/// in a 1280x720 viewport. The buffer run re-renders the ID buffer from a
+/// camera orbiting a step per run; the hover run moves the cursor over the
+/// viewport and asks for the exact hit under it at every position.
+class PickWorkload final : public Workload {
+public:
+    PickWorkload(double scale, bool hover) : hover_(hover) {
+        for (geometry::Mesh& mesh : syntheticPartMeshes(40, 0.002, 23)) {
+            parts_.push_back(assembly::Part::create("part" + std::to_string(parts_.size()), std::move(mesh)));
+        }
+        model_ = syntheticAssembly(parts_, std::max<std::size_t>(64, static_cast<std::size_t>(10000 * scale)), 2.5,
+                                   100, 5);
+        index_ = std::make_unique<assembly::AssemblyIndex>(*model_.assembly, *model_.library);
+        index_->update();
+        picker_ = std::make_unique<render::Picker>(index_->bvh());
+        picker_->update(camera(0));
+
+        std::mt19937 rng(13);
+        std::uniform_real_distribution<float> x(0.0f, 1280.0f);
+        std::uniform_real_distribution<float> y(0.0f, 720.0f);
+        cursor_.resize(std::max<std::size_t>(256, static_cast<std::size_t>(20000 * scale)));
+        for (Cursor& c : cursor_) {
+            c = {x(rng), y(rng)};
+        }
+    }
+
+    std::size_t run() override {
+        if (!hover_) {
+            picker_->update(camera(++step_));
+            return 1;
+        }
+        for (const Cursor& c : cursor_) {
+            hits_ += picker_->pick(c.x, c.y).hit() ? 1 : 0;
+        }
+        return cursor_.size();
+    }
+
+private:
+    struct Cursor {
+        float x, y;
+    };
+
+    render::Camera camera(std::size_t step) const {
+        const math::Aabb box = index_->bvh().topLevel().nodes()[0].bounds;
+        const math::Vec3f center = (box.min + box.max) * 0.5f;
+        const float radius = math::length(box.extent());
+        const float angle = 0.6f + 0.05f * static_cast<float>(step);
+        const math::Vec3f eye = center + math::Vec3f{std::cos(angle), 0.7f, std::sin(angle)} * radius;
+        return render::Camera::perspective(eye, center, {0.0f, 1.0f, 0.0f}, 0.8f, 1280, 720, 0.01f * radius,
+                                           4.0f * radius);
+    }
+
+    bool hover_;
+    std::size_t step_ = 0;
+    std::vector<assembly::PartPtr> parts_;
+    SyntheticAssembly model_;
+    std::unique_ptr<assembly::AssemblyIndex> index_;
+    std::unique_ptr<render::Picker> picker_;
+    std::vector<Cursor> cursor_;
+    std::size_t hits_ = 0;
+};
+
+/// GPU-driven frame preparation for a 500k-occurrence assembly opened
+/// graphics-only from a native file with three levels of detail per part:
+/// frustum and occlusion culling, level selection and multi-draw list
+/// generation per frame. Setup streams in the levels the first view needs
+/// and rasterizes its depth once as the previous frame's depth; runs
+/// alternate between two nearby cameras, like a slow orbit.
+class CullWorkload final : public Workload {
+public:
+    explicit CullWorkload(double scale)
+        : path_((std::filesystem::temp_directory_path() / "rebelcad-bench-cull.rbl").string()) {
+        brep::TessellationOptions tessellation;
+        tessellation.chordalTolerance = 0.002;
+        io::NativeWriter writer;
+        std::vector<assembly::PartPtr> parts;
+        for (const brep::Body& body : syntheticBodies(40, 21)) {
+            const brep::Tessellation levels = brep::tessellate(body, tessellation);
+            const std::string name = "part" + std::to_string(parts.size());
+            std::vector<assembly::PartPtr> lods;
+            for (std::size_t l = 1; l < levels.levels.size(); ++l) {
+                lods.push_back(assembly::Part::create(name, levels.levels[l].merged()));
+            }
+            parts.push_back(assembly::Part::create(name, levels.levels[0].merged()));
+            writer.addPart(parts.back(), nullptr, std::move(lods));
+        }
+        const SyntheticAssembly model = syntheticAssembly(
+            parts, std::max<std::size_t>(1000, static_cast<std::size_t>(500000 * scale)), 2.5, 100, 9);
+        writer.setAssembly(*model.assembly, *model.library);
+        writer.write(path_);
+
+        const auto document = io::NativeDocument::open(path_);
+        io::NativeLoadOptions options;
+        options.detail = io::LoadDetail::Graphics;
+        options.lod = 1;
+        document->loadAssembly(assembly_, library_, options);
+        index_ = std::make_unique<assembly::AssemblyIndex>(assembly_, library_);
+        index_->update();
+        scene_ = std::make_unique<render::DrawScene>(assembly_, *index_);
+        scene_->streamLevels(document);
+        for (int frame = 0; frame < 2; ++frame) {
+            pass_.run(*scene_, camera(0), nullptr, list_);
+            scene_->finishStreaming();
+        }
+
+        render::Picker picker(index_->bvh());
+        const render::Camera view = camera(0);
+        picker.update(view);
+        std::vector<float> depth(std::size_t(view.width) * view.height);
+        for (std::uint32_t y = 0; y < view.height; ++y) {
+            for (std::uint32_t x = 0; x < view.width; ++x) {
+                depth[std::size_t(y) * view.width + x] = picker.depth(x, y);
+            }
+        }
+        pyramid_.build(depth.data(), view.width, view.height);
+    }
+
+    ~CullWorkload() override {
+        scene_.reset();
+        std::error_code ignored;
+        std::filesystem::remove(path_, ignored);
+    }
+
+    std::size_t run() override {
+        pass_.run(*scene_, camera(++step_ % 2), &pyramid_, list_);
+        return 1;
+    }
+
+private:
+    render::Camera camera(std::size_t step) const {
+        const math::Aabb box = index_->bvh().topLevel().nodes()[0].bounds;
+        const math::Vec3f center = (box.min + box.max) * 0.5f;
+        const float radius = math::length(box.extent());
+        const float angle = 0.6f + 0.002f * static_cast<float>(step);
+        const math::Vec3f eye = center + math::Vec3f{std::cos(angle), 0.7f, std::sin(angle)} * radius;
+        return render::Camera::perspective(eye, center, {0.0f, 1.0f, 0.0f}, 0.8f, 1280, 720, 0.01f * radius,
+                                           4.0f * radius);
+    }
+
+    std::string path_;
+    assembly::PartLibrary library_;
+    assembly::Assembly assembly_;
+    std::unique_ptr<assembly::AssemblyIndex> index_;
+    std::unique_ptr<render::DrawScene> scene_;
+    render::CullPass pass_;
+    render::DepthPyramid pyramid_;
+    render::DrawList list_;
+    std::size_t step_ = 0;
+};
+
+/// Section views of a densely packed 10k-occurrence assembly. The plane
+/// run drags an oblique section plane through the middle a step per run;
+/// the box run drags the +x face of a section box around the middle
+/// quarter, so only that face re-slices and the others trim again.
+class SectionWorkload final : public Workload {
+public:
+    SectionWorkload(double scale, bool box) : box_(box) {
+        for (geometry::Mesh& mesh : syntheticPartMeshes(40, 0.002, 23)) {
+            parts_.push_back(assembly::Part::create("part" + std::to_string(parts_.size()), std::move(mesh)));
+        }
+        model_ = syntheticAssembly(parts_, std::max<std::size_t>(64, static_cast<std::size_t>(10000 * scale)), 1.2,
+                                   100, 5);
+        index_ = std::make_unique<assembly::AssemblyIndex>(*model_.assembly, *model_.library);
+        index_->update();
+        view_ = std::make_unique<render::SectionView>(*index_);
+        bounds_ = index_->bvh().topLevel().nodes()[0].bounds;
+        place(0);
+        view_->update();
+    }
+
+    std::size_t run() override {
+        place(++step_);
+        view_->update();
+        return 1;
+    }
+
+private:
+    /// Back and forth over a tenth of the model.
+    void place(std::size_t step) {
+        const float phase = static_cast<float>(step % 40) / 40.0f;
+        const float t = 0.1f * (phase < 0.5f ? phase : 1.0f - phase);
+        const math::Vec3f center = bounds_.center();
+        const math::Vec3f extent = bounds_.extent();
+        if (box_) {
+            math::Aabb box{center - extent * 0.25f, center + extent * 0.25f};
+            box.max.x += t * extent.x;
+            view_->setBox(box);
+            return;
+        }
+        const math::Vec3d normal = math::normalize(math::Vec3d{0.3, 0.2, 1.0});
+        const math::Vec3d origin{center.x, center.y, center.z + t * extent.z};
+        view_->setPlane({normal, math::dot(normal, origin)});
+    }
+
+    bool box_;
+    std::size_t step_ = 0;
+    std::vector<assembly::PartPtr> parts_;
+    SyntheticAssembly model_;
+    std::unique_ptr<assembly::AssemblyIndex> index_;
+    std::unique_ptr<render::SectionView> view_;
+    math::Aabb bounds_;
+};
+
+/// Startup resources from a precompiled bundle: 4k shaders, icons and
+/// material definitions (about 20 MB). Each run opens the bundle and
+/// fetches what a viewport needs first, every shader and material and a
+/// tenth of the icons, by name, reading one byte of each.
+class StartupBundleWorkload final : public Workload {
+public:
+    explicit StartupBundleWorkload(double scale)
+        : path_((std::filesystem::temp_directory_path() / "rebelcad-bench-startup.rbb").string()) {
+        const auto count = std::max<std::size_t>(64, static_cast<std::size_t>(4000 * scale));
+        std::mt19937 rng(31);
+        std::uniform_int_distribution<std::size_t> bytes(512, 9216);
+        io::ResourceBundleWriter writer;
+        for (std::size_t i = 0; i < count; ++i) {
+            static const char* const kinds[] = {"shaders/", "icons/", "materials/"};
+            const std::string name = kinds[i % 3] + std::to_string(i) + (i % 3 == 1 ? ".png" : ".bin");
+            writer.add(name, std::vector<std::uint8_t>(bytes(rng), static_cast<std::uint8_t>(i)));
+            if (i % 3 != 1 || i % 30 == 1) {
+                wanted_.push_back(name);
+            }
+        }
+        writer.write(path_);
+    }
+
+    ~StartupBundleWorkload() override {
+        std::error_code ignored;
+        std::filesystem::remove(path_, ignored);
+    }
+
+    std::size_t run() override {
+        const auto bundle = io::ResourceBundle::open(path_);
+        for (const std::string& name : wanted_) {
+            checksum_ += bundle->get(name).data[0];
+        }
+        return wanted_.size();
+    }
+
+private:
+    std::string path_;
+    std::vector<std::string> wanted_;
+    std::size_t checksum_ = 0;
+};
+
+} // namespace
+
+void registerRenderBenchmarks(Registry& registry) {
+    registry.add({"render.pick_buffer", "1280x720 ID buffer of a 10k-occurrence assembly, after a camera move",
+                  "frames", [](double scale) { return std::make_unique<PickWorkload>(scale, false); }});
+    registry.add({"render.pick_hover", "20k exact picks under a moving cursor in the render.pick_buffer view",
+                  "picks", [](double scale) { return std::make_unique<PickWorkload>(scale, true); }});
+    registry.add({"render.cull", "GPU-driven culling and multi-draw list of a 500k-occurrence assembly, per frame",
+                  "frames", [](double scale) { return std::make_unique<CullWorkload>(scale); }});
+    registry.add({"render.section_drag", "capped section of a 10k-occurrence assembly, per step of a plane drag",
+                  "steps", [](double scale) { return std::make_unique<SectionWorkload>(scale, false); }});
+    registry.add({"render.section_box", "capped section box of the same assembly, per step of a face drag", "steps",
+                  [](double scale) { return std::make_unique<SectionWorkload>(scale, true); }});
+    registry.add({"render.startup_bundle", "open a 4k-resource startup bundle and fetch a viewport's resources",
+                  "resources", [](double scale) { return std::make_unique<StartupBundleWorkload>(scale); }});
+}
+
+} // namespace rebel::bench
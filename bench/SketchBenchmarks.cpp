@@ -0,0 +1,132 @@
+#include "Harness.hpp"
+
+#include "rebel/sketch/Sketch.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+
+namespace rebel::bench {
+namespace {
+
+using sketch::ConstraintType;
+
+/// Flat-pattern-like sketch: a row of dimensioned rectangles, each with a
+/// centered hole and a corner arc, chained by gap dimensions. Every tenth
+/// rectangle is only held by its gap, which leaves the sketch a few degrees
+/// of freedom, as real ones usually have. Points start perturbed off the
+/// solution.
+struct FlatPattern {
+    sketch::Sketch sketch;
+    std::vector<sketch::ConstraintId> widths;
+    std::vector<sketch::EntityId> corners;
+};
+
+std::unique_ptr<FlatPattern> flatPattern(std::size_t panels) {
+    auto pattern = std::make_unique<FlatPattern>();
+    sketch::Sketch& s = pattern->sketch;
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> jitter(-0.1, 0.1);
+    sketch::EntityId previousCorner = sketch::kInvalidEntity;
+    sketch::EntityId previousRight = sketch::kInvalidEntity;
+    sketch::EntityId firstHole = sketch::kInvalidEntity;
+    for (std::size_t i = 0; i < panels; ++i) {
+        const double x = 2.0 * static_cast<double>(i);
+        const math::Vec2d at[4] = {{x, 0.0}, {x + 1.5, 0.0}, {x + 1.5, 1.0}, {x, 1.0}};
+        sketch::EntityId p[4], l[4];
+        for (int k = 0; k < 4; ++k) {
+            p[k] = s.addPoint({at[k].x + jitter(rng), at[k].y + jitter(rng)});
+        }
+        for (int k = 0; k < 4; ++k) {
+            l[k] = s.addLine(p[k], p[(k + 1) % 4]);
+        }
+        s.addConstraint({ConstraintType::Horizontal, l[0]});
+        s.addConstraint({ConstraintType::Vertical, l[1]});
+        s.addConstraint({ConstraintType::Horizontal, l[2]});
+        s.addConstraint({ConstraintType::Vertical, l[3]});
+        pattern->widths.push_back(s.addConstraint({ConstraintType::Length, l[0], sketch::kInvalidEntity, 1.5}));
+        s.addConstraint({ConstraintType::Length, l[1], sketch::kInvalidEntity, 1.0});
+        if (i == 0) {
+            s.setFixed(p[0]);
+        } else {
+            s.addConstraint({ConstraintType::Distance, previousRight, p[0], 0.5});
+            if (i % 10 != 0) {
+                s.addConstraint({ConstraintType::PointOnLine, p[0], s.addLine(previousCorner, previousRight)});
+            }
+        }
+        const sketch::EntityId center = s.addPoint({x + 0.7, 0.5});
+        s.addConstraint({ConstraintType::Midpoint, center, s.addLine(p[0], p[2])});
+        const sketch::EntityId hole = s.addCircle(center, 0.3);
+        s.addConstraint({ConstraintType::Radius, hole, sketch::kInvalidEntity, 0.2});
+        const sketch::EntityId start = s.addPoint({x + 1.5, 0.8});
+        const sketch::EntityId end = s.addPoint({x + 1.3, 1.0});
+        const sketch::EntityId arc = s.addArc(p[2], start, end);
+        s.addConstraint({ConstraintType::PointOnLine, start, l[1]});
+        s.addConstraint({ConstraintType::PointOnLine, end, l[2]});
+        if (i == 0) {
+            firstHole = hole;
+        } else {
+            s.addConstraint({ConstraintType::EqualRadius, arc, firstHole});
+        }
+        pattern->corners.push_back(p[0]);
+        previousCorner = p[0];
+        previousRight = p[1];
+    }
+    return pattern;
+}
+
+/// Sketch solving: from scratch (decomposition included), after changing
+/// one dimension, and while dragging a point.
+class SketchWorkload final : public Workload {
+public:
+    enum class Mode { Solve, Dimension, Drag };
+
+    SketchWorkload(double scale, Mode mode)
+        : panels_(std::max<std::size_t>(20, static_cast<std::size_t>(400 * scale))), mode_(mode) {
+        pattern_ = flatPattern(panels_);
+        pattern_->sketch.solve();
+    }
+
+    std::size_t run() override {
+        sketch::Sketch& s = pattern_->sketch;
+        const bool even = step_++ % 2 == 0;
+        switch (mode_) {
+        case Mode::Solve:
+            pattern_ = flatPattern(panels_);
+            pattern_->sketch.solve();
+            return pattern_->sketch.entityCount();
+        case Mode::Dimension:
+            s.setValue(pattern_->widths[panels_ / 2], even ? 1.75 : 1.5);
+            s.solve();
+            return 1;
+        case Mode::Drag: {
+            const sketch::EntityId corner = pattern_->corners.back();
+            const math::Vec2d at = s.point(corner);
+            s.drag(corner, {at.x + (even ? 0.01 : -0.01), at.y + (even ? 0.05 : -0.05)});
+            return 1;
+        }
+        }
+        return 0;
+    }
+
+private:
+    std::size_t panels_;
+    Mode mode_;
+    std::unique_ptr<FlatPattern> pattern_;
+    std::size_t step_ = 0;
+};
+
+} // namespace
+
+void registerSketchBenchmarks(Registry& registry) {
+    registry.add({"sketch.solve", "build and solve a 400-panel flat-pattern sketch (~6k entities)", "entities",
+                  [](double scale) { return std::make_unique<SketchWorkload>(scale, SketchWorkload::Mode::Solve); }});
+    registry.add({"sketch.dimension", "re-solve the sketch.solve sketch after changing one width", "edits",
+                  [](double scale) {
+                      return std::make_unique<SketchWorkload>(scale, SketchWorkload::Mode::Dimension);
+                  }});
+    registry.add({"sketch.drag", "drag the last corner of the sketch.solve sketch", "drags",
+                  [](double scale) { return std::make_unique<SketchWorkload>(scale, SketchWorkload::Mode::Drag); }});
+}
+
+} // namespace rebel::bench
@@ -0,0 +1,72 @@
+#include "Harness.hpp"
+#include "Synthetic.hpp"
+
+#include "rebel/assembly/AssemblyIndex.hpp"
+#include "rebel/assembly/Part.hpp"
+#include "rebel/sync/Replica.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+namespace rebel::bench {
+namespace {
+
+/// One collaborative edit between two sites sharing a 100k-occurrence
+/// assembly: the first moves a few occurrences and publishes, the hub
+/// orders the change set and both sites receive it, and the second brings
+/// its spatial index up to date. What crosses the wire is the change set,
+/// a few hundred bytes, whatever the size of the assembly.
+class SyncDeltaWorkload final : public Workload {
+public:
+    explicit SyncDeltaWorkload(double scale) {
+        for (geometry::Mesh& mesh : syntheticPartMeshes(8, 0.05, 37)) {
+            parts_.push_back(assembly::Part::create("part" + std::to_string(parts_.size()), std::move(mesh)));
+        }
+        const std::size_t occurrences = std::max<std::size_t>(64, static_cast<std::size_t>(100000 * scale));
+        for (std::size_t i = 0; i < 2; ++i) {
+            sites_[i] = syntheticAssembly(parts_, occurrences, 2.0, 100, 17);
+            replicas_[i] = std::make_unique<sync::Replica>(static_cast<sync::SiteId>(i + 1), *sites_[i].assembly,
+                                                           *sites_[i].library);
+        }
+        index_ = std::make_unique<assembly::AssemblyIndex>(*sites_[1].assembly, *sites_[1].library);
+        index_->update();
+    }
+
+    std::size_t run() override {
+        SyntheticAssembly& editor = sites_[0];
+        const float offset = (step_ % 2 == 0) ? 0.25f : -0.25f;
+        for (std::size_t k = 0; k < kMoved; ++k) {
+            const assembly::NodeId node = editor.occurrences[(step_ * 7919 + k * 104729) % editor.occurrences.size()];
+            editor.assembly->setLocalTransform(node, math::Mat4f::translation({offset, 0.0f, 0.0f}) *
+                                                         editor.assembly->node(node).local);
+        }
+        ++step_;
+        const sync::Publication publication = replicas_[0]->publish();
+        const sync::SharedMessage message = hub_.submit(publication.changeSet.data(), publication.changeSet.size());
+        for (auto& replica : replicas_) {
+            replica->receive(message->data(), message->size());
+        }
+        index_->update();
+        return 1;
+    }
+
+private:
+    static constexpr std::size_t kMoved = 8;
+
+    std::vector<assembly::PartPtr> parts_;
+    SyntheticAssembly sites_[2];
+    std::unique_ptr<sync::Replica> replicas_[2];
+    std::unique_ptr<assembly::AssemblyIndex> index_;
+    sync::Hub hub_;
+    std::size_t step_ = 0;
+};
+
+} // namespace
+
+void registerSyncBenchmarks(Registry& registry) {
+    registry.add({"sync.delta", "publish, order and apply 8 moves between two sites of a 100k-occurrence assembly",
+                  "edits", [](double scale) { return std::make_unique<SyncDeltaWorkload>(scale); }});
+}
+
+} // namespace rebel::bench
@@ -0,0 +1,76 @@
+#include "Synthetic.hpp"
+
+#include "rebel/brep/Tessellator.hpp"
+#include "rebel/math/Mat4.hpp"
+
+#include <cmath>
+#include <random>
+#include <string>
+
+namespace rebel::bench {
+
+std::vector<brep::Body> syntheticBodies(std::size_t count, std::uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> size(0.6, 1.0);
+    std::vector<brep::Body> bodies;
+    bodies.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const double s = size(rng);
+        switch (i % 4) {
+        case 0: bodies.push_back(brep::makeBox({-s * 0.5, -s * 0.4, -s * 0.3}, {s * 0.5, s * 0.4, s * 0.3})); break;
+        case 1: bodies.push_back(brep::makeCylinder({0.0, 0.0, -s * 0.5}, s * 0.4, s)); break;
+        case 2: bodies.push_back(brep::makeSphere({0.0, 0.0, 0.0}, s * 0.5)); break;
+        default: bodies.push_back(brep::makeTorus({0.0, 0.0, 0.0}, s * 0.4, s * 0.12)); break;
+        }
+    }
+    return bodies;
+}
+
+geometry::Mesh bodyMesh(const brep::Body& body, double chordalTolerance) {
+    brep::TessellationOptions options;
+    options.chordalTolerance = chordalTolerance;
+    return brep::tessellateLevel(body, options, 0).merged();
+}
+
+std::vector<geometry::Mesh> syntheticPartMeshes(std::size_t count, double chordalTolerance, std::uint64_t seed) {
+    std::vector<geometry::Mesh> meshes;
+    meshes.reserve(count);
+    for (const brep::Body& body : syntheticBodies(count, seed)) {
+        meshes.push_back(bodyMesh(body, chordalTolerance));
+    }
+    return meshes;
+}
+
+SyntheticAssembly syntheticAssembly(const std::vector<assembly::PartPtr>& parts, std::size_t occurrenceCount,
+                                    double spacing, std::size_t groupSize, std::uint64_t seed) {
+    SyntheticAssembly result;
+    result.library = std::make_unique<assembly::PartLibrary>();
+    result.assembly = std::make_unique<assembly::Assembly>();
+    std::vector<assembly::PartId> ids;
+    ids.reserve(parts.size());
+    for (const assembly::PartPtr& part : parts) {
+        ids.push_back(result.library->add(part));
+    }
+
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+    std::uniform_int_distribution<std::size_t> pick(0, ids.size() - 1);
+    const auto side = static_cast<std::size_t>(std::ceil(std::cbrt(static_cast<double>(occurrenceCount))));
+    groupSize = groupSize == 0 ? occurrenceCount : groupSize;
+    assembly::NodeId group = assembly::kInvalidNode;
+    result.occurrences.reserve(occurrenceCount);
+    for (std::size_t i = 0; i < occurrenceCount; ++i) {
+        if (i % groupSize == 0) {
+            group = result.assembly->addSubassembly(result.assembly->root(), math::Mat4f::identity(),
+                                                    "group" + std::to_string(i / groupSize));
+        }
+        const math::Vec3f cell{static_cast<float>(i % side), static_cast<float>((i / side) % side),
+                               static_cast<float>(i / (side * side))};
+        const math::Mat4f local = math::Mat4f::translation(cell * static_cast<float>(spacing)) *
+                                  math::Mat4f::rotation(math::normalize(math::Vec3f{0.3f, 1.0f, 0.2f}), angle(rng));
+        result.occurrences.push_back(result.assembly->addOccurrence(group, ids[pick(rng)], local));
+    }
+    return result;
+}
+
+} // namespace rebel::bench
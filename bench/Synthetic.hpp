@@ -0,0 +1,36 @@
+#pragma once
+
+#include "rebel/assembly/Assembly.hpp"
+#include "rebel/assembly/PartLibrary.hpp"
+#include "rebel/brep/Body.hpp"
+#include "rebel/geometry/Mesh.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace rebel::bench {
+
+/// Deterministic mix of boxes, cylinders, spheres and tori of unit size.
+std::vector<brep::Body> syntheticBodies(std::size_t count, std::uint64_t seed);
+
+/// Closed, welded triangle mesh of `body` at `chordalTolerance`.
+geometry::Mesh bodyMesh(const brep::Body& body, double chordalTolerance);
+
+/// Part definitions meshed from `syntheticBodies`.
+std::vector<geometry::Mesh> syntheticPartMeshes(std::size_t count, double chordalTolerance, std::uint64_t seed);
+
+struct SyntheticAssembly {
+    std::unique_ptr<assembly::PartLibrary> library;
+    std::unique_ptr<assembly::Assembly> assembly;
+    std::vector<assembly::NodeId> occurrences;
+};
+
+/// Places `occurrenceCount` randomly rotated instances of `parts` on a cubic
+/// grid with `spacing` between cell centers, grouped into subassemblies of
+/// `groupSize`. Parts are at most about one unit across, so neighbours
+/// start to touch or overlap once `spacing` drops below 1.
+SyntheticAssembly syntheticAssembly(const std::vector<assembly::PartPtr>& parts, std::size_t occurrenceCount,
+                                    double spacing, std::size_t groupSize, std::uint64_t seed);
+
+} // namespace rebel::bench
@@ -0,0 +1,142 @@
+#include "Harness.hpp"
+
+#include "rebel/core/Trace.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace {
+
+void usage() {
+    std::fprintf(stderr,
+                 "usage: rebelcad-bench [options]\n"
+                 "  --list                 list benchmarks and exit\n"
+                 "  --filter SUBSTRING     run benchmarks whose name contains SUBSTRING\n"
+                 "  --threads 1,2,4        thread counts to run at (default: 1, 2, 4, ... hardware)\n"
+                 "  --repetitions N        timed runs per point (default 5)\n"
+                 "  --warmup N             untimed runs per point (default 1)\n"
+                 "  --scale X              problem size factor (default 1.0)\n"
+                 "  --json PATH            write the JSON report to PATH ('-' for stdout)\n"
+                 "  --baseline PATH        compare medians against a stored report\n"
+                 "  --tolerance X          allowed slowdown before a regression (default 0.10)\n"
+                 "  --trace PATH           write a Chrome trace of the runs to PATH (REBELCAD_TRACING builds)\n");
+}
+
+std::vector<unsigned> parseThreads(const std::string& list) {
+    std::vector<unsigned> counts;
+    std::stringstream in(list);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        const long n = std::strtol(item.c_str(), nullptr, 10);
+        if (n > 0) {
+            counts.push_back(static_cast<unsigned>(n));
+        }
+    }
+    return counts;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    using namespace rebel;
+    bench::Registry registry;
+    bench::registerGeometryBenchmarks(registry);
+    bench::registerAssemblyBenchmarks(registry);
+    bench::registerFeatureBenchmarks(registry);
+    bench::registerSketchBenchmarks(registry);
+    bench::registerBooleanBenchmarks(registry);
+    bench::registerRenderBenchmarks(registry);
+    bench::registerSyncBenchmarks(registry);
+
+    bench::RunOptions options;
+    std::string jsonPath;
+    std::string baselinePath;
+    std::string tracePath;
+    double tolerance = 0.10;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                usage();
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+        if (arg == "--list") {
+            for (const bench::BenchmarkInfo& info : registry.all()) {
+                std::printf("%-28s %s\n", info.name.c_str(), info.description.c_str());
+            }
+            return 0;
+        } else if (arg == "--filter") {
+            options.filter = value();
+        } else if (arg == "--threads") {
+            options.threadCounts = parseThreads(value());
+        } else if (arg == "--repetitions") {
+            options.repetitions = std::strtoul(value().c_str(), nullptr, 10);
+        } else if (arg == "--warmup") {
+            options.warmup = std::strtoul(value().c_str(), nullptr, 10);
+        } else if (arg == "--scale") {
+            options.scale = std::strtod(value().c_str(), nullptr);
+        } else if (arg == "--json") {
+            jsonPath = value();
+        } else if (arg == "--baseline") {
+            baselinePath = value();
+        } else if (arg == "--tolerance") {
+            tolerance = std::strtod(value().c_str(), nullptr);
+        } else if (arg == "--trace") {
+            tracePath = value();
+        } else {
+            usage();
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+
+    if (!tracePath.empty()) {
+        core::setTraceThreadName("main");
+        core::startTracing();
+    }
+    const std::vector<bench::Measurement> results = bench::runBenchmarks(registry, options, std::cerr);
+    if (!tracePath.empty()) {
+        core::stopTracing();
+        if (!core::writeChromeTrace(tracePath)) {
+            std::fprintf(stderr, "cannot write %s\n", tracePath.c_str());
+            return 1;
+        }
+    }
+    const std::string report = bench::toJson(results, options).dump(2) + "\n";
+    if (jsonPath == "-") {
+        std::cout << report;
+    } else if (!jsonPath.empty()) {
+        std::ofstream out(jsonPath);
+        out << report;
+        if (!out) {
+            std::fprintf(stderr, "cannot write %s\n", jsonPath.c_str());
+            return 1;
+        }
+    }
+
+    if (baselinePath.empty()) {
+        return 0;
+    }
+    std::ifstream in(baselinePath);
+    if (!in) {
+        std::fprintf(stderr, "cannot read baseline %s\n", baselinePath.c_str());
+        return 1;
+    }
+    std::stringstream text;
+    text << in.rdbuf();
+    const std::vector<bench::Comparison> comparisons =
+        bench::compareWithBaseline(results, core::Json::parse(text.str()), tolerance);
+    bool regressed = false;
+    std::fprintf(stderr, "\n%-28s %7s %12s %12s %8s\n", "benchmark", "threads", "baseline ms", "current ms", "ratio");
+    for (const bench::Comparison& c : comparisons) {
+        std::fprintf(stderr, "%-28s %7u %12.3f %12.3f %7.2fx%s\n", c.name.c_str(), c.threads, c.baselineMs,
+                     c.currentMs, c.ratio, c.regressed ? "  REGRESSION" : "");
+        regressed = regressed || c.regressed;
+    }
+    return regressed ? 2 : 0;
+}
@@ -0,0 +1,678 @@
+#include "Session.hpp"
+
+#include "rebel/assembly/ClashDetector.hpp"
+#include "rebel/brep/Tessellator.hpp"
+#include "rebel/core/Hash.hpp"
+#include "rebel/core/Trace.hpp"
+#include "rebel/io/MeshExport.hpp"
+#include "rebel/io/StepImport.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+namespace rebel::cli {
+
+using core::Json;
+
+namespace {
+
+constexpr std::size_t kMaxReportedErrors = 20;
+
+/// Content hash of a B-rep: what a tessellation feature's result depends on.
+core::Hash128 hashBody(const brep::Body& body) {
+    core::Hasher hasher;
+    auto addRecord = [&](const brep::GeometryRecord& record) {
+        hasher.add(static_cast<std::uint32_t>(record.kind)).add(record.paramCount);
+        for (std::uint32_t i = 0; i < record.paramCount; ++i) {
+            hasher.addDouble(record.params[i]);
+        }
+    };
+    hasher.add(static_cast<std::uint64_t>(body.vertexCount()));
+    for (brep::VertexId v = 0; v < body.vertexCount(); ++v) {
+        const math::Vec3d& p = body.vertex(v).point;
+        hasher.addDouble(p.x).addDouble(p.y).addDouble(p.z);
+    }
+    hasher.add(static_cast<std::uint64_t>(body.edgeCount()));
+    for (brep::EdgeId e = 0; e < body.edgeCount(); ++e) {
+        const brep::BrepEdge& edge = body.edge(e);
+        addRecord(edge.curve->record());
+        hasher.addDouble(edge.t0).addDouble(edge.t1).add(edge.start).add(edge.end);
+    }
+    hasher.add(static_cast<std::uint64_t>(body.faceCount()));
+    for (brep::FaceId f = 0; f < body.faceCount(); ++f) {
+        const brep::BrepFace& face = body.face(f);
+        addRecord(face.surface->record());
+        hasher.addDouble(face.domain.u0).addDouble(face.domain.u1);
+        hasher.addDouble(face.domain.v0).addDouble(face.domain.v1);
+        for (const brep::Coedge& side : face.sides) {
+            hasher.add(side.edge).add(static_cast<std::uint8_t>(side.reversed));
+        }
+        hasher.add(static_cast<std::uint8_t>(face.reversed));
+    }
+    return hasher.finish();
+}
+
+/// One level of detail of one B-rep, welded. The B-rep is read from its
+/// native file for each evaluation rather than kept; its content hash is
+/// the `body` parameter, so equal bodies share cache entries and the
+/// feature stays a pure function of its parameters.
+class TessellateOp final : public feature::FeatureOp {
+public:
+    TessellateOp(std::shared_ptr<const io::NativeDocument> document, std::uint32_t record)
+        : document_(std::move(document)), record_(record) {}
+
+    std::string_view type() const override { return "rebel.cli.tessellate"; }
+    feature::ResultPtr evaluate(const feature::Parameters& p, const std::vector<feature::ResultPtr>&) const override {
+        brep::TessellationOptions options;
+        options.chordalTolerance = p.number("chordalTolerance");
+        options.angularTolerance = p.number("angularTolerance");
+        options.maxSegments = static_cast<std::uint32_t>(p.integer("maxSegments"));
+        options.levelCount = 1;
+        const brep::Body body = document_->loadBody(record_);
+        return std::make_shared<feature::MeshResult>(brep::tessellateLevel(body, options, 0).merged());
+    }
+
+private:
+    std::shared_ptr<const io::NativeDocument> document_;
+    std::uint32_t record_;
+};
+
+/// Parts referenced by live occurrences, suppressed ones included.
+std::vector<assembly::PartId> partsOf(const assembly::Assembly& assembly) {
+    std::vector<assembly::PartId> parts;
+    for (assembly::NodeId n = 0; n < assembly.nodeCount(); ++n) {
+        const assembly::AssemblyNode& node = assembly.node(n);
+        if (!node.removed && node.isOccurrence()) {
+            parts.push_back(node.part);
+        }
+    }
+    std::sort(parts.begin(), parts.end());
+    parts.erase(std::unique(parts.begin(), parts.end()), parts.end());
+    return parts;
+}
+
+std::string requiredString(const Json& job, std::string_view key) {
+    const Json& value = job[key];
+    if (!value.isString() || value.asString().empty()) {
+        throw std::invalid_argument("missing \"" + std::string(key) + "\"");
+    }
+    return value.asString();
+}
+
+bool flag(const Json& job, std::string_view key, bool fallback) {
+    const Json& value = job[key];
+    return value.isBool() ? value.asBool() : fallback;
+}
+
+assembly::PartPtr partFromResult(const std::string& name, const feature::ResultPtr& result) {
+    const auto& mesh = static_cast<const feature::MeshResult&>(*result).mesh();
+    return assembly::Part::create(name, mesh.view(), result);
+}
+
+} // namespace
+
+Session::Session(SessionOptions options) {
+    feature::ResultCacheOptions cacheOptions;
+    cacheOptions.memoryBytes = options.cacheMemoryBytes;
+    cacheOptions.directory = std::move(options.cacheDirectory);
+    cacheOptions.budget = &core::MemoryBudget::global();
+    cache_ = std::make_shared<feature::ResultCache>(std::move(cacheOptions));
+    core::MemoryBudget::global().add(this);
+}
+
+Session::~Session() {
+    core::MemoryBudget::global().remove(this);
+}
+
+Json Session::run(const Json& job) {
+    const auto start = std::chrono::steady_clock::now();
+    Json result;
+    std::string op;
+    try {
+        if (!job.isObject()) {
+            throw std::invalid_argument("job is not an object");
+        }
+        op = requiredString(job, "op");
+        REBEL_TRACE_ZONE("cli.job");
+        result = dispatch(op, job);
+    } catch (const std::exception& e) {
+        result = Json::object();
+        result["ok"] = false;
+        result["error"] = std::string(e.what());
+    }
+    if (!result.contains("ok")) {
+        result["ok"] = true;
+    }
+    if (!op.empty()) {
+        result["op"] = op;
+    }
+    if (job.isObject() && job.contains("id")) {
+        result["id"] = job["id"];
+    }
+    if (const std::size_t evicted = core::MemoryBudget::global().enforce()) {
+        result["evictedBytes"] = static_cast<std::uint64_t>(evicted);
+    }
+    result["seconds"] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    ++jobs_;
+    if (!result["ok"].asBool()) {
+        ++failures_;
+    }
+    return result;
+}
+
+Json Session::dispatch(const std::string& op, const Json& job) {
+    if (op == "import") {
+        return importStep(job);
+    } else if (op == "open") {
+        return openNative(job);
+    } else if (op == "tessellate") {
+        return tessellate(job);
+    } else if (op == "clash") {
+        return clash(job);
+    } else if (op == "export") {
+        return exportModel(job);
+    } else if (op == "close") {
+        return close(job);
+    } else if (op == "clear-library") {
+        return clearLibrary(job);
+    } else if (op == "status") {
+        return status();
+    } else if (op == "shutdown") {
+        finished_ = true;
+        return Json::object();
+    }
+    throw std::invalid_argument("unknown op \"" + op + "\"");
+}
+
+Json Session::importStep(const Json& job) {
+    const std::string input = requiredString(job, "input");
+    io::StepImportOptions options;
+    options.lengthScale = job.number("lengthScale", options.lengthScale);
+    Model& m = createModel(job);
+    const io::StepImportResult imported =
+        io::importStep(input, *m.assembly, m.assembly->root(), library(m.library), options);
+
+    Json result = Json::object();
+    result["entities"] = imported.entities;
+    result["products"] = imported.products;
+    result["parts"] = imported.parts;
+    result["occurrences"] = imported.occurrences;
+    result["triangles"] = imported.triangles;
+    result["unsupportedShapes"] = imported.unsupportedShapes;
+    result["warningCount"] = imported.warningCount;
+    Json warnings = Json::array();
+    for (std::size_t i = 0; i < imported.warnings.size() && i < kMaxReportedErrors; ++i) {
+        warnings.push(imported.warnings[i]);
+    }
+    result["warnings"] = std::move(warnings);
+    return result;
+}
+
+Json Session::openNative(const Json& job) {
+    const std::string input = requiredString(job, "input");
+    auto document = io::NativeDocument::open(input);
+    io::NativeLoadOptions options;
+    if (flag(job, "graphics", false)) {
+        options.detail = io::LoadDetail::Graphics;
+        options.lod = static_cast<std::uint32_t>(std::max(0.0, job.number("lod", 0.0)));
+    }
+    Model& m = createModel(job);
+    assembly::PartLibrary& lib = library(m.library);
+    const std::size_t known = lib.size();
+    document->loadAssembly(*m.assembly, lib, options);
+    m.document = std::move(document);
+    m.graphics = options.detail == io::LoadDetail::Graphics;
+
+    const assembly::AssemblyStats stats = m.assembly->stats();
+    Json result = Json::object();
+    result["occurrences"] = stats.occurrences;
+    result["parts"] = stats.uniqueParts;
+    result["partsLoaded"] = lib.size() - known;
+    return result;
+}
+
+Json Session::tessellate(const Json& job) {
+    Model& m = model(job);
+    if (!m.document) {
+        throw std::invalid_argument("model has no B-reps to tessellate");
+    }
+    brep::TessellationOptions options;
+    options.chordalTolerance = job.number("chordalTolerance", options.chordalTolerance);
+    options.angularTolerance = job.number("angularTolerance", options.angularTolerance);
+    options.maxSegments = static_cast<std::uint32_t>(job.number("maxSegments", options.maxSegments));
+    const double levels = job.number("levels", options.levelCount);
+    if (!(options.chordalTolerance > 0.0) || !(options.angularTolerance > 0.0) || !(levels >= 1.0) ||
+        options.maxSegments == 0) {
+        throw std::invalid_argument("tolerances, levels and maxSegments must be positive");
+    }
+    options.levelCount = static_cast<std::uint32_t>(levels);
+
+    assembly::PartLibrary& lib = library(m.library);
+    if (m.tessellated.empty()) {
+        for (const assembly::PartId id : partsOf(*m.assembly)) {
+            const std::string& name = lib.get(id)->name();
+            const std::uint32_t record = m.document->findPart(name);
+            if (record == io::NativeDocument::kNotFound || !m.document->partInfo(record).hasBody) {
+                continue;
+            }
+            feature::Parameters parameters;
+            parameters.set("body", hashBody(m.document->loadBody(record)).toHex());
+            TessellatedPart t;
+            t.part = id;
+            t.record = record;
+            t.levels.push_back(
+                m.features.add(name + "#0", std::make_shared<TessellateOp>(m.document, record), parameters));
+            m.tessellated.push_back(std::move(t));
+        }
+    }
+    for (TessellatedPart& t : m.tessellated) {
+        const std::string& name = lib.get(t.part)->name();
+        while (t.levels.size() < options.levelCount) {
+            const feature::FeatureId first = t.levels.front();
+            t.levels.push_back(m.features.add(name + "#" + std::to_string(t.levels.size()), m.features.op(first),
+                                              m.features.parameters(first)));
+        }
+        for (std::uint32_t l = 0; l < options.levelCount; ++l) {
+            m.features.setParameter(t.levels[l], "chordalTolerance", options.levelChordalTolerance(l));
+            m.features.setParameter(t.levels[l], "angularTolerance", options.levelAngularTolerance(l));
+            m.features.setParameter(t.levels[l], "maxSegments", std::int64_t(options.maxSegments));
+        }
+    }
+    m.levelCount = options.levelCount;
+    const feature::RegenerationStats stats = m.features.regenerate();
+    const std::size_t replaced = install(m);
+
+    std::size_t triangles = 0;
+    Json errors = Json::array();
+    for (const TessellatedPart& t : m.tessellated) {
+        for (std::uint32_t l = 0; l < m.levelCount; ++l) {
+            if (m.features.state(t.levels[l]) == feature::FeatureState::Failed) {
+                if (errors.asArray().size() < kMaxReportedErrors) {
+                    errors.push(lib.get(t.part)->name() + ": " + m.features.error(t.levels[l]));
+                }
+            }
+        }
+        if (t.installed) {
+            triangles += static_cast<const feature::MeshResult&>(*t.installed).mesh().triangleCount();
+        }
+    }
+
+    Json result = Json::object();
+    result["parts"] = m.tessellated.size();
+    result["levels"] = m.levelCount;
+    result["triangles"] = triangles;
+    result["visited"] = stats.visited;
+    result["evaluated"] = stats.evaluated;
+    result["reused"] = stats.reused;
+    result["cached"] = stats.cached;
+    result["failed"] = stats.failed;
+    result["replaced"] = replaced;
+    if (stats.failed > 0) {
+        result["ok"] = false;
+        result["error"] = std::to_string(stats.failed) + " tessellation features failed";
+        result["errors"] = std::move(errors);
+    }
+    return result;
+}
+
+Json Session::clash(const Json& job) {
+    Model& m = model(job);
+    install(m);
+    touch(m);
+    if (!m.index) {
+        m.index = std::make_unique<assembly::AssemblyIndex>(*m.assembly, library(m.library));
+    }
+    m.index->update();
+    assembly::ClashOptions options;
+    options.reportContacts = flag(job, "contacts", options.reportContacts);
+    assembly::ClashDetector detector(*m.index, options);
+    const std::vector<assembly::Clash>& clashes = detector.detectAll();
+
+    const auto limit = static_cast<std::size_t>(std::max(0.0, job.number("limit", 100.0)));
+    std::size_t interferences = 0;
+    Json pairs = Json::array();
+    for (const assembly::Clash& c : clashes) {
+        const bool interference = c.kind == assembly::ClashKind::Interference;
+        interferences += interference ? 1 : 0;
+        if (pairs.asArray().size() < limit) {
+            Json pair = Json::object();
+            pair["a"] = c.a;
+            pair["b"] = c.b;
+            if (!m.assembly->name(c.a).empty() || !m.assembly->name(c.b).empty()) {
+                pair["nameA"] = m.assembly->name(c.a);
+                pair["nameB"] = m.assembly->name(c.b);
+            }
+            pair["kind"] = interference ? "interference" : "contact";
+            pairs.push(std::move(pair));
+        }
+    }
+    Json result = Json::object();
+    result["occurrences"] = m.index->occurrenceCount();
+    result["candidatePairs"] = detector.stats().candidatePairs;
+    result["trianglePairs"] = detector.stats().trianglePairs;
+    result["interferences"] = interferences;
+    result["contacts"] = clashes.size() - interferences;
+    result["clashes"] = std::move(pairs);
+    return result;
+}
+
+Json Session::exportModel(const Json& job) {
+    Model& m = model(job);
+    const std::filesystem::path output = requiredString(job, "output");
+    if (output.extension() != ".rbl") {
+        return exportMeshes(m, job, output.string());
+    }
+    assembly::PartLibrary& lib = library(m.library);
+    if (m.features.needsRegeneration()) {
+        m.features.regenerate();
+    }
+    install(m);
+    touch(m);
+    std::vector<assembly::PartId> tessellated;
+    for (const TessellatedPart& t : m.tessellated) {
+        tessellated.push_back(t.part);
+    }
+    std::sort(tessellated.begin(), tessellated.end());
+
+    io::NativeWriter writer;
+    for (const TessellatedPart& t : m.tessellated) {
+        const assembly::PartPtr part = lib.get(t.part);
+        std::vector<assembly::PartPtr> lods;
+        for (std::uint32_t l = 1; l < m.levelCount; ++l) {
+            if (m.features.state(t.levels[l]) == feature::FeatureState::UpToDate) {
+                lods.push_back(partFromResult(part->name(), m.features.result(t.levels[l])));
+            }
+        }
+        const brep::Body body = m.document->loadBody(t.record);
+        writer.addPart(part, &body, std::move(lods));
+    }
+    std::size_t promoted = 0;
+    if (m.document) {
+        // Everything else keeps the B-rep and levels of detail it was stored
+        // with; parts opened as levels of detail are brought in full first,
+        // unless a model sharing the library has its tessellation installed.
+        const std::vector<assembly::PartId> installed = installedParts(m.library);
+        for (const assembly::PartId id : partsOf(*m.assembly)) {
+            const std::uint32_t record = m.document->findPart(lib.get(id)->name());
+            if (record == io::NativeDocument::kNotFound ||
+                std::binary_search(tessellated.begin(), tessellated.end(), id)) {
+                continue;
+            }
+            if (m.graphics && !std::binary_search(installed.begin(), installed.end(), id)) {
+                m.document->loadForEditing(record, lib);
+                ++promoted;
+            }
+            const io::NativePartInfo info = m.document->partInfo(record);
+            std::optional<brep::Body> body;
+            if (info.hasBody) {
+                body = m.document->loadBody(record);
+            }
+            std::vector<assembly::PartPtr> lods;
+            for (std::uint32_t l = 0; l < info.lodCount; ++l) {
+                lods.push_back(m.document->loadLod(record, l));
+            }
+            writer.addPart(lib.get(id), body ? &*body : nullptr, std::move(lods));
+        }
+        m.graphics = false;
+    }
+    writer.setAssembly(*m.assembly, lib);
+
+    // The output may be the mapped source, which must not be truncated
+    // under its readers: write next to it and rename over it.
+    std::filesystem::path staging = output;
+    staging += ".partial";
+    writer.write(staging.string());
+    std::filesystem::rename(staging, output);
+
+    Json result = Json::object();
+    result["output"] = output.string();
+    result["bytes"] = static_cast<std::uint64_t>(std::filesystem::file_size(output));
+    result["promoted"] = promoted;
+    return result;
+}
+
+Json Session::exportMeshes(Model& m, const Json& job, const std::string& output) {
+    io::MeshFormat format;
+    try {
+        format = io::meshFormatForPath(output);
+    } catch (const std::invalid_argument&) {
+        const std::string extension = std::filesystem::path(output).extension().string();
+        throw std::invalid_argument("unsupported export format \"" + extension + "\"");
+    }
+    assembly::PartLibrary& lib = library(m.library);
+    if (m.features.needsRegeneration()) {
+        m.features.regenerate();
+    }
+    install(m);
+    touch(m);
+    std::size_t promoted = 0;
+    if (m.graphics) {
+        // Tessellated parts, of this or any model sharing the library, are
+        // installed already; the rest come in full.
+        const std::vector<assembly::PartId> installed = installedParts(m.library);
+        for (const assembly::PartId id : partsOf(*m.assembly)) {
+            const std::uint32_t record = m.document->findPart(lib.get(id)->name());
+            if (record != io::NativeDocument::kNotFound &&
+                !std::binary_search(installed.begin(), installed.end(), id)) {
+                m.document->loadForEditing(record, lib);
+                ++promoted;
+            }
+        }
+        m.graphics = false;
+    }
+    io::MeshExportOptions options;
+    options.includeHidden = flag(job, "hidden", options.includeHidden);
+    options.zUp = flag(job, "zUp", options.zUp);
+    const io::MeshExportStats stats = io::exportMesh(*m.assembly, lib, output, format, options);
+
+    Json result = Json::object();
+    result["output"] = output;
+    result["bytes"] = stats.bytes;
+    result["occurrences"] = stats.occurrences;
+    result["meshes"] = stats.meshes;
+    result["triangles"] = stats.triangles;
+    result["promoted"] = promoted;
+    return result;
+}
+
+Json Session::close(const Json& job) {
+    const std::string name = requiredString(job, "model");
+    if (models_.erase(name) == 0) {
+        throw std::invalid_argument("no model \"" + name + "\"");
+    }
+    return Json::object();
+}
+
+Json Session::clearLibrary(const Json& job) {
+    const std::string name = job.string("library", "shared");
+    const auto it = libraries_.find(name);
+    if (it == libraries_.end()) {
+        throw std::invalid_argument("no library \"" + name + "\"");
+    }
+    for (const auto& [modelName, m] : models_) {
+        if (m->library == name) {
+            throw std::invalid_argument("library \"" + name + "\" is used by model \"" + modelName + "\"");
+        }
+    }
+    Json result = Json::object();
+    result["parts"] = it->second->size();
+    result["memoryBytes"] = it->second->memoryBytes();
+    libraries_.erase(it);
+    return result;
+}
+
+Json Session::status() const {
+    Json models = Json::object();
+    for (const auto& [name, m] : models_) {
+        const assembly::AssemblyStats stats = m->assembly->stats();
+        Json entry = Json::object();
+        entry["library"] = m->library;
+        entry["occurrences"] = stats.occurrences;
+        entry["parts"] = stats.uniqueParts;
+        entry["tessellatedParts"] = m->tessellated.size();
+        entry["features"] = m->features.size();
+        models[name] = std::move(entry);
+    }
+    Json libraries = Json::object();
+    for (const auto& [name, lib] : libraries_) {
+        Json entry = Json::object();
+        entry["parts"] = lib->size();
+        entry["memoryBytes"] = lib->memoryBytes();
+        libraries[name] = std::move(entry);
+    }
+    const feature::ResultCacheStats stats = cache_->stats();
+    Json cache = Json::object();
+    cache["memoryHits"] = stats.memoryHits;
+    cache["diskHits"] = stats.diskHits;
+    cache["misses"] = stats.misses;
+    cache["stores"] = stats.stores;
+    cache["corrupt"] = stats.corrupt;
+    cache["memoryBytes"] = stats.memoryBytes;
+
+    const core::MemoryBudgetStats budget = core::MemoryBudget::global().stats();
+    Json consumers = Json::object();
+    for (const core::MemoryUsage& u : core::MemoryBudget::global().usage()) {
+        consumers[u.name] = u.bytes;
+    }
+    Json memory = Json::object();
+    memory["limitBytes"] = budget.limitBytes;
+    memory["usedBytes"] = budget.usedBytes;
+    memory["overruns"] = budget.overruns;
+    memory["evictedBytes"] = budget.evictedBytes;
+    memory["consumers"] = std::move(consumers);
+
+    Json result = Json::object();
+    result["models"] = std::move(models);
+    result["libraries"] = std::move(libraries);
+    result["cache"] = std::move(cache);
+    result["memory"] = std::move(memory);
+    result["jobs"] = jobs_;
+    result["failures"] = failures_;
+    return result;
+}
+
+std::size_t Session::install(Model& m) {
+    assembly::PartLibrary& lib = library(m.library);
+    std::size_t replaced = 0;
+    for (TessellatedPart& t : m.tessellated) {
+        if (m.features.state(t.levels[0]) != feature::FeatureState::UpToDate) {
+            continue;
+        }
+        const feature::ResultPtr& finest = m.features.result(t.levels[0]);
+        if (finest != t.installed || lib.get(t.part) != t.installedPart) {
+            t.installedPart = partFromResult(lib.get(t.part)->name(), finest);
+            lib.replace(t.part, t.installedPart);
+            t.installed = finest;
+            ++replaced;
+        }
+        t.bytes = lib.get(t.part)->memoryBytes();
+        for (std::uint32_t l = 0; l < m.levelCount && l < t.levels.size(); ++l) {
+            if (const feature::ResultPtr& level = m.features.result(t.levels[l])) {
+                t.bytes += static_cast<const feature::MeshResult&>(*level).mesh().memoryBytes();
+            }
+        }
+        t.lastUse = core::MemoryBudget::stamp();
+    }
+    return replaced;
+}
+
+std::vector<assembly::PartId> Session::installedParts(const std::string& library) const {
+    std::vector<assembly::PartId> out;
+    for (const auto& [name, m] : models_) {
+        if (m->library != library) {
+            continue;
+        }
+        for (const TessellatedPart& t : m->tessellated) {
+            if (t.installed) {
+                out.push_back(t.part);
+            }
+        }
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return out;
+}
+
+void Session::touch(Model& m) {
+    // One stamp each, so the budget can evict part of a model.
+    for (TessellatedPart& t : m.tessellated) {
+        t.lastUse = core::MemoryBudget::stamp();
+    }
+}
+
+std::size_t Session::memoryBytes() const {
+    std::size_t bytes = 0;
+    for (const auto& [name, m] : models_) {
+        for (const TessellatedPart& t : m->tessellated) {
+            bytes += t.bytes;
+        }
+    }
+    return bytes;
+}
+
+void Session::evictionCandidates(std::vector<core::MemoryItem>& out) const {
+    for (const auto& [name, m] : models_) {
+        for (const TessellatedPart& t : m->tessellated) {
+            if (t.installed) {
+                out.push_back({t.lastUse, t.bytes});
+            }
+        }
+    }
+}
+
+std::size_t Session::evictOlderThan(std::uint64_t stamp) {
+    std::size_t freed = 0;
+    for (auto& [name, m] : models_) {
+        assembly::PartLibrary& lib = library(m->library);
+        for (TessellatedPart& t : m->tessellated) {
+            if (!t.installed || t.lastUse >= stamp) {
+                continue;
+            }
+            // Back to the finest level stored with the part, which is mapped
+            // rather than held.
+            lib.replace(t.part, m->document->loadLod(t.record, 0));
+            for (const feature::FeatureId level : t.levels) {
+                m->features.release(level);
+            }
+            t.installed.reset();
+            t.installedPart.reset();
+            freed += std::exchange(t.bytes, 0);
+        }
+    }
+    return freed;
+}
+
+Session::Model& Session::model(const Json& job) {
+    const std::string name = job.string("model", "default");
+    const auto it = models_.find(name);
+    if (it == models_.end()) {
+        throw std::invalid_argument("no model \"" + name + "\"");
+    }
+    return *it->second;
+}
+
+Session::Model& Session::createModel(const Json& job) {
+    auto m = std::make_unique<Model>();
+    m->library = job.string("library", "shared");
+    m->assembly = std::make_unique<assembly::Assembly>();
+    m->features.setCache(cache_);
+    library(m->library);
+    std::unique_ptr<Model>& slot = models_[job.string("model", "default")];
+    slot = std::move(m);
+    return *slot;
+}
+
+assembly::PartLibrary& Session::library(const std::string& name) {
+    std::unique_ptr<assembly::PartLibrary>& slot = libraries_[name];
+    if (!slot) {
+        slot = std::make_unique<assembly::PartLibrary>();
+    }
+    return *slot;
+}
+
+} // namespace rebel::cli
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "rebel/assembly/AssemblyIndex.hpp"
+#include "rebel/core/Json.hpp"
+#include "rebel/core/MemoryBudget.hpp"
+#include "rebel/feature/FeatureGraph.hpp"
+#include "rebel/feature/ResultCache.hpp"
+#include "rebel/io/NativeFile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace rebel::cli {
+
+struct SessionOptions {
+    /// Persistent tier of the result cache, shared with other processes and
+    /// machines; empty keeps results in memory only.
+    std::string cacheDirectory;
+    std::size_t cacheMemoryBytes = std::size_t(512) << 20;
+};
+
+/// Headless job runner: jobs are JSON objects naming an `op`, results JSON
+/// objects echoing the job's `id`.
+///
+/// Everything a job loads stays for the next one: models by name, the part
+/// libraries they share (parts are matched by name across models, like the
+/// loaders do, unless a job picks its own `library`), each model's
+/// tessellation features and spatial index, and one result cache, so a
+/// server working through a queue of assemblies keeps its common parts and
+/// tessellations warm.
+///
+/// Ops:
+/// - `import`  STEP file `input` into model `model` (`lengthScale`).
+/// - `open`    native file `input` into `model` (`graphics`, `lod`).
+/// - `tessellate`  every part with a B-rep (`chordalTolerance`,
+///   `angularTolerance`, `levels`). Each level of each part is a feature
+///   of the model's feature graph, so a repeated job regenerates only what
+///   its parameters changed, and results come from the cache where any
+///   session computed them before.
+/// - `clash`   interference check of `model` (`contacts`, `limit`).
+/// - `export`  `model` to `output`: a native file (`.rbl`), or meshes for
+///   review and printing (`.glb`, `.3mf`, `.stl`; `hidden`, `zUp`).
+/// - `close`   drops `model`; `clear-library` drops an unused `library`.
+/// - `status`  models, libraries, cache and memory counters.
+/// - `shutdown` ends a server loop.
+///
+/// Tessellations and the result cache count against
+/// `core::MemoryBudget::global()`, enforced after every job: the parts
+/// least recently used by a job go back to the levels of detail stored in
+/// their native file, and come back from the cache or a re-tessellation
+/// when a job needs them again.
+class Session final : private core::MemoryConsumer {
+public:
+    explicit Session(SessionOptions options = {});
+    ~Session() override;
+
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+
+    /// Runs one job. Failures come back as `{"ok": false, "error": ...}`
+    /// rather than as exceptions, so one bad job never stops a batch.
+    core::Json run(const core::Json& job);
+
+    /// A `shutdown` job was run.
+    bool finished() const { return finished_; }
+
+private:
+    /// Tessellation features of one part: one per level, finest first.
+    struct TessellatedPart {
+        assembly::PartId part = assembly::kInvalidPart;
+        /// Part record in the model's document, which holds the B-rep.
+        std::uint32_t record = 0;
+        std::vector<feature::FeatureId> levels;
+        /// Level 0 result the library part was made from; null while the
+        /// library has the stored part instead.
+        feature::ResultPtr installed;
+        /// Library part made from `installed`, to notice when another model
+        /// sharing the library replaced it.
+        assembly::PartPtr installedPart;
+        /// Bytes of the installed levels, and the last job using them.
+        std::size_t bytes = 0;
+        std::uint64_t lastUse = 0;
+    };
+
+    struct Model {
+        std::string library;
+        std::unique_ptr<assembly::Assembly> assembly;
+        /// Source of native models, for B-reps and stored levels of detail.
+        std::shared_ptr<const io::NativeDocument> document;
+        /// Opened with levels of detail only; full parts are loaded on export.
+        bool graphics = false;
+        std::unique_ptr<assembly::AssemblyIndex> index;
+        feature::FeatureGraph features;
+        std::vector<TessellatedPart> tessellated;
+        /// Levels the last `tessellate` job asked for.
+        std::uint32_t levelCount = 0;
+    };
+
+    std::string_view memoryName() const override { return "cli.tessellations"; }
+    std::size_t memoryBytes() const override;
+    void evictionCandidates(std::vector<core::MemoryItem>& out) const override;
+    std::size_t evictOlderThan(std::uint64_t stamp) override;
+
+    core::Json dispatch(const std::string& op, const core::Json& job);
+    core::Json importStep(const core::Json& job);
+    core::Json openNative(const core::Json& job);
+    core::Json tessellate(const core::Json& job);
+    core::Json clash(const core::Json& job);
+    core::Json exportModel(const core::Json& job);
+    core::Json exportMeshes(Model& m, const core::Json& job, const std::string& output);
+    core::Json close(const core::Json& job);
+    core::Json clearLibrary(const core::Json& job);
+    core::Json status() const;
+
+    /// Makes level 0 of every regenerated tessellated part its library part
+    /// again wherever the library holds something else (after eviction, or
+    /// another model sharing the library); returns the parts replaced.
+    std::size_t install(Model& m);
+    /// Parts of `library` any model has a tessellation installed for,
+    /// sorted; promoting stored parts must leave them alone.
+    std::vector<assembly::PartId> installedParts(const std::string& library) const;
+    void touch(Model& m);
+
+    Model& model(const core::Json& job);
+    /// New empty model named by the job, replacing any of the same name.
+    Model& createModel(const core::Json& job);
+    assembly::PartLibrary& library(const std::string& name);
+
+    std::map<std::string, std::unique_ptr<assembly::PartLibrary>, std::less<>> libraries_;
+    std::map<std::string, std::unique_ptr<Model>, std::less<>> models_;
+    std::shared_ptr<feature::ResultCache> cache_;
+    std::size_t jobs_ = 0;
+    std::size_t failures_ = 0;
+    bool finished_ = false;
+};
+
+} // namespace rebel::cli
@@ -0,0 +1,188 @@
+#include "Session.hpp"
+
+#include "rebel/core/MemoryBudget.hpp"
+#include "rebel/core/TaskScheduler.hpp"
+#include "rebel/io/ResourceBundle.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+void usage() {
+    std::fprintf(stderr,
+                 "usage: rebelcad-cli [options] run FILE...\n"
+                 "       rebelcad-cli [options] serve\n"
+                 "       rebelcad-cli bundle OUTPUT PATH...\n"
+                 "  run FILE...            run the jobs in each FILE ('-' for stdin): a JSON array of\n"
+                 "                         jobs, a single job, or one job per line\n"
+                 "  serve                  read one job per line from stdin and answer each on stdout\n"
+                 "                         until end of input or a shutdown job\n"
+                 "  bundle OUTPUT PATH...  precompile files, and every file below directories, into the\n"
+                 "                         resource bundle OUTPUT, each named by its path as given\n"
+                 "  --threads N            worker threads (default: hardware)\n"
+                 "  --cache-dir DIR        persistent result cache, shareable between processes\n"
+                 "  --cache-memory MB      in-memory result cache size (default 512)\n"
+                 "  --memory-budget MB     evict least recently used data beyond this (default: none)\n");
+}
+
+/// Jobs of a batch file: an array, a single object, or JSON lines.
+std::vector<rebel::core::Json> readJobs(const std::string& text) {
+    using rebel::core::Json;
+    try {
+        Json all = Json::parse(text);
+        if (all.isArray()) {
+            return all.asArray();
+        }
+        return {std::move(all)};
+    } catch (const std::exception&) {
+        // Not one document; fall through to one job per line.
+    }
+    std::vector<Json> jobs;
+    std::stringstream in(text);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.find_first_not_of(" \t\r") != std::string::npos) {
+            jobs.push_back(Json::parse(line));
+        }
+    }
+    return jobs;
+}
+
+/// Precompiles a resource bundle, so startup maps one file instead of
+/// reading and parsing many.
+int bundle(const std::vector<std::string>& args) {
+    namespace fs = std::filesystem;
+    rebel::io::ResourceBundleWriter writer;
+    try {
+        for (std::size_t i = 1; i < args.size(); ++i) {
+            if (!fs::is_directory(args[i])) {
+                writer.addFile(fs::path(args[i]).generic_string(), args[i]);
+                continue;
+            }
+            for (const fs::directory_entry& entry : fs::recursive_directory_iterator(args[i])) {
+                if (entry.is_regular_file()) {
+                    writer.addFile(entry.path().generic_string(), entry.path().string());
+                }
+            }
+        }
+        writer.write(args[0]);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    std::fprintf(stderr, "%zu resources written to %s\n", writer.size(), args[0].c_str());
+    return 0;
+}
+
+void answer(const rebel::core::Json& result) {
+    std::cout << result.dump() << '\n' << std::flush;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    using namespace rebel;
+    cli::SessionOptions options;
+    std::string mode;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                usage();
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+        if (!mode.empty()) {
+            files.push_back(arg);
+        } else if (arg == "--threads") {
+            const long n = std::strtol(value().c_str(), nullptr, 10);
+            if (n > 0) {
+                core::TaskScheduler::setGlobalThreadCount(static_cast<unsigned>(n));
+            }
+        } else if (arg == "--cache-dir") {
+            options.cacheDirectory = value();
+        } else if (arg == "--cache-memory") {
+            options.cacheMemoryBytes = static_cast<std::size_t>(std::strtoull(value().c_str(), nullptr, 10)) << 20;
+        } else if (arg == "--memory-budget") {
+            core::MemoryBudget::global().setLimit(static_cast<std::size_t>(std::strtoull(value().c_str(), nullptr, 10))
+                                                  << 20);
+        } else if (arg == "run" || arg == "serve" || arg == "bundle") {
+            mode = arg;
+        } else {
+            usage();
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+    if (mode.empty() || (mode == "serve") != files.empty() || (mode == "bundle" && files.size() < 2)) {
+        usage();
+        return 1;
+    }
+    if (mode == "bundle") {
+        return bundle(files);
+    }
+
+    cli::Session session(std::move(options));
+    if (mode == "serve") {
+        // One line in, one line out, so a driver can pipeline jobs and match
+        // answers by order or by `id`.
+        std::string line;
+        while (!session.finished() && std::getline(std::cin, line)) {
+            if (line.find_first_not_of(" \t\r") == std::string::npos) {
+                continue;
+            }
+            core::Json job;
+            try {
+                job = core::Json::parse(line);
+            } catch (const std::exception& e) {
+                core::Json result = core::Json::object();
+                result["ok"] = false;
+                result["error"] = std::string(e.what());
+                answer(result);
+                continue;
+            }
+            answer(session.run(job));
+        }
+        return 0;
+    }
+
+    bool failed = false;
+    for (const std::string& path : files) {
+        std::stringstream text;
+        if (path == "-") {
+            text << std::cin.rdbuf();
+        } else {
+            std::ifstream in(path);
+            if (!in) {
+                std::fprintf(stderr, "cannot read %s\n", path.c_str());
+                return 1;
+            }
+            text << in.rdbuf();
+        }
+        std::vector<core::Json> jobs;
+        try {
+            jobs = readJobs(text.str());
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "%s: %s\n", path.c_str(), e.what());
+            return 1;
+        }
+        for (const core::Json& job : jobs) {
+            const core::Json result = session.run(job);
+            answer(result);
+            failed = failed || !result["ok"].asBool();
+            if (session.finished()) {
+                return failed ? 1 : 0;
+            }
+        }
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,207 @@
+#pragma once
+
+#include "rebel/assembly/Part.hpp"
+#include "rebel/core/PersistentVector.hpp"
+#include "rebel/math/Mat4.hpp"
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace rebel::assembly {
+
+using NodeId = std::uint32_t;
+inline constexpr NodeId kInvalidNode = 0xFFFFFFFFu;
+
+/// Per-occurrence overrides. Geometry is never overridden per occurrence;
+/// only presentation and state are.
+struct Overrides {
+    enum Flags : std::uint8_t {
+        kHidden = 1u << 0,
+        kSuppressed = 1u << 1,
+        kHasColor = 1u << 2,
+    };
+
+    std::uint32_t colorRgba = 0;
+    std::uint8_t flags = 0;
+
+    bool hidden() const { return (flags & kHidden) != 0; }
+    bool suppressed() const { return (flags & kSuppressed) != 0; }
+    bool hasColor() const { return (flags & kHasColor) != 0; }
+
+    bool operator==(const Overrides& other) const { return flags == other.flags && colorRgba == other.colorRgba; }
+    bool operator!=(const Overrides& other) const { return !(*this == other); }
+};
+
+/// One record of the assembly tree: either a part occurrence (`part` set)
+/// or a subassembly grouping node (`part == kInvalidPart`).
+struct AssemblyNode {
+    math::Mat4f local;
+    PartId part = kInvalidPart;
+    NodeId parent = kInvalidNode;
+    NodeId firstChild = kInvalidNode;
+    NodeId nextSibling = kInvalidNode;
+    Overrides overrides;
+    bool removed = false;
+
+    bool isOccurrence() const { return part != kInvalidPart; }
+};
+
+/// A part occurrence resolved to world space.
+struct Occurrence {
+    NodeId node = kInvalidNode;
+    PartId part = kInvalidPart;
+    math::Mat4f world;
+};
+
+struct AssemblyStats {
+    std::size_t occurrences = 0;
+    std::size_t subassemblies = 0;
+    std::size_t uniqueParts = 0;
+    /// Bytes of the tree itself (records, names, change log).
+    std::size_t recordBytes = 0;
+};
+
+/// Assembly structure as a tree of lightweight instance records that refer
+/// to shared, immutable parts by id. Memory and load time scale with the
+/// number of occurrences only through these fixed-size records; geometry
+/// scales with the number of unique parts.
+///
+/// Transform and override edits are recorded in a change log keyed by a
+/// monotonically increasing revision, so spatial indices, scenes and checks
+/// downstream can update only what changed.
+///
+/// Records, names and the change log are persistent vectors, so copying an
+/// assembly is an O(1) snapshot that shares everything with the original,
+/// and each later edit copies only the few records on its path. Snapshots
+/// serve undo and redo (see `AssemblyHistory`) and give background work
+/// (saving, clash checks, tessellation) a consistent version to read while
+/// the original keeps being edited; take them on the editing thread.
+class Assembly {
+public:
+    Assembly();
+
+    NodeId root() const { return 0; }
+    std::size_t nodeCount() const { return nodes_.size(); }
+    const AssemblyNode& node(NodeId id) const { return nodes_[id]; }
+
+    NodeId addSubassembly(NodeId parent, const math::Mat4f& local, std::string name = {});
+    NodeId addOccurrence(NodeId parent, PartId part, const math::Mat4f& local, std::string name = {});
+
+    /// Detaches `id` and its subtree. Ids are not reused.
+    void remove(NodeId id);
+
+    void setLocalTransform(NodeId id, const math::Mat4f& local);
+    void setOverrides(NodeId id, const Overrides& overrides);
+
+    const std::string& name(NodeId id) const;
+
+    math::Mat4f worldTransform(NodeId id) const;
+
+    /// Calls `fn(const Occurrence&)` for every live occurrence in depth-first
+    /// order. Suppressed nodes (and their subtrees) are skipped.
+    template <typename Fn>
+    void forEachOccurrence(Fn&& fn) const;
+
+    std::vector<Occurrence> occurrences() const;
+
+    /// Occurrence nodes in the subtree of `id` (including `id` itself).
+    void collectOccurrences(NodeId id, std::vector<NodeId>& out) const;
+
+    /// Current revision; every structural, transform or override edit
+    /// increments it.
+    std::uint64_t revision() const { return revision_; }
+
+    /// Nodes whose local transform or overrides changed after `revision`,
+    /// possibly with duplicates. Descendants of a listed node moved too, or
+    /// inherit the change (hidden).
+    void changedSince(std::uint64_t revision, std::vector<NodeId>& out) const;
+
+    /// True if nodes were added or removed after `revision`.
+    bool structureChangedSince(std::uint64_t revision) const { return structureRevision_ > revision; }
+
+    /// Makes the tree that of `snapshot`, a copy of this assembly taken
+    /// earlier or later, as one edit: the revision moves forward, nodes
+    /// whose transform or overrides differ are reported by `changedSince()`
+    /// and other differences (suppression included) as a structure change,
+    /// so spatial indices and scenes
+    /// update incrementally. Unchanged records are found without being
+    /// read, so the cost follows the size of the difference. Ids are not
+    /// reused: nodes the snapshot does not have are kept, removed.
+    void restore(const Assembly& snapshot);
+
+    /// Calls `fn(id, const AssemblyNode& mine, const AssemblyNode* theirs)`
+    /// for every node whose record may differ from the one in `snapshot`,
+    /// an earlier copy of this assembly; `theirs` is null for nodes added
+    /// since. Records still shared with the snapshot are skipped unread, so
+    /// the cost follows the number of edited records. Throws
+    /// `std::invalid_argument` if `snapshot` has more nodes.
+    template <typename Fn>
+    void forEachDifference(const Assembly& snapshot, Fn&& fn) const;
+
+    AssemblyStats stats() const;
+
+    /// Bytes of the tree (records, names, change log). With `seen`, memory
+    /// in it is skipped and then added, so the sum over snapshots counts
+    /// shared records once.
+    std::size_t recordBytes(std::unordered_set<const void*>* seen = nullptr) const;
+
+private:
+    NodeId addNode(NodeId parent, PartId part, const math::Mat4f& local, std::string name);
+
+    struct Change {
+        std::uint64_t revision;
+        NodeId node;
+    };
+
+    core::PersistentVector<AssemblyNode> nodes_;
+    /// Names are optional and sparse, so they live outside the records;
+    /// leaves without a name are never allocated.
+    core::PersistentVector<std::string> names_;
+    core::PersistentVector<Change> changes_;
+    std::uint64_t revision_ = 0;
+    std::uint64_t structureRevision_ = 0;
+};
+
+template <typename Fn>
+void Assembly::forEachOccurrence(Fn&& fn) const {
+    struct Frame {
+        NodeId node;
+        math::Mat4f world;
+    };
+    std::vector<Frame> stack;
+    stack.push_back({root(), nodes_[root()].local});
+    while (!stack.empty()) {
+        const Frame frame = stack.back();
+        stack.pop_back();
+        const AssemblyNode& n = nodes_[frame.node];
+        if (n.overrides.suppressed()) {
+            continue;
+        }
+        if (n.isOccurrence()) {
+            fn(Occurrence{frame.node, n.part, frame.world});
+        }
+        for (NodeId c = n.firstChild; c != kInvalidNode; c = nodes_[c].nextSibling) {
+            stack.push_back({c, frame.world * nodes_[c].local});
+        }
+    }
+}
+
+template <typename Fn>
+void Assembly::forEachDifference(const Assembly& snapshot, Fn&& fn) const {
+    if (snapshot.nodes_.size() > nodes_.size()) {
+        throw std::invalid_argument("snapshot has nodes this assembly does not have");
+    }
+    // Growing the snapshot's records to our size adds levels above its root
+    // and shares everything below, so subtrees we never edited still match.
+    core::PersistentVector<AssemblyNode> theirs = snapshot.nodes_;
+    theirs.extend(nodes_.size());
+    const std::size_t known = snapshot.nodes_.size();
+    nodes_.forEachDifference(theirs, [&](std::size_t i, const AssemblyNode& mine, const AssemblyNode& old) {
+        fn(static_cast<NodeId>(i), mine, i < known ? &old : nullptr);
+    });
+}
+
+} // namespace rebel::assembly
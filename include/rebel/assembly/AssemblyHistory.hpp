@@ -0,0 +1,60 @@
+#pragma once
+
+#include "rebel/assembly/Assembly.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace rebel::assembly {
+
+/// Undo and redo for an assembly, as a list of snapshots. A snapshot is an
+/// O(1) copy sharing its records with the assembly and the other steps, so
+/// a step costs the records its edits touched, not the size of the tree.
+///
+/// Edit the assembly, then `commit()` the edits as one step. `undo()` and
+/// `redo()` move between steps with `Assembly::restore()`, so indices and
+/// scenes over the assembly update incrementally; edits not committed yet
+/// are discarded by them. The assembly must outlive the history.
+class AssemblyHistory {
+public:
+    /// Records the current state of `assembly` as the first step. At most
+    /// `limit` steps are kept; the oldest are dropped beyond that.
+    explicit AssemblyHistory(Assembly& assembly, std::size_t limit = 256);
+
+    /// Records the current state as a step after the current one, dropping
+    /// the steps that could have been redone.
+    void commit(std::string label);
+
+    bool canUndo() const { return current_ > 0; }
+    bool canRedo() const { return current_ + 1 < steps_.size(); }
+    /// Label of the step `undo()` reverts, and of the one `redo()` applies.
+    const std::string& undoLabel() const;
+    const std::string& redoLabel() const;
+
+    /// Returns to the previous step; false if there is none.
+    bool undo();
+    /// Returns to the next step; false if there is none.
+    bool redo();
+
+    /// The current step, for a background reader (save, clash check,
+    /// tessellation) to copy and keep while editing goes on.
+    const Assembly& committed() const { return steps_[current_].state; }
+
+    std::size_t stepCount() const { return steps_.size(); }
+    /// Bytes held by all steps, records shared between them counted once.
+    std::size_t memoryBytes() const;
+
+private:
+    struct Step {
+        Assembly state;
+        std::string label;
+    };
+
+    Assembly& assembly_;
+    std::size_t limit_;
+    std::vector<Step> steps_;
+    std::size_t current_ = 0;
+};
+
+} // namespace rebel::assembly
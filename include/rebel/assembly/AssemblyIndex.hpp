@@ -0,0 +1,66 @@
+#pragma once
+
+#include "rebel/assembly/Assembly.hpp"
+#include "rebel/assembly/PartLibrary.hpp"
+#include "rebel/spatial/TwoLevelBvh.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace rebel::assembly {
+
+struct AssemblyHit {
+    NodeId node = kInvalidNode;
+    std::uint32_t triangle = geometry::kInvalidIndex;
+    float t = std::numeric_limits<float>::infinity();
+
+    bool hit() const { return node != kInvalidNode; }
+};
+
+/// Two-level spatial index over an assembly's occurrences. Each occurrence
+/// is one top-level instance pointing at its part's shared triangle BVH.
+///
+/// `update()` reads the assembly's change log and only re-transforms the
+/// occurrences below changed nodes; structure edits trigger a rebuild. Parts
+/// replaced in the library are swapped into their instances in place.
+class AssemblyIndex {
+public:
+    AssemblyIndex(const Assembly& assembly, const PartLibrary& library);
+
+    /// Brings the index in line with the assembly and library. Returns the
+    /// occurrence nodes whose world transform, overrides or part geometry
+    /// changed (all of them after a rebuild).
+    const std::vector<NodeId>& update();
+
+    const spatial::TwoLevelBvh& bvh() const { return bvh_; }
+    std::size_t occurrenceCount() const { return nodes_.size(); }
+
+    /// Occurrence node for a top-level instance, and back.
+    NodeId node(spatial::InstanceId instance) const { return nodes_[instance]; }
+    spatial::InstanceId instance(NodeId node) const;
+    PartId part(spatial::InstanceId instance) const { return parts_[instance]; }
+    /// Part definition the instance was indexed with.
+    const Part& definition(spatial::InstanceId instance) const { return *retained_.at(parts_[instance]); }
+    const PartPtr& sharedDefinition(spatial::InstanceId instance) const { return retained_.at(parts_[instance]); }
+
+    AssemblyHit raycast(const math::Ray& ray) const;
+
+private:
+    void rebuild();
+
+    const Assembly& assembly_;
+    const PartLibrary& library_;
+    spatial::TwoLevelBvh bvh_;
+    std::vector<NodeId> nodes_;
+    std::vector<PartId> parts_;
+    /// Keeps every referenced part (and thus its BVH) alive while indexed.
+    std::unordered_map<PartId, PartPtr> retained_;
+    std::unordered_map<NodeId, spatial::InstanceId> instanceOf_;
+    std::uint64_t revision_ = 0;
+    std::uint64_t libraryRevision_ = 0;
+    bool built_ = false;
+    std::vector<NodeId> moved_;
+};
+
+} // namespace rebel::assembly
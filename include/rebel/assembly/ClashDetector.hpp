@@ -0,0 +1,78 @@
+#pragma once
+
+#include "rebel/assembly/AssemblyIndex.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace rebel::assembly {
+
+enum class ClashKind {
+    /// The surfaces of the two occurrences pass through each other.
+    Interference,
+    /// They only touch: shared faces, edges or vertices, no penetration.
+    Contact,
+};
+
+struct Clash {
+    /// Occurrence nodes, `a < b`.
+    NodeId a = kInvalidNode;
+    NodeId b = kInvalidNode;
+    ClashKind kind = ClashKind::Interference;
+    /// One witness triangle pair, as part triangle indices.
+    std::uint32_t triangleA = geometry::kInvalidIndex;
+    std::uint32_t triangleB = geometry::kInvalidIndex;
+};
+
+struct ClashOptions {
+    /// Also report touching pairs, which assemblies have by design wherever
+    /// faces are mated.
+    bool reportContacts = false;
+};
+
+struct ClashStats {
+    /// Occurrence pairs whose world boxes overlap (broad phase output).
+    std::size_t candidatePairs = 0;
+    /// Triangle pairs given to the exact test (narrow phase work).
+    std::size_t trianglePairs = 0;
+};
+
+/// Interference checks between the occurrences of an `AssemblyIndex`.
+///
+/// The broad phase is a simultaneous self-traversal of the index's top
+/// level, yielding every pair of occurrences whose world boxes overlap. In
+/// the narrow phase each pair descends both parts' triangle BVHs together,
+/// one box brought into the other's frame, and meets its leaf triangles with
+/// the exact triangle predicate; pairs are spread over the task scheduler.
+/// The test works on the tessellated surfaces, so one part entirely inside
+/// another without their surfaces meeting is not a clash.
+///
+/// `update()` re-checks only pairs involving occurrences that moved and
+/// keeps every other result, which is what interactive dragging needs.
+/// The index must be brought up to date first; its `update()` result is
+/// exactly what to pass in.
+class ClashDetector {
+public:
+    explicit ClashDetector(const AssemblyIndex& index, ClashOptions options = {});
+
+    /// Checks every pair from scratch.
+    const std::vector<Clash>& detectAll();
+
+    /// Re-checks the pairs involving `moved` occurrences. After an index
+    /// rebuild (when `moved` is every occurrence) this is `detectAll()`.
+    const std::vector<Clash>& update(const std::vector<NodeId>& moved);
+
+    /// Current results sorted by `(a, b)`.
+    const std::vector<Clash>& clashes() const { return clashes_; }
+    /// Work done by the last `detectAll()` or `update()`.
+    const ClashStats& stats() const { return stats_; }
+
+private:
+    const AssemblyIndex& index_;
+    ClashOptions options_;
+    std::vector<Clash> clashes_;
+    ClashStats stats_;
+};
+
+} // namespace rebel::assembly
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "rebel/assembly/AssemblyIndex.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace rebel::assembly {
+
+struct DistanceOptions {
+    /// Approximate mode: a reported distance may exceed the true minimum by
+    /// `absoluteTolerance` plus `relativeTolerance` times the minimum, and
+    /// the search skips every branch that could not beat that. Both zero
+    /// (the default) is exact.
+    double absoluteTolerance = 0.0;
+    double relativeTolerance = 0.0;
+    /// Pairs farther apart are not measured but come back at infinity,
+    /// usually after looking at their root boxes only.
+    double maxDistance = std::numeric_limits<double>::infinity();
+};
+
+struct DistanceResult {
+    /// Occurrence nodes, `a < b`.
+    NodeId a = kInvalidNode;
+    NodeId b = kInvalidNode;
+    /// Minimum distance between the tessellated surfaces: 0 where they touch
+    /// or pass through each other, infinity beyond `maxDistance` or for an
+    /// empty part.
+    double distance = std::numeric_limits<double>::infinity();
+    /// Closest points in world space, on `a` and on `b`.
+    math::Vec3d pointA;
+    math::Vec3d pointB;
+    /// Part triangles carrying them.
+    std::uint32_t triangleA = geometry::kInvalidIndex;
+    std::uint32_t triangleB = geometry::kInvalidIndex;
+};
+
+struct DistanceStats {
+    /// Occurrence pairs measured.
+    std::size_t pairs = 0;
+    /// BVH node pairs taken off the search queues.
+    std::size_t nodePairs = 0;
+    /// Triangle pairs measured.
+    std::size_t trianglePairs = 0;
+};
+
+/// Minimum distance and clearance queries between the occurrences of an
+/// `AssemblyIndex`.
+///
+/// Each pair is a branch-and-bound search over both parts' triangle BVHs,
+/// in the first part's frame: node pairs come off a queue nearest box gap
+/// first, the gap scaled by the least stretch of the occurrence transform
+/// so it bounds the world distance, and the search ends once no remaining
+/// gap can beat the best triangle pair, or at the first contact. Leaf
+/// triangles are measured in world space in double precision. Pairs are
+/// spread over the task scheduler.
+///
+/// Like `ClashDetector`, this works on the tessellated surfaces: a part
+/// entirely inside another is at the distance between their surfaces.
+class DistanceQuery {
+public:
+    explicit DistanceQuery(const AssemblyIndex& index, DistanceOptions options = {});
+
+    /// Distance between two occurrences. Throws `std::invalid_argument` if
+    /// either is not an occurrence of the index.
+    DistanceResult distance(NodeId a, NodeId b);
+    /// Distances of many pairs, in input order.
+    std::vector<DistanceResult> distances(const std::vector<std::pair<NodeId, NodeId>>& pairs);
+
+    /// Every pair of occurrences closer than `clearance`, sorted by
+    /// `(a, b)`: candidates are the pairs whose world boxes come within
+    /// `clearance`, and each search starts with `clearance` as its bound.
+    std::vector<DistanceResult> closerThan(double clearance);
+
+    /// Work done by the last query.
+    const DistanceStats& stats() const { return stats_; }
+
+private:
+    const AssemblyIndex& index_;
+    DistanceOptions options_;
+    DistanceStats stats_;
+};
+
+} // namespace rebel::assembly
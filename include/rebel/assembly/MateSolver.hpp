@@ -0,0 +1,133 @@
+#pragma once
+
+#include "rebel/assembly/Assembly.hpp"
+#include "rebel/math/Mat4.hpp"
+#include "rebel/math/Vec.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace rebel::assembly {
+
+using MateId = std::uint32_t;
+
+enum class MateType {
+    /// Points coincide.
+    Coincident,
+    /// Points are `value` apart.
+    Distance,
+    /// Directions are parallel (or anti-parallel).
+    Parallel,
+    /// Planes through the points with the directions as normals coincide,
+    /// offset by `value` along `a`'s normal; normals parallel.
+    Planar,
+    /// Axes through the points along the directions coincide.
+    Concentric,
+    /// The two nodes keep their current relative placement.
+    Lock,
+};
+
+/// Point and direction in the local frame of `node`, i.e. in the frame its
+/// world transform maps to world space.
+struct MateReference {
+    NodeId node = kInvalidNode;
+    math::Vec3d point;
+    math::Vec3d direction{0.0, 0.0, 1.0};
+};
+
+struct Mate {
+    MateType type = MateType::Coincident;
+    MateReference a;
+    MateReference b;
+    double value = 0.0;
+};
+
+struct MateSolveOptions {
+    std::uint32_t maxIterations = 50;
+    /// Converged once no residual exceeds this (model units; radians for
+    /// direction residuals).
+    double tolerance = 1e-9;
+    /// Conjugate-gradient iterations per step, as a multiple of the
+    /// unknowns (capped at 500).
+    double linearIterationFactor = 2.0;
+};
+
+struct MateSolveResult {
+    bool converged = true;
+    /// Free rigid clusters solved for, i.e. bodies after merging locked
+    /// ones.
+    std::size_t clusters = 0;
+    /// Independent components solved in parallel.
+    std::size_t components = 0;
+    /// Most iterations any component took.
+    std::size_t iterations = 0;
+    /// Largest remaining residual.
+    double residual = 0.0;
+};
+
+/// Positions assembly nodes so that their mates hold.
+///
+/// Locked nodes are first merged into rigid clusters, each one body with
+/// six unknowns. Mates then connect clusters into a graph whose connected
+/// components, once fixed nodes are cut out of it, share no unknown; each
+/// component is solved on its own task with Levenberg-Marquardt. Jacobians
+/// are stored sparsely, one row per residual with at most two six-column
+/// blocks, and each step solves the damped normal equations by
+/// block-Jacobi preconditioned conjugate gradients without ever forming
+/// them, so a component with thousands of mates costs a few sparse
+/// products per iteration instead of a dense factorization.
+///
+/// Solves start from the previous solution. `drag()` holds one node at a
+/// target placement and re-solves only the components that reach it, so a
+/// drag through a large assembly moves only what is attached to the
+/// dragged node.
+class MateSolver {
+public:
+    explicit MateSolver(Assembly& assembly);
+
+    /// Directions are normalized; throws `std::invalid_argument` for a zero
+    /// direction, an unknown node or a mate of a node with itself.
+    MateId addMate(const Mate& mate);
+    /// Throws `std::out_of_range` for an unknown id.
+    void removeMate(MateId id);
+    const Mate& mate(MateId id) const;
+    std::size_t mateCount() const { return mateCount_; }
+
+    /// Fixed nodes keep their placement; everything is solved relative to
+    /// them. With no fixed node a component moves as little as it can.
+    void setFixed(NodeId node, bool fixed = true);
+    bool isFixed(NodeId node) const { return fixed_.count(node) != 0; }
+
+    /// Solves every component and writes the new local transforms.
+    MateSolveResult solve(const MateSolveOptions& options = {});
+
+    /// Moves `node` to the world placement `world` and re-solves only the
+    /// components attached to it, with `node` (and anything locked to it)
+    /// held there.
+    MateSolveResult drag(NodeId node, const math::Mat4f& world, const MateSolveOptions& options = {});
+
+private:
+    struct CachedPose {
+        double rotation[9] = {};
+        math::Vec3d translation;
+        /// World transform written from it; anything else in the assembly
+        /// means the node was moved by someone else since.
+        math::Mat4f written;
+    };
+
+    MateSolveResult run(NodeId dragged, const math::Mat4f& target, const MateSolveOptions& options);
+
+    Assembly& assembly_;
+    std::vector<Mate> mates_;
+    std::vector<char> active_;
+    std::size_t mateCount_ = 0;
+    std::unordered_set<NodeId> fixed_;
+    /// Last solution in double precision, reused while the assembly still
+    /// holds exactly what was written.
+    std::unordered_map<NodeId, CachedPose> poses_;
+};
+
+} // namespace rebel::assembly
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "rebel/geometry/Mesh.hpp"
+#include "rebel/spatial/MeshBvh.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace rebel::assembly {
+
+using PartId = std::uint32_t;
+inline constexpr PartId kInvalidPart = 0xFFFFFFFFu;
+
+/// Immutable part definition: geometry plus its triangle BVH, built once and
+/// shared by every occurrence of the part. Parts are only ever handled
+/// through `std::shared_ptr<const Part>`.
+class Part {
+public:
+    /// Takes ownership of `mesh` and builds the part's BVH.
+    static std::shared_ptr<const Part> create(std::string name, geometry::Mesh mesh);
+
+    /// Wraps geometry owned elsewhere; `storage` keeps the arrays behind
+    /// `mesh` alive for as long as the part exists.
+    static std::shared_ptr<const Part> create(std::string name, const geometry::MeshView& mesh,
+                                              std::shared_ptr<const void> storage);
+
+    /// Wraps geometry and a BVH built earlier, e.g. both mapped from a
+    /// native file, so creating the part does no work proportional to its
+    /// size. `storage` keeps the arrays behind `mesh` alive; `bvh` keeps its
+    /// own.
+    static std::shared_ptr<const Part> create(std::string name, const geometry::MeshView& mesh,
+                                              spatial::MeshBvh bvh, std::shared_ptr<const void> storage);
+
+    const std::string& name() const { return name_; }
+    const geometry::MeshView& mesh() const { return mesh_; }
+    const spatial::MeshBvh& bvh() const { return bvh_; }
+    const math::Aabb& bounds() const { return bounds_; }
+
+    /// Bytes of geometry and BVH held by this definition.
+    std::size_t memoryBytes() const;
+
+private:
+    Part(std::string name, const geometry::MeshView& mesh, spatial::MeshBvh bvh,
+         std::shared_ptr<const void> storage, std::size_t storageBytes);
+
+    std::string name_;
+    geometry::MeshView mesh_;
+    std::shared_ptr<const void> storage_;
+    std::size_t storageBytes_ = 0;
+    spatial::MeshBvh bvh_;
+    math::Aabb bounds_;
+};
+
+using PartPtr = std::shared_ptr<const Part>;
+
+} // namespace rebel::assembly
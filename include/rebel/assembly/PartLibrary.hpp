@@ -0,0 +1,52 @@
+#pragma once
+
+#include "rebel/assembly/Part.hpp"
+
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rebel::assembly {
+
+/// Registry of unique part definitions. Assemblies refer to parts by
+/// `PartId`, so loading a second occurrence of a part costs one lookup.
+/// Thread-safe: importers may add parts concurrently with readers.
+class PartLibrary {
+public:
+    /// Registers `part` and returns its id. A part whose name is already
+    /// registered is not added twice; the existing id is returned.
+    PartId add(PartPtr part);
+
+    /// Swaps the definition behind `id`, e.g. a lightweight level of detail
+    /// for the full part once it is needed. `part` must have the same name.
+    /// Throws `std::out_of_range` for an unknown id and
+    /// `std::invalid_argument` for a different name.
+    void replace(PartId id, PartPtr part);
+
+    /// Incremented by every `replace()`.
+    std::uint64_t revision() const;
+    /// Appends the ids replaced after `revision` (possibly repeated).
+    void replacedSince(std::uint64_t revision, std::vector<PartId>& out) const;
+
+    /// Id of the part registered under `name`, or `kInvalidPart`.
+    PartId find(const std::string& name) const;
+
+    /// Part for `id`; throws `std::out_of_range` for an unknown id.
+    PartPtr get(PartId id) const;
+
+    std::size_t size() const;
+
+    /// Geometry and BVH bytes of all unique parts.
+    std::size_t memoryBytes() const;
+
+private:
+    mutable std::shared_mutex mutex_;
+    std::vector<PartPtr> parts_;
+    std::unordered_map<std::string, PartId> byName_;
+    /// Id of every `replace()` in order; the revision is its size.
+    std::vector<PartId> replaced_;
+};
+
+} // namespace rebel::assembly
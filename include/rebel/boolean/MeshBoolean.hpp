@@ -0,0 +1,57 @@
+#pragma once
+
+#include "rebel/geometry/Mesh.hpp"
+
+#include <cstddef>
+
+namespace rebel::boolean {
+
+enum class BooleanOp {
+    Union,
+    Intersection,
+    /// First operand minus the second.
+    Difference,
+};
+
+struct MeshBooleanStats {
+    /// Triangle pairs whose boxes overlap, and those that really cross.
+    std::size_t candidatePairs = 0;
+    std::size_t intersectingPairs = 0;
+    /// Input triangles cut along intersection curves and retriangulated.
+    std::size_t splitTriangles = 0;
+    /// Connected surface regions between intersection curves, classified
+    /// as a whole.
+    std::size_t patches = 0;
+};
+
+/// Boolean of two closed, outward-oriented triangle meshes.
+///
+/// Candidate triangle pairs come from a BVH over clusters of the second
+/// mesh's triangles, queried in parallel with the first's. Each pair is
+/// tested with the exact predicates after moving the second mesh by a tiny
+/// generic offset (about 2^-30 of the coordinate magnitude, far below float
+/// resolution), with symbolic perturbation breaking any tie left over, so
+/// every decision agrees with one consistent, general-position
+/// configuration and coplanar or touching triangles need no special cases
+/// (faces that only touch end up as if the meshes were pulled that tiny bit
+/// apart). Intersection points are mapped back by the offset and snapped to
+/// the input coordinates they coincide with. Crossing
+/// triangles are cut along their intersection segments and retriangulated
+/// on their own tasks: the cut points are inserted into a Delaunay
+/// triangulation of the triangle's plane and the segments recovered as
+/// edges. The cut surfaces fall apart into patches bounded by the
+/// intersection curves; each patch is classified inside or outside the
+/// other mesh from one exact plane-side test next to its boundary (or a
+/// winding number for patches that no curve touches), and the output keeps
+/// the patches the operation selects.
+///
+/// Vertices are welded by position on input and output. The result is a
+/// closed mesh whose new vertices are the intersection points rounded to
+/// float; coincident opposite faces left where the inputs touched are
+/// removed. Inputs must not intersect themselves. Throws
+/// `std::invalid_argument` if either input is not closed
+/// (every edge used once in each direction).
+geometry::Mesh meshBoolean(const geometry::MeshView& a, const geometry::MeshView& b, BooleanOp op,
+                           MeshBooleanStats* stats = nullptr);
+
+} // namespace rebel::boolean
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "rebel/brep/Curve.hpp"
+#include "rebel/brep/Surface.hpp"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace rebel::brep {
+
+using VertexId = std::uint32_t;
+using EdgeId = std::uint32_t;
+using FaceId = std::uint32_t;
+
+struct BrepVertex {
+    math::Vec3d point;
+};
+
+/// Edge geometry is `curve` over [t0, t1], running from `start` to `end`.
+/// An edge is shared by the faces on both sides and tessellated once.
+struct BrepEdge {
+    CurvePtr curve;
+    double t0 = 0.0;
+    double t1 = 1.0;
+    VertexId start = 0;
+    VertexId end = 0;
+};
+
+/// Use of an edge by one face side; `reversed` if the edge runs against the
+/// loop direction of the face.
+struct Coedge {
+    EdgeId edge = 0;
+    bool reversed = false;
+};
+
+struct UvDomain {
+    double u0 = 0.0;
+    double u1 = 1.0;
+    double v0 = 0.0;
+    double v1 = 1.0;
+};
+
+/// Four-sided face over the rectangle `domain` of its surface. The loop runs
+/// counter-clockwise in (u, v): side 0 at v0 towards u1, side 1 at u1
+/// towards v1, side 2 at v1 back to u0, side 3 at u0 back to v0. Sides may be
+/// degenerate (a pole) or seams (the same edge used twice). Each edge's
+/// parameter must map linearly onto its side. `reversed` flips the face
+/// normal against the surface normal so it points out of the solid.
+struct BrepFace {
+    SurfacePtr surface;
+    UvDomain domain;
+    std::array<Coedge, 4> sides;
+    bool reversed = false;
+};
+
+/// Boundary representation of a solid: analytic faces glued along shared
+/// edges. Only topology and geometry are stored; meshes come from the
+/// tessellator.
+class Body {
+public:
+    VertexId addVertex(const math::Vec3d& point);
+    EdgeId addEdge(CurvePtr curve, double t0, double t1, VertexId start, VertexId end);
+    FaceId addFace(SurfacePtr surface, const UvDomain& domain, const std::array<Coedge, 4>& sides,
+                   bool reversed = false);
+
+    std::size_t vertexCount() const { return vertices_.size(); }
+    std::size_t edgeCount() const { return edges_.size(); }
+    std::size_t faceCount() const { return faces_.size(); }
+
+    const BrepVertex& vertex(VertexId id) const { return vertices_.at(id); }
+    const BrepEdge& edge(EdgeId id) const { return edges_.at(id); }
+    const BrepFace& face(FaceId id) const { return faces_.at(id); }
+
+private:
+    std::vector<BrepVertex> vertices_;
+    std::vector<BrepEdge> edges_;
+    std::vector<BrepFace> faces_;
+};
+
+/// Axis-aligned box; six planar faces, outward normals.
+Body makeBox(const math::Vec3d& min, const math::Vec3d& max);
+
+/// Cylinder standing on `base` along +z: side, bottom and top cap.
+Body makeCylinder(const math::Vec3d& base, double radius, double height);
+
+/// Single-face sphere with poles on the z axis.
+Body makeSphere(const math::Vec3d& center, double radius);
+
+/// Single-face torus around the z axis.
+Body makeTorus(const math::Vec3d& center, double majorRadius, double minorRadius);
+
+} // namespace rebel::brep
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "rebel/brep/GeometryRecord.hpp"
+#include "rebel/math/Vec.hpp"
+
+#include <cstddef>
+#include <memory>
+
+namespace rebel::brep {
+
+/// Parametric 3D curve carrying the geometry of a B-rep edge. Evaluation is
+/// in double precision; tessellation converts to float only at the end.
+class Curve {
+public:
+    virtual ~Curve() = default;
+
+    virtual math::Vec3d point(double t) const = 0;
+    /// `point(t[i])` for `count` parameters; curves with costly evaluation
+    /// share work across the batch.
+    virtual void evaluatePoints(const double* t, std::size_t count, math::Vec3d* out) const;
+    /// Straight curves never need more than one segment.
+    virtual bool isLinear() const { return false; }
+    /// Kind and parameters, enough for `makeCurve` to rebuild the curve.
+    virtual GeometryRecord record() const = 0;
+};
+
+using CurvePtr = std::shared_ptr<const Curve>;
+
+/// Rebuilds a curve from `Curve::record()`; throws `std::invalid_argument`
+/// for a record that does not describe a curve.
+CurvePtr makeCurve(const GeometryRecord& record);
+
+/// Segment from `p0` (t = 0) to `p1` (t = 1). `p0 == p1` gives the
+/// degenerate edge at a surface pole or disc center.
+class LineCurve final : public Curve {
+public:
+    LineCurve(const math::Vec3d& p0, const math::Vec3d& p1) : p0_(p0), p1_(p1) {}
+
+    math::Vec3d point(double t) const override { return p0_ + (p1_ - p0_) * t; }
+    bool isLinear() const override { return true; }
+    GeometryRecord record() const override { return GeometryRecord(GeometryKind::Line).add(p0_).add(p1_); }
+
+private:
+    math::Vec3d p0_;
+    math::Vec3d p1_;
+};
+
+/// Circle `center + radius * (cos t * xAxis + sin t * yAxis)`; the axes must
+/// be orthonormal. Arcs are edges that use part of the parameter range.
+class CircleCurve final : public Curve {
+public:
+    CircleCurve(const math::Vec3d& center, const math::Vec3d& xAxis, const math::Vec3d& yAxis, double radius)
+        : center_(center), x_(xAxis), y_(yAxis), radius_(radius) {}
+
+    math::Vec3d point(double t) const override;
+    GeometryRecord record() const override;
+
+private:
+    math::Vec3d center_;
+    math::Vec3d x_;
+    math::Vec3d y_;
+    double radius_;
+};
+
+} // namespace rebel::brep
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "rebel/math/Vec.hpp"
+
+#include <cstdint>
+
+namespace rebel::brep {
+
+enum class GeometryKind : std::uint32_t {
+    Line = 1,
+    Circle = 2,
+    Plane = 16,
+    Disc = 17,
+    Cylinder = 18,
+    Sphere = 19,
+    Torus = 20,
+};
+
+/// Flat, trivially copyable description of an analytic curve or surface:
+/// its kind plus the constructor arguments in order, vectors as three
+/// consecutive doubles. B-rep tables store geometry as arrays of these.
+struct GeometryRecord {
+    static constexpr int kMaxParams = 15;
+
+    GeometryKind kind = GeometryKind::Line;
+    std::uint32_t paramCount = 0;
+    double params[kMaxParams] = {};
+
+    GeometryRecord() = default;
+    explicit GeometryRecord(GeometryKind k) : kind(k) {}
+
+    GeometryRecord& add(double v) {
+        params[paramCount++] = v;
+        return *this;
+    }
+    GeometryRecord& add(const math::Vec3d& v) { return add(v.x).add(v.y).add(v.z); }
+
+    double scalar(int i) const { return params[i]; }
+    math::Vec3d vec(int i) const { return {params[i], params[i + 1], params[i + 2]}; }
+};
+
+static_assert(sizeof(GeometryRecord) == 128, "GeometryRecord must stay 128 bytes");
+
+} // namespace rebel::brep
@@ -0,0 +1,172 @@
+#pragma once
+
+#include "rebel/brep/Curve.hpp"
+#include "rebel/brep/Surface.hpp"
+#include "rebel/math/Vec.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace rebel::brep {
+
+/// Non-decreasing knots of a B-spline of one degree, with knot span lookup.
+///
+/// The parameter domain is `[knots[degree], knots[controlCount()]]`; clamped
+/// (Bezier end) and unclamped vectors are both accepted.
+class KnotVector {
+public:
+    /// Throws `std::invalid_argument` if the knots decrease, the domain is
+    /// empty, there are fewer than `2 * (degree + 1)` of them or the degree
+    /// exceeds `math::batch::kMaxBasisDegree`.
+    KnotVector(unsigned degree, std::vector<double> knots);
+
+    unsigned degree() const { return degree_; }
+    const std::vector<double>& knots() const { return knots_; }
+    std::size_t controlCount() const { return knots_.size() - degree_ - 1; }
+    double first() const { return knots_[degree_]; }
+    double last() const { return knots_[controlCount()]; }
+    double clamp(double t) const { return t < first() ? first() : t > last() ? last() : t; }
+
+    /// Span `s` with `knots[s] <= t < knots[s + 1]`, from a binary search;
+    /// parameters outside the domain get the first or last span. The end of
+    /// the domain belongs to the last non-empty span.
+    std::uint32_t span(double t) const;
+    /// Same, walking from `hint`, the span of a nearby parameter, and only
+    /// searching when `t` is more than a couple of spans away. Sweeps over
+    /// sorted parameters pay next to nothing per lookup that way.
+    std::uint32_t span(double t, std::uint32_t hint) const;
+
+    /// Basis functions at `t` in `span` and their derivatives up to `order`
+    /// (at most 2): derivative `k` of function `r` goes to
+    /// `out[k * (degree + 1) + r]`.
+    void basis(double t, std::uint32_t span, unsigned order, double* out) const;
+
+private:
+    unsigned degree_;
+    std::vector<double> knots_;
+    std::uint32_t firstSpan_ = 0;
+    std::uint32_t lastSpan_ = 0;
+};
+
+/// Rational B-spline curve. Weights default to 1 (a plain B-spline) and
+/// must be positive.
+///
+/// NURBS have no fixed-size `GeometryRecord`, so bodies using them cannot
+/// be written to native files yet; `record()` throws `std::logic_error`.
+class NurbsCurve final : public Curve {
+public:
+    /// Throws `std::invalid_argument` if the point or weight counts do not
+    /// match the knots or a weight is not positive.
+    NurbsCurve(KnotVector knots, const std::vector<math::Vec3d>& points, const std::vector<double>& weights = {});
+
+    const KnotVector& knots() const { return knots_; }
+
+    math::Vec3d point(double t) const override;
+    GeometryRecord record() const override;
+
+    /// Points, and first derivatives unless `tangents` is null, at `count`
+    /// parameters (clamped to the domain). Knot spans are looked up from
+    /// the previous sample and basis functions evaluated several samples at
+    /// a time, so sorted parameters are cheapest.
+    void evaluate(const double* t, std::size_t count, math::Vec3d* points, math::Vec3d* tangents = nullptr) const;
+    void evaluatePoints(const double* t, std::size_t count, math::Vec3d* out) const override;
+
+private:
+    KnotVector knots_;
+    /// Homogeneous control points (x w, y w, z w, w).
+    std::vector<double> weighted_;
+};
+
+/// Outputs of `NurbsSurface::evaluate`; null arrays are skipped.
+struct SurfaceSamples {
+    math::Vec3d* points = nullptr;
+    math::Vec3d* du = nullptr;
+    math::Vec3d* dv = nullptr;
+    math::Vec3d* normals = nullptr;
+};
+
+/// Point and partial derivatives up to second order.
+struct SurfaceDerivatives {
+    math::Vec3d point;
+    math::Vec3d du;
+    math::Vec3d dv;
+    math::Vec3d duu;
+    math::Vec3d duv;
+    math::Vec3d dvv;
+};
+
+struct SurfaceClosestPoint {
+    math::Vec2d uv;
+    math::Vec3d point;
+    double distance = 0.0;
+};
+
+/// Rational B-spline surface; control point `(i, j)` is
+/// `points[j * uCount + i]`, i along u. Weights default to 1 and must be
+/// positive.
+///
+/// Normals at degenerate points (poles, collapsed edges) are taken a
+/// little way into the patch. Like `NurbsCurve`, `record()` throws
+/// `std::logic_error`.
+class NurbsSurface final : public Surface {
+public:
+    /// Throws `std::invalid_argument` if the point or weight counts do not
+    /// match the knots or a weight is not positive.
+    NurbsSurface(KnotVector uKnots, KnotVector vKnots, const std::vector<math::Vec3d>& points,
+                 const std::vector<double>& weights = {});
+
+    const KnotVector& uKnots() const { return u_; }
+    const KnotVector& vKnots() const { return v_; }
+
+    math::Vec3d point(double u, double v) const override;
+    math::Vec3d normal(double u, double v) const override;
+    GeometryRecord record() const override;
+
+    SurfaceDerivatives derivatives(double u, double v) const;
+
+    /// Scattered samples `uv[i]` (clamped to the domain). Spans are looked
+    /// up from the previous sample, basis functions evaluated several samples
+    /// at a time, and large batches are split over the task scheduler.
+    void evaluate(const math::Vec2d* uv, std::size_t count, const SurfaceSamples& out) const;
+    /// Basis functions are evaluated once per u and once per v, and each
+    /// row first reduces the control net to one curve along u, which makes
+    /// dense grids several times cheaper than scattered samples.
+    void evaluateGrid(const double* u, std::size_t nu, const double* v, std::size_t nv, math::Vec3d* points,
+                      math::Vec3d* normals) const override;
+
+    /// Nearest point of the surface to each query, in parallel. Patches
+    /// (pairs of non-empty knot spans) are visited nearest bound first, the
+    /// bound being the box of their control points, which contains them;
+    /// each visited patch is seeded from a few samples and refined by Newton
+    /// steps, until no remaining patch can be nearer.
+    void closestPoints(const math::Vec3d* queries, std::size_t count, SurfaceClosestPoint* out) const;
+    SurfaceClosestPoint closestPoint(const math::Vec3d& query) const;
+
+private:
+    struct Patch {
+        math::Vec3d min;
+        math::Vec3d max;
+        std::uint32_t uSpan;
+        std::uint32_t vSpan;
+    };
+
+    /// Homogeneous point and first derivatives at one sample from its basis
+    /// functions, `nu`/`nv` values and `du`/`dv` derivatives (either null).
+    void accumulate(std::uint32_t uSpan, std::uint32_t vSpan, const double* nu, const double* du, std::size_t uStride,
+                    const double* nv, const double* dv, std::size_t vStride, double* h) const;
+    math::Vec3d normalNear(double u, double v) const;
+    SurfaceClosestPoint nearest(const math::Vec3d& query, std::vector<std::pair<double, std::uint32_t>>& order) const;
+    SurfaceClosestPoint refine(const math::Vec3d& query, double u, double v, double uLo, double uHi, double vLo,
+                               double vHi) const;
+
+    KnotVector u_;
+    KnotVector v_;
+    std::size_t uCount_;
+    /// Homogeneous control points (x w, y w, z w, w), `j * uCount + i`.
+    std::vector<double> weighted_;
+    std::vector<Patch> patches_;
+};
+
+} // namespace rebel::brep
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "rebel/brep/GeometryRecord.hpp"
+#include "rebel/math/Vec.hpp"
+
+#include <cstddef>
+#include <memory>
+
+namespace rebel::brep {
+
+/// Parametric surface carrying the geometry of a B-rep face.
+///
+/// `normal(u, v)` is the unit normal in the direction of dP/du x dP/dv, so
+/// triangles that are counter-clockwise in (u, v) face along it. It is
+/// evaluated analytically and stays well defined at poles.
+class Surface {
+public:
+    virtual ~Surface() = default;
+
+    virtual math::Vec3d point(double u, double v) const = 0;
+    virtual math::Vec3d normal(double u, double v) const = 0;
+    /// Points and normals at every (u[i], v[j]), element `j * nu + i`;
+    /// `normals` may be null. Surfaces with costly evaluation share work
+    /// along rows and columns.
+    virtual void evaluateGrid(const double* u, std::size_t nu, const double* v, std::size_t nv, math::Vec3d* points,
+                              math::Vec3d* normals) const;
+    /// Kind and parameters, enough for `makeSurface` to rebuild the surface.
+    virtual GeometryRecord record() const = 0;
+};
+
+using SurfacePtr = std::shared_ptr<const Surface>;
+
+/// Rebuilds a surface from `Surface::record()`; throws
+/// `std::invalid_argument` for a record that does not describe a surface.
+SurfacePtr makeSurface(const GeometryRecord& record);
+
+/// `origin + u * uAxis + v * vAxis`.
+class PlaneSurface final : public Surface {
+public:
+    PlaneSurface(const math::Vec3d& origin, const math::Vec3d& uAxis, const math::Vec3d& vAxis);
+
+    math::Vec3d point(double u, double v) const override { return origin_ + u_ * u + v_ * v; }
+    math::Vec3d normal(double, double) const override { return normal_; }
+    GeometryRecord record() const override;
+
+private:
+    math::Vec3d origin_;
+    math::Vec3d u_;
+    math::Vec3d v_;
+    math::Vec3d normal_;
+};
+
+/// Disc in polar form: `center + v * radius * (cos u * xAxis + sin u * yAxis)`,
+/// v in [0, 1]. The v = 0 side collapses to the center. Its normal is
+/// `-(xAxis x yAxis)`, so bottom caps use it as is and top caps reverse it.
+class DiscSurface final : public Surface {
+public:
+    DiscSurface(const math::Vec3d& center, const math::Vec3d& xAxis, const math::Vec3d& yAxis, double radius);
+
+    math::Vec3d point(double u, double v) const override;
+    math::Vec3d normal(double, double) const override { return normal_; }
+    GeometryRecord record() const override;
+
+private:
+    math::Vec3d center_;
+    math::Vec3d x_;
+    math::Vec3d y_;
+    math::Vec3d normal_;
+    double radius_;
+};
+
+/// `origin + radius * (cos u * xAxis + sin u * yAxis) + v * (xAxis x yAxis)`,
+/// normal pointing away from the axis.
+class CylinderSurface final : public Surface {
+public:
+    CylinderSurface(const math::Vec3d& origin, const math::Vec3d& xAxis, const math::Vec3d& yAxis, double radius);
+
+    math::Vec3d point(double u, double v) const override;
+    math::Vec3d normal(double u, double v) const override;
+    GeometryRecord record() const override;
+
+private:
+    math::Vec3d origin_;
+    math::Vec3d x_;
+    math::Vec3d y_;
+    math::Vec3d axis_;
+    double radius_;
+};
+
+/// Longitude u in [0, 2pi], latitude v in [-pi/2, pi/2]; outward normal.
+class SphereSurface final : public Surface {
+public:
+    SphereSurface(const math::Vec3d& center, const math::Vec3d& xAxis, const math::Vec3d& yAxis, double radius);
+
+    math::Vec3d point(double u, double v) const override;
+    math::Vec3d normal(double u, double v) const override;
+    GeometryRecord record() const override;
+
+private:
+    math::Vec3d center_;
+    math::Vec3d x_;
+    math::Vec3d y_;
+    math::Vec3d z_;
+    double radius_;
+};
+
+/// Torus around `xAxis x yAxis`: u runs around the axis, v around the tube.
+class TorusSurface final : public Surface {
+public:
+    TorusSurface(const math::Vec3d& center, const math::Vec3d& xAxis, const math::Vec3d& yAxis,
+                 double majorRadius, double minorRadius);
+
+    math::Vec3d point(double u, double v) const override;
+    math::Vec3d normal(double u, double v) const override;
+    GeometryRecord record() const override;
+
+private:
+    math::Vec3d center_;
+    math::Vec3d x_;
+    math::Vec3d y_;
+    math::Vec3d z_;
+    double major_;
+    double minor_;
+};
+
+} // namespace rebel::brep
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "rebel/brep/Body.hpp"
+#include "rebel/geometry/Mesh.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace rebel::brep {
+
+struct TessellationOptions {
+    /// Maximum distance between the surface and its triangles (model units)
+    /// at the finest level.
+    double chordalTolerance = 0.01;
+    /// Maximum angle (radians) between normals across one segment at the
+    /// finest level.
+    double angularTolerance = 0.26;
+    /// Number of levels of detail; level 0 is the finest.
+    std::uint32_t levelCount = 3;
+    /// Tolerance growth from one level to the next coarser one.
+    double levelScale = 4.0;
+    /// Upper bound on segments per edge or per face direction.
+    std::uint32_t maxSegments = 1024;
+
+    double levelChordalTolerance(std::uint32_t level) const;
+    double levelAngularTolerance(std::uint32_t level) const;
+};
+
+/// One level of detail of a body. Face meshes carry per-vertex normals;
+/// boundary vertices are bit-identical copies of the shared edge samples,
+/// so neighbouring faces meet without cracks.
+struct TessellationLevel {
+    double chordalTolerance = 0.0;
+    double angularTolerance = 0.0;
+    /// Polyline of every edge, in edge direction.
+    std::vector<std::vector<math::Vec3f>> edges;
+    std::vector<geometry::Mesh> faces;
+
+    std::size_t triangleCount() const;
+
+    /// All faces welded into one mesh without normals (closed for a closed
+    /// body), e.g. for spatial queries and booleans.
+    geometry::Mesh merged() const;
+};
+
+struct Tessellation {
+    std::vector<TessellationLevel> levels;
+};
+
+/// Tessellates every face of `body` at every level. Edges are discretized
+/// first, once per level, then faces are meshed against those samples; both
+/// phases run in parallel on the global task scheduler.
+Tessellation tessellate(const Body& body, const TessellationOptions& options = {});
+
+/// Tessellates a single level, e.g. the coarsest one for a first frame
+/// before the finer levels are produced in the background.
+TessellationLevel tessellateLevel(const Body& body, const TessellationOptions& options, std::uint32_t level);
+
+} // namespace rebel::brep
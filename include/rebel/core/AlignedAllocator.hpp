@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace rebel::core {
+
+/// Cache-line alignment used for all bulk geometry arrays.
+inline constexpr std::size_t kCacheLineSize = 64;
+
+/// STL allocator that returns storage aligned to `Alignment` bytes, so SoA
+/// arrays can be streamed with aligned SIMD loads.
+template <typename T, std::size_t Alignment = kCacheLineSize>
+class AlignedAllocator {
+public:
+    static_assert(Alignment >= alignof(T), "alignment weaker than the type requires");
+    static_assert((Alignment & (Alignment - 1)) == 0, "alignment must be a power of two");
+
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    T* allocate(std::size_t count) {
+        if (count > static_cast<std::size_t>(-1) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T* ptr, std::size_t) noexcept {
+        ::operator delete(ptr, std::align_val_t(Alignment));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept { return false; }
+};
+
+/// Contiguous, cache-line aligned array.
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+} // namespace rebel::core
@@ -0,0 +1,239 @@
+#pragma once
+
+#include "rebel/core/AlignedAllocator.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace rebel::core {
+
+/// Bump allocator for the transient data of one operation (boolean, offset,
+/// fillet): intersection points, curve and edge fragments, scratch arrays.
+///
+/// Allocation is a pointer bump inside large blocks and individual frees are
+/// no-ops; everything goes away at once through `rollback()`, `reset()` or
+/// the destructor. Objects with non-trivial destructors created through
+/// `create()` are destroyed at that point, in reverse order. Blocks are kept
+/// across `reset()` so repeated operations reach a steady state without
+/// touching the heap. Not thread-safe: use one arena per task or an
+/// `ArenaSet`.
+class MonotonicArena {
+public:
+    /// Position to roll back to; see `mark()`.
+    struct Marker {
+        std::size_t block = 0;
+        std::size_t offset = 0;
+        void* destructors = nullptr;
+        std::size_t bytesUsed = 0;
+    };
+
+    explicit MonotonicArena(std::size_t blockSize = 256 * 1024);
+    ~MonotonicArena();
+
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    /// Uninitialized storage; `alignment` must be a power of two.
+    void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t));
+
+    template <typename T>
+    T* allocateArray(std::size_t count) {
+        if (count > static_cast<std::size_t>(-1) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    /// Constructs a `T` in the arena. Its destructor runs when the arena
+    /// rolls back past it or is reset.
+    template <typename T, typename... Args>
+    T* create(Args&&... args);
+
+    Marker mark() const { return {current_, offset_, destructors_, bytesUsed_}; }
+    /// Frees everything allocated after `marker` was taken.
+    void rollback(const Marker& marker);
+    /// Frees everything but keeps the blocks for reuse.
+    void reset() { rollback(Marker{}); }
+    /// Frees everything and returns the blocks to the system.
+    void release();
+
+    /// Bytes handed out since the last reset, including alignment padding.
+    std::size_t bytesUsed() const { return bytesUsed_; }
+    /// Bytes held in blocks.
+    std::size_t bytesReserved() const { return bytesReserved_; }
+
+private:
+    struct Block {
+        std::byte* data;
+        std::size_t size;
+    };
+
+    struct DestructorRecord {
+        void (*destroy)(void*);
+        void* object;
+        DestructorRecord* next;
+    };
+
+    void* allocateSlow(std::size_t bytes, std::size_t alignment);
+    void runDestructors(void* until);
+
+    std::size_t blockSize_;
+    std::vector<Block> blocks_;
+    std::size_t current_ = 0;
+    std::size_t offset_ = 0;
+    DestructorRecord* destructors_ = nullptr;
+    std::size_t bytesUsed_ = 0;
+    std::size_t bytesReserved_ = 0;
+};
+
+inline void* MonotonicArena::allocate(std::size_t bytes, std::size_t alignment) {
+    if (current_ < blocks_.size()) {
+        const Block& block = blocks_[current_];
+        const auto base = reinterpret_cast<std::uintptr_t>(block.data);
+        const std::size_t aligned = ((base + offset_ + alignment - 1) & ~(alignment - 1)) - base;
+        if (aligned + bytes <= block.size) {
+            bytesUsed_ += aligned + bytes - offset_;
+            offset_ = aligned + bytes;
+            return block.data + aligned;
+        }
+    }
+    return allocateSlow(bytes, alignment);
+}
+
+template <typename T, typename... Args>
+T* MonotonicArena::create(Args&&... args) {
+    if constexpr (std::is_trivially_destructible_v<T>) {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    } else {
+        // The record is allocated first so a throwing constructor leaves
+        // nothing to unwind but the bump.
+        auto* record = static_cast<DestructorRecord*>(allocate(sizeof(DestructorRecord), alignof(DestructorRecord)));
+        T* object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        record->destroy = [](void* p) { static_cast<T*>(p)->~T(); };
+        record->object = object;
+        record->next = destructors_;
+        destructors_ = record;
+        return object;
+    }
+}
+
+/// STL allocator drawing from a `MonotonicArena`; `deallocate` is a no-op.
+/// Containers using it must not outlive the arena's next rollback.
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(MonotonicArena& arena) noexcept : arena_(&arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena_(other.arena()) {}
+
+    T* allocate(std::size_t count) { return arena_->allocateArray<T>(count); }
+    void deallocate(T*, std::size_t) noexcept {}
+
+    MonotonicArena* arena() const noexcept { return arena_; }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& o) const noexcept { return arena_ == o.arena(); }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& o) const noexcept { return arena_ != o.arena(); }
+
+private:
+    MonotonicArena* arena_;
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+/// Fixed-size object pool on top of an arena: freed objects go to a free
+/// list and are reused by the next `create()`, for fragments that churn
+/// within one operation. Limited to trivially destructible types since the
+/// arena drops outstanding objects wholesale.
+template <typename T>
+class ArenaPool {
+public:
+    static_assert(std::is_trivially_destructible_v<T>, "pooled types must be trivially destructible");
+
+    explicit ArenaPool(MonotonicArena& arena) : arena_(arena) {}
+
+    template <typename... Args>
+    T* create(Args&&... args) {
+        void* slot = free_;
+        if (slot) {
+            free_ = free_->next;
+        } else {
+            slot = arena_.allocate(sizeof(Slot), alignof(Slot));
+        }
+        return new (slot) T(std::forward<Args>(args)...);
+    }
+
+    void destroy(T* object) {
+        auto* slot = reinterpret_cast<FreeSlot*>(object);
+        slot->next = free_;
+        free_ = slot;
+    }
+
+    /// Forgets the free list; call after rolling the arena back.
+    void clear() { free_ = nullptr; }
+
+private:
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+    union Slot {
+        alignas(T) std::byte object[sizeof(T)];
+        FreeSlot free;
+    };
+
+    MonotonicArena& arena_;
+    FreeSlot* free_ = nullptr;
+};
+
+/// Releases everything allocated in an arena during its lifetime, whether
+/// the operation commits (results were copied out) or is abandoned by an
+/// error or cancellation unwinding the stack.
+class ArenaScope {
+public:
+    explicit ArenaScope(MonotonicArena& arena) : arena_(arena), marker_(arena.mark()) {}
+    ~ArenaScope() { arena_.rollback(marker_); }
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+    MonotonicArena& arena() const { return arena_; }
+
+private:
+    MonotonicArena& arena_;
+    MonotonicArena::Marker marker_;
+};
+
+/// One arena per task scheduler worker plus one for the calling thread, so
+/// the parallel phases of an operation allocate without contention. Tasks
+/// on the same worker run one after another (or nested, in stack order), so
+/// each arena is only ever touched by one thread at a time. At most one
+/// thread outside the pool may use a set.
+class ArenaSet {
+public:
+    explicit ArenaSet(std::size_t blockSize = 256 * 1024);
+
+    /// Arena of the calling worker (or of the outside thread).
+    MonotonicArena& local();
+
+    /// Resets every arena; only call once the operation's tasks finished.
+    void reset();
+
+    std::size_t bytesUsed() const;
+    std::size_t bytesReserved() const;
+
+private:
+    std::vector<std::unique_ptr<MonotonicArena>> arenas_;
+};
+
+} // namespace rebel::core
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace rebel::core {
+
+/// 128-bit content hash. Wide enough to key shared caches and content
+/// addressed storage without worrying about collisions.
+struct Hash128 {
+    std::uint64_t lo = 0;
+    std::uint64_t hi = 0;
+
+    constexpr bool operator==(const Hash128& o) const { return lo == o.lo && hi == o.hi; }
+    constexpr bool operator!=(const Hash128& o) const { return !(*this == o); }
+    constexpr bool operator<(const Hash128& o) const { return hi != o.hi ? hi < o.hi : lo < o.lo; }
+
+    /// 32 lowercase hex digits, high word first.
+    std::string toHex() const;
+    /// Parses `toHex()` output; returns false on malformed input.
+    static bool fromHex(std::string_view hex, Hash128& out);
+};
+
+/// Streaming MurmurHash3 (x64, 128-bit). Feeding the same bytes in any
+/// chunking gives the same digest.
+class Hasher {
+public:
+    explicit Hasher(std::uint64_t seed = 0) : h1_(seed), h2_(seed) {}
+
+    Hasher& addBytes(const void* data, std::size_t size);
+
+    template <typename T>
+    Hasher& add(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "hash trivially copyable values only");
+        return addBytes(&value, sizeof(T));
+    }
+
+    /// Length-prefixed, so ("ab", "c") and ("a", "bc") differ.
+    Hasher& addString(std::string_view s) {
+        add(static_cast<std::uint64_t>(s.size()));
+        return addBytes(s.data(), s.size());
+    }
+
+    Hasher& addHash(const Hash128& h) { return add(h.lo).add(h.hi); }
+
+    /// Hashes `-0.0` like `0.0` so equal values hash equally.
+    Hasher& addDouble(double v) { return add(v == 0.0 ? 0.0 : v); }
+
+    Hash128 finish() const;
+
+private:
+    void mixBlock(std::uint64_t k1, std::uint64_t k2);
+
+    std::uint64_t h1_;
+    std::uint64_t h2_;
+    std::uint64_t length_ = 0;
+    unsigned char tail_[16] = {};
+    std::size_t tailSize_ = 0;
+};
+
+inline Hash128 hashBytes(const void* data, std::size_t size, std::uint64_t seed = 0) {
+    return Hasher(seed).addBytes(data, size).finish();
+}
+
+} // namespace rebel::core
+
+template <>
+struct std::hash<rebel::core::Hash128> {
+    std::size_t operator()(const rebel::core::Hash128& h) const noexcept {
+        return static_cast<std::size_t>(h.lo ^ (h.hi * 0x9E3779B97F4A7C15ull));
+    }
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace rebel::core {
+
+/// Minimal JSON document for tool I/O (benchmark reports, baselines, command
+/// streams). Objects keep their keys sorted so output is deterministic.
+class Json {
+public:
+    using Array = std::vector<Json>;
+    using Object = std::map<std::string, Json, std::less<>>;
+
+    Json() = default;
+    Json(std::nullptr_t) {}
+    Json(bool b) : value_(b) {}
+    Json(double d) : value_(d) {}
+    Json(int i) : value_(static_cast<double>(i)) {}
+    Json(unsigned i) : value_(static_cast<double>(i)) {}
+    Json(std::int64_t i) : value_(static_cast<double>(i)) {}
+    Json(std::uint64_t i) : value_(static_cast<double>(i)) {}
+    Json(const char* s) : value_(std::string(s)) {}
+    Json(std::string s) : value_(std::move(s)) {}
+    Json(Array a) : value_(std::move(a)) {}
+    Json(Object o) : value_(std::move(o)) {}
+
+    static Json array() { return Json(Array{}); }
+    static Json object() { return Json(Object{}); }
+
+    /// Throws `std::runtime_error` with the byte offset on malformed input.
+    static Json parse(std::string_view text);
+
+    /// Compact when `indent < 0`, else pretty-printed.
+    std::string dump(int indent = -1) const;
+
+    bool isNull() const { return std::holds_alternative<std::nullptr_t>(value_); }
+    bool isBool() const { return std::holds_alternative<bool>(value_); }
+    bool isNumber() const { return std::holds_alternative<double>(value_); }
+    bool isString() const { return std::holds_alternative<std::string>(value_); }
+    bool isArray() const { return std::holds_alternative<Array>(value_); }
+    bool isObject() const { return std::holds_alternative<Object>(value_); }
+
+    /// Typed access; throws `std::runtime_error` on a type mismatch.
+    bool asBool() const;
+    double asNumber() const;
+    const std::string& asString() const;
+    const Array& asArray() const;
+    Array& asArray();
+    const Object& asObject() const;
+    Object& asObject();
+
+    /// Object member or null if absent (or not an object).
+    const Json& operator[](std::string_view key) const;
+    bool contains(std::string_view key) const;
+    /// Object member, inserted if absent; a null value becomes an object.
+    Json& operator[](const std::string& key);
+
+    /// Appends to an array; a null value becomes an array.
+    void push(Json value);
+
+    /// Member lookups with a fallback for absent or mistyped values.
+    double number(std::string_view key, double fallback) const;
+    std::string string(std::string_view key, std::string fallback) const;
+
+private:
+    std::variant<std::nullptr_t, bool, double, std::string, Array, Object> value_;
+};
+
+} // namespace rebel::core
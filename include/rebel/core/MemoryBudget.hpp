@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rebel::core {
+
+/// Something a consumer could free, and when it was last used (a
+/// `MemoryBudget::stamp()`).
+struct MemoryItem {
+    std::uint64_t lastUse = 0;
+    std::size_t bytes = 0;
+};
+
+/// A cache whose memory counts against a `MemoryBudget`. Data evicted is
+/// not lost: it falls back to a cheaper source (a mapped file, a coarser
+/// level of detail, the disk tier of a cache) or is recomputed on demand.
+class MemoryConsumer {
+public:
+    virtual ~MemoryConsumer() = default;
+
+    /// Short name for reports, e.g. "render.geometry_pool".
+    virtual std::string_view memoryName() const = 0;
+    /// Bytes currently held, evictable or not.
+    virtual std::size_t memoryBytes() const = 0;
+    /// Appends what could be evicted right now.
+    virtual void evictionCandidates(std::vector<MemoryItem>& out) const = 0;
+    /// Evicts every candidate last used before `stamp`; returns the bytes
+    /// freed.
+    virtual std::size_t evictOlderThan(std::uint64_t stamp) = 0;
+};
+
+struct MemoryUsage {
+    std::string name;
+    std::size_t bytes = 0;
+};
+
+struct MemoryBudgetStats {
+    std::size_t limitBytes = 0;
+    /// Sum over the consumers at the last `enforce()`.
+    std::size_t usedBytes = 0;
+    /// `enforce()` calls that found the budget exceeded.
+    std::size_t overruns = 0;
+    std::size_t evictedBytes = 0;
+};
+
+/// Process-wide memory accounting with least-recently-used eviction across
+/// every registered cache.
+///
+/// Consumers stamp their items with `stamp()` whenever they are used, from
+/// one shared clock, so ages compare across caches. When the sum of what
+/// the consumers hold exceeds the limit, `enforce()` gathers every
+/// candidate, picks the oldest until enough would be freed, and has each
+/// consumer evict its items older than its share of that cut, so the
+/// tessellation of a part not looked at for an hour goes before the result
+/// the last regeneration produced, whatever cache holds them. Data shared
+/// between consumers is counted by each of them.
+///
+/// Consumers are called on the thread calling `enforce()`, under the
+/// budget's lock; call it where they are not in use, e.g. between jobs or
+/// at the start of a frame. Consumers must `remove()` themselves before
+/// they are destroyed.
+class MemoryBudget {
+public:
+    /// `limitBytes == 0` means no limit.
+    explicit MemoryBudget(std::size_t limitBytes = 0) : limit_(limitBytes) {}
+
+    /// Shared budget. Limited to `REBEL_MEMORY_BUDGET` megabytes if set,
+    /// else unlimited.
+    static MemoryBudget& global();
+
+    /// Next value of the shared use clock.
+    static std::uint64_t stamp() { return clock_.fetch_add(1, std::memory_order_relaxed) + 1; }
+
+    void setLimit(std::size_t limitBytes);
+    std::size_t limit() const;
+
+    void add(MemoryConsumer* consumer);
+    void remove(MemoryConsumer* consumer);
+
+    /// Evicts least recently used data until the consumers fit the limit,
+    /// or nothing evictable is left. Returns the bytes freed.
+    std::size_t enforce();
+
+    /// What each consumer holds now.
+    std::vector<MemoryUsage> usage() const;
+    MemoryBudgetStats stats() const;
+
+private:
+    static std::atomic<std::uint64_t> clock_;
+
+    mutable std::mutex mutex_;
+    std::size_t limit_;
+    std::vector<MemoryConsumer*> consumers_;
+    MemoryBudgetStats stats_;
+};
+
+} // namespace rebel::core
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <unordered_set>
+#include <utility>
+
+namespace rebel::core {
+
+/// Vector with structurally shared copies, for document state that is
+/// snapshotted for undo, redo and background readers.
+///
+/// Elements live in a 32-way trie of reference-counted nodes. Copying a
+/// vector copies its root pointer, so a snapshot is O(1) whatever the size.
+/// An edit copies the nodes on the path to the changed element that are
+/// still shared with another copy (one leaf of 32 elements and a handful of
+/// branch nodes) and changes nodes only this copy holds in place, so a run
+/// of edits between two snapshots copies each path at most once.
+///
+/// Snapshots may be read on other threads while the original is edited:
+/// an edit never writes to a node another copy can reach. Taking the copy
+/// itself must happen on the editing thread. Element references stay valid
+/// until the next edit of this copy.
+///
+/// Leaves that were never written are not allocated and read as `T{}`, so
+/// a vector indexed by sparse ids (`extend()` then `set()`) only pays for
+/// the leaves it uses.
+template <typename T>
+class PersistentVector {
+public:
+    static constexpr unsigned kBits = 5;
+    static constexpr std::size_t kWidth = std::size_t(1) << kBits;
+
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    const T& operator[](std::size_t i) const {
+        const void* node = root_.get();
+        for (unsigned shift = shift_; node != nullptr && shift > 0; shift -= kBits) {
+            node = static_cast<const Branch*>(node)->children[(i >> shift) & kMask].get();
+        }
+        return node != nullptr ? static_cast<const Leaf*>(node)->values[i & kMask] : defaultValue();
+    }
+
+    /// Same, throwing `std::out_of_range` past the end.
+    const T& at(std::size_t i) const {
+        if (i >= size_) {
+            throw std::out_of_range("persistent vector index out of range");
+        }
+        return (*this)[i];
+    }
+
+    const T& back() const { return (*this)[size_ - 1]; }
+
+    /// Writable element `i`, after copying the shared nodes on its path.
+    /// `i` must be below `size()`.
+    T& mutate(std::size_t i) {
+        std::shared_ptr<void>* slot = &root_;
+        for (unsigned shift = shift_; shift > 0; shift -= kBits) {
+            slot = &own<Branch>(*slot)->children[(i >> shift) & kMask];
+        }
+        return own<Leaf>(*slot)->values[i & kMask];
+    }
+
+    void set(std::size_t i, T value) {
+        if (i >= size_) {
+            throw std::out_of_range("persistent vector index out of range");
+        }
+        mutate(i) = std::move(value);
+    }
+
+    void push_back(T value) {
+        extend(size_ + 1);
+        mutate(size_ - 1) = std::move(value);
+    }
+
+    /// Grows to `size` elements; the new ones read as `T{}` and allocate
+    /// nothing until written. Never shrinks.
+    void extend(std::size_t size) {
+        while (size > capacity()) {
+            auto branch = std::make_shared<Branch>();
+            branch->children[0] = std::move(root_);
+            root_ = std::move(branch);
+            shift_ += kBits;
+        }
+        size_ = std::max(size_, size);
+    }
+
+    void clear() {
+        root_.reset();
+        shift_ = 0;
+        size_ = 0;
+    }
+
+    /// Calls `fn(index, value)` in index order for the elements of every
+    /// allocated leaf, skipping leaves that were never written.
+    template <typename Fn>
+    void forEachStored(Fn&& fn) const {
+        visit(root_.get(), shift_, 0, fn);
+    }
+
+    /// Calls `fn(index, mine, theirs)` for the elements of every leaf not
+    /// shared between this vector and `other`, which must have the same
+    /// size. Subtrees the two still share are skipped without being read,
+    /// so comparing a snapshot with its edited original costs time in the
+    /// number of edited leaves, not in the size. Untouched elements of an
+    /// edited leaf are reported too; `fn` compares them if it has to.
+    template <typename Fn>
+    void forEachDifference(const PersistentVector& other, Fn&& fn) const {
+        if (other.size_ != size_) {
+            throw std::invalid_argument("persistent vectors differ in size");
+        }
+        difference(root_.get(), other.root_.get(), shift_, 0, fn);
+    }
+
+    /// True if both share every node, e.g. a vector and an unedited copy.
+    bool identical(const PersistentVector& other) const { return root_ == other.root_ && size_ == other.size_; }
+
+    /// Bytes of the nodes reachable from this vector. With `seen`, only
+    /// nodes not in it are counted and then added, which gives the memory
+    /// of a set of snapshots with shared nodes counted once. Heap memory
+    /// owned by the elements themselves is not included.
+    std::size_t memoryBytes(std::unordered_set<const void*>* seen = nullptr) const {
+        return memoryBytes(seen, [](const T&) { return std::size_t(0); });
+    }
+
+    /// Same, adding `elementBytes(value)` for the elements of each counted
+    /// leaf, e.g. the heap memory of strings.
+    template <typename ElementBytes>
+    std::size_t memoryBytes(std::unordered_set<const void*>* seen, ElementBytes&& elementBytes) const {
+        return bytes(root_.get(), shift_, seen, elementBytes);
+    }
+
+private:
+    static constexpr std::size_t kMask = kWidth - 1;
+
+    struct Leaf {
+        std::array<T, kWidth> values{};
+    };
+    struct Branch {
+        std::array<std::shared_ptr<void>, kWidth> children;
+    };
+
+    static const T& defaultValue() {
+        static const T value{};
+        return value;
+    }
+
+    std::size_t capacity() const { return kWidth << shift_; }
+
+    /// Node behind `slot`, allocated if missing and copied if shared.
+    template <typename Node>
+    static Node* own(std::shared_ptr<void>& slot) {
+        if (!slot) {
+            slot = std::make_shared<Node>();
+        } else if (slot.use_count() != 1) {
+            slot = std::make_shared<Node>(*static_cast<const Node*>(slot.get()));
+        } else {
+            // The last other copy may just have been dropped on a reader
+            // thread. `use_count()` is a relaxed load; the fence orders that
+            // reader's accesses to the node before the in-place write.
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return static_cast<Node*>(slot.get());
+    }
+
+    template <typename Fn>
+    void visit(const void* node, unsigned shift, std::size_t first, Fn& fn) const {
+        if (node == nullptr || first >= size_) {
+            return;
+        }
+        if (shift == 0) {
+            const Leaf* leaf = static_cast<const Leaf*>(node);
+            for (std::size_t k = 0; k < kWidth && first + k < size_; ++k) {
+                fn(first + k, leaf->values[k]);
+            }
+            return;
+        }
+        const Branch* branch = static_cast<const Branch*>(node);
+        for (std::size_t k = 0; k < kWidth; ++k) {
+            visit(branch->children[k].get(), shift - kBits, first + (k << shift), fn);
+        }
+    }
+
+    template <typename Fn>
+    void difference(const void* mine, const void* theirs, unsigned shift, std::size_t first, Fn& fn) const {
+        if (mine == theirs || first >= size_) {
+            return;
+        }
+        if (shift == 0) {
+            const Leaf* a = static_cast<const Leaf*>(mine);
+            const Leaf* b = static_cast<const Leaf*>(theirs);
+            for (std::size_t k = 0; k < kWidth && first + k < size_; ++k) {
+                fn(first + k, a != nullptr ? a->values[k] : defaultValue(),
+                   b != nullptr ? b->values[k] : defaultValue());
+            }
+            return;
+        }
+        const Branch* a = static_cast<const Branch*>(mine);
+        const Branch* b = static_cast<const Branch*>(theirs);
+        for (std::size_t k = 0; k < kWidth; ++k) {
+            difference(a != nullptr ? a->children[k].get() : nullptr, b != nullptr ? b->children[k].get() : nullptr,
+                       shift - kBits, first + (k << shift), fn);
+        }
+    }
+
+    template <typename ElementBytes>
+    static std::size_t bytes(const void* node, unsigned shift, std::unordered_set<const void*>* seen,
+                             ElementBytes& elementBytes) {
+        if (node == nullptr || (seen != nullptr && !seen->insert(node).second)) {
+            return 0;
+        }
+        if (shift == 0) {
+            std::size_t total = sizeof(Leaf);
+            for (const T& value : static_cast<const Leaf*>(node)->values) {
+                total += elementBytes(value);
+            }
+            return total;
+        }
+        std::size_t total = sizeof(Branch);
+        for (const auto& child : static_cast<const Branch*>(node)->children) {
+            total += bytes(child.get(), shift - kBits, seen, elementBytes);
+        }
+        return total;
+    }
+
+    std::shared_ptr<void> root_;
+    /// Index bits below the root's level; 0 when the root is a leaf.
+    unsigned shift_ = 0;
+    std::size_t size_ = 0;
+};
+
+} // namespace rebel::core
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace rebel::core {
+
+/// Thrown by `CancellationToken::throwIfCancelled()`. Task groups treat it as
+/// a normal way for a task to stop, not as an error.
+class OperationCancelled : public std::runtime_error {
+public:
+    OperationCancelled() : std::runtime_error("operation cancelled") {}
+};
+
+/// Shared cancellation flag. Copies observe the same flag; a
+/// default-constructed token owns a fresh one.
+class CancellationToken {
+public:
+    CancellationToken() : flag_(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void cancel() const { flag_->store(true, std::memory_order_relaxed); }
+    bool isCancelled() const { return flag_->load(std::memory_order_relaxed); }
+    void throwIfCancelled() const {
+        if (isCancelled()) {
+            throw OperationCancelled();
+        }
+    }
+
+private:
+    std::shared_ptr<std::atomic<bool>> flag_;
+};
+
+/// Engine-wide work-stealing thread pool.
+///
+/// Each worker owns a deque: it pushes and pops its own tasks at the back
+/// (LIFO, cache-warm) and idle workers steal from the front of others
+/// (FIFO, oldest and usually largest work first). Tasks submitted from
+/// outside the pool go through a shared injection queue. Threads waiting
+/// on a group help by running queued tasks, so nested parallelism never
+/// blocks a worker.
+///
+/// All engines use `global()` instead of creating threads of their own.
+class TaskScheduler {
+public:
+    using Task = std::function<void()>;
+
+    /// `threadCount == 0` uses `std::thread::hardware_concurrency()`.
+    explicit TaskScheduler(unsigned threadCount = 0);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    /// Shared pool. Sized from `REBEL_THREADS` if set, else the hardware.
+    static TaskScheduler& global();
+
+    /// Replaces the shared pool with one of `threadCount` workers. Only call
+    /// while no work is in flight (benchmarks' thread-scaling runs).
+    static void setGlobalThreadCount(unsigned threadCount);
+
+    unsigned threadCount() const { return static_cast<unsigned>(workers_.size()); }
+
+    void submit(Task task);
+
+    /// Runs one queued task on the calling thread if any is available.
+    bool tryRunOne();
+
+    /// Index of the calling worker thread in its pool, or -1 elsewhere.
+    static int currentWorkerIndex();
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::thread thread;
+    };
+
+    void workerLoop(unsigned index);
+    bool popLocal(unsigned index, Task& task);
+    bool popInjected(Task& task);
+    bool steal(unsigned thief, Task& task);
+    bool findTask(int self, Task& task);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::mutex injectMutex_;
+    std::deque<Task> injected_;
+    std::atomic<std::size_t> queued_{0};
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+    std::atomic<unsigned> sleeping_{0};
+    bool stop_ = false;
+};
+
+/// A set of tasks that can be waited on together. Tasks added from within
+/// tasks of the same group are waited on as well. The first exception
+/// thrown by a task cancels the group and is rethrown by `wait()`.
+class TaskGroup {
+public:
+    /// Tasks are also skipped once `token` is cancelled. The group only
+    /// reads it: cancelling the group, or a task failing, leaves `token`
+    /// and every other user of it alone.
+    explicit TaskGroup(TaskScheduler& scheduler = TaskScheduler::global(),
+                       CancellationToken token = CancellationToken());
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    /// Queues `fn`. Skipped if the group is cancelled by the time it runs.
+    void run(std::function<void()> fn);
+
+    /// Blocks until every task finished, running queued tasks meanwhile.
+    void wait();
+
+    void cancel() { cancelled_.cancel(); }
+    bool isCancelled() const { return cancelled_.isCancelled() || token_.isCancelled(); }
+    /// The token given on construction.
+    const CancellationToken& token() const { return token_; }
+
+private:
+    struct State {
+        std::atomic<std::size_t> outstanding{0};
+        std::mutex errorMutex;
+        std::exception_ptr error;
+    };
+
+    TaskScheduler& scheduler_;
+    CancellationToken token_;
+    /// The group's own flag, set by `cancel()` and by the first failure.
+    CancellationToken cancelled_;
+    std::shared_ptr<State> state_;
+};
+
+/// Runs `fn(begin, end)` over `[first, last)` in chunks of at most `grain`
+/// items on the scheduler, returning when all chunks are done.
+template <typename Fn>
+void parallelFor(std::size_t first, std::size_t last, std::size_t grain, Fn&& fn,
+                 TaskScheduler& scheduler = TaskScheduler::global(),
+                 const CancellationToken& token = CancellationToken()) {
+    if (first >= last) {
+        return;
+    }
+    grain = grain == 0 ? 1 : grain;
+    if (last - first <= grain || scheduler.threadCount() <= 1) {
+        fn(first, last);
+        return;
+    }
+    TaskGroup group(scheduler, token);
+    for (std::size_t begin = first; begin < last; begin += grain) {
+        const std::size_t end = begin + grain < last ? begin + grain : last;
+        group.run([&fn, begin, end] { fn(begin, end); });
+    }
+    group.wait();
+}
+
+/// Static task graph: nodes run once all their predecessors finished
+/// (continuations), independent nodes run in parallel. The first failure
+/// cancels the rest of the run, not the token it was given. A graph can be
+/// run repeatedly.
+class TaskGraph {
+public:
+    using NodeId = std::uint32_t;
+
+    NodeId add(std::function<void()> fn);
+    /// `after` runs only once `before` completed.
+    void precede(NodeId before, NodeId after);
+
+    std::size_t size() const { return nodes_.size(); }
+
+    /// Executes the graph and blocks until done; rethrows the first error.
+    void run(TaskScheduler& scheduler = TaskScheduler::global(),
+             const CancellationToken& token = CancellationToken());
+
+private:
+    struct Node {
+        std::function<void()> fn;
+        std::vector<NodeId> successors;
+        std::uint32_t predecessors = 0;
+        std::atomic<std::uint32_t> remaining{0};
+    };
+
+    void schedule(TaskGroup& group, NodeId id);
+
+    std::vector<std::unique_ptr<Node>> nodes_;
+};
+
+} // namespace rebel::core
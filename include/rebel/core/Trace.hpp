@@ -0,0 +1,110 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+
+namespace rebel::core {
+
+/// Engine-wide tracing of scoped zones.
+///
+/// `REBEL_TRACE_ZONE("name")` opens a zone that closes at the end of the
+/// enclosing scope; `REBEL_TRACE_ZONE_DETAIL("name", detail)` also records a
+/// short string (a feature or part name, truncated to
+/// `kTraceDetailLength - 1` bytes) so a trace shows which one was slow.
+/// Names must be string literals or otherwise outlive the trace.
+///
+/// A zone is one event written when it closes, into a ring buffer owned by
+/// the recording thread, so threads never contend and a long capture keeps
+/// the most recent `kTraceEventsPerThread` zones of each thread. While
+/// tracing is stopped a zone costs one relaxed load; while it runs, two
+/// `traceClock()` reads and a 64-byte store.
+///
+/// The zones compile out entirely unless the library is built with
+/// `REBEL_TRACING` (CMake option `REBELCAD_TRACING`, on by default except in
+/// Release builds); the control and export functions below exist either way
+/// and then simply record nothing.
+inline constexpr std::size_t kTraceEventsPerThread = std::size_t(1) << 16;
+inline constexpr std::size_t kTraceDetailLength = 40;
+
+namespace detail {
+inline std::atomic<bool> tracing{false};
+void recordTraceEvent(const char* name, std::string_view detail, std::uint64_t begin, std::uint64_t end);
+} // namespace detail
+
+/// Discards everything recorded so far and starts recording.
+void startTracing();
+/// Stops recording; the events stay available for export.
+void stopTracing();
+inline bool tracingEnabled() { return detail::tracing.load(std::memory_order_relaxed); }
+
+/// Zone timestamp: the time stamp counter on x86 (a third the cost of a
+/// steady_clock read), nanoseconds elsewhere. Exports convert to time.
+std::uint64_t traceClock();
+
+/// Names the calling thread in exported traces ("main", "worker 3").
+void setTraceThreadName(std::string_view name);
+
+/// Events currently held across all threads.
+std::size_t traceEventCount();
+
+/// Writes the recorded events in the Chrome trace event format, which
+/// chrome://tracing and the Perfetto UI open directly. Call once the traced
+/// work has finished; zones still closing on other threads may be missed.
+void writeChromeTrace(std::ostream& out);
+/// Same, to a file; returns false if it cannot be written.
+bool writeChromeTrace(const std::string& path);
+
+class TraceZone {
+public:
+    explicit TraceZone(const char* name) {
+        if (tracingEnabled()) {
+            name_ = name;
+            begin_ = traceClock();
+        }
+    }
+    TraceZone(const char* name, std::string_view detail) : TraceZone(name) {
+        if (name_ != nullptr) {
+            std::size_t length = std::min(detail.size(), kTraceDetailLength - 1);
+            // Never cut a UTF-8 sequence in half.
+            while (length < detail.size() && length > 0 && (static_cast<unsigned char>(detail[length]) & 0xC0) == 0x80) {
+                --length;
+            }
+            detailLength_ = static_cast<std::uint8_t>(length);
+            std::memcpy(detail_, detail.data(), detailLength_);
+        }
+    }
+    ~TraceZone() {
+        if (name_ != nullptr) {
+            detail::recordTraceEvent(name_, {detail_, detailLength_}, begin_, traceClock());
+        }
+    }
+
+    TraceZone(const TraceZone&) = delete;
+    TraceZone& operator=(const TraceZone&) = delete;
+
+private:
+    const char* name_ = nullptr;
+    std::uint64_t begin_ = 0;
+    std::uint8_t detailLength_ = 0;
+    char detail_[kTraceDetailLength - 1];
+};
+
+} // namespace rebel::core
+
+#define REBEL_TRACE_CONCAT_(a, b) a##b
+#define REBEL_TRACE_CONCAT(a, b) REBEL_TRACE_CONCAT_(a, b)
+
+#if defined(REBEL_TRACING)
+#define REBEL_TRACE_ZONE(name) ::rebel::core::TraceZone REBEL_TRACE_CONCAT(rebelTraceZone, __LINE__)(name)
+#define REBEL_TRACE_ZONE_DETAIL(name, detail) \
+    ::rebel::core::TraceZone REBEL_TRACE_CONCAT(rebelTraceZone, __LINE__)(name, detail)
+#else
+#define REBEL_TRACE_ZONE(name) static_cast<void>(0)
+#define REBEL_TRACE_ZONE_DETAIL(name, detail) static_cast<void>(0)
+#endif
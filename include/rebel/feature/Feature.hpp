@@ -0,0 +1,106 @@
+#pragma once
+
+#include "rebel/core/Hash.hpp"
+#include "rebel/geometry/Mesh.hpp"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace rebel::feature {
+
+using FeatureId = std::uint32_t;
+inline constexpr FeatureId kInvalidFeature = 0xFFFFFFFFu;
+
+using ParameterValue = std::variant<double, std::int64_t, bool, std::string>;
+
+/// Named feature parameters (dimensions, depths, radii, flags). Ordered so
+/// the hash does not depend on insertion order.
+class Parameters {
+public:
+    void set(const std::string& name, ParameterValue value) { values_[name] = std::move(value); }
+    bool has(const std::string& name) const { return values_.count(name) != 0; }
+    const ParameterValue& get(const std::string& name) const { return values_.at(name); }
+
+    /// Typed accessors; throw `std::bad_variant_access` / `std::out_of_range`.
+    double number(const std::string& name) const { return std::get<double>(get(name)); }
+    std::int64_t integer(const std::string& name) const { return std::get<std::int64_t>(get(name)); }
+    bool flag(const std::string& name) const { return std::get<bool>(get(name)); }
+    const std::string& text(const std::string& name) const { return std::get<std::string>(get(name)); }
+
+    const std::map<std::string, ParameterValue>& values() const { return values_; }
+
+    void hashInto(core::Hasher& hasher) const;
+
+    bool operator==(const Parameters& o) const { return values_ == o.values_; }
+    bool operator!=(const Parameters& o) const { return !(*this == o); }
+
+private:
+    std::map<std::string, ParameterValue> values_;
+};
+
+/// Immutable output of a feature. Its content hash feeds the input hash of
+/// every downstream feature, so a result that comes out identical to the
+/// previous one stops regeneration from spreading further.
+class FeatureResult {
+public:
+    virtual ~FeatureResult() = default;
+    virtual core::Hash128 contentHash() const = 0;
+};
+
+using ResultPtr = std::shared_ptr<const FeatureResult>;
+
+/// Result holding a triangle mesh.
+class MeshResult final : public FeatureResult {
+public:
+    explicit MeshResult(geometry::Mesh mesh);
+
+    const geometry::Mesh& mesh() const { return mesh_; }
+    core::Hash128 contentHash() const override { return hash_; }
+
+private:
+    geometry::Mesh mesh_;
+    core::Hash128 hash_;
+};
+
+/// Result holding plain numbers (sketch solutions, measurements).
+class ValueResult final : public FeatureResult {
+public:
+    explicit ValueResult(std::vector<double> values);
+
+    const std::vector<double>& values() const { return values_; }
+    core::Hash128 contentHash() const override { return hash_; }
+
+private:
+    std::vector<double> values_;
+    core::Hash128 hash_;
+};
+
+/// Hash of a mesh's positions and topology.
+core::Hash128 hashMesh(const geometry::MeshView& mesh);
+
+/// A feature operation (sketch, extrude, fillet, ...). Implementations must
+/// be pure: the result may depend only on the parameters and input results,
+/// which is what makes hash-based skipping valid. `evaluate` may be called
+/// concurrently for different features.
+class FeatureOp {
+public:
+    virtual ~FeatureOp() = default;
+
+    /// Stable type name; part of the input hash.
+    virtual std::string_view type() const = 0;
+
+    /// Version of the algorithm; bump it when outputs change for equal
+    /// inputs so stale reuse (and cached results) are invalidated.
+    virtual std::uint32_t version() const { return 1; }
+
+    virtual ResultPtr evaluate(const Parameters& parameters, const std::vector<ResultPtr>& inputs) const = 0;
+};
+
+using FeatureOpPtr = std::shared_ptr<const FeatureOp>;
+
+} // namespace rebel::feature
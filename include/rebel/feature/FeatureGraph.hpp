@@ -0,0 +1,148 @@
+#pragma once
+
+#include "rebel/core/TaskScheduler.hpp"
+#include "rebel/feature/Feature.hpp"
+#include "rebel/feature/ResultCache.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace rebel::feature {
+
+enum class FeatureState {
+    /// Needs (re)evaluation on the next regeneration.
+    Dirty,
+    UpToDate,
+    /// Evaluation threw, or an input failed; see `error()`.
+    Failed,
+};
+
+struct RegenerationStats {
+    /// Features considered: the dirty ones plus everything downstream.
+    std::size_t visited = 0;
+    /// Features whose evaluator actually ran.
+    std::size_t evaluated = 0;
+    /// Features whose input hash was unchanged, so the old result was kept.
+    std::size_t reused = 0;
+    /// Features whose result came from the result cache instead.
+    std::size_t cached = 0;
+    std::size_t failed = 0;
+    /// The run was cancelled; features it did not reach are still dirty.
+    bool cancelled = false;
+
+    void merge(const RegenerationStats& other) {
+        visited += other.visited;
+        evaluated += other.evaluated;
+        reused += other.reused;
+        cached += other.cached;
+        failed += other.failed;
+        cancelled = cancelled || other.cancelled;
+    }
+};
+
+/// Parametric feature tree as a dependency DAG with incremental
+/// regeneration.
+///
+/// Each feature's input hash covers its op type/version, its parameters and
+/// the content hashes of its input results. Editing a parameter dirties one
+/// feature; `regenerate()` walks only that feature's downstream cone, and a
+/// feature whose input hash comes out unchanged keeps its previous result
+/// without running, which also stops the change from propagating past it.
+///
+/// With a `ResultCache` attached, a feature whose input hash changed is
+/// looked up there before it is evaluated, and evaluated results are stored
+/// back, so returning to earlier inputs (undo, redo, reopening a model)
+/// reuses results computed before, possibly by another session.
+class FeatureGraph {
+public:
+    /// Adds a feature. `inputs` must name existing features.
+    FeatureId add(std::string name, FeatureOpPtr op, Parameters parameters,
+                  std::vector<FeatureId> inputs = {});
+
+    std::size_t size() const { return nodes_.size(); }
+
+    /// Changes one parameter; a no-op if the value is unchanged.
+    void setParameter(FeatureId id, const std::string& name, ParameterValue value);
+    void setParameters(FeatureId id, Parameters parameters);
+
+    /// Rewires a feature's inputs. Throws `std::invalid_argument` if this
+    /// would create a cycle.
+    void setInputs(FeatureId id, std::vector<FeatureId> inputs);
+
+    /// Forces re-evaluation of `id` even if its inputs hash the same; the
+    /// result cache is bypassed for it too.
+    void invalidate(FeatureId id);
+
+    /// Drops the result of `id` to free its memory, e.g. under a memory
+    /// budget. The feature turns dirty and gets its result back on the next
+    /// `regenerate()`, from the result cache where it still has it.
+    void release(FeatureId id);
+
+    /// Shares `cache` with this graph (null detaches). One cache may serve
+    /// many graphs.
+    void setCache(std::shared_ptr<ResultCache> cache) { cache_ = std::move(cache); }
+    const std::shared_ptr<ResultCache>& cache() const { return cache_; }
+
+    const std::string& name(FeatureId id) const { return nodes_.at(id).name; }
+    const FeatureOpPtr& op(FeatureId id) const { return nodes_.at(id).op; }
+    const Parameters& parameters(FeatureId id) const { return nodes_.at(id).parameters; }
+    const std::vector<FeatureId>& inputs(FeatureId id) const { return nodes_.at(id).inputs; }
+    const std::vector<FeatureId>& dependents(FeatureId id) const { return nodes_.at(id).dependents; }
+    FeatureState state(FeatureId id) const { return nodes_.at(id).state; }
+    const std::string& error(FeatureId id) const { return nodes_.at(id).error; }
+    /// Latest result, or null if the feature never evaluated successfully.
+    const ResultPtr& result(FeatureId id) const { return nodes_.at(id).result; }
+    /// Input hash the current result was computed from.
+    const core::Hash128& inputHash(FeatureId id) const { return nodes_.at(id).inputHash; }
+
+    /// True if any feature is dirty.
+    bool needsRegeneration() const;
+
+    /// Features the next regeneration will visit, grouped into waves: no
+    /// feature depends on another in the same wave, so each wave can be
+    /// evaluated in parallel once the previous one finished.
+    std::vector<std::vector<FeatureId>> pendingWaves() const;
+
+    /// Regenerates the dirty features and their downstream cone. Waves run
+    /// on the global task scheduler. Cancelling `token` stops the run between
+    /// features; whatever was not reached stays dirty for the next call.
+    RegenerationStats regenerate(const core::CancellationToken& token = core::CancellationToken());
+
+    /// All features in dependency order.
+    std::vector<FeatureId> topologicalOrder() const;
+
+    /// Input hash `id` would have given the current input results. Only
+    /// meaningful once all of its inputs are up to date.
+    core::Hash128 computeInputHash(FeatureId id) const;
+
+    /// Evaluates one feature of a wave (inputs must already be regenerated)
+    /// and updates `stats`. Exposed for schedulers that run waves in
+    /// parallel; distinct features may be processed concurrently.
+    void regenerateFeature(FeatureId id, RegenerationStats& stats);
+
+private:
+    struct Node {
+        std::string name;
+        FeatureOpPtr op;
+        Parameters parameters;
+        std::vector<FeatureId> inputs;
+        std::vector<FeatureId> dependents;
+        ResultPtr result;
+        core::Hash128 inputHash;
+        FeatureState state = FeatureState::Dirty;
+        std::string error;
+        /// Set by edits; cleared by regeneration.
+        bool dirty = true;
+        /// Skip the hash comparison on the next regeneration.
+        bool forced = false;
+    };
+
+    void markDirty(FeatureId id);
+    bool reaches(FeatureId from, FeatureId to) const;
+
+    std::vector<Node> nodes_;
+    std::shared_ptr<ResultCache> cache_;
+};
+
+} // namespace rebel::feature
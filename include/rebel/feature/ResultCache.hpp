@@ -0,0 +1,112 @@
+#pragma once
+
+#include "rebel/core/Hash.hpp"
+#include "rebel/core/MemoryBudget.hpp"
+#include "rebel/feature/Feature.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rebel::feature {
+
+struct ResultCacheOptions {
+    /// Bytes of results kept in memory; least recently used go first.
+    std::size_t memoryBytes = std::size_t(512) << 20;
+    /// Directory of the persistent tier; empty keeps the cache in memory.
+    /// Any number of processes and machines may share one directory (a team
+    /// cache on network storage): entries are immutable files named by
+    /// their key and published with an atomic rename.
+    std::string directory;
+    /// Only read the persistent tier, never add to it.
+    bool readOnly = false;
+    /// Budget the memory tier also counts against, least recently used
+    /// entries going first; the cache registers for its lifetime.
+    core::MemoryBudget* budget = nullptr;
+};
+
+struct ResultCacheStats {
+    std::size_t memoryHits = 0;
+    std::size_t diskHits = 0;
+    std::size_t misses = 0;
+    std::size_t stores = 0;
+    /// Entries rejected on load (truncated, foreign or corrupt files).
+    std::size_t corrupt = 0;
+    /// Bytes of results currently held in memory.
+    std::size_t memoryBytes = 0;
+};
+
+/// Feature results keyed by feature input hash, in memory and on disk.
+///
+/// The input hash already covers the op type and version, the parameters
+/// and the content of every input result, so equal keys mean equal results
+/// no matter which model, session or machine computed them: undo/redo and
+/// edits back to an earlier value hit the memory tier, and reopening a
+/// model or opening a colleague's finds its results on disk.
+///
+/// `MeshResult` and `ValueResult` persist; other result types are cached
+/// in memory only. A loaded entry is checked against a hash of its bytes
+/// and the content hash it was stored with, so damaged files count as
+/// misses. All members are thread-safe, and disk I/O happens outside the
+/// lock.
+class ResultCache final : public core::MemoryConsumer {
+public:
+    explicit ResultCache(ResultCacheOptions options = {});
+    ~ResultCache() override;
+
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    /// Result stored under `key`, from memory or else from disk (and then
+    /// kept in memory); null if neither has it.
+    ResultPtr find(const core::Hash128& key);
+
+    /// Adds a result. Disk writes are skipped for keys already on disk.
+    void store(const core::Hash128& key, const ResultPtr& result);
+
+    /// Drops the memory tier; the persistent one is kept.
+    void clearMemory();
+
+    /// Deletes the least recently used entries on disk (by file time, which
+    /// stores and disk hits refresh) until at most `maxBytes` remain.
+    /// Returns the bytes removed.
+    std::uintmax_t pruneDisk(std::uintmax_t maxBytes);
+
+    ResultCacheStats stats() const;
+    const ResultCacheOptions& options() const { return options_; }
+
+    std::string_view memoryName() const override { return "feature.result_cache"; }
+    std::size_t memoryBytes() const override;
+    void evictionCandidates(std::vector<core::MemoryItem>& out) const override;
+    std::size_t evictOlderThan(std::uint64_t stamp) override;
+
+    /// Persistent encoding of `result`; false for types that only live in
+    /// memory.
+    static bool encode(const FeatureResult& result, std::vector<std::uint8_t>& out);
+    /// Inverse of `encode`; null for malformed or corrupt data.
+    static ResultPtr decode(const std::uint8_t* data, std::size_t size);
+
+private:
+    struct Entry {
+        ResultPtr result;
+        std::size_t bytes = 0;
+        std::uint64_t lastUse = 0;
+        std::list<core::Hash128>::iterator lru;
+    };
+
+    void insertLocked(const core::Hash128& key, const ResultPtr& result);
+    std::string pathOf(const core::Hash128& key) const;
+
+    ResultCacheOptions options_;
+    mutable std::mutex mutex_;
+    std::unordered_map<core::Hash128, Entry> entries_;
+    /// Most recently used first.
+    std::list<core::Hash128> lru_;
+    ResultCacheStats stats_;
+};
+
+} // namespace rebel::feature
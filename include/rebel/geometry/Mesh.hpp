@@ -0,0 +1,145 @@
+#pragma once
+
+#include "rebel/core/AlignedAllocator.hpp"
+#include "rebel/math/Aabb.hpp"
+#include "rebel/math/Vec.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rebel::geometry {
+
+using VertexIndex = std::uint32_t;
+using CornerIndex = std::uint32_t;
+using TriangleIndex = std::uint32_t;
+
+/// Marks a missing vertex/corner/triangle (boundary or non-manifold edge).
+inline constexpr std::uint32_t kInvalidIndex = 0xFFFFFFFFu;
+
+/// Corner-table navigation. Triangle `t` owns corners 3t, 3t+1, 3t+2.
+constexpr TriangleIndex triangleOf(CornerIndex c) { return c / 3; }
+constexpr CornerIndex nextCorner(CornerIndex c) { return c % 3 == 2 ? c - 2 : c + 1; }
+constexpr CornerIndex prevCorner(CornerIndex c) { return c % 3 == 0 ? c + 2 : c - 1; }
+
+/// Non-owning view of mesh arrays. Every kernel in the geometry module works
+/// on a view, so the same code runs over owned meshes and over arrays mapped
+/// straight from a file. Optional arrays are null when absent.
+struct MeshView {
+    const float* px = nullptr;
+    const float* py = nullptr;
+    const float* pz = nullptr;
+    const float* nx = nullptr;
+    const float* ny = nullptr;
+    const float* nz = nullptr;
+    const float* u = nullptr;
+    const float* v = nullptr;
+    /// Vertex index per corner, 3 per triangle.
+    const VertexIndex* corners = nullptr;
+    /// Opposite corner per corner, or `kInvalidIndex` across a boundary.
+    const CornerIndex* opposites = nullptr;
+    std::size_t vertexCount = 0;
+    std::size_t triangleCount = 0;
+
+    bool hasNormals() const { return nx != nullptr; }
+    bool hasUvs() const { return u != nullptr; }
+    bool hasConnectivity() const { return opposites != nullptr; }
+
+    math::Vec3f position(VertexIndex i) const { return {px[i], py[i], pz[i]}; }
+    math::Vec3f normal(VertexIndex i) const { return {nx[i], ny[i], nz[i]}; }
+    math::Vec2f uv(VertexIndex i) const { return {u[i], v[i]}; }
+    VertexIndex vertex(CornerIndex c) const { return corners[c]; }
+    CornerIndex opposite(CornerIndex c) const { return opposites[c]; }
+
+    /// Corner on the next triangle around `vertex(c)`, or `kInvalidIndex` at
+    /// a boundary. Requires connectivity.
+    CornerIndex swing(CornerIndex c) const {
+        const CornerIndex o = opposites[nextCorner(c)];
+        return o == kInvalidIndex ? kInvalidIndex : nextCorner(o);
+    }
+
+    math::Aabb bounds() const;
+    math::Aabb triangleBounds(TriangleIndex t) const;
+};
+
+/// Triangle mesh stored as structure-of-arrays.
+///
+/// Each attribute component lives in its own cache-line aligned array and
+/// topology is a corner table (vertex per corner plus opposite corner), so a
+/// triangle costs 12 bytes of indices, 12 more once connectivity is built,
+/// and a vertex costs exactly the attributes it carries.
+class Mesh {
+public:
+    Mesh() = default;
+
+    std::size_t vertexCount() const { return px_.size(); }
+    std::size_t triangleCount() const { return corners_.size() / 3; }
+    bool hasNormals() const { return hasNormals_; }
+    bool hasUvs() const { return hasUvs_; }
+    bool hasConnectivity() const { return !opposites_.empty(); }
+
+    void reserve(std::size_t vertices, std::size_t triangles);
+    void clear();
+
+    /// Appends a vertex and returns its index. If normals or UVs are enabled
+    /// the new vertex gets zeroed attributes.
+    VertexIndex addVertex(const math::Vec3f& position);
+    /// Appends a triangle. Invalidates connectivity.
+    TriangleIndex addTriangle(VertexIndex a, VertexIndex b, VertexIndex c);
+
+    /// Resizes the vertex arrays, zero-filling new entries.
+    void resizeVertices(std::size_t count);
+    /// Resizes the corner array to `count` triangles. Invalidates connectivity.
+    void resizeTriangles(std::size_t count);
+
+    /// Allocates the normal / UV arrays (zero-filled) if they are absent.
+    void enableNormals();
+    void enableUvs();
+
+    math::Vec3f position(VertexIndex i) const { return {px_[i], py_[i], pz_[i]}; }
+    void setPosition(VertexIndex i, const math::Vec3f& p) { px_[i] = p.x; py_[i] = p.y; pz_[i] = p.z; }
+    math::Vec3f normal(VertexIndex i) const { return {nx_[i], ny_[i], nz_[i]}; }
+    void setNormal(VertexIndex i, const math::Vec3f& n) { nx_[i] = n.x; ny_[i] = n.y; nz_[i] = n.z; }
+    math::Vec2f uv(VertexIndex i) const { return {u_[i], v_[i]}; }
+    void setUv(VertexIndex i, const math::Vec2f& t) { u_[i] = t.x; v_[i] = t.y; }
+    VertexIndex vertex(CornerIndex c) const { return corners_[c]; }
+
+    /// Raw component arrays for bulk kernels.
+    float* px() { return px_.data(); }
+    float* py() { return py_.data(); }
+    float* pz() { return pz_.data(); }
+    float* nx() { return nx_.data(); }
+    float* ny() { return ny_.data(); }
+    float* nz() { return nz_.data(); }
+    float* u() { return u_.data(); }
+    float* v() { return v_.data(); }
+    VertexIndex* corners() { return corners_.data(); }
+
+    /// Builds the opposite-corner table. Edges shared by more than two
+    /// triangles, or by two whose windings disagree (both traverse it in
+    /// the same direction), are treated as boundaries; returns the number
+    /// of such non-manifold edges.
+    std::size_t buildConnectivity();
+
+    /// Recomputes per-vertex normals as area-weighted face normal sums.
+    void computeVertexNormals();
+
+    math::Aabb bounds() const { return view().bounds(); }
+
+    /// Heap bytes held by the attribute and index arrays.
+    std::size_t memoryBytes() const;
+
+    MeshView view() const;
+
+private:
+    void invalidateConnectivity() { opposites_.clear(); }
+
+    core::AlignedVector<float> px_, py_, pz_;
+    core::AlignedVector<float> nx_, ny_, nz_;
+    core::AlignedVector<float> u_, v_;
+    core::AlignedVector<VertexIndex> corners_;
+    core::AlignedVector<CornerIndex> opposites_;
+    bool hasNormals_ = false;
+    bool hasUvs_ = false;
+};
+
+} // namespace rebel::geometry
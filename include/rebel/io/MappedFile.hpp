@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace rebel::io {
+
+/// Read-only memory mapping of a whole file. Pages are brought in by the OS
+/// on first touch and shared with every other process mapping the same
+/// file, so opening costs the same for a 4 KB and a 4 GB file.
+///
+/// Always handled through `std::shared_ptr<const MappedFile>`: anything
+/// that points into the mapping (mesh views, BVH arrays) holds a reference
+/// and keeps it alive.
+class MappedFile {
+public:
+    /// Maps `path`; throws `std::runtime_error` if it cannot be opened or
+    /// mapped.
+    static std::shared_ptr<const MappedFile> open(const std::string& path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const std::string& path() const { return path_; }
+    const std::uint8_t* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+    /// Asks the OS to start reading `[offset, offset + size)` in ahead of
+    /// use. Only a hint; out-of-range parts are ignored.
+    void prefetch(std::size_t offset, std::size_t size) const;
+
+private:
+    MappedFile() = default;
+
+    std::string path_;
+    const std::uint8_t* data_ = nullptr;
+    std::size_t size_ = 0;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+};
+
+} // namespace rebel::io
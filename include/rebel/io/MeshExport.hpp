@@ -0,0 +1,78 @@
+#pragma once
+
+#include "rebel/assembly/Assembly.hpp"
+#include "rebel/assembly/PartLibrary.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace rebel::io {
+
+enum class MeshFormat {
+    /// Binary STL: one triangle soup, every occurrence flattened into it.
+    Stl,
+    /// 3MF package: one mesh object per part, one build item per
+    /// occurrence.
+    ThreeMf,
+    /// Binary glTF 2.0 (`.glb`): one mesh per part, the assembly tree as
+    /// nodes referencing them.
+    Gltf,
+};
+
+/// Format named by the extension of `path` (`.stl`, `.3mf`, `.glb`, case
+/// insensitive). Throws `std::invalid_argument` for anything else.
+MeshFormat meshFormatForPath(const std::string& path);
+
+struct MeshExportOptions {
+    /// Occurrences hidden in the assembly (themselves or through a parent)
+    /// are left out unless set. Suppressed ones are always left out.
+    bool includeHidden = false;
+    /// The model is Z-up; glTF is Y-up, so the root node turns it upright.
+    /// Clear for models that are Y-up already.
+    bool zUp = true;
+    /// Encoded output buffered ahead of the writer at most. Bounds memory
+    /// whatever the size of the file.
+    std::size_t windowBytes = std::size_t(64) << 20;
+};
+
+struct MeshExportStats {
+    std::size_t occurrences = 0;
+    /// Part meshes written: once per part for 3MF and glTF, once per
+    /// occurrence for STL.
+    std::size_t meshes = 0;
+    /// Triangles stored in the file.
+    std::size_t triangles = 0;
+    std::size_t bytes = 0;
+};
+
+/// Exports the visible occurrences of `assembly`, meshes taken from
+/// `library`, to `path`. Parts are exported as tessellated: tessellate
+/// them first (e.g. with `brep::tessellate()` or the feature graph) at the
+/// tolerances the file is for. Welded part meshes stay watertight: every
+/// use of a vertex is written from the same value, and STL, where
+/// transforms are applied on export, flips mirrored occurrences so their
+/// triangles keep facing out.
+///
+/// Parts and, within large parts, ranges of vertices and triangles are
+/// encoded in parallel on the task scheduler, a window at a time, while
+/// the previous window is being written through `OutputFile`, so memory
+/// stays bounded by `MeshExportOptions::windowBytes` and the file only
+/// replaces `path` once complete. Instanced parts are stored once for 3MF
+/// and glTF and referenced by every occurrence, with occurrence colors as
+/// glTF materials.
+///
+/// Throws `std::runtime_error` if the file cannot be written or the model
+/// does not fit the format (binary STL holds at most 2^32 - 1 triangles,
+/// binary glTF 4 GB).
+MeshExportStats exportMesh(const assembly::Assembly& assembly, const assembly::PartLibrary& library,
+                           const std::string& path, MeshFormat format, const MeshExportOptions& options = {});
+
+namespace detail {
+/// CRC-32 as stored in ZIP entries.
+std::uint32_t crc32(const std::uint8_t* data, std::size_t size);
+/// CRC of `a` followed by `b` from their CRCs and the size of `b`.
+std::uint32_t crc32Combine(std::uint32_t crcA, std::uint32_t crcB, std::uint64_t sizeB);
+} // namespace detail
+
+} // namespace rebel::io
@@ -0,0 +1,176 @@
+#pragma once
+
+#include "rebel/assembly/Assembly.hpp"
+#include "rebel/assembly/Part.hpp"
+#include "rebel/assembly/PartLibrary.hpp"
+#include "rebel/brep/Body.hpp"
+#include "rebel/io/MappedFile.hpp"
+#include "rebel/io/NativeLayout.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace rebel::io {
+
+/// Writes native documents (see `NativeLayout.hpp`). Parts are collected
+/// first and streamed out section by section by `write()`.
+class NativeWriter {
+public:
+    /// Queues `part` (and optionally the B-rep it was tessellated from) and
+    /// returns its part record index. `lods` are coarser versions of the
+    /// part, finest first, e.g. parts made from the coarser levels of a
+    /// `brep::tessellate()` result; they are what graphics-only loading
+    /// reads. Adding the same part again returns the existing index and
+    /// ignores the other arguments.
+    std::uint32_t addPart(const assembly::PartPtr& part, const brep::Body* body = nullptr,
+                          std::vector<assembly::PartPtr> lods = {});
+
+    /// Stores the structure of `assembly`; every part it references is
+    /// taken from `library` and queued. Removed nodes are dropped and the
+    /// rest renumbered depth-first.
+    void setAssembly(const assembly::Assembly& assembly, const assembly::PartLibrary& library);
+
+    /// Throws `std::runtime_error` if the file cannot be written.
+    void write(const std::string& path) const;
+
+private:
+    struct PendingPart {
+        assembly::PartPtr part;
+        std::optional<brep::Body> body;
+        std::vector<assembly::PartPtr> lods;
+    };
+
+    std::vector<PendingPart> parts_;
+    std::unordered_map<const assembly::Part*, std::uint32_t> partIndex_;
+    std::vector<layout::NodeRecord> nodes_;
+    std::vector<std::string> nodeNames_;
+};
+
+struct NativePartInfo {
+    std::string_view name;
+    math::Aabb bounds;
+    std::size_t vertexCount = 0;
+    std::size_t triangleCount = 0;
+    /// Bytes of the part's section, i.e. what loading it may page in.
+    std::size_t sectionBytes = 0;
+    bool hasBody = false;
+    /// Stored coarse levels of detail, not counting the full part.
+    std::size_t lodCount = 0;
+};
+
+enum class LoadDetail {
+    /// Full-resolution meshes and BVHs.
+    Full,
+    /// Each part's stored level of detail instead (or the full part if it
+    /// has none): enough to view, pick and measure, and only the dense LOD
+    /// sections of the file are paged in. Full parts are brought in one by
+    /// one with `NativeDocument::loadForEditing`.
+    Graphics,
+};
+
+struct NativeLoadOptions {
+    LoadDetail detail = LoadDetail::Full;
+    /// Level used by `LoadDetail::Graphics`, 0 being the finest stored one;
+    /// clamped to the coarsest level each part has.
+    std::uint32_t lod = 0;
+};
+
+/// A part brought in at full resolution by `NativeDocument::loadForEditing`.
+struct EditablePart {
+    assembly::PartId id = assembly::kInvalidPart;
+    assembly::PartPtr part;
+    /// The B-rep, for parts stored with one.
+    std::optional<brep::Body> body;
+};
+
+/// Native document opened through a memory mapping.
+///
+/// Opening maps the file and checks the header and tables; no section is
+/// touched. `loadPart` hands out parts whose mesh arrays and BVH point
+/// straight into the mapping, so nothing is copied and the pages are shared
+/// through the OS page cache by every process that maps the file. Loaded
+/// parts keep the mapping alive.
+///
+/// Loading checks every index a section holds (triangle corners, BVH
+/// children and leaves, tree depth) in one pass, so a damaged file is
+/// rejected rather than read out of bounds. For files from untrusted
+/// sources call `verifyPart` as well, which hashes the whole section.
+class NativeDocument {
+public:
+    static constexpr std::uint32_t kNotFound = layout::kNone;
+
+    /// Throws `std::runtime_error` if the file is missing, not a native
+    /// document, written with another byte order or version, or truncated.
+    static std::shared_ptr<const NativeDocument> open(const std::string& path);
+
+    const MappedFile& file() const { return *file_; }
+
+    std::size_t partCount() const { return partCount_; }
+    NativePartInfo partInfo(std::uint32_t part) const;
+    /// Record index of the part named `name`, or `kNotFound`.
+    std::uint32_t findPart(std::string_view name) const;
+
+    /// Zero-copy part; throws `std::runtime_error` if the section's arrays
+    /// do not fit the file or disagree with its record, or an index in them
+    /// is out of range.
+    assembly::PartPtr loadPart(std::uint32_t part) const;
+    /// Zero-copy level of detail `lod` of a part (0 is the finest stored
+    /// level; clamped to the coarsest), named like the full part so it can
+    /// stand in for it in a library. The full part if it has no levels.
+    assembly::PartPtr loadLod(std::uint32_t part, std::uint32_t lod) const;
+    /// Loads the full part and its B-rep and swaps it in for whatever is
+    /// registered under its name in `library` (typically a level of detail
+    /// from a graphics-only load), so occurrences pick it up without
+    /// touching the assembly. Adds it if the library does not have it yet.
+    EditablePart loadForEditing(std::uint32_t part, assembly::PartLibrary& library) const;
+    /// True if the section matches the hash recorded when it was written.
+    bool verifyPart(std::uint32_t part) const;
+    /// Rebuilds the B-rep stored with a part; throws `std::runtime_error` if
+    /// it has none.
+    brep::Body loadBody(std::uint32_t part) const;
+
+    bool hasAssembly() const { return nodeCount_ > 0; }
+    std::size_t nodeCount() const { return nodeCount_; }
+    const layout::NodeRecord& node(std::uint32_t node) const;
+    std::string_view nodeName(std::uint32_t node) const;
+
+    /// Copies the subtree below file node `node` under `parent` in `target`
+    /// and returns the copy's id. `node` itself is copied too unless it is
+    /// the root, whose children go straight under `parent`. Only the parts
+    /// this subtree references are loaded; parts already in `library` under
+    /// the same name are reused, whatever detail they were loaded at.
+    assembly::NodeId loadSubassembly(std::uint32_t node, assembly::Assembly& target, assembly::NodeId parent,
+                                     assembly::PartLibrary& library, const NativeLoadOptions& options = {}) const;
+
+    /// Whole assembly: `loadSubassembly(0, target, target.root(), library)`.
+    void loadAssembly(assembly::Assembly& target, assembly::PartLibrary& library,
+                      const NativeLoadOptions& options = {}) const;
+
+private:
+    NativeDocument() = default;
+
+    const layout::PartRecord& record(std::uint32_t part) const;
+    assembly::PartPtr load(const layout::PartRecord& record) const;
+    std::string_view string(const layout::StringRef& ref) const;
+    /// Pointer to a validated array of `T`, or null if the array is absent.
+    template <typename T>
+    const T* array(const layout::PartRecord& record, layout::PartArray which, std::uint64_t expectedCount) const;
+
+    std::shared_ptr<const MappedFile> file_;
+    const layout::PartRecord* parts_ = nullptr;
+    std::size_t partCount_ = 0;
+    const layout::PartRecord* lods_ = nullptr;
+    std::size_t lodCount_ = 0;
+    const char* strings_ = nullptr;
+    std::size_t stringBytes_ = 0;
+    const layout::NodeRecord* nodes_ = nullptr;
+    std::size_t nodeCount_ = 0;
+    std::unordered_map<std::string_view, std::uint32_t> byName_;
+};
+
+} // namespace rebel::io
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "rebel/core/Hash.hpp"
+#include "rebel/math/Aabb.hpp"
+#include "rebel/math/Mat4.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+/// On-disk layout of the native `.rbl` document format.
+///
+/// A file is a header, a sequence of page-aligned part sections, the
+/// sections of the parts' coarse levels of detail packed back to back, then
+/// the tables (part records, level-of-detail records, string blob, assembly
+/// node records). Every array
+/// inside a section starts on a 64-byte boundary and holds exactly the bytes
+/// the in-memory structure holds (SoA mesh components, corner table,
+/// `BvhNode`s, leaf-ordered triangle batches, B-rep tables), so a mapped
+/// section is used in place without any parsing. Byte order is the writer's
+/// native order, recorded in the header and checked on open.
+namespace rebel::io::layout {
+
+inline constexpr char kMagic[8] = {'R', 'E', 'B', 'E', 'L', 'C', 'A', 'D'};
+inline constexpr std::uint32_t kVersion = 2;
+inline constexpr std::uint32_t kByteOrderMark = 0x01020304u;
+
+/// Arrays start on cache-line boundaries, matching `core::AlignedVector`.
+inline constexpr std::size_t kArrayAlignment = 64;
+/// Part sections start on page boundaries, so loading one part never faults
+/// in pages of its neighbours. Level-of-detail sections are only
+/// array-aligned: they are small and read together, and keeping them dense
+/// is what makes a graphics-only load cheap.
+inline constexpr std::size_t kSectionAlignment = 4096;
+
+inline constexpr std::uint32_t kNone = 0xFFFFFFFFu;
+
+/// `count` elements at absolute file offset `offset`; `count == 0` means
+/// the array is absent.
+struct ArrayRef {
+    std::uint64_t offset = 0;
+    std::uint64_t count = 0;
+};
+
+struct StringRef {
+    std::uint32_t offset = 0;
+    std::uint32_t length = 0;
+};
+
+struct FileHeader {
+    char magic[8] = {};
+    std::uint32_t version = 0;
+    std::uint32_t byteOrder = 0;
+    std::uint64_t fileSize = 0;
+    /// `PartRecord`s.
+    ArrayRef parts;
+    /// UTF-8 bytes referenced by `StringRef`s.
+    ArrayRef strings;
+    /// `NodeRecord`s in depth-first order; node 0 is the root. Absent when
+    /// the file holds parts only.
+    ArrayRef nodes;
+    /// `PartRecord`s of coarse levels of detail, see `PartRecord::lodCount`.
+    ArrayRef lods;
+    /// Hash of the four tables, checked on open.
+    core::Hash128 tablesHash;
+    std::uint8_t reserved[24] = {};
+};
+
+static_assert(sizeof(FileHeader) == 128, "FileHeader must stay 128 bytes");
+
+/// Arrays of one part section, in file order.
+enum PartArray : std::uint32_t {
+    kPx,
+    kPy,
+    kPz,
+    kNx,
+    kNy,
+    kNz,
+    kU,
+    kV,
+    kCorners,
+    kOpposites,
+    kBvhNodes,
+    kBvhPrimitives,
+    kV0x,
+    kV0y,
+    kV0z,
+    kE1x,
+    kE1y,
+    kE1z,
+    kE2x,
+    kE2y,
+    kE2z,
+    kBrepVertices,
+    kBrepEdges,
+    kBrepFaces,
+    kBrepCurves,
+    kBrepSurfaces,
+    kPartArrayCount,
+};
+
+struct PartRecord {
+    enum Flags : std::uint32_t {
+        kHasBody = 1u << 0,
+    };
+
+    StringRef name;
+    std::uint64_t vertexCount = 0;
+    std::uint64_t triangleCount = 0;
+    math::Aabb bounds;
+    std::uint32_t flags = 0;
+    /// Coarse levels of detail, finest first, at `firstLod` in the LOD
+    /// table. They carry mesh and BVH arrays only and share `name`.
+    std::uint32_t lodCount = 0;
+    std::uint64_t sectionOffset = 0;
+    std::uint64_t sectionSize = 0;
+    /// Hash of the section bytes, checked only on request.
+    core::Hash128 sectionHash;
+    ArrayRef arrays[kPartArrayCount];
+    std::uint32_t firstLod = kNone;
+    std::uint32_t reserved = 0;
+};
+
+static_assert(sizeof(PartRecord) == 512, "PartRecord layout changed; bump kVersion");
+
+/// Same shape as `assembly::AssemblyNode`, with `part` a part record index
+/// and links indexing node records.
+struct NodeRecord {
+    math::Mat4f local;
+    std::uint32_t part = kNone;
+    std::uint32_t parent = kNone;
+    std::uint32_t firstChild = kNone;
+    std::uint32_t nextSibling = kNone;
+    std::uint32_t colorRgba = 0;
+    std::uint32_t overrideFlags = 0;
+    StringRef name;
+};
+
+static_assert(sizeof(NodeRecord) == 96, "NodeRecord must stay 96 bytes");
+
+/// B-rep edge; `curve` indexes the curve table.
+struct BrepEdgeRecord {
+    std::uint32_t curve = 0;
+    std::uint32_t start = 0;
+    std::uint32_t end = 0;
+    std::uint32_t reserved = 0;
+    double t0 = 0.0;
+    double t1 = 1.0;
+};
+
+/// B-rep face; `surface` indexes the surface table, bit i of
+/// `reversedSides` is side i's coedge direction.
+struct BrepFaceRecord {
+    std::uint32_t surface = 0;
+    std::uint32_t reversed = 0;
+    std::uint32_t sideEdges[4] = {};
+    std::uint32_t reversedSides = 0;
+    std::uint32_t reserved = 0;
+    double u0 = 0.0;
+    double u1 = 1.0;
+    double v0 = 0.0;
+    double v1 = 1.0;
+};
+
+static_assert(std::is_trivially_copyable_v<PartRecord> && std::is_trivially_copyable_v<NodeRecord> &&
+                  std::is_trivially_copyable_v<BrepEdgeRecord> && std::is_trivially_copyable_v<BrepFaceRecord>,
+              "layout records are written and mapped as raw bytes");
+
+} // namespace rebel::io::layout
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rebel::io {
+
+/// Sequential file output for large exports. Buffers are queued without
+/// copying and handed to the OS many at a time with one vectored write
+/// (`writev`), so encoders can produce output in independent chunks and
+/// the writer never reassembles them into one stream in memory.
+///
+/// Output goes to `path + ".partial"` and only replaces `path` on
+/// `commit()`; a writer destroyed before that, e.g. by an exception,
+/// deletes the partial file and leaves any existing file untouched.
+class OutputFile {
+public:
+    /// Throws `std::runtime_error` if the staging file cannot be created.
+    explicit OutputFile(std::string path);
+    ~OutputFile();
+
+    OutputFile(const OutputFile&) = delete;
+    OutputFile& operator=(const OutputFile&) = delete;
+
+    const std::string& path() const { return path_; }
+    /// Bytes written so far, queued ones included.
+    std::uint64_t position() const { return position_; }
+
+    /// Copies `size` bytes; meant for headers, padding and other small
+    /// pieces between chunks.
+    void write(const void* data, std::size_t size);
+    /// Queues `chunk` as it is.
+    void write(std::vector<std::uint8_t> chunk);
+
+    /// Writes everything queued. Throws `std::runtime_error` on failure.
+    void flush();
+    /// Flushes, closes and renames over `path`. Throws `std::runtime_error`
+    /// on failure.
+    void commit();
+
+private:
+    void close();
+
+    std::string path_;
+    std::string staging_;
+#ifdef _WIN32
+    void* handle_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+    std::vector<std::vector<std::uint8_t>> pending_;
+    std::size_t pendingBytes_ = 0;
+    /// True while `pending_.back()` collects small writes.
+    bool small_ = false;
+    std::uint64_t position_ = 0;
+    bool committed_ = false;
+};
+
+} // namespace rebel::io
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "rebel/io/MappedFile.hpp"
+#include "rebel/io/NativeLayout.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace rebel::io {
+
+/// A named blob of a `ResourceBundle`, pointing into the mapping.
+struct Resource {
+    std::string_view name;
+    const std::uint8_t* data = nullptr;
+    std::size_t size = 0;
+
+    std::string_view text() const { return {reinterpret_cast<const char*>(data), size}; }
+};
+
+class ResourceBundle;
+
+/// Precompiles startup resources (shaders, icons, material libraries, ...)
+/// into one bundle file for `ResourceBundle`.
+///
+/// The same writer keeps data produced at run time between runs, such as a
+/// graphics driver's pipeline cache: carry the current bundle forward with
+/// `addBundle`, add the new blob under a name specific to the device and
+/// driver, and write the bundle back over itself.
+class ResourceBundleWriter {
+public:
+    /// A later resource of the same name replaces the earlier one.
+    void add(std::string name, const void* data, std::size_t size);
+    void add(std::string name, std::vector<std::uint8_t> bytes);
+    /// Throws `std::runtime_error` if the file cannot be read.
+    void addFile(std::string name, const std::string& path);
+    /// Every resource of `bundle`, referenced rather than copied.
+    void addBundle(const std::shared_ptr<const ResourceBundle>& bundle);
+
+    std::size_t size() const { return pending_.size(); }
+
+    /// Writes next to `path` and renames over it, so readers mapping the
+    /// old bundle keep their pages. Throws `std::runtime_error` on failure.
+    void write(const std::string& path) const;
+
+private:
+    struct Pending {
+        /// Keeps `data` alive.
+        std::shared_ptr<const void> storage;
+        const std::uint8_t* data = nullptr;
+        std::size_t size = 0;
+    };
+
+    std::map<std::string, Pending, std::less<>> pending_;
+};
+
+/// Read-only resource bundle opened through a memory mapping.
+///
+/// A bundle is a header, the resources' bytes back to back on 64-byte
+/// boundaries, and a table of resources sorted by name. Opening maps the
+/// file and checks the header and the table; lookups are binary searches
+/// of the table and hand out pointers into the mapping, so only the pages
+/// of resources actually used are ever read, and every process started from
+/// the same bundle shares them through the OS page cache. Resources stay
+/// valid for as long as the bundle.
+///
+/// Resource bytes are used as mapped. `verify` checks one against the hash
+/// recorded when the bundle was written.
+class ResourceBundle {
+public:
+    static constexpr std::uint32_t kNotFound = layout::kNone;
+
+    /// Throws `std::runtime_error` if the file is missing, not a bundle,
+    /// written with another byte order or version, or truncated.
+    static std::shared_ptr<const ResourceBundle> open(const std::string& path);
+
+    const MappedFile& file() const { return *file_; }
+
+    std::size_t size() const { return entryCount_; }
+    /// Resource `index`, in name order; throws `std::out_of_range`.
+    Resource resource(std::uint32_t index) const;
+    /// Index of the resource named `name`, or `kNotFound`.
+    std::uint32_t find(std::string_view name) const;
+    /// Throws `std::out_of_range` if there is no resource named `name`.
+    Resource get(std::string_view name) const;
+    /// Indices `[first, last)` of the resources whose names start with
+    /// `prefix`, e.g. "shaders/" for everything a module needs.
+    std::pair<std::uint32_t, std::uint32_t> range(std::string_view prefix) const;
+
+    /// True if the resource matches the hash recorded when it was written.
+    bool verify(std::uint32_t index) const;
+    /// Asks the OS to read the resources in `[first, last)` ahead of use.
+    void prefetch(std::uint32_t first, std::uint32_t last) const;
+
+private:
+    friend class ResourceBundleWriter;
+    /// Table record, defined with the file layout.
+    struct Entry;
+
+    ResourceBundle() = default;
+
+    std::string_view name(std::uint32_t index) const;
+
+    std::shared_ptr<const MappedFile> file_;
+    const Entry* entries_ = nullptr;
+    std::size_t entryCount_ = 0;
+    const char* strings_ = nullptr;
+    std::size_t stringBytes_ = 0;
+};
+
+} // namespace rebel::io
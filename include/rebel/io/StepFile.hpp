@@ -0,0 +1,151 @@
+#pragma once
+
+#include "rebel/io/MappedFile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rebel::io {
+
+using StepId = std::uint64_t;
+
+/// Entity instance of a STEP (ISO 10303-21) file. For simple instances
+/// `type` is the entity keyword and `params` the parenthesized parameter
+/// list; complex instances have an empty `type` and `params` holding the
+/// whole `(A(...) B(...))` list, see `StepFile::component`.
+struct StepEntity {
+    StepId id = 0;
+    std::string_view type;
+    std::string_view params;
+
+    bool valid() const { return id != 0; }
+    bool isComplex() const { return valid() && type.empty(); }
+};
+
+struct StepIndexOptions {
+    /// Bytes each indexing task scans.
+    std::size_t chunkBytes = std::size_t{8} << 20;
+};
+
+/// Indexed, memory-mapped STEP physical file.
+///
+/// Opening tokenizes the file in parallel chunks: every chunk first works
+/// out, for each lexer state it could start in, the state it ends in; the
+/// true start states then follow from a cheap prefix pass and all chunks
+/// locate their statements in parallel. What stays in memory is one
+/// 24-byte record per entity (id, type, location of its text); parameters
+/// are parsed only when an entity is looked at, straight from the mapping,
+/// so the entity graph is never materialized and memory stays far below
+/// the file size. Lookups by id are safe from any number of threads.
+class StepFile {
+public:
+    /// Throws `std::runtime_error` if the file cannot be mapped or is not an
+    /// ISO 10303-21 exchange structure.
+    static std::shared_ptr<const StepFile> open(const std::string& path, const StepIndexOptions& options = {});
+
+    const MappedFile& file() const { return *file_; }
+    /// Schema names from the header's `FILE_SCHEMA`, e.g. `AP242_...`.
+    const std::vector<std::string>& schemas() const { return schemas_; }
+
+    std::size_t entityCount() const { return records_.size(); }
+    /// Entity `#id`, or an invalid entity if there is none.
+    StepEntity entity(StepId id) const;
+    /// The `index`-th entity in id order.
+    StepEntity entityAt(std::size_t index) const;
+
+    /// Calls `fn(const StepEntity&)` for every simple instance of `type`
+    /// (upper case), in id order.
+    template <typename Fn>
+    void forEachOfType(std::string_view type, Fn&& fn) const;
+
+    /// Parameter list of the component `type` of a complex instance, or of
+    /// the instance itself if it is simple and of that type; empty if it has
+    /// no such component.
+    static std::string_view component(const StepEntity& entity, std::string_view type);
+
+    /// Bytes held by the index (not counting the mapping).
+    std::size_t memoryBytes() const;
+
+private:
+    struct Record {
+        StepId id;
+        std::uint64_t offset;
+        std::uint32_t length;
+        std::uint32_t type;
+    };
+
+    StepFile() = default;
+
+    StepEntity make(const Record& record) const;
+    std::uint32_t findType(std::string_view type) const;
+
+    std::shared_ptr<const MappedFile> file_;
+    std::vector<std::string> schemas_;
+    std::vector<Record> records_;
+    /// Dense id -> record index when ids are compact, else empty and lookups
+    /// binary-search `records_`.
+    std::vector<std::uint32_t> byId_;
+    /// Interned keywords; index 0 is the empty name of complex instances.
+    std::vector<std::string_view> types_;
+};
+
+/// Sequential reader over one parameter list, as found in
+/// `StepEntity::params`. Each accessor consumes one parameter and the comma
+/// after it; malformed input throws `std::runtime_error`. Lists are entered
+/// with `beginList()` and left with `endList()`.
+class StepParams {
+public:
+    explicit StepParams(std::string_view text);
+
+    /// Enters the list that starts at the current position.
+    void beginList();
+    /// Leaves the current list; its remaining parameters are skipped.
+    void endList();
+    /// True at the closing parenthesis of the current list.
+    bool atEnd();
+
+    /// `$` (unset) or `*` (derived) at the current position.
+    bool isUnset();
+    /// `#id`; 0 for `$` or `*`.
+    StepId ref();
+    double real();
+    long long integer();
+    /// With `''` unescaped; empty for `$`. Non-ASCII `\X\` escapes are kept
+    /// verbatim.
+    std::string string();
+    /// `.NAME.`; empty for `$`.
+    std::string_view enumeration();
+    /// Any single parameter, including nested lists and typed values.
+    void skip();
+
+    /// References in the list at the current position.
+    std::vector<StepId> refList();
+
+private:
+    void skipSpace();
+    void separator();
+    [[noreturn]] void fail(const char* what) const;
+
+    std::string_view text_;
+    std::size_t pos_ = 0;
+    int depth_ = 0;
+};
+
+template <typename Fn>
+void StepFile::forEachOfType(std::string_view type, Fn&& fn) const {
+    const std::uint32_t t = findType(type);
+    if (t == 0) {
+        return;
+    }
+    for (const Record& r : records_) {
+        if (r.type == t) {
+            fn(make(r));
+        }
+    }
+}
+
+} // namespace rebel::io
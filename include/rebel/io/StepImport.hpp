@@ -0,0 +1,61 @@
+#pragma once
+
+#include "rebel/assembly/Assembly.hpp"
+#include "rebel/assembly/PartLibrary.hpp"
+#include "rebel/io/StepFile.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace rebel::io {
+
+struct StepImportOptions {
+    StepIndexOptions index;
+    /// Multiplies every coordinate and translation, e.g. 0.001 to bring a
+    /// millimetre file into metres.
+    double lengthScale = 1.0;
+    /// Warnings beyond this many are counted but not kept.
+    std::size_t maxWarnings = 100;
+};
+
+struct StepImportResult {
+    /// Node created under the import parent: the single root product, or a
+    /// subassembly holding several; `kInvalidNode` if nothing was imported.
+    assembly::NodeId root = assembly::kInvalidNode;
+    std::size_t entities = 0;
+    std::size_t products = 0;
+    /// Unique parts converted (parts already in the library are reused).
+    std::size_t parts = 0;
+    std::size_t occurrences = 0;
+    std::size_t triangles = 0;
+    /// Products whose shape is exact B-rep only, which is not converted.
+    std::size_t unsupportedShapes = 0;
+    std::size_t warningCount = 0;
+    std::vector<std::string> warnings;
+};
+
+/// Imports a STEP AP203/AP214/AP242 file into `target` below `parent`.
+///
+/// Product structure follows the AP214 assembly pattern (product
+/// definitions, next-assembly-usage occurrences and context-dependent shape
+/// representations with item-defined transformations); every product
+/// definition becomes one shared part in `library`, instanced by as many
+/// occurrences as the structure has, so the result is the same instanced
+/// representation the rest of the engine uses. Geometry is read from AP242
+/// tessellated items (triangulated faces and surface sets, plain and with
+/// strips and fans); products with exact B-rep geometry only are counted in
+/// `unsupportedShapes`.
+///
+/// Parts are converted in parallel, one task per product, each reading its
+/// entities straight from the mapped file. Malformed entities produce
+/// warnings and skip the affected part, not the import. Throws
+/// `std::runtime_error` only if the file cannot be read as STEP at all.
+StepImportResult importStep(const std::string& path, assembly::Assembly& target, assembly::NodeId parent,
+                            assembly::PartLibrary& library, const StepImportOptions& options = {});
+
+/// Same, over a file already indexed.
+StepImportResult importStep(const StepFile& file, assembly::Assembly& target, assembly::NodeId parent,
+                            assembly::PartLibrary& library, const StepImportOptions& options = {});
+
+} // namespace rebel::io
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "rebel/math/Vec.hpp"
+
+#include <limits>
+
+namespace rebel::math {
+
+/// Axis-aligned bounding box. A default-constructed box is empty (min > max)
+/// so it can be grown with `expand` without a special first case.
+struct Aabb {
+    Vec3f min{std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+              std::numeric_limits<float>::max()};
+    Vec3f max{std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(),
+              std::numeric_limits<float>::lowest()};
+
+    constexpr Aabb() = default;
+    constexpr Aabb(const Vec3f& lo, const Vec3f& hi) : min(lo), max(hi) {}
+
+    constexpr bool empty() const { return min.x > max.x || min.y > max.y || min.z > max.z; }
+
+    constexpr void expand(const Vec3f& p) {
+        min = math::min(min, p);
+        max = math::max(max, p);
+    }
+
+    constexpr void expand(const Aabb& b) {
+        min = math::min(min, b.min);
+        max = math::max(max, b.max);
+    }
+
+    constexpr Vec3f center() const { return (min + max) * 0.5f; }
+    constexpr Vec3f extent() const { return max - min; }
+
+    /// Half the surface area; the SAH only ever compares ratios.
+    constexpr float halfArea() const {
+        if (empty()) {
+            return 0.0f;
+        }
+        const Vec3f e = extent();
+        return e.x * e.y + e.y * e.z + e.z * e.x;
+    }
+
+    constexpr bool overlaps(const Aabb& b) const {
+        return min.x <= b.max.x && b.min.x <= max.x && min.y <= b.max.y && b.min.y <= max.y &&
+               min.z <= b.max.z && b.min.z <= max.z;
+    }
+
+    constexpr bool contains(const Vec3f& p) const {
+        return p.x >= min.x && p.x <= max.x && p.y >= min.y && p.y <= max.y && p.z >= min.z &&
+               p.z <= max.z;
+    }
+
+    constexpr bool operator==(const Aabb& o) const { return min == o.min && max == o.max; }
+    constexpr bool operator!=(const Aabb& o) const { return !(*this == o); }
+};
+
+} // namespace rebel::math
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "rebel/math/Aabb.hpp"
+#include "rebel/math/Mat4.hpp"
+#include "rebel/math/Ray.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rebel::math::batch {
+
+/// Instruction-set backends for the batch kernels. Every backend produces
+/// bit-identical results to `Scalar`: kernels use the same operation order,
+/// no fused multiply-add and no reciprocal approximations.
+enum class Backend {
+    Scalar,
+    Sse2,
+    Avx2,
+    Neon,
+};
+
+const char* backendName(Backend backend);
+
+/// True if the backend was compiled in and the running CPU supports it.
+bool isSupported(Backend backend);
+
+/// Backend chosen by CPU dispatch: the widest supported one, unless the
+/// `REBEL_SIMD` environment variable names another (`scalar`, `sse2`,
+/// `avx2`, `neon`).
+Backend activeBackend();
+
+/// Forces a backend (benchmarks, determinism checks). Throws
+/// `std::invalid_argument` if it is not supported.
+void setBackend(Backend backend);
+
+/// Triangles in structure-of-arrays form with precomputed edges
+/// (`e1 = v1 - v0`, `e2 = v2 - v0`), the layout the ray kernel streams.
+struct TriangleBatch {
+    const float* v0x = nullptr;
+    const float* v0y = nullptr;
+    const float* v0z = nullptr;
+    const float* e1x = nullptr;
+    const float* e1y = nullptr;
+    const float* e1z = nullptr;
+    const float* e2x = nullptr;
+    const float* e2y = nullptr;
+    const float* e2z = nullptr;
+    std::size_t count = 0;
+};
+
+/// Affine transform of `count` SoA points. Output may alias input.
+void transformPoints(const Mat4f& m, const float* x, const float* y, const float* z, float* outX,
+                     float* outY, float* outZ, std::size_t count);
+
+/// World bounds of `count` boxes, box `i` transformed by `matrices[i]`
+/// (center/extent form, exact for affine transforms up to rounding).
+void transformAabbs(const Mat4f* matrices, const Aabb* local, Aabb* world, std::size_t count);
+
+/// Moller-Trumbore test of one ray against every triangle in `triangles`.
+/// Writes the hit distance per triangle to `tHit`, or +infinity for a miss.
+void intersectRayTriangles(const Ray& ray, const TriangleBatch& triangles, float* tHit);
+
+/// Index of the nearest hit in `triangles`, or `count` if nothing is hit.
+/// `tScratch` must hold `triangles.count` floats; the hit distance is
+/// written to `*tNearest` when non-null.
+std::size_t closestRayTriangle(const Ray& ray, const TriangleBatch& triangles, float* tScratch,
+                               float* tNearest = nullptr);
+
+/// Range of the signed plane distance `dot(normal, p) - offset` over the
+/// three corners of each triangle: `lo[i]` and `hi[i]`. Corners other than
+/// `v0` are rebuilt from the edges, so the range is only good to rounding;
+/// callers filtering for triangles crossing the plane pad it.
+void trianglePlaneRanges(const Vec3f& normal, float offset, const TriangleBatch& triangles, float* lo, float* hi);
+
+/// Highest degree `bsplineBasis` evaluates.
+inline constexpr unsigned kMaxBasisDegree = 7;
+
+/// The `degree + 1` non-zero B-spline basis functions of `knots` at `count`
+/// parameters, `spans[i]` being the knot span of `t[i]` (`knots[s] <= t <
+/// knots[s + 1]`, as found by the caller). Basis `k` of sample `i` goes to
+/// `basis[k * count + i]`, its first derivative likewise to `derivatives`
+/// unless that is null. Lanes run over samples, so knot spans may differ
+/// from one to the next.
+void bsplineBasis(const double* knots, unsigned degree, const double* t, const std::uint32_t* spans,
+                  std::size_t count, double* basis, double* derivatives = nullptr);
+
+} // namespace rebel::math::batch
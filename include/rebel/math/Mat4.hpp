@@ -0,0 +1,183 @@
+#pragma once
+
+#include "rebel/math/Vec.hpp"
+
+#include <cmath>
+
+namespace rebel::math {
+
+/// 4x4 float matrix, column-major (`m[col * 4 + row]`) so columns can be
+/// loaded directly into SIMD registers and uploaded to GPU buffers as is.
+struct Mat4f {
+    float m[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+
+    constexpr float operator()(int row, int col) const { return m[col * 4 + row]; }
+    constexpr float& operator()(int row, int col) { return m[col * 4 + row]; }
+
+    static constexpr Mat4f identity() { return {}; }
+
+    static constexpr Mat4f translation(const Vec3f& t) {
+        Mat4f r;
+        r.m[12] = t.x;
+        r.m[13] = t.y;
+        r.m[14] = t.z;
+        return r;
+    }
+
+    static constexpr Mat4f scale(const Vec3f& s) {
+        Mat4f r;
+        r.m[0] = s.x;
+        r.m[5] = s.y;
+        r.m[10] = s.z;
+        return r;
+    }
+
+    /// Right-handed rotation of `radians` about the (normalized) `axis`.
+    static Mat4f rotation(const Vec3f& axis, float radians) {
+        const Vec3f a = normalize(axis);
+        const float c = std::cos(radians);
+        const float s = std::sin(radians);
+        const float t = 1.0f - c;
+        Mat4f r;
+        r(0, 0) = t * a.x * a.x + c;
+        r(0, 1) = t * a.x * a.y - s * a.z;
+        r(0, 2) = t * a.x * a.z + s * a.y;
+        r(1, 0) = t * a.x * a.y + s * a.z;
+        r(1, 1) = t * a.y * a.y + c;
+        r(1, 2) = t * a.y * a.z - s * a.x;
+        r(2, 0) = t * a.x * a.z - s * a.y;
+        r(2, 1) = t * a.y * a.z + s * a.x;
+        r(2, 2) = t * a.z * a.z + c;
+        return r;
+    }
+
+    /// OpenGL-style perspective projection: right-handed eye space looking
+    /// down -z, clip z in [-w, w] between the `near` and `far` planes.
+    static Mat4f perspective(float fovY, float aspect, float near, float far) {
+        const float f = 1.0f / std::tan(0.5f * fovY);
+        Mat4f r;
+        r(0, 0) = f / aspect;
+        r(1, 1) = f;
+        r(2, 2) = (far + near) / (near - far);
+        r(2, 3) = 2.0f * far * near / (near - far);
+        r(3, 2) = -1.0f;
+        r(3, 3) = 0.0f;
+        return r;
+    }
+
+    /// View transform of an eye at `eye` looking at `target`.
+    static Mat4f lookAt(const Vec3f& eye, const Vec3f& target, const Vec3f& up) {
+        const Vec3f f = normalize(target - eye);
+        const Vec3f s = normalize(cross(f, up));
+        const Vec3f u = cross(s, f);
+        Mat4f r;
+        r(0, 0) = s.x;
+        r(0, 1) = s.y;
+        r(0, 2) = s.z;
+        r(1, 0) = u.x;
+        r(1, 1) = u.y;
+        r(1, 2) = u.z;
+        r(2, 0) = -f.x;
+        r(2, 1) = -f.y;
+        r(2, 2) = -f.z;
+        r(0, 3) = -dot(s, eye);
+        r(1, 3) = -dot(u, eye);
+        r(2, 3) = dot(f, eye);
+        return r;
+    }
+
+    constexpr Mat4f operator*(const Mat4f& o) const {
+        Mat4f r;
+        for (int col = 0; col < 4; ++col) {
+            for (int row = 0; row < 4; ++row) {
+                float sum = 0.0f;
+                for (int k = 0; k < 4; ++k) {
+                    sum += (*this)(row, k) * o(k, col);
+                }
+                r(row, col) = sum;
+            }
+        }
+        return r;
+    }
+
+    /// Affine point transform (the projective row is ignored).
+    constexpr Vec3f transformPoint(const Vec3f& p) const {
+        return {m[0] * p.x + m[4] * p.y + m[8] * p.z + m[12],
+                m[1] * p.x + m[5] * p.y + m[9] * p.z + m[13],
+                m[2] * p.x + m[6] * p.y + m[10] * p.z + m[14]};
+    }
+
+    /// Full projective point transform, divided by the resulting w.
+    constexpr Vec3f transformProjective(const Vec3f& p) const {
+        const float w = m[3] * p.x + m[7] * p.y + m[11] * p.z + m[15];
+        return transformPoint(p) / w;
+    }
+
+    constexpr Vec3f transformVector(const Vec3f& v) const {
+        return {m[0] * v.x + m[4] * v.y + m[8] * v.z, m[1] * v.x + m[5] * v.y + m[9] * v.z,
+                m[2] * v.x + m[6] * v.y + m[10] * v.z};
+    }
+
+    constexpr Vec3f translationPart() const { return {m[12], m[13], m[14]}; }
+
+    constexpr bool operator==(const Mat4f& o) const {
+        for (int i = 0; i < 16; ++i) {
+            if (m[i] != o.m[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+    constexpr bool operator!=(const Mat4f& o) const { return !(*this == o); }
+
+    /// General inverse via cofactors. Returns identity for a singular matrix.
+    Mat4f inverse() const {
+        const float* a = m;
+        float inv[16];
+        inv[0] = a[5] * a[10] * a[15] - a[5] * a[11] * a[14] - a[9] * a[6] * a[15] +
+                 a[9] * a[7] * a[14] + a[13] * a[6] * a[11] - a[13] * a[7] * a[10];
+        inv[4] = -a[4] * a[10] * a[15] + a[4] * a[11] * a[14] + a[8] * a[6] * a[15] -
+                 a[8] * a[7] * a[14] - a[12] * a[6] * a[11] + a[12] * a[7] * a[10];
+        inv[8] = a[4] * a[9] * a[15] - a[4] * a[11] * a[13] - a[8] * a[5] * a[15] +
+                 a[8] * a[7] * a[13] + a[12] * a[5] * a[11] - a[12] * a[7] * a[9];
+        inv[12] = -a[4] * a[9] * a[14] + a[4] * a[10] * a[13] + a[8] * a[5] * a[14] -
+                  a[8] * a[6] * a[13] - a[12] * a[5] * a[10] + a[12] * a[6] * a[9];
+        inv[1] = -a[1] * a[10] * a[15] + a[1] * a[11] * a[14] + a[9] * a[2] * a[15] -
+                 a[9] * a[3] * a[14] - a[13] * a[2] * a[11] + a[13] * a[3] * a[10];
+        inv[5] = a[0] * a[10] * a[15] - a[0] * a[11] * a[14] - a[8] * a[2] * a[15] +
+                 a[8] * a[3] * a[14] + a[12] * a[2] * a[11] - a[12] * a[3] * a[10];
+        inv[9] = -a[0] * a[9] * a[15] + a[0] * a[11] * a[13] + a[8] * a[1] * a[15] -
+                 a[8] * a[3] * a[13] - a[12] * a[1] * a[11] + a[12] * a[3] * a[9];
+        inv[13] = a[0] * a[9] * a[14] - a[0] * a[10] * a[13] - a[8] * a[1] * a[14] +
+                  a[8] * a[2] * a[13] + a[12] * a[1] * a[10] - a[12] * a[2] * a[9];
+        inv[2] = a[1] * a[6] * a[15] - a[1] * a[7] * a[14] - a[5] * a[2] * a[15] +
+                 a[5] * a[3] * a[14] + a[13] * a[2] * a[7] - a[13] * a[3] * a[6];
+        inv[6] = -a[0] * a[6] * a[15] + a[0] * a[7] * a[14] + a[4] * a[2] * a[15] -
+                 a[4] * a[3] * a[14] - a[12] * a[2] * a[7] + a[12] * a[3] * a[6];
+        inv[10] = a[0] * a[5] * a[15] - a[0] * a[7] * a[13] - a[4] * a[1] * a[15] +
+                  a[4] * a[3] * a[13] + a[12] * a[1] * a[7] - a[12] * a[3] * a[5];
+        inv[14] = -a[0] * a[5] * a[14] + a[0] * a[6] * a[13] + a[4] * a[1] * a[14] -
+                  a[4] * a[2] * a[13] - a[12] * a[1] * a[6] + a[12] * a[2] * a[5];
+        inv[3] = -a[1] * a[6] * a[11] + a[1] * a[7] * a[10] + a[5] * a[2] * a[11] -
+                 a[5] * a[3] * a[10] - a[9] * a[2] * a[7] + a[9] * a[3] * a[6];
+        inv[7] = a[0] * a[6] * a[11] - a[0] * a[7] * a[10] - a[4] * a[2] * a[11] +
+                 a[4] * a[3] * a[10] + a[8] * a[2] * a[7] - a[8] * a[3] * a[6];
+        inv[11] = -a[0] * a[5] * a[11] + a[0] * a[7] * a[9] + a[4] * a[1] * a[11] -
+                  a[4] * a[3] * a[9] - a[8] * a[1] * a[7] + a[8] * a[3] * a[5];
+        inv[15] = a[0] * a[5] * a[10] - a[0] * a[6] * a[9] - a[4] * a[1] * a[10] +
+                  a[4] * a[2] * a[9] + a[8] * a[1] * a[6] - a[8] * a[2] * a[5];
+
+        const float det = a[0] * inv[0] + a[1] * inv[4] + a[2] * inv[8] + a[3] * inv[12];
+        Mat4f r;
+        if (det == 0.0f) {
+            return r;
+        }
+        const float invDet = 1.0f / det;
+        for (int i = 0; i < 16; ++i) {
+            r.m[i] = inv[i] * invDet;
+        }
+        return r;
+    }
+};
+
+} // namespace rebel::math
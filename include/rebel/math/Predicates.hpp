@@ -0,0 +1,49 @@
+#pragma once
+
+#include "rebel/math/Vec.hpp"
+
+namespace rebel::math {
+
+/// Adaptive exact geometric predicates (Shewchuk's approach). Each one first
+/// evaluates its determinant in plain double precision together with a
+/// forward error bound; only when the bound cannot certify the sign does it
+/// fall back to exact expansion arithmetic. The sign of the result is always
+/// exact; its magnitude approximates the determinant.
+///
+/// Inputs are doubles; float coordinates convert exactly.
+
+/// Positive if a, b, c are counter-clockwise, negative if clockwise, zero
+/// if collinear.
+double orient2d(const Vec2d& a, const Vec2d& b, const Vec2d& c);
+
+/// Positive if `d` lies below the plane through a, b, c, where "above" is
+/// the side from which a, b, c appear counter-clockwise (that is, opposite
+/// to (b - a) x (c - a)); zero if coplanar.
+double orient3d(const Vec3d& a, const Vec3d& b, const Vec3d& c, const Vec3d& d);
+
+/// Positive if `d` lies inside the circle through the counter-clockwise
+/// points a, b, c, negative outside, zero on it.
+double incircle(const Vec2d& a, const Vec2d& b, const Vec2d& c, const Vec2d& d);
+
+enum class Intersection {
+    None,
+    /// Crossing at a single point interior to both primitives.
+    Proper,
+    /// Contact at an endpoint, edge or vertex, or a collinear/coplanar
+    /// overlap: the degenerate cases tolerance-based code gets wrong.
+    Touching,
+};
+
+/// Closed segments [a, b] and [c, d] in the plane.
+Intersection intersectSegments(const Vec2d& a, const Vec2d& b, const Vec2d& c, const Vec2d& d);
+
+/// Closed segment [p, q] against the closed triangle a, b, c.
+Intersection intersectSegmentTriangle(const Vec3d& p, const Vec3d& q, const Vec3d& a, const Vec3d& b,
+                                      const Vec3d& c);
+
+/// Closed triangles a, b, c and d, e, f: `Proper` if an edge of one passes
+/// through the interior of the other, i.e. they interpenetrate.
+Intersection intersectTriangles(const Vec3d& a, const Vec3d& b, const Vec3d& c, const Vec3d& d, const Vec3d& e,
+                                const Vec3d& f);
+
+} // namespace rebel::math
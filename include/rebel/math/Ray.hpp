@@ -0,0 +1,19 @@
+#pragma once
+
+#include "rebel/math/Vec.hpp"
+
+#include <limits>
+
+namespace rebel::math {
+
+/// Ray with a parametric interval; hits are accepted for t in [tMin, tMax].
+struct Ray {
+    Vec3f origin;
+    Vec3f direction{0.0f, 0.0f, 1.0f};
+    float tMin = 0.0f;
+    float tMax = std::numeric_limits<float>::infinity();
+
+    constexpr Vec3f at(float t) const { return origin + direction * t; }
+};
+
+} // namespace rebel::math
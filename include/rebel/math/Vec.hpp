@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cmath>
+
+namespace rebel::math {
+
+/// Plain 2-component vector.
+template <typename T>
+struct Vec2 {
+    T x{}, y{};
+
+    constexpr Vec2() = default;
+    constexpr Vec2(T x_, T y_) : x(x_), y(y_) {}
+
+    constexpr Vec2 operator+(const Vec2& o) const { return {x + o.x, y + o.y}; }
+    constexpr Vec2 operator-(const Vec2& o) const { return {x - o.x, y - o.y}; }
+    constexpr Vec2 operator*(T s) const { return {x * s, y * s}; }
+    constexpr bool operator==(const Vec2& o) const { return x == o.x && y == o.y; }
+    constexpr bool operator!=(const Vec2& o) const { return !(*this == o); }
+};
+
+/// Plain 3-component vector. Kept trivially copyable so it can be written
+/// straight into SoA arrays and file sections.
+template <typename T>
+struct Vec3 {
+    T x{}, y{}, z{};
+
+    constexpr Vec3() = default;
+    constexpr Vec3(T x_, T y_, T z_) : x(x_), y(y_), z(z_) {}
+
+    template <typename U>
+    constexpr explicit Vec3(const Vec3<U>& o)
+        : x(static_cast<T>(o.x)), y(static_cast<T>(o.y)), z(static_cast<T>(o.z)) {}
+
+    constexpr T& operator[](int i) { return i == 0 ? x : (i == 1 ? y : z); }
+    constexpr T operator[](int i) const { return i == 0 ? x : (i == 1 ? y : z); }
+
+    constexpr Vec3 operator+(const Vec3& o) const { return {x + o.x, y + o.y, z + o.z}; }
+    constexpr Vec3 operator-(const Vec3& o) const { return {x - o.x, y - o.y, z - o.z}; }
+    constexpr Vec3 operator-() const { return {-x, -y, -z}; }
+    constexpr Vec3 operator*(T s) const { return {x * s, y * s, z * s}; }
+    constexpr Vec3 operator/(T s) const { return {x / s, y / s, z / s}; }
+    constexpr Vec3& operator+=(const Vec3& o) { x += o.x; y += o.y; z += o.z; return *this; }
+    constexpr Vec3& operator-=(const Vec3& o) { x -= o.x; y -= o.y; z -= o.z; return *this; }
+    constexpr Vec3& operator*=(T s) { x *= s; y *= s; z *= s; return *this; }
+    constexpr bool operator==(const Vec3& o) const { return x == o.x && y == o.y && z == o.z; }
+    constexpr bool operator!=(const Vec3& o) const { return !(*this == o); }
+};
+
+template <typename T>
+constexpr Vec3<T> operator*(T s, const Vec3<T>& v) { return v * s; }
+
+template <typename T>
+constexpr T dot(const Vec3<T>& a, const Vec3<T>& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+template <typename T>
+constexpr Vec3<T> cross(const Vec3<T>& a, const Vec3<T>& b) {
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+template <typename T>
+inline T length(const Vec3<T>& v) { return std::sqrt(dot(v, v)); }
+
+/// Returns `v` scaled to unit length, or the zero vector if `v` is degenerate.
+template <typename T>
+inline Vec3<T> normalize(const Vec3<T>& v) {
+    const T len = length(v);
+    return len > T(0) ? v / len : Vec3<T>{};
+}
+
+template <typename T>
+constexpr Vec3<T> min(const Vec3<T>& a, const Vec3<T>& b) {
+    return {a.x < b.x ? a.x : b.x, a.y < b.y ? a.y : b.y, a.z < b.z ? a.z : b.z};
+}
+
+template <typename T>
+constexpr Vec3<T> max(const Vec3<T>& a, const Vec3<T>& b) {
+    return {a.x > b.x ? a.x : b.x, a.y > b.y ? a.y : b.y, a.z > b.z ? a.z : b.z};
+}
+
+using Vec2f = Vec2<float>;
+using Vec2d = Vec2<double>;
+using Vec3f = Vec3<float>;
+using Vec3d = Vec3<double>;
+
+} // namespace rebel::math
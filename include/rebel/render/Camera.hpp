@@ -0,0 +1,36 @@
+#pragma once
+
+#include "rebel/math/Mat4.hpp"
+#include "rebel/math/Ray.hpp"
+
+#include <cstdint>
+
+namespace rebel::render {
+
+/// Viewport camera: world-to-clip transform (OpenGL conventions, clip z in
+/// [-w, w]) and the viewport size in pixels. Pixel coordinates run right
+/// and down from the top-left corner; pixel (i, j) is sampled at its center
+/// (i + 0.5, j + 0.5).
+struct Camera {
+    math::Mat4f viewProjection;
+    std::uint32_t width = 0;
+    std::uint32_t height = 0;
+
+    static Camera perspective(const math::Vec3f& eye, const math::Vec3f& target, const math::Vec3f& up,
+                              float fovY, std::uint32_t width, std::uint32_t height, float near, float far);
+
+    /// Ray through pixel coordinates (x, y), from the near plane to the far
+    /// plane, with a unit direction so `t` is a world distance.
+    math::Ray ray(float x, float y) const;
+
+    /// Pixel coordinates and NDC depth of a world point in front of the
+    /// camera; depth is outside [-1, 1] beyond the near/far range.
+    math::Vec3f project(const math::Vec3f& world) const;
+
+    bool operator==(const Camera& o) const {
+        return viewProjection == o.viewProjection && width == o.width && height == o.height;
+    }
+    bool operator!=(const Camera& o) const { return !(*this == o); }
+};
+
+} // namespace rebel::render
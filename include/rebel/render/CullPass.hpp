@@ -0,0 +1,138 @@
+#pragma once
+
+#include "rebel/render/Camera.hpp"
+#include "rebel/render/DrawScene.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace rebel::render {
+
+/// Layout of `glDrawElementsIndirect` and `VkDrawIndexedIndirectCommand`
+/// commands, so a draw list uploads as is.
+struct DrawIndexedIndirectCommand {
+    std::uint32_t indexCount = 0;
+    std::uint32_t instanceCount = 0;
+    std::uint32_t firstIndex = 0;
+    std::int32_t baseVertex = 0;
+    std::uint32_t baseInstance = 0;
+};
+static_assert(sizeof(DrawIndexedIndirectCommand) == 20, "commands must match the indirect draw layout");
+
+/// One multi-draw-indirect call: `commandCount` commands from
+/// `firstCommand`, all in `material`.
+struct MultiDrawBatch {
+    std::uint32_t material = 0;
+    std::uint32_t firstCommand = 0;
+    std::uint32_t commandCount = 0;
+};
+
+/// Hierarchical depth buffer for occlusion culling: level 0 is the depth
+/// buffer of the previous frame, each further level holds the farthest
+/// depth of 2x2 texels of the one below. A box whose nearest depth lies
+/// behind the farthest depth over its screen rectangle is hidden, and at
+/// the level where the rectangle spans at most 2x2 texels that takes four
+/// reads whatever its size.
+class DepthPyramid {
+public:
+    /// From `width * height` NDC depths in rows from the top-left pixel;
+    /// infinity (nothing drawn) counts as the far plane.
+    void build(const float* depth, std::uint32_t width, std::uint32_t height);
+
+    bool empty() const { return levels_.empty(); }
+    std::uint32_t width() const { return empty() ? 0 : levels_[0].width; }
+    std::uint32_t height() const { return empty() ? 0 : levels_[0].height; }
+    std::size_t levelCount() const { return levels_.size(); }
+
+    /// Farthest depth under texel (x, y) of `level`.
+    float at(std::size_t level, std::uint32_t x, std::uint32_t y) const {
+        const Level& l = levels_[level];
+        return texels_[l.offset + std::size_t(y) * l.width + x];
+    }
+
+    /// True if everything drawn in pixels [x0, x1] x [y0, y1] of level 0
+    /// is nearer than `nearDepth`.
+    bool occludes(float x0, float y0, float x1, float y1, float nearDepth) const;
+
+private:
+    struct Level {
+        std::uint32_t width = 0;
+        std::uint32_t height = 0;
+        std::size_t offset = 0;
+    };
+
+    std::vector<Level> levels_;
+    std::vector<float> texels_;
+};
+
+struct CullOptions {
+    bool frustumCulling = true;
+    /// Needs a depth pyramid; skipped without one.
+    bool occlusionCulling = true;
+    /// Level of detail selection: each instance uses the finest level with
+    /// at most this many triangles per pixel of its screen rectangle.
+    float trianglesPerPixel = 0.5f;
+    /// Instances per task, the analogue of a workgroup.
+    std::uint32_t groupSize = 4096;
+};
+
+struct CullStats {
+    std::size_t instances = 0;
+    std::size_t hidden = 0;
+    std::size_t frustumCulled = 0;
+    std::size_t occluded = 0;
+    std::size_t drawn = 0;
+    /// Drawn with another level than the one selected, which was not
+    /// resident yet.
+    std::size_t substituted = 0;
+    /// Visible but not drawn because no level of the part is resident.
+    std::size_t waiting = 0;
+    std::size_t triangles = 0;
+};
+
+/// What a frame draws: one multi-draw per batch, over `commands`, with
+/// `instances` as the per-draw instance buffer (command `c` draws
+/// `instances[c.baseInstance]` onwards).
+struct DrawList {
+    std::vector<DrawIndexedIndirectCommand> commands;
+    std::vector<MultiDrawBatch> batches;
+    std::vector<std::uint32_t> instances;
+    CullStats stats;
+};
+
+/// Per-frame culling and draw list generation over a `DrawScene`, written
+/// as the compute pass of a GPU-driven renderer: data-parallel over
+/// instances in fixed-size groups on the task scheduler, reading only the
+/// scene's buffers, with per-command counters and a prefix sum turning the
+/// survivors into indirect commands. Each instance is tested against the
+/// frustum planes and the depth pyramid, then picks its level of detail
+/// from its projected size.
+///
+/// The occlusion test uses the depth of the previous frame as is, so
+/// instances uncovered by a camera move can appear a frame late. Within a
+/// command, instances may come in any order when run on several threads.
+class CullPass {
+public:
+    explicit CullPass(const CullOptions& options = {}) : options_(options) {}
+
+    /// Starts a frame of `scene`, culls it against `camera` and `occluders`
+    /// (may be null or built at another resolution), requests missing
+    /// levels and writes the draw list to `out`.
+    void run(DrawScene& scene, const Camera& camera, const DepthPyramid* occluders, DrawList& out);
+
+    const CullOptions& options() const { return options_; }
+
+private:
+    CullOptions options_;
+    /// Selected command per instance.
+    std::vector<std::uint32_t> selection_;
+    std::unique_ptr<std::atomic<std::uint32_t>[]> counters_;
+    std::size_t counterCount_ = 0;
+    std::unique_ptr<std::atomic<std::uint8_t>[]> wanted_;
+    std::size_t wantedCount_ = 0;
+};
+
+} // namespace rebel::render
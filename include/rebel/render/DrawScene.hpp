@@ -0,0 +1,310 @@
+#pragma once
+
+#include "rebel/assembly/AssemblyIndex.hpp"
+#include "rebel/core/MemoryBudget.hpp"
+#include "rebel/core/TaskScheduler.hpp"
+#include "rebel/io/NativeFile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace rebel::render {
+
+/// Instance record as uploaded (std430, 96 bytes): world transform as the
+/// column-major matrix it already is, world bounds, and the draw group that
+/// selects mesh and material.
+struct GpuInstance {
+    enum Flags : std::uint32_t { kHidden = 1u << 0 };
+
+    float world[16];
+    float boundsMin[3];
+    std::uint32_t group = 0;
+    float boundsMax[3];
+    std::uint32_t flags = 0;
+};
+static_assert(sizeof(GpuInstance) == 96, "instance records must match the shader layout");
+
+/// Pooled vertex: position and normal packed as signed 10:10:10:2 with x in
+/// the low bits (`GL_INT_2_10_10_10_REV`, `VK_FORMAT_A2B10G10R10_SNORM_PACK32`).
+struct GpuVertex {
+    float x, y, z;
+    std::uint32_t normal;
+};
+static_assert(sizeof(GpuVertex) == 16, "vertices must match the vertex input layout");
+
+/// One level of detail of a part in the geometry pool: the fields of the
+/// indirect command that draws it.
+struct GpuLod {
+    enum Flags : std::uint32_t { kResident = 1u << 0 };
+
+    std::uint32_t firstIndex = 0;
+    std::uint32_t indexCount = 0;
+    std::int32_t baseVertex = 0;
+    std::uint32_t flags = 0;
+
+    bool resident() const { return (flags & kResident) != 0; }
+};
+
+/// A part's levels, `lodCount` entries from `firstLod`, finest first.
+struct GpuPart {
+    std::uint32_t firstLod = 0;
+    std::uint32_t lodCount = 0;
+};
+
+/// Occurrences sharing a part and a material, drawn by the same indirect
+/// commands (one per level of the part, from `firstCommand`).
+struct GpuDrawGroup {
+    std::uint32_t part = 0;
+    std::uint32_t material = 0;
+    std::uint32_t firstCommand = 0;
+    std::uint32_t commandCount = 0;
+};
+
+struct GpuMaterial {
+    std::uint32_t colorRgba = 0;
+};
+
+/// Geometry written to the pool since the last `markUploaded()`, in
+/// elements of the vertex and index buffers.
+struct GeometryUpload {
+    std::uint32_t firstVertex = 0;
+    std::uint32_t vertexCount = 0;
+    std::uint32_t firstIndex = 0;
+    std::uint32_t indexCount = 0;
+};
+
+struct DrawSceneOptions {
+    /// Geometry pool size above which the least recently drawn levels are
+    /// evicted. The coarsest level of each part is never evicted once in.
+    std::size_t geometryBudgetBytes = std::size_t(1) << 30;
+    /// Streamed geometry committed to the pool per frame at most, so a
+    /// burst of arrivals never stalls one frame.
+    std::size_t uploadBytesPerFrame = std::size_t(64) << 20;
+    /// Material of occurrences without a color override.
+    std::uint32_t defaultColorRgba = 0xB4B4B4FFu;
+    /// Budget the pool also counts against, under the same eviction rules;
+    /// the scene registers for its lifetime. Enforce it on the render
+    /// thread.
+    core::MemoryBudget* budget = nullptr;
+};
+
+struct DrawSceneStats {
+    std::size_t instances = 0;
+    std::size_t groups = 0;
+    std::size_t materials = 0;
+    std::size_t lods = 0;
+    std::size_t residentLods = 0;
+    /// Levels being loaded in the background, or loaded and not committed.
+    std::size_t pendingLods = 0;
+    std::size_t poolVertices = 0;
+    std::size_t poolIndices = 0;
+    /// Bytes of geometry resident in the pool.
+    std::size_t poolBytes = 0;
+    std::size_t streamedLods = 0;
+    std::size_t evictedLods = 0;
+    std::size_t failedLods = 0;
+};
+
+/// Viewport scene in the layout of GPU buffers, for GPU-driven drawing.
+///
+/// Instances, one per top-level instance of the index and with the same
+/// ids, carry their world transform and bounds, so the culling pass (see
+/// `CullPass`) works on the buffers alone and the CPU never touches an
+/// instance per frame. Occurrences are grouped by part and material; each
+/// group owns one indirect command per level of detail of its part, and
+/// commands are ordered by material, so a frame is one multi-draw per
+/// material whatever the number of parts.
+///
+/// Geometry lives in one vertex pool and one index pool. Levels stream in
+/// on demand: the culling pass requests the level each instance should be
+/// drawn with, the scene converts it on the task scheduler and commits it
+/// to the pool at the start of a later frame, and until then instances use
+/// the nearest resident level. Least recently drawn levels are evicted when
+/// the pool outgrows its budget. Levels come from the index's part
+/// definitions, or from a native document with `streamLevels`.
+///
+/// `update()` and every other member must be called from one thread (the
+/// render thread); only the loading runs elsewhere. The assembly and index
+/// must outlive the scene.
+class DrawScene final : public core::MemoryConsumer {
+public:
+    DrawScene(const assembly::Assembly& assembly, const assembly::AssemblyIndex& index,
+              const DrawSceneOptions& options = {});
+    ~DrawScene() override;
+
+    DrawScene(const DrawScene&) = delete;
+    DrawScene& operator=(const DrawScene&) = delete;
+
+    /// Rewrites the instances of `moved` (what `AssemblyIndex::update()`
+    /// returned), hidden flags included. Rebuilds instead if occurrences
+    /// were added, removed or suppressed, one changed color, or the index
+    /// was rebuilt.
+    void update(const std::vector<assembly::NodeId>& moved);
+    /// Re-reads every instance, group and material. Resident geometry is
+    /// kept.
+    void rebuild();
+
+    /// Uses the stored levels of detail of `document` for the parts found
+    /// in it by name: the full part first, then its coarser levels. Pending
+    /// and resident geometry of those parts is dropped.
+    void streamLevels(std::shared_ptr<const io::NativeDocument> document);
+
+    const std::vector<GpuInstance>& instances() const { return instances_; }
+    const std::vector<GpuDrawGroup>& groups() const { return groups_; }
+    const std::vector<GpuMaterial>& materials() const { return materials_; }
+    const std::vector<GpuPart>& parts() const { return parts_; }
+    const std::vector<GpuLod>& lods() const { return lods_; }
+    const std::vector<GpuVertex>& vertices() const { return vertices_; }
+    const std::vector<std::uint32_t>& indices() const { return indices_; }
+    /// Indirect commands a frame may use: the sum over groups.
+    std::size_t commandCount() const { return commandCount_; }
+
+    /// Triangles of a level, whether resident or not.
+    std::uint32_t lodTriangles(std::uint32_t lod) const { return lods_[lod].indexCount / 3; }
+
+    /// Queues level `lod` for loading unless it is resident or pending.
+    void request(std::uint32_t lod);
+    /// Records that `lod` was drawn in the current frame.
+    void touch(std::uint32_t lod) {
+        lodState_[lod].lastDrawn = frame_;
+        lodState_[lod].lastUse = frameStamp_;
+    }
+    /// Starts a frame: commits loaded levels within the upload budget and
+    /// evicts levels over the pool budget.
+    void beginFrame();
+    /// Waits for every pending load and commits all of them.
+    void finishStreaming();
+
+    /// Instances rewritten since `markUploaded()`: [first, last).
+    std::size_t dirtyInstancesBegin() const { return dirtyBegin_; }
+    std::size_t dirtyInstancesEnd() const { return dirtyEnd_; }
+    /// Pool ranges written since `markUploaded()`. A single range covering
+    /// everything after the pool grew.
+    const std::vector<GeometryUpload>& geometryUploads() const { return uploads_; }
+    /// Whether the group, material, part or level tables changed since
+    /// `markUploaded()`.
+    bool tablesDirty() const { return tablesDirty_; }
+    void markUploaded();
+
+    DrawSceneStats stats() const;
+    const DrawSceneOptions& options() const { return options_; }
+
+    std::string_view memoryName() const override { return "render.geometry_pool"; }
+    std::size_t memoryBytes() const override { return poolBytes_; }
+    void evictionCandidates(std::vector<core::MemoryItem>& out) const override;
+    std::size_t evictOlderThan(std::uint64_t stamp) override;
+
+private:
+    struct LodState {
+        assembly::PartPtr source;
+        std::uint64_t lastDrawn = 0;
+        /// `core::MemoryBudget::stamp()` of the frame it was last drawn in.
+        std::uint64_t lastUse = 0;
+        /// Generation of the part's levels this state belongs to, so loads
+        /// finishing after `streamLevels()` replaced them are dropped.
+        std::uint32_t generation = 0;
+        /// Vertices the level occupies in the pool while resident.
+        std::uint32_t vertexCount = 0;
+        bool coarsest = false;
+        bool pending = false;
+        bool failed = false;
+    };
+
+    struct SlotState {
+        /// Definition the levels were taken from, to notice library swaps.
+        const assembly::Part* definition = nullptr;
+        std::string name;
+        /// Levels come from a native document, not the definition.
+        bool fromDocument = false;
+    };
+
+    struct Loaded {
+        std::uint32_t lod = 0;
+        std::uint32_t generation = 0;
+        std::vector<GpuVertex> vertices;
+        std::vector<std::uint32_t> indices;
+        bool failed = false;
+    };
+
+    /// First-fit allocator of element ranges in a pool.
+    class RangeAllocator {
+    public:
+        /// Offset of `count` free elements, growing `size` if none fit.
+        std::uint32_t allocate(std::uint32_t count, std::uint32_t& size);
+        void release(std::uint32_t offset, std::uint32_t count);
+        void clear() { free_.clear(); }
+
+    private:
+        struct Range {
+            std::uint32_t offset;
+            std::uint32_t count;
+        };
+        /// Sorted by offset, never adjacent.
+        std::vector<Range> free_;
+    };
+
+    std::uint32_t partSlot(spatial::InstanceId instance);
+    void setLevels(std::uint32_t slot, std::vector<assembly::PartPtr> levels);
+    void layoutCommands();
+    void writeInstance(spatial::InstanceId instance);
+    void commit(Loaded& loaded);
+    /// Resident, not the coarsest, and not drawn last frame.
+    bool evictable(std::uint32_t lod) const;
+    void evict(std::uint32_t lod);
+    void evictOverBudget();
+    void markDirty(std::size_t first, std::size_t last);
+    void recordUpload(const GeometryUpload& upload);
+
+    const assembly::Assembly& assembly_;
+    const assembly::AssemblyIndex& index_;
+    DrawSceneOptions options_;
+
+    std::vector<GpuInstance> instances_;
+    std::vector<GpuDrawGroup> groups_;
+    std::vector<GpuMaterial> materials_;
+    std::vector<GpuPart> parts_;
+    std::vector<GpuLod> lods_;
+    std::vector<GpuVertex> vertices_;
+    std::vector<std::uint32_t> indices_;
+    std::size_t commandCount_ = 0;
+
+    /// Scene part slot of each library part; slots are never reused, so
+    /// resident geometry survives rebuilds.
+    std::vector<std::uint32_t> slotOf_;
+    std::vector<SlotState> slots_;
+    std::vector<LodState> lodState_;
+    RangeAllocator vertexSpace_;
+    RangeAllocator indexSpace_;
+    std::uint32_t vertexEnd_ = 0;
+    std::uint32_t indexEnd_ = 0;
+    std::size_t poolBytes_ = 0;
+    std::uint64_t frame_ = 1;
+    std::uint64_t frameStamp_ = 0;
+
+    std::size_t dirtyBegin_ = 0;
+    std::size_t dirtyEnd_ = 0;
+    std::vector<GeometryUpload> uploads_;
+    bool poolGrew_ = false;
+    bool tablesDirty_ = true;
+
+    std::size_t streamed_ = 0;
+    std::size_t evicted_ = 0;
+    std::size_t failed_ = 0;
+    std::size_t pending_ = 0;
+
+    std::uint64_t revision_ = 0;
+    std::size_t indexedCount_ = 0;
+
+    /// Loads finished in the background, waiting for `beginFrame()`.
+    std::mutex loadedMutex_;
+    std::deque<Loaded> loaded_;
+    /// Declared last so it is destroyed (and waited on) first.
+    core::TaskGroup loads_;
+};
+
+} // namespace rebel::render
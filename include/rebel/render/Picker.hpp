@@ -0,0 +1,104 @@
+#pragma once
+
+#include "rebel/render/Camera.hpp"
+#include "rebel/spatial/TwoLevelBvh.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace rebel::render {
+
+/// What the ID buffer holds at a pixel.
+struct PickId {
+    spatial::InstanceId instance = geometry::kInvalidIndex;
+    std::uint32_t triangle = geometry::kInvalidIndex;
+
+    bool hit() const { return instance != geometry::kInvalidIndex; }
+    bool operator==(const PickId& o) const { return instance == o.instance && triangle == o.triangle; }
+    bool operator<(const PickId& o) const {
+        return instance != o.instance ? instance < o.instance : triangle < o.triangle;
+    }
+};
+
+/// Precise hit under the cursor.
+struct PickHit {
+    spatial::InstanceId instance = geometry::kInvalidIndex;
+    std::uint32_t triangle = geometry::kInvalidIndex;
+    /// Distance along the camera ray, and the world point there.
+    float t = std::numeric_limits<float>::infinity();
+    math::Vec3f point;
+    /// Edge of the hit triangle nearest the cursor on screen, as the corner
+    /// it starts at (0-2), and its distance from the cursor in pixels, for
+    /// snapping to edges.
+    std::uint8_t edge = 0;
+    float edgeDistance = std::numeric_limits<float>::infinity();
+
+    bool hit() const { return instance != geometry::kInvalidIndex; }
+};
+
+struct PickerOptions {
+    /// Square screen tiles, the unit of parallel rasterization and of the
+    /// hierarchical depth test.
+    std::uint32_t tileSize = 32;
+};
+
+/// Viewport picking over a two-level BVH.
+///
+/// `update()` rasterizes instance and triangle IDs with depth into an
+/// offscreen buffer the size of the viewport, but only when the camera
+/// changed or `invalidate()` was called (after the hierarchy is
+/// committed), never per mouse move. Hover and box select are then lookups
+/// in that buffer, independent of the assembly's size. The buffer is drawn
+/// tile by tile on the task scheduler: each tile takes the instances whose
+/// screen box overlaps it nearest first and walks their triangle BVHs,
+/// skipping nodes that miss the tile's pixel centers, lie outside the
+/// frustum or behind everything the tile already shows, so subpixel and
+/// hidden geometry costs little more than its top node.
+///
+/// `pick()` then finds the exact hit under the cursor by casting the
+/// camera ray at the instance the buffer shows there, falling back to the
+/// whole hierarchy where the buffer is empty or stale.
+///
+/// The hierarchy must outlive the picker.
+class Picker {
+public:
+    explicit Picker(const spatial::TwoLevelBvh& bvh, const PickerOptions& options = {});
+
+    /// Re-renders the ID buffer if `camera` differs from the one it was
+    /// drawn with or the picker was invalidated. Returns whether it did.
+    bool update(const Camera& camera);
+    /// Marks the buffer stale, e.g. after instances moved.
+    void invalidate() { valid_ = false; }
+
+    const Camera& camera() const { return camera_; }
+
+    /// ID at a pixel; none outside the viewport.
+    PickId at(std::uint32_t x, std::uint32_t y) const;
+    /// NDC depth at a pixel; infinity where nothing is drawn.
+    float depth(std::uint32_t x, std::uint32_t y) const;
+
+    /// Visible instances with at least one pixel in [x0, x1) x [y0, y1),
+    /// sorted.
+    std::vector<spatial::InstanceId> selectInstances(std::uint32_t x0, std::uint32_t y0, std::uint32_t x1,
+                                                     std::uint32_t y1) const;
+    /// Visible triangles in the same rectangle, sorted.
+    std::vector<PickId> selectTriangles(std::uint32_t x0, std::uint32_t y0, std::uint32_t x1,
+                                        std::uint32_t y1) const;
+
+    /// Exact closest hit at pixel coordinates (x, y) of the current camera.
+    PickHit pick(float x, float y) const;
+
+private:
+    void render();
+    PickHit pickInstance(spatial::InstanceId instance, const math::Ray& ray, float x, float y) const;
+
+    const spatial::TwoLevelBvh& bvh_;
+    PickerOptions options_;
+    Camera camera_;
+    bool valid_ = false;
+    std::vector<PickId> ids_;
+    std::vector<float> depth_;
+};
+
+} // namespace rebel::render
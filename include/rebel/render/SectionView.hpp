@@ -0,0 +1,153 @@
+#pragma once
+
+#include "rebel/assembly/AssemblyIndex.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace rebel::render {
+
+/// Half-space kept by a section: points with `dot(normal, p) > offset` are
+/// cut away. `SectionView` normalizes the normal.
+struct SectionPlane {
+    math::Vec3d normal{0.0, 0.0, 1.0};
+    double offset = 0.0;
+
+    double distance(const math::Vec3d& p) const { return math::dot(normal, p) - offset; }
+    bool operator==(const SectionPlane& o) const { return normal == o.normal && offset == o.offset; }
+    bool operator!=(const SectionPlane& o) const { return !(*this == o); }
+};
+
+/// Where an occurrence lies relative to the section, from its world box:
+/// drawn as is, drawn with the section planes as clip planes, or culled.
+enum class SectionSide : std::uint8_t {
+    Kept,
+    Cut,
+    Removed,
+};
+
+/// Cut of one occurrence by one section plane, in world space and trimmed
+/// to the other planes.
+struct SectionCut {
+    spatial::InstanceId instance = geometry::kInvalidIndex;
+    std::uint32_t plane = 0;
+    /// Cut outline as point pairs, one per sliced triangle.
+    std::vector<math::Vec3f> edges;
+    /// Cap triangles filling the closed cut loops, three points each, facing
+    /// along the plane normal.
+    std::vector<math::Vec3f> cap;
+    /// Loops that did not close, where the mesh is open; they are outlined
+    /// but not capped.
+    std::uint32_t openChains = 0;
+};
+
+/// (instance, plane) of a cut.
+using SectionCutId = std::pair<spatial::InstanceId, std::uint32_t>;
+
+struct SectionStats {
+    /// Cuts sliced from their meshes again.
+    std::size_t cutsSliced = 0;
+    /// Cuts trimmed to the other planes again.
+    std::size_t cutsTrimmed = 0;
+    /// Triangles in the BVH leaves reached, and those crossing their plane.
+    std::size_t trianglesTested = 0;
+    std::size_t trianglesSliced = 0;
+};
+
+/// Section plane and section box views of an `AssemblyIndex`: the kept
+/// region is the intersection of one or more half-spaces, and each
+/// occurrence crossing a plane gets its cut outline and a cap.
+///
+/// `update()` only redoes what the last changes touched. For a plane that
+/// moved, the top-level BVH yields the occurrences whose world box crosses
+/// it, and each part BVH, with the plane taken into part space, the leaves
+/// crossing it; a SIMD kernel then bounds every leaf triangle's distance
+/// range and only triangles that may cross are sliced exactly. Cuts of
+/// unmoved planes stay as they are unless their occurrence moved, and are
+/// only trimmed again where a moved plane passes through them, so dragging
+/// one face of a section box re-slices that face alone. Cuts are spread
+/// over the task scheduler.
+///
+/// Slices chain into loops through the mesh edges they cross, so caps need
+/// welded meshes; loops nest by containment and are triangulated by ear
+/// clipping with holes bridged to their outer loop.
+///
+/// The index must outlive the view.
+class SectionView {
+public:
+    explicit SectionView(const assembly::AssemblyIndex& index);
+
+    /// A single section plane.
+    void setPlane(const SectionPlane& plane);
+    /// Keeps the inside of `box`: planes -x, +x, -y, +y, -z, +z in that
+    /// order. Throws `std::invalid_argument` if the box is empty.
+    void setBox(const math::Aabb& box);
+    /// Throws `std::invalid_argument` if a normal is zero. Changing the
+    /// number of planes drops every cut.
+    void setPlanes(std::vector<SectionPlane> planes);
+    /// No section: everything is kept.
+    void clear() { setPlanes({}); }
+
+    const std::vector<SectionPlane>& planes() const { return planes_; }
+
+    /// Brings the cuts in line with the planes and the index. `moved` are
+    /// the occurrence nodes `AssemblyIndex::update()` reported since the
+    /// last call.
+    void update(const std::vector<assembly::NodeId>& moved = {});
+
+    /// From the instance's world box as of the last index update.
+    SectionSide side(spatial::InstanceId instance) const;
+
+    /// Cut of `instance` by plane `plane`, or null where it does not cross.
+    const SectionCut* cut(spatial::InstanceId instance, std::uint32_t plane) const;
+    /// Calls `fn(const SectionCut&)` for every cut, in no particular order.
+    template <typename Fn>
+    void forEachCut(Fn&& fn) const {
+        for (const auto& entry : entries_) {
+            fn(entry.second.cut);
+        }
+    }
+    std::size_t cutCount() const { return entries_.size(); }
+
+    /// Cuts added, changed or removed by the last update, sorted, for
+    /// re-uploading only those.
+    const std::vector<SectionCutId>& changed() const { return changed_; }
+    const SectionStats& stats() const { return stats_; }
+
+private:
+    /// Untrimmed cut in double precision.
+    struct Slice {
+        std::vector<math::Vec3d> edges;
+        std::vector<math::Vec3d> cap;
+        std::uint32_t openChains = 0;
+        math::Vec3d min;
+        math::Vec3d max;
+    };
+
+    struct Entry {
+        Slice slice;
+        SectionCut cut;
+    };
+
+    static std::uint64_t key(spatial::InstanceId instance, std::uint32_t plane) {
+        return (std::uint64_t(plane) << 32) | instance;
+    }
+
+    Slice slice(spatial::InstanceId instance, std::uint32_t plane, SectionStats& stats) const;
+    void trim(Entry& entry) const;
+    void erase(std::uint64_t k);
+
+    const assembly::AssemblyIndex& index_;
+    std::vector<SectionPlane> planes_;
+    /// Planes the current cuts were made with.
+    std::vector<SectionPlane> sliced_;
+    std::unordered_map<std::uint64_t, Entry> entries_;
+    std::vector<SectionCutId> changed_;
+    SectionStats stats_;
+    std::size_t instanceCount_ = 0;
+};
+
+} // namespace rebel::render
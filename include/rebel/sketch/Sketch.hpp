@@ -0,0 +1,234 @@
+#pragma once
+
+#include "rebel/math/Vec.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace rebel::sketch {
+
+using EntityId = std::uint32_t;
+using ConstraintId = std::uint32_t;
+inline constexpr EntityId kInvalidEntity = 0xFFFFFFFFu;
+
+enum class EntityType {
+    Point,
+    /// Segment between two points.
+    Line,
+    /// Center point and radius.
+    Circle,
+    /// Center, start and end points (counter-clockwise), both ends kept on
+    /// one radius.
+    Arc,
+};
+
+struct Entity {
+    EntityType type = EntityType::Point;
+    /// Defining points: line ends; circle center; arc center, start, end.
+    EntityId points[3] = {kInvalidEntity, kInvalidEntity, kInvalidEntity};
+};
+
+enum class ConstraintType {
+    /// Points `a` and `b` coincide.
+    Coincident,
+    /// Line `a` is horizontal / vertical.
+    Horizontal,
+    Vertical,
+    /// Lines `a` and `b`.
+    Parallel,
+    Perpendicular,
+    /// Angle `value` (radians) from line `a` to line `b`, counter-clockwise;
+    /// lines have no direction, so `value + pi` satisfies it too.
+    Angle,
+    /// Points `a` and `b` are `value` apart.
+    Distance,
+    /// Line `a` is `value` long.
+    Length,
+    /// Circle or arc `a` has radius `value`.
+    Radius,
+    /// Lines `a` and `b` are equally long.
+    EqualLength,
+    /// Circles or arcs `a` and `b` have equal radii.
+    EqualRadius,
+    /// Point `a` lies on the (infinite) line `b`.
+    PointOnLine,
+    /// Point `a` lies on circle or arc `b`.
+    PointOnCircle,
+    /// Point `a` is the midpoint of line `b`.
+    Midpoint,
+    /// Line `a` touches circle or arc `b`, on the side the center is on
+    /// when the constraint is added.
+    Tangent,
+};
+
+struct Constraint {
+    ConstraintType type = ConstraintType::Coincident;
+    EntityId a = kInvalidEntity;
+    EntityId b = kInvalidEntity;
+    /// Dimension for `Angle`, `Distance`, `Length` and `Radius`.
+    double value = 0.0;
+};
+
+struct SketchSolveOptions {
+    std::uint32_t maxIterations = 100;
+    /// Converged once no equation residual exceeds this.
+    double tolerance = 1e-10;
+};
+
+struct SketchSolveResult {
+    bool converged = true;
+    /// Subsystems solved this time (merged retries included), and how many
+    /// the sketch has.
+    std::size_t blocksSolved = 0;
+    std::size_t blockCount = 0;
+    /// Unknowns of the largest subsystem solved.
+    std::size_t largestBlock = 0;
+    /// Components whose blocks did not converge one by one and were solved
+    /// again as a whole.
+    std::size_t fallbacks = 0;
+    /// Unknowns structurally left free (under-constrained) and equations
+    /// structurally redundant (over-constrained), over the whole sketch.
+    std::size_t freeParameters = 0;
+    std::size_t redundantEquations = 0;
+    /// Largest remaining residual of the equations solved.
+    double residual = 0.0;
+};
+
+/// 2D sketch: points, lines, circles and arcs under geometric constraints
+/// and dimensions.
+///
+/// Every constraint becomes one or two equations over point coordinates and
+/// radii. The solver decomposes the equation/unknown graph before solving:
+/// connected components are independent and run in parallel, and within a
+/// component a Dulmage-Mendelsohn decomposition splits off an
+/// over-constrained part, a well-constrained part and an under-constrained
+/// part. The unknowns the matching leaves over are the sketch's remaining
+/// degrees of freedom and keep their values, which makes the rest square;
+/// it is ordered into its strongly connected blocks and solved as a
+/// sequence of small systems (often one or two unknowns each), each with
+/// the earlier blocks held fixed. The matching prefers the unknowns each
+/// equation depends on most at the current geometry, so blocks are not
+/// singular where the structure alone would allow it. A block that cannot
+/// be satisfied with its free parameters where they are is merged with
+/// them and the other blocks reading them; only if that fails too is the
+/// component solved as a whole. Every system is solved with the same sparse
+/// Levenberg-Marquardt method.
+///
+/// The decomposition is kept until the structure changes (entities or
+/// constraints added or removed, points fixed or released, a different
+/// point dragged). Changing a dimension with `setValue()` re-solves only the
+/// block holding it and the blocks downstream of it; `drag()` re-solves only
+/// the components attached to the dragged point, and to the point let go
+/// when another one is grabbed.
+class Sketch {
+public:
+    EntityId addPoint(const math::Vec2d& position);
+    EntityId addLine(EntityId start, EntityId end);
+    EntityId addCircle(EntityId center, double radius);
+    EntityId addArc(EntityId center, EntityId start, EntityId end);
+
+    std::size_t entityCount() const { return entities_.size(); }
+    const Entity& entity(EntityId id) const;
+    math::Vec2d point(EntityId point) const;
+    /// Radius of a circle, or the current radius of an arc.
+    double radius(EntityId circleOrArc) const;
+
+    /// Fixed points keep their position.
+    void setFixed(EntityId point, bool fixed = true);
+    bool isFixed(EntityId point) const;
+
+    /// Throws `std::invalid_argument` if the entities do not have the kinds
+    /// the constraint type needs.
+    ConstraintId addConstraint(const Constraint& constraint);
+    /// Throws `std::out_of_range` for an unknown id.
+    void removeConstraint(ConstraintId id);
+    const Constraint& constraint(ConstraintId id) const;
+    std::size_t constraintCount() const { return constraintCount_; }
+
+    /// Changes a dimension; the next solve re-solves only what depends on
+    /// it.
+    void setValue(ConstraintId id, double value);
+
+    /// Solves what changed since the last solve (everything the first time
+    /// or after a structural change).
+    SketchSolveResult solve(const SketchSolveOptions& options = {});
+
+    /// Moves `point` to `target` and re-solves the components attached to
+    /// it with the point held there. A fixed point does not move.
+    SketchSolveResult drag(EntityId point, const math::Vec2d& target, const SketchSolveOptions& options = {});
+
+private:
+    /// One scalar equation; `params` index `params_`.
+    struct Equation {
+        std::uint8_t kind = 0;
+        std::uint8_t paramCount = 0;
+        std::uint32_t params[8] = {};
+        /// Dimension, or the side for tangency.
+        double value = 0.0;
+    };
+
+    struct ConstraintRecord {
+        Constraint constraint;
+        bool active = true;
+        /// Equations are `equations_[first, first + count)` while the
+        /// structure is current.
+        std::uint32_t firstEquation = 0;
+        std::uint32_t equationCount = 0;
+        double side = 1.0;
+    };
+
+    /// Subsystem: equations solved for unknowns, all other parameters held.
+    struct Block {
+        std::vector<std::uint32_t> equations;
+        std::vector<std::uint32_t> unknowns;
+    };
+
+    /// Connected part of the equation graph; blocks in solve order.
+    struct Component {
+        std::vector<Block> blocks;
+        std::vector<std::uint32_t> unknowns;
+        std::vector<std::uint32_t> equations;
+        bool dirty = true;
+    };
+
+    void requirePoint(EntityId id) const;
+    void requireKind(EntityId id, EntityType type) const;
+    void requireRound(EntityId id) const;
+    /// Makes `point` the held (dragged) point, `kInvalidEntity` for none.
+    void hold(EntityId point);
+    void rebuild();
+    void decompose(Component& component, std::vector<std::int32_t>& column) const;
+    SketchSolveResult run(const SketchSolveOptions& options);
+
+    std::vector<Entity> entities_;
+    /// Points: x, y. Circles and arcs: radius. Indexes into `params_`.
+    std::vector<std::uint32_t> firstParam_;
+    std::vector<double> params_;
+    std::vector<char> fixed_;
+    std::vector<ConstraintRecord> constraints_;
+    std::size_t constraintCount_ = 0;
+
+    bool structureDirty_ = true;
+    EntityId held_ = kInvalidEntity;
+    /// Set while the held point is the only structural change since the
+    /// last rebuild, which then leaves the components neither the old nor
+    /// the new held point takes part in solved.
+    bool holdOnlyChange_ = false;
+    EntityId previousHeld_ = kInvalidEntity;
+    std::vector<Equation> equations_;
+    std::vector<Component> components_;
+    /// Per equation: its component and block, while the structure is
+    /// current.
+    std::vector<std::uint32_t> componentOf_;
+    std::vector<std::uint32_t> blockOf_;
+    /// Per parameter: the block solving for it; -1 if it is held (a fixed
+    /// or dragged point), -2 if it is a free unknown no block solves for.
+    std::vector<std::int32_t> blockOfParam_;
+    /// Equations whose dimension changed since the last solve.
+    std::vector<std::uint32_t> changed_;
+    std::size_t freeParameters_ = 0;
+    std::size_t redundantEquations_ = 0;
+};
+
+} // namespace rebel::sketch
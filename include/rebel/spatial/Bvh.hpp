@@ -0,0 +1,251 @@
+#pragma once
+
+#include "rebel/math/Aabb.hpp"
+#include "rebel/math/Ray.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace rebel::spatial {
+
+/// Flattened BVH node, 32 bytes. Interior nodes have `count == 0` and their
+/// two children at `first` and `first + 1`; leaves reference `count`
+/// entries of the primitive index array starting at `first`.
+struct BvhNode {
+    math::Aabb bounds;
+    std::uint32_t first = 0;
+    std::uint32_t count = 0;
+
+    bool isLeaf() const { return count != 0; }
+};
+
+static_assert(sizeof(BvhNode) == 32, "BvhNode must stay 32 bytes");
+
+struct BvhBuildOptions {
+    /// Nodes above this size are always split; at or below it the SAH
+    /// decides.
+    std::uint32_t maxLeafSize = 4;
+    /// Nodes whose primitive centroids all coincide stay a leaf up to this
+    /// size and are split by count beyond it.
+    std::uint32_t forcedSplitSize = 64;
+    std::uint32_t binCount = 16;
+    /// Subtrees with fewer primitives than this are built on the calling
+    /// thread.
+    std::size_t parallelThreshold = 8192;
+    float traversalCost = 1.0f;
+    float intersectionCost = 1.0f;
+};
+
+/// Non-owning view of a built hierarchy: the query half of `Bvh`. The same
+/// traversal code runs over trees owned in memory and over node arrays
+/// mapped straight from a file.
+struct BvhView {
+    /// Builds never exceed this depth, which bounds the traversal stacks.
+    static constexpr int kMaxDepth = 64;
+
+    const BvhNode* nodes = nullptr;
+    std::size_t nodeCount = 0;
+    /// Primitive ids in leaf order.
+    const std::uint32_t* primitives = nullptr;
+    std::size_t primitiveCount = 0;
+
+    bool empty() const { return nodeCount == 0; }
+    math::Aabb bounds() const { return nodeCount == 0 ? math::Aabb{} : nodes[0].bounds; }
+
+    /// Depth-first traversal. `visitNode(const BvhNode&)` returns false to
+    /// prune a subtree; `visitLeaf(primitive)` returns false to stop.
+    template <typename NodeFn, typename LeafFn>
+    void traverse(NodeFn&& visitNode, LeafFn&& visitLeaf) const;
+
+    /// Calls `fn(primitive)` for every primitive whose leaf box overlaps
+    /// `box`. Returning false from `fn` stops the query.
+    template <typename Fn>
+    void queryOverlap(const math::Aabb& box, Fn&& fn) const;
+
+    /// Front-to-back ray traversal. `intersect(primitive, ray)` tests one
+    /// primitive and shrinks `ray.tMax` on a hit, which prunes the rest.
+    template <typename Fn>
+    void raycast(math::Ray ray, Fn&& intersect) const;
+
+    /// Same traversal with one call per leaf, `intersect(leaf, ray)`, for
+    /// callers that keep primitive data in leaf order and test it in batches.
+    template <typename Fn>
+    void raycastLeaves(math::Ray ray, Fn&& intersect) const;
+};
+
+/// Bounding volume hierarchy over an array of primitive AABBs.
+///
+/// Built top-down with binned SAH; independent subtrees are built in
+/// parallel. Moving a primitive only refits the nodes on its path to the
+/// root, so the tree stays valid (if gradually less tight) without a
+/// rebuild.
+class Bvh {
+public:
+    static constexpr int kMaxDepth = BvhView::kMaxDepth;
+
+    Bvh() = default;
+
+    static Bvh build(const math::Aabb* primitiveBounds, std::size_t count,
+                     const BvhBuildOptions& options = {});
+
+    bool empty() const { return nodes_.empty(); }
+    std::size_t nodeCount() const { return nodes_.size(); }
+    std::size_t primitiveCount() const { return primitives_.size(); }
+    math::Aabb bounds() const { return nodes_.empty() ? math::Aabb{} : nodes_[0].bounds; }
+
+    const std::vector<BvhNode>& nodes() const { return nodes_; }
+    /// Primitive ids in leaf order.
+    const std::vector<std::uint32_t>& primitives() const { return primitives_; }
+
+    /// Refits the leaf holding `primitive` and its ancestors after that
+    /// primitive moved, stopping as soon as a node's bounds stop changing.
+    /// `primitiveBounds` holds the current box of every primitive.
+    void refit(std::uint32_t primitive, const math::Aabb* primitiveBounds);
+
+    /// Refits after moving several primitives; each affected node is
+    /// recomputed once, after its children, and ancestors only while bounds
+    /// keep changing.
+    void refit(const std::uint32_t* moved, std::size_t movedCount, const math::Aabb* primitiveBounds);
+
+    /// Recomputes every node bottom-up from `primitiveBounds`.
+    void refitAll(const math::Aabb* primitiveBounds);
+
+    /// SAH cost of the current tree relative to its root area; grows as refits
+    /// loosen the tree and is a good trigger for a rebuild.
+    float sahCost(const BvhBuildOptions& options = {}) const;
+
+    BvhView view() const { return {nodes_.data(), nodes_.size(), primitives_.data(), primitives_.size()}; }
+
+    /// Queries; see `BvhView`.
+    template <typename NodeFn, typename LeafFn>
+    void traverse(NodeFn&& visitNode, LeafFn&& visitLeaf) const {
+        view().traverse(visitNode, visitLeaf);
+    }
+    template <typename Fn>
+    void queryOverlap(const math::Aabb& box, Fn&& fn) const {
+        view().queryOverlap(box, fn);
+    }
+    template <typename Fn>
+    void raycast(const math::Ray& ray, Fn&& intersect) const {
+        view().raycast(ray, intersect);
+    }
+    template <typename Fn>
+    void raycastLeaves(const math::Ray& ray, Fn&& intersect) const {
+        view().raycastLeaves(ray, intersect);
+    }
+
+private:
+    friend struct BvhBuilder;
+
+    void linkParents();
+    /// Recomputes one node's box; returns true if it changed.
+    bool refitNode(std::uint32_t node, const math::Aabb* primitiveBounds);
+
+    std::vector<BvhNode> nodes_;
+    std::vector<std::uint32_t> primitives_;
+    /// Parent of each node (root's parent is itself).
+    std::vector<std::uint32_t> parents_;
+    /// Leaf node holding each primitive id.
+    std::vector<std::uint32_t> primitiveLeaf_;
+};
+
+/// Slab test; returns the entry distance or +infinity when `box` is missed
+/// within [ray.tMin, ray.tMax]. Test the result against infinity rather than
+/// `ray.tMax`, which may itself be infinite.
+float intersectRayAabb(const math::Ray& ray, const math::Vec3f& invDirection, const math::Aabb& box);
+
+template <typename NodeFn, typename LeafFn>
+void BvhView::traverse(NodeFn&& visitNode, LeafFn&& visitLeaf) const {
+    if (nodeCount == 0) {
+        return;
+    }
+    std::uint32_t stack[kMaxDepth];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const BvhNode& node = nodes[stack[--top]];
+        if (!visitNode(node)) {
+            continue;
+        }
+        if (node.isLeaf()) {
+            for (std::uint32_t i = 0; i < node.count; ++i) {
+                if (!visitLeaf(primitives[node.first + i])) {
+                    return;
+                }
+            }
+        } else {
+            stack[top++] = node.first + 1;
+            stack[top++] = node.first;
+        }
+    }
+}
+
+template <typename Fn>
+void BvhView::queryOverlap(const math::Aabb& box, Fn&& fn) const {
+    traverse([&](const BvhNode& node) { return node.bounds.overlaps(box); },
+             [&](std::uint32_t primitive) { return fn(primitive); });
+}
+
+template <typename Fn>
+void BvhView::raycast(math::Ray ray, Fn&& intersect) const {
+    raycastLeaves(ray, [&](const BvhNode& leaf, math::Ray& r) {
+        for (std::uint32_t i = 0; i < leaf.count; ++i) {
+            intersect(primitives[leaf.first + i], r);
+        }
+    });
+}
+
+template <typename Fn>
+void BvhView::raycastLeaves(math::Ray ray, Fn&& intersect) const {
+    if (nodeCount == 0) {
+        return;
+    }
+    const math::Vec3f invDir{1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z};
+    constexpr float kMiss = std::numeric_limits<float>::infinity();
+    struct Entry {
+        std::uint32_t node;
+        float tEntry;
+    };
+    Entry stack[kMaxDepth];
+    int top = 0;
+    const float tRoot = intersectRayAabb(ray, invDir, nodes[0].bounds);
+    if (tRoot < kMiss) {
+        stack[top++] = {0, tRoot};
+    }
+    while (top > 0) {
+        const Entry entry = stack[--top];
+        // A closer hit found since this entry was pushed may rule it out.
+        if (entry.tEntry > ray.tMax) {
+            continue;
+        }
+        const BvhNode& node = nodes[entry.node];
+        if (node.isLeaf()) {
+            intersect(node, ray);
+            continue;
+        }
+        const std::uint32_t left = node.first;
+        const std::uint32_t right = node.first + 1;
+        const float tLeft = intersectRayAabb(ray, invDir, nodes[left].bounds);
+        const float tRight = intersectRayAabb(ray, invDir, nodes[right].bounds);
+        const bool hitLeft = tLeft < kMiss;
+        const bool hitRight = tRight < kMiss;
+        // Push the far child first so the near one is popped next.
+        if (hitLeft && hitRight) {
+            if (tLeft <= tRight) {
+                stack[top++] = {right, tRight};
+                stack[top++] = {left, tLeft};
+            } else {
+                stack[top++] = {left, tLeft};
+                stack[top++] = {right, tRight};
+            }
+        } else if (hitLeft) {
+            stack[top++] = {left, tLeft};
+        } else if (hitRight) {
+            stack[top++] = {right, tRight};
+        }
+    }
+}
+
+} // namespace rebel::spatial
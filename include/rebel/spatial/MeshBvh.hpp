@@ -0,0 +1,61 @@
+#pragma once
+
+#include "rebel/core/AlignedAllocator.hpp"
+#include "rebel/geometry/Mesh.hpp"
+#include "rebel/math/Batch.hpp"
+#include "rebel/spatial/Bvh.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+
+namespace rebel::spatial {
+
+struct RayHit {
+    std::uint32_t triangle = geometry::kInvalidIndex;
+    float t = std::numeric_limits<float>::infinity();
+
+    bool hit() const { return triangle != geometry::kInvalidIndex; }
+};
+
+/// Triangle BVH for one mesh. Triangle vertices are copied into leaf order
+/// as SoA `v0/e1/e2` arrays, so each leaf is one contiguous batch for the
+/// SIMD ray kernel. Immutable after build and safe to share between any
+/// number of instances and threads.
+///
+/// Queries only ever see a `BvhView` and the triangle arrays, which either
+/// belong to the hierarchy (`build`) or live elsewhere, such as a mapped
+/// file (`wrap`); copies share the same arrays.
+class MeshBvh {
+public:
+    MeshBvh() = default;
+
+    static MeshBvh build(const geometry::MeshView& mesh, const BvhBuildOptions& options = {});
+
+    /// Hierarchy over arrays owned elsewhere, laid out exactly as `build`
+    /// produces them: `triangles` in leaf order, one entry per primitive.
+    /// `storage` keeps the arrays alive for as long as any copy exists.
+    static MeshBvh wrap(const BvhView& bvh, const math::batch::TriangleBatch& triangles,
+                        std::shared_ptr<const void> storage);
+
+    const BvhView& bvh() const { return bvh_; }
+    math::Aabb bounds() const { return bvh_.bounds(); }
+    std::size_t triangleCount() const { return bvh_.primitiveCount; }
+
+    /// Closest hit along `ray` in mesh space.
+    RayHit raycast(const math::Ray& ray) const;
+
+    /// Triangles of the leaf-ordered batch covering `leaf`.
+    math::batch::TriangleBatch leafBatch(const BvhNode& leaf) const;
+    /// All triangles in leaf order.
+    const math::batch::TriangleBatch& triangles() const { return triangles_; }
+
+    std::size_t memoryBytes() const;
+
+private:
+    BvhView bvh_;
+    math::batch::TriangleBatch triangles_;
+    std::shared_ptr<const void> storage_;
+};
+
+} // namespace rebel::spatial
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "rebel/math/Mat4.hpp"
+#include "rebel/spatial/MeshBvh.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace rebel::spatial {
+
+using InstanceId = std::uint32_t;
+
+struct InstanceHit {
+    InstanceId instance = geometry::kInvalidIndex;
+    std::uint32_t triangle = geometry::kInvalidIndex;
+    float t = std::numeric_limits<float>::infinity();
+
+    bool hit() const { return instance != geometry::kInvalidIndex; }
+};
+
+/// Two-level hierarchy: a top-level BVH over instance world boxes whose
+/// leaves point at shared, per-mesh `MeshBvh`s. Instancing a mesh costs one
+/// transform and one box, never another copy of its triangles or BVH.
+///
+/// Moving instances marks them dirty; `commit()` transforms only their boxes
+/// and refits only the affected top-level paths. Adding instances forces a
+/// top-level rebuild on the next commit.
+class TwoLevelBvh {
+public:
+    TwoLevelBvh() = default;
+
+    /// `mesh` must outlive this hierarchy.
+    InstanceId addInstance(const MeshBvh* mesh, const math::Mat4f& transform);
+    void setTransform(InstanceId instance, const math::Mat4f& transform);
+    /// Points `instance` at other geometry (e.g. another level of detail of
+    /// the same part); refit like a move on the next commit.
+    void setMesh(InstanceId instance, const MeshBvh* mesh);
+
+    std::size_t instanceCount() const { return meshes_.size(); }
+    const MeshBvh* mesh(InstanceId instance) const { return meshes_[instance]; }
+    const math::Mat4f& transform(InstanceId instance) const { return transforms_[instance]; }
+    const math::Mat4f& inverseTransform(InstanceId instance) const { return inverses_[instance]; }
+    /// World box as of the last `commit()`.
+    const math::Aabb& worldBounds(InstanceId instance) const { return worldBounds_[instance]; }
+    const Bvh& topLevel() const { return top_; }
+
+    /// Applies pending changes: refit for moved instances, full rebuild if the
+    /// instance set changed.
+    void commit(const BvhBuildOptions& options = {});
+    /// Rebuilds the top level from scratch (e.g. after many refits).
+    void rebuild(const BvhBuildOptions& options = {});
+    bool needsCommit() const { return needsRebuild_ || !dirty_.empty(); }
+
+    /// Closest hit in world space. Requires a committed hierarchy.
+    InstanceHit raycast(const math::Ray& ray) const;
+
+    /// Calls `fn(instance)` for instances whose world box overlaps `box`.
+    template <typename Fn>
+    void queryOverlap(const math::Aabb& box, Fn&& fn) const {
+        top_.queryOverlap(box, [&](std::uint32_t instance) {
+            return worldBounds_[instance].overlaps(box) ? fn(instance) : true;
+        });
+    }
+
+private:
+    void updateWorldBounds(const std::uint32_t* instances, std::size_t count);
+
+    std::vector<const MeshBvh*> meshes_;
+    std::vector<math::Mat4f> transforms_;
+    std::vector<math::Mat4f> inverses_;
+    std::vector<math::Aabb> localBounds_;
+    std::vector<math::Aabb> worldBounds_;
+    std::vector<std::uint32_t> dirty_;
+    std::vector<std::uint8_t> isDirty_;
+    Bvh top_;
+    bool needsRebuild_ = false;
+};
+
+} // namespace rebel::spatial
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "rebel/assembly/Assembly.hpp"
+#include "rebel/core/Hash.hpp"
+#include "rebel/feature/Feature.hpp"
+#include "rebel/geometry/Mesh.hpp"
+#include "rebel/math/Mat4.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace rebel::sync {
+
+/// Site taking part in a session. Site 0 stands for the document every
+/// site opened, so real sites start at 1.
+using SiteId = std::uint32_t;
+
+/// Identity of an assembly node shared by all sites: the site that added
+/// it and a serial from that site. Nodes of the opened document are site 0
+/// with their node id as serial; node ids themselves differ between sites
+/// once several of them add nodes.
+using NodeKey = std::uint64_t;
+
+constexpr NodeKey makeNodeKey(SiteId site, std::uint64_t serial) {
+    return (static_cast<NodeKey>(site) << 40) | serial;
+}
+
+/// A part referenced by a change set: its library name and the content
+/// hash of its geometry, under which sites fetch the geometry they lack.
+struct PartRef {
+    std::string name;
+    core::Hash128 geometry;
+};
+
+inline constexpr std::uint32_t kNoPart = 0xFFFFFFFFu;
+
+/// New node under `parent`; `part` indexes `ChangeSet::parts`, or is
+/// `kNoPart` for a subassembly.
+struct AddNodeOp {
+    NodeKey node = 0;
+    NodeKey parent = 0;
+    std::uint32_t part = kNoPart;
+    math::Mat4f local;
+    std::string name;
+};
+
+struct RemoveNodeOp {
+    NodeKey node = 0;
+};
+
+struct TransformOp {
+    NodeKey node = 0;
+    math::Mat4f local;
+};
+
+struct OverridesOp {
+    NodeKey node = 0;
+    assembly::Overrides overrides;
+};
+
+/// Features are addressed by id: sites share the feature graph of the
+/// document they opened, and feature additions are not synchronized.
+struct ParameterOp {
+    feature::FeatureId feature = feature::kInvalidFeature;
+    std::string name;
+    feature::ParameterValue value;
+};
+
+using Operation = std::variant<AddNodeOp, RemoveNodeOp, TransformOp, OverridesOp, ParameterOp>;
+
+/// The edits of one site between two publications, as operations on
+/// shared identities rather than document state.
+struct ChangeSet {
+    SiteId site = 0;
+    /// Counts the site's change sets from 1, so it recognizes its own when
+    /// the hub sends them back.
+    std::uint64_t serial = 0;
+    /// Position in the hub's log, assigned by the hub; 0 before that.
+    std::uint64_t sequence = 0;
+    std::vector<PartRef> parts;
+    std::vector<Operation> operations;
+};
+
+/// Compact little-endian encoding: variable-length integers, affine
+/// transforms as 12 floats. A transform edit encodes to about 60 bytes.
+std::vector<std::uint8_t> encode(const ChangeSet& changes);
+/// Throws `std::runtime_error` for malformed or truncated input.
+ChangeSet decodeChangeSet(const std::uint8_t* data, std::size_t size);
+
+/// Hash of every array of `mesh`: the address of its geometry.
+core::Hash128 geometryHash(const geometry::MeshView& mesh);
+/// Geometry of a part as sent between sites; the name travels in the
+/// `PartRef`, so equal geometry under different names is stored once.
+std::vector<std::uint8_t> encodeGeometry(const geometry::MeshView& mesh);
+/// Throws `std::runtime_error` for malformed or truncated input.
+geometry::Mesh decodeGeometry(const std::uint8_t* data, std::size_t size);
+
+} // namespace rebel::sync
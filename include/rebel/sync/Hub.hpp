@@ -0,0 +1,68 @@
+#pragma once
+
+#include "rebel/sync/ChangeSet.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace rebel::sync {
+
+using Message = std::vector<std::uint8_t>;
+using SharedMessage = std::shared_ptr<const Message>;
+
+struct HubStats {
+    std::size_t changeSets = 0;
+    std::size_t changeSetBytes = 0;
+    std::size_t geometries = 0;
+    std::size_t geometryBytes = 0;
+    /// Uploads of geometry the store already had.
+    std::size_t duplicateGeometries = 0;
+};
+
+/// Server end of a session: puts the change sets of all sites into one
+/// order and stores part geometry by content hash.
+///
+/// Every change set gets the next sequence number and goes to every site,
+/// its sender included; sites apply them in that order, which is what
+/// makes them converge. The log lets sites that join or reconnect catch
+/// up from their last sequence. Geometry is uploaded once per content,
+/// whatever the number of parts, sites and occurrences using it, and
+/// fetched by sites only when a change set names a part they lack.
+///
+/// Transport is left to the caller; everything goes in and out as encoded
+/// messages. Thread-safe, so connections may be served concurrently.
+class Hub {
+public:
+    /// Stamps an encoded change set with the next sequence number, appends
+    /// it to the log and returns it for broadcast. Throws
+    /// `std::runtime_error` if the message does not decode.
+    SharedMessage submit(const std::uint8_t* data, std::size_t size);
+
+    /// Sequence number of the latest change set (0 if none).
+    std::uint64_t sequence() const;
+    /// Change sets after `sequence`, in order.
+    std::vector<SharedMessage> since(std::uint64_t sequence) const;
+
+    bool hasGeometry(const core::Hash128& hash) const;
+    /// Of `hashes`, the ones to upload.
+    std::vector<core::Hash128> missingGeometry(const std::vector<core::Hash128>& hashes) const;
+    /// Stores encoded geometry after checking it decodes and returns its
+    /// hash. Throws `std::runtime_error` for malformed input.
+    core::Hash128 putGeometry(const std::uint8_t* data, std::size_t size);
+    /// Encoded geometry, or null if not stored.
+    SharedMessage geometry(const core::Hash128& hash) const;
+
+    HubStats stats() const;
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<SharedMessage> log_;
+    std::unordered_map<core::Hash128, SharedMessage> geometry_;
+    HubStats stats_;
+};
+
+} // namespace rebel::sync
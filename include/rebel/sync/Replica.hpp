@@ -0,0 +1,161 @@
+#pragma once
+
+#include "rebel/assembly/PartLibrary.hpp"
+#include "rebel/feature/FeatureGraph.hpp"
+#include "rebel/sync/Hub.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace rebel::sync {
+
+struct ReplicaStats {
+    std::size_t published = 0;
+    std::size_t publishedBytes = 0;
+    /// Change sets of other sites applied.
+    std::size_t applied = 0;
+    std::size_t receivedBytes = 0;
+    std::size_t geometryBytes = 0;
+    /// Remote operations without effect: their node was removed, or a
+    /// local edit of the same value is still on its way to the hub.
+    std::size_t ignored = 0;
+};
+
+/// What `Replica::publish()` produced: the change set for the hub, empty
+/// if nothing changed, and the geometry it refers to, of which the site
+/// uploads whatever the hub lacks (`Hub::missingGeometry()`).
+struct Publication {
+    Message changeSet;
+    std::vector<core::Hash128> geometry;
+};
+
+/// One site's end of a session over an assembly and, optionally, the
+/// feature graph of the same document.
+///
+/// Local edits are made on the assembly and graph as usual. `publish()`
+/// finds them by comparing the assembly with its snapshot from the last
+/// publication, which costs the number of edited records, and turns them
+/// into operations: nodes added and removed, transforms and overrides set,
+/// feature parameters changed. Change sets from the hub are applied the
+/// same way as edits, so indices and scenes over the assembly update
+/// incrementally; parts they add are taken from the library by name, and
+/// geometry the site does not have is fetched by content hash first.
+///
+/// Sites apply every change set in the hub's order, and a site keeps its
+/// own value of anything it edited until the hub has ordered that edit, so
+/// concurrent edits of one value settle on the one ordered last on every
+/// site. Removing a node wins over edits of its subtree.
+///
+/// Every site must start from the same document (e.g. the same native
+/// file) at the same sequence. Call everything from the editing thread.
+class Replica {
+public:
+    /// `sequence` is the hub sequence the document is at. `site` must be
+    /// unique in the session and not 0. The assembly, library and graph
+    /// must outlive the replica.
+    Replica(SiteId site, assembly::Assembly& assembly, assembly::PartLibrary& library,
+            feature::FeatureGraph* features = nullptr, std::uint64_t sequence = 0);
+
+    SiteId site() const { return site_; }
+
+    /// Turns the edits since the last call into a change set.
+    Publication publish();
+
+    /// Encoded geometry of a part this site published, for upload. Throws
+    /// `std::out_of_range` for other hashes.
+    Message localGeometry(const core::Hash128& hash) const;
+
+    /// Takes a change set from the hub; they must arrive in sequence order
+    /// (repeats are ignored). Applies it at once unless it or an earlier
+    /// one waits for geometry. Throws `std::runtime_error` for malformed
+    /// messages and gaps in the sequence.
+    void receive(const std::uint8_t* data, std::size_t size);
+
+    /// Geometry to fetch from the hub before waiting change sets apply.
+    std::vector<core::Hash128> missingGeometry() const;
+    /// Takes encoded geometry fetched from the hub and applies the change
+    /// sets that waited for it.
+    void provideGeometry(const std::uint8_t* data, std::size_t size);
+
+    /// Sequence of the last change set received and applied.
+    std::uint64_t sequence() const { return sequence_; }
+    /// Published change sets the hub has not sent back yet.
+    std::size_t unacknowledged() const { return inFlight_.size(); }
+    /// Received change sets waiting for geometry.
+    std::size_t waiting() const { return waiting_.size(); }
+
+    /// Shared identity of a node, and back (`assembly::kInvalidNode` if
+    /// unknown here).
+    NodeKey key(assembly::NodeId node) const;
+    assembly::NodeId node(NodeKey key) const;
+
+    ReplicaStats stats() const { return stats_; }
+
+private:
+    /// A value a pending local edit set, shielded from remote edits.
+    using Mask = std::pair<NodeKey, std::uint8_t>;
+    using ParameterMask = std::pair<feature::FeatureId, std::string>;
+
+    struct Pending {
+        std::uint64_t serial = 0;
+        std::vector<Mask> masks;
+        std::vector<ParameterMask> parameterMasks;
+    };
+
+    void capture();
+    std::uint32_t partRef(assembly::PartId part);
+    void mask(Mask m);
+    void mask(ParameterMask m);
+    void release(const Pending& pending);
+    bool resolvable(const ChangeSet& changes) const;
+    void apply(const ChangeSet& changes);
+    void applyWaiting();
+    assembly::NodeId live(NodeKey key) const;
+
+    SiteId site_;
+    assembly::Assembly& assembly_;
+    assembly::PartLibrary& library_;
+    feature::FeatureGraph* features_;
+    std::uint64_t sequence_;
+    /// Sequence of the last change set received, applied or waiting.
+    std::uint64_t received_;
+
+    /// The assembly as of the last capture or remote change set.
+    assembly::Assembly shadow_;
+    std::vector<feature::Parameters> shadowParameters_;
+
+    /// Nodes of the opened document have site 0 keys equal to their ids;
+    /// later ones are looked up.
+    std::size_t documentNodes_ = 0;
+    std::vector<NodeKey> addedKeys_;
+    std::unordered_map<NodeKey, assembly::NodeId> addedNodes_;
+    std::uint64_t nextNodeSerial_ = 1;
+    std::uint64_t nextChangeSerial_ = 1;
+
+    /// Captured and not published yet.
+    ChangeSet outbox_;
+    Pending outboxPending_;
+    std::unordered_map<assembly::PartId, std::uint32_t> outboxParts_;
+    /// Published and not back from the hub, oldest first.
+    std::deque<Pending> inFlight_;
+    std::map<Mask, std::uint32_t> masks_;
+    std::map<ParameterMask, std::uint32_t> parameterMasks_;
+
+    /// Geometry hash of each published part, by definition.
+    std::unordered_map<const assembly::Part*, std::pair<assembly::PartPtr, core::Hash128>> partHashes_;
+    std::unordered_map<core::Hash128, assembly::PartPtr> publishedGeometry_;
+
+    std::deque<ChangeSet> waiting_;
+    std::unordered_map<core::Hash128, std::shared_ptr<const geometry::Mesh>> fetched_;
+
+    ReplicaStats stats_;
+};
+
+} // namespace rebel::sync
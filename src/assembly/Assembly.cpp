@@ -0,0 +1,223 @@
+#include "rebel/assembly/Assembly.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_set>
+#include <utility>
+
+namespace rebel::assembly {
+
+Assembly::Assembly() {
+    nodes_.push_back({});
+}
+
+NodeId Assembly::addNode(NodeId parent, PartId part, const math::Mat4f& local, std::string name) {
+    if (parent >= nodes_.size() || nodes_[parent].removed || nodes_[parent].isOccurrence()) {
+        throw std::invalid_argument("assembly parent must be a live subassembly node");
+    }
+    const auto id = static_cast<NodeId>(nodes_.size());
+    AssemblyNode node;
+    node.local = local;
+    node.part = part;
+    node.parent = parent;
+    // Children are prepended; traversal pops them off a stack, which restores
+    // insertion order.
+    node.nextSibling = nodes_[parent].firstChild;
+    nodes_.mutate(parent).firstChild = id;
+    nodes_.push_back(node);
+    if (!name.empty()) {
+        names_.extend(id + std::size_t(1));
+        names_.set(id, std::move(name));
+    }
+    structureRevision_ = ++revision_;
+    return id;
+}
+
+NodeId Assembly::addSubassembly(NodeId parent, const math::Mat4f& local, std::string name) {
+    return addNode(parent, kInvalidPart, local, std::move(name));
+}
+
+NodeId Assembly::addOccurrence(NodeId parent, PartId part, const math::Mat4f& local, std::string name) {
+    if (part == kInvalidPart) {
+        throw std::invalid_argument("occurrence needs a part id");
+    }
+    return addNode(parent, part, local, std::move(name));
+}
+
+void Assembly::remove(NodeId id) {
+    if (id == root()) {
+        throw std::invalid_argument("cannot remove the assembly root");
+    }
+    const AssemblyNode& node = nodes_.at(id);
+    if (node.removed) {
+        return;
+    }
+    const NodeId next = node.nextSibling;
+    if (nodes_[node.parent].firstChild == id) {
+        nodes_.mutate(node.parent).firstChild = next;
+    } else {
+        NodeId previous = nodes_[node.parent].firstChild;
+        while (nodes_[previous].nextSibling != id) {
+            previous = nodes_[previous].nextSibling;
+        }
+        nodes_.mutate(previous).nextSibling = next;
+    }
+
+    std::vector<NodeId> stack{id};
+    while (!stack.empty()) {
+        const NodeId n = stack.back();
+        stack.pop_back();
+        nodes_.mutate(n).removed = true;
+        if (n < names_.size() && !names_[n].empty()) {
+            names_.set(n, {});
+        }
+        for (NodeId c = nodes_[n].firstChild; c != kInvalidNode; c = nodes_[c].nextSibling) {
+            stack.push_back(c);
+        }
+    }
+    structureRevision_ = ++revision_;
+}
+
+void Assembly::setLocalTransform(NodeId id, const math::Mat4f& local) {
+    if (nodes_.at(id).local == local) {
+        return;
+    }
+    nodes_.mutate(id).local = local;
+    changes_.push_back({++revision_, id});
+}
+
+void Assembly::setOverrides(NodeId id, const Overrides& overrides) {
+    const Overrides& current = nodes_.at(id).overrides;
+    if (current == overrides) {
+        return;
+    }
+    const bool suppressionChanged = current.suppressed() != overrides.suppressed();
+    nodes_.mutate(id).overrides = overrides;
+    changes_.push_back({++revision_, id});
+    if (suppressionChanged) {
+        // Suppression changes which occurrences exist downstream.
+        structureRevision_ = revision_;
+    }
+}
+
+const std::string& Assembly::name(NodeId id) const {
+    static const std::string empty;
+    return id < names_.size() ? names_[id] : empty;
+}
+
+math::Mat4f Assembly::worldTransform(NodeId id) const {
+    math::Mat4f world = nodes_.at(id).local;
+    for (NodeId p = nodes_[id].parent; p != kInvalidNode; p = nodes_[p].parent) {
+        world = nodes_[p].local * world;
+    }
+    return world;
+}
+
+std::vector<Occurrence> Assembly::occurrences() const {
+    std::vector<Occurrence> result;
+    forEachOccurrence([&](const Occurrence& occ) { result.push_back(occ); });
+    return result;
+}
+
+void Assembly::collectOccurrences(NodeId id, std::vector<NodeId>& out) const {
+    std::vector<NodeId> stack{id};
+    while (!stack.empty()) {
+        const NodeId n = stack.back();
+        stack.pop_back();
+        const AssemblyNode& node = nodes_[n];
+        if (node.removed || node.overrides.suppressed()) {
+            continue;
+        }
+        if (node.isOccurrence()) {
+            out.push_back(n);
+        }
+        for (NodeId c = node.firstChild; c != kInvalidNode; c = nodes_[c].nextSibling) {
+            stack.push_back(c);
+        }
+    }
+}
+
+void Assembly::changedSince(std::uint64_t revision, std::vector<NodeId>& out) const {
+    // First change after `revision`; the log is sorted by revision.
+    std::size_t first = 0;
+    std::size_t count = changes_.size();
+    while (count > 0) {
+        const std::size_t half = count / 2;
+        if (changes_[first + half].revision <= revision) {
+            first += half + 1;
+            count -= half + 1;
+        } else {
+            count = half;
+        }
+    }
+    for (std::size_t i = first; i < changes_.size(); ++i) {
+        const NodeId node = changes_[i].node;
+        if (!nodes_[node].removed) {
+            out.push_back(node);
+        }
+    }
+}
+
+void Assembly::restore(const Assembly& snapshot) {
+    // Ids are never reused: nodes added after the snapshot was taken stay,
+    // as removed records.
+    core::PersistentVector<AssemblyNode> target = snapshot.nodes_;
+    for (std::size_t i = target.size(); i < nodes_.size(); ++i) {
+        AssemblyNode node = nodes_[i];
+        node.removed = true;
+        target.push_back(node);
+    }
+    bool structural = target.size() != nodes_.size();
+    std::vector<NodeId> changed;
+    if (!structural) {
+        nodes_.forEachDifference(target, [&](std::size_t i, const AssemblyNode& mine,
+                                                      const AssemblyNode& theirs) {
+            if (mine.part != theirs.part || mine.parent != theirs.parent || mine.firstChild != theirs.firstChild ||
+                mine.nextSibling != theirs.nextSibling || mine.removed != theirs.removed ||
+                mine.overrides.suppressed() != theirs.overrides.suppressed()) {
+                structural = true;
+            } else if (!(mine.local == theirs.local) || mine.overrides != theirs.overrides) {
+                changed.push_back(static_cast<NodeId>(i));
+            }
+        });
+    }
+    nodes_ = std::move(target);
+    names_ = snapshot.names_;
+    // The change log stays ours: it indexes our revisions, which readers of
+    // `changedSince()` hold, and the snapshot's may have been numbered
+    // differently since it was taken.
+    revision_ = std::max(revision_, snapshot.revision_) + 1;
+    for (const NodeId node : changed) {
+        changes_.push_back({revision_, node});
+    }
+    if (structural) {
+        structureRevision_ = revision_;
+    }
+}
+
+AssemblyStats Assembly::stats() const {
+    AssemblyStats stats;
+    std::unordered_set<PartId> parts;
+    forEachOccurrence([&](const Occurrence& occ) {
+        ++stats.occurrences;
+        parts.insert(occ.part);
+    });
+    nodes_.forEachStored([&](std::size_t, const AssemblyNode& node) {
+        if (!node.removed && !node.isOccurrence()) {
+            ++stats.subassemblies;
+        }
+    });
+    stats.uniqueParts = parts.size();
+    stats.recordBytes = recordBytes();
+    return stats;
+}
+
+std::size_t Assembly::recordBytes(std::unordered_set<const void*>* seen) const {
+    static const std::size_t inlineCapacity = std::string().capacity();
+    return nodes_.memoryBytes(seen) + changes_.memoryBytes(seen) +
+           names_.memoryBytes(seen, [](const std::string& name) {
+               return name.capacity() > inlineCapacity ? name.capacity() + 1 : std::size_t(0);
+           });
+}
+
+} // namespace rebel::assembly
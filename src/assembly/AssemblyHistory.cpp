@@ -0,0 +1,60 @@
+#include "rebel/assembly/AssemblyHistory.hpp"
+
+#include <stdexcept>
+#include <unordered_set>
+#include <utility>
+
+namespace rebel::assembly {
+
+AssemblyHistory::AssemblyHistory(Assembly& assembly, std::size_t limit) : assembly_(assembly), limit_(limit) {
+    if (limit == 0) {
+        throw std::invalid_argument("history must keep at least one step");
+    }
+    steps_.push_back({assembly, {}});
+}
+
+void AssemblyHistory::commit(std::string label) {
+    steps_.resize(current_ + 1);
+    steps_.push_back({assembly_, std::move(label)});
+    if (steps_.size() > limit_) {
+        steps_.erase(steps_.begin(), steps_.begin() + static_cast<std::ptrdiff_t>(steps_.size() - limit_));
+    }
+    current_ = steps_.size() - 1;
+}
+
+const std::string& AssemblyHistory::undoLabel() const {
+    static const std::string empty;
+    return canUndo() ? steps_[current_].label : empty;
+}
+
+const std::string& AssemblyHistory::redoLabel() const {
+    static const std::string empty;
+    return canRedo() ? steps_[current_ + 1].label : empty;
+}
+
+bool AssemblyHistory::undo() {
+    if (!canUndo()) {
+        return false;
+    }
+    assembly_.restore(steps_[--current_].state);
+    return true;
+}
+
+bool AssemblyHistory::redo() {
+    if (!canRedo()) {
+        return false;
+    }
+    assembly_.restore(steps_[++current_].state);
+    return true;
+}
+
+std::size_t AssemblyHistory::memoryBytes() const {
+    std::unordered_set<const void*> seen;
+    std::size_t bytes = 0;
+    for (const Step& step : steps_) {
+        bytes += step.state.recordBytes(&seen) + step.label.capacity();
+    }
+    return bytes;
+}
+
+} // namespace rebel::assembly
@@ -0,0 +1,108 @@
+#include "rebel/assembly/AssemblyIndex.hpp"
+
+#include "rebel/core/Trace.hpp"
+
+#include <algorithm>
+
+namespace rebel::assembly {
+
+AssemblyIndex::AssemblyIndex(const Assembly& assembly, const PartLibrary& library)
+    : assembly_(assembly), library_(library) {}
+
+spatial::InstanceId AssemblyIndex::instance(NodeId node) const {
+    const auto it = instanceOf_.find(node);
+    return it == instanceOf_.end() ? geometry::kInvalidIndex : it->second;
+}
+
+void AssemblyIndex::rebuild() {
+    REBEL_TRACE_ZONE("assembly.index_rebuild");
+    bvh_ = spatial::TwoLevelBvh();
+    nodes_.clear();
+    parts_.clear();
+    retained_.clear();
+    instanceOf_.clear();
+    libraryRevision_ = library_.revision();
+    assembly_.forEachOccurrence([&](const Occurrence& occ) {
+        auto it = retained_.find(occ.part);
+        if (it == retained_.end()) {
+            it = retained_.emplace(occ.part, library_.get(occ.part)).first;
+        }
+        const spatial::InstanceId id = bvh_.addInstance(&it->second->bvh(), occ.world);
+        nodes_.push_back(occ.node);
+        parts_.push_back(occ.part);
+        instanceOf_.emplace(occ.node, id);
+    });
+    bvh_.commit();
+    moved_ = nodes_;
+}
+
+const std::vector<NodeId>& AssemblyIndex::update() {
+    REBEL_TRACE_ZONE("assembly.index_update");
+    moved_.clear();
+    const std::uint64_t current = assembly_.revision();
+    if (!built_ || assembly_.structureChangedSince(revision_)) {
+        rebuild();
+        built_ = true;
+        revision_ = current;
+        return moved_;
+    }
+
+    std::vector<PartId> replaced;
+    library_.replacedSince(libraryRevision_, replaced);
+    libraryRevision_ = library_.revision();
+    if (!replaced.empty()) {
+        std::sort(replaced.begin(), replaced.end());
+        replaced.erase(std::unique(replaced.begin(), replaced.end()), replaced.end());
+        for (PartId id : replaced) {
+            const auto it = retained_.find(id);
+            if (it != retained_.end()) {
+                it->second = library_.get(id);
+            }
+        }
+        for (spatial::InstanceId i = 0; i < parts_.size(); ++i) {
+            if (std::binary_search(replaced.begin(), replaced.end(), parts_[i])) {
+                bvh_.setMesh(i, &retained_[parts_[i]]->bvh());
+                moved_.push_back(nodes_[i]);
+            }
+        }
+    }
+
+    std::vector<NodeId> changed;
+    assembly_.changedSince(revision_, changed);
+    revision_ = current;
+    if (changed.empty()) {
+        if (!moved_.empty()) {
+            bvh_.commit();
+        }
+        return moved_;
+    }
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    for (NodeId n : changed) {
+        assembly_.collectOccurrences(n, moved_);
+    }
+    std::sort(moved_.begin(), moved_.end());
+    moved_.erase(std::unique(moved_.begin(), moved_.end()), moved_.end());
+    // Occurrences under a suppressed ancestor are not indexed.
+    moved_.erase(std::remove_if(moved_.begin(), moved_.end(),
+                                [&](NodeId n) { return instanceOf_.count(n) == 0; }),
+                 moved_.end());
+    for (NodeId n : moved_) {
+        bvh_.setTransform(instanceOf_[n], assembly_.worldTransform(n));
+    }
+    bvh_.commit();
+    return moved_;
+}
+
+AssemblyHit AssemblyIndex::raycast(const math::Ray& ray) const {
+    const spatial::InstanceHit hit = bvh_.raycast(ray);
+    AssemblyHit result;
+    if (hit.hit()) {
+        result.node = nodes_[hit.instance];
+        result.triangle = hit.triangle;
+        result.t = hit.t;
+    }
+    return result;
+}
+
+} // namespace rebel::assembly
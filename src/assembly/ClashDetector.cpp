@@ -0,0 +1,338 @@
+#include "rebel/assembly/ClashDetector.hpp"
+
+#include "rebel/core/TaskScheduler.hpp"
+#include "rebel/core/Trace.hpp"
+#include "rebel/math/Predicates.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <utility>
+
+namespace rebel::assembly {
+
+namespace {
+
+using math::Vec3d;
+using math::Vec3f;
+using spatial::BvhNode;
+using spatial::InstanceId;
+
+using Candidate = std::pair<InstanceId, InstanceId>;
+using NodePair = std::pair<std::uint32_t, std::uint32_t>;
+
+/// Box of `box` under `m` (Arvo), padded so float rounding can only make it
+/// larger than the exact image, never smaller.
+math::Aabb transformBox(const math::Mat4f& m, const math::Aabb& box) {
+    const Vec3f c = m.transformPoint(box.center());
+    const Vec3f e = box.extent() * 0.5f;
+    Vec3f r;
+    for (int row = 0; row < 3; ++row) {
+        const float v = std::fabs(m(row, 0)) * e.x + std::fabs(m(row, 1)) * e.y + std::fabs(m(row, 2)) * e.z;
+        (row == 0 ? r.x : row == 1 ? r.y : r.z) = v;
+    }
+    const float pad = 1e-5f * (std::max({std::fabs(c.x), std::fabs(c.y), std::fabs(c.z)}) +
+                               std::max({r.x, r.y, r.z}));
+    r = r + Vec3f{pad, pad, pad};
+    return {c - r, c + r};
+}
+
+/// Broad phase: instance pairs below two top-level nodes whose world boxes
+/// overlap, found by descending both at once.
+void collectPairs(const spatial::TwoLevelBvh& bvh, std::vector<NodePair>& stack, std::vector<Candidate>& out) {
+    const std::vector<BvhNode>& nodes = bvh.topLevel().nodes();
+    const std::vector<std::uint32_t>& prims = bvh.topLevel().primitives();
+    auto emit = [&](std::uint32_t p, std::uint32_t q) {
+        if (bvh.worldBounds(p).overlaps(bvh.worldBounds(q))) {
+            out.emplace_back(std::min(p, q), std::max(p, q));
+        }
+    };
+    while (!stack.empty()) {
+        const auto [i, j] = stack.back();
+        stack.pop_back();
+        const BvhNode& a = nodes[i];
+        const BvhNode& b = nodes[j];
+        if (i == j) {
+            if (a.isLeaf()) {
+                for (std::uint32_t p = a.first; p < a.first + a.count; ++p) {
+                    for (std::uint32_t q = p + 1; q < a.first + a.count; ++q) {
+                        emit(prims[p], prims[q]);
+                    }
+                }
+            } else {
+                stack.emplace_back(a.first, a.first);
+                stack.emplace_back(a.first + 1, a.first + 1);
+                stack.emplace_back(a.first, a.first + 1);
+            }
+            continue;
+        }
+        if (!a.bounds.overlaps(b.bounds)) {
+            continue;
+        }
+        if (a.isLeaf() && b.isLeaf()) {
+            for (std::uint32_t p = a.first; p < a.first + a.count; ++p) {
+                for (std::uint32_t q = b.first; q < b.first + b.count; ++q) {
+                    emit(prims[p], prims[q]);
+                }
+            }
+        } else if (b.isLeaf() || (!a.isLeaf() && a.bounds.halfArea() >= b.bounds.halfArea())) {
+            stack.emplace_back(a.first, j);
+            stack.emplace_back(a.first + 1, j);
+        } else {
+            stack.emplace_back(i, b.first);
+            stack.emplace_back(i, b.first + 1);
+        }
+    }
+}
+
+/// Every overlapping instance pair of the index. The first levels of the
+/// self-traversal are expanded breadth-first into independent node pairs,
+/// which are then descended in parallel.
+std::vector<Candidate> overlappingPairs(const spatial::TwoLevelBvh& bvh) {
+    const std::vector<BvhNode>& nodes = bvh.topLevel().nodes();
+    if (nodes.empty()) {
+        return {};
+    }
+    const std::size_t target = 64 * std::size_t{core::TaskScheduler::global().threadCount()};
+    std::vector<NodePair> frontier{{0u, 0u}};
+    std::vector<Candidate> pairs;
+    for (std::size_t round = 0; round < 16 && frontier.size() < target; ++round) {
+        std::vector<NodePair> next;
+        bool expanded = false;
+        for (const auto& [i, j] : frontier) {
+            const BvhNode& a = nodes[i];
+            const BvhNode& b = nodes[j];
+            if (i == j ? a.isLeaf() : (a.isLeaf() && b.isLeaf()) || !a.bounds.overlaps(b.bounds)) {
+                std::vector<NodePair> one{{i, j}};
+                collectPairs(bvh, one, pairs);
+            } else if (i == j) {
+                next.emplace_back(a.first, a.first);
+                next.emplace_back(a.first + 1, a.first + 1);
+                next.emplace_back(a.first, a.first + 1);
+                expanded = true;
+            } else if (b.isLeaf() || (!a.isLeaf() && a.bounds.halfArea() >= b.bounds.halfArea())) {
+                next.emplace_back(a.first, j);
+                next.emplace_back(a.first + 1, j);
+                expanded = true;
+            } else {
+                next.emplace_back(i, b.first);
+                next.emplace_back(i, b.first + 1);
+                expanded = true;
+            }
+        }
+        frontier = std::move(next);
+        if (!expanded) {
+            break;
+        }
+    }
+
+    std::vector<std::vector<Candidate>> found(frontier.size());
+    core::parallelFor(0, frontier.size(), 1, [&](std::size_t first, std::size_t last) {
+        std::vector<NodePair> stack;
+        for (std::size_t k = first; k < last; ++k) {
+            stack.assign(1, frontier[k]);
+            collectPairs(bvh, stack, found[k]);
+        }
+    });
+    for (const std::vector<Candidate>& f : found) {
+        pairs.insert(pairs.end(), f.begin(), f.end());
+    }
+    return pairs;
+}
+
+struct WorldTriangle {
+    Vec3d v[3];
+    Vec3d lo;
+    Vec3d hi;
+};
+
+WorldTriangle worldTriangle(const geometry::MeshView& mesh, const math::Mat4f& m, std::uint32_t triangle) {
+    WorldTriangle t;
+    for (int k = 0; k < 3; ++k) {
+        const geometry::VertexIndex i = mesh.corners[3 * static_cast<std::size_t>(triangle) + k];
+        const double x = mesh.px[i];
+        const double y = mesh.py[i];
+        const double z = mesh.pz[i];
+        for (int row = 0; row < 3; ++row) {
+            const double w = double(m(row, 0)) * x + double(m(row, 1)) * y + double(m(row, 2)) * z +
+                             double(m(row, 3));
+            (row == 0 ? t.v[k].x : row == 1 ? t.v[k].y : t.v[k].z) = w;
+        }
+    }
+    t.lo = math::min(t.v[0], math::min(t.v[1], t.v[2]));
+    t.hi = math::max(t.v[0], math::max(t.v[1], t.v[2]));
+    return t;
+}
+
+bool boxesOverlap(const WorldTriangle& a, const WorldTriangle& b) {
+    return a.lo.x <= b.hi.x && b.lo.x <= a.hi.x && a.lo.y <= b.hi.y && b.lo.y <= a.hi.y && a.lo.z <= b.hi.z &&
+           b.lo.z <= a.hi.z;
+}
+
+/// Narrow phase for one instance pair: both triangle BVHs descended
+/// together in `a`'s local frame, leaf triangles tested exactly in world
+/// space. Returns a clash with `a == kInvalidNode` if there is none.
+Clash testPair(const AssemblyIndex& index, const Candidate& candidate, const ClashOptions& options,
+               std::size_t& trianglePairs) {
+    const spatial::TwoLevelBvh& bvh = index.bvh();
+    const auto [ia, ib] = candidate;
+    const spatial::BvhView& ta = bvh.mesh(ia)->bvh();
+    const spatial::BvhView& tb = bvh.mesh(ib)->bvh();
+    const geometry::MeshView& ma = index.definition(ia).mesh();
+    const geometry::MeshView& mb = index.definition(ib).mesh();
+    const math::Mat4f bToA = bvh.inverseTransform(ia) * bvh.transform(ib);
+
+    if (ta.empty() || tb.empty()) {
+        return {};
+    }
+    auto clash = [&](ClashKind kind, std::uint32_t triA, std::uint32_t triB) {
+        Clash c;
+        c.kind = kind;
+        c.a = index.node(ia);
+        c.b = index.node(ib);
+        c.triangleA = triA;
+        c.triangleB = triB;
+        if (c.b < c.a) {
+            std::swap(c.a, c.b);
+            std::swap(c.triangleA, c.triangleB);
+        }
+        return c;
+    };
+
+    Clash contact;
+    std::vector<WorldTriangle> leafA;
+    std::vector<NodePair> stack{{0u, 0u}};
+    while (!stack.empty()) {
+        const auto [i, j] = stack.back();
+        stack.pop_back();
+        const BvhNode& a = ta.nodes[i];
+        const BvhNode& b = tb.nodes[j];
+        const math::Aabb boxB = transformBox(bToA, b.bounds);
+        if (!a.bounds.overlaps(boxB)) {
+            continue;
+        }
+        if (a.isLeaf() && b.isLeaf()) {
+            leafA.clear();
+            for (std::uint32_t p = a.first; p < a.first + a.count; ++p) {
+                leafA.push_back(worldTriangle(ma, bvh.transform(ia), ta.primitives[p]));
+            }
+            for (std::uint32_t q = b.first; q < b.first + b.count; ++q) {
+                const std::uint32_t triB = tb.primitives[q];
+                const WorldTriangle wb = worldTriangle(mb, bvh.transform(ib), triB);
+                for (std::uint32_t p = 0; p < a.count; ++p) {
+                    const WorldTriangle& wa = leafA[p];
+                    if (!boxesOverlap(wa, wb)) {
+                        continue;
+                    }
+                    ++trianglePairs;
+                    const math::Intersection r =
+                        math::intersectTriangles(wa.v[0], wa.v[1], wa.v[2], wb.v[0], wb.v[1], wb.v[2]);
+                    const std::uint32_t triA = ta.primitives[a.first + p];
+                    if (r == math::Intersection::Proper) {
+                        return clash(ClashKind::Interference, triA, triB);
+                    }
+                    if (r == math::Intersection::Touching && options.reportContacts &&
+                        contact.a == kInvalidNode) {
+                        contact = clash(ClashKind::Contact, triA, triB);
+                    }
+                }
+            }
+        } else if (b.isLeaf() || (!a.isLeaf() && a.bounds.halfArea() >= boxB.halfArea())) {
+            stack.emplace_back(a.first, j);
+            stack.emplace_back(a.first + 1, j);
+        } else {
+            stack.emplace_back(i, b.first);
+            stack.emplace_back(i, b.first + 1);
+        }
+    }
+    return contact;
+}
+
+void testPairs(const AssemblyIndex& index, const std::vector<Candidate>& candidates, const ClashOptions& options,
+               std::vector<Clash>& out, ClashStats& stats) {
+    std::vector<Clash> results(candidates.size());
+    std::atomic<std::size_t> trianglePairs{0};
+    core::parallelFor(0, candidates.size(), 4, [&](std::size_t first, std::size_t last) {
+        std::size_t local = 0;
+        for (std::size_t k = first; k < last; ++k) {
+            results[k] = testPair(index, candidates[k], options, local);
+        }
+        trianglePairs.fetch_add(local, std::memory_order_relaxed);
+    });
+    for (const Clash& c : results) {
+        if (c.a != kInvalidNode) {
+            out.push_back(c);
+        }
+    }
+    stats.candidatePairs = candidates.size();
+    stats.trianglePairs = trianglePairs.load();
+}
+
+void sortClashes(std::vector<Clash>& clashes) {
+    std::sort(clashes.begin(), clashes.end(),
+              [](const Clash& x, const Clash& y) { return x.a != y.a ? x.a < y.a : x.b < y.b; });
+}
+
+} // namespace
+
+ClashDetector::ClashDetector(const AssemblyIndex& index, ClashOptions options)
+    : index_(index), options_(options) {}
+
+const std::vector<Clash>& ClashDetector::detectAll() {
+    REBEL_TRACE_ZONE("clash.detect_all");
+    clashes_.clear();
+    stats_ = {};
+    testPairs(index_, overlappingPairs(index_.bvh()), options_, clashes_, stats_);
+    sortClashes(clashes_);
+    return clashes_;
+}
+
+const std::vector<Clash>& ClashDetector::update(const std::vector<NodeId>& moved) {
+    if (moved.size() >= index_.occurrenceCount()) {
+        return detectAll();
+    }
+    REBEL_TRACE_ZONE("clash.update");
+    stats_ = {};
+    const spatial::TwoLevelBvh& bvh = index_.bvh();
+    std::vector<char> isMoved(index_.occurrenceCount(), 0);
+    std::vector<InstanceId> instances;
+    for (NodeId n : moved) {
+        const InstanceId i = index_.instance(n);
+        if (i != geometry::kInvalidIndex && !isMoved[i]) {
+            isMoved[i] = 1;
+            instances.push_back(i);
+        }
+    }
+
+    // Results of unmoved pairs stay; pairs of two moved instances are
+    // found once, from the lower id.
+    clashes_.erase(std::remove_if(clashes_.begin(), clashes_.end(),
+                                  [&](const Clash& c) {
+                                      const InstanceId a = index_.instance(c.a);
+                                      const InstanceId b = index_.instance(c.b);
+                                      return a == geometry::kInvalidIndex || b == geometry::kInvalidIndex ||
+                                             isMoved[a] || isMoved[b];
+                                  }),
+                   clashes_.end());
+    std::vector<std::vector<Candidate>> found(instances.size());
+    core::parallelFor(0, instances.size(), 16, [&](std::size_t first, std::size_t last) {
+        for (std::size_t k = first; k < last; ++k) {
+            const InstanceId i = instances[k];
+            bvh.queryOverlap(bvh.worldBounds(i), [&](InstanceId j) {
+                if (j != i && (!isMoved[j] || i < j)) {
+                    found[k].emplace_back(std::min(i, j), std::max(i, j));
+                }
+                return true;
+            });
+        }
+    });
+    std::vector<Candidate> candidates;
+    for (const std::vector<Candidate>& f : found) {
+        candidates.insert(candidates.end(), f.begin(), f.end());
+    }
+    testPairs(index_, candidates, options_, clashes_, stats_);
+    sortClashes(clashes_);
+    return clashes_;
+}
+
+} // namespace rebel::assembly
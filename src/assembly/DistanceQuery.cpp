@@ -0,0 +1,481 @@
+#include "rebel/assembly/DistanceQuery.hpp"
+
+#include "rebel/core/TaskScheduler.hpp"
+#include "rebel/core/Trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+
+namespace rebel::assembly {
+
+namespace {
+
+using math::Vec3d;
+using spatial::BvhNode;
+using spatial::InstanceId;
+
+using Candidate = std::pair<InstanceId, InstanceId>;
+
+constexpr double kInfinity = std::numeric_limits<double>::infinity();
+
+/// Linear and translation part of a transform in double precision.
+struct Affine {
+    double m[3][4];
+
+    static Affine from(const math::Mat4f& f) {
+        Affine a;
+        for (int r = 0; r < 3; ++r) {
+            for (int c = 0; c < 4; ++c) {
+                a.m[r][c] = f(r, c);
+            }
+        }
+        return a;
+    }
+
+    Affine operator*(const Affine& o) const {
+        Affine a;
+        for (int r = 0; r < 3; ++r) {
+            for (int c = 0; c < 4; ++c) {
+                a.m[r][c] = m[r][0] * o.m[0][c] + m[r][1] * o.m[1][c] + m[r][2] * o.m[2][c] + (c == 3 ? m[r][3] : 0.0);
+            }
+        }
+        return a;
+    }
+
+    Vec3d apply(double x, double y, double z) const {
+        return {m[0][0] * x + m[0][1] * y + m[0][2] * z + m[0][3], m[1][0] * x + m[1][1] * y + m[1][2] * z + m[1][3],
+                m[2][0] * x + m[2][1] * y + m[2][2] * z + m[2][3]};
+    }
+};
+
+struct Box {
+    Vec3d lo;
+    Vec3d hi;
+};
+
+Box box(const math::Aabb& b) { return {Vec3d(b.min), Vec3d(b.max)}; }
+
+/// Box of `b` under `m` (Arvo), padded for the float rounding of the
+/// matrices it was made from.
+Box transformBox(const Affine& m, const math::Aabb& b) {
+    const Vec3d c = m.apply(0.5 * (double(b.min.x) + b.max.x), 0.5 * (double(b.min.y) + b.max.y),
+                            0.5 * (double(b.min.z) + b.max.z));
+    const Vec3d e = (Vec3d(b.max) - Vec3d(b.min)) * 0.5;
+    Vec3d r;
+    for (int row = 0; row < 3; ++row) {
+        r[row] = std::fabs(m.m[row][0]) * e.x + std::fabs(m.m[row][1]) * e.y + std::fabs(m.m[row][2]) * e.z;
+    }
+    const double pad = 1e-6 * (std::max({std::fabs(c.x), std::fabs(c.y), std::fabs(c.z)}) + std::max({r.x, r.y, r.z}));
+    r = r + Vec3d{pad, pad, pad};
+    return {c - r, c + r};
+}
+
+double gap(const Box& a, const Box& b) {
+    double squared = 0.0;
+    for (int axis = 0; axis < 3; ++axis) {
+        const double d = std::max({a.lo[axis] - b.hi[axis], b.lo[axis] - a.hi[axis], 0.0});
+        squared += d * d;
+    }
+    return std::sqrt(squared);
+}
+
+/// Least factor by which `m` shortens a vector: the smallest singular value
+/// of its linear part, from the eigenvalues of m^T m (Smith's closed form),
+/// rounded down a little. 1 for rigid motions.
+double minStretch(const math::Mat4f& f) {
+    double a[3][3];
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 3; ++c) {
+            a[r][c] = double(f(0, r)) * f(0, c) + double(f(1, r)) * f(1, c) + double(f(2, r)) * f(2, c);
+        }
+    }
+    const double off = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+    double smallest;
+    if (off == 0.0) {
+        smallest = std::min({a[0][0], a[1][1], a[2][2]});
+    } else {
+        const double q = (a[0][0] + a[1][1] + a[2][2]) / 3.0;
+        const double p2 =
+            (a[0][0] - q) * (a[0][0] - q) + (a[1][1] - q) * (a[1][1] - q) + (a[2][2] - q) * (a[2][2] - q) + 2.0 * off;
+        const double p = std::sqrt(p2 / 6.0);
+        double b[3][3];
+        for (int r = 0; r < 3; ++r) {
+            for (int c = 0; c < 3; ++c) {
+                b[r][c] = (a[r][c] - (r == c ? q : 0.0)) / p;
+            }
+        }
+        const double det = b[0][0] * (b[1][1] * b[2][2] - b[1][2] * b[2][1]) -
+                           b[0][1] * (b[1][0] * b[2][2] - b[1][2] * b[2][0]) +
+                           b[0][2] * (b[1][0] * b[2][1] - b[1][1] * b[2][0]);
+        const double phi = std::acos(std::clamp(det / 2.0, -1.0, 1.0)) / 3.0;
+        smallest = q + 2.0 * p * std::cos(phi + 2.0943951023931957);
+    }
+    return std::sqrt(std::max(smallest, 0.0)) * (1.0 - 1e-6);
+}
+
+struct WorldTriangle {
+    Vec3d v[3];
+    Box bounds;
+    std::uint32_t index;
+};
+
+WorldTriangle worldTriangle(const geometry::MeshView& mesh, const Affine& m, std::uint32_t triangle) {
+    WorldTriangle t;
+    for (int k = 0; k < 3; ++k) {
+        const geometry::VertexIndex i = mesh.corners[3 * static_cast<std::size_t>(triangle) + k];
+        t.v[k] = m.apply(mesh.px[i], mesh.py[i], mesh.pz[i]);
+    }
+    t.bounds = {math::min(t.v[0], math::min(t.v[1], t.v[2])), math::max(t.v[0], math::max(t.v[1], t.v[2]))};
+    t.index = triangle;
+    return t;
+}
+
+/// Nearest point of triangle `abc` to `p` (Ericson, Real-Time Collision
+/// Detection 5.1.5).
+Vec3d closestOnTriangle(const Vec3d& p, const Vec3d& a, const Vec3d& b, const Vec3d& c) {
+    const Vec3d ab = b - a;
+    const Vec3d ac = c - a;
+    const Vec3d ap = p - a;
+    const double d1 = math::dot(ab, ap);
+    const double d2 = math::dot(ac, ap);
+    if (d1 <= 0.0 && d2 <= 0.0) {
+        return a;
+    }
+    const Vec3d bp = p - b;
+    const double d3 = math::dot(ab, bp);
+    const double d4 = math::dot(ac, bp);
+    if (d3 >= 0.0 && d4 <= d3) {
+        return b;
+    }
+    const double vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0) {
+        return a + ab * (d1 / (d1 - d3));
+    }
+    const Vec3d cp = p - c;
+    const double d5 = math::dot(ab, cp);
+    const double d6 = math::dot(ac, cp);
+    if (d6 >= 0.0 && d5 <= d6) {
+        return c;
+    }
+    const double vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0) {
+        return a + ac * (d2 / (d2 - d6));
+    }
+    const double va = d3 * d6 - d5 * d4;
+    if (va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0) {
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    }
+    const double denom = 1.0 / (va + vb + vc);
+    return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+/// Nearest points of segments `p1 q1` and `p2 q2` (Ericson 5.1.9).
+void closestOnSegments(const Vec3d& p1, const Vec3d& q1, const Vec3d& p2, const Vec3d& q2, Vec3d& c1, Vec3d& c2) {
+    const Vec3d d1 = q1 - p1;
+    const Vec3d d2 = q2 - p2;
+    const Vec3d r = p1 - p2;
+    const double a = math::dot(d1, d1);
+    const double e = math::dot(d2, d2);
+    const double f = math::dot(d2, r);
+    double s = 0.0;
+    double t = 0.0;
+    if (a <= 0.0 && e <= 0.0) {
+        c1 = p1;
+        c2 = p2;
+        return;
+    }
+    if (a <= 0.0) {
+        t = std::clamp(f / e, 0.0, 1.0);
+    } else {
+        const double c = math::dot(d1, r);
+        if (e <= 0.0) {
+            s = std::clamp(-c / a, 0.0, 1.0);
+        } else {
+            const double b = math::dot(d1, d2);
+            const double denom = a * e - b * b;
+            s = denom > 0.0 ? std::clamp((b * f - c * e) / denom, 0.0, 1.0) : 0.0;
+            t = (b * s + f) / e;
+            if (t < 0.0) {
+                t = 0.0;
+                s = std::clamp(-c / a, 0.0, 1.0);
+            } else if (t > 1.0) {
+                t = 1.0;
+                s = std::clamp((b - c) / a, 0.0, 1.0);
+            }
+        }
+    }
+    c1 = p1 + d1 * s;
+    c2 = p2 + d2 * t;
+}
+
+/// Where segment `pq` passes through the interior of `tri`
+/// (Moller-Trumbore); false if it does not or lies in its plane.
+bool segmentCrossesTriangle(const Vec3d& p, const Vec3d& q, const WorldTriangle& tri, Vec3d& hit) {
+    const Vec3d d = q - p;
+    const Vec3d e1 = tri.v[1] - tri.v[0];
+    const Vec3d e2 = tri.v[2] - tri.v[0];
+    const Vec3d h = math::cross(d, e2);
+    const double det = math::dot(e1, h);
+    if (det == 0.0) {
+        return false;
+    }
+    const double inv = 1.0 / det;
+    const Vec3d s = p - tri.v[0];
+    const double u = math::dot(s, h) * inv;
+    if (u < 0.0 || u > 1.0) {
+        return false;
+    }
+    const Vec3d qv = math::cross(s, e1);
+    const double v = math::dot(d, qv) * inv;
+    if (v < 0.0 || u + v > 1.0) {
+        return false;
+    }
+    const double t = math::dot(e2, qv) * inv;
+    if (t < 0.0 || t > 1.0) {
+        return false;
+    }
+    hit = p + d * t;
+    return true;
+}
+
+/// Distance between two triangles and a pair of points realizing it. When
+/// they cross, an edge of one passes through the other and gives a common
+/// point; otherwise the minimum is between a vertex and a triangle or
+/// between two edges.
+double triangleDistance(const WorldTriangle& a, const WorldTriangle& b, Vec3d& pa, Vec3d& pb) {
+    if (gap(a.bounds, b.bounds) == 0.0) {
+        for (int k = 0; k < 3; ++k) {
+            if (segmentCrossesTriangle(a.v[k], a.v[(k + 1) % 3], b, pa) ||
+                segmentCrossesTriangle(b.v[k], b.v[(k + 1) % 3], a, pa)) {
+                pb = pa;
+                return 0.0;
+            }
+        }
+    }
+    double best = kInfinity;
+    auto consider = [&](const Vec3d& x, const Vec3d& y) {
+        const Vec3d d = x - y;
+        const double squared = math::dot(d, d);
+        if (squared < best) {
+            best = squared;
+            pa = x;
+            pb = y;
+        }
+    };
+    for (int k = 0; k < 3; ++k) {
+        consider(a.v[k], closestOnTriangle(a.v[k], b.v[0], b.v[1], b.v[2]));
+        consider(closestOnTriangle(b.v[k], a.v[0], a.v[1], a.v[2]), b.v[k]);
+    }
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            Vec3d ca;
+            Vec3d cb;
+            closestOnSegments(a.v[i], a.v[(i + 1) % 3], b.v[j], b.v[(j + 1) % 3], ca, cb);
+            consider(ca, cb);
+        }
+    }
+    return std::sqrt(best);
+}
+
+struct Counters {
+    std::size_t nodePairs = 0;
+    std::size_t trianglePairs = 0;
+};
+
+struct QueuedPair {
+    double bound;
+    std::uint32_t a;
+    std::uint32_t b;
+
+    /// Inverted for a min-heap on `bound`.
+    bool operator<(const QueuedPair& o) const { return bound > o.bound; }
+};
+
+/// Branch-and-bound search for one instance pair, with `limit` as the
+/// initial bound: found distances are below it, or the result is at
+/// infinity.
+DistanceResult measure(const AssemblyIndex& index, const Candidate& candidate, double limit,
+                       const DistanceOptions& options, Counters& counters) {
+    const spatial::TwoLevelBvh& bvh = index.bvh();
+    const auto [ia, ib] = candidate;
+    DistanceResult result;
+    result.a = index.node(ia);
+    result.b = index.node(ib);
+    const spatial::BvhView& ta = bvh.mesh(ia)->bvh();
+    const spatial::BvhView& tb = bvh.mesh(ib)->bvh();
+    if (ta.empty() || tb.empty()) {
+        return result;
+    }
+    const geometry::MeshView& ma = index.definition(ia).mesh();
+    const geometry::MeshView& mb = index.definition(ib).mesh();
+    const Affine worldA = Affine::from(bvh.transform(ia));
+    const Affine worldB = Affine::from(bvh.transform(ib));
+    const Affine bToA = Affine::from(bvh.inverseTransform(ia)) * worldB;
+    const double stretch = minStretch(bvh.transform(ia));
+
+    double best = limit;
+    // Nothing below `bound` can improve the result by the tolerance. The
+    // limit itself is exact: the tolerance only applies against a distance
+    // found, or pairs just under the limit would be lost.
+    auto settled = [&](double bound) {
+        if (result.triangleA == geometry::kInvalidIndex) {
+            return bound >= best;
+        }
+        return bound * (1.0 + options.relativeTolerance) + options.absoluteTolerance >= best;
+    };
+    auto bound = [&](std::uint32_t i, std::uint32_t j) {
+        return gap(box(ta.nodes[i].bounds), transformBox(bToA, tb.nodes[j].bounds)) * stretch;
+    };
+    std::vector<QueuedPair> queue;
+    auto push = [&](std::uint32_t i, std::uint32_t j) {
+        const double b = bound(i, j);
+        if (!settled(b)) {
+            queue.push_back({b, i, j});
+            std::push_heap(queue.begin(), queue.end());
+        }
+    };
+
+    std::vector<WorldTriangle> leafA;
+    push(0, 0);
+    while (!queue.empty() && best > 0.0) {
+        std::pop_heap(queue.begin(), queue.end());
+        const QueuedPair top = queue.back();
+        queue.pop_back();
+        if (settled(top.bound)) {
+            break;
+        }
+        ++counters.nodePairs;
+        const BvhNode& a = ta.nodes[top.a];
+        const BvhNode& b = tb.nodes[top.b];
+        if (a.isLeaf() && b.isLeaf()) {
+            leafA.clear();
+            for (std::uint32_t p = a.first; p < a.first + a.count; ++p) {
+                leafA.push_back(worldTriangle(ma, worldA, ta.primitives[p]));
+            }
+            for (std::uint32_t q = b.first; q < b.first + b.count && best > 0.0; ++q) {
+                const WorldTriangle wb = worldTriangle(mb, worldB, tb.primitives[q]);
+                for (const WorldTriangle& wa : leafA) {
+                    if (settled(gap(wa.bounds, wb.bounds))) {
+                        continue;
+                    }
+                    ++counters.trianglePairs;
+                    Vec3d pa;
+                    Vec3d pb;
+                    const double d = triangleDistance(wa, wb, pa, pb);
+                    if (d < best) {
+                        best = d;
+                        result.distance = d;
+                        result.pointA = pa;
+                        result.pointB = pb;
+                        result.triangleA = wa.index;
+                        result.triangleB = wb.index;
+                        if (d == 0.0) {
+                            break;
+                        }
+                    }
+                }
+            }
+        } else if (b.isLeaf() || (!a.isLeaf() && a.bounds.halfArea() >= b.bounds.halfArea())) {
+            push(a.first, top.b);
+            push(a.first + 1, top.b);
+        } else {
+            push(top.a, b.first);
+            push(top.a, b.first + 1);
+        }
+    }
+    if (result.b < result.a) {
+        std::swap(result.a, result.b);
+        std::swap(result.pointA, result.pointB);
+        std::swap(result.triangleA, result.triangleB);
+    }
+    return result;
+}
+
+std::vector<DistanceResult> measureAll(const AssemblyIndex& index, const std::vector<Candidate>& candidates,
+                                       double limit, const DistanceOptions& options, DistanceStats& stats) {
+    std::vector<DistanceResult> results(candidates.size());
+    std::atomic<std::size_t> nodePairs{0};
+    std::atomic<std::size_t> trianglePairs{0};
+    core::parallelFor(0, candidates.size(), 4, [&](std::size_t first, std::size_t last) {
+        Counters local;
+        for (std::size_t k = first; k < last; ++k) {
+            results[k] = measure(index, candidates[k], limit, options, local);
+        }
+        nodePairs.fetch_add(local.nodePairs, std::memory_order_relaxed);
+        trianglePairs.fetch_add(local.trianglePairs, std::memory_order_relaxed);
+    });
+    stats.pairs = candidates.size();
+    stats.nodePairs = nodePairs.load();
+    stats.trianglePairs = trianglePairs.load();
+    return results;
+}
+
+} // namespace
+
+DistanceQuery::DistanceQuery(const AssemblyIndex& index, DistanceOptions options) : index_(index), options_(options) {}
+
+DistanceResult DistanceQuery::distance(NodeId a, NodeId b) {
+    return distances({{a, b}}).front();
+}
+
+std::vector<DistanceResult> DistanceQuery::distances(const std::vector<std::pair<NodeId, NodeId>>& pairs) {
+    REBEL_TRACE_ZONE("distance.pairs");
+    std::vector<Candidate> candidates;
+    candidates.reserve(pairs.size());
+    for (const auto& [a, b] : pairs) {
+        const InstanceId ia = index_.instance(a);
+        const InstanceId ib = index_.instance(b);
+        if (ia == geometry::kInvalidIndex || ib == geometry::kInvalidIndex) {
+            throw std::invalid_argument("distance query on a node that is not an indexed occurrence");
+        }
+        candidates.emplace_back(ia, ib);
+    }
+    stats_ = {};
+    return measureAll(index_, candidates, options_.maxDistance, options_, stats_);
+}
+
+std::vector<DistanceResult> DistanceQuery::closerThan(double clearance) {
+    REBEL_TRACE_ZONE("distance.closer_than");
+    stats_ = {};
+    const spatial::TwoLevelBvh& bvh = index_.bvh();
+    const double limit = std::min(clearance, options_.maxDistance);
+    if (!(limit > 0.0)) {
+        return {};
+    }
+    // Boxes grown by the clearance, rounded outwards.
+    const float grow = static_cast<float>(limit) * (1.0f + 1e-6f);
+    std::vector<std::vector<Candidate>> found(index_.occurrenceCount());
+    core::parallelFor(0, index_.occurrenceCount(), 16, [&](std::size_t first, std::size_t last) {
+        for (std::size_t k = first; k < last; ++k) {
+            const auto i = static_cast<InstanceId>(k);
+            math::Aabb grown = bvh.worldBounds(i);
+            if (grown.empty()) {
+                continue;
+            }
+            grown.min = grown.min - math::Vec3f{grow, grow, grow};
+            grown.max = grown.max + math::Vec3f{grow, grow, grow};
+            bvh.queryOverlap(grown, [&](InstanceId j) {
+                if (i < j) {
+                    found[k].emplace_back(i, j);
+                }
+                return true;
+            });
+        }
+    });
+    std::vector<Candidate> candidates;
+    for (const std::vector<Candidate>& f : found) {
+        candidates.insert(candidates.end(), f.begin(), f.end());
+    }
+
+    std::vector<DistanceResult> results = measureAll(index_, candidates, limit, options_, stats_);
+    results.erase(std::remove_if(results.begin(), results.end(),
+                                 [&](const DistanceResult& r) { return !(r.distance < limit); }),
+                  results.end());
+    std::sort(results.begin(), results.end(),
+              [](const DistanceResult& x, const DistanceResult& y) { return x.a != y.a ? x.a < y.a : x.b < y.b; });
+    return results;
+}
+
+} // namespace rebel::assembly
@@ -0,0 +1,703 @@
+#include "rebel/assembly/MateSolver.hpp"
+
+#include "rebel/core/TaskScheduler.hpp"
+#include "rebel/core/Trace.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+namespace rebel::assembly {
+
+namespace {
+
+using math::Vec3d;
+
+constexpr Vec3d kAxes[3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+
+/// Rigid placement in double precision; `r` is row-major.
+struct Pose {
+    double r[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+    Vec3d t;
+
+    Vec3d rotate(const Vec3d& v) const {
+        return {r[0] * v.x + r[1] * v.y + r[2] * v.z, r[3] * v.x + r[4] * v.y + r[5] * v.z,
+                r[6] * v.x + r[7] * v.y + r[8] * v.z};
+    }
+    Vec3d apply(const Vec3d& v) const { return rotate(v) + t; }
+};
+
+Pose compose(const Pose& a, const Pose& b) {
+    Pose c;
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            c.r[3 * i + j] = a.r[3 * i] * b.r[j] + a.r[3 * i + 1] * b.r[3 + j] + a.r[3 * i + 2] * b.r[6 + j];
+        }
+    }
+    c.t = a.apply(b.t);
+    return c;
+}
+
+Pose inverse(const Pose& a) {
+    Pose b;
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            b.r[3 * i + j] = a.r[3 * j + i];
+        }
+    }
+    b.t = -b.rotate(a.t);
+    return b;
+}
+
+/// Re-orthonormalizes the rotation (Gram-Schmidt on its columns).
+void orthonormalize(Pose& p) {
+    Vec3d c0{p.r[0], p.r[3], p.r[6]};
+    Vec3d c1{p.r[1], p.r[4], p.r[7]};
+    c0 = math::normalize(c0);
+    c1 = math::normalize(c1 - c0 * math::dot(c0, c1));
+    const Vec3d c2 = math::cross(c0, c1);
+    const Vec3d columns[3] = {c0, c1, c2};
+    for (int j = 0; j < 3; ++j) {
+        p.r[j] = columns[j].x;
+        p.r[3 + j] = columns[j].y;
+        p.r[6 + j] = columns[j].z;
+    }
+}
+
+Pose fromMatrix(const math::Mat4f& m) {
+    Pose p;
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            p.r[3 * i + j] = m(i, j);
+        }
+    }
+    p.t = {m(0, 3), m(1, 3), m(2, 3)};
+    orthonormalize(p);
+    return p;
+}
+
+math::Mat4f toMatrix(const Pose& p) {
+    math::Mat4f m;
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            m(i, j) = static_cast<float>(p.r[3 * i + j]);
+        }
+    }
+    m(0, 3) = static_cast<float>(p.t.x);
+    m(1, 3) = static_cast<float>(p.t.y);
+    m(2, 3) = static_cast<float>(p.t.z);
+    return m;
+}
+
+/// Applies the step: rotation `w` (axis times angle, about the frame
+/// origin) and translation `d`.
+void step(Pose& p, const double* x) {
+    const Vec3d w{x[0], x[1], x[2]};
+    const double angle = math::length(w);
+    if (angle > 0.0) {
+        const Vec3d k = w * (1.0 / angle);
+        const double s = std::sin(angle);
+        const double c = 1.0 - std::cos(angle);
+        const double rot[9] = {1 - c * (k.y * k.y + k.z * k.z), -s * k.z + c * k.x * k.y, s * k.y + c * k.x * k.z,
+                               s * k.z + c * k.x * k.y,         1 - c * (k.x * k.x + k.z * k.z), -s * k.x + c * k.y * k.z,
+                               -s * k.y + c * k.x * k.z,        s * k.x + c * k.y * k.z,  1 - c * (k.x * k.x + k.y * k.y)};
+        double r[9];
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                r[3 * i + j] = rot[3 * i] * p.r[j] + rot[3 * i + 1] * p.r[3 + j] + rot[3 * i + 2] * p.r[6 + j];
+            }
+        }
+        std::copy(r, r + 9, p.r);
+    }
+    p.t += Vec3d{x[3], x[4], x[5]};
+}
+
+struct UnionFind {
+    explicit UnionFind(std::size_t n) : parent(n) { std::iota(parent.begin(), parent.end(), 0u); }
+
+    std::uint32_t find(std::uint32_t i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+    void unite(std::uint32_t a, std::uint32_t b) { parent[find(a)] = find(b); }
+
+    std::vector<std::uint32_t> parent;
+};
+
+/// A mate with its references expressed in the frames of the two clusters.
+struct Term {
+    MateType type;
+    std::uint32_t a;
+    std::uint32_t b;
+    Vec3d pa;
+    Vec3d da;
+    Vec3d pb;
+    Vec3d db;
+    double value;
+};
+
+/// One residual and its Jacobian: six columns (rotation, translation) for
+/// each of at most two free clusters.
+struct Row {
+    double r = 0.0;
+    int blockA = -1;
+    int blockB = -1;
+    double ja[6] = {};
+    double jb[6] = {};
+};
+
+struct Cluster {
+    Pose pose;
+    bool fixed = false;
+};
+
+void evaluate(const Term& term, const std::vector<Cluster>& clusters, const std::vector<int>& block,
+              std::vector<Row>& rows) {
+    const Pose& A = clusters[term.a].pose;
+    const Pose& B = clusters[term.b].pose;
+    const Vec3d qa = A.rotate(term.pa);
+    const Vec3d qb = B.rotate(term.pb);
+    const Vec3d Pa = qa + A.t;
+    const Vec3d Pb = qb + B.t;
+    const Vec3d Da = A.rotate(term.da);
+    const Vec3d Db = B.rotate(term.db);
+    const int ba = block[term.a];
+    const int bb = block[term.b];
+
+    // Gradients of the residual with respect to the world points and
+    // directions, pulled back to each cluster's (rotation, translation).
+    auto add = [&](double r, const Vec3d& gPa, const Vec3d& gDa, const Vec3d& gPb, const Vec3d& gDb) {
+        Row row;
+        row.r = r;
+        row.blockA = ba;
+        row.blockB = bb;
+        const Vec3d wa = math::cross(qa, gPa) + math::cross(Da, gDa);
+        const Vec3d wb = math::cross(qb, gPb) + math::cross(Db, gDb);
+        const double ja[6] = {wa.x, wa.y, wa.z, gPa.x, gPa.y, gPa.z};
+        const double jb[6] = {wb.x, wb.y, wb.z, gPb.x, gPb.y, gPb.z};
+        std::copy(ja, ja + 6, row.ja);
+        std::copy(jb, jb + 6, row.jb);
+        rows.push_back(row);
+    };
+    const Vec3d zero;
+    auto parallel = [&] {
+        const Vec3d c = math::cross(Da, Db);
+        for (int k = 0; k < 3; ++k) {
+            add(c[k], zero, math::cross(Db, kAxes[k]), zero, math::cross(kAxes[k], Da));
+        }
+    };
+
+    switch (term.type) {
+    case MateType::Coincident: {
+        const Vec3d w = Pa - Pb;
+        for (int k = 0; k < 3; ++k) {
+            add(w[k], kAxes[k], zero, -kAxes[k], zero);
+        }
+        break;
+    }
+    case MateType::Distance: {
+        const Vec3d w = Pa - Pb;
+        const double len = math::length(w);
+        const Vec3d u = len > 1e-12 ? w * (1.0 / len) : kAxes[0];
+        add(len - term.value, u, zero, -u, zero);
+        break;
+    }
+    case MateType::Parallel:
+        parallel();
+        break;
+    case MateType::Planar: {
+        parallel();
+        const Vec3d w = Pb - Pa;
+        add(math::dot(Da, w) - term.value, -Da, w, Da, zero);
+        break;
+    }
+    case MateType::Concentric: {
+        parallel();
+        const Vec3d w = Pb - Pa;
+        const double s = math::dot(Da, w);
+        for (int k = 0; k < 3; ++k) {
+            const Vec3d gw = kAxes[k] - Da * Da[k];
+            add(w[k] - Da[k] * s, -gw, -(kAxes[k] * s + w * Da[k]), gw, zero);
+        }
+        break;
+    }
+    case MateType::Lock:
+        break;
+    }
+}
+
+/// Cholesky factor of a symmetric 6x6 block, for the preconditioner.
+struct Block {
+    double l[36] = {};
+
+    void factor(const double* a) {
+        for (int i = 0; i < 6; ++i) {
+            for (int j = 0; j <= i; ++j) {
+                double s = a[6 * i + j];
+                for (int k = 0; k < j; ++k) {
+                    s -= l[6 * i + k] * l[6 * j + k];
+                }
+                l[6 * i + j] = i == j ? std::sqrt(std::max(s, 1e-300)) : s / l[6 * j + j];
+            }
+        }
+    }
+
+    void solve(const double* b, double* x) const {
+        double y[6];
+        for (int i = 0; i < 6; ++i) {
+            double s = b[i];
+            for (int k = 0; k < i; ++k) {
+                s -= l[6 * i + k] * y[k];
+            }
+            y[i] = s / l[6 * i + i];
+        }
+        for (int i = 5; i >= 0; --i) {
+            double s = y[i];
+            for (int k = i + 1; k < 6; ++k) {
+                s -= l[6 * k + i] * x[k];
+            }
+            x[i] = s / l[6 * i + i];
+        }
+    }
+};
+
+struct ComponentResult {
+    bool converged = false;
+    std::size_t iterations = 0;
+    double residual = 0.0;
+};
+
+double maxAbs(const std::vector<Row>& rows) {
+    double m = 0.0;
+    for (const Row& row : rows) {
+        m = std::max(m, std::fabs(row.r));
+    }
+    return m;
+}
+
+double sumSquares(const std::vector<Row>& rows) {
+    double s = 0.0;
+    for (const Row& row : rows) {
+        s += row.r * row.r;
+    }
+    return s;
+}
+
+/// Levenberg-Marquardt over one component. `free` lists its free clusters;
+/// `block` maps every cluster to its position in `free` (or -1), and is
+/// only read for this component's clusters.
+ComponentResult solveComponent(const std::vector<const Term*>& terms, const std::vector<std::uint32_t>& free,
+                               const std::vector<int>& block, std::vector<Cluster>& clusters,
+                               const MateSolveOptions& options) {
+    const std::size_t n = 6 * free.size();
+    const std::size_t maxCg =
+        std::min<std::size_t>(500, std::max<std::size_t>(12, static_cast<std::size_t>(options.linearIterationFactor * n)));
+    std::vector<Row> rows;
+    auto evaluateAll = [&] {
+        rows.clear();
+        for (const Term* term : terms) {
+            evaluate(*term, clusters, block, rows);
+        }
+    };
+
+    std::vector<double> gradient(n);
+    std::vector<double> diag(n);
+    std::vector<double> blocks(36 * free.size());
+    std::vector<Block> preconditioner(free.size());
+    std::vector<double> x(n), r(n), z(n), p(n), ap(n), jp;
+    std::vector<Pose> saved(free.size());
+
+    ComponentResult result;
+    double lambda = 1e-3;
+    evaluateAll();
+    double cost = sumSquares(rows);
+    for (std::uint32_t iteration = 0; iteration < options.maxIterations; ++iteration) {
+        result.iterations = iteration;
+        result.residual = maxAbs(rows);
+        if (result.residual <= options.tolerance) {
+            result.converged = true;
+            return result;
+        }
+
+        // Gradient J^T r and the diagonal blocks of J^T J.
+        std::fill(gradient.begin(), gradient.end(), 0.0);
+        std::fill(blocks.begin(), blocks.end(), 0.0);
+        for (const Row& row : rows) {
+            for (const auto& [b, j] : {std::pair{row.blockA, row.ja}, std::pair{row.blockB, row.jb}}) {
+                if (b < 0) {
+                    continue;
+                }
+                double* blk = &blocks[36 * static_cast<std::size_t>(b)];
+                for (int i = 0; i < 6; ++i) {
+                    gradient[6 * b + i] += j[i] * row.r;
+                    for (int k = 0; k < 6; ++k) {
+                        blk[6 * i + k] += j[i] * j[k];
+                    }
+                }
+            }
+        }
+        for (std::size_t b = 0; b < free.size(); ++b) {
+            for (int i = 0; i < 6; ++i) {
+                diag[6 * b + i] = blocks[36 * b + 7 * i];
+            }
+        }
+
+        // (J^T J + lambda diag(J^T J) + mu I) x = -g, retried with more
+        // damping until the cost drops.
+        bool accepted = false;
+        while (!accepted && lambda < 1e12) {
+            const double mu = 1e-12;
+            for (std::size_t b = 0; b < free.size(); ++b) {
+                double damped[36];
+                std::copy(&blocks[36 * b], &blocks[36 * b] + 36, damped);
+                for (int i = 0; i < 6; ++i) {
+                    damped[7 * i] += lambda * diag[6 * b + i] + mu;
+                }
+                preconditioner[b].factor(damped);
+            }
+            auto multiply = [&](const std::vector<double>& v, std::vector<double>& out) {
+                jp.resize(rows.size());
+                for (std::size_t k = 0; k < rows.size(); ++k) {
+                    const Row& row = rows[k];
+                    double s = 0.0;
+                    for (int i = 0; i < 6; ++i) {
+                        s += row.blockA >= 0 ? row.ja[i] * v[6 * row.blockA + i] : 0.0;
+                        s += row.blockB >= 0 ? row.jb[i] * v[6 * row.blockB + i] : 0.0;
+                    }
+                    jp[k] = s;
+                }
+                for (std::size_t i = 0; i < n; ++i) {
+                    out[i] = (lambda * diag[i] + mu) * v[i];
+                }
+                for (std::size_t k = 0; k < rows.size(); ++k) {
+                    const Row& row = rows[k];
+                    for (int i = 0; i < 6; ++i) {
+                        if (row.blockA >= 0) {
+                            out[6 * row.blockA + i] += row.ja[i] * jp[k];
+                        }
+                        if (row.blockB >= 0) {
+                            out[6 * row.blockB + i] += row.jb[i] * jp[k];
+                        }
+                    }
+                }
+            };
+            auto precondition = [&](const std::vector<double>& v, std::vector<double>& out) {
+                for (std::size_t b = 0; b < free.size(); ++b) {
+                    preconditioner[b].solve(&v[6 * b], &out[6 * b]);
+                }
+            };
+
+            // Preconditioned conjugate gradients from x = 0.
+            std::fill(x.begin(), x.end(), 0.0);
+            for (std::size_t i = 0; i < n; ++i) {
+                r[i] = -gradient[i];
+            }
+            precondition(r, z);
+            p = z;
+            double rz = std::inner_product(r.begin(), r.end(), z.begin(), 0.0);
+            const double stop = 1e-20 * std::inner_product(r.begin(), r.end(), r.begin(), 0.0);
+            for (std::size_t k = 0; k < maxCg && rz > 0.0; ++k) {
+                multiply(p, ap);
+                const double pap = std::inner_product(p.begin(), p.end(), ap.begin(), 0.0);
+                if (pap <= 0.0) {
+                    break;
+                }
+                const double alpha = rz / pap;
+                for (std::size_t i = 0; i < n; ++i) {
+                    x[i] += alpha * p[i];
+                    r[i] -= alpha * ap[i];
+                }
+                if (std::inner_product(r.begin(), r.end(), r.begin(), 0.0) <= stop) {
+                    break;
+                }
+                precondition(r, z);
+                const double next = std::inner_product(r.begin(), r.end(), z.begin(), 0.0);
+                const double beta = next / rz;
+                rz = next;
+                for (std::size_t i = 0; i < n; ++i) {
+                    p[i] = z[i] + beta * p[i];
+                }
+            }
+
+            for (std::size_t b = 0; b < free.size(); ++b) {
+                saved[b] = clusters[free[b]].pose;
+                step(clusters[free[b]].pose, &x[6 * b]);
+            }
+            evaluateAll();
+            const double trial = sumSquares(rows);
+            if (trial < cost) {
+                cost = trial;
+                lambda = std::max(lambda / 3.0, 1e-12);
+                accepted = true;
+            } else {
+                for (std::size_t b = 0; b < free.size(); ++b) {
+                    clusters[free[b]].pose = saved[b];
+                }
+                lambda *= 4.0;
+                evaluateAll();
+            }
+        }
+        for (std::uint32_t c : free) {
+            orthonormalize(clusters[c].pose);
+        }
+        if (!accepted) {
+            // No step decreases the cost: a local minimum of an
+            // inconsistent (over-constrained) set.
+            break;
+        }
+    }
+    evaluateAll();
+    result.residual = maxAbs(rows);
+    result.converged = result.residual <= options.tolerance;
+    return result;
+}
+
+} // namespace
+
+MateSolver::MateSolver(Assembly& assembly) : assembly_(assembly) {}
+
+MateId MateSolver::addMate(const Mate& mate) {
+    const auto unknown = [&](NodeId n) { return n >= assembly_.nodeCount(); };
+    if (unknown(mate.a.node) || unknown(mate.b.node)) {
+        throw std::invalid_argument("mate references an unknown node");
+    }
+    if (mate.a.node == mate.b.node) {
+        throw std::invalid_argument("mate of node " + std::to_string(mate.a.node) + " with itself");
+    }
+    Mate m = mate;
+    const bool usesDirections = m.type == MateType::Parallel || m.type == MateType::Planar ||
+                                m.type == MateType::Concentric;
+    for (MateReference* ref : {&m.a, &m.b}) {
+        const double len = math::length(ref->direction);
+        if (usesDirections && !(len > 0.0)) {
+            throw std::invalid_argument("mate direction must not be zero");
+        }
+        ref->direction = len > 0.0 ? ref->direction * (1.0 / len) : Vec3d{0, 0, 1};
+    }
+    const auto id = static_cast<MateId>(mates_.size());
+    mates_.push_back(m);
+    active_.push_back(1);
+    ++mateCount_;
+    return id;
+}
+
+void MateSolver::removeMate(MateId id) {
+    if (id >= mates_.size() || !active_[id]) {
+        throw std::out_of_range("unknown mate " + std::to_string(id));
+    }
+    active_[id] = 0;
+    --mateCount_;
+}
+
+const Mate& MateSolver::mate(MateId id) const {
+    if (id >= mates_.size() || !active_[id]) {
+        throw std::out_of_range("unknown mate " + std::to_string(id));
+    }
+    return mates_[id];
+}
+
+void MateSolver::setFixed(NodeId node, bool fixed) {
+    if (fixed) {
+        fixed_.insert(node);
+    } else {
+        fixed_.erase(node);
+    }
+}
+
+MateSolveResult MateSolver::solve(const MateSolveOptions& options) {
+    return run(kInvalidNode, math::Mat4f::identity(), options);
+}
+
+MateSolveResult MateSolver::drag(NodeId node, const math::Mat4f& world, const MateSolveOptions& options) {
+    if (node >= assembly_.nodeCount()) {
+        throw std::invalid_argument("cannot drag unknown node " + std::to_string(node));
+    }
+    return run(node, world, options);
+}
+
+MateSolveResult MateSolver::run(NodeId dragged, const math::Mat4f& target, const MateSolveOptions& options) {
+    REBEL_TRACE_ZONE("mate.solve");
+    // Bodies: every node a mate, the fixed set or the drag refers to.
+    std::vector<NodeId> bodies;
+    std::unordered_map<NodeId, std::uint32_t> bodyOf;
+    auto body = [&](NodeId n) {
+        const auto [it, added] = bodyOf.emplace(n, static_cast<std::uint32_t>(bodies.size()));
+        if (added) {
+            bodies.push_back(n);
+        }
+        return it->second;
+    };
+    for (std::size_t i = 0; i < mates_.size(); ++i) {
+        if (active_[i]) {
+            body(mates_[i].a.node);
+            body(mates_[i].b.node);
+        }
+    }
+    if (dragged != kInvalidNode) {
+        body(dragged);
+    }
+    std::vector<Pose> poses(bodies.size());
+    for (std::size_t i = 0; i < bodies.size(); ++i) {
+        const math::Mat4f world = assembly_.worldTransform(bodies[i]);
+        const auto cached = poses_.find(bodies[i]);
+        if (cached != poses_.end() && cached->second.written == world) {
+            std::copy(cached->second.rotation, cached->second.rotation + 9, poses[i].r);
+            poses[i].t = cached->second.translation;
+        } else {
+            poses[i] = fromMatrix(world);
+        }
+    }
+
+    // Rigid clusters from locks; a cluster's frame is its first body's.
+    UnionFind locks(bodies.size());
+    for (std::size_t i = 0; i < mates_.size(); ++i) {
+        if (active_[i] && mates_[i].type == MateType::Lock) {
+            locks.unite(bodyOf[mates_[i].a.node], bodyOf[mates_[i].b.node]);
+        }
+    }
+    std::vector<std::uint32_t> clusterOf(bodies.size());
+    std::vector<std::int64_t> clusterOfRoot(bodies.size(), -1);
+    std::vector<Cluster> clusters;
+    std::vector<Pose> offsets(bodies.size());
+    for (std::uint32_t i = 0; i < bodies.size(); ++i) {
+        const std::uint32_t root = locks.find(i);
+        if (clusterOfRoot[root] < 0) {
+            clusterOfRoot[root] = static_cast<std::int64_t>(clusters.size());
+            clusters.push_back({poses[i], false});
+        }
+        clusterOf[i] = static_cast<std::uint32_t>(clusterOfRoot[root]);
+        Cluster& c = clusters[clusterOf[i]];
+        offsets[i] = compose(inverse(c.pose), poses[i]);
+        c.fixed = c.fixed || fixed_.count(bodies[i]) != 0;
+    }
+    std::int64_t draggedCluster = -1;
+    if (dragged != kInvalidNode) {
+        const std::uint32_t b = bodyOf[dragged];
+        Cluster& c = clusters[clusterOf[b]];
+        if (!c.fixed) {
+            c.pose = compose(fromMatrix(target), inverse(offsets[b]));
+            c.fixed = true;
+            draggedCluster = clusterOf[b];
+        }
+    }
+
+    // Terms between distinct clusters, and components of the free ones.
+    std::vector<Term> terms;
+    UnionFind components(clusters.size());
+    for (std::size_t i = 0; i < mates_.size(); ++i) {
+        const Mate& m = mates_[i];
+        if (!active_[i] || m.type == MateType::Lock) {
+            continue;
+        }
+        const std::uint32_t ba = bodyOf[m.a.node];
+        const std::uint32_t bb = bodyOf[m.b.node];
+        Term t{m.type, clusterOf[ba], clusterOf[bb],
+               offsets[ba].apply(m.a.point), offsets[ba].rotate(m.a.direction),
+               offsets[bb].apply(m.b.point), offsets[bb].rotate(m.b.direction), m.value};
+        if (t.a == t.b || (clusters[t.a].fixed && clusters[t.b].fixed)) {
+            continue;
+        }
+        if (!clusters[t.a].fixed && !clusters[t.b].fixed) {
+            components.unite(t.a, t.b);
+        }
+        terms.push_back(t);
+    }
+
+    // A drag only re-solves the components touching the dragged cluster.
+    std::vector<char> wanted(clusters.size(), dragged == kInvalidNode ? 1 : 0);
+    if (draggedCluster >= 0) {
+        for (const Term& t : terms) {
+            if (t.a == draggedCluster && !clusters[t.b].fixed) {
+                wanted[components.find(t.b)] = 1;
+            } else if (t.b == draggedCluster && !clusters[t.a].fixed) {
+                wanted[components.find(t.a)] = 1;
+            }
+        }
+    }
+
+    struct Component {
+        std::vector<std::uint32_t> free;
+        std::vector<const Term*> terms;
+        ComponentResult result;
+    };
+    std::vector<Component> work;
+    std::vector<std::int64_t> workOf(clusters.size(), -1);
+    std::vector<int> block(clusters.size(), -1);
+    for (std::uint32_t c = 0; c < clusters.size(); ++c) {
+        const std::uint32_t root = components.find(c);
+        if (clusters[c].fixed || !wanted[root]) {
+            continue;
+        }
+        if (workOf[root] < 0) {
+            workOf[root] = static_cast<std::int64_t>(work.size());
+            work.emplace_back();
+        }
+        Component& w = work[workOf[root]];
+        block[c] = static_cast<int>(w.free.size());
+        w.free.push_back(c);
+    }
+    for (const Term& t : terms) {
+        const std::uint32_t free = clusters[t.a].fixed ? t.b : t.a;
+        const std::int64_t w = workOf[components.find(free)];
+        if (w >= 0) {
+            work[w].terms.push_back(&t);
+        }
+    }
+
+    core::parallelFor(0, work.size(), 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            REBEL_TRACE_ZONE("mate.component");
+            work[i].result = solveComponent(work[i].terms, work[i].free, block, clusters, options);
+        }
+    });
+
+    MateSolveResult result;
+    result.components = work.size();
+    std::vector<char> moved(clusters.size(), 0);
+    for (const Component& w : work) {
+        result.clusters += w.free.size();
+        result.converged = result.converged && w.result.converged;
+        result.iterations = std::max(result.iterations, w.result.iterations);
+        result.residual = std::max(result.residual, w.result.residual);
+        for (std::uint32_t c : w.free) {
+            moved[c] = 1;
+        }
+    }
+    if (draggedCluster >= 0) {
+        moved[draggedCluster] = 1;
+    }
+
+    // Write back parents before children, in case one body is an ancestor
+    // of another.
+    std::vector<std::pair<std::size_t, std::uint32_t>> order;
+    for (std::uint32_t i = 0; i < bodies.size(); ++i) {
+        if (moved[clusterOf[i]]) {
+            std::size_t depth = 0;
+            for (NodeId n = bodies[i]; n != kInvalidNode; n = assembly_.node(n).parent) {
+                ++depth;
+            }
+            order.emplace_back(depth, i);
+        }
+    }
+    std::sort(order.begin(), order.end());
+    for (const auto& [depth, i] : order) {
+        const Pose pose = compose(clusters[clusterOf[i]].pose, offsets[i]);
+        const NodeId node = bodies[i];
+        const NodeId parent = assembly_.node(node).parent;
+        const math::Mat4f world = toMatrix(pose);
+        assembly_.setLocalTransform(node, parent == kInvalidNode ? world
+                                                                 : assembly_.worldTransform(parent).inverse() * world);
+        CachedPose& cached = poses_[node];
+        std::copy(pose.r, pose.r + 9, cached.rotation);
+        cached.translation = pose.t;
+        cached.written = assembly_.worldTransform(node);
+    }
+    return result;
+}
+
+} // namespace rebel::assembly
@@ -0,0 +1,39 @@
+#include "rebel/assembly/Part.hpp"
+
+#include <utility>
+
+namespace rebel::assembly {
+
+std::shared_ptr<const Part> Part::create(std::string name, geometry::Mesh mesh) {
+    auto owned = std::make_shared<const geometry::Mesh>(std::move(mesh));
+    const geometry::MeshView view = owned->view();
+    const std::size_t bytes = owned->memoryBytes();
+    spatial::MeshBvh bvh = spatial::MeshBvh::build(view);
+    return std::shared_ptr<const Part>(new Part(std::move(name), view, std::move(bvh), std::move(owned), bytes));
+}
+
+std::shared_ptr<const Part> Part::create(std::string name, const geometry::MeshView& mesh,
+                                         std::shared_ptr<const void> storage) {
+    return std::shared_ptr<const Part>(
+        new Part(std::move(name), mesh, spatial::MeshBvh::build(mesh), std::move(storage), 0));
+}
+
+std::shared_ptr<const Part> Part::create(std::string name, const geometry::MeshView& mesh, spatial::MeshBvh bvh,
+                                         std::shared_ptr<const void> storage) {
+    return std::shared_ptr<const Part>(new Part(std::move(name), mesh, std::move(bvh), std::move(storage), 0));
+}
+
+Part::Part(std::string name, const geometry::MeshView& mesh, spatial::MeshBvh bvh,
+           std::shared_ptr<const void> storage, std::size_t storageBytes)
+    : name_(std::move(name)),
+      mesh_(mesh),
+      storage_(std::move(storage)),
+      storageBytes_(storageBytes),
+      bvh_(std::move(bvh)),
+      bounds_(mesh.bounds()) {}
+
+std::size_t Part::memoryBytes() const {
+    return storageBytes_ + bvh_.memoryBytes();
+}
+
+} // namespace rebel::assembly
@@ -0,0 +1,72 @@
+#include "rebel/assembly/PartLibrary.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+
+namespace rebel::assembly {
+
+PartId PartLibrary::add(PartPtr part) {
+    std::unique_lock lock(mutex_);
+    const auto it = byName_.find(part->name());
+    if (it != byName_.end()) {
+        return it->second;
+    }
+    const auto id = static_cast<PartId>(parts_.size());
+    byName_.emplace(part->name(), id);
+    parts_.push_back(std::move(part));
+    return id;
+}
+
+void PartLibrary::replace(PartId id, PartPtr part) {
+    std::unique_lock lock(mutex_);
+    if (id >= parts_.size()) {
+        throw std::out_of_range("unknown part id " + std::to_string(id));
+    }
+    if (part->name() != parts_[id]->name()) {
+        throw std::invalid_argument("replacement for part " + parts_[id]->name() + " is named " + part->name());
+    }
+    parts_[id] = std::move(part);
+    replaced_.push_back(id);
+}
+
+std::uint64_t PartLibrary::revision() const {
+    std::shared_lock lock(mutex_);
+    return replaced_.size();
+}
+
+void PartLibrary::replacedSince(std::uint64_t revision, std::vector<PartId>& out) const {
+    std::shared_lock lock(mutex_);
+    const auto first = static_cast<std::size_t>(std::min<std::uint64_t>(revision, replaced_.size()));
+    out.insert(out.end(), replaced_.begin() + static_cast<std::ptrdiff_t>(first), replaced_.end());
+}
+
+PartId PartLibrary::find(const std::string& name) const {
+    std::shared_lock lock(mutex_);
+    const auto it = byName_.find(name);
+    return it == byName_.end() ? kInvalidPart : it->second;
+}
+
+PartPtr PartLibrary::get(PartId id) const {
+    std::shared_lock lock(mutex_);
+    if (id >= parts_.size()) {
+        throw std::out_of_range("unknown part id " + std::to_string(id));
+    }
+    return parts_[id];
+}
+
+std::size_t PartLibrary::size() const {
+    std::shared_lock lock(mutex_);
+    return parts_.size();
+}
+
+std::size_t PartLibrary::memoryBytes() const {
+    std::shared_lock lock(mutex_);
+    std::size_t bytes = 0;
+    for (const PartPtr& part : parts_) {
+        bytes += part->memoryBytes();
+    }
+    return bytes;
+}
+
+} // namespace rebel::assembly
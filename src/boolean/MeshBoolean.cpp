@@ -0,0 +1,1481 @@
+#include "rebel/boolean/MeshBoolean.hpp"
+
+#include "rebel/core/Arena.hpp"
+#include "rebel/core/TaskScheduler.hpp"
+#include "rebel/core/Trace.hpp"
+#include "rebel/math/Predicates.hpp"
+#include "rebel/spatial/Bvh.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace rebel::boolean {
+
+using math::Aabb;
+using math::Vec2d;
+using math::Vec3d;
+using math::Vec3f;
+
+namespace {
+
+constexpr std::uint32_t kNone = 0xFFFFFFFFu;
+/// Triangles per task for the pair search and the retriangulation.
+constexpr std::size_t kGrain = 512;
+/// Triangles per BVH primitive in the pair search.
+constexpr std::size_t kClusterSize = 8;
+
+using Triangle = std::array<std::uint32_t, 3>;
+
+template <typename T>
+using Scratch = core::ArenaVector<T>;
+
+/// Arenas for the transient buffers of booleans run from this thread: one
+/// operation's own in the calling thread's arena, each retriangulated face
+/// in its worker's. Kept per calling thread, so repeated operations reuse
+/// the blocks and no two callers share a set.
+core::ArenaSet& scratchArenas() {
+    thread_local core::ArenaSet arenas;
+    return arenas;
+}
+
+int signOf(double v) { return (v > 0.0) - (v < 0.0); }
+
+// Perturbation. The second mesh is first moved by a real offset in a
+// generic direction, a few hundred times below float resolution but far
+// above double rounding, which pulls apart coplanar faces and edges running
+// through each other while every intersection point stays distinct in
+// double. Any determinant that is still exactly zero then takes the sign of
+// its first nonzero derivative along a further infinitesimal motion
+// e * (1, e, e^2); those derivatives are evaluated as 2D orientations of
+// input coordinates.
+
+/// Sign of n . (1, e, e^2) for the normal n = (b - a) x (c - a).
+int normalSign(const Vec3d& a, const Vec3d& b, const Vec3d& c) {
+    int s = signOf(math::orient2d({a.y, a.z}, {b.y, b.z}, {c.y, c.z}));
+    if (s == 0) {
+        s = signOf(math::orient2d({a.z, a.x}, {b.z, b.x}, {c.z, c.x}));
+    }
+    if (s == 0) {
+        s = signOf(math::orient2d({a.x, a.y}, {b.x, b.y}, {c.x, c.y}));
+    }
+    return s;
+}
+
+/// Perturbed sign of orient3d(a, b, c, d): positive when d is behind the
+/// plane of abc, i.e. opposite its normal. `triangleMoved` is true when abc
+/// belongs to the second mesh (and d to the first), false the other way.
+int planeSide(const Vec3d& a, const Vec3d& b, const Vec3d& c, const Vec3d& d, bool triangleMoved) {
+    const int s = signOf(math::orient3d(a, b, c, d));
+    if (s != 0) {
+        return s;
+    }
+    const int n = normalSign(a, b, c);
+    return triangleMoved ? n : -n;
+}
+
+/// Perturbed sign of orient3d(p, q, a, b) for an edge pq of one mesh and
+/// an edge ab of the other; `edgeMoved` is true when pq is the second
+/// mesh's.
+int edgeSide(const Vec3d& p, const Vec3d& q, const Vec3d& a, const Vec3d& b, bool edgeMoved) {
+    const int s = signOf(math::orient3d(p, q, a, b));
+    if (s != 0) {
+        return s;
+    }
+    // Derivative along the motion: (1, e, e^2) . ((q - p) x (a - b)).
+    const Vec3d u = q - p;
+    const Vec3d w = a - b;
+    const Vec2d o{0.0, 0.0};
+    int d = signOf(math::orient2d(o, {u.y, u.z}, {w.y, w.z}));
+    if (d == 0) {
+        d = signOf(math::orient2d(o, {u.z, u.x}, {w.z, w.x}));
+    }
+    if (d == 0) {
+        d = signOf(math::orient2d(o, {u.x, u.y}, {w.x, w.y}));
+    }
+    return edgeMoved ? d : -d;
+}
+
+bool edgeCrossesTriangle(const Vec3d& p, const Vec3d& q, const Vec3d& a, const Vec3d& b, const Vec3d& c,
+                         bool edgeMoved) {
+    const int sp = planeSide(a, b, c, p, !edgeMoved);
+    if (sp == 0 || sp == planeSide(a, b, c, q, !edgeMoved)) {
+        return false;
+    }
+    const int e = edgeSide(p, q, a, b, edgeMoved);
+    return e != 0 && edgeSide(p, q, b, c, edgeMoved) == e && edgeSide(p, q, c, a, edgeMoved) == e;
+}
+
+/// One operand, welded: its float positions, their double copies (moved
+/// by the offset for the second operand) and its non-degenerate triangles.
+struct Solid {
+    Scratch<Vec3f> positions;
+    Scratch<Vec3d> points;
+    Scratch<Triangle> triangles;
+    Scratch<Aabb> boxes;
+    Aabb bounds;
+    /// Triangle across edge k of triangle t at 3t + k.
+    Scratch<std::uint32_t> neighbors;
+    /// Triangles in Morton order; cluster c is `order[c * kClusterSize, ...)`.
+    Scratch<std::uint32_t> order;
+    Scratch<Aabb> clusters;
+    /// Id of its first point among all output vertex ids.
+    std::uint32_t base = 0;
+    /// The second operand, the one the perturbation moves.
+    bool moved = false;
+
+    explicit Solid(core::MonotonicArena& arena)
+        : positions(core::ArenaAllocator<Vec3f>(arena)), points(core::ArenaAllocator<Vec3d>(arena)),
+          triangles(core::ArenaAllocator<Triangle>(arena)), boxes(core::ArenaAllocator<Aabb>(arena)),
+          neighbors(core::ArenaAllocator<std::uint32_t>(arena)), order(core::ArenaAllocator<std::uint32_t>(arena)),
+          clusters(core::ArenaAllocator<Aabb>(arena)) {}
+};
+
+/// Nearest floats below and above a double.
+float floatBelow(double v) {
+    const float f = static_cast<float>(v);
+    return static_cast<double>(f) > v ? std::nextafter(f, -std::numeric_limits<float>::infinity()) : f;
+}
+
+float floatAbove(double v) {
+    const float f = static_cast<float>(v);
+    return static_cast<double>(f) < v ? std::nextafter(f, std::numeric_limits<float>::infinity()) : f;
+}
+
+/// Open-addressing table of distinct float positions, for welding.
+class PositionTable {
+public:
+    PositionTable(std::size_t capacity, core::MonotonicArena& arena)
+        : slots_(core::ArenaAllocator<std::uint32_t>(arena)) {
+        std::size_t size = 16;
+        while (size < 2 * capacity) {
+            size *= 2;
+        }
+        slots_.assign(size, kNone);
+    }
+
+    /// Index of `p` in `positions`; appended first if it is new.
+    std::uint32_t insert(const Vec3f& p, Scratch<Vec3f>& positions) {
+        const std::size_t mask = slots_.size() - 1;
+        for (std::size_t slot = hash(p) & mask;; slot = (slot + 1) & mask) {
+            if (slots_[slot] == kNone) {
+                slots_[slot] = static_cast<std::uint32_t>(positions.size());
+                positions.push_back(p);
+                return slots_[slot];
+            }
+            if (positions[slots_[slot]] == p) {
+                return slots_[slot];
+            }
+        }
+    }
+
+private:
+    static std::uint64_t hash(const Vec3f& p) {
+        std::uint64_t h = 0;
+        for (float c : {p.x, p.y, p.z}) {
+            std::uint32_t bits = 0;
+            if (c != 0.0f) { // -0 and +0 weld
+                std::memcpy(&bits, &c, sizeof bits);
+            }
+            h = (h ^ bits) * 0x9E3779B97F4A7C15ull;
+        }
+        return h ^ (h >> 29);
+    }
+
+    Scratch<std::uint32_t> slots_;
+};
+
+/// Open-addressing map from directed edges (two vertices packed into 64
+/// bits) to triangles, with linear probing and backward-shift deletion.
+class EdgeTable {
+public:
+    /// Sized for `edges` entries without growing.
+    EdgeTable(core::MonotonicArena& arena, std::size_t edges)
+        : keys_(core::ArenaAllocator<std::uint64_t>(arena)), values_(core::ArenaAllocator<std::uint32_t>(arena)) {
+        std::size_t size = 16;
+        while (size < 2 * edges) {
+            size *= 2;
+        }
+        keys_.assign(size, kEmpty);
+        values_.resize(size);
+    }
+
+    std::uint32_t find(std::uint64_t key) const {
+        const std::size_t mask = keys_.size() - 1;
+        for (std::size_t slot = hash(key) & mask;; slot = (slot + 1) & mask) {
+            if (keys_[slot] == key) {
+                return values_[slot];
+            }
+            if (keys_[slot] == kEmpty) {
+                return kNone;
+            }
+        }
+    }
+
+    void assign(std::uint64_t key, std::uint32_t value) {
+        if (2 * (size_ + 1) > keys_.size()) {
+            grow();
+        }
+        const std::size_t mask = keys_.size() - 1;
+        std::size_t slot = hash(key) & mask;
+        while (keys_[slot] != kEmpty && keys_[slot] != key) {
+            slot = (slot + 1) & mask;
+        }
+        size_ += keys_[slot] == kEmpty;
+        keys_[slot] = key;
+        values_[slot] = value;
+    }
+
+    /// Removes `key` if it maps to `value`.
+    void erase(std::uint64_t key, std::uint32_t value) {
+        const std::size_t mask = keys_.size() - 1;
+        std::size_t slot = hash(key) & mask;
+        while (keys_[slot] != key) {
+            if (keys_[slot] == kEmpty) {
+                return;
+            }
+            slot = (slot + 1) & mask;
+        }
+        if (values_[slot] != value) {
+            return;
+        }
+        // Pull later entries of the probe run back over the hole.
+        for (std::size_t next = (slot + 1) & mask; keys_[next] != kEmpty; next = (next + 1) & mask) {
+            const std::size_t home = hash(keys_[next]) & mask;
+            if (((next - home) & mask) >= ((next - slot) & mask)) {
+                keys_[slot] = keys_[next];
+                values_[slot] = values_[next];
+                slot = next;
+            }
+        }
+        keys_[slot] = kEmpty;
+        --size_;
+    }
+
+private:
+    static constexpr std::uint64_t kEmpty = ~std::uint64_t(0);
+
+    static std::uint64_t hash(std::uint64_t key) {
+        key *= 0x9E3779B97F4A7C15ull;
+        return key ^ (key >> 32);
+    }
+
+    void grow() {
+        Scratch<std::uint64_t> keys(2 * keys_.size(), kEmpty, keys_.get_allocator());
+        Scratch<std::uint32_t> values(keys.size(), values_.get_allocator());
+        keys.swap(keys_);
+        values.swap(values_);
+        size_ = 0;
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            if (keys[i] != kEmpty) {
+                assign(keys[i], values[i]);
+            }
+        }
+    }
+
+    Scratch<std::uint64_t> keys_;
+    Scratch<std::uint32_t> values_;
+    std::size_t size_ = 0;
+};
+
+/// Welds `mesh` into a solid in `arena`.
+Solid weld(const geometry::MeshView& mesh, const Vec3d& offset, bool moved, core::MonotonicArena& arena) {
+    const core::ArenaAllocator<char> scratch(arena);
+    Solid solid(arena);
+    solid.moved = moved;
+    Scratch<std::uint32_t> remap(mesh.vertexCount, scratch);
+    PositionTable table(mesh.vertexCount, arena);
+    for (std::size_t i = 0; i < mesh.vertexCount; ++i) {
+        remap[i] = table.insert(mesh.position(static_cast<geometry::VertexIndex>(i)), solid.positions);
+    }
+    solid.points.resize(solid.positions.size());
+    for (std::size_t i = 0; i < solid.points.size(); ++i) {
+        solid.points[i] = Vec3d(solid.positions[i]) + offset;
+    }
+
+    for (std::size_t t = 0; t < mesh.triangleCount; ++t) {
+        const Triangle tri{remap[mesh.corners[3 * t]], remap[mesh.corners[3 * t + 1]],
+                           remap[mesh.corners[3 * t + 2]]};
+        if (tri[0] == tri[1] || tri[1] == tri[2] || tri[2] == tri[0]) {
+            continue;
+        }
+        solid.triangles.push_back(tri);
+        const Vec3d lo = math::min(math::min(solid.points[tri[0]], solid.points[tri[1]]), solid.points[tri[2]]);
+        const Vec3d hi = math::max(math::max(solid.points[tri[0]], solid.points[tri[1]]), solid.points[tri[2]]);
+        solid.boxes.push_back({{floatBelow(lo.x), floatBelow(lo.y), floatBelow(lo.z)},
+                               {floatAbove(hi.x), floatAbove(hi.y), floatAbove(hi.z)}});
+        solid.bounds.expand(solid.boxes.back());
+    }
+
+    // Outgoing edges per vertex; closed means every directed edge is used
+    // exactly once and so is its reverse, whose triangle is the neighbour.
+    const std::size_t n = solid.triangles.size();
+    Scratch<std::uint32_t> offsets(solid.points.size() + 1, 0, scratch);
+    for (const Triangle& tri : solid.triangles) {
+        for (std::uint32_t v : tri) {
+            ++offsets[v + 1];
+        }
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    Scratch<std::uint32_t> outgoing(3 * n, scratch);
+    Scratch<std::uint32_t> fill(offsets.begin(), offsets.end() - 1, scratch);
+    for (std::uint32_t c = 0; c < 3 * n; ++c) {
+        outgoing[fill[solid.triangles[c / 3][c % 3]]++] = c;
+    }
+    const auto target = [&](std::uint32_t c) { return solid.triangles[c / 3][(c % 3 + 1) % 3]; };
+    solid.neighbors.resize(3 * n);
+    for (std::uint32_t c = 0; c < 3 * n; ++c) {
+        const std::uint32_t u = solid.triangles[c / 3][c % 3];
+        const std::uint32_t v = target(c);
+        std::uint32_t reverse = 0;
+        std::uint32_t same = 0;
+        for (std::uint32_t i = offsets[v]; i < offsets[v + 1]; ++i) {
+            if (target(outgoing[i]) == u) {
+                solid.neighbors[c] = outgoing[i] / 3;
+                ++reverse;
+            }
+        }
+        for (std::uint32_t i = offsets[u]; i < offsets[u + 1]; ++i) {
+            same += target(outgoing[i]) == v;
+        }
+        if (reverse != 1 || same != 1) {
+            throw std::invalid_argument("meshBoolean: input mesh is not closed");
+        }
+    }
+
+    // Clusters of consecutive triangles along a Morton curve, the unit of
+    // the pair search.
+    Scratch<std::uint64_t> keys(n, scratch);
+    const Vec3f lo = solid.bounds.min;
+    const Vec3f extent = solid.bounds.extent();
+    for (std::uint32_t t = 0; t < n; ++t) {
+        const Vec3f c = solid.boxes[t].center();
+        std::uint64_t code = 0;
+        for (int k = 0; k < 3; ++k) {
+            const float f = extent[k] > 0.0f ? (c[k] - lo[k]) / extent[k] : 0.0f;
+            std::uint64_t q = static_cast<std::uint64_t>(std::clamp(f, 0.0f, 1.0f) * 1023.0f);
+            q = (q | q << 16) & 0x030000FFull;
+            q = (q | q << 8) & 0x0300F00Full;
+            q = (q | q << 4) & 0x030C30C3ull;
+            q = (q | q << 2) & 0x09249249ull;
+            code |= q << k;
+        }
+        keys[t] = code << 32 | t;
+    }
+    std::sort(keys.begin(), keys.end());
+    solid.order.resize(n);
+    for (std::uint32_t i = 0; i < n; ++i) {
+        solid.order[i] = static_cast<std::uint32_t>(keys[i]);
+    }
+    for (std::size_t first = 0; first < n; first += kClusterSize) {
+        Aabb box;
+        for (std::size_t i = first; i < std::min(n, first + kClusterSize); ++i) {
+            box.expand(solid.boxes[solid.order[i]]);
+        }
+        solid.clusters.push_back(box);
+    }
+    return solid;
+}
+
+/// Crossing of an edge of one mesh with a triangle of the other.
+struct Event {
+    /// Mesh the edge belongs to, 0 or 1, its welded ends (v0 < v1) and the
+    /// other mesh's triangle.
+    std::uint32_t mesh = 0;
+    std::uint32_t v0 = 0;
+    std::uint32_t v1 = 0;
+    std::uint32_t triangle = 0;
+
+    bool operator<(const Event& o) const {
+        return std::tie(mesh, v0, v1, triangle) < std::tie(o.mesh, o.v0, o.v1, o.triangle);
+    }
+    bool operator==(const Event& o) const {
+        return mesh == o.mesh && v0 == o.v0 && v1 == o.v1 && triangle == o.triangle;
+    }
+};
+
+/// Crossing triangle pair; its intersection segment runs between the two
+/// events.
+struct Hit {
+    std::uint32_t a = 0;
+    std::uint32_t b = 0;
+    Event events[2];
+};
+
+/// Tests pair (ta, tb); in general position two triangles cross in a
+/// segment whose ends are exactly two edge-triangle crossings.
+bool crossPair(const Solid& a, std::uint32_t ta, const Solid& b, std::uint32_t tb, Event out[2]) {
+    int count = 0;
+    const auto edges = [&](const Solid& x, std::uint32_t tx, const Solid& y, std::uint32_t ty,
+                           std::uint32_t mesh) {
+        const Triangle& e = x.triangles[tx];
+        const Triangle& f = y.triangles[ty];
+        for (int k = 0; k < 3; ++k) {
+            const std::uint32_t u = e[k];
+            const std::uint32_t v = e[(k + 1) % 3];
+            if (edgeCrossesTriangle(x.points[u], x.points[v], y.points[f[0]], y.points[f[1]], y.points[f[2]],
+                                    x.moved)) {
+                if (count < 2) {
+                    out[count] = {mesh, std::min(u, v), std::max(u, v), ty};
+                }
+                ++count;
+            }
+        }
+    };
+    edges(a, ta, b, tb, 0);
+    edges(b, tb, a, ta, 1);
+    return count == 2;
+}
+
+/// Intersection segment on a triangle: its end vertex ids and the other
+/// mesh's triangle that cuts it there.
+struct Cut {
+    std::uint32_t triangle = 0;
+    std::uint32_t u = 0;
+    std::uint32_t v = 0;
+    std::uint32_t generator = 0;
+};
+
+/// Output triangle of one mesh over global vertex ids.
+struct Face {
+    Triangle v{};
+    /// Bit k set when edge v[k] -> v[k + 1] lies on an intersection curve.
+    std::uint8_t cutEdges = 0;
+    /// +1 inside / -1 outside the other mesh as seen from an adjacent cut,
+    /// 0 without one; `weight` ranks votes (infinite when exact).
+    std::int8_t vote = 0;
+    double weight = 0.0;
+};
+
+/// All vertex positions by global id: first mesh, second mesh, events.
+struct Points {
+    const Solid& a;
+    const Solid& b;
+    const Scratch<Vec3d>& events;
+    std::uint32_t eventBase = 0;
+
+    const Scratch<Vec3f>& eventPositions;
+
+    const Vec3d& operator()(std::uint32_t id) const {
+        if (id < b.base) {
+            return a.points[id];
+        }
+        return id < eventBase ? b.points[id - b.base] : events[id - eventBase];
+    }
+
+    /// Output position: input positions as they were, intersection points
+    /// moved back and snapped.
+    const Vec3f& output(std::uint32_t id) const {
+        if (id < b.base) {
+            return a.positions[id];
+        }
+        return id < eventBase ? b.positions[id - b.base] : eventPositions[id - eventBase];
+    }
+};
+
+/// Triangulation of one input triangle in 2D, refined by the cut points
+/// with Delaunay flips, then with every cut recovered as an edge. All of
+/// its state lives in `arena`.
+class Retriangulator {
+public:
+    Scratch<Vec2d> points;
+    Scratch<std::uint32_t> ids;
+    Scratch<Triangle> triangles;
+    /// Recovered cut edges (local vertices) and the triangle cutting there.
+    Scratch<std::array<std::uint32_t, 3>> constraints;
+
+    /// Sized for `vertices` points, so the buffers rarely grow.
+    Retriangulator(core::MonotonicArena& arena, std::size_t vertices)
+        : points(core::ArenaAllocator<Vec2d>(arena)), ids(core::ArenaAllocator<std::uint32_t>(arena)),
+          triangles(core::ArenaAllocator<Triangle>(arena)),
+          constraints(core::ArenaAllocator<std::array<std::uint32_t, 3>>(arena)), arena_(arena),
+          edges_(arena, 6 * vertices), corner_(core::ArenaAllocator<std::uint32_t>(arena)),
+          stack_(core::ArenaAllocator<std::pair<std::uint32_t, std::uint32_t>>(arena)) {
+        points.reserve(vertices);
+        ids.reserve(vertices);
+        corner_.reserve(vertices);
+        triangles.reserve(2 * vertices);
+    }
+
+    std::uint32_t addPoint(const Vec2d& p, std::uint32_t id) {
+        points.push_back(p);
+        ids.push_back(id);
+        corner_.push_back(kNone);
+        return static_cast<std::uint32_t>(points.size() - 1);
+    }
+
+    void addTriangle(const Triangle& t) {
+        triangles.push_back(t);
+        link(static_cast<std::uint32_t>(triangles.size() - 1));
+    }
+
+    double orient(std::uint32_t a, std::uint32_t b, std::uint32_t c) const {
+        return math::orient2d(points[a], points[b], points[c]);
+    }
+
+    /// Triangle holding the directed edge a -> b, rotated so it starts
+    /// with a, or kNone.
+    std::uint32_t findEdge(std::uint32_t a, std::uint32_t b) {
+        const std::uint32_t i = edges_.find(key(a, b));
+        if (i != kNone) {
+            rotateTo(i, a);
+        }
+        return i;
+    }
+
+    /// Splits edge a -> b (and its twin, if any) at new vertex p.
+    void splitEdge(std::uint32_t a, std::uint32_t b, std::uint32_t p) {
+        const std::uint32_t t1 = findEdge(a, b);
+        if (t1 == kNone) {
+            return;
+        }
+        const std::uint32_t c = triangles[t1][2];
+        const std::uint32_t t2 = findEdge(b, a);
+        const std::uint32_t d = t2 == kNone ? kNone : triangles[t2][2];
+        set(t1, {a, p, c});
+        addTriangle({p, b, c});
+        if (t2 != kNone) {
+            set(t2, {b, p, d});
+            addTriangle({p, a, d});
+        }
+        hint_ = t1;
+        legalize(p, c, a);
+        legalize(p, b, c);
+        if (t2 != kNone) {
+            legalize(p, d, b);
+            legalize(p, a, d);
+        }
+    }
+
+    /// Inserts p where it falls; returns the vertex to use for it (an
+    /// existing one if p coincides with it).
+    std::uint32_t insert(std::uint32_t p) {
+        const auto [best, outside] = locate(p);
+        const Triangle t = triangles[best];
+        const double o[3] = {orient(t[0], t[1], p), orient(t[1], t[2], p), orient(t[2], t[0], p)};
+        if (outside < 0) {
+            for (int k = 0; k < 3; ++k) {
+                if (o[k] == 0.0 && o[(k + 2) % 3] == 0.0) {
+                    return t[k];
+                }
+            }
+        }
+        const int k = outside >= 0 ? outside : static_cast<int>(std::min_element(o, o + 3) - o);
+        if (o[k] <= 0.0) {
+            // On an edge, or just outside the triangulation after rounding.
+            splitEdge(t[k], t[(k + 1) % 3], p);
+            return p;
+        }
+        set(best, {t[0], t[1], p});
+        addTriangle({t[1], t[2], p});
+        addTriangle({t[2], t[0], p});
+        hint_ = best;
+        legalize(p, t[0], t[1]);
+        legalize(p, t[1], t[2]);
+        legalize(p, t[2], t[0]);
+        return p;
+    }
+
+    /// Lawson flips outward from p, starting at edge a -> b opposite it.
+    void legalize(std::uint32_t p, std::uint32_t a, std::uint32_t b) {
+        stack_.assign(1, {a, b});
+        while (!stack_.empty()) {
+            const auto [x, y] = stack_.back();
+            stack_.pop_back();
+            const std::uint32_t t1 = findEdge(x, y);
+            if (t1 == kNone || triangles[t1][2] != p) {
+                continue;
+            }
+            const std::uint32_t t2 = findEdge(y, x);
+            if (t2 == kNone) {
+                continue;
+            }
+            const std::uint32_t d = triangles[t2][2];
+            if (math::incircle(points[x], points[y], points[p], points[d]) > 0.0 && orient(x, d, p) > 0.0 &&
+                orient(d, y, p) > 0.0) {
+                set(t1, {x, d, p});
+                set(t2, {d, y, p});
+                stack_.push_back({x, d});
+                stack_.push_back({d, y});
+            }
+        }
+    }
+
+    /// Makes u - v an edge (the triangles it crosses are removed and the
+    /// two sides ear-clipped) and records it as a cut.
+    void recover(std::uint32_t u, std::uint32_t v, std::uint32_t generator) {
+        if (u == v) {
+            return;
+        }
+        if (findEdge(u, v) != kNone || findEdge(v, u) != kNone) {
+            constraints.push_back({u, v, generator});
+            return;
+        }
+        // The triangle around u that the segment leaves through, found by
+        // turning counter-clockwise, then clockwise if u is on the boundary.
+        const Vec2d d = points[v] - points[u];
+        const auto ahead = [&](std::uint32_t r) {
+            const Vec2d e = points[r] - points[u];
+            return orient(u, v, r) == 0.0 && e.x * d.x + e.y * d.y > 0.0;
+        };
+        std::uint32_t start = corner_[u] == kNone ? kNone : findEdge(u, corner_[u]);
+        if (start == kNone) {
+            start = scanFor(u);
+            if (start == kNone) {
+                return;
+            }
+        }
+        std::uint32_t wedge = kNone;
+        for (int turn = 0; turn < 2 && wedge == kNone; ++turn) {
+            std::uint32_t at = start;
+            for (std::size_t steps = 0; steps <= triangles.size(); ++steps) {
+                rotateTo(at, u);
+                const std::uint32_t b = triangles[at][1];
+                const std::uint32_t c = triangles[at][2];
+                for (std::uint32_t r : {b, c}) {
+                    if (ahead(r)) {
+                        // A vertex on the segment splits it in two.
+                        recover(u, r, generator);
+                        recover(r, v, generator);
+                        return;
+                    }
+                }
+                if (orient(u, b, v) > 0.0 && orient(u, c, v) < 0.0) {
+                    wedge = at;
+                    break;
+                }
+                at = turn == 0 ? findEdge(u, c) : findEdge(b, u);
+                if (at == kNone || at == start) {
+                    break;
+                }
+            }
+            if (at == start) {
+                break;
+            }
+        }
+        if (wedge == kNone) {
+            return;
+        }
+
+        // Walk across the triangles the segment crosses.
+        auto removed = scratch<std::uint32_t>();
+        removed.push_back(wedge);
+        std::uint32_t right = triangles[wedge][1];
+        std::uint32_t left = triangles[wedge][2];
+        std::uint32_t end = v;
+        for (std::size_t steps = 0;; ++steps) {
+            const std::uint32_t next = findEdge(left, right);
+            if (next == kNone || steps > triangles.size()) {
+                return;
+            }
+            removed.push_back(next);
+            const std::uint32_t apex = triangles[next][2];
+            if (apex == v) {
+                break;
+            }
+            const double side = orient(u, v, apex);
+            if (side == 0.0) {
+                end = apex;
+                break;
+            }
+            (side > 0.0 ? left : right) = apex;
+        }
+
+        auto boundary = scratch<std::pair<std::uint32_t, std::uint32_t>>();
+        for (std::uint32_t i : removed) {
+            for (int k = 0; k < 3; ++k) {
+                boundary.push_back({triangles[i][k], triangles[i][(k + 1) % 3]});
+            }
+        }
+        std::sort(boundary.begin(), boundary.end());
+        auto outline = scratch<std::pair<std::uint32_t, std::uint32_t>>();
+        for (const auto& e : boundary) {
+            if (!std::binary_search(boundary.begin(), boundary.end(), std::make_pair(e.second, e.first))) {
+                outline.push_back(e);
+            }
+        }
+        const auto walk = [&](std::uint32_t from, std::uint32_t to, Scratch<std::uint32_t>& chain) {
+            chain.push_back(from);
+            for (std::size_t steps = 0; chain.back() != to; ++steps) {
+                const auto next = std::lower_bound(outline.begin(), outline.end(),
+                                                   std::make_pair(chain.back(), std::uint32_t(0)));
+                if (steps > outline.size() || next == outline.end() || next->first != chain.back()) {
+                    return false;
+                }
+                chain.push_back(next->second);
+            }
+            return true;
+        };
+        auto leftChain = scratch<std::uint32_t>();
+        auto rightChain = scratch<std::uint32_t>();
+        if (!walk(u, end, leftChain) || !walk(end, u, rightChain)) {
+            return;
+        }
+        std::sort(removed.begin(), removed.end(), std::greater<>());
+        for (std::uint32_t i : removed) {
+            remove(i);
+        }
+        earClip(leftChain);
+        earClip(rightChain);
+        constraints.push_back({u, end, generator});
+        if (end != v) {
+            recover(end, v, generator);
+        }
+    }
+
+private:
+    static std::uint64_t key(std::uint32_t a, std::uint32_t b) { return std::uint64_t(a) << 32 | b; }
+
+    template <typename T>
+    Scratch<T> scratch() const {
+        return Scratch<T>(core::ArenaAllocator<T>(arena_));
+    }
+
+    void link(std::uint32_t i) {
+        const Triangle& t = triangles[i];
+        for (int k = 0; k < 3; ++k) {
+            edges_.assign(key(t[k], t[(k + 1) % 3]), i);
+            corner_[t[k]] = t[(k + 1) % 3];
+        }
+    }
+
+    void unlink(std::uint32_t i) {
+        const Triangle& t = triangles[i];
+        for (int k = 0; k < 3; ++k) {
+            // A flip's other triangle may have claimed the edge already.
+            edges_.erase(key(t[k], t[(k + 1) % 3]), i);
+        }
+    }
+
+    void set(std::uint32_t i, const Triangle& t) {
+        unlink(i);
+        triangles[i] = t;
+        link(i);
+    }
+
+    /// Removes triangle i, moving the last one into its slot.
+    void remove(std::uint32_t i) {
+        unlink(i);
+        const auto last = static_cast<std::uint32_t>(triangles.size() - 1);
+        if (i != last) {
+            unlink(last);
+            triangles[i] = triangles[last];
+            link(i);
+        }
+        triangles.pop_back();
+    }
+
+    void rotateTo(std::uint32_t i, std::uint32_t a) {
+        Triangle& t = triangles[i];
+        while (t[0] != a) {
+            std::rotate(t.begin(), t.begin() + 1, t.end());
+        }
+    }
+
+    std::uint32_t scanFor(std::uint32_t a) const {
+        for (std::size_t i = 0; i < triangles.size(); ++i) {
+            const Triangle& t = triangles[i];
+            if (t[0] == a || t[1] == a || t[2] == a) {
+                return static_cast<std::uint32_t>(i);
+            }
+        }
+        return kNone;
+    }
+
+    /// Triangle holding p by a stochastic visibility walk from the last
+    /// insertion, and the edge p is outside of if the walk left the
+    /// triangulation there (-1 if it is inside). Cut points come in curve
+    /// order, so the walk is short.
+    std::pair<std::uint32_t, int> locate(std::uint32_t p) {
+        std::uint32_t at = hint_ < triangles.size() ? hint_ : 0;
+        for (std::size_t steps = 0; steps <= 4 * triangles.size(); ++steps) {
+            const Triangle& t = triangles[at];
+            seed_ ^= seed_ << 13;
+            seed_ ^= seed_ >> 17;
+            seed_ ^= seed_ << 5;
+            const int first = static_cast<int>(seed_ % 3);
+            int outside = -1;
+            for (int j = 0; j < 3 && outside < 0; ++j) {
+                const int k = (first + j) % 3;
+                if (orient(t[k], t[(k + 1) % 3], p) < 0.0) {
+                    outside = k;
+                }
+            }
+            if (outside < 0) {
+                return {at, -1};
+            }
+            const std::uint32_t twin = edges_.find(key(t[(outside + 1) % 3], t[outside]));
+            if (twin == kNone) {
+                return {at, outside};
+            }
+            at = twin;
+        }
+        // Only a broken triangulation gets here; fall back to the triangle
+        // p is least outside of.
+        std::uint32_t best = 0;
+        double bestMin = -std::numeric_limits<double>::infinity();
+        for (std::size_t i = 0; i < triangles.size(); ++i) {
+            const Triangle& t = triangles[i];
+            const double m = std::min({orient(t[0], t[1], p), orient(t[1], t[2], p), orient(t[2], t[0], p)});
+            if (m > bestMin) {
+                bestMin = m;
+                best = static_cast<std::uint32_t>(i);
+            }
+        }
+        return {best, -1};
+    }
+
+    /// Triangulates a counter-clockwise polygon, preferring fat ears.
+    void earClip(Scratch<std::uint32_t>& polygon) {
+        while (polygon.size() > 3) {
+            const std::size_t n = polygon.size();
+            std::size_t best = n;
+            double bestScore = -std::numeric_limits<double>::infinity();
+            std::size_t fallback = 0;
+            double fallbackArea = -std::numeric_limits<double>::infinity();
+            for (std::size_t i = 0; i < n; ++i) {
+                const std::uint32_t a = polygon[(i + n - 1) % n];
+                const std::uint32_t b = polygon[i];
+                const std::uint32_t c = polygon[(i + 1) % n];
+                const double area = orient(a, b, c);
+                if (area > fallbackArea) {
+                    fallbackArea = area;
+                    fallback = i;
+                }
+                if (area <= 0.0) {
+                    continue;
+                }
+                bool empty = true;
+                for (std::uint32_t r : polygon) {
+                    if (r != a && r != b && r != c && orient(a, b, r) >= 0.0 && orient(b, c, r) >= 0.0 &&
+                        orient(c, a, r) >= 0.0) {
+                        empty = false;
+                        break;
+                    }
+                }
+                if (!empty) {
+                    continue;
+                }
+                const Vec2d ab = points[b] - points[a];
+                const Vec2d bc = points[c] - points[b];
+                const Vec2d ca = points[a] - points[c];
+                const double score =
+                    area / (ab.x * ab.x + ab.y * ab.y + bc.x * bc.x + bc.y * bc.y + ca.x * ca.x + ca.y * ca.y);
+                if (score > bestScore) {
+                    bestScore = score;
+                    best = i;
+                }
+            }
+            const std::size_t i = best < n ? best : fallback;
+            addTriangle({polygon[(i + n - 1) % n], polygon[i], polygon[(i + 1) % n]});
+            polygon.erase(polygon.begin() + static_cast<std::ptrdiff_t>(i));
+        }
+        if (polygon.size() == 3) {
+            addTriangle({polygon[0], polygon[1], polygon[2]});
+        }
+    }
+
+    core::MonotonicArena& arena_;
+    EdgeTable edges_;
+    /// Per vertex: the far end of some edge out of it.
+    Scratch<std::uint32_t> corner_;
+    Scratch<std::pair<std::uint32_t, std::uint32_t>> stack_;
+    std::uint32_t hint_ = 0;
+    std::uint32_t seed_ = 0x9E3779B9u;
+};
+
+/// Cuts triangle `t` of `x` along `cuts` (all on it) and appends the
+/// pieces, each voting inside/outside `y` when it borders a cut. Scratch
+/// comes from `arena` and is released on return.
+void cutTriangle(const Solid& x, std::uint32_t t, std::uint32_t mesh, const Cut* cuts, std::size_t cutCount,
+                 const Solid& y, const Scratch<Event>& events, const Points& points, core::MonotonicArena& arena,
+                 std::vector<Face>& out) {
+    const Triangle& tri = x.triangles[t];
+    const Vec3d corners[3] = {x.points[tri[0]], x.points[tri[1]], x.points[tri[2]]};
+    const Vec3d n = math::cross(corners[1] - corners[0], corners[2] - corners[0]);
+    const int axis = std::fabs(n.x) >= std::fabs(n.y) && std::fabs(n.x) >= std::fabs(n.z) ? 0
+                     : std::fabs(n.y) >= std::fabs(n.z)                                  ? 1
+                                                                                         : 2;
+    // Drop the dominant axis, keeping the triangle counter-clockwise.
+    const int i0 = (axis + 1) % 3;
+    const int i1 = (axis + 2) % 3;
+    bool swap = false;
+    const auto project = [&](const Vec3d& p) { return swap ? Vec2d{p[i1], p[i0]} : Vec2d{p[i0], p[i1]}; };
+    double o = math::orient2d(project(corners[0]), project(corners[1]), project(corners[2]));
+    if (o < 0.0) {
+        swap = true;
+        o = -o;
+    }
+    if (o == 0.0) {
+        out.push_back({{tri[0] + x.base, tri[1] + x.base, tri[2] + x.base}});
+        return;
+    }
+
+    const core::ArenaScope scope(arena);
+    const core::ArenaAllocator<char> scratch(arena);
+
+    // Cut points: on one of the triangle's edges when the event is one of
+    // its own edges crossing the other mesh, inside it otherwise.
+    Scratch<std::uint32_t> cutPoints(scratch);
+    cutPoints.reserve(2 * cutCount);
+    for (std::size_t i = 0; i < cutCount; ++i) {
+        cutPoints.push_back(cuts[i].u);
+        cutPoints.push_back(cuts[i].v);
+    }
+    std::sort(cutPoints.begin(), cutPoints.end());
+    cutPoints.erase(std::unique(cutPoints.begin(), cutPoints.end()), cutPoints.end());
+
+    Retriangulator r(arena, 3 + cutPoints.size());
+    for (int k = 0; k < 3; ++k) {
+        r.addPoint(project(corners[k]), tri[k] + x.base);
+    }
+    r.addTriangle({0, 1, 2});
+    using EdgePoint = std::pair<double, std::uint32_t>;
+    Scratch<EdgePoint> onEdge[3] = {Scratch<EdgePoint>(scratch), Scratch<EdgePoint>(scratch),
+                                    Scratch<EdgePoint>(scratch)};
+    Scratch<std::uint32_t> inside(scratch);
+    for (std::uint32_t id : cutPoints) {
+        const Event& e = events[id - points.eventBase];
+        if (e.mesh != mesh) {
+            inside.push_back(id);
+            continue;
+        }
+        for (int k = 0; k < 3; ++k) {
+            const std::uint32_t s = tri[k];
+            const std::uint32_t f = tri[(k + 1) % 3];
+            if (std::min(s, f) == e.v0 && std::max(s, f) == e.v1) {
+                const Vec3d along = corners[(k + 1) % 3] - corners[k];
+                onEdge[k].push_back({math::dot(points(id) - corners[k], along), id});
+                break;
+            }
+        }
+    }
+    Scratch<std::pair<std::uint32_t, std::uint32_t>> local(scratch);
+    for (int k = 0; k < 3; ++k) {
+        std::sort(onEdge[k].begin(), onEdge[k].end());
+        std::uint32_t previous = static_cast<std::uint32_t>(k);
+        for (const auto& [param, id] : onEdge[k]) {
+            const std::uint32_t p = r.addPoint(project(points(id)), id);
+            r.splitEdge(previous, static_cast<std::uint32_t>((k + 1) % 3), p);
+            local.push_back({id, p});
+            previous = p;
+        }
+    }
+    // Interior points go in a biased randomized order: in rounds of about
+    // doubling size (picked by hashing the id), each along a Morton curve
+    // over the triangle. That keeps point-location walks short without the
+    // long flip cascades a plain curve order causes.
+    const Vec2d lo{std::min({r.points[0].x, r.points[1].x, r.points[2].x}),
+                   std::min({r.points[0].y, r.points[1].y, r.points[2].y})};
+    const Vec2d extent = Vec2d{std::max({r.points[0].x, r.points[1].x, r.points[2].x}),
+                               std::max({r.points[0].y, r.points[1].y, r.points[2].y})} -
+                         lo;
+    Scratch<std::pair<std::uint64_t, std::uint32_t>> order(scratch);
+    for (std::uint32_t id : inside) {
+        const Vec2d p = project(points(id));
+        std::uint64_t code = 0;
+        for (int k = 0; k < 2; ++k) {
+            const double f = ((k == 0 ? p.x - lo.x : p.y - lo.y) / (k == 0 ? extent.x : extent.y));
+            std::uint64_t q = static_cast<std::uint64_t>(std::clamp(f, 0.0, 1.0) * 65535.0);
+            q = (q | q << 8) & 0x00FF00FFu;
+            q = (q | q << 4) & 0x0F0F0F0Fu;
+            q = (q | q << 2) & 0x33333333u;
+            q = (q | q << 1) & 0x55555555u;
+            code |= q << k;
+        }
+        std::uint64_t h = (id + 1) * 0x9E3779B97F4A7C15ull;
+        h ^= h >> 31;
+        std::uint64_t round = 31;
+        for (; round > 0 && (h & 1) != 0; h >>= 1) {
+            --round;
+        }
+        order.push_back({round << 32 | code, id});
+    }
+    std::sort(order.begin(), order.end());
+    for (const auto& [code, id] : order) {
+        const std::uint32_t p = r.addPoint(project(points(id)), id);
+        local.push_back({id, r.insert(p)});
+    }
+    std::sort(local.begin(), local.end());
+    const auto localOf = [&](std::uint32_t id) {
+        return std::lower_bound(local.begin(), local.end(), std::make_pair(id, std::uint32_t(0)))->second;
+    };
+    for (std::size_t i = 0; i < cutCount; ++i) {
+        r.recover(localOf(cuts[i].u), localOf(cuts[i].v), cuts[i].generator);
+    }
+
+    const std::size_t first = out.size();
+    for (const Triangle& lt : r.triangles) {
+        out.push_back({{r.ids[lt[0]], r.ids[lt[1]], r.ids[lt[2]]}});
+    }
+    // The piece on either side of a cut lies on one side of the cutting
+    // triangle's plane; its apex tells which. Own input vertices decide
+    // exactly (with the perturbation); cut points only as far as they are
+    // away from that plane.
+    for (const auto& [u, v, generator] : r.constraints) {
+        const Triangle& g = y.triangles[generator];
+        const Vec3d& ga = y.points[g[0]];
+        const Vec3d& gb = y.points[g[1]];
+        const Vec3d& gc = y.points[g[2]];
+        const double area = math::length(math::cross(gb - ga, gc - ga));
+        for (int side = 0; side < 2; ++side) {
+            const std::uint32_t from = side == 0 ? u : v;
+            const std::uint32_t to = side == 0 ? v : u;
+            const std::uint32_t lt = r.findEdge(from, to);
+            if (lt == kNone) {
+                continue;
+            }
+            Face& face = out[first + lt];
+            for (int k = 0; k < 3; ++k) {
+                if (face.v[k] == r.ids[from] && face.v[(k + 1) % 3] == r.ids[to]) {
+                    face.cutEdges |= static_cast<std::uint8_t>(1u << k);
+                }
+            }
+            const std::uint32_t apex = r.ids[r.triangles[lt][2]];
+            int vote = 0;
+            double weight = 0.0;
+            if (apex >= x.base && apex < x.base + x.points.size()) {
+                vote = planeSide(ga, gb, gc, points(apex), y.moved);
+                weight = std::numeric_limits<double>::infinity();
+            } else if (area > 0.0) {
+                const double s = math::orient3d(ga, gb, gc, points(apex));
+                vote = signOf(s);
+                weight = std::fabs(s) / area;
+            }
+            if (vote != 0 && weight > face.weight) {
+                face.vote = static_cast<std::int8_t>(vote);
+                face.weight = weight;
+            }
+        }
+    }
+}
+
+/// Generalized winding number of `y` around `p`: 1 inside, 0 outside.
+double windingNumber(const Solid& y, const Vec3d& p) {
+    if (!y.bounds.contains(Vec3f(p))) {
+        return 0.0;
+    }
+    double total = 0.0;
+    for (const Triangle& t : y.triangles) {
+        const Vec3d a = y.points[t[0]] - p;
+        const Vec3d b = y.points[t[1]] - p;
+        const Vec3d c = y.points[t[2]] - p;
+        const double la = math::length(a);
+        const double lb = math::length(b);
+        const double lc = math::length(c);
+        const double det = math::dot(a, math::cross(b, c));
+        const double div = la * lb * lc + math::dot(a, b) * lc + math::dot(b, c) * la + math::dot(c, a) * lb;
+        total += 2.0 * std::atan2(det, div);
+    }
+    return total / (4.0 * 3.14159265358979323846);
+}
+
+struct UnionFind {
+    Scratch<std::uint32_t> parent;
+
+    UnionFind(std::size_t n, core::MonotonicArena& arena) : parent(n, core::ArenaAllocator<std::uint32_t>(arena)) {
+        std::iota(parent.begin(), parent.end(), 0u);
+    }
+
+    std::uint32_t find(std::uint32_t i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+
+    void unite(std::uint32_t i, std::uint32_t j) {
+        i = find(i);
+        j = find(j);
+        if (i != j) {
+            parent[std::max(i, j)] = std::min(i, j);
+        }
+    }
+};
+
+/// Output faces of one mesh: face t is input triangle t unless that was
+/// cut, in which case `cut[t]` is set and its pieces come after the first
+/// `cut.size()` faces.
+struct Surface {
+    Scratch<Face> faces;
+    Scratch<char> cut;
+    std::size_t split = 0;
+
+    explicit Surface(core::MonotonicArena& arena)
+        : faces(core::ArenaAllocator<Face>(arena)), cut(core::ArenaAllocator<char>(arena)) {}
+
+    bool removed(std::size_t f) const { return f < cut.size() && cut[f]; }
+};
+
+/// Cuts every triangle of `x` that `cuts` (sorted by triangle) touch, each
+/// on its own task. The surface goes in the operation's `arena`, the
+/// retriangulations in the workers' arenas of `arenas`.
+Surface cutSolid(const Solid& x, std::uint32_t mesh, const Scratch<Cut>& cuts, const Solid& y,
+                 const Scratch<Event>& events, const Points& points, core::MonotonicArena& arena,
+                 core::ArenaSet& arenas) {
+    Surface surface(arena);
+    Scratch<std::size_t> starts{core::ArenaAllocator<std::size_t>(arena)};
+    surface.cut.assign(x.triangles.size(), 0);
+    for (std::size_t i = 0; i < cuts.size(); ++i) {
+        if (i == 0 || cuts[i].triangle != cuts[i - 1].triangle) {
+            starts.push_back(i);
+            surface.cut[cuts[i].triangle] = 1;
+        }
+    }
+    starts.push_back(cuts.size());
+    surface.split = starts.size() - 1;
+
+    surface.faces.resize(x.triangles.size());
+    for (std::size_t t = 0; t < x.triangles.size(); ++t) {
+        const Triangle& tri = x.triangles[t];
+        surface.faces[t].v = {tri[0] + x.base, tri[1] + x.base, tri[2] + x.base};
+    }
+    // Chunks of cut triangles; pieces stay in triangle order whatever the
+    // thread count.
+    const std::size_t chunk = kGrain / 16;
+    std::vector<std::vector<Face>> pieces((surface.split + chunk - 1) / chunk);
+    core::parallelFor(0, pieces.size(), 1, [&](std::size_t first, std::size_t last) {
+        core::MonotonicArena& local = arenas.local();
+        for (std::size_t c = first; c < last; ++c) {
+            for (std::size_t i = c * chunk; i < std::min(surface.split, (c + 1) * chunk); ++i) {
+                const Cut* begin = cuts.data() + starts[i];
+                cutTriangle(x, begin->triangle, mesh, begin, starts[i + 1] - starts[i], y, events, points, local,
+                            pieces[c]);
+            }
+        }
+    });
+    for (const std::vector<Face>& p : pieces) {
+        surface.faces.insert(surface.faces.end(), p.begin(), p.end());
+    }
+    return surface;
+}
+
+/// Classifies the faces of `x` patch by patch: inside (true) or outside
+/// the other mesh `y`. Uncut triangles join across the input's own
+/// adjacency; only pieces and the triangles around them are matched by
+/// edge. Everything, the result included, goes in `arena`.
+Scratch<char> classify(const Surface& surface, const Solid& x, const Solid& y, const Points& points,
+                       std::size_t& patches, core::MonotonicArena& arena) {
+    const Scratch<Face>& faces = surface.faces;
+    const std::size_t n = surface.cut.size();
+    const core::ArenaAllocator<char> scratch(arena);
+    UnionFind sets(faces.size(), arena);
+    Scratch<std::pair<std::uint64_t, std::uint32_t>> edges(scratch);
+    const auto addEdge = [&](std::uint32_t f, int k) {
+        const std::uint32_t u = faces[f].v[k];
+        const std::uint32_t v = faces[f].v[(k + 1) % 3];
+        edges.push_back({std::uint64_t(std::min(u, v)) << 32 | std::max(u, v), f});
+    };
+    for (std::uint32_t t = 0; t < n; ++t) {
+        if (surface.cut[t]) {
+            continue;
+        }
+        for (int k = 0; k < 3; ++k) {
+            const std::uint32_t other = x.neighbors[3 * t + k];
+            if (!surface.cut[other]) {
+                sets.unite(t, other);
+            } else {
+                addEdge(t, k);
+            }
+        }
+    }
+    for (std::uint32_t f = static_cast<std::uint32_t>(n); f < faces.size(); ++f) {
+        for (int k = 0; k < 3; ++k) {
+            if (!(faces[f].cutEdges & (1u << k))) {
+                addEdge(f, k);
+            }
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    for (std::size_t i = 1; i < edges.size(); ++i) {
+        if (edges[i].first == edges[i - 1].first) {
+            sets.unite(edges[i].second, edges[i - 1].second);
+        }
+    }
+
+    // Best vote per patch root; patches without one get a winding number.
+    Scratch<std::uint32_t> best(faces.size(), kNone, scratch);
+    for (std::uint32_t f = static_cast<std::uint32_t>(n); f < faces.size(); ++f) {
+        const std::uint32_t root = sets.find(f);
+        if (faces[f].vote != 0 && (best[root] == kNone || faces[f].weight > faces[best[root]].weight)) {
+            best[root] = f;
+        }
+    }
+    Scratch<char> rootInside(faces.size(), 0, scratch);
+    patches = 0;
+    for (std::uint32_t f = 0; f < faces.size(); ++f) {
+        if (surface.removed(f) || sets.find(f) != f) {
+            continue;
+        }
+        ++patches;
+        if (best[f] != kNone) {
+            rootInside[f] = faces[best[f]].vote > 0;
+        } else {
+            const Triangle& v = faces[f].v;
+            const Vec3d centroid = (points(v[0]) + points(v[1]) + points(v[2])) / 3.0;
+            rootInside[f] = windingNumber(y, centroid) > 0.5;
+        }
+    }
+    Scratch<char> inside(faces.size(), scratch);
+    for (std::uint32_t f = 0; f < faces.size(); ++f) {
+        inside[f] = rootInside[sets.find(f)];
+    }
+    return inside;
+}
+
+} // namespace
+
+geometry::Mesh meshBoolean(const geometry::MeshView& a, const geometry::MeshView& b, BooleanOp op,
+                           MeshBooleanStats* stats) {
+    REBEL_TRACE_ZONE("boolean.mesh");
+    // Offset of the second operand: 2^-30 of the largest coordinate, in a
+    // direction no modeled feature is aligned with.
+    Aabb bounds = a.bounds();
+    bounds.expand(b.bounds());
+    double magnitude = 0.0;
+    for (int k = 0; k < 3; ++k) {
+        magnitude = std::max({magnitude, std::fabs(double(bounds.min[k])), std::fabs(double(bounds.max[k]))});
+    }
+    const double delta = std::ldexp(magnitude > 0.0 ? magnitude : 1.0, -30);
+    const Vec3d offset = Vec3d{1.0, 0.7548776662466927, 0.5698402909980532} * delta;
+    const double snapDistance = 16.0 * delta;
+
+    // Everything below up to the output mesh is scratch, released when the
+    // operation returns or unwinds.
+    core::ArenaSet& arenas = scratchArenas();
+    const core::ArenaScope operation(arenas.local());
+    core::MonotonicArena& arena = operation.arena();
+    const core::ArenaAllocator<char> scratch(arena);
+
+    Solid sa = weld(a, Vec3d{}, false, arena);
+    Solid sb = weld(b, offset, true, arena);
+    sb.base = static_cast<std::uint32_t>(sa.points.size());
+    const std::uint32_t eventBase = static_cast<std::uint32_t>(sa.points.size() + sb.points.size());
+
+    // Crossing pairs: clusters of the first mesh's triangles, in chunks on
+    // the scheduler, against a BVH over the second's clusters; triangles
+    // of overlapping clusters are then paired box by box.
+    Scratch<Hit> hits(scratch);
+    std::size_t candidates = 0;
+    if (sa.bounds.overlaps(sb.bounds)) {
+        const spatial::Bvh bvh = spatial::Bvh::build(sb.clusters.data(), sb.clusters.size());
+        const std::size_t perChunk = kGrain / kClusterSize;
+        const std::size_t chunks = (sa.clusters.size() + perChunk - 1) / perChunk;
+        std::vector<std::vector<Hit>> chunkHits(chunks);
+        std::vector<std::size_t> chunkCandidates(chunks, 0);
+        const auto members = [](const Solid& s, std::size_t cluster) {
+            const std::size_t first = cluster * kClusterSize;
+            return std::make_pair(s.order.data() + first,
+                                  s.order.data() + std::min(s.order.size(), first + kClusterSize));
+        };
+        core::parallelFor(0, chunks, 1, [&](std::size_t firstChunk, std::size_t lastChunk) {
+            for (std::size_t chunk = firstChunk; chunk < lastChunk; ++chunk) {
+                const std::size_t last = std::min(sa.clusters.size(), (chunk + 1) * perChunk);
+                for (std::size_t ca = chunk * perChunk; ca < last; ++ca) {
+                    if (!sa.clusters[ca].overlaps(sb.bounds)) {
+                        continue;
+                    }
+                    const auto [firstA, lastA] = members(sa, ca);
+                    bvh.queryOverlap(sa.clusters[ca], [&](std::uint32_t cb) {
+                        if (!sa.clusters[ca].overlaps(sb.clusters[cb])) {
+                            return true;
+                        }
+                        const auto [firstB, lastB] = members(sb, cb);
+                        for (const std::uint32_t* ta = firstA; ta != lastA; ++ta) {
+                            for (const std::uint32_t* tb = firstB; tb != lastB; ++tb) {
+                                if (!sa.boxes[*ta].overlaps(sb.boxes[*tb])) {
+                                    continue;
+                                }
+                                ++chunkCandidates[chunk];
+                                Hit hit{*ta, *tb, {}};
+                                if (crossPair(sa, *ta, sb, *tb, hit.events)) {
+                                    chunkHits[chunk].push_back(hit);
+                                }
+                            }
+                        }
+                        return true;
+                    });
+                }
+            }
+        });
+        for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+            hits.insert(hits.end(), chunkHits[chunk].begin(), chunkHits[chunk].end());
+            candidates += chunkCandidates[chunk];
+        }
+    }
+
+    // Intersection points, one per distinct edge-triangle crossing.
+    Scratch<Event> events(scratch);
+    events.reserve(2 * hits.size());
+    for (const Hit& hit : hits) {
+        events.push_back(hit.events[0]);
+        events.push_back(hit.events[1]);
+    }
+    std::sort(events.begin(), events.end());
+    events.erase(std::unique(events.begin(), events.end()), events.end());
+    Scratch<Vec3d> eventPoints(events.size(), scratch);
+    Scratch<Vec3f> eventPositions(events.size(), scratch);
+    core::parallelFor(0, events.size(), kGrain, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            const Event& e = events[i];
+            const Solid& x = e.mesh == 0 ? sa : sb;
+            const Solid& y = e.mesh == 0 ? sb : sa;
+            const Triangle& g = y.triangles[e.triangle];
+            const Vec3d& p = x.points[e.v0];
+            const Vec3d& q = x.points[e.v1];
+            const double op = math::orient3d(y.points[g[0]], y.points[g[1]], y.points[g[2]], p);
+            const double oq = math::orient3d(y.points[g[0]], y.points[g[1]], y.points[g[2]], q);
+            const double t = op != oq ? std::clamp(op / (op - oq), 0.0, 1.0) : 0.5;
+            eventPoints[i] = p + (q - p) * t;
+
+            // Back by the offset, then onto the input coordinates it is
+            // within a few offsets of: where the inputs touched, the point
+            // lands exactly on the shared vertex, edge or plane.
+            Vec3d limit = x.moved ? eventPoints[i] - offset : eventPoints[i];
+            const Vec3f* near[5] = {&x.positions[e.v0], &x.positions[e.v1], &y.positions[g[0]],
+                                    &y.positions[g[1]], &y.positions[g[2]]};
+            for (int k = 0; k < 3; ++k) {
+                double best = snapDistance;
+                double snapped = limit[k];
+                for (const Vec3f* c : near) {
+                    const double d = std::fabs(limit[k] - (*c)[k]);
+                    if (d <= best) {
+                        best = d;
+                        snapped = (*c)[k];
+                    }
+                }
+                limit[k] = snapped;
+            }
+            eventPositions[i] = Vec3f(limit);
+        }
+    });
+
+    Scratch<Cut> cutsA(scratch);
+    Scratch<Cut> cutsB(scratch);
+    cutsA.reserve(hits.size());
+    cutsB.reserve(hits.size());
+    const auto eventId = [&](const Event& e) {
+        return eventBase +
+               static_cast<std::uint32_t>(std::lower_bound(events.begin(), events.end(), e) - events.begin());
+    };
+    for (const Hit& hit : hits) {
+        const std::uint32_t u = eventId(hit.events[0]);
+        const std::uint32_t v = eventId(hit.events[1]);
+        cutsA.push_back({hit.a, u, v, hit.b});
+        cutsB.push_back({hit.b, u, v, hit.a});
+    }
+    const auto byTriangle = [](const Cut& x, const Cut& y) {
+        return std::tie(x.triangle, x.generator) < std::tie(y.triangle, y.generator);
+    };
+    std::sort(cutsA.begin(), cutsA.end(), byTriangle);
+    std::sort(cutsB.begin(), cutsB.end(), byTriangle);
+
+    const Points points{sa, sb, eventPoints, eventBase, eventPositions};
+    const Surface surfaceA = cutSolid(sa, 0, cutsA, sb, events, points, arena, arenas);
+    const Surface surfaceB = cutSolid(sb, 1, cutsB, sa, events, points, arena, arenas);
+    std::size_t patchesA = 0;
+    std::size_t patchesB = 0;
+    const Scratch<char> insideA = classify(surfaceA, sa, sb, points, patchesA, arena);
+    const Scratch<char> insideB = classify(surfaceB, sb, sa, points, patchesB, arena);
+
+    // Keep what the operation selects, the second mesh's faces flipped for
+    // a difference, welded by output position. Vertices used from both
+    // meshes are marked: only triangles over those can have a coincident
+    // opposite twin.
+    const bool keepA = op == BooleanOp::Intersection;
+    const bool keepB = op != BooleanOp::Union;
+    Scratch<std::uint32_t> outIndex(eventBase + events.size(), kNone, scratch);
+    Scratch<Vec3f> vertices(scratch);
+    Scratch<std::uint8_t> sides(scratch);
+    PositionTable table(std::min(outIndex.size(), 3 * (surfaceA.faces.size() + surfaceB.faces.size())), arena);
+    Scratch<Triangle> triangles(scratch);
+    const auto keep = [&](const Surface& surface, const Scratch<char>& inside, bool keepInside, bool flip,
+                          std::uint8_t side) {
+        for (std::size_t f = 0; f < surface.faces.size(); ++f) {
+            if (surface.removed(f) || static_cast<bool>(inside[f]) != keepInside) {
+                continue;
+            }
+            Triangle v;
+            for (int k = 0; k < 3; ++k) {
+                std::uint32_t& index = outIndex[surface.faces[f].v[k]];
+                if (index == kNone) {
+                    index = table.insert(points.output(surface.faces[f].v[k]), vertices);
+                    sides.resize(vertices.size(), 0);
+                }
+                sides[index] |= side;
+                v[k] = index;
+            }
+            if (flip) {
+                std::swap(v[1], v[2]);
+            }
+            if (v[0] != v[1] && v[1] != v[2] && v[2] != v[0]) {
+                triangles.push_back(v);
+            }
+        }
+    };
+    keep(surfaceA, insideA, keepA, false, 1);
+    keep(surfaceB, insideB, keepB, op == BooleanOp::Difference, 2);
+
+    // Drop pairs of coincident, opposite triangles where the inputs touched.
+    Scratch<std::pair<Triangle, std::uint32_t>> sorted(scratch);
+    for (std::uint32_t i = 0; i < triangles.size(); ++i) {
+        Triangle s = triangles[i];
+        if (sides[s[0]] == 3 && sides[s[1]] == 3 && sides[s[2]] == 3) {
+            std::sort(s.begin(), s.end());
+            sorted.push_back({s, i});
+        }
+    }
+    std::sort(sorted.begin(), sorted.end());
+    Scratch<char> dropped(triangles.size(), 0, scratch);
+    const auto even = [&](std::uint32_t i) {
+        const Triangle& t = triangles[i];
+        const int m = static_cast<int>(std::min_element(t.begin(), t.end()) - t.begin());
+        return t[(m + 1) % 3] < t[(m + 2) % 3];
+    };
+    Scratch<std::uint32_t> plus(scratch);
+    Scratch<std::uint32_t> minus(scratch);
+    for (std::size_t i = 0; i < sorted.size();) {
+        std::size_t j = i;
+        plus.clear();
+        minus.clear();
+        for (; j < sorted.size() && sorted[j].first == sorted[i].first; ++j) {
+            (even(sorted[j].second) ? plus : minus).push_back(sorted[j].second);
+        }
+        for (std::size_t k = 0; k < std::min(plus.size(), minus.size()); ++k) {
+            dropped[plus[k]] = 1;
+            dropped[minus[k]] = 1;
+        }
+        i = j;
+    }
+
+    geometry::Mesh mesh;
+    mesh.reserve(vertices.size(), triangles.size());
+    for (const Vec3f& p : vertices) {
+        mesh.addVertex(p);
+    }
+    for (std::size_t i = 0; i < triangles.size(); ++i) {
+        if (!dropped[i]) {
+            mesh.addTriangle(triangles[i][0], triangles[i][1], triangles[i][2]);
+        }
+    }
+
+    if (stats != nullptr) {
+        stats->candidatePairs = candidates;
+        stats->intersectingPairs = hits.size();
+        stats->splitTriangles = surfaceA.split + surfaceB.split;
+        stats->patches = patchesA + patchesB;
+    }
+    return mesh;
+}
+
+} // namespace rebel::boolean
@@ -0,0 +1,166 @@
+#include "rebel/brep/Body.hpp"
+
+#include <cmath>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+namespace rebel::brep {
+
+using math::Vec3d;
+
+namespace {
+
+constexpr double kTwoPi = 6.283185307179586476925286766559;
+constexpr double kHalfPi = 1.5707963267948966192313216916398;
+
+const Vec3d kX{1.0, 0.0, 0.0};
+const Vec3d kY{0.0, 1.0, 0.0};
+const Vec3d kZ{0.0, 0.0, 1.0};
+
+} // namespace
+
+VertexId Body::addVertex(const Vec3d& point) {
+    vertices_.push_back({point});
+    return static_cast<VertexId>(vertices_.size() - 1);
+}
+
+EdgeId Body::addEdge(CurvePtr curve, double t0, double t1, VertexId start, VertexId end) {
+    if (!curve) {
+        throw std::invalid_argument("edge has no curve");
+    }
+    if (start >= vertices_.size() || end >= vertices_.size()) {
+        throw std::invalid_argument("edge refers to an unknown vertex");
+    }
+    edges_.push_back({std::move(curve), t0, t1, start, end});
+    return static_cast<EdgeId>(edges_.size() - 1);
+}
+
+FaceId Body::addFace(SurfacePtr surface, const UvDomain& domain, const std::array<Coedge, 4>& sides,
+                     bool reversed) {
+    if (!surface) {
+        throw std::invalid_argument("face has no surface");
+    }
+    for (const Coedge& side : sides) {
+        if (side.edge >= edges_.size()) {
+            throw std::invalid_argument("face refers to an unknown edge");
+        }
+    }
+    faces_.push_back({std::move(surface), domain, sides, reversed});
+    return static_cast<FaceId>(faces_.size() - 1);
+}
+
+Body makeBox(const Vec3d& min, const Vec3d& max) {
+    Body body;
+    VertexId corner[8];
+    for (int i = 0; i < 8; ++i) {
+        corner[i] = body.addVertex({(i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z});
+    }
+    std::map<std::pair<VertexId, VertexId>, EdgeId> edges;
+    auto coedge = [&](VertexId a, VertexId b) -> Coedge {
+        if (auto it = edges.find({b, a}); it != edges.end()) {
+            return {it->second, true};
+        }
+        const EdgeId e = body.addEdge(std::make_shared<LineCurve>(body.vertex(a).point, body.vertex(b).point),
+                                      0.0, 1.0, a, b);
+        edges[{a, b}] = e;
+        return {e, false};
+    };
+    // Corners of each face in loop order (origin, +u, +u+v, +v), chosen so
+    // that u x v points outward.
+    const int quads[6][4] = {
+        {0, 2, 3, 1}, // z = min
+        {4, 5, 7, 6}, // z = max
+        {0, 1, 5, 4}, // y = min
+        {2, 6, 7, 3}, // y = max
+        {0, 4, 6, 2}, // x = min
+        {1, 3, 7, 5}, // x = max
+    };
+    for (const auto& q : quads) {
+        const Vec3d o = body.vertex(corner[q[0]]).point;
+        const Vec3d u = body.vertex(corner[q[1]]).point - o;
+        const Vec3d v = body.vertex(corner[q[3]]).point - o;
+        std::array<Coedge, 4> sides;
+        for (int k = 0; k < 4; ++k) {
+            sides[k] = coedge(corner[q[k]], corner[q[(k + 1) % 4]]);
+        }
+        body.addFace(std::make_shared<PlaneSurface>(o, u, v), {0.0, 1.0, 0.0, 1.0}, sides);
+    }
+    return body;
+}
+
+Body makeCylinder(const Vec3d& base, double radius, double height) {
+    if (!(radius > 0.0) || !(height > 0.0)) {
+        throw std::invalid_argument("cylinder needs a positive radius and height");
+    }
+    Body body;
+    const Vec3d top = base + kZ * height;
+    const VertexId bottomCenter = body.addVertex(base);
+    const VertexId topCenter = body.addVertex(top);
+    const VertexId bottomRim = body.addVertex(base + kX * radius);
+    const VertexId topRim = body.addVertex(top + kX * radius);
+
+    const EdgeId bottomCircle =
+        body.addEdge(std::make_shared<CircleCurve>(base, kX, kY, radius), 0.0, kTwoPi, bottomRim, bottomRim);
+    const EdgeId topCircle =
+        body.addEdge(std::make_shared<CircleCurve>(top, kX, kY, radius), 0.0, kTwoPi, topRim, topRim);
+    const EdgeId seam = body.addEdge(
+        std::make_shared<LineCurve>(body.vertex(bottomRim).point, body.vertex(topRim).point), 0.0, 1.0,
+        bottomRim, topRim);
+    const EdgeId bottomSpoke =
+        body.addEdge(std::make_shared<LineCurve>(base, body.vertex(bottomRim).point), 0.0, 1.0, bottomCenter,
+                     bottomRim);
+    const EdgeId topSpoke = body.addEdge(std::make_shared<LineCurve>(top, body.vertex(topRim).point), 0.0, 1.0,
+                                         topCenter, topRim);
+    const EdgeId bottomPole =
+        body.addEdge(std::make_shared<LineCurve>(base, base), 0.0, 1.0, bottomCenter, bottomCenter);
+    const EdgeId topPole = body.addEdge(std::make_shared<LineCurve>(top, top), 0.0, 1.0, topCenter, topCenter);
+
+    body.addFace(std::make_shared<CylinderSurface>(base, kX, kY, radius), {0.0, kTwoPi, 0.0, height},
+                 {Coedge{bottomCircle, false}, Coedge{seam, false}, Coedge{topCircle, true}, Coedge{seam, true}});
+    body.addFace(std::make_shared<DiscSurface>(base, kX, kY, radius), {0.0, kTwoPi, 0.0, 1.0},
+                 {Coedge{bottomPole, false}, Coedge{bottomSpoke, false}, Coedge{bottomCircle, true},
+                  Coedge{bottomSpoke, true}});
+    body.addFace(std::make_shared<DiscSurface>(top, kX, kY, radius), {0.0, kTwoPi, 0.0, 1.0},
+                 {Coedge{topPole, false}, Coedge{topSpoke, false}, Coedge{topCircle, true}, Coedge{topSpoke, true}},
+                 true);
+    return body;
+}
+
+Body makeSphere(const Vec3d& center, double radius) {
+    if (!(radius > 0.0)) {
+        throw std::invalid_argument("sphere needs a positive radius");
+    }
+    Body body;
+    const Vec3d south = center - kZ * radius;
+    const Vec3d north = center + kZ * radius;
+    const VertexId s = body.addVertex(south);
+    const VertexId n = body.addVertex(north);
+    const EdgeId southPole = body.addEdge(std::make_shared<LineCurve>(south, south), 0.0, 1.0, s, s);
+    const EdgeId northPole = body.addEdge(std::make_shared<LineCurve>(north, north), 0.0, 1.0, n, n);
+    const EdgeId meridian =
+        body.addEdge(std::make_shared<CircleCurve>(center, kX, kZ, radius), -kHalfPi, kHalfPi, s, n);
+    body.addFace(std::make_shared<SphereSurface>(center, kX, kY, radius), {0.0, kTwoPi, -kHalfPi, kHalfPi},
+                 {Coedge{southPole, false}, Coedge{meridian, false}, Coedge{northPole, true},
+                  Coedge{meridian, true}});
+    return body;
+}
+
+Body makeTorus(const Vec3d& center, double majorRadius, double minorRadius) {
+    if (!(minorRadius > 0.0) || !(majorRadius > minorRadius)) {
+        throw std::invalid_argument("torus needs 0 < minor radius < major radius");
+    }
+    Body body;
+    const VertexId v = body.addVertex(center + kX * (majorRadius + minorRadius));
+    // Seam around the axis (v = 0) and around the tube (u = 0).
+    const EdgeId outer = body.addEdge(std::make_shared<CircleCurve>(center, kX, kY, majorRadius + minorRadius),
+                                      0.0, kTwoPi, v, v);
+    const EdgeId tube = body.addEdge(
+        std::make_shared<CircleCurve>(center + kX * majorRadius, kX, kZ, minorRadius), 0.0, kTwoPi, v, v);
+    body.addFace(std::make_shared<TorusSurface>(center, kX, kY, majorRadius, minorRadius),
+                 {0.0, kTwoPi, 0.0, kTwoPi},
+                 {Coedge{outer, false}, Coedge{tube, false}, Coedge{outer, true}, Coedge{tube, true}});
+    return body;
+}
+
+} // namespace rebel::brep
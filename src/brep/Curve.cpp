@@ -0,0 +1,34 @@
+#include "rebel/brep/Curve.hpp"
+
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+
+namespace rebel::brep {
+
+void Curve::evaluatePoints(const double* t, std::size_t count, math::Vec3d* out) const {
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i] = point(t[i]);
+    }
+}
+
+math::Vec3d CircleCurve::point(double t) const {
+    return center_ + (x_ * std::cos(t) + y_ * std::sin(t)) * radius_;
+}
+
+GeometryRecord CircleCurve::record() const {
+    return GeometryRecord(GeometryKind::Circle).add(center_).add(x_).add(y_).add(radius_);
+}
+
+CurvePtr makeCurve(const GeometryRecord& r) {
+    switch (r.kind) {
+    case GeometryKind::Line:
+        return std::make_shared<LineCurve>(r.vec(0), r.vec(3));
+    case GeometryKind::Circle:
+        return std::make_shared<CircleCurve>(r.vec(0), r.vec(3), r.vec(6), r.scalar(9));
+    default:
+        throw std::invalid_argument("makeCurve: record is not a curve");
+    }
+}
+
+} // namespace rebel::brep
@@ -0,0 +1,704 @@
+#include "rebel/brep/Nurbs.hpp"
+
+#include "rebel/core/TaskScheduler.hpp"
+#include "rebel/core/Trace.hpp"
+#include "rebel/math/Batch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace rebel::brep {
+
+using math::Vec2d;
+using math::Vec3d;
+using math::batch::kMaxBasisDegree;
+
+namespace {
+
+/// Samples per call of the batched basis kernel.
+constexpr std::size_t kBlock = 64;
+constexpr std::size_t kMaxOrder = kMaxBasisDegree + 1;
+constexpr int kNewtonIterations = 16;
+/// Seeds per patch direction for closest-point queries.
+constexpr int kSeeds = 4;
+
+std::vector<double> homogeneous(const std::vector<Vec3d>& points, const std::vector<double>& weights,
+                                std::size_t expected) {
+    if (points.size() != expected) {
+        throw std::invalid_argument("NURBS needs " + std::to_string(expected) + " control points, got " +
+                                    std::to_string(points.size()));
+    }
+    if (!weights.empty() && weights.size() != points.size()) {
+        throw std::invalid_argument("NURBS weight count does not match its control points");
+    }
+    std::vector<double> out;
+    out.reserve(4 * points.size());
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        const double w = weights.empty() ? 1.0 : weights[i];
+        if (!(w > 0.0) || !std::isfinite(w)) {
+            throw std::invalid_argument("NURBS weights must be positive");
+        }
+        out.insert(out.end(), {points[i].x * w, points[i].y * w, points[i].z * w, w});
+    }
+    return out;
+}
+
+void addScaled(double* h, double s, const double* c) {
+    h[0] += s * c[0];
+    h[1] += s * c[1];
+    h[2] += s * c[2];
+    h[3] += s * c[3];
+}
+
+Vec3d projected(const double* h) { return {h[0] / h[3], h[1] / h[3], h[2] / h[3]}; }
+
+/// Derivative of the projection `a / w` from the homogeneous derivative
+/// `da` and the projected point `p`.
+Vec3d projectedDerivative(const double* da, const Vec3d& p, double w) {
+    return (Vec3d{da[0], da[1], da[2]} - p * da[3]) / w;
+}
+
+/// True when dP/du x dP/dv is too short to give a direction.
+bool degenerate(const Vec3d& du, const Vec3d& dv, const Vec3d& n) {
+    const double scale = math::dot(du, du) + math::dot(dv, dv);
+    return math::dot(n, n) <= 1e-24 * scale * scale;
+}
+
+/// Span lookups for a run of parameters, each from the previous one.
+void spansOf(const KnotVector& knots, const double* t, std::size_t count, double* clamped, std::uint32_t* spans,
+             std::uint32_t& hint) {
+    for (std::size_t i = 0; i < count; ++i) {
+        clamped[i] = knots.clamp(t[i]);
+        hint = knots.span(clamped[i], hint);
+        spans[i] = hint;
+    }
+}
+
+} // namespace
+
+KnotVector::KnotVector(unsigned degree, std::vector<double> knots) : degree_(degree), knots_(std::move(knots)) {
+    if (degree_ > kMaxBasisDegree) {
+        throw std::invalid_argument("B-spline degree " + std::to_string(degree_) + " is above the supported " +
+                                    std::to_string(kMaxBasisDegree));
+    }
+    if (knots_.size() < 2 * (degree_ + 1)) {
+        throw std::invalid_argument("a degree " + std::to_string(degree_) + " B-spline needs at least " +
+                                    std::to_string(2 * (degree_ + 1)) + " knots");
+    }
+    for (std::size_t i = 1; i < knots_.size(); ++i) {
+        if (!(knots_[i - 1] <= knots_[i])) {
+            throw std::invalid_argument("knots must not decrease");
+        }
+    }
+    if (!(first() < last())) {
+        throw std::invalid_argument("knot vector has an empty domain");
+    }
+    firstSpan_ = degree_;
+    while (knots_[firstSpan_] == knots_[firstSpan_ + 1]) {
+        ++firstSpan_;
+    }
+    lastSpan_ = static_cast<std::uint32_t>(controlCount() - 1);
+    while (knots_[lastSpan_] == knots_[lastSpan_ + 1]) {
+        --lastSpan_;
+    }
+}
+
+std::uint32_t KnotVector::span(double t) const {
+    if (!(t >= knots_[firstSpan_ + 1])) {
+        return firstSpan_;
+    }
+    if (t >= knots_[lastSpan_]) {
+        return lastSpan_;
+    }
+    const auto begin = knots_.begin();
+    const auto it = std::upper_bound(begin + firstSpan_ + 1, begin + lastSpan_ + 1, t);
+    return static_cast<std::uint32_t>(it - begin - 1);
+}
+
+std::uint32_t KnotVector::span(double t, std::uint32_t hint) const {
+    if (hint < firstSpan_ || hint > lastSpan_) {
+        return span(t);
+    }
+    std::uint32_t s = hint;
+    for (int step = 0; step < 3; ++step) {
+        if (t < knots_[s]) {
+            if (s == firstSpan_) {
+                return s;
+            }
+            --s;
+        } else if (t >= knots_[s + 1]) {
+            if (s == lastSpan_) {
+                return s;
+            }
+            ++s;
+        } else {
+            return s;
+        }
+    }
+    return span(t);
+}
+
+void KnotVector::basis(double t, std::uint32_t span, unsigned order, double* out) const {
+    // Piegl and Tiller, algorithm A2.3.
+    const int p = static_cast<int>(degree_);
+    const double* u = knots_.data();
+    double ndu[kMaxOrder][kMaxOrder];
+    double left[kMaxOrder];
+    double right[kMaxOrder];
+    ndu[0][0] = 1.0;
+    for (int j = 1; j <= p; ++j) {
+        left[j] = t - u[span + 1 - j];
+        right[j] = u[span + j] - t;
+        double saved = 0.0;
+        for (int r = 0; r < j; ++r) {
+            ndu[j][r] = right[r + 1] + left[j - r];
+            const double temp = ndu[r][j - 1] / ndu[j][r];
+            ndu[r][j] = saved + right[r + 1] * temp;
+            saved = left[j - r] * temp;
+        }
+        ndu[j][j] = saved;
+    }
+    for (int j = 0; j <= p; ++j) {
+        out[j] = ndu[j][p];
+    }
+    const int n = std::min(static_cast<int>(order), 2);
+    for (int k = 1; k <= n; ++k) {
+        std::fill(out + k * (p + 1), out + (k + 1) * (p + 1), 0.0);
+    }
+    const int top = std::min(n, p);
+    double a[2][3];
+    for (int r = 0; r <= p; ++r) {
+        int s1 = 0;
+        int s2 = 1;
+        a[0][0] = 1.0;
+        for (int k = 1; k <= top; ++k) {
+            double d = 0.0;
+            const int rk = r - k;
+            const int pk = p - k;
+            if (r >= k) {
+                a[s2][0] = a[s1][0] / ndu[pk + 1][rk];
+                d = a[s2][0] * ndu[rk][pk];
+            }
+            const int j1 = rk >= -1 ? 1 : -rk;
+            const int j2 = r - 1 <= pk ? k - 1 : p - r;
+            for (int j = j1; j <= j2; ++j) {
+                a[s2][j] = (a[s1][j] - a[s1][j - 1]) / ndu[pk + 1][rk + j];
+                d += a[s2][j] * ndu[rk + j][pk];
+            }
+            if (r <= pk) {
+                a[s2][k] = -a[s1][k - 1] / ndu[pk + 1][r];
+                d += a[s2][k] * ndu[r][pk];
+            }
+            out[k * (p + 1) + r] = d;
+            std::swap(s1, s2);
+        }
+    }
+    double factor = p;
+    for (int k = 1; k <= top; ++k) {
+        for (int j = 0; j <= p; ++j) {
+            out[k * (p + 1) + j] *= factor;
+        }
+        factor *= p - k;
+    }
+}
+
+NurbsCurve::NurbsCurve(KnotVector knots, const std::vector<Vec3d>& points, const std::vector<double>& weights)
+    : knots_(std::move(knots)), weighted_(homogeneous(points, weights, knots_.controlCount())) {}
+
+Vec3d NurbsCurve::point(double t) const {
+    const unsigned p = knots_.degree();
+    t = knots_.clamp(t);
+    const std::uint32_t s = knots_.span(t);
+    double n[kMaxOrder];
+    knots_.basis(t, s, 0, n);
+    double h[4] = {};
+    for (unsigned r = 0; r <= p; ++r) {
+        addScaled(h, n[r], &weighted_[4 * (s - p + r)]);
+    }
+    return projected(h);
+}
+
+GeometryRecord NurbsCurve::record() const {
+    throw std::logic_error("NURBS curves have no geometry record");
+}
+
+void NurbsCurve::evaluate(const double* t, std::size_t count, Vec3d* points, Vec3d* tangents) const {
+    const unsigned p = knots_.degree();
+    double params[kBlock];
+    std::uint32_t spans[kBlock];
+    double basis[kMaxOrder * kBlock];
+    double derivatives[kMaxOrder * kBlock];
+    std::uint32_t hint = count > 0 ? knots_.span(knots_.clamp(t[0])) : 0;
+    for (std::size_t first = 0; first < count; first += kBlock) {
+        const std::size_t n = std::min(kBlock, count - first);
+        spansOf(knots_, t + first, n, params, spans, hint);
+        math::batch::bsplineBasis(knots_.knots().data(), p, params, spans, n, basis,
+                                  tangents != nullptr ? derivatives : nullptr);
+        for (std::size_t i = 0; i < n; ++i) {
+            double h[4] = {};
+            double hd[4] = {};
+            for (unsigned r = 0; r <= p; ++r) {
+                const double* c = &weighted_[4 * (spans[i] - p + r)];
+                addScaled(h, basis[r * n + i], c);
+                if (tangents != nullptr) {
+                    addScaled(hd, derivatives[r * n + i], c);
+                }
+            }
+            const Vec3d point = projected(h);
+            points[first + i] = point;
+            if (tangents != nullptr) {
+                tangents[first + i] = projectedDerivative(hd, point, h[3]);
+            }
+        }
+    }
+}
+
+void NurbsCurve::evaluatePoints(const double* t, std::size_t count, Vec3d* out) const {
+    evaluate(t, count, out, nullptr);
+}
+
+NurbsSurface::NurbsSurface(KnotVector uKnots, KnotVector vKnots, const std::vector<Vec3d>& points,
+                           const std::vector<double>& weights)
+    : u_(std::move(uKnots)), v_(std::move(vKnots)), uCount_(u_.controlCount()),
+      weighted_(homogeneous(points, weights, u_.controlCount() * v_.controlCount())) {
+    // With positive weights each patch lies in the hull of its control
+    // points, so their box bounds it.
+    const unsigned p = u_.degree();
+    const unsigned q = v_.degree();
+    const std::vector<double>& uk = u_.knots();
+    const std::vector<double>& vk = v_.knots();
+    for (std::uint32_t b = q; b < v_.controlCount(); ++b) {
+        if (vk[b] == vk[b + 1]) {
+            continue;
+        }
+        for (std::uint32_t a = p; a < uCount_; ++a) {
+            if (uk[a] == uk[a + 1]) {
+                continue;
+            }
+            Patch patch{points[(b - q) * uCount_ + a - p], points[(b - q) * uCount_ + a - p], a, b};
+            for (std::uint32_t j = b - q; j <= b; ++j) {
+                for (std::uint32_t i = a - p; i <= a; ++i) {
+                    const Vec3d& c = points[j * uCount_ + i];
+                    for (int axis = 0; axis < 3; ++axis) {
+                        patch.min[axis] = std::min(patch.min[axis], c[axis]);
+                        patch.max[axis] = std::max(patch.max[axis], c[axis]);
+                    }
+                }
+            }
+            patches_.push_back(patch);
+        }
+    }
+}
+
+void NurbsSurface::accumulate(std::uint32_t uSpan, std::uint32_t vSpan, const double* nu, const double* du,
+                              std::size_t uStride, const double* nv, const double* dv, std::size_t vStride,
+                              double* h) const {
+    const unsigned p = u_.degree();
+    const unsigned q = v_.degree();
+    std::fill(h, h + 12, 0.0);
+    for (unsigned l = 0; l <= q; ++l) {
+        double row[4] = {};
+        double rowDu[4] = {};
+        const double* c = &weighted_[4 * ((vSpan - q + l) * uCount_ + uSpan - p)];
+        for (unsigned k = 0; k <= p; ++k) {
+            addScaled(row, nu[k * uStride], c + 4 * k);
+            if (du != nullptr) {
+                addScaled(rowDu, du[k * uStride], c + 4 * k);
+            }
+        }
+        addScaled(h, nv[l * vStride], row);
+        if (du != nullptr) {
+            addScaled(h + 4, nv[l * vStride], rowDu);
+        }
+        if (dv != nullptr) {
+            addScaled(h + 8, dv[l * vStride], row);
+        }
+    }
+}
+
+Vec3d NurbsSurface::point(double u, double v) const {
+    u = u_.clamp(u);
+    v = v_.clamp(v);
+    const std::uint32_t su = u_.span(u);
+    const std::uint32_t sv = v_.span(v);
+    double nu[kMaxOrder];
+    double nv[kMaxOrder];
+    u_.basis(u, su, 0, nu);
+    v_.basis(v, sv, 0, nv);
+    double h[12];
+    accumulate(su, sv, nu, nullptr, 1, nv, nullptr, 1, h);
+    return projected(h);
+}
+
+Vec3d NurbsSurface::normal(double u, double v) const {
+    u = u_.clamp(u);
+    v = v_.clamp(v);
+    const std::uint32_t su = u_.span(u);
+    const std::uint32_t sv = v_.span(v);
+    double nu[2 * kMaxOrder];
+    double nv[2 * kMaxOrder];
+    u_.basis(u, su, 1, nu);
+    v_.basis(v, sv, 1, nv);
+    double h[12];
+    accumulate(su, sv, nu, nu + u_.degree() + 1, 1, nv, nv + v_.degree() + 1, 1, h);
+    const Vec3d p = projected(h);
+    const Vec3d du = projectedDerivative(h + 4, p, h[3]);
+    const Vec3d dv = projectedDerivative(h + 8, p, h[3]);
+    const Vec3d n = math::cross(du, dv);
+    return degenerate(du, dv, n) ? normalNear(u, v) : math::normalize(n);
+}
+
+Vec3d NurbsSurface::normalNear(double u, double v) const {
+    // Step towards the middle of the patch until the tangents span a plane.
+    const std::uint32_t su = u_.span(u);
+    const std::uint32_t sv = v_.span(v);
+    const double uMid = 0.5 * (u_.knots()[su] + u_.knots()[su + 1]);
+    const double vMid = 0.5 * (v_.knots()[sv] + v_.knots()[sv + 1]);
+    Vec3d n;
+    for (double fraction : {1e-6, 1e-4, 1e-2}) {
+        const SurfaceDerivatives d = derivatives(u + (uMid - u) * fraction, v + (vMid - v) * fraction);
+        n = math::cross(d.du, d.dv);
+        if (!degenerate(d.du, d.dv, n)) {
+            break;
+        }
+    }
+    const double length = math::length(n);
+    return length > 0.0 ? n / length : n;
+}
+
+GeometryRecord NurbsSurface::record() const {
+    throw std::logic_error("NURBS surfaces have no geometry record");
+}
+
+SurfaceDerivatives NurbsSurface::derivatives(double u, double v) const {
+    const unsigned p = u_.degree();
+    const unsigned q = v_.degree();
+    u = u_.clamp(u);
+    v = v_.clamp(v);
+    const std::uint32_t su = u_.span(u);
+    const std::uint32_t sv = v_.span(v);
+    double nu[3 * kMaxOrder];
+    double nv[3 * kMaxOrder];
+    u_.basis(u, su, 2, nu);
+    v_.basis(v, sv, 2, nv);
+
+    // Homogeneous derivatives a[i][j] = d^(i+j) / du^i dv^j, i + j <= 2.
+    double a[3][3][4] = {};
+    for (unsigned l = 0; l <= q; ++l) {
+        double row[3][4] = {};
+        const double* c = &weighted_[4 * ((sv - q + l) * uCount_ + su - p)];
+        for (unsigned k = 0; k <= p; ++k) {
+            for (unsigned i = 0; i < 3; ++i) {
+                addScaled(row[i], nu[i * (p + 1) + k], c + 4 * k);
+            }
+        }
+        for (unsigned i = 0; i < 3; ++i) {
+            for (unsigned j = 0; i + j < 3; ++j) {
+                addScaled(a[i][j], nv[j * (q + 1) + l], row[i]);
+            }
+        }
+    }
+    // Piegl and Tiller, algorithm A4.4.
+    const double w = a[0][0][3];
+    auto vec = [](const double* h) { return Vec3d{h[0], h[1], h[2]}; };
+    SurfaceDerivatives d;
+    d.point = projected(a[0][0]);
+    d.du = (vec(a[1][0]) - d.point * a[1][0][3]) / w;
+    d.dv = (vec(a[0][1]) - d.point * a[0][1][3]) / w;
+    d.duu = (vec(a[2][0]) - d.du * (2.0 * a[1][0][3]) - d.point * a[2][0][3]) / w;
+    d.duv = (vec(a[1][1]) - d.dv * a[1][0][3] - d.du * a[0][1][3] - d.point * a[1][1][3]) / w;
+    d.dvv = (vec(a[0][2]) - d.dv * (2.0 * a[0][1][3]) - d.point * a[0][2][3]) / w;
+    return d;
+}
+
+void NurbsSurface::evaluate(const Vec2d* uv, std::size_t count, const SurfaceSamples& out) const {
+    REBEL_TRACE_ZONE("brep.nurbs_evaluate");
+    const unsigned p = u_.degree();
+    const unsigned q = v_.degree();
+    const bool tangents = out.du != nullptr || out.dv != nullptr || out.normals != nullptr;
+    core::parallelFor(0, count, 16 * kBlock, [&](std::size_t begin, std::size_t end) {
+        double rawU[kBlock];
+        double rawV[kBlock];
+        double u[kBlock];
+        double v[kBlock];
+        std::uint32_t uSpans[kBlock];
+        std::uint32_t vSpans[kBlock];
+        double uBasis[kMaxOrder * kBlock];
+        double vBasis[kMaxOrder * kBlock];
+        double uDerivatives[kMaxOrder * kBlock];
+        double vDerivatives[kMaxOrder * kBlock];
+        std::uint32_t uHint = u_.span(u_.clamp(uv[begin].x));
+        std::uint32_t vHint = v_.span(v_.clamp(uv[begin].y));
+        for (std::size_t first = begin; first < end; first += kBlock) {
+            const std::size_t n = std::min(kBlock, end - first);
+            for (std::size_t i = 0; i < n; ++i) {
+                rawU[i] = uv[first + i].x;
+                rawV[i] = uv[first + i].y;
+            }
+            spansOf(u_, rawU, n, u, uSpans, uHint);
+            spansOf(v_, rawV, n, v, vSpans, vHint);
+            math::batch::bsplineBasis(u_.knots().data(), p, u, uSpans, n, uBasis, tangents ? uDerivatives : nullptr);
+            math::batch::bsplineBasis(v_.knots().data(), q, v, vSpans, n, vBasis, tangents ? vDerivatives : nullptr);
+            for (std::size_t i = 0; i < n; ++i) {
+                double h[12];
+                accumulate(uSpans[i], vSpans[i], uBasis + i, tangents ? uDerivatives + i : nullptr, n, vBasis + i,
+                           tangents ? vDerivatives + i : nullptr, n, h);
+                const Vec3d point = projected(h);
+                if (out.points != nullptr) {
+                    out.points[first + i] = point;
+                }
+                if (!tangents) {
+                    continue;
+                }
+                const Vec3d du = projectedDerivative(h + 4, point, h[3]);
+                const Vec3d dv = projectedDerivative(h + 8, point, h[3]);
+                if (out.du != nullptr) {
+                    out.du[first + i] = du;
+                }
+                if (out.dv != nullptr) {
+                    out.dv[first + i] = dv;
+                }
+                if (out.normals != nullptr) {
+                    const Vec3d normal = math::cross(du, dv);
+                    out.normals[first + i] =
+                        degenerate(du, dv, normal) ? normalNear(u[i], v[i]) : math::normalize(normal);
+                }
+            }
+        }
+    });
+}
+
+void NurbsSurface::evaluateGrid(const double* u, std::size_t nu, const double* v, std::size_t nv, Vec3d* points,
+                                Vec3d* normals) const {
+    REBEL_TRACE_ZONE("brep.nurbs_grid");
+    if (nu == 0 || nv == 0) {
+        return;
+    }
+    const unsigned p = u_.degree();
+    const unsigned q = v_.degree();
+    const bool tangents = normals != nullptr;
+    std::vector<double> uParams(nu);
+    std::vector<double> vParams(nv);
+    std::vector<std::uint32_t> uSpans(nu);
+    std::vector<std::uint32_t> vSpans(nv);
+    std::vector<double> uBasis((p + 1) * nu);
+    std::vector<double> vBasis((q + 1) * nv);
+    std::vector<double> uDerivatives(tangents ? (p + 1) * nu : 0);
+    std::vector<double> vDerivatives(tangents ? (q + 1) * nv : 0);
+    std::uint32_t uHint = u_.span(u_.clamp(u[0]));
+    std::uint32_t vHint = v_.span(v_.clamp(v[0]));
+    spansOf(u_, u, nu, uParams.data(), uSpans.data(), uHint);
+    spansOf(v_, v, nv, vParams.data(), vSpans.data(), vHint);
+    math::batch::bsplineBasis(u_.knots().data(), p, uParams.data(), uSpans.data(), nu, uBasis.data(),
+                              tangents ? uDerivatives.data() : nullptr);
+    math::batch::bsplineBasis(v_.knots().data(), q, vParams.data(), vSpans.data(), nv, vBasis.data(),
+                              tangents ? vDerivatives.data() : nullptr);
+
+    core::parallelFor(0, nv, std::max<std::size_t>(1, 16 * kBlock / nu), [&](std::size_t begin, std::size_t end) {
+        // The row as a curve along u: its homogeneous control points and
+        // their v derivatives.
+        std::vector<double> row(4 * uCount_);
+        std::vector<double> rowDv(tangents ? 4 * uCount_ : 0);
+        for (std::size_t j = begin; j < end; ++j) {
+            const std::uint32_t sv = vSpans[j];
+            std::fill(row.begin(), row.end(), 0.0);
+            std::fill(rowDv.begin(), rowDv.end(), 0.0);
+            for (unsigned l = 0; l <= q; ++l) {
+                const double* c = &weighted_[4 * (sv - q + l) * uCount_];
+                const double b = vBasis[l * nv + j];
+                for (std::size_t i = 0; i < uCount_; ++i) {
+                    addScaled(&row[4 * i], b, c + 4 * i);
+                }
+                if (tangents) {
+                    const double d = vDerivatives[l * nv + j];
+                    for (std::size_t i = 0; i < uCount_; ++i) {
+                        addScaled(&rowDv[4 * i], d, c + 4 * i);
+                    }
+                }
+            }
+            for (std::size_t i = 0; i < nu; ++i) {
+                const std::uint32_t su = uSpans[i];
+                double h[4] = {};
+                double hu[4] = {};
+                double hv[4] = {};
+                for (unsigned k = 0; k <= p; ++k) {
+                    const std::size_t c = 4 * (su - p + k);
+                    addScaled(h, uBasis[k * nu + i], &row[c]);
+                    if (tangents) {
+                        addScaled(hu, uDerivatives[k * nu + i], &row[c]);
+                        addScaled(hv, uBasis[k * nu + i], &rowDv[c]);
+                    }
+                }
+                const Vec3d point = projected(h);
+                points[j * nu + i] = point;
+                if (tangents) {
+                    const Vec3d du = projectedDerivative(hu, point, h[3]);
+                    const Vec3d dv = projectedDerivative(hv, point, h[3]);
+                    const Vec3d n = math::cross(du, dv);
+                    normals[j * nu + i] =
+                        degenerate(du, dv, n) ? normalNear(uParams[i], vParams[j]) : math::normalize(n);
+                }
+            }
+        }
+    });
+}
+
+SurfaceClosestPoint NurbsSurface::refine(const Vec3d& query, double u, double v, double uLo, double uHi, double vLo,
+                                         double vHi) const {
+    SurfaceDerivatives d = derivatives(u, v);
+    double distance = math::length(d.point - query);
+    for (int iteration = 0; iteration < kNewtonIterations; ++iteration) {
+        // Newton on the gradient of half the squared distance; a gradient
+        // step where the Hessian is not positive definite.
+        const Vec3d r = d.point - query;
+        const double f = math::dot(d.du, r);
+        const double g = math::dot(d.dv, r);
+        const double a = math::dot(d.du, d.du) + math::dot(d.duu, r);
+        const double b = math::dot(d.du, d.dv) + math::dot(d.duv, r);
+        const double c = math::dot(d.dv, d.dv) + math::dot(d.dvv, r);
+        const double det = a * c - b * b;
+        // A parameter held at its bound by the gradient drops out, leaving
+        // a one-dimensional step in the other.
+        const bool holdU = (u <= uLo && f > 0.0) || (u >= uHi && f < 0.0);
+        const bool holdV = (v <= vLo && g > 0.0) || (v >= vHi && g < 0.0);
+        double stepU;
+        double stepV;
+        if (holdU && holdV) {
+            break;
+        }
+        if (holdU || holdV) {
+            const double curvature = holdU ? c : a;
+            const double slope = holdU ? g : f;
+            const double fallback = holdU ? math::dot(d.dv, d.dv) : math::dot(d.du, d.du);
+            const double step = curvature > 0.0 ? -slope / curvature : fallback > 0.0 ? -slope / fallback : 0.0;
+            stepU = holdU ? 0.0 : step;
+            stepV = holdU ? step : 0.0;
+        } else if (a > 0.0 && det > 0.0) {
+            stepU = -(c * f - b * g) / det;
+            stepV = -(a * g - b * f) / det;
+        } else {
+            const double scale = math::dot(d.du, d.du) + math::dot(d.dv, d.dv);
+            if (!(scale > 0.0)) {
+                break;
+            }
+            stepU = -f / scale;
+            stepV = -g / scale;
+        }
+        bool moved = false;
+        bool converged = false;
+        for (int halving = 0; halving < 4 && !moved; ++halving) {
+            const double nextU = std::clamp(u + stepU, uLo, uHi);
+            const double nextV = std::clamp(v + stepV, vLo, vHi);
+            if (nextU == u && nextV == v) {
+                break;
+            }
+            const SurfaceDerivatives next = derivatives(nextU, nextV);
+            const double nextDistance = math::length(next.point - query);
+            if (nextDistance <= distance) {
+                converged = std::abs(nextU - u) <= 1e-12 * (uHi - uLo) && std::abs(nextV - v) <= 1e-12 * (vHi - vLo);
+                u = nextU;
+                v = nextV;
+                d = next;
+                distance = nextDistance;
+                moved = true;
+            }
+            stepU *= 0.5;
+            stepV *= 0.5;
+        }
+        if (!moved || converged) {
+            break;
+        }
+    }
+    return {{u, v}, d.point, distance};
+}
+
+SurfaceClosestPoint NurbsSurface::nearest(const Vec3d& query,
+                                          std::vector<std::pair<double, std::uint32_t>>& order) const {
+    order.clear();
+    for (std::uint32_t k = 0; k < patches_.size(); ++k) {
+        const Patch& patch = patches_[k];
+        double squared = 0.0;
+        for (int axis = 0; axis < 3; ++axis) {
+            const double outside = std::max({patch.min[axis] - query[axis], query[axis] - patch.max[axis], 0.0});
+            squared += outside * outside;
+        }
+        order.emplace_back(std::sqrt(squared), k);
+    }
+    std::sort(order.begin(), order.end());
+
+    SurfaceClosestPoint best;
+    best.distance = std::numeric_limits<double>::infinity();
+    for (const auto& [bound, k] : order) {
+        if (bound >= best.distance) {
+            break;
+        }
+        const Patch& patch = patches_[k];
+        const double uLo = u_.knots()[patch.uSpan];
+        const double uHi = u_.knots()[patch.uSpan + 1];
+        const double vLo = v_.knots()[patch.vSpan];
+        const double vHi = v_.knots()[patch.vSpan + 1];
+        // Every local minimum of a small sample grid seeds a refinement, so
+        // a patch with two nearby valleys is not left to the luck of one.
+        // Knots at the far side of the patch evaluate fine in its span.
+        double uBasis[kSeeds + 1][kMaxOrder];
+        double vBasis[kSeeds + 1][kMaxOrder];
+        for (int i = 0; i <= kSeeds; ++i) {
+            u_.basis(uLo + (uHi - uLo) * i / kSeeds, patch.uSpan, 0, uBasis[i]);
+            v_.basis(vLo + (vHi - vLo) * i / kSeeds, patch.vSpan, 0, vBasis[i]);
+        }
+        double distances[kSeeds + 1][kSeeds + 1];
+        for (int j = 0; j <= kSeeds; ++j) {
+            for (int i = 0; i <= kSeeds; ++i) {
+                double h[12];
+                accumulate(patch.uSpan, patch.vSpan, uBasis[i], nullptr, 1, vBasis[j], nullptr, 1, h);
+                distances[j][i] = math::length(projected(h) - query);
+            }
+        }
+        for (int j = 0; j <= kSeeds; ++j) {
+            for (int i = 0; i <= kSeeds; ++i) {
+                bool minimum = true;
+                for (int dj = -1; dj <= 1 && minimum; ++dj) {
+                    for (int di = -1; di <= 1 && minimum; ++di) {
+                        const int ni = i + di;
+                        const int nj = j + dj;
+                        if ((di != 0 || dj != 0) && ni >= 0 && ni <= kSeeds && nj >= 0 && nj <= kSeeds) {
+                            minimum = distances[j][i] < distances[nj][ni] ||
+                                      (distances[j][i] == distances[nj][ni] && (dj > 0 || (dj == 0 && di > 0)));
+                        }
+                    }
+                }
+                if (!minimum) {
+                    continue;
+                }
+                const SurfaceClosestPoint candidate = refine(query, uLo + (uHi - uLo) * i / kSeeds,
+                                                             vLo + (vHi - vLo) * j / kSeeds, uLo, uHi, vLo, vHi);
+                if (candidate.distance < best.distance) {
+                    best = candidate;
+                }
+            }
+        }
+    }
+    return best;
+}
+
+void NurbsSurface::closestPoints(const Vec3d* queries, std::size_t count, SurfaceClosestPoint* out) const {
+    REBEL_TRACE_ZONE("brep.nurbs_closest");
+    core::parallelFor(0, count, 16, [&](std::size_t begin, std::size_t end) {
+        std::vector<std::pair<double, std::uint32_t>> order;
+        order.reserve(patches_.size());
+        for (std::size_t i = begin; i < end; ++i) {
+            out[i] = nearest(queries[i], order);
+        }
+    });
+}
+
+SurfaceClosestPoint NurbsSurface::closestPoint(const Vec3d& query) const {
+    SurfaceClosestPoint out;
+    closestPoints(&query, 1, &out);
+    return out;
+}
+
+} // namespace rebel::brep
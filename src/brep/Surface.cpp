@@ -0,0 +1,109 @@
+#include "rebel/brep/Surface.hpp"
+
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+
+namespace rebel::brep {
+
+using math::Vec3d;
+
+void Surface::evaluateGrid(const double* u, std::size_t nu, const double* v, std::size_t nv, Vec3d* points,
+                           Vec3d* normals) const {
+    for (std::size_t j = 0; j < nv; ++j) {
+        for (std::size_t i = 0; i < nu; ++i) {
+            points[j * nu + i] = point(u[i], v[j]);
+            if (normals != nullptr) {
+                normals[j * nu + i] = normal(u[i], v[j]);
+            }
+        }
+    }
+}
+
+PlaneSurface::PlaneSurface(const Vec3d& origin, const Vec3d& uAxis, const Vec3d& vAxis)
+    : origin_(origin), u_(uAxis), v_(vAxis), normal_(math::normalize(math::cross(uAxis, vAxis))) {}
+
+DiscSurface::DiscSurface(const Vec3d& center, const Vec3d& xAxis, const Vec3d& yAxis, double radius)
+    : center_(center), x_(xAxis), y_(yAxis), normal_(-math::normalize(math::cross(xAxis, yAxis))),
+      radius_(radius) {}
+
+Vec3d DiscSurface::point(double u, double v) const {
+    return center_ + (x_ * std::cos(u) + y_ * std::sin(u)) * (radius_ * v);
+}
+
+CylinderSurface::CylinderSurface(const Vec3d& origin, const Vec3d& xAxis, const Vec3d& yAxis, double radius)
+    : origin_(origin), x_(xAxis), y_(yAxis), axis_(math::cross(xAxis, yAxis)), radius_(radius) {}
+
+Vec3d CylinderSurface::point(double u, double v) const {
+    return origin_ + (x_ * std::cos(u) + y_ * std::sin(u)) * radius_ + axis_ * v;
+}
+
+Vec3d CylinderSurface::normal(double u, double) const {
+    return x_ * std::cos(u) + y_ * std::sin(u);
+}
+
+SphereSurface::SphereSurface(const Vec3d& center, const Vec3d& xAxis, const Vec3d& yAxis, double radius)
+    : center_(center), x_(xAxis), y_(yAxis), z_(math::cross(xAxis, yAxis)), radius_(radius) {}
+
+Vec3d SphereSurface::point(double u, double v) const {
+    return center_ + normal(u, v) * radius_;
+}
+
+Vec3d SphereSurface::normal(double u, double v) const {
+    const double c = std::cos(v);
+    return x_ * (c * std::cos(u)) + y_ * (c * std::sin(u)) + z_ * std::sin(v);
+}
+
+TorusSurface::TorusSurface(const Vec3d& center, const Vec3d& xAxis, const Vec3d& yAxis, double majorRadius,
+                           double minorRadius)
+    : center_(center), x_(xAxis), y_(yAxis), z_(math::cross(xAxis, yAxis)), major_(majorRadius),
+      minor_(minorRadius) {}
+
+Vec3d TorusSurface::point(double u, double v) const {
+    const Vec3d radial = x_ * std::cos(u) + y_ * std::sin(u);
+    return center_ + radial * (major_ + minor_ * std::cos(v)) + z_ * (minor_ * std::sin(v));
+}
+
+Vec3d TorusSurface::normal(double u, double v) const {
+    const Vec3d radial = x_ * std::cos(u) + y_ * std::sin(u);
+    return radial * std::cos(v) + z_ * std::sin(v);
+}
+
+GeometryRecord PlaneSurface::record() const {
+    return GeometryRecord(GeometryKind::Plane).add(origin_).add(u_).add(v_);
+}
+
+GeometryRecord DiscSurface::record() const {
+    return GeometryRecord(GeometryKind::Disc).add(center_).add(x_).add(y_).add(radius_);
+}
+
+GeometryRecord CylinderSurface::record() const {
+    return GeometryRecord(GeometryKind::Cylinder).add(origin_).add(x_).add(y_).add(radius_);
+}
+
+GeometryRecord SphereSurface::record() const {
+    return GeometryRecord(GeometryKind::Sphere).add(center_).add(x_).add(y_).add(radius_);
+}
+
+GeometryRecord TorusSurface::record() const {
+    return GeometryRecord(GeometryKind::Torus).add(center_).add(x_).add(y_).add(major_).add(minor_);
+}
+
+SurfacePtr makeSurface(const GeometryRecord& r) {
+    switch (r.kind) {
+    case GeometryKind::Plane:
+        return std::make_shared<PlaneSurface>(r.vec(0), r.vec(3), r.vec(6));
+    case GeometryKind::Disc:
+        return std::make_shared<DiscSurface>(r.vec(0), r.vec(3), r.vec(6), r.scalar(9));
+    case GeometryKind::Cylinder:
+        return std::make_shared<CylinderSurface>(r.vec(0), r.vec(3), r.vec(6), r.scalar(9));
+    case GeometryKind::Sphere:
+        return std::make_shared<SphereSurface>(r.vec(0), r.vec(3), r.vec(6), r.scalar(9));
+    case GeometryKind::Torus:
+        return std::make_shared<TorusSurface>(r.vec(0), r.vec(3), r.vec(6), r.scalar(9), r.scalar(10));
+    default:
+        throw std::invalid_argument("makeSurface: record is not a surface");
+    }
+}
+
+} // namespace rebel::brep
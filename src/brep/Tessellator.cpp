@@ -0,0 +1,378 @@
+#include "rebel/brep/Tessellator.hpp"
+
+#include "rebel/core/TaskScheduler.hpp"
+#include "rebel/core/Trace.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+
+namespace rebel::brep {
+
+using geometry::Mesh;
+using geometry::VertexIndex;
+using math::Vec2d;
+using math::Vec3d;
+using math::Vec3f;
+
+namespace {
+
+/// Coarse levels never let a single segment turn by more than this, which
+/// also keeps closed directions (circles, seams) at five or more segments.
+constexpr double kMaxAngle = 1.0;
+
+struct Budget {
+    double chordal;
+    double angular;
+    std::uint32_t maxSegments;
+};
+
+struct EdgeSamples {
+    std::vector<double> params;
+    std::vector<Vec3f> points;
+};
+
+/// Boundary or grid vertex of a face as seen from one triangle.
+struct FaceCorner {
+    VertexIndex index;
+    /// Position along the side (boundary) or row/column (grid), in [0, 1].
+    double s;
+    Vec2d uv;
+};
+
+double angleBetween(const Vec3d& a, const Vec3d& b) {
+    const double la = math::length(a);
+    const double lb = math::length(b);
+    if (la <= 0.0 || lb <= 0.0) {
+        return 0.0;
+    }
+    return std::acos(std::clamp(math::dot(a, b) / (la * lb), -1.0, 1.0));
+}
+
+void subdivideEdge(const Curve& curve, double a, double b, const Vec3d& pa, const Vec3d& pb, const Budget& budget,
+                   int depth, std::vector<double>& out) {
+    const double m = 0.5 * (a + b);
+    const Vec3d pm = curve.point(m);
+    const double deviation = math::length(pm - (pa + pb) * 0.5);
+    const double turn = angleBetween(pm - pa, pb - pm);
+    if (depth > 0 && (deviation > budget.chordal || turn > budget.angular)) {
+        subdivideEdge(curve, a, m, pa, pm, budget, depth - 1, out);
+        out.push_back(m);
+        subdivideEdge(curve, m, b, pm, pb, budget, depth - 1, out);
+    }
+}
+
+EdgeSamples sampleEdge(const Body& body, const BrepEdge& edge, const Budget& budget) {
+    const Curve& curve = *edge.curve;
+    // Curved edges start from a few spans so that closed circles, whose
+    // single-span chord is degenerate, are still measured correctly.
+    const std::uint32_t initial = curve.isLinear() ? 1u : std::min(4u, budget.maxSegments);
+    int depth = 0;
+    while ((initial << (depth + 1)) <= budget.maxSegments) {
+        ++depth;
+    }
+
+    EdgeSamples samples;
+    samples.params.push_back(edge.t0);
+    Vec3d pa = curve.point(edge.t0);
+    for (std::uint32_t k = 0; k < initial; ++k) {
+        const double a = edge.t0 + (edge.t1 - edge.t0) * k / initial;
+        const double b = edge.t0 + (edge.t1 - edge.t0) * (k + 1) / initial;
+        const Vec3d pb = curve.point(b);
+        subdivideEdge(curve, a, b, pa, pb, budget, depth, samples.params);
+        samples.params.push_back(b);
+        pa = pb;
+    }
+    std::vector<Vec3d> points(samples.params.size());
+    curve.evaluatePoints(samples.params.data(), points.size(), points.data());
+    samples.points.reserve(points.size());
+    for (const Vec3d& p : points) {
+        samples.points.emplace_back(p);
+    }
+    // End points come from the topological vertices so that every edge
+    // meeting there produces the same bits.
+    samples.points.front() = Vec3f(body.vertex(edge.start).point);
+    samples.points.back() = Vec3f(body.vertex(edge.end).point);
+    return samples;
+}
+
+/// Number of segments along u (or v) that keeps every isoline within the
+/// chordal and angular budget: doubled until a handful of isolines pass.
+std::uint32_t faceSegments(const Surface& surface, const UvDomain& d, bool alongU, const Budget& budget) {
+    constexpr int kIsolines = 5;
+    auto evaluate = [&](double along, double across, Vec3d& p, Vec3d& n) {
+        const double u = alongU ? along : across;
+        const double v = alongU ? across : along;
+        p = surface.point(d.u0 + u * (d.u1 - d.u0), d.v0 + v * (d.v1 - d.v0));
+        n = surface.normal(d.u0 + u * (d.u1 - d.u0), d.v0 + v * (d.v1 - d.v0));
+    };
+    auto fits = [&](std::uint32_t n) {
+        for (int k = 0; k < kIsolines; ++k) {
+            const double across = static_cast<double>(k) / (kIsolines - 1);
+            Vec3d pa;
+            Vec3d na;
+            evaluate(0.0, across, pa, na);
+            for (std::uint32_t i = 0; i < n; ++i) {
+                Vec3d pb;
+                Vec3d nb;
+                Vec3d pm;
+                Vec3d nm;
+                evaluate(static_cast<double>(i + 1) / n, across, pb, nb);
+                evaluate((i + 0.5) / n, across, pm, nm);
+                if (math::length(pm - (pa + pb) * 0.5) > budget.chordal || angleBetween(na, nb) > budget.angular) {
+                    return false;
+                }
+                pa = pb;
+                na = nb;
+            }
+        }
+        return true;
+    };
+    std::uint32_t n = 2;
+    while (n < budget.maxSegments && !fits(n)) {
+        n *= 2;
+    }
+    return std::max<std::uint32_t>(2, std::min(n, budget.maxSegments));
+}
+
+std::uint64_t vertexKey(VertexId v) { return (std::uint64_t{1} << 63) | v; }
+
+std::uint64_t edgeSampleKey(EdgeId e, std::size_t k) { return (std::uint64_t{e} << 32) | k; }
+
+/// Meshes one face: a regular (u, v) grid inside, zipped to the shared edge
+/// samples along each side.
+Mesh meshFace(const Body& body, const BrepFace& face, const std::vector<EdgeSamples>& edges, const Budget& budget) {
+    const Surface& surface = *face.surface;
+    const UvDomain& d = face.domain;
+    const std::uint32_t nu = faceSegments(surface, d, true, budget);
+    const std::uint32_t nv = faceSegments(surface, d, false, budget);
+    const double sign = face.reversed ? -1.0 : 1.0;
+
+    Mesh mesh;
+    mesh.enableNormals();
+    mesh.reserve((nu + 1) * (nv + 1), 2 * nu * nv);
+    auto uvAt = [&](double a, double b) { return Vec2d{d.u0 + a * (d.u1 - d.u0), d.v0 + b * (d.v1 - d.v0)}; };
+    auto addVertex = [&](const Vec3f& p, const Vec2d& uv) {
+        const VertexIndex index = mesh.addVertex(p);
+        mesh.setNormal(index, Vec3f(surface.normal(uv.x, uv.y) * sign));
+        return index;
+    };
+    auto emit = [&](const FaceCorner& a, FaceCorner b, FaceCorner c) {
+        if (a.index == b.index || b.index == c.index || a.index == c.index) {
+            return; // Collapsed at a pole or a degenerate side.
+        }
+        const Vec2d ab = b.uv - a.uv;
+        const Vec2d ac = c.uv - a.uv;
+        if ((ab.x * ac.y - ab.y * ac.x < 0.0) != face.reversed) {
+            std::swap(b, c);
+        }
+        mesh.addTriangle(a.index, b.index, c.index);
+    };
+
+    // Interior grid nodes, i in [1, nu - 1] and j in [1, nv - 1], evaluated
+    // in one batch.
+    std::vector<double> gridU;
+    std::vector<double> gridV;
+    for (std::uint32_t i = 1; i < nu; ++i) {
+        gridU.push_back(uvAt(static_cast<double>(i) / nu, 0.0).x);
+    }
+    for (std::uint32_t j = 1; j < nv; ++j) {
+        gridV.push_back(uvAt(0.0, static_cast<double>(j) / nv).y);
+    }
+    std::vector<Vec3d> gridPoints(gridU.size() * gridV.size());
+    std::vector<Vec3d> gridNormals(gridPoints.size());
+    surface.evaluateGrid(gridU.data(), gridU.size(), gridV.data(), gridV.size(), gridPoints.data(),
+                         gridNormals.data());
+    std::vector<FaceCorner> grid;
+    grid.reserve(gridPoints.size());
+    for (std::size_t k = 0; k < gridPoints.size(); ++k) {
+        const Vec2d uv{gridU[k % gridU.size()], gridV[k / gridU.size()]};
+        const VertexIndex index = mesh.addVertex(Vec3f(gridPoints[k]));
+        mesh.setNormal(index, Vec3f(gridNormals[k] * sign));
+        grid.push_back({index, 0.0, uv});
+    }
+    auto node = [&](std::uint32_t i, std::uint32_t j, double s) {
+        FaceCorner c = grid[static_cast<std::size_t>(j - 1) * (nu - 1) + (i - 1)];
+        c.s = s;
+        return c;
+    };
+    for (std::uint32_t j = 1; j + 1 < nv; ++j) {
+        for (std::uint32_t i = 1; i + 1 < nu; ++i) {
+            emit(node(i, j, 0), node(i + 1, j, 0), node(i + 1, j + 1, 0));
+            emit(node(i, j, 0), node(i + 1, j + 1, 0), node(i, j + 1, 0));
+        }
+    }
+
+    // Boundary: each side ordered by increasing u (sides 0, 2) or v (1, 3).
+    std::unordered_map<std::uint64_t, VertexIndex> shared;
+    std::vector<FaceCorner> outer;
+    std::vector<FaceCorner> inner;
+    for (int k = 0; k < 4; ++k) {
+        const Coedge& coedge = face.sides[k];
+        const BrepEdge& edge = body.edge(coedge.edge);
+        const EdgeSamples& samples = edges[coedge.edge];
+        const bool forward = (k < 2) != coedge.reversed;
+        const std::size_t count = samples.params.size();
+        const double span = edge.t1 - edge.t0;
+
+        outer.clear();
+        for (std::size_t q = 0; q < count; ++q) {
+            const std::size_t idx = forward ? q : count - 1 - q;
+            double s = span != 0.0 ? (samples.params[idx] - edge.t0) / span : static_cast<double>(idx) / (count - 1);
+            s = forward ? s : 1.0 - s;
+            const Vec2d uv = k == 0 ? uvAt(s, 0.0) : k == 1 ? uvAt(1.0, s) : k == 2 ? uvAt(s, 1.0) : uvAt(0.0, s);
+            const std::uint64_t key = idx == 0           ? vertexKey(edge.start)
+                                      : idx == count - 1 ? vertexKey(edge.end)
+                                                         : edgeSampleKey(coedge.edge, idx);
+            auto [it, inserted] = shared.try_emplace(key, 0);
+            if (inserted) {
+                it->second = addVertex(samples.points[idx], uv);
+            }
+            outer.push_back({it->second, s, uv});
+        }
+
+        inner.clear();
+        if (k == 0 || k == 2) {
+            const std::uint32_t j = k == 0 ? 1 : nv - 1;
+            for (std::uint32_t i = 1; i < nu; ++i) {
+                inner.push_back(node(i, j, static_cast<double>(i) / nu));
+            }
+        } else {
+            const std::uint32_t i = k == 1 ? nu - 1 : 1;
+            for (std::uint32_t j = 1; j < nv; ++j) {
+                inner.push_back(node(i, j, static_cast<double>(j) / nv));
+            }
+        }
+
+        // Zipper between the side and the nearest grid row, always advancing
+        // whichever sequence has the nearer next point.
+        std::size_t a = 0;
+        std::size_t b = 0;
+        while (a + 1 < outer.size() || b + 1 < inner.size()) {
+            const bool advanceOuter = b + 1 >= inner.size() || (a + 1 < outer.size() && outer[a + 1].s <= inner[b + 1].s);
+            if (advanceOuter) {
+                emit(outer[a], outer[a + 1], inner[b]);
+                ++a;
+            } else {
+                emit(outer[a], inner[b + 1], inner[b]);
+                ++b;
+            }
+        }
+    }
+    return mesh;
+}
+
+struct PositionKey {
+    std::uint32_t bits[3];
+
+    bool operator==(const PositionKey& o) const {
+        return bits[0] == o.bits[0] && bits[1] == o.bits[1] && bits[2] == o.bits[2];
+    }
+};
+
+struct PositionKeyHash {
+    std::size_t operator()(const PositionKey& k) const {
+        std::uint64_t h = 1469598103934665603ull;
+        for (std::uint32_t b : k.bits) {
+            h = (h ^ b) * 1099511628211ull;
+        }
+        return static_cast<std::size_t>(h);
+    }
+};
+
+PositionKey positionKey(const Vec3f& p) {
+    PositionKey key;
+    const float c[3] = {p.x == 0.0f ? 0.0f : p.x, p.y == 0.0f ? 0.0f : p.y, p.z == 0.0f ? 0.0f : p.z};
+    std::memcpy(key.bits, c, sizeof(key.bits));
+    return key;
+}
+
+} // namespace
+
+double TessellationOptions::levelChordalTolerance(std::uint32_t level) const {
+    return chordalTolerance * std::pow(levelScale, static_cast<double>(level));
+}
+
+double TessellationOptions::levelAngularTolerance(std::uint32_t level) const {
+    // Chordal deviation grows with the square of the segment angle, so the
+    // angle budget grows with the square root of the chordal one.
+    const double angle = angularTolerance * std::pow(std::sqrt(levelScale), static_cast<double>(level));
+    return std::min(angle, kMaxAngle);
+}
+
+std::size_t TessellationLevel::triangleCount() const {
+    std::size_t n = 0;
+    for (const Mesh& face : faces) {
+        n += face.triangleCount();
+    }
+    return n;
+}
+
+Mesh TessellationLevel::merged() const {
+    Mesh out;
+    std::unordered_map<PositionKey, VertexIndex, PositionKeyHash> welded;
+    std::vector<VertexIndex> remap;
+    for (const Mesh& face : faces) {
+        remap.resize(face.vertexCount());
+        for (std::size_t i = 0; i < face.vertexCount(); ++i) {
+            const Vec3f p = face.position(static_cast<VertexIndex>(i));
+            auto [it, inserted] = welded.try_emplace(positionKey(p), 0);
+            if (inserted) {
+                it->second = out.addVertex(p);
+            }
+            remap[i] = it->second;
+        }
+        for (std::size_t t = 0; t < face.triangleCount(); ++t) {
+            const VertexIndex a = remap[face.vertex(static_cast<geometry::CornerIndex>(3 * t))];
+            const VertexIndex b = remap[face.vertex(static_cast<geometry::CornerIndex>(3 * t + 1))];
+            const VertexIndex c = remap[face.vertex(static_cast<geometry::CornerIndex>(3 * t + 2))];
+            if (a != b && b != c && a != c) {
+                out.addTriangle(a, b, c);
+            }
+        }
+    }
+    return out;
+}
+
+TessellationLevel tessellateLevel(const Body& body, const TessellationOptions& options, std::uint32_t level) {
+    REBEL_TRACE_ZONE("brep.tessellate_level");
+    const Budget budget{options.levelChordalTolerance(level), options.levelAngularTolerance(level),
+                        std::max<std::uint32_t>(options.maxSegments, 4)};
+    TessellationLevel out;
+    out.chordalTolerance = budget.chordal;
+    out.angularTolerance = budget.angular;
+
+    std::vector<EdgeSamples> samples(body.edgeCount());
+    core::parallelFor(0, body.edgeCount(), 16, [&](std::size_t first, std::size_t last) {
+        for (std::size_t e = first; e < last; ++e) {
+            samples[e] = sampleEdge(body, body.edge(static_cast<EdgeId>(e)), budget);
+        }
+    });
+    out.faces.resize(body.faceCount());
+    core::parallelFor(0, body.faceCount(), 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t f = first; f < last; ++f) {
+            out.faces[f] = meshFace(body, body.face(static_cast<FaceId>(f)), samples, budget);
+        }
+    });
+    out.edges.reserve(samples.size());
+    for (EdgeSamples& s : samples) {
+        out.edges.push_back(std::move(s.points));
+    }
+    return out;
+}
+
+Tessellation tessellate(const Body& body, const TessellationOptions& options) {
+    REBEL_TRACE_ZONE("brep.tessellate");
+    Tessellation result;
+    result.levels.resize(std::max<std::uint32_t>(options.levelCount, 1));
+    core::TaskGroup group;
+    for (std::uint32_t level = 0; level < result.levels.size(); ++level) {
+        group.run([&body, &options, &result, level] { result.levels[level] = tessellateLevel(body, options, level); });
+    }
+    group.wait();
+    return result;
+}
+
+} // namespace rebel::brep
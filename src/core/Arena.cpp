@@ -0,0 +1,110 @@
+#include "rebel/core/Arena.hpp"
+
+#include "rebel/core/TaskScheduler.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace rebel::core {
+
+MonotonicArena::MonotonicArena(std::size_t blockSize) : blockSize_(std::max<std::size_t>(blockSize, 1024)) {}
+
+MonotonicArena::~MonotonicArena() { release(); }
+
+void* MonotonicArena::allocateSlow(std::size_t bytes, std::size_t alignment) {
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        throw std::invalid_argument("arena alignment must be a power of two");
+    }
+    // Blocks are cache-line aligned, so a fresh block only needs padding for
+    // stricter alignments.
+    const std::size_t needed = bytes + (alignment > kCacheLineSize ? alignment : 0);
+    if (current_ < blocks_.size()) {
+        bytesUsed_ += blocks_[current_].size - offset_;
+    }
+    // Reuse a retained block if one is large enough, keeping block order so
+    // markers stay valid.
+    std::size_t next = current_ < blocks_.size() ? current_ + 1 : 0;
+    for (std::size_t i = next; i < blocks_.size(); ++i) {
+        if (blocks_[i].size >= needed) {
+            std::swap(blocks_[i], blocks_[next]);
+            break;
+        }
+    }
+    if (next >= blocks_.size() || blocks_[next].size < needed) {
+        const std::size_t size = std::max(blockSize_, needed);
+        auto* data = static_cast<std::byte*>(::operator new(size, std::align_val_t(kCacheLineSize)));
+        blocks_.insert(blocks_.begin() + static_cast<std::ptrdiff_t>(next), Block{data, size});
+        bytesReserved_ += size;
+    }
+    current_ = next;
+    offset_ = 0;
+    return allocate(bytes, alignment);
+}
+
+void MonotonicArena::runDestructors(void* until) {
+    while (destructors_ && destructors_ != until) {
+        DestructorRecord* record = destructors_;
+        destructors_ = record->next;
+        record->destroy(record->object);
+    }
+}
+
+void MonotonicArena::rollback(const Marker& marker) {
+    runDestructors(marker.destructors);
+    current_ = marker.block;
+    offset_ = marker.offset;
+    bytesUsed_ = marker.bytesUsed;
+}
+
+void MonotonicArena::release() {
+    runDestructors(nullptr);
+    for (const Block& block : blocks_) {
+        ::operator delete(block.data, std::align_val_t(kCacheLineSize));
+    }
+    blocks_.clear();
+    current_ = 0;
+    offset_ = 0;
+    bytesUsed_ = 0;
+    bytesReserved_ = 0;
+}
+
+ArenaSet::ArenaSet(std::size_t blockSize) {
+    const unsigned slots = TaskScheduler::global().threadCount() + 1;
+    arenas_.reserve(slots);
+    for (unsigned i = 0; i < slots; ++i) {
+        arenas_.push_back(std::make_unique<MonotonicArena>(blockSize));
+    }
+}
+
+MonotonicArena& ArenaSet::local() {
+    const int worker = TaskScheduler::currentWorkerIndex();
+    const std::size_t slot = worker >= 0 ? static_cast<std::size_t>(worker) + 1 : 0;
+    if (slot >= arenas_.size()) {
+        throw std::runtime_error("arena set was created for a smaller task scheduler");
+    }
+    return *arenas_[slot];
+}
+
+void ArenaSet::reset() {
+    for (auto& arena : arenas_) {
+        arena->reset();
+    }
+}
+
+std::size_t ArenaSet::bytesUsed() const {
+    std::size_t n = 0;
+    for (const auto& arena : arenas_) {
+        n += arena->bytesUsed();
+    }
+    return n;
+}
+
+std::size_t ArenaSet::bytesReserved() const {
+    std::size_t n = 0;
+    for (const auto& arena : arenas_) {
+        n += arena->bytesReserved();
+    }
+    return n;
+}
+
+} // namespace rebel::core
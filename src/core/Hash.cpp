@@ -0,0 +1,136 @@
+#include "rebel/core/Hash.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace rebel::core {
+namespace {
+
+constexpr std::uint64_t kC1 = 0x87c37b91114253d5ull;
+constexpr std::uint64_t kC2 = 0x4cf5ad432745937full;
+
+constexpr std::uint64_t rotl(std::uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+constexpr std::uint64_t fmix(std::uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdull;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ull;
+    k ^= k >> 33;
+    return k;
+}
+
+std::uint64_t loadLittleEndian(const unsigned char* p, std::size_t n) {
+    std::uint64_t v = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        v |= static_cast<std::uint64_t>(p[i]) << (8 * i);
+    }
+    return v;
+}
+
+} // namespace
+
+std::string Hash128::toHex() const {
+    static const char* digits = "0123456789abcdef";
+    std::string out(32, '0');
+    for (int i = 0; i < 16; ++i) {
+        out[15 - i] = digits[(hi >> (4 * i)) & 0xf];
+        out[31 - i] = digits[(lo >> (4 * i)) & 0xf];
+    }
+    return out;
+}
+
+bool Hash128::fromHex(std::string_view hex, Hash128& out) {
+    if (hex.size() != 32) {
+        return false;
+    }
+    Hash128 h;
+    for (std::size_t i = 0; i < 32; ++i) {
+        const char c = hex[i];
+        std::uint64_t d;
+        if (c >= '0' && c <= '9') {
+            d = static_cast<std::uint64_t>(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            d = static_cast<std::uint64_t>(c - 'a' + 10);
+        } else {
+            return false;
+        }
+        std::uint64_t& word = i < 16 ? h.hi : h.lo;
+        word = (word << 4) | d;
+    }
+    out = h;
+    return true;
+}
+
+void Hasher::mixBlock(std::uint64_t k1, std::uint64_t k2) {
+    k1 *= kC1;
+    k1 = rotl(k1, 31);
+    k1 *= kC2;
+    h1_ ^= k1;
+    h1_ = rotl(h1_, 27);
+    h1_ += h2_;
+    h1_ = h1_ * 5 + 0x52dce729;
+
+    k2 *= kC2;
+    k2 = rotl(k2, 33);
+    k2 *= kC1;
+    h2_ ^= k2;
+    h2_ = rotl(h2_, 31);
+    h2_ += h1_;
+    h2_ = h2_ * 5 + 0x38495ab5;
+}
+
+Hasher& Hasher::addBytes(const void* data, std::size_t size) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    length_ += size;
+    if (tailSize_ > 0) {
+        const std::size_t take = std::min(size, sizeof(tail_) - tailSize_);
+        std::memcpy(tail_ + tailSize_, p, take);
+        tailSize_ += take;
+        p += take;
+        size -= take;
+        if (tailSize_ < sizeof(tail_)) {
+            return *this;
+        }
+        mixBlock(loadLittleEndian(tail_, 8), loadLittleEndian(tail_ + 8, 8));
+        tailSize_ = 0;
+    }
+    while (size >= 16) {
+        mixBlock(loadLittleEndian(p, 8), loadLittleEndian(p + 8, 8));
+        p += 16;
+        size -= 16;
+    }
+    std::memcpy(tail_, p, size);
+    tailSize_ = size;
+    return *this;
+}
+
+Hash128 Hasher::finish() const {
+    std::uint64_t h1 = h1_;
+    std::uint64_t h2 = h2_;
+    if (tailSize_ > 8) {
+        std::uint64_t k2 = loadLittleEndian(tail_ + 8, tailSize_ - 8);
+        k2 *= kC2;
+        k2 = rotl(k2, 33);
+        k2 *= kC1;
+        h2 ^= k2;
+    }
+    if (tailSize_ > 0) {
+        std::uint64_t k1 = loadLittleEndian(tail_, tailSize_ < 8 ? tailSize_ : 8);
+        k1 *= kC1;
+        k1 = rotl(k1, 31);
+        k1 *= kC2;
+        h1 ^= k1;
+    }
+    h1 ^= length_;
+    h2 ^= length_;
+    h1 += h2;
+    h2 += h1;
+    h1 = fmix(h1);
+    h2 = fmix(h2);
+    h1 += h2;
+    h2 += h1;
+    return {h1, h2};
+}
+
+} // namespace rebel::core
@@ -0,0 +1,409 @@
+#include "rebel/core/Json.hpp"
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace rebel::core {
+namespace {
+
+class Parser {
+public:
+    explicit Parser(std::string_view text) : text_(text) {}
+
+    Json parseDocument() {
+        Json value = parseValue();
+        skipSpace();
+        if (pos_ != text_.size()) {
+            fail("trailing characters");
+        }
+        return value;
+    }
+
+private:
+    [[noreturn]] void fail(const char* what) const {
+        throw std::runtime_error(std::string("json: ") + what + " at offset " + std::to_string(pos_));
+    }
+
+    void skipSpace() {
+        while (pos_ < text_.size() &&
+               (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n' || text_[pos_] == '\r')) {
+            ++pos_;
+        }
+    }
+
+    bool consume(std::string_view token) {
+        if (text_.substr(pos_, token.size()) == token) {
+            pos_ += token.size();
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c) {
+        skipSpace();
+        if (pos_ >= text_.size() || text_[pos_] != c) {
+            fail("unexpected character");
+        }
+        ++pos_;
+    }
+
+    Json parseValue() {
+        skipSpace();
+        if (pos_ >= text_.size()) {
+            fail("unexpected end of input");
+        }
+        const char c = text_[pos_];
+        if (c == '{') {
+            return parseObject();
+        }
+        if (c == '[') {
+            return parseArray();
+        }
+        if (c == '"') {
+            return Json(parseString());
+        }
+        if (consume("true")) {
+            return Json(true);
+        }
+        if (consume("false")) {
+            return Json(false);
+        }
+        if (consume("null")) {
+            return Json();
+        }
+        return Json(parseNumber());
+    }
+
+    Json parseObject() {
+        ++pos_;
+        Json::Object object;
+        skipSpace();
+        if (pos_ < text_.size() && text_[pos_] == '}') {
+            ++pos_;
+            return Json(std::move(object));
+        }
+        for (;;) {
+            skipSpace();
+            if (pos_ >= text_.size() || text_[pos_] != '"') {
+                fail("expected object key");
+            }
+            std::string key = parseString();
+            expect(':');
+            object[std::move(key)] = parseValue();
+            skipSpace();
+            if (pos_ < text_.size() && text_[pos_] == ',') {
+                ++pos_;
+                continue;
+            }
+            expect('}');
+            return Json(std::move(object));
+        }
+    }
+
+    Json parseArray() {
+        ++pos_;
+        Json::Array array;
+        skipSpace();
+        if (pos_ < text_.size() && text_[pos_] == ']') {
+            ++pos_;
+            return Json(std::move(array));
+        }
+        for (;;) {
+            array.push_back(parseValue());
+            skipSpace();
+            if (pos_ < text_.size() && text_[pos_] == ',') {
+                ++pos_;
+                continue;
+            }
+            expect(']');
+            return Json(std::move(array));
+        }
+    }
+
+    static void appendUtf8(std::string& out, std::uint32_t cp) {
+        if (cp < 0x80) {
+            out += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            out += static_cast<char>(0xC0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += static_cast<char>(0xE0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    std::uint32_t parseHex4() {
+        if (pos_ + 4 > text_.size()) {
+            fail("truncated escape");
+        }
+        std::uint32_t v = 0;
+        for (int i = 0; i < 4; ++i) {
+            const char h = text_[pos_++];
+            v <<= 4;
+            if (h >= '0' && h <= '9') {
+                v |= static_cast<std::uint32_t>(h - '0');
+            } else if (h >= 'a' && h <= 'f') {
+                v |= static_cast<std::uint32_t>(h - 'a' + 10);
+            } else if (h >= 'A' && h <= 'F') {
+                v |= static_cast<std::uint32_t>(h - 'A' + 10);
+            } else {
+                fail("bad escape");
+            }
+        }
+        return v;
+    }
+
+    std::string parseString() {
+        ++pos_;
+        std::string out;
+        while (pos_ < text_.size()) {
+            const char c = text_[pos_++];
+            if (c == '"') {
+                return out;
+            }
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos_ >= text_.size()) {
+                break;
+            }
+            const char e = text_[pos_++];
+            switch (e) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                std::uint32_t cp = parseHex4();
+                if (cp >= 0xD800 && cp < 0xDC00 && consume("\\u")) {
+                    const std::uint32_t low = parseHex4();
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                }
+                appendUtf8(out, cp);
+                break;
+            }
+            default: fail("bad escape");
+            }
+        }
+        fail("unterminated string");
+    }
+
+    double parseNumber() {
+        const std::size_t start = pos_;
+        while (pos_ < text_.size() && (std::isdigit(static_cast<unsigned char>(text_[pos_])) || text_[pos_] == '-' ||
+                                       text_[pos_] == '+' || text_[pos_] == '.' || text_[pos_] == 'e' ||
+                                       text_[pos_] == 'E')) {
+            ++pos_;
+        }
+        if (start == pos_) {
+            fail("unexpected character");
+        }
+        const std::string token(text_.substr(start, pos_ - start));
+        char* end = nullptr;
+        const double v = std::strtod(token.c_str(), &end);
+        if (end != token.c_str() + token.size()) {
+            pos_ = start;
+            fail("bad number");
+        }
+        return v;
+    }
+
+    std::string_view text_;
+    std::size_t pos_ = 0;
+};
+
+void dumpString(const std::string& s, std::string& out) {
+    out += '"';
+    for (const char c : s) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+                out += buf;
+            } else {
+                out += c;
+            }
+        }
+    }
+    out += '"';
+}
+
+void newline(std::string& out, int indent, int depth) {
+    if (indent >= 0) {
+        out += '\n';
+        out.append(static_cast<std::size_t>(indent * depth), ' ');
+    }
+}
+
+const Json kNull;
+
+} // namespace
+
+Json Json::parse(std::string_view text) { return Parser(text).parseDocument(); }
+
+bool Json::asBool() const {
+    if (!isBool()) {
+        throw std::runtime_error("json: not a bool");
+    }
+    return std::get<bool>(value_);
+}
+
+double Json::asNumber() const {
+    if (!isNumber()) {
+        throw std::runtime_error("json: not a number");
+    }
+    return std::get<double>(value_);
+}
+
+const std::string& Json::asString() const {
+    if (!isString()) {
+        throw std::runtime_error("json: not a string");
+    }
+    return std::get<std::string>(value_);
+}
+
+const Json::Array& Json::asArray() const {
+    if (!isArray()) {
+        throw std::runtime_error("json: not an array");
+    }
+    return std::get<Array>(value_);
+}
+
+Json::Array& Json::asArray() {
+    if (!isArray()) {
+        throw std::runtime_error("json: not an array");
+    }
+    return std::get<Array>(value_);
+}
+
+const Json::Object& Json::asObject() const {
+    if (!isObject()) {
+        throw std::runtime_error("json: not an object");
+    }
+    return std::get<Object>(value_);
+}
+
+Json::Object& Json::asObject() {
+    if (!isObject()) {
+        throw std::runtime_error("json: not an object");
+    }
+    return std::get<Object>(value_);
+}
+
+const Json& Json::operator[](std::string_view key) const {
+    if (!isObject()) {
+        return kNull;
+    }
+    const Object& o = std::get<Object>(value_);
+    const auto it = o.find(key);
+    return it == o.end() ? kNull : it->second;
+}
+
+bool Json::contains(std::string_view key) const {
+    return isObject() && std::get<Object>(value_).count(key) != 0;
+}
+
+Json& Json::operator[](const std::string& key) {
+    if (isNull()) {
+        value_ = Object{};
+    }
+    return asObject()[key];
+}
+
+void Json::push(Json value) {
+    if (isNull()) {
+        value_ = Array{};
+    }
+    asArray().push_back(std::move(value));
+}
+
+double Json::number(std::string_view key, double fallback) const {
+    const Json& v = (*this)[key];
+    return v.isNumber() ? v.asNumber() : fallback;
+}
+
+std::string Json::string(std::string_view key, std::string fallback) const {
+    const Json& v = (*this)[key];
+    return v.isString() ? v.asString() : fallback;
+}
+
+namespace {
+
+void dumpValue(const Json& v, std::string& out, int indent, int depth) {
+    if (v.isNull()) {
+        out += "null";
+    } else if (v.isBool()) {
+        out += v.asBool() ? "true" : "false";
+    } else if (v.isNumber()) {
+        const double d = v.asNumber();
+        if (!std::isfinite(d)) {
+            out += "null";
+        } else if (d == std::floor(d) && std::fabs(d) < 1e15) {
+            out += std::to_string(static_cast<long long>(d));
+        } else {
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "%.17g", d);
+            out += buf;
+        }
+    } else if (v.isString()) {
+        dumpString(v.asString(), out);
+    } else if (v.isArray()) {
+        const Json::Array& a = v.asArray();
+        out += '[';
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            out += i ? "," : "";
+            newline(out, indent, depth + 1);
+            dumpValue(a[i], out, indent, depth + 1);
+        }
+        if (!a.empty()) {
+            newline(out, indent, depth);
+        }
+        out += ']';
+    } else {
+        const Json::Object& o = v.asObject();
+        out += '{';
+        bool first = true;
+        for (const auto& [key, value] : o) {
+            out += first ? "" : ",";
+            first = false;
+            newline(out, indent, depth + 1);
+            dumpString(key, out);
+            out += indent >= 0 ? ": " : ":";
+            dumpValue(value, out, indent, depth + 1);
+        }
+        if (!o.empty()) {
+            newline(out, indent, depth);
+        }
+        out += '}';
+    }
+}
+
+} // namespace
+
+std::string Json::dump(int indent) const {
+    std::string out;
+    dumpValue(*this, out, indent, 0);
+    return out;
+}
+
+} // namespace rebel::core
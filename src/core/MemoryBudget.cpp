@@ -0,0 +1,111 @@
+#include "rebel/core/MemoryBudget.hpp"
+
+#include "rebel/core/Trace.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace rebel::core {
+
+std::atomic<std::uint64_t> MemoryBudget::clock_{0};
+
+MemoryBudget& MemoryBudget::global() {
+    static MemoryBudget instance([] {
+        const char* env = std::getenv("REBEL_MEMORY_BUDGET");
+        const unsigned long long megabytes = env != nullptr ? std::strtoull(env, nullptr, 10) : 0;
+        return static_cast<std::size_t>(megabytes) << 20;
+    }());
+    return instance;
+}
+
+void MemoryBudget::setLimit(std::size_t limitBytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    limit_ = limitBytes;
+}
+
+std::size_t MemoryBudget::limit() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return limit_;
+}
+
+void MemoryBudget::add(MemoryConsumer* consumer) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (std::find(consumers_.begin(), consumers_.end(), consumer) == consumers_.end()) {
+        consumers_.push_back(consumer);
+    }
+}
+
+void MemoryBudget::remove(MemoryConsumer* consumer) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    consumers_.erase(std::remove(consumers_.begin(), consumers_.end(), consumer), consumers_.end());
+}
+
+std::size_t MemoryBudget::enforce() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::size_t used = 0;
+    for (const MemoryConsumer* c : consumers_) {
+        used += c->memoryBytes();
+    }
+    stats_.usedBytes = used;
+    if (limit_ == 0 || used <= limit_) {
+        return 0;
+    }
+    REBEL_TRACE_ZONE("memory.enforce");
+    ++stats_.overruns;
+
+    struct Candidate {
+        MemoryItem item;
+        std::size_t consumer;
+    };
+    std::vector<Candidate> candidates;
+    std::vector<MemoryItem> items;
+    for (std::size_t c = 0; c < consumers_.size(); ++c) {
+        items.clear();
+        consumers_[c]->evictionCandidates(items);
+        for (const MemoryItem& item : items) {
+            candidates.push_back({item, c});
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Candidate& a, const Candidate& b) { return a.item.lastUse < b.item.lastUse; });
+
+    // Oldest first until the overrun is covered; each consumer then evicts
+    // up to the newest of its items in that prefix.
+    std::vector<std::uint64_t> cut(consumers_.size(), 0);
+    std::size_t planned = 0;
+    for (const Candidate& c : candidates) {
+        if (planned >= used - limit_) {
+            break;
+        }
+        planned += c.item.bytes;
+        cut[c.consumer] = std::max(cut[c.consumer], c.item.lastUse + 1);
+    }
+    std::size_t freed = 0;
+    for (std::size_t c = 0; c < consumers_.size(); ++c) {
+        if (cut[c] > 0) {
+            freed += consumers_[c]->evictOlderThan(cut[c]);
+        }
+    }
+    stats_.usedBytes = used - std::min(used, freed);
+    stats_.evictedBytes += freed;
+    return freed;
+}
+
+std::vector<MemoryUsage> MemoryBudget::usage() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<MemoryUsage> out;
+    out.reserve(consumers_.size());
+    for (const MemoryConsumer* c : consumers_) {
+        out.push_back({std::string(c->memoryName()), c->memoryBytes()});
+    }
+    return out;
+}
+
+MemoryBudgetStats MemoryBudget::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    MemoryBudgetStats s = stats_;
+    s.limitBytes = limit_;
+    return s;
+}
+
+} // namespace rebel::core
@@ -0,0 +1,275 @@
+#include "rebel/core/TaskScheduler.hpp"
+
+#include "rebel/core/Trace.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <utility>
+
+namespace rebel::core {
+namespace {
+
+struct WorkerContext {
+    const TaskScheduler* scheduler = nullptr;
+    int index = -1;
+};
+
+thread_local WorkerContext tlsWorker;
+
+unsigned defaultThreadCount() {
+    if (const char* env = std::getenv("REBEL_THREADS")) {
+        const long n = std::strtol(env, nullptr, 10);
+        if (n > 0) {
+            return static_cast<unsigned>(n);
+        }
+    }
+    const unsigned hw = std::thread::hardware_concurrency();
+    return hw == 0 ? 1 : hw;
+}
+
+std::mutex& globalMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::unique_ptr<TaskScheduler>& globalInstance() {
+    static std::unique_ptr<TaskScheduler> instance;
+    return instance;
+}
+
+} // namespace
+
+TaskScheduler::TaskScheduler(unsigned threadCount) {
+    const unsigned n = threadCount == 0 ? defaultThreadCount() : threadCount;
+    workers_.reserve(n);
+    for (unsigned i = 0; i < n; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (unsigned i = 0; i < n; ++i) {
+        workers_[i]->thread = std::thread([this, i] { workerLoop(i); });
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+        worker->thread.join();
+    }
+}
+
+TaskScheduler& TaskScheduler::global() {
+    std::lock_guard<std::mutex> lock(globalMutex());
+    auto& instance = globalInstance();
+    if (!instance) {
+        instance = std::make_unique<TaskScheduler>();
+    }
+    return *instance;
+}
+
+void TaskScheduler::setGlobalThreadCount(unsigned threadCount) {
+    std::lock_guard<std::mutex> lock(globalMutex());
+    auto& instance = globalInstance();
+    instance.reset();
+    instance = std::make_unique<TaskScheduler>(threadCount);
+}
+
+int TaskScheduler::currentWorkerIndex() {
+    return tlsWorker.index;
+}
+
+void TaskScheduler::submit(Task task) {
+    if (tlsWorker.scheduler == this) {
+        Worker& self = *workers_[static_cast<unsigned>(tlsWorker.index)];
+        std::lock_guard<std::mutex> lock(self.mutex);
+        self.tasks.push_back(std::move(task));
+    } else {
+        std::lock_guard<std::mutex> lock(injectMutex_);
+        injected_.push_back(std::move(task));
+    }
+    // queued_ is published before sleeping_ is read; a worker about to sleep
+    // publishes sleeping_ before re-reading queued_, so one side always sees
+    // the other and no wakeup is lost.
+    queued_.fetch_add(1);
+    if (sleeping_.load() > 0) {
+        { std::lock_guard<std::mutex> lock(sleepMutex_); }
+        wake_.notify_one();
+    }
+}
+
+bool TaskScheduler::popLocal(unsigned index, Task& task) {
+    Worker& self = *workers_[index];
+    std::lock_guard<std::mutex> lock(self.mutex);
+    if (self.tasks.empty()) {
+        return false;
+    }
+    task = std::move(self.tasks.back());
+    self.tasks.pop_back();
+    return true;
+}
+
+bool TaskScheduler::popInjected(Task& task) {
+    std::lock_guard<std::mutex> lock(injectMutex_);
+    if (injected_.empty()) {
+        return false;
+    }
+    task = std::move(injected_.front());
+    injected_.pop_front();
+    return true;
+}
+
+bool TaskScheduler::steal(unsigned thief, Task& task) {
+    const auto n = static_cast<unsigned>(workers_.size());
+    for (unsigned k = 1; k <= n; ++k) {
+        Worker& victim = *workers_[(thief + k) % n];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TaskScheduler::findTask(int self, Task& task) {
+    if (queued_.load(std::memory_order_relaxed) == 0) {
+        return false;
+    }
+    const bool found = (self >= 0 && popLocal(static_cast<unsigned>(self), task)) || popInjected(task) ||
+                       steal(self >= 0 ? static_cast<unsigned>(self) : 0, task);
+    if (found) {
+        queued_.fetch_sub(1);
+    }
+    return found;
+}
+
+bool TaskScheduler::tryRunOne() {
+    const int self = tlsWorker.scheduler == this ? tlsWorker.index : -1;
+    Task task;
+    if (!findTask(self, task)) {
+        return false;
+    }
+    task();
+    return true;
+}
+
+void TaskScheduler::workerLoop(unsigned index) {
+    tlsWorker.scheduler = this;
+    tlsWorker.index = static_cast<int>(index);
+    setTraceThreadName("worker " + std::to_string(index));
+    for (;;) {
+        Task task;
+        if (findTask(static_cast<int>(index), task)) {
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        sleeping_.fetch_add(1);
+        wake_.wait(lock, [this] { return stop_ || queued_.load() > 0; });
+        sleeping_.fetch_sub(1);
+        if (stop_ && queued_.load() == 0) {
+            break;
+        }
+    }
+    tlsWorker = WorkerContext{};
+}
+
+TaskGroup::TaskGroup(TaskScheduler& scheduler, CancellationToken token)
+    : scheduler_(scheduler), token_(std::move(token)), state_(std::make_shared<State>()) {}
+
+TaskGroup::~TaskGroup() {
+    try {
+        wait();
+    } catch (...) {
+        // Errors must be collected with an explicit wait().
+    }
+}
+
+void TaskGroup::run(std::function<void()> fn) {
+    state_->outstanding.fetch_add(1, std::memory_order_relaxed);
+    scheduler_.submit([state = state_, token = token_, cancelled = cancelled_, fn = std::move(fn)] {
+        if (!token.isCancelled() && !cancelled.isCancelled()) {
+            try {
+                fn();
+            } catch (const OperationCancelled&) {
+                // Cooperative cancellation is not an error.
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state->errorMutex);
+                if (!state->error) {
+                    state->error = std::current_exception();
+                }
+                cancelled.cancel();
+            }
+        }
+        state->outstanding.fetch_sub(1, std::memory_order_release);
+    });
+}
+
+void TaskGroup::wait() {
+    unsigned idleSpins = 0;
+    while (state_->outstanding.load(std::memory_order_acquire) > 0) {
+        if (scheduler_.tryRunOne()) {
+            idleSpins = 0;
+        } else if (++idleSpins < 64) {
+            std::this_thread::yield();
+        } else {
+            // Everything left is running elsewhere; back off.
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(state_->errorMutex);
+        error = std::exchange(state_->error, nullptr);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+TaskGraph::NodeId TaskGraph::add(std::function<void()> fn) {
+    auto node = std::make_unique<Node>();
+    node->fn = std::move(fn);
+    nodes_.push_back(std::move(node));
+    return static_cast<NodeId>(nodes_.size() - 1);
+}
+
+void TaskGraph::precede(NodeId before, NodeId after) {
+    if (before >= nodes_.size() || after >= nodes_.size() || before == after) {
+        throw std::invalid_argument("invalid task graph edge");
+    }
+    nodes_[before]->successors.push_back(after);
+    nodes_[after]->predecessors++;
+}
+
+void TaskGraph::schedule(TaskGroup& group, NodeId id) {
+    group.run([this, &group, id] {
+        Node& node = *nodes_[id];
+        node.fn();
+        for (NodeId next : node.successors) {
+            if (nodes_[next]->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                schedule(group, next);
+            }
+        }
+    });
+}
+
+void TaskGraph::run(TaskScheduler& scheduler, const CancellationToken& token) {
+    for (auto& node : nodes_) {
+        node->remaining.store(node->predecessors, std::memory_order_relaxed);
+    }
+    TaskGroup group(scheduler, token);
+    for (NodeId id = 0; id < nodes_.size(); ++id) {
+        if (nodes_[id]->predecessors == 0) {
+            schedule(group, id);
+        }
+    }
+    group.wait();
+}
+
+} // namespace rebel::core
@@ -0,0 +1,200 @@
+#include "rebel/core/Trace.hpp"
+
+#include "rebel/core/Json.hpp"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define REBEL_TRACE_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define REBEL_TRACE_TSC 1
+#endif
+
+namespace rebel::core {
+namespace {
+
+/// One closed zone, a cache line.
+struct TraceEvent {
+    const char* name;
+    std::uint64_t begin;
+    std::uint64_t end;
+    std::uint8_t detailLength;
+    char detail[kTraceDetailLength - 1];
+};
+static_assert(sizeof(TraceEvent) == 64, "trace events should fill one cache line");
+
+/// Single-writer ring owned by one thread. `written` counts every event
+/// ever recorded; the ring holds the last `kTraceEventsPerThread` of them.
+struct ThreadBuffer {
+    std::unique_ptr<TraceEvent[]> events{new TraceEvent[kTraceEventsPerThread]};
+    std::atomic<std::uint64_t> written{0};
+    /// `written` when tracing was last started; older events are stale.
+    std::atomic<std::uint64_t> startMark{0};
+    std::uint32_t threadId = 0;
+    std::string name;
+};
+
+static_assert((kTraceEventsPerThread & (kTraceEventsPerThread - 1)) == 0, "ring size must be a power of two");
+
+/// Buffers outlive their threads so a trace still shows work done by
+/// workers of a pool that has since been replaced.
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+std::uint64_t steadyNanos() {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+/// Clock reading and steady time at load; exports map ticks to time with a
+/// second reading taken then.
+struct ClockOrigin {
+    std::uint64_t ticks = traceClock();
+    std::uint64_t nanos = steadyNanos();
+};
+const ClockOrigin kOrigin;
+
+thread_local ThreadBuffer* tlsBuffer = nullptr;
+thread_local std::string tlsName;
+
+ThreadBuffer& threadBuffer() {
+    if (tlsBuffer == nullptr) {
+        auto buffer = std::make_unique<ThreadBuffer>();
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        buffer->threadId = static_cast<std::uint32_t>(r.buffers.size()) + 1;
+        buffer->name = tlsName.empty() ? "thread " + std::to_string(buffer->threadId) : tlsName;
+        tlsBuffer = buffer.get();
+        r.buffers.push_back(std::move(buffer));
+    }
+    return *tlsBuffer;
+}
+
+/// Microseconds with nanosecond precision, as the trace format expects.
+void writeMicros(std::ostream& out, double nanosDouble) {
+    const auto nanos = static_cast<std::uint64_t>(std::max(nanosDouble, 0.0));
+    char text[32];
+    std::snprintf(text, sizeof(text), "%" PRIu64 ".%03u", nanos / 1000, static_cast<unsigned>(nanos % 1000));
+    out << text;
+}
+
+} // namespace
+
+namespace detail {
+
+void recordTraceEvent(const char* name, std::string_view detail, std::uint64_t begin, std::uint64_t end) {
+    ThreadBuffer& buffer = threadBuffer();
+    const std::uint64_t index = buffer.written.load(std::memory_order_relaxed);
+    TraceEvent& event = buffer.events[index & (kTraceEventsPerThread - 1)];
+    event.name = name;
+    event.begin = begin;
+    event.end = end;
+    event.detailLength = static_cast<std::uint8_t>(detail.size());
+    std::memcpy(event.detail, detail.data(), detail.size());
+    buffer.written.store(index + 1, std::memory_order_release);
+}
+
+} // namespace detail
+
+void startTracing() {
+    Registry& r = registry();
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (const auto& buffer : r.buffers) {
+            buffer->startMark.store(buffer->written.load(std::memory_order_acquire), std::memory_order_relaxed);
+        }
+    }
+    detail::tracing.store(true, std::memory_order_release);
+}
+
+void stopTracing() { detail::tracing.store(false, std::memory_order_release); }
+
+std::uint64_t traceClock() {
+#if defined(REBEL_TRACE_TSC)
+    return __rdtsc();
+#else
+    return steadyNanos();
+#endif
+}
+
+void setTraceThreadName(std::string_view name) {
+    tlsName.assign(name);
+    if (tlsBuffer != nullptr) {
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        tlsBuffer->name = tlsName;
+    }
+}
+
+std::size_t traceEventCount() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::size_t count = 0;
+    for (const auto& buffer : r.buffers) {
+        const std::uint64_t written = buffer->written.load(std::memory_order_acquire);
+        const std::uint64_t start = buffer->startMark.load(std::memory_order_relaxed);
+        count += static_cast<std::size_t>(std::min<std::uint64_t>(written - start, kTraceEventsPerThread));
+    }
+    return count;
+}
+
+void writeChromeTrace(std::ostream& out) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    const std::uint64_t ticks = traceClock();
+    const std::uint64_t nanos = steadyNanos();
+    const double elapsedTicks = static_cast<double>(ticks - kOrigin.ticks);
+    const double nanosPerTick = ticks > kOrigin.ticks ? static_cast<double>(nanos - kOrigin.nanos) / elapsedTicks : 1.0;
+    const auto toNanos = [&](std::uint64_t t) {
+        return static_cast<double>(static_cast<std::int64_t>(t - kOrigin.ticks)) * nanosPerTick;
+    };
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    out << R"({"name":"process_name","ph":"M","pid":1,"tid":0,"args":{"name":"rebelcad"}})";
+    for (const auto& buffer : r.buffers) {
+        out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId
+            << ",\"args\":{\"name\":" << Json(buffer->name).dump() << "}}";
+        const std::uint64_t written = buffer->written.load(std::memory_order_acquire);
+        const std::uint64_t start = std::max(buffer->startMark.load(std::memory_order_relaxed),
+                                             written > kTraceEventsPerThread ? written - kTraceEventsPerThread : 0);
+        for (std::uint64_t i = start; i < written; ++i) {
+            const TraceEvent& event = buffer->events[i & (kTraceEventsPerThread - 1)];
+            out << ",\n{\"name\":" << Json(event.name).dump() << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+                << ",\"ts\":";
+            writeMicros(out, toNanos(event.begin));
+            out << ",\"dur\":";
+            writeMicros(out, static_cast<double>(event.end - event.begin) * nanosPerTick);
+            if (event.detailLength > 0) {
+                out << ",\"args\":{\"detail\":" << Json(std::string(event.detail, event.detailLength)).dump() << '}';
+            }
+            out << '}';
+        }
+    }
+    out << "\n]}\n";
+}
+
+bool writeChromeTrace(const std::string& path) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        return false;
+    }
+    writeChromeTrace(out);
+    return static_cast<bool>(out);
+}
+
+} // namespace rebel::core
@@ -0,0 +1,50 @@
+#include "rebel/feature/Feature.hpp"
+
+#include <type_traits>
+#include <utility>
+
+namespace rebel::feature {
+
+void Parameters::hashInto(core::Hasher& hasher) const {
+    hasher.add(static_cast<std::uint64_t>(values_.size()));
+    for (const auto& [name, value] : values_) {
+        hasher.addString(name);
+        hasher.add(static_cast<std::uint8_t>(value.index()));
+        std::visit(
+            [&](const auto& v) {
+                using T = std::decay_t<decltype(v)>;
+                if constexpr (std::is_same_v<T, double>) {
+                    hasher.addDouble(v);
+                } else if constexpr (std::is_same_v<T, std::string>) {
+                    hasher.addString(v);
+                } else {
+                    hasher.add(v);
+                }
+            },
+            value);
+    }
+}
+
+core::Hash128 hashMesh(const geometry::MeshView& mesh) {
+    core::Hasher hasher;
+    hasher.add(static_cast<std::uint64_t>(mesh.vertexCount));
+    hasher.add(static_cast<std::uint64_t>(mesh.triangleCount));
+    hasher.addBytes(mesh.px, mesh.vertexCount * sizeof(float));
+    hasher.addBytes(mesh.py, mesh.vertexCount * sizeof(float));
+    hasher.addBytes(mesh.pz, mesh.vertexCount * sizeof(float));
+    hasher.addBytes(mesh.corners, mesh.triangleCount * 3 * sizeof(geometry::VertexIndex));
+    return hasher.finish();
+}
+
+MeshResult::MeshResult(geometry::Mesh mesh) : mesh_(std::move(mesh)), hash_(hashMesh(mesh_.view())) {}
+
+ValueResult::ValueResult(std::vector<double> values) : values_(std::move(values)) {
+    core::Hasher hasher;
+    hasher.add(static_cast<std::uint64_t>(values_.size()));
+    for (double v : values_) {
+        hasher.addDouble(v);
+    }
+    hash_ = hasher.finish();
+}
+
+} // namespace rebel::feature
@@ -0,0 +1,313 @@
+#include "rebel/feature/FeatureGraph.hpp"
+
+#include "rebel/core/Trace.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+namespace rebel::feature {
+
+FeatureId FeatureGraph::add(std::string name, FeatureOpPtr op, Parameters parameters,
+                            std::vector<FeatureId> inputs) {
+    if (!op) {
+        throw std::invalid_argument("feature '" + name + "' has no operation");
+    }
+    const auto id = static_cast<FeatureId>(nodes_.size());
+    for (FeatureId input : inputs) {
+        if (input >= id) {
+            throw std::invalid_argument("feature '" + name + "' refers to an unknown input");
+        }
+    }
+    Node node;
+    node.name = std::move(name);
+    node.op = std::move(op);
+    node.parameters = std::move(parameters);
+    node.inputs = std::move(inputs);
+    nodes_.push_back(std::move(node));
+    for (FeatureId input : nodes_[id].inputs) {
+        nodes_[input].dependents.push_back(id);
+    }
+    return id;
+}
+
+void FeatureGraph::markDirty(FeatureId id) {
+    Node& node = nodes_.at(id);
+    node.dirty = true;
+    node.state = FeatureState::Dirty;
+}
+
+void FeatureGraph::setParameter(FeatureId id, const std::string& name, ParameterValue value) {
+    Node& node = nodes_.at(id);
+    if (node.parameters.has(name) && node.parameters.get(name) == value) {
+        return;
+    }
+    node.parameters.set(name, std::move(value));
+    markDirty(id);
+}
+
+void FeatureGraph::setParameters(FeatureId id, Parameters parameters) {
+    Node& node = nodes_.at(id);
+    if (node.parameters == parameters) {
+        return;
+    }
+    node.parameters = std::move(parameters);
+    markDirty(id);
+}
+
+bool FeatureGraph::reaches(FeatureId from, FeatureId to) const {
+    std::vector<FeatureId> stack{from};
+    std::vector<bool> seen(nodes_.size(), false);
+    while (!stack.empty()) {
+        const FeatureId f = stack.back();
+        stack.pop_back();
+        if (f == to) {
+            return true;
+        }
+        if (seen[f]) {
+            continue;
+        }
+        seen[f] = true;
+        for (FeatureId d : nodes_[f].dependents) {
+            stack.push_back(d);
+        }
+    }
+    return false;
+}
+
+void FeatureGraph::setInputs(FeatureId id, std::vector<FeatureId> inputs) {
+    Node& node = nodes_.at(id);
+    for (FeatureId input : inputs) {
+        if (input >= nodes_.size()) {
+            throw std::invalid_argument("feature '" + node.name + "' refers to an unknown input");
+        }
+        if (reaches(id, input)) {
+            throw std::invalid_argument("rewiring feature '" + node.name + "' would create a cycle");
+        }
+    }
+    for (FeatureId old : node.inputs) {
+        auto& deps = nodes_[old].dependents;
+        deps.erase(std::find(deps.begin(), deps.end(), id));
+    }
+    node.inputs = std::move(inputs);
+    for (FeatureId input : node.inputs) {
+        nodes_[input].dependents.push_back(id);
+    }
+    markDirty(id);
+}
+
+void FeatureGraph::invalidate(FeatureId id) {
+    markDirty(id);
+    nodes_[id].forced = true;
+}
+
+void FeatureGraph::release(FeatureId id) {
+    markDirty(id);
+    nodes_[id].result.reset();
+}
+
+bool FeatureGraph::needsRegeneration() const {
+    return std::any_of(nodes_.begin(), nodes_.end(), [](const Node& n) { return n.dirty; });
+}
+
+std::vector<std::vector<FeatureId>> FeatureGraph::pendingWaves() const {
+    const std::size_t n = nodes_.size();
+    // Affected cone: dirty features and everything downstream of them.
+    std::vector<bool> affected(n, false);
+    std::vector<FeatureId> stack;
+    for (FeatureId id = 0; id < n; ++id) {
+        if (nodes_[id].dirty) {
+            stack.push_back(id);
+        }
+    }
+    while (!stack.empty()) {
+        const FeatureId f = stack.back();
+        stack.pop_back();
+        if (affected[f]) {
+            continue;
+        }
+        affected[f] = true;
+        for (FeatureId d : nodes_[f].dependents) {
+            stack.push_back(d);
+        }
+    }
+
+    // Kahn's algorithm restricted to the cone; each frontier is one wave.
+    std::vector<std::uint32_t> pendingInputs(n, 0);
+    std::vector<FeatureId> frontier;
+    for (FeatureId id = 0; id < n; ++id) {
+        if (!affected[id]) {
+            continue;
+        }
+        for (FeatureId input : nodes_[id].inputs) {
+            pendingInputs[id] += affected[input] ? 1 : 0;
+        }
+        if (pendingInputs[id] == 0) {
+            frontier.push_back(id);
+        }
+    }
+    std::vector<std::vector<FeatureId>> waves;
+    while (!frontier.empty()) {
+        std::vector<FeatureId> next;
+        for (FeatureId f : frontier) {
+            for (FeatureId d : nodes_[f].dependents) {
+                if (--pendingInputs[d] == 0) {
+                    next.push_back(d);
+                }
+            }
+        }
+        waves.push_back(std::move(frontier));
+        frontier = std::move(next);
+    }
+    return waves;
+}
+
+std::vector<FeatureId> FeatureGraph::topologicalOrder() const {
+    std::vector<FeatureId> order;
+    order.reserve(nodes_.size());
+    std::vector<std::uint32_t> pendingInputs(nodes_.size());
+    for (FeatureId id = 0; id < nodes_.size(); ++id) {
+        pendingInputs[id] = static_cast<std::uint32_t>(nodes_[id].inputs.size());
+        if (pendingInputs[id] == 0) {
+            order.push_back(id);
+        }
+    }
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        for (FeatureId d : nodes_[order[i]].dependents) {
+            if (--pendingInputs[d] == 0) {
+                order.push_back(d);
+            }
+        }
+    }
+    return order;
+}
+
+core::Hash128 FeatureGraph::computeInputHash(FeatureId id) const {
+    const Node& node = nodes_.at(id);
+    core::Hasher hasher;
+    hasher.addString(node.op->type());
+    hasher.add(node.op->version());
+    node.parameters.hashInto(hasher);
+    hasher.add(static_cast<std::uint64_t>(node.inputs.size()));
+    for (FeatureId input : node.inputs) {
+        const ResultPtr& r = nodes_[input].result;
+        hasher.addHash(r ? r->contentHash() : core::Hash128{});
+    }
+    return hasher.finish();
+}
+
+void FeatureGraph::regenerateFeature(FeatureId id, RegenerationStats& stats) {
+    Node& node = nodes_.at(id);
+    ++stats.visited;
+    node.dirty = false;
+    const bool forced = std::exchange(node.forced, false);
+
+    std::vector<ResultPtr> inputResults;
+    inputResults.reserve(node.inputs.size());
+    for (FeatureId input : node.inputs) {
+        const Node& in = nodes_[input];
+        if (in.state == FeatureState::Failed || !in.result) {
+            node.state = FeatureState::Failed;
+            node.error = "input '" + in.name + "' failed";
+            node.result.reset();
+            node.inputHash = {};
+            ++stats.failed;
+            return;
+        }
+        inputResults.push_back(in.result);
+    }
+
+    const core::Hash128 hash = computeInputHash(id);
+    if (!forced && node.result && hash == node.inputHash) {
+        node.state = FeatureState::UpToDate;
+        ++stats.reused;
+        return;
+    }
+
+    if (cache_ && !forced) {
+        if (ResultPtr cached = cache_->find(hash)) {
+            node.result = std::move(cached);
+            node.inputHash = hash;
+            node.state = FeatureState::UpToDate;
+            node.error.clear();
+            ++stats.cached;
+            return;
+        }
+    }
+
+    try {
+        REBEL_TRACE_ZONE_DETAIL("feature.evaluate", node.name);
+        ResultPtr result = node.op->evaluate(node.parameters, inputResults);
+        if (!result) {
+            throw std::runtime_error("operation returned no result");
+        }
+        if (cache_) {
+            cache_->store(hash, result);
+        }
+        node.result = std::move(result);
+        node.inputHash = hash;
+        node.state = FeatureState::UpToDate;
+        node.error.clear();
+        ++stats.evaluated;
+    } catch (const std::exception& e) {
+        node.state = FeatureState::Failed;
+        node.error = e.what();
+        node.result.reset();
+        node.inputHash = {};
+        ++stats.failed;
+    }
+}
+
+RegenerationStats FeatureGraph::regenerate(const core::CancellationToken& token) {
+    REBEL_TRACE_ZONE("feature.regenerate");
+    RegenerationStats stats;
+    const std::vector<std::vector<FeatureId>> waves = pendingWaves();
+    std::vector<std::uint8_t> reached(nodes_.size(), 0);
+    core::TaskScheduler& scheduler = core::TaskScheduler::global();
+    std::mutex statsMutex;
+    for (const std::vector<FeatureId>& wave : waves) {
+        if (token.isCancelled()) {
+            break;
+        }
+        if (wave.size() == 1 || scheduler.threadCount() <= 1) {
+            for (FeatureId id : wave) {
+                if (token.isCancelled()) {
+                    break;
+                }
+                reached[id] = 1;
+                regenerateFeature(id, stats);
+            }
+            continue;
+        }
+        // Features of one wave are independent; each task only writes its own
+        // node and reads results of earlier waves.
+        core::TaskGroup group(scheduler, token);
+        for (FeatureId id : wave) {
+            group.run([this, id, &reached, &stats, &statsMutex] {
+                reached[id] = 1;
+                RegenerationStats local;
+                regenerateFeature(id, local);
+                std::lock_guard<std::mutex> lock(statsMutex);
+                stats.merge(local);
+            });
+        }
+        group.wait();
+    }
+
+    if (token.isCancelled()) {
+        stats.cancelled = true;
+        // Keep the unreached part of the cone dirty so the next run resumes
+        // it; features visited above may have changed their results.
+        for (const std::vector<FeatureId>& wave : waves) {
+            for (FeatureId id : wave) {
+                if (!reached[id]) {
+                    markDirty(id);
+                }
+            }
+        }
+    }
+    return stats;
+}
+
+} // namespace rebel::feature
@@ -0,0 +1,444 @@
+#include "rebel/feature/ResultCache.hpp"
+
+#include "rebel/core/Trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+namespace rebel::feature {
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr char kMagic[4] = {'R', 'B', 'R', 'C'};
+constexpr std::uint32_t kFormatVersion = 2;
+constexpr const char* kExtension = ".rbr";
+
+enum class Kind : std::uint32_t {
+    Mesh = 1,
+    Values = 2,
+};
+
+constexpr std::uint32_t kNormals = 1u << 0;
+constexpr std::uint32_t kUvs = 1u << 1;
+constexpr std::uint32_t kConnectivity = 1u << 2;
+
+/// Entry file header; the payload follows. `content` is the result's
+/// content hash, re-derived and compared on load; `payload` hashes the
+/// payload bytes and also covers what the content hash leaves out, such
+/// as normals and texture coordinates.
+struct BlobHeader {
+    char magic[4];
+    std::uint32_t version;
+    Kind kind;
+    std::uint32_t flags;
+    std::uint64_t payloadSize;
+    std::uint64_t contentLo;
+    std::uint64_t contentHi;
+    std::uint64_t payloadLo;
+    std::uint64_t payloadHi;
+};
+
+/// Bookkeeping charged per memory entry on top of the result's arrays.
+constexpr std::size_t kEntryOverhead = 128;
+
+std::size_t resultBytes(const FeatureResult& result) {
+    if (const auto* mesh = dynamic_cast<const MeshResult*>(&result)) {
+        return mesh->mesh().memoryBytes() + kEntryOverhead;
+    }
+    if (const auto* values = dynamic_cast<const ValueResult*>(&result)) {
+        return values->values().size() * sizeof(double) + kEntryOverhead;
+    }
+    return kEntryOverhead;
+}
+
+class Writer {
+public:
+    explicit Writer(std::vector<std::uint8_t>& out) : out_(out) {}
+
+    void bytes(const void* data, std::size_t size) {
+        const auto* p = static_cast<const std::uint8_t*>(data);
+        out_.insert(out_.end(), p, p + size);
+    }
+    template <typename T>
+    void value(const T& v) {
+        bytes(&v, sizeof(T));
+    }
+
+private:
+    std::vector<std::uint8_t>& out_;
+};
+
+class Reader {
+public:
+    Reader(const std::uint8_t* data, std::size_t size) : data_(data), size_(size) {}
+
+    bool bytes(void* out, std::size_t size) {
+        if (size > size_ - offset_) {
+            return false;
+        }
+        std::memcpy(out, data_ + offset_, size);
+        offset_ += size;
+        return true;
+    }
+    template <typename T>
+    bool value(T& v) {
+        return bytes(&v, sizeof(T));
+    }
+    std::size_t remaining() const { return size_ - offset_; }
+
+private:
+    const std::uint8_t* data_;
+    std::size_t size_;
+    std::size_t offset_ = 0;
+};
+
+ResultPtr decodeMesh(Reader& in, std::uint32_t flags) {
+    std::uint64_t vertices = 0;
+    std::uint64_t triangles = 0;
+    if (!in.value(vertices) || !in.value(triangles)) {
+        return nullptr;
+    }
+    const std::uint64_t floatsPerVertex = 3 + ((flags & kNormals) ? 3 : 0) + ((flags & kUvs) ? 2 : 0);
+    if (vertices > in.remaining() / sizeof(float) / floatsPerVertex ||
+        triangles > in.remaining() / sizeof(geometry::VertexIndex) / 3 ||
+        vertices * floatsPerVertex * sizeof(float) + triangles * 3 * sizeof(geometry::VertexIndex) != in.remaining()) {
+        return nullptr;
+    }
+    geometry::Mesh mesh;
+    if (flags & kNormals) {
+        mesh.enableNormals();
+    }
+    if (flags & kUvs) {
+        mesh.enableUvs();
+    }
+    mesh.resizeVertices(vertices);
+    mesh.resizeTriangles(triangles);
+    const std::size_t floats = vertices * sizeof(float);
+    in.bytes(mesh.px(), floats);
+    in.bytes(mesh.py(), floats);
+    in.bytes(mesh.pz(), floats);
+    if (flags & kNormals) {
+        in.bytes(mesh.nx(), floats);
+        in.bytes(mesh.ny(), floats);
+        in.bytes(mesh.nz(), floats);
+    }
+    if (flags & kUvs) {
+        in.bytes(mesh.u(), floats);
+        in.bytes(mesh.v(), floats);
+    }
+    in.bytes(mesh.corners(), triangles * 3 * sizeof(geometry::VertexIndex));
+    for (std::uint64_t c = 0; c < 3 * triangles; ++c) {
+        if (mesh.corners()[c] >= vertices) {
+            return nullptr;
+        }
+    }
+    if (flags & kConnectivity) {
+        mesh.buildConnectivity();
+    }
+    return std::make_shared<MeshResult>(std::move(mesh));
+}
+
+ResultPtr decodeValues(Reader& in) {
+    std::uint64_t count = 0;
+    if (!in.value(count) || count != in.remaining() / sizeof(double) || in.remaining() % sizeof(double) != 0) {
+        return nullptr;
+    }
+    std::vector<double> values(count);
+    in.bytes(values.data(), count * sizeof(double));
+    return std::make_shared<ValueResult>(std::move(values));
+}
+
+bool readFile(const std::string& path, std::vector<std::uint8_t>& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    out.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return !in.bad();
+}
+
+/// Unique temporary name next to `path`, so concurrent writers of the
+/// same entry (threads or machines) never share a file.
+std::string temporaryPath(const std::string& path) {
+    static std::atomic<std::uint64_t> counter{0};
+    core::Hasher hasher;
+    hasher.add(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    hasher.add(counter.fetch_add(1));
+    hasher.add(static_cast<std::uint64_t>(fs::file_time_type::clock::now().time_since_epoch().count()));
+    return path + "." + hasher.finish().toHex().substr(0, 16) + ".tmp";
+}
+
+} // namespace
+
+ResultCache::ResultCache(ResultCacheOptions options) : options_(std::move(options)) {
+    if (options_.budget != nullptr) {
+        options_.budget->add(this);
+    }
+}
+
+ResultCache::~ResultCache() {
+    if (options_.budget != nullptr) {
+        options_.budget->remove(this);
+    }
+}
+
+bool ResultCache::encode(const FeatureResult& result, std::vector<std::uint8_t>& out) {
+    BlobHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFormatVersion;
+    const core::Hash128 content = result.contentHash();
+    header.contentLo = content.lo;
+    header.contentHi = content.hi;
+
+    std::vector<std::uint8_t> payload;
+    Writer w(payload);
+    if (const auto* meshResult = dynamic_cast<const MeshResult*>(&result)) {
+        const geometry::MeshView mesh = meshResult->mesh().view();
+        header.kind = Kind::Mesh;
+        header.flags = (mesh.hasNormals() ? kNormals : 0u) | (mesh.hasUvs() ? kUvs : 0u) |
+                       (mesh.hasConnectivity() ? kConnectivity : 0u);
+        w.value(static_cast<std::uint64_t>(mesh.vertexCount));
+        w.value(static_cast<std::uint64_t>(mesh.triangleCount));
+        const std::size_t floats = mesh.vertexCount * sizeof(float);
+        w.bytes(mesh.px, floats);
+        w.bytes(mesh.py, floats);
+        w.bytes(mesh.pz, floats);
+        if (mesh.hasNormals()) {
+            w.bytes(mesh.nx, floats);
+            w.bytes(mesh.ny, floats);
+            w.bytes(mesh.nz, floats);
+        }
+        if (mesh.hasUvs()) {
+            w.bytes(mesh.u, floats);
+            w.bytes(mesh.v, floats);
+        }
+        w.bytes(mesh.corners, mesh.triangleCount * 3 * sizeof(geometry::VertexIndex));
+    } else if (const auto* valueResult = dynamic_cast<const ValueResult*>(&result)) {
+        header.kind = Kind::Values;
+        const std::vector<double>& values = valueResult->values();
+        w.value(static_cast<std::uint64_t>(values.size()));
+        w.bytes(values.data(), values.size() * sizeof(double));
+    } else {
+        return false;
+    }
+    header.payloadSize = payload.size();
+    const core::Hash128 payloadHash = core::hashBytes(payload.data(), payload.size());
+    header.payloadLo = payloadHash.lo;
+    header.payloadHi = payloadHash.hi;
+    out.clear();
+    out.reserve(sizeof(header) + payload.size());
+    Writer(out).value(header);
+    out.insert(out.end(), payload.begin(), payload.end());
+    return true;
+}
+
+ResultPtr ResultCache::decode(const std::uint8_t* data, std::size_t size) {
+    Reader in(data, size);
+    BlobHeader header;
+    if (!in.value(header) || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.version != kFormatVersion || header.payloadSize != in.remaining() ||
+        core::hashBytes(data + sizeof(header), header.payloadSize) !=
+            core::Hash128{header.payloadLo, header.payloadHi}) {
+        return nullptr;
+    }
+    ResultPtr result;
+    switch (header.kind) {
+    case Kind::Mesh:
+        result = decodeMesh(in, header.flags);
+        break;
+    case Kind::Values:
+        result = decodeValues(in);
+        break;
+    }
+    if (!result || result->contentHash() != core::Hash128{header.contentLo, header.contentHi}) {
+        return nullptr;
+    }
+    return result;
+}
+
+std::string ResultCache::pathOf(const core::Hash128& key) const {
+    const std::string hex = key.toHex();
+    return (fs::path(options_.directory) / hex.substr(0, 2) / (hex + kExtension)).string();
+}
+
+void ResultCache::insertLocked(const core::Hash128& key, const ResultPtr& result) {
+    if (entries_.count(key) != 0) {
+        return;
+    }
+    const std::size_t bytes = resultBytes(*result);
+    if (bytes > options_.memoryBytes) {
+        return;
+    }
+    lru_.push_front(key);
+    entries_[key] = {result, bytes, core::MemoryBudget::stamp(), lru_.begin()};
+    stats_.memoryBytes += bytes;
+    while (stats_.memoryBytes > options_.memoryBytes) {
+        const auto victim = entries_.find(lru_.back());
+        stats_.memoryBytes -= victim->second.bytes;
+        entries_.erase(victim);
+        lru_.pop_back();
+    }
+}
+
+ResultPtr ResultCache::find(const core::Hash128& key) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto it = entries_.find(key);
+        if (it != entries_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second.lru);
+            it->second.lastUse = core::MemoryBudget::stamp();
+            ++stats_.memoryHits;
+            return it->second.result;
+        }
+    }
+    if (!options_.directory.empty()) {
+        REBEL_TRACE_ZONE("cache.load");
+        const std::string path = pathOf(key);
+        std::vector<std::uint8_t> data;
+        if (readFile(path, data)) {
+            ResultPtr result = decode(data.data(), data.size());
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (result) {
+                ++stats_.diskHits;
+                insertLocked(key, result);
+            } else {
+                ++stats_.corrupt;
+                ++stats_.misses;
+            }
+            if (result && !options_.readOnly) {
+                std::error_code ec;
+                fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+            }
+            return result;
+        }
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.misses;
+    return nullptr;
+}
+
+void ResultCache::store(const core::Hash128& key, const ResultPtr& result) {
+    if (!result) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.stores;
+        insertLocked(key, result);
+    }
+    if (options_.directory.empty() || options_.readOnly) {
+        return;
+    }
+    REBEL_TRACE_ZONE("cache.store");
+    // The cache is an optimization: any I/O failure just leaves the entry
+    // out of the persistent tier.
+    const std::string path = pathOf(key);
+    std::error_code ec;
+    if (fs::exists(path, ec)) {
+        return;
+    }
+    std::vector<std::uint8_t> data;
+    if (!encode(*result, data)) {
+        return;
+    }
+    fs::create_directories(fs::path(path).parent_path(), ec);
+    const std::string temporary = temporaryPath(path);
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!out) {
+            out.close();
+            fs::remove(temporary, ec);
+            return;
+        }
+    }
+    fs::rename(temporary, path, ec);
+    if (ec) {
+        fs::remove(temporary, ec);
+    }
+}
+
+std::size_t ResultCache::memoryBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_.memoryBytes;
+}
+
+void ResultCache::evictionCandidates(std::vector<core::MemoryItem>& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& entry : entries_) {
+        out.push_back({entry.second.lastUse, entry.second.bytes});
+    }
+}
+
+std::size_t ResultCache::evictOlderThan(std::uint64_t stamp) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Use stamps grow from the back of the recency list to its front.
+    std::size_t freed = 0;
+    while (!lru_.empty()) {
+        const auto victim = entries_.find(lru_.back());
+        if (victim->second.lastUse >= stamp) {
+            break;
+        }
+        freed += victim->second.bytes;
+        entries_.erase(victim);
+        lru_.pop_back();
+    }
+    stats_.memoryBytes -= freed;
+    return freed;
+}
+
+void ResultCache::clearMemory() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    lru_.clear();
+    stats_.memoryBytes = 0;
+}
+
+std::uintmax_t ResultCache::pruneDisk(std::uintmax_t maxBytes) {
+    if (options_.directory.empty() || options_.readOnly) {
+        return 0;
+    }
+    struct File {
+        fs::file_time_type time;
+        std::uintmax_t size;
+        fs::path path;
+    };
+    std::vector<File> files;
+    std::uintmax_t total = 0;
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(options_.directory, ec), end; !ec && it != end; it.increment(ec)) {
+        std::error_code fileEc;
+        if (!it->is_regular_file(fileEc) || it->path().extension() != kExtension) {
+            continue;
+        }
+        File f{it->last_write_time(fileEc), it->file_size(fileEc), it->path()};
+        if (!fileEc) {
+            total += f.size;
+            files.push_back(std::move(f));
+        }
+    }
+    std::sort(files.begin(), files.end(), [](const File& a, const File& b) { return a.time < b.time; });
+    std::uintmax_t removed = 0;
+    for (const File& f : files) {
+        if (total - removed <= maxBytes) {
+            break;
+        }
+        if (fs::remove(f.path, ec)) {
+            removed += f.size;
+        }
+    }
+    return removed;
+}
+
+ResultCacheStats ResultCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+} // namespace rebel::feature
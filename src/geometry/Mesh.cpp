@@ -0,0 +1,238 @@
+#include "rebel/geometry/Mesh.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace rebel::geometry {
+
+using math::Aabb;
+using math::Vec3f;
+
+Aabb MeshView::bounds() const {
+    Aabb box;
+    if (vertexCount == 0) {
+        return box;
+    }
+    // One pass per component keeps each loop a straight min/max reduction
+    // over a single contiguous array, which compilers vectorize.
+    float lo[3] = {px[0], py[0], pz[0]};
+    float hi[3] = {px[0], py[0], pz[0]};
+    const float* comps[3] = {px, py, pz};
+    for (int axis = 0; axis < 3; ++axis) {
+        const float* c = comps[axis];
+        float mn = lo[axis];
+        float mx = hi[axis];
+        for (std::size_t i = 1; i < vertexCount; ++i) {
+            mn = c[i] < mn ? c[i] : mn;
+            mx = c[i] > mx ? c[i] : mx;
+        }
+        lo[axis] = mn;
+        hi[axis] = mx;
+    }
+    box.min = {lo[0], lo[1], lo[2]};
+    box.max = {hi[0], hi[1], hi[2]};
+    return box;
+}
+
+Aabb MeshView::triangleBounds(TriangleIndex t) const {
+    Aabb box;
+    box.expand(position(corners[3 * t]));
+    box.expand(position(corners[3 * t + 1]));
+    box.expand(position(corners[3 * t + 2]));
+    return box;
+}
+
+void Mesh::reserve(std::size_t vertices, std::size_t triangles) {
+    px_.reserve(vertices);
+    py_.reserve(vertices);
+    pz_.reserve(vertices);
+    if (hasNormals()) {
+        nx_.reserve(vertices);
+        ny_.reserve(vertices);
+        nz_.reserve(vertices);
+    }
+    if (hasUvs()) {
+        u_.reserve(vertices);
+        v_.reserve(vertices);
+    }
+    corners_.reserve(triangles * 3);
+}
+
+void Mesh::clear() {
+    px_.clear();
+    py_.clear();
+    pz_.clear();
+    nx_.clear();
+    ny_.clear();
+    nz_.clear();
+    u_.clear();
+    v_.clear();
+    corners_.clear();
+    opposites_.clear();
+    hasNormals_ = false;
+    hasUvs_ = false;
+}
+
+VertexIndex Mesh::addVertex(const Vec3f& position) {
+    const auto index = static_cast<VertexIndex>(px_.size());
+    px_.push_back(position.x);
+    py_.push_back(position.y);
+    pz_.push_back(position.z);
+    if (hasNormals()) {
+        nx_.push_back(0.0f);
+        ny_.push_back(0.0f);
+        nz_.push_back(0.0f);
+    }
+    if (hasUvs()) {
+        u_.push_back(0.0f);
+        v_.push_back(0.0f);
+    }
+    return index;
+}
+
+TriangleIndex Mesh::addTriangle(VertexIndex a, VertexIndex b, VertexIndex c) {
+    const auto index = static_cast<TriangleIndex>(triangleCount());
+    corners_.push_back(a);
+    corners_.push_back(b);
+    corners_.push_back(c);
+    invalidateConnectivity();
+    return index;
+}
+
+void Mesh::resizeVertices(std::size_t count) {
+    px_.resize(count, 0.0f);
+    py_.resize(count, 0.0f);
+    pz_.resize(count, 0.0f);
+    if (hasNormals()) {
+        nx_.resize(count, 0.0f);
+        ny_.resize(count, 0.0f);
+        nz_.resize(count, 0.0f);
+    }
+    if (hasUvs()) {
+        u_.resize(count, 0.0f);
+        v_.resize(count, 0.0f);
+    }
+}
+
+void Mesh::resizeTriangles(std::size_t count) {
+    corners_.resize(count * 3, 0);
+    invalidateConnectivity();
+}
+
+void Mesh::enableNormals() {
+    if (!hasNormals_) {
+        nx_.assign(vertexCount(), 0.0f);
+        ny_.assign(vertexCount(), 0.0f);
+        nz_.assign(vertexCount(), 0.0f);
+        hasNormals_ = true;
+    }
+}
+
+void Mesh::enableUvs() {
+    if (!hasUvs_) {
+        u_.assign(vertexCount(), 0.0f);
+        v_.assign(vertexCount(), 0.0f);
+        hasUvs_ = true;
+    }
+}
+
+std::size_t Mesh::buildConnectivity() {
+    const std::size_t cornerCount = corners_.size();
+    opposites_.assign(cornerCount, kInvalidIndex);
+
+    // Corner c is opposite the edge (vertex(next(c)), vertex(prev(c))). Sort
+    // the undirected edge keys so the two corners facing each edge become
+    // neighbours; this is O(n log n) with no per-edge allocation.
+    std::vector<std::pair<std::uint64_t, CornerIndex>> edges(cornerCount);
+    for (CornerIndex c = 0; c < cornerCount; ++c) {
+        const std::uint64_t a = corners_[nextCorner(c)];
+        const std::uint64_t b = corners_[prevCorner(c)];
+        const std::uint64_t key = a < b ? (a << 32) | b : (b << 32) | a;
+        edges[c] = {key, c};
+    }
+    std::sort(edges.begin(), edges.end());
+
+    std::size_t nonManifold = 0;
+    for (std::size_t i = 0; i < edges.size();) {
+        std::size_t j = i + 1;
+        while (j < edges.size() && edges[j].first == edges[i].first) {
+            ++j;
+        }
+        const CornerIndex c0 = edges[i].second;
+        const CornerIndex c1 = j - i == 2 ? edges[i + 1].second : kInvalidIndex;
+        // Consistently wound neighbours traverse their shared edge in
+        // opposite directions; two triangles using it the same way are
+        // wound inconsistently and cannot be walked across.
+        if (c1 != kInvalidIndex && corners_[nextCorner(c0)] == corners_[prevCorner(c1)]) {
+            opposites_[c0] = c1;
+            opposites_[c1] = c0;
+        } else if (j - i >= 2) {
+            ++nonManifold;
+        }
+        i = j;
+    }
+    return nonManifold;
+}
+
+void Mesh::computeVertexNormals() {
+    hasNormals_ = true;
+    nx_.assign(vertexCount(), 0.0f);
+    ny_.assign(vertexCount(), 0.0f);
+    nz_.assign(vertexCount(), 0.0f);
+
+    const std::size_t triangles = triangleCount();
+    for (std::size_t t = 0; t < triangles; ++t) {
+        const VertexIndex a = corners_[3 * t];
+        const VertexIndex b = corners_[3 * t + 1];
+        const VertexIndex c = corners_[3 * t + 2];
+        // The unnormalized cross product is twice the triangle area, which
+        // gives the area weighting for free.
+        const Vec3f n = math::cross(position(b) - position(a), position(c) - position(a));
+        for (VertexIndex idx : {a, b, c}) {
+            nx_[idx] += n.x;
+            ny_[idx] += n.y;
+            nz_[idx] += n.z;
+        }
+    }
+
+    const std::size_t vertices = vertexCount();
+    for (std::size_t i = 0; i < vertices; ++i) {
+        const float len = std::sqrt(nx_[i] * nx_[i] + ny_[i] * ny_[i] + nz_[i] * nz_[i]);
+        const float inv = len > 0.0f ? 1.0f / len : 0.0f;
+        nx_[i] *= inv;
+        ny_[i] *= inv;
+        nz_[i] *= inv;
+    }
+}
+
+std::size_t Mesh::memoryBytes() const {
+    return (px_.capacity() + py_.capacity() + pz_.capacity() + nx_.capacity() + ny_.capacity() +
+            nz_.capacity() + u_.capacity() + v_.capacity()) *
+               sizeof(float) +
+           corners_.capacity() * sizeof(VertexIndex) + opposites_.capacity() * sizeof(CornerIndex);
+}
+
+MeshView Mesh::view() const {
+    MeshView view;
+    view.px = px_.data();
+    view.py = py_.data();
+    view.pz = pz_.data();
+    if (hasNormals()) {
+        view.nx = nx_.data();
+        view.ny = ny_.data();
+        view.nz = nz_.data();
+    }
+    if (hasUvs()) {
+        view.u = u_.data();
+        view.v = v_.data();
+    }
+    view.corners = corners_.data();
+    view.opposites = hasConnectivity() ? opposites_.data() : nullptr;
+    view.vertexCount = vertexCount();
+    view.triangleCount = triangleCount();
+    return view;
+}
+
+} // namespace rebel::geometry
@@ -0,0 +1,925 @@
+#include "rebel/io/MeshExport.hpp"
+
+#include "rebel/core/Json.hpp"
+#include "rebel/core/TaskScheduler.hpp"
+#include "rebel/core/Trace.hpp"
+#include "rebel/io/OutputFile.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+namespace rebel::io {
+
+using assembly::NodeId;
+using core::Json;
+using math::Mat4f;
+using math::Vec3f;
+
+namespace {
+
+/// Vertices or triangles encoded by one piece at most, so large parts are
+/// split over many tasks.
+constexpr std::size_t kPieceElements = std::size_t(1) << 15;
+/// Pieces are grouped into tasks of about this many output bytes.
+constexpr std::size_t kTaskBytes = std::size_t(1) << 20;
+
+using Bytes = std::vector<std::uint8_t>;
+
+// Every format here is little-endian, like every target the library builds
+// for, so values are stored as they are in memory.
+template <typename T>
+void put(Bytes& out, T value) {
+    static_assert(std::is_trivially_copyable_v<T>, "stored as raw bytes");
+    const auto* bytes = reinterpret_cast<const std::uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+void putText(Bytes& out, std::string_view text) {
+    out.insert(out.end(), text.begin(), text.end());
+}
+
+/// Part of the output encoded independently of the rest.
+struct Piece {
+    /// Expected size, an upper bound where the encoding varies.
+    std::size_t bytes = 0;
+    std::function<void(Bytes&)> encode;
+};
+
+Piece literal(std::string text) {
+    const std::size_t bytes = text.size();
+    return {bytes, [text = std::move(text)](Bytes& out) { putText(out, text); }};
+}
+
+// --- CRC-32 (ZIP) --------------------------------------------------------
+
+const std::array<std::uint32_t, 256>& crcTable() {
+    static const std::array<std::uint32_t, 256> table = [] {
+        std::array<std::uint32_t, 256> t{};
+        for (std::uint32_t n = 0; n < 256; ++n) {
+            std::uint32_t c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) != 0 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[n] = c;
+        }
+        return t;
+    }();
+    return table;
+}
+
+std::uint32_t gf2Times(const std::uint32_t* matrix, std::uint32_t vector) {
+    std::uint32_t sum = 0;
+    for (; vector != 0; vector >>= 1, ++matrix) {
+        if ((vector & 1) != 0) {
+            sum ^= *matrix;
+        }
+    }
+    return sum;
+}
+
+void gf2Square(std::uint32_t* square, const std::uint32_t* matrix) {
+    for (int n = 0; n < 32; ++n) {
+        square[n] = gf2Times(matrix, matrix[n]);
+    }
+}
+
+} // namespace
+
+namespace detail {
+
+std::uint32_t crc32(const std::uint8_t* data, std::size_t size) {
+    const std::array<std::uint32_t, 256>& table = crcTable();
+    std::uint32_t c = 0xFFFFFFFFu;
+    for (std::size_t i = 0; i < size; ++i) {
+        c = table[(c ^ data[i]) & 0xFF] ^ (c >> 8);
+    }
+    return c ^ 0xFFFFFFFFu;
+}
+
+// zlib's `crc32_combine`, so pieces are checksummed in parallel with their
+// encoding.
+std::uint32_t crc32Combine(std::uint32_t crcA, std::uint32_t crcB, std::uint64_t sizeB) {
+    if (sizeB == 0) {
+        return crcA;
+    }
+    std::uint32_t even[32];
+    std::uint32_t odd[32];
+    odd[0] = 0xEDB88320u;
+    for (int n = 1; n < 32; ++n) {
+        odd[n] = std::uint32_t(1) << (n - 1);
+    }
+    gf2Square(even, odd);
+    gf2Square(odd, even);
+    do {
+        gf2Square(even, odd);
+        if ((sizeB & 1) != 0) {
+            crcA = gf2Times(even, crcA);
+        }
+        sizeB >>= 1;
+        if (sizeB == 0) {
+            break;
+        }
+        gf2Square(odd, even);
+        if ((sizeB & 1) != 0) {
+            crcA = gf2Times(odd, crcA);
+        }
+        sizeB >>= 1;
+    } while (sizeB != 0);
+    return crcA ^ crcB;
+}
+
+} // namespace detail
+
+namespace {
+
+using detail::crc32;
+using detail::crc32Combine;
+
+// --- Pipeline ------------------------------------------------------------
+
+struct Encoded {
+    Bytes bytes;
+    std::uint32_t crc = 0;
+};
+
+/// Queues the encoding of `pieces[first, last)` into `out` on `group`.
+void encode(const std::vector<Piece>& pieces, std::size_t first, std::size_t last, bool checksum,
+            std::vector<Encoded>& out, core::TaskGroup& group) {
+    out.assign(last - first, Encoded{});
+    for (std::size_t begin = first; begin < last;) {
+        std::size_t end = begin;
+        for (std::size_t bytes = 0; end < last && (end == begin || bytes < kTaskBytes); ++end) {
+            bytes += pieces[end].bytes;
+        }
+        group.run([&pieces, &out, first, begin, end, checksum] {
+            for (std::size_t i = begin; i < end; ++i) {
+                Encoded& e = out[i - first];
+                e.bytes.reserve(pieces[i].bytes);
+                pieces[i].encode(e.bytes);
+                if (checksum) {
+                    e.crc = crc32(e.bytes.data(), e.bytes.size());
+                }
+            }
+        });
+        begin = end;
+    }
+}
+
+/// Encodes `pieces` in parallel, one window at a time, and writes them in
+/// order; the next window is encoded while the current one is written.
+/// With `crc`, also folds in the checksum of everything written.
+void stream(OutputFile& file, const std::vector<Piece>& pieces, std::size_t windowBytes, std::uint32_t* crc) {
+    REBEL_TRACE_ZONE("export.stream");
+    const std::size_t half = std::max<std::size_t>(windowBytes / 2, 1);
+    auto windowEnd = [&](std::size_t begin) {
+        std::size_t end = begin;
+        for (std::size_t bytes = 0; end < pieces.size() && (end == begin || bytes + pieces[end].bytes <= half); ++end) {
+            bytes += pieces[end].bytes;
+        }
+        return end;
+    };
+    std::vector<Encoded> current;
+    std::vector<Encoded> next;
+    std::size_t end = windowEnd(0);
+    {
+        core::TaskGroup group;
+        encode(pieces, 0, end, crc != nullptr, current, group);
+        group.wait();
+    }
+    while (!current.empty()) {
+        const std::size_t nextEnd = windowEnd(end);
+        core::TaskGroup group;
+        encode(pieces, end, nextEnd, crc != nullptr, next, group);
+        for (Encoded& e : current) {
+            if (crc != nullptr) {
+                *crc = crc32Combine(*crc, e.crc, e.bytes.size());
+            }
+            file.write(std::move(e.bytes));
+        }
+        file.flush();
+        group.wait();
+        current.swap(next);
+        end = nextEnd;
+    }
+}
+
+// --- Scene ---------------------------------------------------------------
+
+struct Visible {
+    NodeId node = assembly::kInvalidNode;
+    assembly::PartId part = assembly::kInvalidPart;
+    assembly::PartPtr definition;
+    Mat4f world;
+};
+
+/// Calls `enter(id, node, world)` for every exported node in depth-first
+/// order, children in tree order, and `leave(id)` after its subtree.
+template <typename Enter, typename Leave>
+void walk(const assembly::Assembly& assembly, const MeshExportOptions& options, Enter&& enter, Leave&& leave) {
+    struct Frame {
+        NodeId node;
+        Mat4f world;
+        bool entered;
+    };
+    std::vector<Frame> stack{{assembly.root(), assembly.node(assembly.root()).local, false}};
+    std::vector<NodeId> children;
+    while (!stack.empty()) {
+        Frame& frame = stack.back();
+        if (frame.entered) {
+            leave(frame.node);
+            stack.pop_back();
+            continue;
+        }
+        frame.entered = true;
+        const NodeId id = frame.node;
+        const Mat4f world = frame.world;
+        const assembly::AssemblyNode& n = assembly.node(id);
+        if (n.overrides.suppressed() || (n.overrides.hidden() && !options.includeHidden)) {
+            stack.pop_back();
+            continue;
+        }
+        enter(id, n, world);
+        children.clear();
+        for (NodeId c = n.firstChild; c != assembly::kInvalidNode; c = assembly.node(c).nextSibling) {
+            children.push_back(c);
+        }
+        for (auto c = children.rbegin(); c != children.rend(); ++c) {
+            stack.push_back({*c, world * assembly.node(*c).local, false});
+        }
+    }
+}
+
+std::vector<Visible> visibleOccurrences(const assembly::Assembly& assembly, const assembly::PartLibrary& library,
+                                        const MeshExportOptions& options) {
+    std::vector<Visible> out;
+    walk(
+        assembly, options,
+        [&](NodeId id, const assembly::AssemblyNode& n, const Mat4f& world) {
+            if (n.isOccurrence()) {
+                out.push_back({id, n.part, library.get(n.part), world});
+            }
+        },
+        [](NodeId) {});
+    return out;
+}
+
+bool mirrors(const Mat4f& m) {
+    const Vec3f x{m.m[0], m.m[1], m.m[2]};
+    const Vec3f y{m.m[4], m.m[5], m.m[6]};
+    const Vec3f z{m.m[8], m.m[9], m.m[10]};
+    return math::dot(math::cross(x, y), z) < 0.0f;
+}
+
+std::size_t pieceCount(std::size_t elements) {
+    return (elements + kPieceElements - 1) / kPieceElements;
+}
+
+// --- STL -----------------------------------------------------------------
+
+MeshExportStats writeStl(OutputFile& file, const std::vector<Visible>& visible, const MeshExportOptions& options) {
+    constexpr std::size_t kFacetBytes = 50;
+    MeshExportStats stats;
+    std::vector<Piece> pieces;
+    for (const Visible& v : visible) {
+        const geometry::MeshView& mesh = v.definition->mesh();
+        if (mesh.triangleCount == 0) {
+            continue;
+        }
+        ++stats.meshes;
+        stats.triangles += mesh.triangleCount;
+        const bool flip = mirrors(v.world);
+        for (std::size_t p = 0; p < pieceCount(mesh.triangleCount); ++p) {
+            const std::size_t first = p * kPieceElements;
+            const std::size_t last = std::min(first + kPieceElements, mesh.triangleCount);
+            pieces.push_back({(last - first) * kFacetBytes, [&v, first, last, flip](Bytes& out) {
+                                  const geometry::MeshView& m = v.definition->mesh();
+                                  for (std::size_t t = first; t < last; ++t) {
+                                      Vec3f a = v.world.transformPoint(m.position(m.corners[3 * t]));
+                                      Vec3f b = v.world.transformPoint(m.position(m.corners[3 * t + 1]));
+                                      Vec3f c = v.world.transformPoint(m.position(m.corners[3 * t + 2]));
+                                      if (flip) {
+                                          std::swap(b, c);
+                                      }
+                                      const Vec3f n = math::cross(b - a, c - a);
+                                      const float length = math::length(n);
+                                      const Vec3f unit = length > 0.0f ? n / length : Vec3f{};
+                                      for (const Vec3f& q : {unit, a, b, c}) {
+                                          put(out, q.x);
+                                          put(out, q.y);
+                                          put(out, q.z);
+                                      }
+                                      put(out, std::uint16_t(0));
+                                  }
+                              }});
+        }
+    }
+    if (stats.triangles > 0xFFFFFFFFu) {
+        throw std::runtime_error(file.path() + ": too many triangles for STL");
+    }
+    const char header[80] = "RebelCAD binary STL";
+    file.write(header, sizeof(header));
+    const auto count = static_cast<std::uint32_t>(stats.triangles);
+    file.write(&count, sizeof(count));
+    stream(file, pieces, options.windowBytes, nullptr);
+    return stats;
+}
+
+// --- glTF ----------------------------------------------------------------
+
+/// Where one part's arrays go in the binary chunk.
+struct GltfPart {
+    assembly::PartPtr definition;
+    std::uint64_t positions = 0;
+    std::uint64_t normals = 0;
+    std::uint64_t indices = 0;
+    std::uint64_t indexBytes = 0;
+    bool shortIndices = false;
+    /// First accessor: positions, then normals if any, then indices.
+    std::size_t accessor = 0;
+};
+
+Json gltfMatrix(const Mat4f& m) {
+    Json out = Json::array();
+    for (const float v : m.m) {
+        out.push(static_cast<double>(v));
+    }
+    return out;
+}
+
+double srgbToLinear(std::uint32_t channel) {
+    const double c = channel / 255.0;
+    return c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+}
+
+void vec3Pieces(std::vector<Piece>& pieces, const assembly::PartPtr& part, bool normals) {
+    const std::size_t count = part->mesh().vertexCount;
+    for (std::size_t p = 0; p < pieceCount(count); ++p) {
+        const std::size_t first = p * kPieceElements;
+        const std::size_t last = std::min(first + kPieceElements, count);
+        pieces.push_back({(last - first) * 12, [part, first, last, normals](Bytes& out) {
+                              const geometry::MeshView& m = part->mesh();
+                              const float* x = normals ? m.nx : m.px;
+                              const float* y = normals ? m.ny : m.py;
+                              const float* z = normals ? m.nz : m.pz;
+                              for (std::size_t i = first; i < last; ++i) {
+                                  put(out, x[i]);
+                                  put(out, y[i]);
+                                  put(out, z[i]);
+                              }
+                          }});
+    }
+}
+
+MeshExportStats writeGltf(OutputFile& file, const assembly::Assembly& assembly, const std::vector<Visible>& visible,
+                          const MeshExportOptions& options) {
+    MeshExportStats stats;
+    Json bufferViews = Json::array();
+    Json accessors = Json::array();
+    std::vector<GltfPart> parts;
+    std::unordered_map<assembly::PartId, std::size_t> partIndex;
+    std::vector<Piece> pieces;
+    std::uint64_t binBytes = 0;
+    auto addView = [&](std::uint64_t bytes, int target) {
+        Json view = Json::object();
+        view["buffer"] = 0;
+        view["byteOffset"] = binBytes;
+        view["byteLength"] = bytes;
+        view["target"] = target;
+        bufferViews.push(std::move(view));
+        const std::uint64_t offset = binBytes;
+        binBytes += (bytes + 3) / 4 * 4;
+        return offset;
+    };
+    auto addAccessor = [&](int componentType, std::size_t count, const char* type) -> Json& {
+        Json accessor = Json::object();
+        accessor["bufferView"] = bufferViews.asArray().size() - 1;
+        accessor["componentType"] = componentType;
+        accessor["count"] = count;
+        accessor["type"] = type;
+        accessors.push(std::move(accessor));
+        return accessors.asArray().back();
+    };
+    constexpr int kArrayBuffer = 34962;
+    constexpr int kElementArrayBuffer = 34963;
+    constexpr int kFloat = 5126;
+
+    for (const Visible& v : visible) {
+        const geometry::MeshView& mesh = v.definition->mesh();
+        if (mesh.triangleCount == 0 || partIndex.count(v.part) != 0) {
+            continue;
+        }
+        partIndex.emplace(v.part, parts.size());
+        GltfPart& p = parts.emplace_back();
+        p.definition = v.definition;
+        p.accessor = accessors.asArray().size();
+        p.shortIndices = mesh.vertexCount <= 0xFFFF;
+        p.indexBytes = std::uint64_t(3) * mesh.triangleCount * (p.shortIndices ? 2 : 4);
+
+        p.positions = addView(std::uint64_t(12) * mesh.vertexCount, kArrayBuffer);
+        Json& position = addAccessor(kFloat, mesh.vertexCount, "VEC3");
+        const math::Aabb& bounds = v.definition->bounds();
+        position["min"] = Json(Json::Array{bounds.min.x, bounds.min.y, bounds.min.z});
+        position["max"] = Json(Json::Array{bounds.max.x, bounds.max.y, bounds.max.z});
+        vec3Pieces(pieces, p.definition, false);
+        if (mesh.hasNormals()) {
+            p.normals = addView(std::uint64_t(12) * mesh.vertexCount, kArrayBuffer);
+            addAccessor(kFloat, mesh.vertexCount, "VEC3");
+            vec3Pieces(pieces, p.definition, true);
+        }
+        p.indices = addView(p.indexBytes, kElementArrayBuffer);
+        addAccessor(p.shortIndices ? 5123 : 5125, 3 * mesh.triangleCount, "SCALAR");
+        const std::size_t indexPieces = pieceCount(mesh.triangleCount);
+        for (std::size_t i = 0; i < indexPieces; ++i) {
+            const std::size_t first = i * kPieceElements;
+            const std::size_t last = std::min(first + kPieceElements, mesh.triangleCount);
+            const bool pad = i + 1 == indexPieces;
+            const bool shortIndices = p.shortIndices;
+            pieces.push_back({(last - first) * (shortIndices ? 6 : 12) + 2,
+                              [part = p.definition, first, last, pad, shortIndices](Bytes& out) {
+                                  const geometry::VertexIndex* corners = part->mesh().corners;
+                                  for (std::size_t c = 3 * first; c < 3 * last; ++c) {
+                                      if (shortIndices) {
+                                          put(out, static_cast<std::uint16_t>(corners[c]));
+                                      } else {
+                                          put(out, corners[c]);
+                                      }
+                                  }
+                                  if (pad && out.size() % 4 != 0) {
+                                      put(out, std::uint16_t(0));
+                                  }
+                              }});
+        }
+        stats.triangles += mesh.triangleCount;
+    }
+    stats.meshes = parts.size();
+
+    // One glTF mesh per part and color, sharing the part's accessors.
+    Json meshes = Json::array();
+    Json materials = Json::array();
+    std::map<std::pair<std::size_t, std::uint32_t>, std::size_t> meshIndex;
+    std::unordered_map<std::uint32_t, std::size_t> materialIndex;
+    auto meshFor = [&](std::size_t part, const assembly::Overrides& overrides) {
+        const std::uint32_t color = overrides.hasColor() ? overrides.colorRgba : 0;
+        const auto found = meshIndex.try_emplace({part, overrides.hasColor() ? color : 0xFFFFFFFFu}, 0);
+        if (!found.second) {
+            return found.first->second;
+        }
+        const GltfPart& p = parts[part];
+        Json attributes = Json::object();
+        attributes["POSITION"] = p.accessor;
+        if (p.definition->mesh().hasNormals()) {
+            attributes["NORMAL"] = p.accessor + 1;
+        }
+        Json primitive = Json::object();
+        primitive["attributes"] = std::move(attributes);
+        primitive["indices"] = p.accessor + (p.definition->mesh().hasNormals() ? 2 : 1);
+        if (overrides.hasColor()) {
+            const auto material = materialIndex.try_emplace(color, materials.asArray().size());
+            if (material.second) {
+                Json pbr = Json::object();
+                pbr["baseColorFactor"] = Json(Json::Array{srgbToLinear(color >> 24), srgbToLinear(color >> 16 & 0xFF),
+                                                          srgbToLinear(color >> 8 & 0xFF), (color & 0xFF) / 255.0});
+                pbr["metallicFactor"] = 0.0;
+                Json m = Json::object();
+                m["pbrMetallicRoughness"] = std::move(pbr);
+                if ((color & 0xFF) != 0xFF) {
+                    m["alphaMode"] = "BLEND";
+                }
+                materials.push(std::move(m));
+            }
+            primitive["material"] = material.first->second;
+        }
+        Json mesh = Json::object();
+        const std::string& name = p.definition->name();
+        if (!name.empty()) {
+            mesh["name"] = name;
+        }
+        mesh["primitives"] = Json(Json::Array{std::move(primitive)});
+        found.first->second = meshes.asArray().size();
+        meshes.push(std::move(mesh));
+        return found.first->second;
+    };
+
+    // Nodes mirror the assembly tree, so instancing and structure survive.
+    std::vector<Json> nodes;
+    std::vector<Json::Array> children;
+    std::vector<std::size_t> open;
+    walk(
+        assembly, options,
+        [&](NodeId id, const assembly::AssemblyNode& n, const Mat4f&) {
+            const std::size_t index = nodes.size();
+            if (!open.empty()) {
+                children[open.back()].push_back(index);
+            }
+            open.push_back(index);
+            Json node = Json::object();
+            const std::string& name = assembly.name(id);
+            if (!name.empty()) {
+                node["name"] = name;
+            }
+            Mat4f local = n.local;
+            if (id == assembly.root() && options.zUp) {
+                Mat4f upright;
+                upright.m[5] = 0.0f;
+                upright.m[6] = -1.0f;
+                upright.m[9] = 1.0f;
+                upright.m[10] = 0.0f;
+                local = upright * local;
+            }
+            if (!(local == Mat4f())) {
+                node["matrix"] = gltfMatrix(local);
+            }
+            if (n.isOccurrence()) {
+                const auto part = partIndex.find(n.part);
+                if (part != partIndex.end()) {
+                    node["mesh"] = meshFor(part->second, n.overrides);
+                }
+            }
+            nodes.push_back(std::move(node));
+            children.emplace_back();
+        },
+        [&](NodeId) { open.pop_back(); });
+    Json nodeArray = Json::array();
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        if (!children[i].empty()) {
+            nodes[i]["children"] = Json(std::move(children[i]));
+        }
+        nodeArray.push(std::move(nodes[i]));
+    }
+
+    Json gltf = Json::object();
+    Json asset = Json::object();
+    asset["version"] = "2.0";
+    asset["generator"] = "RebelCAD";
+    gltf["asset"] = std::move(asset);
+    gltf["scene"] = 0;
+    Json scene = Json::object();
+    scene["nodes"] = nodes.empty() ? Json::array() : Json(Json::Array{0});
+    gltf["scenes"] = Json(Json::Array{std::move(scene)});
+    gltf["nodes"] = std::move(nodeArray);
+    if (!meshes.asArray().empty()) {
+        gltf["meshes"] = std::move(meshes);
+        gltf["accessors"] = std::move(accessors);
+        gltf["bufferViews"] = std::move(bufferViews);
+        Json buffer = Json::object();
+        buffer["byteLength"] = binBytes;
+        gltf["buffers"] = Json(Json::Array{std::move(buffer)});
+    }
+    if (!materials.asArray().empty()) {
+        gltf["materials"] = std::move(materials);
+    }
+    std::string json = gltf.dump();
+    json.resize((json.size() + 3) / 4 * 4, ' ');
+
+    const std::uint64_t total = 12 + 8 + json.size() + (binBytes > 0 ? 8 + binBytes : 0);
+    if (total > 0xFFFFFFFFu) {
+        throw std::runtime_error(file.path() + ": too large for binary glTF (4 GB)");
+    }
+    Bytes header;
+    put(header, std::uint32_t(0x46546C67)); // "glTF"
+    put(header, std::uint32_t(2));
+    put(header, static_cast<std::uint32_t>(total));
+    put(header, static_cast<std::uint32_t>(json.size()));
+    put(header, std::uint32_t(0x4E4F534A)); // "JSON"
+    putText(header, json);
+    if (binBytes > 0) {
+        put(header, static_cast<std::uint32_t>(binBytes));
+        put(header, std::uint32_t(0x004E4942)); // "BIN\0"
+    }
+    file.write(std::move(header));
+    stream(file, pieces, options.windowBytes, nullptr);
+    return stats;
+}
+
+// --- 3MF -----------------------------------------------------------------
+
+/// Longest text `to_chars` gives for a float, e.g. "-1.17549435e-38".
+constexpr std::size_t kMaxFloatChars = 15;
+
+void putNumber(Bytes& out, float value) {
+    char text[32];
+    const std::to_chars_result r = std::to_chars(text, text + sizeof(text), value);
+    out.insert(out.end(), text, r.ptr);
+}
+
+void putNumber(Bytes& out, std::uint64_t value) {
+    char text[24];
+    const std::to_chars_result r = std::to_chars(text, text + sizeof(text), value);
+    out.insert(out.end(), text, r.ptr);
+}
+
+std::string xmlEscape(std::string_view text) {
+    std::string out;
+    for (const char c : text) {
+        switch (c) {
+        case '&':
+            out += "&amp;";
+            break;
+        case '<':
+            out += "&lt;";
+            break;
+        case '>':
+            out += "&gt;";
+            break;
+        case '"':
+            out += "&quot;";
+            break;
+        default:
+            out += c;
+        }
+    }
+    return out;
+}
+
+struct ZipEntry {
+    std::string name;
+    std::uint64_t offset = 0;
+    std::uint64_t size = 0;
+    std::uint32_t crc = 0;
+    bool streamed = false;
+    bool zip64 = false;
+};
+
+constexpr std::uint16_t kZipDate = 0x21; // 1980-01-01, so output is reproducible
+
+void putLocalHeader(Bytes& out, const ZipEntry& e) {
+    put(out, std::uint32_t(0x04034B50));
+    put(out, std::uint16_t(e.zip64 ? 45 : 20));
+    put(out, std::uint16_t(e.streamed ? 0x0008 : 0));
+    put(out, std::uint16_t(0)); // stored
+    put(out, std::uint16_t(0));
+    put(out, kZipDate);
+    put(out, e.streamed ? std::uint32_t(0) : e.crc);
+    const std::uint32_t size = e.zip64 ? 0xFFFFFFFFu : e.streamed ? 0 : static_cast<std::uint32_t>(e.size);
+    put(out, size);
+    put(out, size);
+    put(out, static_cast<std::uint16_t>(e.name.size()));
+    put(out, std::uint16_t(e.zip64 ? 20 : 0));
+    putText(out, e.name);
+    if (e.zip64) {
+        put(out, std::uint16_t(1));
+        put(out, std::uint16_t(16));
+        put(out, std::uint64_t(0));
+        put(out, std::uint64_t(0));
+    }
+}
+
+void putCentralHeader(Bytes& out, const ZipEntry& e) {
+    put(out, std::uint32_t(0x02014B50));
+    put(out, std::uint16_t(45));
+    put(out, std::uint16_t(e.zip64 ? 45 : 20));
+    put(out, std::uint16_t(e.streamed ? 0x0008 : 0));
+    put(out, std::uint16_t(0));
+    put(out, std::uint16_t(0));
+    put(out, kZipDate);
+    put(out, e.crc);
+    const std::uint32_t size = e.zip64 ? 0xFFFFFFFFu : static_cast<std::uint32_t>(e.size);
+    put(out, size);
+    put(out, size);
+    put(out, static_cast<std::uint16_t>(e.name.size()));
+    put(out, std::uint16_t(e.zip64 ? 20 : 0));
+    put(out, std::uint16_t(0)); // comment
+    put(out, std::uint16_t(0)); // disk
+    put(out, std::uint16_t(0)); // internal attributes
+    put(out, std::uint32_t(0)); // external attributes
+    put(out, static_cast<std::uint32_t>(e.offset));
+    putText(out, e.name);
+    if (e.zip64) {
+        put(out, std::uint16_t(1));
+        put(out, std::uint16_t(16));
+        put(out, e.size);
+        put(out, e.size);
+    }
+}
+
+void writeStoredEntry(OutputFile& file, std::vector<ZipEntry>& entries, std::string name, std::string_view data) {
+    ZipEntry e;
+    e.name = std::move(name);
+    e.offset = file.position();
+    e.size = data.size();
+    e.crc = crc32(reinterpret_cast<const std::uint8_t*>(data.data()), data.size());
+    Bytes out;
+    putLocalHeader(out, e);
+    putText(out, data);
+    file.write(std::move(out));
+    entries.push_back(std::move(e));
+}
+
+MeshExportStats write3mf(OutputFile& file, const std::vector<Visible>& visible, const MeshExportOptions& options) {
+    MeshExportStats stats;
+    std::vector<Piece> pieces;
+    pieces.push_back(literal("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                             "<model unit=\"meter\" xml:lang=\"en-US\" "
+                             "xmlns=\"http://schemas.microsoft.com/3dmanufacturing/core/2015/02\">\n"
+                             "<resources>\n"));
+    // One mesh object per part; ids start at 1.
+    std::unordered_map<assembly::PartId, std::size_t> objectId;
+    for (const Visible& v : visible) {
+        const geometry::MeshView& mesh = v.definition->mesh();
+        if (mesh.triangleCount == 0 || objectId.count(v.part) != 0) {
+            continue;
+        }
+        const std::size_t id = objectId.size() + 1;
+        objectId.emplace(v.part, id);
+        ++stats.meshes;
+        stats.triangles += mesh.triangleCount;
+        std::string open = "<object id=\"" + std::to_string(id) + "\" type=\"model\"";
+        if (!v.definition->name().empty()) {
+            open += " name=\"" + xmlEscape(v.definition->name()) + "\"";
+        }
+        pieces.push_back(literal(open + "><mesh><vertices>\n"));
+        for (std::size_t p = 0; p < pieceCount(mesh.vertexCount); ++p) {
+            const std::size_t first = p * kPieceElements;
+            const std::size_t last = std::min(first + kPieceElements, mesh.vertexCount);
+            const std::size_t bytes = (last - first) * (26 + 3 * kMaxFloatChars);
+            pieces.push_back({bytes, [part = v.definition, first, last](Bytes& out) {
+                                  const geometry::MeshView& m = part->mesh();
+                                  for (std::size_t i = first; i < last; ++i) {
+                                      putText(out, "<vertex x=\"");
+                                      putNumber(out, m.px[i]);
+                                      putText(out, "\" y=\"");
+                                      putNumber(out, m.py[i]);
+                                      putText(out, "\" z=\"");
+                                      putNumber(out, m.pz[i]);
+                                      putText(out, "\"/>\n");
+                                  }
+                              }});
+        }
+        pieces.push_back(literal("</vertices><triangles>\n"));
+        for (std::size_t p = 0; p < pieceCount(mesh.triangleCount); ++p) {
+            const std::size_t first = p * kPieceElements;
+            const std::size_t last = std::min(first + kPieceElements, mesh.triangleCount);
+            pieces.push_back({(last - first) * (31 + 3 * 10), [part = v.definition, first, last](Bytes& out) {
+                                  const geometry::VertexIndex* corners = part->mesh().corners;
+                                  for (std::size_t t = first; t < last; ++t) {
+                                      putText(out, "<triangle v1=\"");
+                                      putNumber(out, std::uint64_t(corners[3 * t]));
+                                      putText(out, "\" v2=\"");
+                                      putNumber(out, std::uint64_t(corners[3 * t + 1]));
+                                      putText(out, "\" v3=\"");
+                                      putNumber(out, std::uint64_t(corners[3 * t + 2]));
+                                      putText(out, "\"/>\n");
+                                  }
+                              }});
+        }
+        pieces.push_back(literal("</triangles></mesh></object>\n"));
+    }
+    pieces.push_back(literal("</resources>\n<build>\n"));
+    std::vector<std::pair<std::size_t, const Visible*>> items;
+    for (const Visible& v : visible) {
+        const auto id = objectId.find(v.part);
+        if (id != objectId.end()) {
+            items.emplace_back(id->second, &v);
+        }
+    }
+    for (std::size_t p = 0; p < pieceCount(items.size()); ++p) {
+        const std::size_t first = p * kPieceElements;
+        const std::size_t last = std::min(first + kPieceElements, items.size());
+        pieces.push_back({(last - first) * (38 + 20 + 12 * (kMaxFloatChars + 1)), [&items, first, last](Bytes& out) {
+                              for (std::size_t i = first; i < last; ++i) {
+                                  // Row-vector 4x3 matrix: the images of the axes, then the origin.
+                                  const Mat4f& m = items[i].second->world;
+                                  putText(out, "<item objectid=\"");
+                                  putNumber(out, std::uint64_t(items[i].first));
+                                  putText(out, "\" transform=\"");
+                                  for (const int k : {0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14}) {
+                                      putNumber(out, m.m[k]);
+                                      putText(out, k == 14 ? "\"/>\n" : " ");
+                                  }
+                              }
+                          }});
+    }
+    pieces.push_back(literal("</build>\n</model>\n"));
+
+    std::vector<ZipEntry> entries;
+    writeStoredEntry(file, entries, "[Content_Types].xml",
+                     "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                     "<Types xmlns=\"http://schemas.openxmlformats.org/package/2006/content-types\">"
+                     "<Default Extension=\"rels\" "
+                     "ContentType=\"application/vnd.openxmlformats-package.relationships+xml\"/>"
+                     "<Default Extension=\"model\" "
+                     "ContentType=\"application/vnd.ms-package.3dmanufacturing-3dmodel+xml\"/></Types>\n");
+    writeStoredEntry(file, entries, "_rels/.rels",
+                     "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                     "<Relationships xmlns=\"http://schemas.openxmlformats.org/package/2006/relationships\">"
+                     "<Relationship Target=\"/3D/3dmodel.model\" Id=\"rel0\" "
+                     "Type=\"http://schemas.microsoft.com/3dmanufacturing/2013/01/3dmodel\"/></Relationships>\n");
+
+    // The model is streamed, so its size and checksum follow it in a data
+    // descriptor; piece sizes bound it, which settles ZIP64 up front.
+    ZipEntry model;
+    model.name = "3D/3dmodel.model";
+    model.offset = file.position();
+    model.streamed = true;
+    std::uint64_t bound = 0;
+    for (const Piece& p : pieces) {
+        bound += p.bytes;
+    }
+    model.zip64 = bound >= 0xFFFFFFFFu;
+    Bytes header;
+    putLocalHeader(header, model);
+    file.write(std::move(header));
+    const std::uint64_t start = file.position();
+    stream(file, pieces, options.windowBytes, &model.crc);
+    model.size = file.position() - start;
+    Bytes descriptor;
+    put(descriptor, std::uint32_t(0x08074B50));
+    put(descriptor, model.crc);
+    if (model.zip64) {
+        put(descriptor, model.size);
+        put(descriptor, model.size);
+    } else {
+        put(descriptor, static_cast<std::uint32_t>(model.size));
+        put(descriptor, static_cast<std::uint32_t>(model.size));
+    }
+    file.write(std::move(descriptor));
+    entries.push_back(std::move(model));
+
+    const std::uint64_t directory = file.position();
+    Bytes end;
+    for (const ZipEntry& e : entries) {
+        putCentralHeader(end, e);
+    }
+    const std::uint64_t directorySize = end.size();
+    const bool zip64 = entries.back().zip64 || directory >= 0xFFFFFFFFu;
+    if (zip64) {
+        const std::uint64_t record = directory + directorySize;
+        put(end, std::uint32_t(0x06064B50));
+        put(end, std::uint64_t(44));
+        put(end, std::uint16_t(45));
+        put(end, std::uint16_t(45));
+        put(end, std::uint32_t(0));
+        put(end, std::uint32_t(0));
+        put(end, std::uint64_t(entries.size()));
+        put(end, std::uint64_t(entries.size()));
+        put(end, directorySize);
+        put(end, directory);
+        put(end, std::uint32_t(0x07064B50));
+        put(end, std::uint32_t(0));
+        put(end, record);
+        put(end, std::uint32_t(1));
+    }
+    put(end, std::uint32_t(0x06054B50));
+    put(end, std::uint16_t(0));
+    put(end, std::uint16_t(0));
+    put(end, static_cast<std::uint16_t>(entries.size()));
+    put(end, static_cast<std::uint16_t>(entries.size()));
+    put(end, static_cast<std::uint32_t>(directorySize));
+    put(end, directory >= 0xFFFFFFFFu ? 0xFFFFFFFFu : static_cast<std::uint32_t>(directory));
+    put(end, std::uint16_t(0));
+    file.write(std::move(end));
+    return stats;
+}
+
+} // namespace
+
+MeshFormat meshFormatForPath(const std::string& path) {
+    const std::size_t dot = path.find_last_of('.');
+    std::string extension = dot == std::string::npos ? std::string() : path.substr(dot);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (extension == ".stl") {
+        return MeshFormat::Stl;
+    }
+    if (extension == ".3mf") {
+        return MeshFormat::ThreeMf;
+    }
+    if (extension == ".glb") {
+        return MeshFormat::Gltf;
+    }
+    throw std::invalid_argument("no mesh format for \"" + path + "\"");
+}
+
+MeshExportStats exportMesh(const assembly::Assembly& assembly, const assembly::PartLibrary& library,
+                           const std::string& path, MeshFormat format, const MeshExportOptions& options) {
+    REBEL_TRACE_ZONE_DETAIL("export.mesh", path);
+    const std::vector<Visible> visible = visibleOccurrences(assembly, library, options);
+    OutputFile file(path);
+    MeshExportStats stats;
+    switch (format) {
+    case MeshFormat::Stl:
+        stats = writeStl(file, visible, options);
+        break;
+    case MeshFormat::ThreeMf:
+        stats = write3mf(file, visible, options);
+        break;
+    case MeshFormat::Gltf:
+        stats = writeGltf(file, assembly, visible, options);
+        break;
+    }
+    stats.occurrences = visible.size();
+    stats.bytes = static_cast<std::size_t>(file.position());
+    file.commit();
+    return stats;
+}
+
+} // namespace rebel::io
@@ -0,0 +1,692 @@
+#include "rebel/io/NativeFile.hpp"
+
+#include "rebel/brep/GeometryRecord.hpp"
+#include "rebel/core/Trace.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+namespace rebel::io {
+
+using layout::ArrayRef;
+using layout::NodeRecord;
+using layout::PartRecord;
+using layout::StringRef;
+
+namespace {
+
+/// Sequential output that tracks the file offset and, while a section is
+/// open, hashes everything written.
+class Output {
+public:
+    explicit Output(std::ofstream& out) : out_(out) {}
+
+    std::uint64_t position() const { return position_; }
+
+    void write(const void* data, std::size_t bytes) {
+        out_.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+        if (hasher_ != nullptr) {
+            hasher_->addBytes(data, bytes);
+        }
+        position_ += bytes;
+    }
+
+    void pad(std::size_t alignment) {
+        static const std::uint8_t zeros[layout::kSectionAlignment] = {};
+        const std::size_t n = static_cast<std::size_t>((alignment - position_ % alignment) % alignment);
+        write(zeros, n);
+    }
+
+    template <typename T>
+    ArrayRef array(const T* data, std::size_t count) {
+        static_assert(std::is_trivially_copyable_v<T>, "arrays are written as raw bytes");
+        if (data == nullptr || count == 0) {
+            return {};
+        }
+        pad(layout::kArrayAlignment);
+        const ArrayRef ref{position_, count};
+        write(data, count * sizeof(T));
+        return ref;
+    }
+
+    void hashInto(core::Hasher* hasher) { hasher_ = hasher; }
+
+private:
+    std::ofstream& out_;
+    std::uint64_t position_ = 0;
+    core::Hasher* hasher_ = nullptr;
+};
+
+class StringTable {
+public:
+    StringRef add(std::string_view s) {
+        const StringRef ref{static_cast<std::uint32_t>(bytes_.size()), static_cast<std::uint32_t>(s.size())};
+        bytes_.append(s.data(), s.size());
+        return ref;
+    }
+    const std::string& bytes() const { return bytes_; }
+
+private:
+    std::string bytes_;
+};
+
+struct BodyTables {
+    std::vector<math::Vec3d> vertices;
+    std::vector<layout::BrepEdgeRecord> edges;
+    std::vector<layout::BrepFaceRecord> faces;
+    std::vector<brep::GeometryRecord> curves;
+    std::vector<brep::GeometryRecord> surfaces;
+};
+
+BodyTables flatten(const brep::Body& body) {
+    BodyTables t;
+    std::unordered_map<const brep::Curve*, std::uint32_t> curveIndex;
+    std::unordered_map<const brep::Surface*, std::uint32_t> surfaceIndex;
+    for (std::size_t i = 0; i < body.vertexCount(); ++i) {
+        t.vertices.push_back(body.vertex(static_cast<brep::VertexId>(i)).point);
+    }
+    for (std::size_t i = 0; i < body.edgeCount(); ++i) {
+        const brep::BrepEdge& e = body.edge(static_cast<brep::EdgeId>(i));
+        const auto [it, added] = curveIndex.emplace(e.curve.get(), static_cast<std::uint32_t>(t.curves.size()));
+        if (added) {
+            t.curves.push_back(e.curve->record());
+        }
+        layout::BrepEdgeRecord r;
+        r.curve = it->second;
+        r.start = e.start;
+        r.end = e.end;
+        r.t0 = e.t0;
+        r.t1 = e.t1;
+        t.edges.push_back(r);
+    }
+    for (std::size_t i = 0; i < body.faceCount(); ++i) {
+        const brep::BrepFace& f = body.face(static_cast<brep::FaceId>(i));
+        const auto [it, added] =
+            surfaceIndex.emplace(f.surface.get(), static_cast<std::uint32_t>(t.surfaces.size()));
+        if (added) {
+            t.surfaces.push_back(f.surface->record());
+        }
+        layout::BrepFaceRecord r;
+        r.surface = it->second;
+        r.reversed = f.reversed ? 1u : 0u;
+        for (int s = 0; s < 4; ++s) {
+            r.sideEdges[s] = f.sides[s].edge;
+            r.reversedSides |= f.sides[s].reversed ? 1u << s : 0u;
+        }
+        r.u0 = f.domain.u0;
+        r.u1 = f.domain.u1;
+        r.v0 = f.domain.v0;
+        r.v1 = f.domain.v1;
+        t.faces.push_back(r);
+    }
+    return t;
+}
+
+/// Mesh, BVH and triangle batch arrays of `part`, shared by full and
+/// level-of-detail sections.
+void writeMeshArrays(Output& out, const assembly::Part& part, PartRecord& r) {
+    const geometry::MeshView& m = part.mesh();
+    const spatial::MeshBvh& bvh = part.bvh();
+    const math::batch::TriangleBatch& tri = bvh.triangles();
+    r.arrays[layout::kPx] = out.array(m.px, m.vertexCount);
+    r.arrays[layout::kPy] = out.array(m.py, m.vertexCount);
+    r.arrays[layout::kPz] = out.array(m.pz, m.vertexCount);
+    r.arrays[layout::kNx] = out.array(m.nx, m.vertexCount);
+    r.arrays[layout::kNy] = out.array(m.ny, m.vertexCount);
+    r.arrays[layout::kNz] = out.array(m.nz, m.vertexCount);
+    r.arrays[layout::kU] = out.array(m.u, m.vertexCount);
+    r.arrays[layout::kV] = out.array(m.v, m.vertexCount);
+    r.arrays[layout::kCorners] = out.array(m.corners, 3 * m.triangleCount);
+    r.arrays[layout::kOpposites] = out.array(m.opposites, 3 * m.triangleCount);
+    r.arrays[layout::kBvhNodes] = out.array(bvh.bvh().nodes, bvh.bvh().nodeCount);
+    r.arrays[layout::kBvhPrimitives] = out.array(bvh.bvh().primitives, bvh.bvh().primitiveCount);
+    r.arrays[layout::kV0x] = out.array(tri.v0x, tri.count);
+    r.arrays[layout::kV0y] = out.array(tri.v0y, tri.count);
+    r.arrays[layout::kV0z] = out.array(tri.v0z, tri.count);
+    r.arrays[layout::kE1x] = out.array(tri.e1x, tri.count);
+    r.arrays[layout::kE1y] = out.array(tri.e1y, tri.count);
+    r.arrays[layout::kE1z] = out.array(tri.e1z, tri.count);
+    r.arrays[layout::kE2x] = out.array(tri.e2x, tri.count);
+    r.arrays[layout::kE2y] = out.array(tri.e2y, tri.count);
+    r.arrays[layout::kE2z] = out.array(tri.e2z, tri.count);
+}
+
+bool fits(const ArrayRef& ref, std::size_t elementSize, std::size_t fileSize) {
+    if (ref.offset > fileSize) {
+        return false;
+    }
+    return ref.count <= (fileSize - ref.offset) / elementSize;
+}
+
+/// True if every node of `bvh` references primitives and children inside
+/// the arrays, children come after their parent (so the tree has no
+/// cycles), primitive ids name triangles, and no leaf is deeper than
+/// builds go, which keeps traversal within its fixed stacks. One pass in
+/// node order, since parents always precede their children.
+bool validBvh(const spatial::BvhView& bvh) {
+    if (bvh.nodeCount == 0) {
+        return bvh.primitiveCount == 0;
+    }
+    for (std::size_t i = 0; i < bvh.primitiveCount; ++i) {
+        if (bvh.primitives[i] >= bvh.primitiveCount) {
+            return false;
+        }
+    }
+    constexpr int kMaxDepth = spatial::BvhView::kMaxDepth - 2;
+    std::vector<std::uint8_t> depth(bvh.nodeCount, 0);
+    for (std::size_t i = 0; i < bvh.nodeCount; ++i) {
+        const spatial::BvhNode& node = bvh.nodes[i];
+        if (node.isLeaf()) {
+            if (node.first > bvh.primitiveCount || node.count > bvh.primitiveCount - node.first) {
+                return false;
+            }
+            continue;
+        }
+        if (node.first <= i || node.first >= bvh.nodeCount - 1 || depth[i] >= kMaxDepth) {
+            return false;
+        }
+        const auto childDepth = static_cast<std::uint8_t>(depth[i] + 1);
+        depth[node.first] = std::max(depth[node.first], childDepth);
+        depth[node.first + 1] = std::max(depth[node.first + 1], childDepth);
+    }
+    return true;
+}
+
+/// True if every corner names a vertex and every opposite is a corner or
+/// `geometry::kInvalidIndex`.
+bool validCorners(const geometry::MeshView& mesh) {
+    const std::size_t corners = 3 * mesh.triangleCount;
+    for (std::size_t i = 0; i < corners; ++i) {
+        if (mesh.corners[i] >= mesh.vertexCount) {
+            return false;
+        }
+    }
+    if (mesh.opposites != nullptr) {
+        for (std::size_t i = 0; i < corners; ++i) {
+            if (mesh.opposites[i] != geometry::kInvalidIndex && mesh.opposites[i] >= corners) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+std::runtime_error corrupt(const std::string& path, const char* what) {
+    return std::runtime_error(path + ": " + what);
+}
+
+} // namespace
+
+std::uint32_t NativeWriter::addPart(const assembly::PartPtr& part, const brep::Body* body,
+                                    std::vector<assembly::PartPtr> lods) {
+    const auto it = partIndex_.find(part.get());
+    if (it != partIndex_.end()) {
+        return it->second;
+    }
+    const auto index = static_cast<std::uint32_t>(parts_.size());
+    PendingPart pending{part, std::nullopt, std::move(lods)};
+    if (body != nullptr) {
+        pending.body = *body;
+    }
+    parts_.push_back(std::move(pending));
+    partIndex_.emplace(part.get(), index);
+    return index;
+}
+
+void NativeWriter::setAssembly(const assembly::Assembly& assembly, const assembly::PartLibrary& library) {
+    nodes_.clear();
+    nodeNames_.clear();
+    struct Pending {
+        assembly::NodeId node;
+        std::uint32_t parent;
+    };
+    std::vector<std::uint32_t> lastChild;
+    std::vector<Pending> stack{{assembly.root(), layout::kNone}};
+    std::vector<assembly::NodeId> children;
+    while (!stack.empty()) {
+        const Pending p = stack.back();
+        stack.pop_back();
+        const assembly::AssemblyNode& n = assembly.node(p.node);
+        const auto index = static_cast<std::uint32_t>(nodes_.size());
+        NodeRecord r;
+        r.local = n.local;
+        r.part = n.isOccurrence() ? addPart(library.get(n.part)) : layout::kNone;
+        r.parent = p.parent;
+        r.colorRgba = n.overrides.colorRgba;
+        r.overrideFlags = n.overrides.flags;
+        nodes_.push_back(r);
+        nodeNames_.push_back(assembly.name(p.node));
+        lastChild.push_back(layout::kNone);
+        // Children are popped in sibling order, so appending each to its
+        // parent's chain keeps the source order.
+        if (p.parent != layout::kNone) {
+            if (lastChild[p.parent] == layout::kNone) {
+                nodes_[p.parent].firstChild = index;
+            } else {
+                nodes_[lastChild[p.parent]].nextSibling = index;
+            }
+            lastChild[p.parent] = index;
+        }
+        children.clear();
+        for (assembly::NodeId c = n.firstChild; c != assembly::kInvalidNode; c = assembly.node(c).nextSibling) {
+            children.push_back(c);
+        }
+        for (auto c = children.rbegin(); c != children.rend(); ++c) {
+            stack.push_back({*c, index});
+        }
+    }
+}
+
+void NativeWriter::write(const std::string& path) const {
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if (!stream) {
+        throw std::runtime_error("cannot create " + path);
+    }
+    Output out(stream);
+    layout::FileHeader header;
+    out.write(&header, sizeof(header));
+
+    StringTable strings;
+    std::vector<PartRecord> records(parts_.size());
+    for (std::size_t i = 0; i < parts_.size(); ++i) {
+        const assembly::Part& part = *parts_[i].part;
+        PartRecord& r = records[i];
+        r.name = strings.add(part.name());
+        r.vertexCount = part.mesh().vertexCount;
+        r.triangleCount = part.mesh().triangleCount;
+        r.bounds = part.bounds();
+
+        out.pad(layout::kSectionAlignment);
+        core::Hasher hasher;
+        out.hashInto(&hasher);
+        r.sectionOffset = out.position();
+        writeMeshArrays(out, part, r);
+        if (parts_[i].body) {
+            const BodyTables t = flatten(*parts_[i].body);
+            r.flags |= PartRecord::kHasBody;
+            r.arrays[layout::kBrepVertices] = out.array(t.vertices.data(), t.vertices.size());
+            r.arrays[layout::kBrepEdges] = out.array(t.edges.data(), t.edges.size());
+            r.arrays[layout::kBrepFaces] = out.array(t.faces.data(), t.faces.size());
+            r.arrays[layout::kBrepCurves] = out.array(t.curves.data(), t.curves.size());
+            r.arrays[layout::kBrepSurfaces] = out.array(t.surfaces.data(), t.surfaces.size());
+        }
+        r.sectionSize = out.position() - r.sectionOffset;
+        out.hashInto(nullptr);
+        r.sectionHash = hasher.finish();
+    }
+
+    // Levels of detail go after all full sections, densely packed, so a
+    // graphics-only load reads one contiguous region.
+    std::vector<PartRecord> lods;
+    for (std::size_t i = 0; i < parts_.size(); ++i) {
+        records[i].firstLod = parts_[i].lods.empty() ? layout::kNone : static_cast<std::uint32_t>(lods.size());
+        records[i].lodCount = static_cast<std::uint32_t>(parts_[i].lods.size());
+        for (const assembly::PartPtr& lod : parts_[i].lods) {
+            PartRecord r;
+            r.name = records[i].name;
+            r.vertexCount = lod->mesh().vertexCount;
+            r.triangleCount = lod->mesh().triangleCount;
+            r.bounds = lod->bounds();
+            out.pad(layout::kArrayAlignment);
+            core::Hasher hasher;
+            out.hashInto(&hasher);
+            r.sectionOffset = out.position();
+            writeMeshArrays(out, *lod, r);
+            r.sectionSize = out.position() - r.sectionOffset;
+            out.hashInto(nullptr);
+            r.sectionHash = hasher.finish();
+            lods.push_back(r);
+        }
+    }
+
+    std::vector<NodeRecord> nodes = nodes_;
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        nodes[i].name = strings.add(nodeNames_[i]);
+    }
+
+    header.parts = out.array(records.data(), records.size());
+    header.strings = out.array(strings.bytes().data(), strings.bytes().size());
+    header.nodes = out.array(nodes.data(), nodes.size());
+    header.lods = out.array(lods.data(), lods.size());
+    // Only the table contents are hashed, not the padding between them.
+    core::Hasher tablesHasher;
+    tablesHasher.addBytes(records.data(), records.size() * sizeof(PartRecord));
+    tablesHasher.addBytes(strings.bytes().data(), strings.bytes().size());
+    tablesHasher.addBytes(nodes.data(), nodes.size() * sizeof(NodeRecord));
+    tablesHasher.addBytes(lods.data(), lods.size() * sizeof(PartRecord));
+
+    std::memcpy(header.magic, layout::kMagic, sizeof(header.magic));
+    header.version = layout::kVersion;
+    header.byteOrder = layout::kByteOrderMark;
+    header.fileSize = out.position();
+    header.tablesHash = tablesHasher.finish();
+    stream.seekp(0);
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.flush();
+    if (!stream) {
+        throw std::runtime_error("cannot write " + path);
+    }
+}
+
+std::shared_ptr<const NativeDocument> NativeDocument::open(const std::string& path) {
+    REBEL_TRACE_ZONE_DETAIL("native.open", path);
+    std::shared_ptr<NativeDocument> doc(new NativeDocument());
+    doc->file_ = MappedFile::open(path);
+    const MappedFile& file = *doc->file_;
+    if (file.size() < sizeof(layout::FileHeader)) {
+        throw corrupt(path, "not a native document");
+    }
+    layout::FileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, layout::kMagic, sizeof(header.magic)) != 0) {
+        throw corrupt(path, "not a native document");
+    }
+    if (header.byteOrder != layout::kByteOrderMark) {
+        throw corrupt(path, "written with a different byte order");
+    }
+    if (header.version != layout::kVersion) {
+        throw corrupt(path, "unsupported format version");
+    }
+    if (header.fileSize != file.size()) {
+        throw corrupt(path, "truncated");
+    }
+    if (!fits(header.parts, sizeof(PartRecord), file.size()) || !fits(header.strings, 1, file.size()) ||
+        !fits(header.nodes, sizeof(NodeRecord), file.size()) || !fits(header.lods, sizeof(PartRecord), file.size()) ||
+        header.parts.offset % alignof(PartRecord) != 0 || header.nodes.offset % alignof(NodeRecord) != 0 ||
+        header.lods.offset % alignof(PartRecord) != 0) {
+        throw corrupt(path, "tables out of range");
+    }
+    core::Hasher hasher;
+    for (const auto& [ref, size] :
+         {std::pair{header.parts, sizeof(PartRecord)}, std::pair{header.strings, std::size_t{1}},
+          std::pair{header.nodes, sizeof(NodeRecord)}, std::pair{header.lods, sizeof(PartRecord)}}) {
+        if (ref.count > 0) {
+            hasher.addBytes(file.data() + ref.offset, ref.count * size);
+        }
+    }
+    if (hasher.finish() != header.tablesHash) {
+        throw corrupt(path, "tables do not match their hash");
+    }
+
+    doc->parts_ = reinterpret_cast<const PartRecord*>(file.data() + header.parts.offset);
+    doc->partCount_ = header.parts.count;
+    doc->strings_ = reinterpret_cast<const char*>(file.data() + header.strings.offset);
+    doc->stringBytes_ = header.strings.count;
+    doc->nodes_ = reinterpret_cast<const NodeRecord*>(file.data() + header.nodes.offset);
+    doc->nodeCount_ = header.nodes.count;
+    doc->lods_ = reinterpret_cast<const PartRecord*>(file.data() + header.lods.offset);
+    doc->lodCount_ = header.lods.count;
+    doc->byName_.reserve(doc->partCount_);
+    for (std::uint32_t i = 0; i < doc->partCount_; ++i) {
+        doc->byName_.emplace(doc->string(doc->parts_[i].name), i);
+    }
+    return doc;
+}
+
+const PartRecord& NativeDocument::record(std::uint32_t part) const {
+    if (part >= partCount_) {
+        throw std::out_of_range("unknown part record " + std::to_string(part));
+    }
+    return parts_[part];
+}
+
+std::string_view NativeDocument::string(const StringRef& ref) const {
+    if (ref.offset > stringBytes_ || ref.length > stringBytes_ - ref.offset) {
+        throw corrupt(file_->path(), "string out of range");
+    }
+    return {strings_ + ref.offset, ref.length};
+}
+
+template <typename T>
+const T* NativeDocument::array(const PartRecord& record, layout::PartArray which, std::uint64_t expectedCount) const {
+    const ArrayRef& ref = record.arrays[which];
+    if (ref.count == 0) {
+        return nullptr;
+    }
+    if (ref.count != expectedCount || !fits(ref, sizeof(T), file_->size()) ||
+        ref.offset % layout::kArrayAlignment != 0 || ref.offset < record.sectionOffset ||
+        ref.offset + ref.count * sizeof(T) > record.sectionOffset + record.sectionSize) {
+        throw corrupt(file_->path(), "part array out of range");
+    }
+    return reinterpret_cast<const T*>(file_->data() + ref.offset);
+}
+
+NativePartInfo NativeDocument::partInfo(std::uint32_t part) const {
+    const PartRecord& r = record(part);
+    NativePartInfo info;
+    info.name = string(r.name);
+    info.bounds = r.bounds;
+    info.vertexCount = r.vertexCount;
+    info.triangleCount = r.triangleCount;
+    info.sectionBytes = r.sectionSize;
+    info.hasBody = (r.flags & PartRecord::kHasBody) != 0;
+    info.lodCount = r.lodCount;
+    return info;
+}
+
+std::uint32_t NativeDocument::findPart(std::string_view name) const {
+    const auto it = byName_.find(name);
+    return it == byName_.end() ? kNotFound : it->second;
+}
+
+assembly::PartPtr NativeDocument::loadPart(std::uint32_t part) const {
+    return load(record(part));
+}
+
+assembly::PartPtr NativeDocument::loadLod(std::uint32_t part, std::uint32_t lod) const {
+    const PartRecord& r = record(part);
+    if (r.lodCount == 0) {
+        return load(r);
+    }
+    if (r.firstLod > lodCount_ || r.lodCount > lodCount_ - r.firstLod) {
+        throw corrupt(file_->path(), "level of detail out of range");
+    }
+    return load(lods_[r.firstLod + std::min(lod, r.lodCount - 1)]);
+}
+
+EditablePart NativeDocument::loadForEditing(std::uint32_t part, assembly::PartLibrary& library) const {
+    EditablePart result;
+    result.part = loadPart(part);
+    if ((record(part).flags & PartRecord::kHasBody) != 0) {
+        result.body = loadBody(part);
+    }
+    result.id = library.find(result.part->name());
+    if (result.id == assembly::kInvalidPart) {
+        result.id = library.add(result.part);
+    } else {
+        library.replace(result.id, result.part);
+    }
+    return result;
+}
+
+assembly::PartPtr NativeDocument::load(const PartRecord& r) const {
+    REBEL_TRACE_ZONE_DETAIL("native.load_part", string(r.name));
+    using namespace layout;
+    const std::uint64_t v = r.vertexCount;
+    const std::uint64_t c = 3 * r.triangleCount;
+    const std::uint64_t t = r.triangleCount;
+
+    geometry::MeshView mesh;
+    mesh.vertexCount = v;
+    mesh.triangleCount = t;
+    mesh.px = array<float>(r, kPx, v);
+    mesh.py = array<float>(r, kPy, v);
+    mesh.pz = array<float>(r, kPz, v);
+    mesh.nx = array<float>(r, kNx, v);
+    mesh.ny = array<float>(r, kNy, v);
+    mesh.nz = array<float>(r, kNz, v);
+    mesh.u = array<float>(r, kU, v);
+    mesh.v = array<float>(r, kV, v);
+    mesh.corners = array<geometry::VertexIndex>(r, kCorners, c);
+    mesh.opposites = array<geometry::CornerIndex>(r, kOpposites, c);
+
+    spatial::BvhView bvh;
+    bvh.nodeCount = r.arrays[kBvhNodes].count;
+    bvh.nodes = array<spatial::BvhNode>(r, kBvhNodes, bvh.nodeCount);
+    bvh.primitiveCount = t;
+    bvh.primitives = array<std::uint32_t>(r, kBvhPrimitives, t);
+
+    math::batch::TriangleBatch tri{array<float>(r, kV0x, t), array<float>(r, kV0y, t), array<float>(r, kV0z, t),
+                                   array<float>(r, kE1x, t), array<float>(r, kE1y, t), array<float>(r, kE1z, t),
+                                   array<float>(r, kE2x, t), array<float>(r, kE2y, t), array<float>(r, kE2z, t),
+                                   t};
+
+    const bool missingVertices = v > 0 && (mesh.px == nullptr || mesh.py == nullptr || mesh.pz == nullptr);
+    const bool missingTriangles = t > 0 && (mesh.corners == nullptr || bvh.nodes == nullptr ||
+                                            bvh.primitives == nullptr || tri.v0x == nullptr || tri.v0y == nullptr ||
+                                            tri.v0z == nullptr || tri.e1x == nullptr || tri.e1y == nullptr ||
+                                            tri.e1z == nullptr || tri.e2x == nullptr || tri.e2y == nullptr ||
+                                            tri.e2z == nullptr);
+    const bool partialNormals =
+        (mesh.nx == nullptr) != (mesh.ny == nullptr) || (mesh.nx == nullptr) != (mesh.nz == nullptr);
+    const bool partialUvs = (mesh.u == nullptr) != (mesh.v == nullptr);
+    if (missingVertices || missingTriangles || partialNormals || partialUvs) {
+        throw corrupt(file_->path(), "part section is incomplete");
+    }
+    // Indices are used unchecked by queries and traversal; one pass over
+    // them here keeps a damaged section from reading outside the mapping.
+    if (!validCorners(mesh)) {
+        throw corrupt(file_->path(), "triangle corners out of range");
+    }
+    if (!validBvh(bvh)) {
+        throw corrupt(file_->path(), "BVH out of range");
+    }
+    return assembly::Part::create(std::string(string(r.name)), mesh, spatial::MeshBvh::wrap(bvh, tri, file_), file_);
+}
+
+bool NativeDocument::verifyPart(std::uint32_t part) const {
+    const PartRecord& r = record(part);
+    if (!fits({r.sectionOffset, r.sectionSize}, 1, file_->size())) {
+        return false;
+    }
+    return core::hashBytes(file_->data() + r.sectionOffset, r.sectionSize) == r.sectionHash;
+}
+
+brep::Body NativeDocument::loadBody(std::uint32_t part) const {
+    using namespace layout;
+    const PartRecord& r = record(part);
+    if ((r.flags & PartRecord::kHasBody) == 0) {
+        throw std::runtime_error("part " + std::string(string(r.name)) + " has no B-rep");
+    }
+    const ArrayRef* a = r.arrays;
+    const auto* vertices = array<math::Vec3d>(r, kBrepVertices, a[kBrepVertices].count);
+    const auto* edges = array<BrepEdgeRecord>(r, kBrepEdges, a[kBrepEdges].count);
+    const auto* faces = array<BrepFaceRecord>(r, kBrepFaces, a[kBrepFaces].count);
+    const auto* curveRecords = array<brep::GeometryRecord>(r, kBrepCurves, a[kBrepCurves].count);
+    const auto* surfaceRecords = array<brep::GeometryRecord>(r, kBrepSurfaces, a[kBrepSurfaces].count);
+
+    brep::Body body;
+    try {
+        std::vector<brep::CurvePtr> curves;
+        for (std::uint64_t i = 0; i < a[kBrepCurves].count; ++i) {
+            curves.push_back(brep::makeCurve(curveRecords[i]));
+        }
+        std::vector<brep::SurfacePtr> surfaces;
+        for (std::uint64_t i = 0; i < a[kBrepSurfaces].count; ++i) {
+            surfaces.push_back(brep::makeSurface(surfaceRecords[i]));
+        }
+        for (std::uint64_t i = 0; i < a[kBrepVertices].count; ++i) {
+            body.addVertex(vertices[i]);
+        }
+        for (std::uint64_t i = 0; i < a[kBrepEdges].count; ++i) {
+            const BrepEdgeRecord& e = edges[i];
+            body.addEdge(curves.at(e.curve), e.t0, e.t1, e.start, e.end);
+        }
+        for (std::uint64_t i = 0; i < a[kBrepFaces].count; ++i) {
+            const BrepFaceRecord& f = faces[i];
+            std::array<brep::Coedge, 4> sides;
+            for (int s = 0; s < 4; ++s) {
+                sides[s] = {f.sideEdges[s], (f.reversedSides & (1u << s)) != 0};
+            }
+            body.addFace(surfaces.at(f.surface), {f.u0, f.u1, f.v0, f.v1}, sides, f.reversed != 0);
+        }
+    } catch (const std::logic_error& e) {
+        throw corrupt(file_->path(), e.what());
+    }
+    return body;
+}
+
+const NodeRecord& NativeDocument::node(std::uint32_t node) const {
+    if (node >= nodeCount_) {
+        throw std::out_of_range("unknown node record " + std::to_string(node));
+    }
+    return nodes_[node];
+}
+
+std::string_view NativeDocument::nodeName(std::uint32_t node) const {
+    return string(this->node(node).name);
+}
+
+assembly::NodeId NativeDocument::loadSubassembly(std::uint32_t node, assembly::Assembly& target,
+                                                 assembly::NodeId parent, assembly::PartLibrary& library,
+                                                 const NativeLoadOptions& options) const {
+    std::unordered_map<std::uint32_t, assembly::PartId> partIds;
+    auto resolvePart = [&](std::uint32_t part) {
+        const auto it = partIds.find(part);
+        if (it != partIds.end()) {
+            return it->second;
+        }
+        const std::string name(string(record(part).name));
+        assembly::PartId id = library.find(name);
+        if (id == assembly::kInvalidPart) {
+            id = library.add(options.detail == LoadDetail::Graphics ? loadLod(part, options.lod) : loadPart(part));
+        }
+        partIds.emplace(part, id);
+        return id;
+    };
+    auto copyNode = [&](std::uint32_t n, assembly::NodeId into) {
+        const NodeRecord& r = this->node(n);
+        std::string name(string(r.name));
+        const assembly::NodeId id = r.part == layout::kNone
+                                        ? target.addSubassembly(into, r.local, std::move(name))
+                                        : target.addOccurrence(into, resolvePart(r.part), r.local, std::move(name));
+        if (r.overrideFlags != 0 || r.colorRgba != 0) {
+            target.setOverrides(id, {r.colorRgba, static_cast<std::uint8_t>(r.overrideFlags)});
+        }
+        return id;
+    };
+
+    const assembly::NodeId top = node == 0 ? parent : copyNode(node, parent);
+    struct Pending {
+        std::uint32_t file;
+        assembly::NodeId copy;
+    };
+    std::vector<Pending> stack{{node, top}};
+    std::vector<std::uint32_t> children;
+    while (!stack.empty()) {
+        const Pending p = stack.back();
+        stack.pop_back();
+        // Records are numbered depth-first, so children always come after
+        // their parent; anything else is a corrupt (possibly cyclic) table.
+        children.clear();
+        for (std::uint32_t c = this->node(p.file).firstChild; c != layout::kNone; c = this->node(c).nextSibling) {
+            if (c <= p.file || nodes_[c].parent != p.file || children.size() >= nodeCount_) {
+                throw corrupt(file_->path(), "assembly records are not a tree");
+            }
+            children.push_back(c);
+        }
+        // `Assembly` prepends children; adding them in reverse keeps the
+        // original order.
+        for (auto c = children.rbegin(); c != children.rend(); ++c) {
+            const assembly::NodeId copy = copyNode(*c, p.copy);
+            if (nodes_[*c].part == layout::kNone) {
+                stack.push_back({*c, copy});
+            }
+        }
+    }
+    return top;
+}
+
+void NativeDocument::loadAssembly(assembly::Assembly& target, assembly::PartLibrary& library,
+                                  const NativeLoadOptions& options) const {
+    if (!hasAssembly()) {
+        return;
+    }
+    target.setLocalTransform(target.root(), nodes_[0].local);
+    loadSubassembly(0, target, target.root(), library, options);
+}
+
+} // namespace rebel::io
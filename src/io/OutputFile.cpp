@@ -0,0 +1,186 @@
+#include "rebel/io/OutputFile.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <system_error>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace rebel::io {
+
+namespace {
+
+/// Small writes are gathered into buffers of this size.
+constexpr std::size_t kSmallBuffer = std::size_t(64) << 10;
+/// Queued bytes that trigger a write on their own.
+constexpr std::size_t kFlushBytes = std::size_t(32) << 20;
+
+#ifndef _WIN32
+#ifdef IOV_MAX
+constexpr std::size_t kMaxVectors = IOV_MAX;
+#else
+constexpr std::size_t kMaxVectors = 1024;
+#endif
+#endif
+
+} // namespace
+
+OutputFile::OutputFile(std::string path) : path_(std::move(path)), staging_(path_ + ".partial") {
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(staging_.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("cannot create " + path_);
+    }
+    handle_ = handle;
+#else
+    fd_ = ::open(staging_.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error("cannot create " + path_);
+    }
+#endif
+}
+
+OutputFile::~OutputFile() {
+    if (!committed_) {
+        close();
+        std::error_code error;
+        std::filesystem::remove(staging_, error);
+    }
+}
+
+void OutputFile::write(const void* data, std::size_t size) {
+    if (size == 0) {
+        return;
+    }
+    if (!small_ || pending_.back().size() + size > kSmallBuffer) {
+        pending_.emplace_back().reserve(std::max(size, kSmallBuffer));
+        small_ = true;
+    }
+    const auto* bytes = static_cast<const std::uint8_t*>(data);
+    pending_.back().insert(pending_.back().end(), bytes, bytes + size);
+    pendingBytes_ += size;
+    position_ += size;
+    if (pendingBytes_ >= kFlushBytes) {
+        flush();
+    }
+}
+
+void OutputFile::write(std::vector<std::uint8_t> chunk) {
+    if (chunk.empty()) {
+        return;
+    }
+    pendingBytes_ += chunk.size();
+    position_ += chunk.size();
+    pending_.push_back(std::move(chunk));
+    small_ = false;
+#ifndef _WIN32
+    if (pending_.size() >= kMaxVectors) {
+        flush();
+        return;
+    }
+#endif
+    if (pendingBytes_ >= kFlushBytes) {
+        flush();
+    }
+}
+
+void OutputFile::flush() {
+    if (pending_.empty()) {
+        return;
+    }
+#ifdef _WIN32
+    for (const std::vector<std::uint8_t>& chunk : pending_) {
+        const std::uint8_t* data = chunk.data();
+        std::size_t left = chunk.size();
+        while (left > 0) {
+            const DWORD request = static_cast<DWORD>(std::min<std::size_t>(left, DWORD(1) << 30));
+            DWORD written = 0;
+            if (!WriteFile(static_cast<HANDLE>(handle_), data, request, &written, nullptr) || written == 0) {
+                throw std::runtime_error("cannot write " + path_);
+            }
+            data += written;
+            left -= written;
+        }
+    }
+#else
+    std::vector<iovec> vectors(pending_.size());
+    for (std::size_t i = 0; i < pending_.size(); ++i) {
+        vectors[i].iov_base = pending_[i].data();
+        vectors[i].iov_len = pending_[i].size();
+    }
+    std::size_t first = 0;
+    while (first < vectors.size()) {
+        const int count = static_cast<int>(std::min(vectors.size() - first, kMaxVectors));
+        const ssize_t written = ::writev(fd_, vectors.data() + first, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("cannot write " + path_ + ": " + std::strerror(errno));
+        }
+        // Short writes leave the rest of the batch for the next call.
+        auto left = static_cast<std::size_t>(written);
+        while (first < vectors.size() && left >= vectors[first].iov_len) {
+            left -= vectors[first].iov_len;
+            ++first;
+        }
+        if (left > 0) {
+            vectors[first].iov_base = static_cast<std::uint8_t*>(vectors[first].iov_base) + left;
+            vectors[first].iov_len -= left;
+        }
+    }
+#endif
+    pending_.clear();
+    pendingBytes_ = 0;
+    small_ = false;
+}
+
+void OutputFile::commit() {
+    flush();
+#ifdef _WIN32
+    const bool closed = handle_ == nullptr || CloseHandle(static_cast<HANDLE>(handle_));
+    handle_ = nullptr;
+#else
+    const bool closed = fd_ < 0 || ::close(fd_) == 0;
+    fd_ = -1;
+#endif
+    if (!closed) {
+        throw std::runtime_error("cannot write " + path_);
+    }
+    std::error_code error;
+    std::filesystem::rename(staging_, path_, error);
+    if (error) {
+        throw std::runtime_error("cannot write " + path_);
+    }
+    committed_ = true;
+}
+
+void OutputFile::close() {
+#ifdef _WIN32
+    if (handle_ != nullptr) {
+        CloseHandle(static_cast<HANDLE>(handle_));
+        handle_ = nullptr;
+    }
+#else
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+#endif
+}
+
+} // namespace rebel::io
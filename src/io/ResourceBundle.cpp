@@ -0,0 +1,279 @@
+#include "rebel/io/ResourceBundle.hpp"
+
+#include "rebel/core/Hash.hpp"
+#include "rebel/core/Trace.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <system_error>
+
+namespace rebel::io {
+
+using layout::ArrayRef;
+using layout::StringRef;
+
+struct ResourceBundle::Entry {
+    StringRef name;
+    std::uint64_t offset = 0;
+    std::uint64_t size = 0;
+    core::Hash128 hash;
+};
+
+namespace {
+
+constexpr char kBundleMagic[8] = {'R', 'E', 'B', 'E', 'L', 'R', 'E', 'S'};
+constexpr std::uint32_t kBundleVersion = 1;
+
+struct BundleHeader {
+    char magic[8] = {};
+    std::uint32_t version = 0;
+    std::uint32_t byteOrder = 0;
+    std::uint64_t fileSize = 0;
+    /// `Entry`s sorted by name.
+    ArrayRef entries;
+    /// UTF-8 names referenced by the entries.
+    ArrayRef strings;
+    /// Hash of both tables, checked on open.
+    core::Hash128 tablesHash;
+    std::uint8_t reserved[56] = {};
+};
+
+static_assert(sizeof(BundleHeader) == 128, "BundleHeader must stay 128 bytes");
+
+bool fits(std::uint64_t offset, std::uint64_t count, std::size_t elementSize, std::size_t fileSize) {
+    if (offset > fileSize) {
+        return false;
+    }
+    return count <= (fileSize - offset) / elementSize;
+}
+
+std::runtime_error corrupt(const std::string& path, const char* what) {
+    return std::runtime_error(path + ": " + what);
+}
+
+} // namespace
+
+void ResourceBundleWriter::add(std::string name, const void* data, std::size_t size) {
+    const auto* bytes = static_cast<const std::uint8_t*>(data);
+    add(std::move(name), std::vector<std::uint8_t>(bytes, bytes + size));
+}
+
+void ResourceBundleWriter::add(std::string name, std::vector<std::uint8_t> bytes) {
+    auto storage = std::make_shared<const std::vector<std::uint8_t>>(std::move(bytes));
+    Pending pending{nullptr, storage->data(), storage->size()};
+    pending.storage = std::move(storage);
+    pending_[std::move(name)] = std::move(pending);
+}
+
+void ResourceBundleWriter::addFile(std::string name, const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("cannot read " + path);
+    }
+    std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (in.bad()) {
+        throw std::runtime_error("cannot read " + path);
+    }
+    add(std::move(name), std::move(bytes));
+}
+
+void ResourceBundleWriter::addBundle(const std::shared_ptr<const ResourceBundle>& bundle) {
+    for (std::uint32_t i = 0; i < bundle->size(); ++i) {
+        const Resource r = bundle->resource(i);
+        pending_[std::string(r.name)] = Pending{bundle, r.data, r.size};
+    }
+}
+
+void ResourceBundleWriter::write(const std::string& path) const {
+    REBEL_TRACE_ZONE_DETAIL("bundle.write", path);
+    const std::string staging = path + ".partial";
+    {
+        std::ofstream stream(staging, std::ios::binary | std::ios::trunc);
+        if (!stream) {
+            throw std::runtime_error("cannot create " + path);
+        }
+        std::uint64_t position = 0;
+        auto write = [&](const void* data, std::size_t bytes) {
+            stream.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+            position += bytes;
+        };
+        auto pad = [&] {
+            static const std::uint8_t zeros[layout::kArrayAlignment] = {};
+            write(zeros, static_cast<std::size_t>((layout::kArrayAlignment - position % layout::kArrayAlignment) %
+                                                  layout::kArrayAlignment));
+        };
+
+        BundleHeader header;
+        write(&header, sizeof(header));
+        std::vector<ResourceBundle::Entry> entries;
+        entries.reserve(pending_.size());
+        std::string strings;
+        for (const auto& [name, pending] : pending_) {
+            pad();
+            ResourceBundle::Entry entry;
+            entry.name = {static_cast<std::uint32_t>(strings.size()), static_cast<std::uint32_t>(name.size())};
+            entry.offset = position;
+            entry.size = pending.size;
+            entry.hash = core::Hasher().addBytes(pending.data, pending.size).finish();
+            strings += name;
+            write(pending.data, pending.size);
+            entries.push_back(entry);
+        }
+        pad();
+        header.entries = {position, entries.size()};
+        write(entries.data(), entries.size() * sizeof(ResourceBundle::Entry));
+        header.strings = {position, strings.size()};
+        write(strings.data(), strings.size());
+
+        std::memcpy(header.magic, kBundleMagic, sizeof(header.magic));
+        header.version = kBundleVersion;
+        header.byteOrder = layout::kByteOrderMark;
+        header.fileSize = position;
+        header.tablesHash = core::Hasher()
+                                .addBytes(entries.data(), entries.size() * sizeof(ResourceBundle::Entry))
+                                .addBytes(strings.data(), strings.size())
+                                .finish();
+        stream.seekp(0);
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        stream.flush();
+        if (!stream) {
+            throw std::runtime_error("cannot write " + path);
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(staging, path, error);
+    if (error) {
+        std::filesystem::remove(staging, error);
+        throw std::runtime_error("cannot write " + path);
+    }
+}
+
+std::shared_ptr<const ResourceBundle> ResourceBundle::open(const std::string& path) {
+    REBEL_TRACE_ZONE_DETAIL("bundle.open", path);
+    std::shared_ptr<ResourceBundle> bundle(new ResourceBundle());
+    bundle->file_ = MappedFile::open(path);
+    const MappedFile& file = *bundle->file_;
+    if (file.size() < sizeof(BundleHeader)) {
+        throw corrupt(path, "not a resource bundle");
+    }
+    BundleHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, kBundleMagic, sizeof(header.magic)) != 0) {
+        throw corrupt(path, "not a resource bundle");
+    }
+    if (header.byteOrder != layout::kByteOrderMark) {
+        throw corrupt(path, "written with a different byte order");
+    }
+    if (header.version != kBundleVersion) {
+        throw corrupt(path, "unsupported bundle version");
+    }
+    if (header.fileSize != file.size()) {
+        throw corrupt(path, "truncated");
+    }
+    if (!fits(header.entries.offset, header.entries.count, sizeof(Entry), file.size()) ||
+        !fits(header.strings.offset, header.strings.count, 1, file.size()) ||
+        header.entries.offset % alignof(Entry) != 0) {
+        throw corrupt(path, "tables out of range");
+    }
+    const std::size_t entryBytes = static_cast<std::size_t>(header.entries.count) * sizeof(Entry);
+    const core::Hash128 tablesHash = core::Hasher()
+                                         .addBytes(file.data() + header.entries.offset, entryBytes)
+                                         .addBytes(file.data() + header.strings.offset, header.strings.count)
+                                         .finish();
+    if (tablesHash != header.tablesHash) {
+        throw corrupt(path, "tables do not match their hash");
+    }
+
+    bundle->entries_ = reinterpret_cast<const Entry*>(file.data() + header.entries.offset);
+    bundle->entryCount_ = header.entries.count;
+    bundle->strings_ = reinterpret_cast<const char*>(file.data() + header.strings.offset);
+    bundle->stringBytes_ = header.strings.count;
+    // Checking the table once lets lookups trust it; the resources
+    // themselves are not touched.
+    for (std::size_t i = 0; i < bundle->entryCount_; ++i) {
+        const Entry& e = bundle->entries_[i];
+        const auto index = static_cast<std::uint32_t>(i);
+        if (std::uint64_t(e.name.offset) + e.name.length > bundle->stringBytes_ ||
+            !fits(e.offset, e.size, 1, file.size()) || (i > 0 && !(bundle->name(index - 1) < bundle->name(index)))) {
+            throw corrupt(path, "resource table out of range or unsorted");
+        }
+    }
+    return bundle;
+}
+
+std::string_view ResourceBundle::name(std::uint32_t index) const {
+    const StringRef& ref = entries_[index].name;
+    return {strings_ + ref.offset, ref.length};
+}
+
+Resource ResourceBundle::resource(std::uint32_t index) const {
+    if (index >= entryCount_) {
+        throw std::out_of_range("unknown resource " + std::to_string(index));
+    }
+    const Entry& e = entries_[index];
+    return {name(index), file_->data() + e.offset, static_cast<std::size_t>(e.size)};
+}
+
+std::uint32_t ResourceBundle::find(std::string_view name) const {
+    std::uint32_t lo = 0;
+    auto hi = static_cast<std::uint32_t>(entryCount_);
+    while (lo < hi) {
+        const std::uint32_t mid = lo + (hi - lo) / 2;
+        if (this->name(mid) < name) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo < entryCount_ && this->name(lo) == name ? lo : kNotFound;
+}
+
+Resource ResourceBundle::get(std::string_view name) const {
+    const std::uint32_t index = find(name);
+    if (index == kNotFound) {
+        throw std::out_of_range("no resource \"" + std::string(name) + "\"");
+    }
+    return resource(index);
+}
+
+std::pair<std::uint32_t, std::uint32_t> ResourceBundle::range(std::string_view prefix) const {
+    auto lowerBound = [&](auto&& before) {
+        std::uint32_t lo = 0;
+        auto hi = static_cast<std::uint32_t>(entryCount_);
+        while (lo < hi) {
+            const std::uint32_t mid = lo + (hi - lo) / 2;
+            if (before(name(mid))) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    };
+    const std::uint32_t first = lowerBound([&](std::string_view n) { return n < prefix; });
+    const std::uint32_t last = lowerBound([&](std::string_view n) { return n.substr(0, prefix.size()) <= prefix; });
+    return {first, std::max(first, last)};
+}
+
+bool ResourceBundle::verify(std::uint32_t index) const {
+    const Resource r = resource(index);
+    return core::Hasher().addBytes(r.data, r.size).finish() == entries_[index].hash;
+}
+
+void ResourceBundle::prefetch(std::uint32_t first, std::uint32_t last) const {
+    last = std::min(last, static_cast<std::uint32_t>(entryCount_));
+    if (first >= last) {
+        return;
+    }
+    // Resources are stored in name order, so a range is one region.
+    const Entry& begin = entries_[first];
+    const Entry& end = entries_[last - 1];
+    file_->prefetch(static_cast<std::size_t>(begin.offset),
+                    static_cast<std::size_t>(end.offset + end.size - begin.offset));
+}
+
+} // namespace rebel::io
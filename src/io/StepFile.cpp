@@ -0,0 +1,607 @@
+#include "rebel/io/StepFile.hpp"
+
+#include "rebel/core/TaskScheduler.hpp"
+#include "rebel/core/Trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace rebel::io {
+
+namespace {
+
+/// Lexer of the exchange structure as a byte-at-a-time DFA, so chunks can be
+/// scanned independently from every state they might start in.
+enum LexState : std::uint8_t {
+    kCode,
+    kCodeSlash,
+    kString,
+    kStringQuote,
+    kComment,
+    kCommentStar,
+    kStateCount,
+};
+
+enum ByteClass : std::uint8_t {
+    kOther,
+    kQuote,
+    kSlash,
+    kStar,
+    kSemicolon,
+    kClassCount,
+};
+
+constexpr std::array<std::array<LexState, kClassCount>, kStateCount> kTransitions = {{
+    // other,      quote,        slash,      star,         semicolon
+    {{kCode, kString, kCodeSlash, kCode, kCode}},             // kCode
+    {{kCode, kString, kCodeSlash, kComment, kCode}},          // kCodeSlash
+    {{kString, kStringQuote, kString, kString, kString}},     // kString
+    {{kCode, kString, kCodeSlash, kCode, kCode}},             // kStringQuote: string closed
+    {{kComment, kComment, kComment, kCommentStar, kComment}}, // kComment
+    {{kComment, kComment, kCode, kCommentStar, kComment}},    // kCommentStar
+}};
+
+/// States a chunk can start in. Chunks start right after a newline, which
+/// leaves no half-read two-byte token behind.
+constexpr LexState kStartStates[] = {kCode, kString, kComment};
+constexpr int kStartStateCount = 3;
+
+struct ByteClasses {
+    std::uint8_t table[256] = {};
+    constexpr ByteClasses() {
+        table[static_cast<unsigned char>('\'')] = kQuote;
+        table[static_cast<unsigned char>('/')] = kSlash;
+        table[static_cast<unsigned char>('*')] = kStar;
+        table[static_cast<unsigned char>(';')] = kSemicolon;
+    }
+};
+
+constexpr ByteClasses kByteClasses;
+
+int startIndex(LexState s) {
+    switch (s) {
+    case kCode:
+    case kCodeSlash:
+    case kStringQuote:
+        return 0;
+    case kString:
+        return 1;
+    default:
+        return 2;
+    }
+}
+
+bool isTerminator(LexState before, std::uint8_t cls) {
+    return cls == kSemicolon && (before == kCode || before == kCodeSlash || before == kStringQuote);
+}
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+bool isKeywordChar(char c) {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_' || c == '-';
+}
+
+/// Skips whitespace and comments in statement text.
+std::size_t skipSpace(std::string_view s, std::size_t i) {
+    while (i < s.size()) {
+        if (isSpace(s[i])) {
+            ++i;
+        } else if (s[i] == '/' && i + 1 < s.size() && s[i + 1] == '*') {
+            const std::size_t end = s.find("*/", i + 2);
+            i = end == std::string_view::npos ? s.size() : end + 2;
+        } else {
+            break;
+        }
+    }
+    return i;
+}
+
+/// End of the balanced parenthesized list starting at `s[i] == '('`, or
+/// npos. Strings and comments are skipped.
+std::size_t matchList(std::string_view s, std::size_t i) {
+    int depth = 0;
+    while (i < s.size()) {
+        const char c = s[i];
+        if (c == '\'') {
+            for (++i; i < s.size(); ++i) {
+                if (s[i] == '\'') {
+                    if (i + 1 < s.size() && s[i + 1] == '\'') {
+                        ++i;
+                    } else {
+                        break;
+                    }
+                }
+            }
+        } else if (c == '/' && i + 1 < s.size() && s[i + 1] == '*') {
+            const std::size_t end = s.find("*/", i + 2);
+            i = end == std::string_view::npos ? s.size() : end + 1;
+        } else if (c == '(') {
+            ++depth;
+        } else if (c == ')') {
+            if (--depth == 0) {
+                return i + 1;
+            }
+        }
+        ++i;
+    }
+    return std::string_view::npos;
+}
+
+struct Chunk {
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    /// End state for each of `kStartStates`.
+    LexState exitState[kStartStateCount] = {};
+    LexState entryState = kCode;
+    /// Offset of the chunk's first terminator, and of its last.
+    std::size_t firstTerminator = std::string_view::npos;
+    std::size_t lastTerminator = std::string_view::npos;
+    std::vector<std::string_view> types;
+    std::unordered_map<std::string_view, std::uint32_t> typeIndex;
+    std::vector<std::string_view> schemaStatements;
+};
+
+} // namespace
+
+std::shared_ptr<const StepFile> StepFile::open(const std::string& path, const StepIndexOptions& options) {
+    REBEL_TRACE_ZONE_DETAIL("step.index", path);
+    std::shared_ptr<StepFile> step(new StepFile());
+    step->file_ = MappedFile::open(path);
+    const std::string_view text(reinterpret_cast<const char*>(step->file_->data()), step->file_->size());
+    const std::size_t magic = skipSpace(text, 0);
+    if (text.compare(magic, 13, "ISO-10303-21;") != 0) {
+        throw std::runtime_error(path + ": not an ISO 10303-21 file");
+    }
+
+    // Chunk boundaries sit just after a newline.
+    std::vector<Chunk> chunks;
+    const std::size_t chunkBytes = std::max<std::size_t>(options.chunkBytes, 4096);
+    for (std::size_t begin = 0; begin < text.size();) {
+        std::size_t end = std::min(text.size(), begin + chunkBytes);
+        if (end < text.size()) {
+            const std::size_t nl = text.find('\n', end - 1);
+            end = nl == std::string_view::npos ? text.size() : nl + 1;
+        }
+        Chunk chunk;
+        chunk.begin = begin;
+        chunk.end = end;
+        chunks.push_back(std::move(chunk));
+        begin = end;
+    }
+
+    // Pass 1: the lexer state each chunk ends in, for every start state.
+    core::parallelFor(0, chunks.size(), 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t c = first; c < last; ++c) {
+            Chunk& chunk = chunks[c];
+            LexState s[kStartStateCount] = {kStartStates[0], kStartStates[1], kStartStates[2]};
+            for (std::size_t i = chunk.begin; i < chunk.end; ++i) {
+                const std::uint8_t cls = kByteClasses.table[static_cast<unsigned char>(text[i])];
+                s[0] = kTransitions[s[0]][cls];
+                s[1] = kTransitions[s[1]][cls];
+                s[2] = kTransitions[s[2]][cls];
+            }
+            for (int k = 0; k < kStartStateCount; ++k) {
+                chunk.exitState[k] = s[k];
+            }
+        }
+    });
+    LexState state = kCode;
+    for (Chunk& chunk : chunks) {
+        chunk.entryState = state;
+        state = chunk.exitState[startIndex(state)];
+    }
+
+    // Pass 2: terminators and the statements between them. A statement is
+    // indexed by the chunk its terminator lies in; the first one of each
+    // chunk starts in an earlier chunk and is handled afterwards.
+    std::vector<std::vector<Record>> chunkRecords(chunks.size());
+    auto addStatement = [&](Chunk& chunk, std::vector<Record>& out, std::size_t begin, std::size_t term) {
+        const std::string_view s = text.substr(begin, term - begin);
+        std::size_t i = skipSpace(s, 0);
+        if (i >= s.size()) {
+            return;
+        }
+        if (s[i] != '#') {
+            std::size_t k = i;
+            while (k < s.size() && isKeywordChar(s[k])) {
+                ++k;
+            }
+            if (s.substr(i, k - i) == "FILE_SCHEMA") {
+                chunk.schemaStatements.push_back(s.substr(k));
+            }
+            return;
+        }
+        StepId id = 0;
+        const auto [idEnd, ec] = std::from_chars(s.data() + i + 1, s.data() + s.size(), id);
+        if (ec != std::errc() || id == 0) {
+            return;
+        }
+        i = skipSpace(s, static_cast<std::size_t>(idEnd - s.data()));
+        if (i >= s.size() || s[i] != '=') {
+            return;
+        }
+        i = skipSpace(s, i + 1);
+        std::uint32_t type = 0;
+        if (i < s.size() && s[i] != '(') {
+            std::size_t k = i;
+            while (k < s.size() && isKeywordChar(s[k])) {
+                ++k;
+            }
+            const std::string_view name = s.substr(i, k - i);
+            const auto [it, added] =
+                chunk.typeIndex.emplace(name, static_cast<std::uint32_t>(chunk.types.size() + 1));
+            if (added) {
+                chunk.types.push_back(name);
+            }
+            type = it->second;
+            i = skipSpace(s, k);
+        }
+        std::size_t end = s.size();
+        while (end > i && isSpace(s[end - 1])) {
+            --end;
+        }
+        out.push_back({id, begin + i, static_cast<std::uint32_t>(end - i), type});
+    };
+    core::parallelFor(0, chunks.size(), 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t c = first; c < last; ++c) {
+            Chunk& chunk = chunks[c];
+            LexState s = chunk.entryState;
+            std::size_t previous = std::string_view::npos;
+            for (std::size_t i = chunk.begin; i < chunk.end; ++i) {
+                const std::uint8_t cls = kByteClasses.table[static_cast<unsigned char>(text[i])];
+                if (isTerminator(s, cls)) {
+                    if (previous == std::string_view::npos) {
+                        chunk.firstTerminator = i;
+                    } else {
+                        addStatement(chunk, chunkRecords[c], previous + 1, i);
+                    }
+                    previous = i;
+                }
+                s = kTransitions[s][cls];
+            }
+            chunk.lastTerminator = previous;
+        }
+    });
+    // Statements that straddle chunks; they belong in front of their
+    // terminator's chunk.
+    std::vector<std::vector<Record>> heads(chunks.size());
+    std::size_t previous = std::string_view::npos;
+    for (std::size_t c = 0; c < chunks.size(); ++c) {
+        Chunk& chunk = chunks[c];
+        if (chunk.firstTerminator == std::string_view::npos) {
+            continue;
+        }
+        addStatement(chunk, heads[c], previous == std::string_view::npos ? 0 : previous + 1, chunk.firstTerminator);
+        previous = chunk.lastTerminator;
+    }
+
+    // Merge the per-chunk keyword tables.
+    std::unordered_map<std::string_view, std::uint32_t> globalTypes;
+    step->types_.push_back({});
+    std::vector<std::vector<std::uint32_t>> remap(chunks.size());
+    std::size_t total = 0;
+    for (std::size_t c = 0; c < chunks.size(); ++c) {
+        remap[c].push_back(0);
+        for (const std::string_view name : chunks[c].types) {
+            const auto [it, added] = globalTypes.emplace(name, static_cast<std::uint32_t>(step->types_.size()));
+            if (added) {
+                step->types_.push_back(name);
+            }
+            remap[c].push_back(it->second);
+        }
+        total += heads[c].size() + chunkRecords[c].size();
+        for (const std::string_view schema : chunks[c].schemaStatements) {
+            StepParams params(schema);
+            params.beginList();
+            while (!params.atEnd()) {
+                step->schemas_.push_back(params.string());
+            }
+            params.endList();
+        }
+    }
+    step->records_.reserve(total);
+    for (std::size_t c = 0; c < chunks.size(); ++c) {
+        for (const std::vector<Record>* part : {&heads[c], &chunkRecords[c]}) {
+            for (Record r : *part) {
+                r.type = remap[c][r.type];
+                step->records_.push_back(r);
+            }
+        }
+        std::vector<Record>().swap(chunkRecords[c]);
+    }
+    std::vector<Chunk>().swap(chunks);
+
+    std::vector<Record>& records = step->records_;
+    if (!std::is_sorted(records.begin(), records.end(), [](const Record& a, const Record& b) { return a.id < b.id; })) {
+        std::stable_sort(records.begin(), records.end(), [](const Record& a, const Record& b) { return a.id < b.id; });
+    }
+    const StepId maxId = records.empty() ? 0 : records.back().id;
+    if (maxId < 2 * records.size() + 1024) {
+        step->byId_.assign(maxId + 1, 0xFFFFFFFFu);
+        for (std::size_t i = records.size(); i-- > 0;) {
+            step->byId_[records[i].id] = static_cast<std::uint32_t>(i);
+        }
+    }
+    return step;
+}
+
+StepEntity StepFile::make(const Record& record) const {
+    const char* base = reinterpret_cast<const char*>(file_->data());
+    return {record.id, types_[record.type], std::string_view(base + record.offset, record.length)};
+}
+
+StepEntity StepFile::entity(StepId id) const {
+    if (!byId_.empty()) {
+        if (id >= byId_.size() || byId_[id] == 0xFFFFFFFFu) {
+            return {};
+        }
+        return make(records_[byId_[id]]);
+    }
+    const auto it = std::lower_bound(records_.begin(), records_.end(), id,
+                                     [](const Record& r, StepId value) { return r.id < value; });
+    return it == records_.end() || it->id != id ? StepEntity{} : make(*it);
+}
+
+StepEntity StepFile::entityAt(std::size_t index) const {
+    return make(records_.at(index));
+}
+
+std::uint32_t StepFile::findType(std::string_view type) const {
+    for (std::uint32_t i = 1; i < types_.size(); ++i) {
+        if (types_[i] == type) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+std::string_view StepFile::component(const StepEntity& entity, std::string_view type) {
+    if (!entity.isComplex()) {
+        return entity.type == type ? entity.params : std::string_view{};
+    }
+    const std::string_view s = entity.params;
+    std::size_t i = skipSpace(s, 0);
+    if (i >= s.size() || s[i] != '(') {
+        return {};
+    }
+    i = skipSpace(s, i + 1);
+    while (i < s.size() && s[i] != ')') {
+        std::size_t k = i;
+        while (k < s.size() && isKeywordChar(s[k])) {
+            ++k;
+        }
+        const std::string_view name = s.substr(i, k - i);
+        k = skipSpace(s, k);
+        const std::size_t end = matchList(s, k);
+        if (k == i || end == std::string_view::npos) {
+            return {};
+        }
+        if (name == type) {
+            return s.substr(k, end - k);
+        }
+        i = skipSpace(s, end);
+    }
+    return {};
+}
+
+std::size_t StepFile::memoryBytes() const {
+    return records_.capacity() * sizeof(Record) + byId_.capacity() * sizeof(std::uint32_t) +
+           types_.capacity() * sizeof(std::string_view);
+}
+
+StepParams::StepParams(std::string_view text) : text_(text) {
+    beginList();
+}
+
+void StepParams::skipSpace() {
+    pos_ = io::skipSpace(text_, pos_);
+}
+
+void StepParams::separator() {
+    skipSpace();
+    if (pos_ < text_.size() && text_[pos_] == ',') {
+        ++pos_;
+    }
+}
+
+void StepParams::fail(const char* what) const {
+    throw std::runtime_error(std::string("STEP parameters: ") + what + " at offset " + std::to_string(pos_) +
+                             " of '" + std::string(text_.substr(0, 80)) + "'");
+}
+
+void StepParams::beginList() {
+    skipSpace();
+    if (pos_ >= text_.size() || text_[pos_] != '(') {
+        fail("expected a list");
+    }
+    ++pos_;
+    ++depth_;
+}
+
+void StepParams::endList() {
+    while (!atEnd()) {
+        skip();
+    }
+    if (pos_ >= text_.size() || depth_ == 0) {
+        fail("unbalanced list");
+    }
+    ++pos_;
+    --depth_;
+    separator();
+}
+
+bool StepParams::atEnd() {
+    skipSpace();
+    return pos_ >= text_.size() || text_[pos_] == ')';
+}
+
+bool StepParams::isUnset() {
+    skipSpace();
+    return pos_ < text_.size() && (text_[pos_] == '$' || text_[pos_] == '*');
+}
+
+StepId StepParams::ref() {
+    if (isUnset()) {
+        ++pos_;
+        separator();
+        return 0;
+    }
+    if (pos_ >= text_.size() || text_[pos_] != '#') {
+        fail("expected an entity reference");
+    }
+    StepId id = 0;
+    const char* begin = text_.data() + pos_ + 1;
+    const auto [end, ec] = std::from_chars(begin, text_.data() + text_.size(), id);
+    if (ec != std::errc()) {
+        fail("malformed entity reference");
+    }
+    pos_ = static_cast<std::size_t>(end - text_.data());
+    separator();
+    return id;
+}
+
+double StepParams::real() {
+    skipSpace();
+    if (pos_ < text_.size() && isKeywordChar(text_[pos_]) && !(text_[pos_] >= '0' && text_[pos_] <= '9')) {
+        // Typed value such as LENGTH_MEASURE(2.5).
+        while (pos_ < text_.size() && isKeywordChar(text_[pos_])) {
+            ++pos_;
+        }
+        beginList();
+        const double value = real();
+        endList();
+        return value;
+    }
+    if (pos_ < text_.size() && text_[pos_] == '+') {
+        ++pos_;
+    }
+    double value = 0.0;
+    const char* begin = text_.data() + pos_;
+    const auto [end, ec] = std::from_chars(begin, text_.data() + text_.size(), value);
+    if (ec != std::errc()) {
+        fail("expected a real");
+    }
+    pos_ = static_cast<std::size_t>(end - text_.data());
+    separator();
+    return value;
+}
+
+long long StepParams::integer() {
+    skipSpace();
+    if (pos_ < text_.size() && text_[pos_] == '+') {
+        ++pos_;
+    }
+    long long value = 0;
+    const char* begin = text_.data() + pos_;
+    const auto [end, ec] = std::from_chars(begin, text_.data() + text_.size(), value);
+    if (ec != std::errc()) {
+        fail("expected an integer");
+    }
+    pos_ = static_cast<std::size_t>(end - text_.data());
+    separator();
+    return value;
+}
+
+std::string StepParams::string() {
+    if (isUnset()) {
+        ++pos_;
+        separator();
+        return {};
+    }
+    if (pos_ >= text_.size() || text_[pos_] != '\'') {
+        fail("expected a string");
+    }
+    std::string out;
+    for (++pos_; pos_ < text_.size(); ++pos_) {
+        const char c = text_[pos_];
+        if (c == '\'') {
+            if (pos_ + 1 < text_.size() && text_[pos_ + 1] == '\'') {
+                out.push_back('\'');
+                ++pos_;
+                continue;
+            }
+            ++pos_;
+            separator();
+            return out;
+        }
+        out.push_back(c);
+    }
+    fail("unterminated string");
+}
+
+std::string_view StepParams::enumeration() {
+    if (isUnset()) {
+        ++pos_;
+        separator();
+        return {};
+    }
+    if (pos_ >= text_.size() || text_[pos_] != '.') {
+        fail("expected an enumeration");
+    }
+    const std::size_t end = text_.find('.', pos_ + 1);
+    if (end == std::string_view::npos) {
+        fail("unterminated enumeration");
+    }
+    const std::string_view value = text_.substr(pos_ + 1, end - pos_ - 1);
+    pos_ = end + 1;
+    separator();
+    return value;
+}
+
+void StepParams::skip() {
+    skipSpace();
+    if (pos_ >= text_.size()) {
+        fail("unexpected end");
+    }
+    const char c = text_[pos_];
+    if (c == '(') {
+        beginList();
+        endList();
+    } else if (c == '\'') {
+        string();
+    } else if (c == '.') {
+        enumeration();
+    } else if (c == '#' || c == '$' || c == '*') {
+        ref();
+    } else if (c == '"') {
+        const std::size_t end = text_.find('"', pos_ + 1);
+        if (end == std::string_view::npos) {
+            fail("unterminated binary");
+        }
+        pos_ = end + 1;
+        separator();
+    } else if (isKeywordChar(c) && !(c >= '0' && c <= '9')) {
+        while (pos_ < text_.size() && isKeywordChar(text_[pos_])) {
+            ++pos_;
+        }
+        beginList();
+        endList();
+    } else {
+        while (pos_ < text_.size() && text_[pos_] != ',' && text_[pos_] != ')' && !isSpace(text_[pos_])) {
+            ++pos_;
+        }
+        separator();
+    }
+}
+
+std::vector<StepId> StepParams::refList() {
+    std::vector<StepId> refs;
+    if (isUnset()) {
+        ++pos_;
+        separator();
+        return refs;
+    }
+    beginList();
+    while (!atEnd()) {
+        refs.push_back(ref());
+    }
+    endList();
+    return refs;
+}
+
+} // namespace rebel::io
@@ -0,0 +1,603 @@
+#include "rebel/io/StepImport.hpp"
+
+#include "rebel/core/TaskScheduler.hpp"
+#include "rebel/core/Trace.hpp"
+#include "rebel/geometry/Mesh.hpp"
+
+#include <filesystem>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace rebel::io {
+
+namespace {
+
+using math::Vec3d;
+using math::Vec3f;
+
+class Warnings {
+public:
+    Warnings(StepImportResult& result, std::size_t limit) : result_(result), limit_(limit) {}
+
+    void add(std::string message) {
+        std::lock_guard lock(mutex_);
+        ++result_.warningCount;
+        if (result_.warnings.size() < limit_) {
+            result_.warnings.push_back(std::move(message));
+        }
+    }
+
+private:
+    std::mutex mutex_;
+    StepImportResult& result_;
+    std::size_t limit_;
+};
+
+struct Product {
+    StepId definition = 0;
+    std::string name;
+    std::vector<StepId> representations;
+    std::vector<std::size_t> usages;
+    bool isChild = false;
+    bool exactGeometry = false;
+    assembly::PartId part = assembly::kInvalidPart;
+    std::size_t triangles = 0;
+};
+
+/// One next-assembly-usage occurrence: `child` placed in `parent`.
+struct Usage {
+    StepId id = 0;
+    std::string name;
+    std::size_t parent = 0;
+    std::size_t child = 0;
+    math::Mat4f transform;
+};
+
+StepEntity require(const StepFile& file, StepId id, std::string_view type) {
+    const StepEntity e = file.entity(id);
+    if (!e.valid() || (!type.empty() && e.type != type)) {
+        throw std::runtime_error("#" + std::to_string(id) + " is not a " + std::string(type));
+    }
+    return e;
+}
+
+Vec3d readTriple(StepParams& p) {
+    p.beginList();
+    Vec3d v;
+    v.x = p.real();
+    v.y = p.atEnd() ? 0.0 : p.real();
+    v.z = p.atEnd() ? 0.0 : p.real();
+    p.endList();
+    return v;
+}
+
+std::string productName(const StepFile& file, const StepEntity& definition) {
+    StepParams pd(definition.params);
+    pd.skip();
+    pd.skip();
+    const StepEntity formation = file.entity(pd.ref());
+    if (formation.valid()) {
+        StepParams f(formation.params);
+        f.skip();
+        f.skip();
+        const StepEntity product = file.entity(f.ref());
+        if (product.valid()) {
+            StepParams p(product.params);
+            std::string id = p.string();
+            std::string name = p.string();
+            if (!name.empty()) {
+                return name;
+            }
+            if (!id.empty()) {
+                return id;
+            }
+        }
+    }
+    return "product #" + std::to_string(definition.id);
+}
+
+/// AXIS2_PLACEMENT_3D as a rigid transform.
+math::Mat4f placement(const StepFile& file, StepId id, double scale) {
+    StepParams p(require(file, id, "AXIS2_PLACEMENT_3D").params);
+    p.skip();
+    const StepId location = p.ref();
+    const StepId axisRef = p.ref();
+    const StepId refRef = p.atEnd() ? 0 : p.ref();
+
+    StepParams point(require(file, location, "CARTESIAN_POINT").params);
+    point.skip();
+    const Vec3d origin = readTriple(point) * scale;
+    auto direction = [&](StepId ref, const Vec3d& fallback) {
+        if (ref == 0) {
+            return fallback;
+        }
+        StepParams d(require(file, ref, "DIRECTION").params);
+        d.skip();
+        return math::normalize(readTriple(d));
+    };
+    const Vec3d z = direction(axisRef, {0, 0, 1});
+    const Vec3d refDir = direction(refRef, {1, 0, 0});
+    Vec3d x = refDir - z * math::dot(refDir, z);
+    if (math::length(x) < 1e-12) {
+        x = std::abs(z.x) < 0.9 ? math::cross(Vec3d{1, 0, 0}, z) : math::cross(Vec3d{0, 1, 0}, z);
+    }
+    x = math::normalize(x);
+    const Vec3d y = math::cross(z, x);
+
+    math::Mat4f m;
+    const Vec3d columns[4] = {x, y, z, origin};
+    for (int c = 0; c < 4; ++c) {
+        m(0, c) = static_cast<float>(columns[c].x);
+        m(1, c) = static_cast<float>(columns[c].y);
+        m(2, c) = static_cast<float>(columns[c].z);
+    }
+    return m;
+}
+
+/// Placement of a usage from the representation relationship of its
+/// context-dependent shape representation: the transform taking
+/// `transform_item_1` onto `transform_item_2`.
+math::Mat4f usageTransform(const StepFile& file, StepId relationship, double scale) {
+    const StepEntity rel = file.entity(relationship);
+    StepId op = 0;
+    if (rel.isComplex()) {
+        const std::string_view part = StepFile::component(rel, "REPRESENTATION_RELATIONSHIP_WITH_TRANSFORMATION");
+        if (part.empty()) {
+            throw std::runtime_error("#" + std::to_string(relationship) + " carries no transformation");
+        }
+        op = StepParams(part).ref();
+    } else if (rel.type == "REPRESENTATION_RELATIONSHIP_WITH_TRANSFORMATION" ||
+               rel.type == "SHAPE_REPRESENTATION_RELATIONSHIP_WITH_TRANSFORMATION") {
+        StepParams p(rel.params);
+        for (int i = 0; i < 4; ++i) {
+            p.skip();
+        }
+        op = p.ref();
+    } else {
+        throw std::runtime_error("#" + std::to_string(relationship) + " carries no transformation");
+    }
+    StepParams t(require(file, op, "ITEM_DEFINED_TRANSFORMATION").params);
+    t.skip();
+    t.skip();
+    const StepId from = t.ref();
+    const StepId to = t.ref();
+    return placement(file, to, scale) * placement(file, from, scale).inverse();
+}
+
+bool isTessellatedFace(std::string_view type) {
+    return type == "TRIANGULATED_FACE" || type == "COMPLEX_TRIANGULATED_FACE" ||
+           type == "TRIANGULATED_SURFACE_SET" || type == "COMPLEX_TRIANGULATED_SURFACE_SET";
+}
+
+bool isExactShape(std::string_view type) {
+    return type == "MANIFOLD_SOLID_BREP" || type == "BREP_WITH_VOIDS" || type == "FACETED_BREP" ||
+           type == "SHELL_BASED_SURFACE_MODEL" || type == "ADVANCED_FACE" || type == "GEOMETRIC_CURVE_SET";
+}
+
+/// Converts one product's tessellated items into a mesh.
+class MeshBuilder {
+public:
+    MeshBuilder(const StepFile& file, double scale) : file_(file), scale_(scale) {}
+
+    /// Walks `representations` and the representations linked to them,
+    /// collecting tessellated faces and noting exact shapes.
+    void collect(const std::vector<StepId>& representations,
+                 const std::unordered_map<StepId, std::vector<StepId>>& links) {
+        std::vector<StepId> queue = representations;
+        std::unordered_set<StepId> seen(queue.begin(), queue.end());
+        while (!queue.empty()) {
+            const StepId rep = queue.back();
+            queue.pop_back();
+            const StepEntity e = file_.entity(rep);
+            if (!e.valid() || e.isComplex()) {
+                continue;
+            }
+            StepParams p(e.params);
+            p.skip();
+            for (StepId item : p.refList()) {
+                collectItem(item, 0);
+            }
+            const auto it = links.find(rep);
+            if (it != links.end()) {
+                for (StepId next : it->second) {
+                    if (seen.insert(next).second) {
+                        queue.push_back(next);
+                    }
+                }
+            }
+        }
+    }
+
+    bool exactGeometry() const { return exact_; }
+    bool empty() const { return faces_.empty(); }
+
+    geometry::Mesh build() {
+        for (StepId face : faces_) {
+            appendFace(file_.entity(face));
+        }
+        mesh_.computeVertexNormals();
+        for (const auto& [vertex, normal] : normals_) {
+            mesh_.setNormal(vertex, normal);
+        }
+        return std::move(mesh_);
+    }
+
+private:
+    void collectItem(StepId id, int depth) {
+        const StepEntity e = file_.entity(id);
+        if (!e.valid()) {
+            return;
+        }
+        if (isTessellatedFace(e.type)) {
+            faces_.push_back(id);
+        } else if ((e.type == "TESSELLATED_SHELL" || e.type == "TESSELLATED_SOLID") && depth < 8) {
+            StepParams p(e.params);
+            p.skip();
+            for (StepId item : p.refList()) {
+                collectItem(item, depth + 1);
+            }
+        } else if (isExactShape(e.type)) {
+            exact_ = true;
+        }
+    }
+
+    const std::vector<Vec3f>& coordinates(StepId id) {
+        const auto it = coordinates_.find(id);
+        if (it != coordinates_.end()) {
+            return it->second;
+        }
+        StepParams p(require(file_, id, "COORDINATES_LIST").params);
+        p.skip();
+        const long long count = p.integer();
+        std::vector<Vec3f> points;
+        points.reserve(count > 0 ? static_cast<std::size_t>(count) : 0);
+        p.beginList();
+        while (!p.atEnd()) {
+            points.push_back(Vec3f(readTriple(p) * scale_));
+        }
+        p.endList();
+        return coordinates_.emplace(id, std::move(points)).first->second;
+    }
+
+    void appendFace(const StepEntity& e) {
+        const bool complex = e.type.rfind("COMPLEX_", 0) == 0;
+        const bool face = e.type.size() >= 5 && e.type.substr(e.type.size() - 5) == "_FACE";
+        StepParams p(e.params);
+        p.skip();
+        const std::vector<Vec3f>& points = coordinates(p.ref());
+        p.skip(); // pnmax
+        std::vector<Vec3f> normals;
+        p.beginList();
+        while (!p.atEnd()) {
+            normals.push_back(Vec3f(math::normalize(readTriple(p))));
+        }
+        p.endList();
+        if (face) {
+            p.skip(); // geometric_link
+        }
+        std::vector<long long> pnindex;
+        if (p.isUnset()) {
+            p.skip();
+        } else {
+            p.beginList();
+            while (!p.atEnd()) {
+                pnindex.push_back(p.integer());
+            }
+            p.endList();
+        }
+
+        const std::size_t count = pnindex.empty() ? points.size() : pnindex.size();
+        const auto base = static_cast<geometry::VertexIndex>(mesh_.vertexCount());
+        for (std::size_t k = 0; k < count; ++k) {
+            const long long idx = pnindex.empty() ? static_cast<long long>(k) : pnindex[k] - 1;
+            if (idx < 0 || static_cast<std::size_t>(idx) >= points.size()) {
+                throw std::runtime_error("#" + std::to_string(e.id) + ": point index out of range");
+            }
+            mesh_.addVertex(points[static_cast<std::size_t>(idx)]);
+        }
+        if (normals.size() == count || normals.size() == 1) {
+            for (std::size_t k = 0; k < count; ++k) {
+                normals_.emplace_back(base + static_cast<geometry::VertexIndex>(k),
+                                      normals[normals.size() == 1 ? 0 : k]);
+            }
+        }
+
+        const auto n = static_cast<long long>(count);
+        auto triangle = [&](long long a, long long b, long long c) {
+            if (a < 1 || b < 1 || c < 1 || a > n || b > n || c > n) {
+                throw std::runtime_error("#" + std::to_string(e.id) + ": triangle index out of range");
+            }
+            if (a != b && b != c && a != c) {
+                mesh_.addTriangle(base + static_cast<geometry::VertexIndex>(a - 1),
+                                  base + static_cast<geometry::VertexIndex>(b - 1),
+                                  base + static_cast<geometry::VertexIndex>(c - 1));
+            }
+        };
+        auto readIndices = [&](std::vector<long long>& out) {
+            out.clear();
+            p.beginList();
+            while (!p.atEnd()) {
+                out.push_back(p.integer());
+            }
+            p.endList();
+        };
+        std::vector<long long> list;
+        if (!complex) {
+            p.beginList();
+            while (!p.atEnd()) {
+                readIndices(list);
+                if (list.size() != 3) {
+                    throw std::runtime_error("#" + std::to_string(e.id) + ": triangle without three indices");
+                }
+                triangle(list[0], list[1], list[2]);
+            }
+            p.endList();
+            return;
+        }
+        // Strips alternate their winding; fans all share the first index.
+        p.beginList();
+        while (!p.atEnd()) {
+            readIndices(list);
+            for (std::size_t i = 0; i + 2 < list.size(); ++i) {
+                if (i % 2 == 0) {
+                    triangle(list[i], list[i + 1], list[i + 2]);
+                } else {
+                    triangle(list[i + 1], list[i], list[i + 2]);
+                }
+            }
+        }
+        p.endList();
+        p.beginList();
+        while (!p.atEnd()) {
+            readIndices(list);
+            for (std::size_t i = 1; i + 1 < list.size(); ++i) {
+                triangle(list[0], list[i], list[i + 1]);
+            }
+        }
+        p.endList();
+    }
+
+    const StepFile& file_;
+    double scale_;
+    std::vector<StepId> faces_;
+    bool exact_ = false;
+    std::unordered_map<StepId, std::vector<Vec3f>> coordinates_;
+    std::vector<std::pair<geometry::VertexIndex, Vec3f>> normals_;
+    geometry::Mesh mesh_;
+};
+
+} // namespace
+
+StepImportResult importStep(const std::string& path, assembly::Assembly& target, assembly::NodeId parent,
+                            assembly::PartLibrary& library, const StepImportOptions& options) {
+    const auto file = StepFile::open(path, options.index);
+    return importStep(*file, target, parent, library, options);
+}
+
+StepImportResult importStep(const StepFile& file, assembly::Assembly& target, assembly::NodeId parent,
+                            assembly::PartLibrary& library, const StepImportOptions& options) {
+    REBEL_TRACE_ZONE("step.import");
+    StepImportResult result;
+    result.entities = file.entityCount();
+    Warnings warnings(result, options.maxWarnings);
+    auto guarded = [&](const StepEntity& e, auto&& fn) {
+        try {
+            fn();
+        } catch (const std::exception& error) {
+            warnings.add(std::string(e.type) + " #" + std::to_string(e.id) + ": " + error.what());
+        }
+    };
+
+    // Product structure. These tables are proportional to the number of
+    // products and usages, not to the geometry.
+    std::vector<Product> products;
+    std::unordered_map<StepId, std::size_t> productOf;
+    for (const char* type : {"PRODUCT_DEFINITION", "PRODUCT_DEFINITION_WITH_ASSOCIATED_DOCUMENTS"}) {
+        file.forEachOfType(type, [&](const StepEntity& e) {
+            guarded(e, [&] {
+                Product p;
+                p.definition = e.id;
+                p.name = productName(file, e);
+                productOf.emplace(e.id, products.size());
+                products.push_back(std::move(p));
+            });
+        });
+    }
+    result.products = products.size();
+
+    std::vector<Usage> usages;
+    std::unordered_map<StepId, std::size_t> usageOf;
+    file.forEachOfType("NEXT_ASSEMBLY_USAGE_OCCURRENCE", [&](const StepEntity& e) {
+        guarded(e, [&] {
+            StepParams p(e.params);
+            std::string id = p.string();
+            std::string name = p.string();
+            p.skip();
+            const auto parentIt = productOf.find(p.ref());
+            const auto childIt = productOf.find(p.ref());
+            if (parentIt == productOf.end() || childIt == productOf.end()) {
+                throw std::runtime_error("does not relate two product definitions");
+            }
+            Usage u;
+            u.id = e.id;
+            u.name = name.empty() ? id : name;
+            u.parent = parentIt->second;
+            u.child = childIt->second;
+            usageOf.emplace(e.id, usages.size());
+            products[u.parent].usages.push_back(usages.size());
+            products[u.child].isChild = true;
+            usages.push_back(std::move(u));
+        });
+    });
+
+    std::unordered_map<StepId, StepId> shapeDefinition;
+    file.forEachOfType("PRODUCT_DEFINITION_SHAPE", [&](const StepEntity& e) {
+        guarded(e, [&] {
+            StepParams p(e.params);
+            p.skip();
+            p.skip();
+            shapeDefinition.emplace(e.id, p.ref());
+        });
+    });
+    file.forEachOfType("SHAPE_DEFINITION_REPRESENTATION", [&](const StepEntity& e) {
+        guarded(e, [&] {
+            StepParams p(e.params);
+            const auto def = shapeDefinition.find(p.ref());
+            const StepId rep = p.ref();
+            if (def != shapeDefinition.end()) {
+                const auto product = productOf.find(def->second);
+                if (product != productOf.end()) {
+                    products[product->second].representations.push_back(rep);
+                }
+            }
+        });
+    });
+    file.forEachOfType("CONTEXT_DEPENDENT_SHAPE_REPRESENTATION", [&](const StepEntity& e) {
+        guarded(e, [&] {
+            StepParams p(e.params);
+            const StepId relationship = p.ref();
+            const auto def = shapeDefinition.find(p.ref());
+            if (def == shapeDefinition.end()) {
+                return;
+            }
+            const auto usage = usageOf.find(def->second);
+            if (usage != usageOf.end()) {
+                usages[usage->second].transform = usageTransform(file, relationship, options.lengthScale);
+            }
+        });
+    });
+    // Plain (untransformed) links attach geometry representations to the
+    // shape representation of their product.
+    std::unordered_map<StepId, std::vector<StepId>> links;
+    for (const char* type : {"SHAPE_REPRESENTATION_RELATIONSHIP", "REPRESENTATION_RELATIONSHIP"}) {
+        file.forEachOfType(type, [&](const StepEntity& e) {
+            guarded(e, [&] {
+                StepParams p(e.params);
+                p.skip();
+                p.skip();
+                const StepId a = p.ref();
+                const StepId b = p.ref();
+                links[a].push_back(b);
+                links[b].push_back(a);
+            });
+        });
+    }
+
+    // Unique names: the library reuses parts by name.
+    std::unordered_map<std::string, std::size_t> nameUses;
+    for (Product& p : products) {
+        if (nameUses[p.name]++ > 0) {
+            p.name += " #" + std::to_string(p.definition);
+        }
+    }
+
+    // Geometry, one task per product.
+    core::TaskGroup group;
+    for (Product& product : products) {
+        if (product.representations.empty()) {
+            continue;
+        }
+        const assembly::PartId existing = library.find(product.name);
+        if (existing != assembly::kInvalidPart) {
+            product.part = existing;
+            continue;
+        }
+        group.run([&, p = &product] {
+            REBEL_TRACE_ZONE_DETAIL("step.part_geometry", p->name);
+            const StepEntity e = file.entity(p->definition);
+            guarded(e, [&] {
+                MeshBuilder builder(file, options.lengthScale);
+                builder.collect(p->representations, links);
+                p->exactGeometry = builder.exactGeometry();
+                if (builder.empty()) {
+                    return;
+                }
+                geometry::Mesh mesh = builder.build();
+                if (mesh.triangleCount() == 0) {
+                    return;
+                }
+                p->triangles = mesh.triangleCount();
+                p->part = library.add(assembly::Part::create(p->name, std::move(mesh)));
+            });
+        });
+    }
+    group.wait();
+    for (const Product& p : products) {
+        result.triangles += p.triangles;
+        result.parts += p.triangles > 0 ? 1 : 0;
+        result.unsupportedShapes += p.part == assembly::kInvalidPart && p.exactGeometry ? 1 : 0;
+    }
+
+    // Assembly tree. Products never used as a child are roots.
+    auto relevant = [&](const Product& p) { return p.part != assembly::kInvalidPart || !p.usages.empty(); };
+    std::vector<std::size_t> roots;
+    for (std::size_t i = 0; i < products.size(); ++i) {
+        if (!products[i].isChild && relevant(products[i])) {
+            roots.push_back(i);
+        }
+    }
+    if (roots.empty()) {
+        return result;
+    }
+    assembly::NodeId top = parent;
+    if (roots.size() > 1) {
+        top = target.addSubassembly(parent, math::Mat4f::identity(),
+                                    std::filesystem::path(file.file().path()).stem().string());
+        result.root = top;
+    }
+
+    std::vector<char> onPath(products.size(), 0);
+    struct Frame {
+        std::size_t product;
+        assembly::NodeId parent;
+        math::Mat4f local;
+        std::string name;
+        bool leave;
+    };
+    std::vector<Frame> stack;
+    for (auto r = roots.rbegin(); r != roots.rend(); ++r) {
+        stack.push_back({*r, top, math::Mat4f::identity(), products[*r].name, false});
+    }
+    while (!stack.empty()) {
+        Frame f = std::move(stack.back());
+        stack.pop_back();
+        if (f.leave) {
+            onPath[f.product] = 0;
+            continue;
+        }
+        const Product& p = products[f.product];
+        if (onPath[f.product]) {
+            warnings.add("product " + p.name + " contains itself; usage skipped");
+            continue;
+        }
+        assembly::NodeId node = assembly::kInvalidNode;
+        if (p.usages.empty()) {
+            node = target.addOccurrence(f.parent, p.part, f.local, f.name);
+            ++result.occurrences;
+        } else {
+            node = target.addSubassembly(f.parent, f.local, f.name);
+            if (p.part != assembly::kInvalidPart) {
+                target.addOccurrence(node, p.part, math::Mat4f::identity(), p.name);
+                ++result.occurrences;
+            }
+            onPath[f.product] = 1;
+            stack.push_back({f.product, node, {}, {}, true});
+            for (auto u = p.usages.rbegin(); u != p.usages.rend(); ++u) {
+                const Usage& usage = usages[*u];
+                if (relevant(products[usage.child])) {
+                    stack.push_back({usage.child, node, usage.transform,
+                                     usage.name.empty() ? products[usage.child].name : usage.name, false});
+                }
+            }
+        }
+        if (result.root == assembly::kInvalidNode) {
+            result.root = node;
+        }
+    }
+    return result;
+}
+
+} // namespace rebel::io
@@ -0,0 +1,186 @@
+#include "rebel/math/Batch.hpp"
+
+#include "BatchKernels.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace rebel::math::batch {
+namespace {
+
+bool cpuHasAvx2() {
+#if defined(REBEL_SIMD_AVX2)
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+#else
+    return false;
+#endif
+}
+
+const detail::KernelTable& kernelsFor(Backend backend) {
+    switch (backend) {
+#if defined(REBEL_SIMD_SSE2)
+    case Backend::Sse2:
+        return detail::sse2Kernels();
+#endif
+#if defined(REBEL_SIMD_AVX2)
+    case Backend::Avx2:
+        return detail::avx2Kernels();
+#endif
+#if defined(REBEL_SIMD_NEON)
+    case Backend::Neon:
+        return detail::neonKernels();
+#endif
+    default:
+        return detail::scalarKernels();
+    }
+}
+
+Backend detectBackend() {
+    if (const char* forced = std::getenv("REBEL_SIMD")) {
+        for (Backend b : {Backend::Scalar, Backend::Sse2, Backend::Avx2, Backend::Neon}) {
+            if (std::strcmp(forced, backendName(b)) == 0 && isSupported(b)) {
+                return b;
+            }
+        }
+    }
+    for (Backend b : {Backend::Avx2, Backend::Neon, Backend::Sse2}) {
+        if (isSupported(b)) {
+            return b;
+        }
+    }
+    return Backend::Scalar;
+}
+
+struct Dispatch {
+    std::atomic<Backend> backend{detectBackend()};
+    std::atomic<const detail::KernelTable*> kernels{&kernelsFor(backend.load())};
+};
+
+Dispatch& dispatch() {
+    static Dispatch instance;
+    return instance;
+}
+
+const detail::KernelTable& kernels() {
+    return *dispatch().kernels.load(std::memory_order_acquire);
+}
+
+} // namespace
+
+const char* backendName(Backend backend) {
+    switch (backend) {
+    case Backend::Scalar:
+        return "scalar";
+    case Backend::Sse2:
+        return "sse2";
+    case Backend::Avx2:
+        return "avx2";
+    case Backend::Neon:
+        return "neon";
+    }
+    return "unknown";
+}
+
+bool isSupported(Backend backend) {
+    switch (backend) {
+    case Backend::Scalar:
+        return true;
+    case Backend::Sse2:
+#if defined(REBEL_SIMD_SSE2)
+        return true;
+#else
+        return false;
+#endif
+    case Backend::Avx2:
+        return cpuHasAvx2();
+    case Backend::Neon:
+#if defined(REBEL_SIMD_NEON)
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+Backend activeBackend() {
+    return dispatch().backend.load(std::memory_order_relaxed);
+}
+
+void setBackend(Backend backend) {
+    if (!isSupported(backend)) {
+        throw std::invalid_argument(std::string("SIMD backend not supported: ") + backendName(backend));
+    }
+    dispatch().kernels.store(&kernelsFor(backend), std::memory_order_release);
+    dispatch().backend.store(backend, std::memory_order_relaxed);
+}
+
+void transformPoints(const Mat4f& m, const float* x, const float* y, const float* z, float* outX,
+                     float* outY, float* outZ, std::size_t count) {
+    kernels().transformPoints(m, x, y, z, outX, outY, outZ, count);
+}
+
+void transformAabbs(const Mat4f* matrices, const Aabb* local, Aabb* world, std::size_t count) {
+    kernels().transformAabbs(matrices, local, world, count);
+}
+
+void intersectRayTriangles(const Ray& ray, const TriangleBatch& triangles, float* tHit) {
+    kernels().intersectRayTriangles(ray, triangles, tHit);
+}
+
+void bsplineBasis(const double* knots, unsigned degree, const double* t, const std::uint32_t* spans,
+                  std::size_t count, double* basis, double* derivatives) {
+    if (degree > kMaxBasisDegree) {
+        throw std::invalid_argument("B-spline degree above kMaxBasisDegree");
+    }
+    kernels().bsplineBasis(knots, degree, t, spans, count, basis, derivatives);
+}
+
+void trianglePlaneRanges(const Vec3f& normal, float offset, const TriangleBatch& triangles, float* lo, float* hi) {
+    kernels().trianglePlaneRanges(normal, offset, triangles, lo, hi);
+}
+
+std::size_t closestRayTriangle(const Ray& ray, const TriangleBatch& triangles, float* tScratch,
+                               float* tNearest) {
+    kernels().intersectRayTriangles(ray, triangles, tScratch);
+    std::size_t best = triangles.count;
+    float bestT = std::numeric_limits<float>::infinity();
+    for (std::size_t i = 0; i < triangles.count; ++i) {
+        if (tScratch[i] < bestT) {
+            best = i;
+            bestT = tScratch[i];
+        }
+    }
+    if (tNearest != nullptr && best != triangles.count) {
+        *tNearest = bestT;
+    }
+    return best;
+}
+
+} // namespace rebel::math::batch
@@ -0,0 +1,243 @@
+#include "BatchKernels.hpp"
+
+#include <immintrin.h>
+
+// Only the kernels below are compiled for AVX2; the rest of the file, and
+// the inline helpers it shares with the other backends, stay baseline so
+// the linker may keep any translation unit's copy of them.
+#if defined(_MSC_VER) && !defined(__clang__)
+#define REBEL_TARGET_AVX2
+#else
+#define REBEL_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace rebel::math::batch::detail {
+namespace {
+
+REBEL_TARGET_AVX2
+void transformPoints(const Mat4f& mat, const float* x, const float* y, const float* z, float* outX,
+                     float* outY, float* outZ, std::size_t count) {
+    const float* m = mat.m;
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 vx = _mm256_loadu_ps(x + i);
+        const __m256 vy = _mm256_loadu_ps(y + i);
+        const __m256 vz = _mm256_loadu_ps(z + i);
+        __m256 r[3];
+        for (int row = 0; row < 3; ++row) {
+            __m256 acc = _mm256_mul_ps(_mm256_set1_ps(m[row]), vx);
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(m[4 + row]), vy));
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(m[8 + row]), vz));
+            r[row] = _mm256_add_ps(acc, _mm256_set1_ps(m[12 + row]));
+        }
+        _mm256_storeu_ps(outX + i, r[0]);
+        _mm256_storeu_ps(outY + i, r[1]);
+        _mm256_storeu_ps(outZ + i, r[2]);
+    }
+    for (; i < count; ++i) {
+        transformPointScalar(mat, x[i], y[i], z[i], outX[i], outY[i], outZ[i]);
+    }
+}
+
+/// `s[k]` in the low half, `s[4 + k]` in the high half.
+REBEL_TARGET_AVX2
+__m256 splatHalves(const float* s, int k) {
+    return _mm256_set_m128(_mm_set1_ps(s[4 + k]), _mm_set1_ps(s[k]));
+}
+
+// Two boxes per iteration, one per 128-bit half, each half laid out like the
+// SSE2 kernel (lanes are matrix rows).
+REBEL_TARGET_AVX2
+void transformAabbs(const Mat4f* matrices, const Aabb* local, Aabb* world, std::size_t count) {
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    const __m256 half = _mm256_set1_ps(0.5f);
+    std::size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const Aabb& a = local[i];
+        const Aabb& b = local[i + 1];
+        const __m256 lo = _mm256_set_ps(0.0f, b.min.z, b.min.y, b.min.x, 0.0f, a.min.z, a.min.y, a.min.x);
+        const __m256 hi = _mm256_set_ps(0.0f, b.max.z, b.max.y, b.max.x, 0.0f, a.max.z, a.max.y, a.max.x);
+        alignas(32) float c[8];
+        alignas(32) float e[8];
+        _mm256_store_ps(c, _mm256_mul_ps(_mm256_add_ps(lo, hi), half));
+        _mm256_store_ps(e, _mm256_mul_ps(_mm256_sub_ps(hi, lo), half));
+
+        const float* ma = matrices[i].m;
+        const float* mb = matrices[i + 1].m;
+        __m256 col[4];
+        for (int k = 0; k < 4; ++k) {
+            col[k] = _mm256_set_m128(_mm_loadu_ps(mb + 4 * k), _mm_loadu_ps(ma + 4 * k));
+        }
+
+        __m256 center = _mm256_mul_ps(col[0], splatHalves(c, 0));
+        center = _mm256_add_ps(center, _mm256_mul_ps(col[1], splatHalves(c, 1)));
+        center = _mm256_add_ps(center, _mm256_mul_ps(col[2], splatHalves(c, 2)));
+        center = _mm256_add_ps(center, col[3]);
+        __m256 extent = _mm256_mul_ps(_mm256_and_ps(col[0], absMask), splatHalves(e, 0));
+        extent = _mm256_add_ps(extent, _mm256_mul_ps(_mm256_and_ps(col[1], absMask), splatHalves(e, 1)));
+        extent = _mm256_add_ps(extent, _mm256_mul_ps(_mm256_and_ps(col[2], absMask), splatHalves(e, 2)));
+
+        alignas(32) float mn[8];
+        alignas(32) float mx[8];
+        _mm256_store_ps(mn, _mm256_sub_ps(center, extent));
+        _mm256_store_ps(mx, _mm256_add_ps(center, extent));
+        world[i].min = {mn[0], mn[1], mn[2]};
+        world[i].max = {mx[0], mx[1], mx[2]};
+        world[i + 1].min = {mn[4], mn[5], mn[6]};
+        world[i + 1].max = {mx[4], mx[5], mx[6]};
+    }
+    for (; i < count; ++i) {
+        transformAabbScalar(matrices[i], local[i], world[i]);
+    }
+}
+
+REBEL_TARGET_AVX2
+void intersectRayTriangles(const Ray& ray, const TriangleBatch& tri, float* tHit) {
+    const __m256 dx = _mm256_set1_ps(ray.direction.x);
+    const __m256 dy = _mm256_set1_ps(ray.direction.y);
+    const __m256 dz = _mm256_set1_ps(ray.direction.z);
+    const __m256 ox = _mm256_set1_ps(ray.origin.x);
+    const __m256 oy = _mm256_set1_ps(ray.origin.y);
+    const __m256 oz = _mm256_set1_ps(ray.origin.z);
+    const __m256 tMin = _mm256_set1_ps(ray.tMin);
+    const __m256 tMax = _mm256_set1_ps(ray.tMax);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 inf = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+
+    std::size_t i = 0;
+    for (; i + 8 <= tri.count; i += 8) {
+        const __m256 e1x = _mm256_loadu_ps(tri.e1x + i);
+        const __m256 e1y = _mm256_loadu_ps(tri.e1y + i);
+        const __m256 e1z = _mm256_loadu_ps(tri.e1z + i);
+        const __m256 e2x = _mm256_loadu_ps(tri.e2x + i);
+        const __m256 e2y = _mm256_loadu_ps(tri.e2y + i);
+        const __m256 e2z = _mm256_loadu_ps(tri.e2z + i);
+
+        const __m256 px = _mm256_sub_ps(_mm256_mul_ps(dy, e2z), _mm256_mul_ps(dz, e2y));
+        const __m256 py = _mm256_sub_ps(_mm256_mul_ps(dz, e2x), _mm256_mul_ps(dx, e2z));
+        const __m256 pz = _mm256_sub_ps(_mm256_mul_ps(dx, e2y), _mm256_mul_ps(dy, e2x));
+        const __m256 det = _mm256_add_ps(
+            _mm256_add_ps(_mm256_mul_ps(e1x, px), _mm256_mul_ps(e1y, py)), _mm256_mul_ps(e1z, pz));
+        const __m256 inv = _mm256_div_ps(one, det);
+
+        const __m256 tx = _mm256_sub_ps(ox, _mm256_loadu_ps(tri.v0x + i));
+        const __m256 ty = _mm256_sub_ps(oy, _mm256_loadu_ps(tri.v0y + i));
+        const __m256 tz = _mm256_sub_ps(oz, _mm256_loadu_ps(tri.v0z + i));
+        const __m256 u = _mm256_mul_ps(
+            _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(tx, px), _mm256_mul_ps(ty, py)),
+                          _mm256_mul_ps(tz, pz)),
+            inv);
+
+        const __m256 qx = _mm256_sub_ps(_mm256_mul_ps(ty, e1z), _mm256_mul_ps(tz, e1y));
+        const __m256 qy = _mm256_sub_ps(_mm256_mul_ps(tz, e1x), _mm256_mul_ps(tx, e1z));
+        const __m256 qz = _mm256_sub_ps(_mm256_mul_ps(tx, e1y), _mm256_mul_ps(ty, e1x));
+        const __m256 v = _mm256_mul_ps(
+            _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, qx), _mm256_mul_ps(dy, qy)),
+                          _mm256_mul_ps(dz, qz)),
+            inv);
+        const __m256 t = _mm256_mul_ps(
+            _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e2x, qx), _mm256_mul_ps(e2y, qy)),
+                          _mm256_mul_ps(e2z, qz)),
+            inv);
+
+        __m256 hit = _mm256_cmp_ps(det, zero, _CMP_NEQ_UQ);
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(u, zero, _CMP_GE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(u, one, _CMP_LE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(v, zero, _CMP_GE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(t, tMin, _CMP_GE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(t, tMax, _CMP_LE_OQ));
+        _mm256_storeu_ps(tHit + i, _mm256_blendv_ps(inf, t, hit));
+    }
+    for (; i < tri.count; ++i) {
+        tHit[i] = intersectRayTriangleScalar(ray, tri, i);
+    }
+}
+
+// Four samples per iteration; each lane gathers the knots of its own span.
+REBEL_TARGET_AVX2
+void bsplineBasis(const double* knots, unsigned degree, const double* t, const std::uint32_t* spans,
+                  std::size_t count, double* basis, double* derivatives) {
+    const __m256d zero = _mm256_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const std::uint32_t s0 = spans[i];
+        const std::uint32_t s1 = spans[i + 1];
+        const std::uint32_t s2 = spans[i + 2];
+        const std::uint32_t s3 = spans[i + 3];
+        const __m256d vt = _mm256_loadu_pd(t + i);
+        __m256d left[kMaxBasisDegree + 1];
+        __m256d right[kMaxBasisDegree + 1];
+        __m256d n[kMaxBasisDegree + 1];
+        __m256d temp[kMaxBasisDegree + 1];
+        n[0] = _mm256_set1_pd(1.0);
+        for (auto& q : temp) {
+            q = zero;
+        }
+        for (unsigned j = 1; j <= degree; ++j) {
+            left[j] = _mm256_sub_pd(
+                vt, _mm256_set_pd(knots[s3 + 1 - j], knots[s2 + 1 - j], knots[s1 + 1 - j], knots[s0 + 1 - j]));
+            right[j] = _mm256_sub_pd(_mm256_set_pd(knots[s3 + j], knots[s2 + j], knots[s1 + j], knots[s0 + j]), vt);
+            __m256d saved = zero;
+            for (unsigned r = 0; r < j; ++r) {
+                temp[r] = _mm256_div_pd(n[r], _mm256_add_pd(right[r + 1], left[j - r]));
+                n[r] = _mm256_add_pd(saved, _mm256_mul_pd(right[r + 1], temp[r]));
+                saved = _mm256_mul_pd(left[j - r], temp[r]);
+            }
+            n[j] = saved;
+        }
+        for (unsigned r = 0; r <= degree; ++r) {
+            _mm256_storeu_pd(basis + r * count + i, n[r]);
+        }
+        if (derivatives != nullptr) {
+            const __m256d p = _mm256_set1_pd(static_cast<double>(degree));
+            for (unsigned r = 0; r <= degree; ++r) {
+                const __m256d lower = r > 0 ? temp[r - 1] : zero;
+                const __m256d upper = r < degree ? temp[r] : zero;
+                _mm256_storeu_pd(derivatives + r * count + i, _mm256_mul_pd(p, _mm256_sub_pd(lower, upper)));
+            }
+        }
+    }
+    for (; i < count; ++i) {
+        bsplineBasisScalar(knots, degree, t[i], spans[i], basis + i, derivatives != nullptr ? derivatives + i : nullptr,
+                           count);
+    }
+}
+
+REBEL_TARGET_AVX2
+void trianglePlaneRanges(const Vec3f& normal, float offset, const TriangleBatch& tri, float* lo, float* hi) {
+    const __m256 nx = _mm256_set1_ps(normal.x);
+    const __m256 ny = _mm256_set1_ps(normal.y);
+    const __m256 nz = _mm256_set1_ps(normal.z);
+    const __m256 off = _mm256_set1_ps(offset);
+    const __m256 zero = _mm256_setzero_ps();
+    std::size_t i = 0;
+    for (; i + 8 <= tri.count; i += 8) {
+        const __m256 d0 = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, _mm256_loadu_ps(tri.v0x + i)),
+                                                           _mm256_mul_ps(ny, _mm256_loadu_ps(tri.v0y + i))),
+                                                _mm256_mul_ps(nz, _mm256_loadu_ps(tri.v0z + i))),
+                                     off);
+        const __m256 a = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, _mm256_loadu_ps(tri.e1x + i)),
+                                               _mm256_mul_ps(ny, _mm256_loadu_ps(tri.e1y + i))),
+                                    _mm256_mul_ps(nz, _mm256_loadu_ps(tri.e1z + i)));
+        const __m256 b = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, _mm256_loadu_ps(tri.e2x + i)),
+                                               _mm256_mul_ps(ny, _mm256_loadu_ps(tri.e2y + i))),
+                                    _mm256_mul_ps(nz, _mm256_loadu_ps(tri.e2z + i)));
+        _mm256_storeu_ps(lo + i, _mm256_add_ps(d0, _mm256_min_ps(_mm256_min_ps(a, b), zero)));
+        _mm256_storeu_ps(hi + i, _mm256_add_ps(d0, _mm256_max_ps(_mm256_max_ps(a, b), zero)));
+    }
+    for (; i < tri.count; ++i) {
+        trianglePlaneRangeScalar(normal, offset, tri, i, lo[i], hi[i]);
+    }
+}
+
+} // namespace
+
+const KernelTable& avx2Kernels() {
+    static const KernelTable table{transformPoints, transformAabbs, intersectRayTriangles, bsplineBasis,
+                                   trianglePlaneRanges};
+    return table;
+}
+
+} // namespace rebel::math::batch::detail
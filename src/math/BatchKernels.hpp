@@ -0,0 +1,141 @@
+#pragma once
+
+// Internal kernel table shared between the dispatcher and the per-ISA
+// translation units. Each backend file only exposes a filled-in table; the
+// inline helpers below are compiled for the baseline ISA in every one of
+// them, since the linker keeps a single copy.
+
+#include "rebel/math/Batch.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace rebel::math::batch::detail {
+
+struct KernelTable {
+    void (*transformPoints)(const Mat4f&, const float*, const float*, const float*, float*, float*,
+                            float*, std::size_t);
+    void (*transformAabbs)(const Mat4f*, const Aabb*, Aabb*, std::size_t);
+    void (*intersectRayTriangles)(const Ray&, const TriangleBatch&, float*);
+    void (*bsplineBasis)(const double*, unsigned, const double*, const std::uint32_t*, std::size_t, double*,
+                         double*);
+    void (*trianglePlaneRanges)(const Vec3f&, float, const TriangleBatch&, float*, float*);
+};
+
+const KernelTable& scalarKernels();
+#if defined(REBEL_SIMD_SSE2)
+const KernelTable& sse2Kernels();
+#endif
+#if defined(REBEL_SIMD_AVX2)
+const KernelTable& avx2Kernels();
+#endif
+#if defined(REBEL_SIMD_NEON)
+const KernelTable& neonKernels();
+#endif
+
+// Scalar reference bodies. The SIMD backends call these for loop tails, and
+// their vector code mirrors these expressions operation for operation.
+
+inline void transformPointScalar(const Mat4f& mat, float x, float y, float z, float& ox, float& oy,
+                                 float& oz) {
+    const float* m = mat.m;
+    ox = m[0] * x + m[4] * y + m[8] * z + m[12];
+    oy = m[1] * x + m[5] * y + m[9] * z + m[13];
+    oz = m[2] * x + m[6] * y + m[10] * z + m[14];
+}
+
+inline void transformAabbScalar(const Mat4f& mat, const Aabb& in, Aabb& out) {
+    const float* m = mat.m;
+    const float cx = (in.min.x + in.max.x) * 0.5f;
+    const float cy = (in.min.y + in.max.y) * 0.5f;
+    const float cz = (in.min.z + in.max.z) * 0.5f;
+    const float ex = (in.max.x - in.min.x) * 0.5f;
+    const float ey = (in.max.y - in.min.y) * 0.5f;
+    const float ez = (in.max.z - in.min.z) * 0.5f;
+    float c[3];
+    float e[3];
+    for (int r = 0; r < 3; ++r) {
+        c[r] = m[r] * cx + m[4 + r] * cy + m[8 + r] * cz + m[12 + r];
+        e[r] = std::fabs(m[r]) * ex + std::fabs(m[4 + r]) * ey + std::fabs(m[8 + r]) * ez;
+    }
+    out.min = {c[0] - e[0], c[1] - e[1], c[2] - e[2]};
+    out.max = {c[0] + e[0], c[1] + e[1], c[2] + e[2]};
+}
+
+inline float intersectRayTriangleScalar(const Ray& ray, const TriangleBatch& tri, std::size_t i) {
+    const float dx = ray.direction.x, dy = ray.direction.y, dz = ray.direction.z;
+    const float e1x = tri.e1x[i], e1y = tri.e1y[i], e1z = tri.e1z[i];
+    const float e2x = tri.e2x[i], e2y = tri.e2y[i], e2z = tri.e2z[i];
+
+    const float px = dy * e2z - dz * e2y;
+    const float py = dz * e2x - dx * e2z;
+    const float pz = dx * e2y - dy * e2x;
+    const float det = e1x * px + e1y * py + e1z * pz;
+    const float inv = 1.0f / det;
+
+    const float tx = ray.origin.x - tri.v0x[i];
+    const float ty = ray.origin.y - tri.v0y[i];
+    const float tz = ray.origin.z - tri.v0z[i];
+    const float u = (tx * px + ty * py + tz * pz) * inv;
+
+    const float qx = ty * e1z - tz * e1y;
+    const float qy = tz * e1x - tx * e1z;
+    const float qz = tx * e1y - ty * e1x;
+    const float v = (dx * qx + dy * qy + dz * qz) * inv;
+    const float t = (e2x * qx + e2y * qy + e2z * qz) * inv;
+
+    const bool hit = det != 0.0f && u >= 0.0f && u <= 1.0f && v >= 0.0f && u + v <= 1.0f &&
+                     t >= ray.tMin && t <= ray.tMax;
+    return hit ? t : std::numeric_limits<float>::infinity();
+}
+
+/// The minimum and maximum are spelled like `minps`/`maxps` (second
+/// operand unless the comparison holds) so every backend agrees.
+inline void trianglePlaneRangeScalar(const Vec3f& n, float offset, const TriangleBatch& tri, std::size_t i, float& lo,
+                                     float& hi) {
+    const float d0 = n.x * tri.v0x[i] + n.y * tri.v0y[i] + n.z * tri.v0z[i] - offset;
+    const float a = n.x * tri.e1x[i] + n.y * tri.e1y[i] + n.z * tri.e1z[i];
+    const float b = n.x * tri.e2x[i] + n.y * tri.e2y[i] + n.z * tri.e2z[i];
+    const float mn = a < b ? a : b;
+    const float mx = a > b ? a : b;
+    lo = d0 + (mn < 0.0f ? mn : 0.0f);
+    hi = d0 + (mx > 0.0f ? mx : 0.0f);
+}
+
+/// Cox-de Boor for one parameter (The NURBS Book, A2.2). The first
+/// derivative of basis r is `degree * (temp[r - 1] - temp[r])` over the
+/// quotients of the last round, which already divide each lower-degree
+/// basis by its knot span.
+inline void bsplineBasisScalar(const double* knots, unsigned degree, double t, std::uint32_t span, double* basis,
+                               double* derivatives, std::size_t stride) {
+    double left[kMaxBasisDegree + 1];
+    double right[kMaxBasisDegree + 1];
+    double n[kMaxBasisDegree + 1];
+    double temp[kMaxBasisDegree + 1] = {};
+    n[0] = 1.0;
+    for (unsigned j = 1; j <= degree; ++j) {
+        left[j] = t - knots[span + 1 - j];
+        right[j] = knots[span + j] - t;
+        double saved = 0.0;
+        for (unsigned r = 0; r < j; ++r) {
+            temp[r] = n[r] / (right[r + 1] + left[j - r]);
+            n[r] = saved + right[r + 1] * temp[r];
+            saved = left[j - r] * temp[r];
+        }
+        n[j] = saved;
+    }
+    for (unsigned r = 0; r <= degree; ++r) {
+        basis[r * stride] = n[r];
+    }
+    if (derivatives != nullptr) {
+        const double p = degree;
+        for (unsigned r = 0; r <= degree; ++r) {
+            const double lower = r > 0 ? temp[r - 1] : 0.0;
+            const double upper = r < degree ? temp[r] : 0.0;
+            derivatives[r * stride] = p * (lower - upper);
+        }
+    }
+}
+
+} // namespace rebel::math::batch::detail
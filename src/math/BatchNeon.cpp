@@ -0,0 +1,207 @@
+#include "BatchKernels.hpp"
+
+#include <arm_neon.h>
+
+namespace rebel::math::batch::detail {
+namespace {
+
+// vmlaq_f32 may be fused on AArch64, so products and sums are kept as
+// separate vmulq/vaddq to stay bit-identical with the scalar kernels.
+
+void transformPoints(const Mat4f& mat, const float* x, const float* y, const float* z, float* outX,
+                     float* outY, float* outZ, std::size_t count) {
+    const float* m = mat.m;
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float32x4_t vx = vld1q_f32(x + i);
+        const float32x4_t vy = vld1q_f32(y + i);
+        const float32x4_t vz = vld1q_f32(z + i);
+        float32x4_t r[3];
+        for (int row = 0; row < 3; ++row) {
+            float32x4_t acc = vmulq_f32(vdupq_n_f32(m[row]), vx);
+            acc = vaddq_f32(acc, vmulq_f32(vdupq_n_f32(m[4 + row]), vy));
+            acc = vaddq_f32(acc, vmulq_f32(vdupq_n_f32(m[8 + row]), vz));
+            r[row] = vaddq_f32(acc, vdupq_n_f32(m[12 + row]));
+        }
+        vst1q_f32(outX + i, r[0]);
+        vst1q_f32(outY + i, r[1]);
+        vst1q_f32(outZ + i, r[2]);
+    }
+    for (; i < count; ++i) {
+        transformPointScalar(mat, x[i], y[i], z[i], outX[i], outY[i], outZ[i]);
+    }
+}
+
+void transformAabbs(const Mat4f* matrices, const Aabb* local, Aabb* world, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        const float* m = matrices[i].m;
+        const Aabb& in = local[i];
+        const float c[3] = {(in.min.x + in.max.x) * 0.5f, (in.min.y + in.max.y) * 0.5f,
+                            (in.min.z + in.max.z) * 0.5f};
+        const float e[3] = {(in.max.x - in.min.x) * 0.5f, (in.max.y - in.min.y) * 0.5f,
+                            (in.max.z - in.min.z) * 0.5f};
+        const float32x4_t col0 = vld1q_f32(m);
+        const float32x4_t col1 = vld1q_f32(m + 4);
+        const float32x4_t col2 = vld1q_f32(m + 8);
+        const float32x4_t col3 = vld1q_f32(m + 12);
+        float32x4_t center = vmulq_f32(col0, vdupq_n_f32(c[0]));
+        center = vaddq_f32(center, vmulq_f32(col1, vdupq_n_f32(c[1])));
+        center = vaddq_f32(center, vmulq_f32(col2, vdupq_n_f32(c[2])));
+        center = vaddq_f32(center, col3);
+        float32x4_t extent = vmulq_f32(vabsq_f32(col0), vdupq_n_f32(e[0]));
+        extent = vaddq_f32(extent, vmulq_f32(vabsq_f32(col1), vdupq_n_f32(e[1])));
+        extent = vaddq_f32(extent, vmulq_f32(vabsq_f32(col2), vdupq_n_f32(e[2])));
+        float mn[4];
+        float mx[4];
+        vst1q_f32(mn, vsubq_f32(center, extent));
+        vst1q_f32(mx, vaddq_f32(center, extent));
+        world[i].min = {mn[0], mn[1], mn[2]};
+        world[i].max = {mx[0], mx[1], mx[2]};
+    }
+}
+
+void intersectRayTriangles(const Ray& ray, const TriangleBatch& tri, float* tHit) {
+    const float32x4_t dx = vdupq_n_f32(ray.direction.x);
+    const float32x4_t dy = vdupq_n_f32(ray.direction.y);
+    const float32x4_t dz = vdupq_n_f32(ray.direction.z);
+    const float32x4_t ox = vdupq_n_f32(ray.origin.x);
+    const float32x4_t oy = vdupq_n_f32(ray.origin.y);
+    const float32x4_t oz = vdupq_n_f32(ray.origin.z);
+    const float32x4_t tMin = vdupq_n_f32(ray.tMin);
+    const float32x4_t tMax = vdupq_n_f32(ray.tMax);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t inf = vdupq_n_f32(std::numeric_limits<float>::infinity());
+
+    auto dot3 = [](float32x4_t ax, float32x4_t ay, float32x4_t az, float32x4_t bx, float32x4_t by,
+                   float32x4_t bz) {
+        return vaddq_f32(vaddq_f32(vmulq_f32(ax, bx), vmulq_f32(ay, by)), vmulq_f32(az, bz));
+    };
+
+    std::size_t i = 0;
+    for (; i + 4 <= tri.count; i += 4) {
+        const float32x4_t e1x = vld1q_f32(tri.e1x + i);
+        const float32x4_t e1y = vld1q_f32(tri.e1y + i);
+        const float32x4_t e1z = vld1q_f32(tri.e1z + i);
+        const float32x4_t e2x = vld1q_f32(tri.e2x + i);
+        const float32x4_t e2y = vld1q_f32(tri.e2y + i);
+        const float32x4_t e2z = vld1q_f32(tri.e2z + i);
+
+        const float32x4_t px = vsubq_f32(vmulq_f32(dy, e2z), vmulq_f32(dz, e2y));
+        const float32x4_t py = vsubq_f32(vmulq_f32(dz, e2x), vmulq_f32(dx, e2z));
+        const float32x4_t pz = vsubq_f32(vmulq_f32(dx, e2y), vmulq_f32(dy, e2x));
+        const float32x4_t det = dot3(e1x, e1y, e1z, px, py, pz);
+        const float32x4_t inv = vdivq_f32(one, det);
+
+        const float32x4_t tx = vsubq_f32(ox, vld1q_f32(tri.v0x + i));
+        const float32x4_t ty = vsubq_f32(oy, vld1q_f32(tri.v0y + i));
+        const float32x4_t tz = vsubq_f32(oz, vld1q_f32(tri.v0z + i));
+        const float32x4_t u = vmulq_f32(dot3(tx, ty, tz, px, py, pz), inv);
+
+        const float32x4_t qx = vsubq_f32(vmulq_f32(ty, e1z), vmulq_f32(tz, e1y));
+        const float32x4_t qy = vsubq_f32(vmulq_f32(tz, e1x), vmulq_f32(tx, e1z));
+        const float32x4_t qz = vsubq_f32(vmulq_f32(tx, e1y), vmulq_f32(ty, e1x));
+        const float32x4_t v = vmulq_f32(dot3(dx, dy, dz, qx, qy, qz), inv);
+        const float32x4_t t = vmulq_f32(dot3(e2x, e2y, e2z, qx, qy, qz), inv);
+
+        uint32x4_t hit = vmvnq_u32(vceqq_f32(det, zero));
+        hit = vandq_u32(hit, vcgeq_f32(u, zero));
+        hit = vandq_u32(hit, vcleq_f32(u, one));
+        hit = vandq_u32(hit, vcgeq_f32(v, zero));
+        hit = vandq_u32(hit, vcleq_f32(vaddq_f32(u, v), one));
+        hit = vandq_u32(hit, vcgeq_f32(t, tMin));
+        hit = vandq_u32(hit, vcleq_f32(t, tMax));
+        vst1q_f32(tHit + i, vbslq_f32(hit, t, inf));
+    }
+    for (; i < tri.count; ++i) {
+        tHit[i] = intersectRayTriangleScalar(ray, tri, i);
+    }
+}
+
+// Two samples per iteration; each lane gathers the knots of its own span.
+void bsplineBasis(const double* knots, unsigned degree, const double* t, const std::uint32_t* spans,
+                  std::size_t count, double* basis, double* derivatives) {
+    const float64x2_t zero = vdupq_n_f64(0.0);
+    auto gather = [knots](std::uint32_t k0, std::uint32_t k1) {
+        const double pair[2] = {knots[k0], knots[k1]};
+        return vld1q_f64(pair);
+    };
+    std::size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const std::uint32_t s0 = spans[i];
+        const std::uint32_t s1 = spans[i + 1];
+        const float64x2_t vt = vld1q_f64(t + i);
+        float64x2_t left[kMaxBasisDegree + 1];
+        float64x2_t right[kMaxBasisDegree + 1];
+        float64x2_t n[kMaxBasisDegree + 1];
+        float64x2_t temp[kMaxBasisDegree + 1];
+        n[0] = vdupq_n_f64(1.0);
+        for (auto& q : temp) {
+            q = zero;
+        }
+        for (unsigned j = 1; j <= degree; ++j) {
+            left[j] = vsubq_f64(vt, gather(s0 + 1 - j, s1 + 1 - j));
+            right[j] = vsubq_f64(gather(s0 + j, s1 + j), vt);
+            float64x2_t saved = zero;
+            for (unsigned r = 0; r < j; ++r) {
+                temp[r] = vdivq_f64(n[r], vaddq_f64(right[r + 1], left[j - r]));
+                n[r] = vaddq_f64(saved, vmulq_f64(right[r + 1], temp[r]));
+                saved = vmulq_f64(left[j - r], temp[r]);
+            }
+            n[j] = saved;
+        }
+        for (unsigned r = 0; r <= degree; ++r) {
+            vst1q_f64(basis + r * count + i, n[r]);
+        }
+        if (derivatives != nullptr) {
+            const float64x2_t p = vdupq_n_f64(static_cast<double>(degree));
+            for (unsigned r = 0; r <= degree; ++r) {
+                const float64x2_t lower = r > 0 ? temp[r - 1] : zero;
+                const float64x2_t upper = r < degree ? temp[r] : zero;
+                vst1q_f64(derivatives + r * count + i, vmulq_f64(p, vsubq_f64(lower, upper)));
+            }
+        }
+    }
+    for (; i < count; ++i) {
+        bsplineBasisScalar(knots, degree, t[i], spans[i], basis + i, derivatives != nullptr ? derivatives + i : nullptr,
+                           count);
+    }
+}
+
+void trianglePlaneRanges(const Vec3f& normal, float offset, const TriangleBatch& tri, float* lo, float* hi) {
+    const float32x4_t nx = vdupq_n_f32(normal.x);
+    const float32x4_t ny = vdupq_n_f32(normal.y);
+    const float32x4_t nz = vdupq_n_f32(normal.z);
+    const float32x4_t off = vdupq_n_f32(offset);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    std::size_t i = 0;
+    for (; i + 4 <= tri.count; i += 4) {
+        const float32x4_t d0 = vsubq_f32(vaddq_f32(vaddq_f32(vmulq_f32(nx, vld1q_f32(tri.v0x + i)),
+                                                             vmulq_f32(ny, vld1q_f32(tri.v0y + i))),
+                                                   vmulq_f32(nz, vld1q_f32(tri.v0z + i))),
+                                         off);
+        const float32x4_t a = vaddq_f32(vaddq_f32(vmulq_f32(nx, vld1q_f32(tri.e1x + i)),
+                                                  vmulq_f32(ny, vld1q_f32(tri.e1y + i))),
+                                        vmulq_f32(nz, vld1q_f32(tri.e1z + i)));
+        const float32x4_t b = vaddq_f32(vaddq_f32(vmulq_f32(nx, vld1q_f32(tri.e2x + i)),
+                                                  vmulq_f32(ny, vld1q_f32(tri.e2y + i))),
+                                        vmulq_f32(nz, vld1q_f32(tri.e2z + i)));
+        // vminq/vmaxq agree with the scalar spelling for the finite
+        // distances compared here.
+        vst1q_f32(lo + i, vaddq_f32(d0, vminq_f32(vminq_f32(a, b), zero)));
+        vst1q_f32(hi + i, vaddq_f32(d0, vmaxq_f32(vmaxq_f32(a, b), zero)));
+    }
+    for (; i < tri.count; ++i) {
+        trianglePlaneRangeScalar(normal, offset, tri, i, lo[i], hi[i]);
+    }
+}
+
+} // namespace
+
+const KernelTable& neonKernels() {
+    static const KernelTable table{transformPoints, transformAabbs, intersectRayTriangles, bsplineBasis,
+                                   trianglePlaneRanges};
+    return table;
+}
+
+} // namespace rebel::math::batch::detail
@@ -0,0 +1,47 @@
+#include "BatchKernels.hpp"
+
+namespace rebel::math::batch::detail {
+namespace {
+
+void transformPoints(const Mat4f& m, const float* x, const float* y, const float* z, float* outX,
+                     float* outY, float* outZ, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        transformPointScalar(m, x[i], y[i], z[i], outX[i], outY[i], outZ[i]);
+    }
+}
+
+void transformAabbs(const Mat4f* matrices, const Aabb* local, Aabb* world, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        transformAabbScalar(matrices[i], local[i], world[i]);
+    }
+}
+
+void intersectRayTriangles(const Ray& ray, const TriangleBatch& triangles, float* tHit) {
+    for (std::size_t i = 0; i < triangles.count; ++i) {
+        tHit[i] = intersectRayTriangleScalar(ray, triangles, i);
+    }
+}
+
+void bsplineBasis(const double* knots, unsigned degree, const double* t, const std::uint32_t* spans,
+                  std::size_t count, double* basis, double* derivatives) {
+    for (std::size_t i = 0; i < count; ++i) {
+        bsplineBasisScalar(knots, degree, t[i], spans[i], basis + i, derivatives != nullptr ? derivatives + i : nullptr,
+                           count);
+    }
+}
+
+void trianglePlaneRanges(const Vec3f& normal, float offset, const TriangleBatch& triangles, float* lo, float* hi) {
+    for (std::size_t i = 0; i < triangles.count; ++i) {
+        trianglePlaneRangeScalar(normal, offset, triangles, i, lo[i], hi[i]);
+    }
+}
+
+} // namespace
+
+const KernelTable& scalarKernels() {
+    static const KernelTable table{transformPoints, transformAabbs, intersectRayTriangles, bsplineBasis,
+                                   trianglePlaneRanges};
+    return table;
+}
+
+} // namespace rebel::math::batch::detail
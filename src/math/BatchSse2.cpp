@@ -0,0 +1,206 @@
+#include "BatchKernels.hpp"
+
+#include <emmintrin.h>
+
+namespace rebel::math::batch::detail {
+namespace {
+
+void transformPoints(const Mat4f& mat, const float* x, const float* y, const float* z, float* outX,
+                     float* outY, float* outZ, std::size_t count) {
+    const float* m = mat.m;
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 vx = _mm_loadu_ps(x + i);
+        const __m128 vy = _mm_loadu_ps(y + i);
+        const __m128 vz = _mm_loadu_ps(z + i);
+        __m128 r[3];
+        for (int row = 0; row < 3; ++row) {
+            __m128 acc = _mm_mul_ps(_mm_set1_ps(m[row]), vx);
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(m[4 + row]), vy));
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(m[8 + row]), vz));
+            r[row] = _mm_add_ps(acc, _mm_set1_ps(m[12 + row]));
+        }
+        _mm_storeu_ps(outX + i, r[0]);
+        _mm_storeu_ps(outY + i, r[1]);
+        _mm_storeu_ps(outZ + i, r[2]);
+    }
+    for (; i < count; ++i) {
+        transformPointScalar(mat, x[i], y[i], z[i], outX[i], outY[i], outZ[i]);
+    }
+}
+
+// One box per iteration: the four lanes hold rows of the matrix columns, so
+// center and extent come out as a single vector each.
+void transformAabbs(const Mat4f* matrices, const Aabb* local, Aabb* world, std::size_t count) {
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 half = _mm_set1_ps(0.5f);
+    for (std::size_t i = 0; i < count; ++i) {
+        const float* m = matrices[i].m;
+        const Aabb& in = local[i];
+        const __m128 lo = _mm_set_ps(0.0f, in.min.z, in.min.y, in.min.x);
+        const __m128 hi = _mm_set_ps(0.0f, in.max.z, in.max.y, in.max.x);
+        alignas(16) float c[4];
+        alignas(16) float e[4];
+        _mm_store_ps(c, _mm_mul_ps(_mm_add_ps(lo, hi), half));
+        _mm_store_ps(e, _mm_mul_ps(_mm_sub_ps(hi, lo), half));
+
+        const __m128 col0 = _mm_loadu_ps(m);
+        const __m128 col1 = _mm_loadu_ps(m + 4);
+        const __m128 col2 = _mm_loadu_ps(m + 8);
+        const __m128 col3 = _mm_loadu_ps(m + 12);
+        __m128 center = _mm_mul_ps(col0, _mm_set1_ps(c[0]));
+        center = _mm_add_ps(center, _mm_mul_ps(col1, _mm_set1_ps(c[1])));
+        center = _mm_add_ps(center, _mm_mul_ps(col2, _mm_set1_ps(c[2])));
+        center = _mm_add_ps(center, col3);
+        __m128 extent = _mm_mul_ps(_mm_and_ps(col0, absMask), _mm_set1_ps(e[0]));
+        extent = _mm_add_ps(extent, _mm_mul_ps(_mm_and_ps(col1, absMask), _mm_set1_ps(e[1])));
+        extent = _mm_add_ps(extent, _mm_mul_ps(_mm_and_ps(col2, absMask), _mm_set1_ps(e[2])));
+
+        alignas(16) float mn[4];
+        alignas(16) float mx[4];
+        _mm_store_ps(mn, _mm_sub_ps(center, extent));
+        _mm_store_ps(mx, _mm_add_ps(center, extent));
+        world[i].min = {mn[0], mn[1], mn[2]};
+        world[i].max = {mx[0], mx[1], mx[2]};
+    }
+}
+
+void intersectRayTriangles(const Ray& ray, const TriangleBatch& tri, float* tHit) {
+    const __m128 dx = _mm_set1_ps(ray.direction.x);
+    const __m128 dy = _mm_set1_ps(ray.direction.y);
+    const __m128 dz = _mm_set1_ps(ray.direction.z);
+    const __m128 ox = _mm_set1_ps(ray.origin.x);
+    const __m128 oy = _mm_set1_ps(ray.origin.y);
+    const __m128 oz = _mm_set1_ps(ray.origin.z);
+    const __m128 tMin = _mm_set1_ps(ray.tMin);
+    const __m128 tMax = _mm_set1_ps(ray.tMax);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 inf = _mm_set1_ps(std::numeric_limits<float>::infinity());
+
+    std::size_t i = 0;
+    for (; i + 4 <= tri.count; i += 4) {
+        const __m128 e1x = _mm_loadu_ps(tri.e1x + i);
+        const __m128 e1y = _mm_loadu_ps(tri.e1y + i);
+        const __m128 e1z = _mm_loadu_ps(tri.e1z + i);
+        const __m128 e2x = _mm_loadu_ps(tri.e2x + i);
+        const __m128 e2y = _mm_loadu_ps(tri.e2y + i);
+        const __m128 e2z = _mm_loadu_ps(tri.e2z + i);
+
+        const __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+        const __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+        const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+        const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)),
+                                      _mm_mul_ps(e1z, pz));
+        const __m128 inv = _mm_div_ps(one, det);
+
+        const __m128 tx = _mm_sub_ps(ox, _mm_loadu_ps(tri.v0x + i));
+        const __m128 ty = _mm_sub_ps(oy, _mm_loadu_ps(tri.v0y + i));
+        const __m128 tz = _mm_sub_ps(oz, _mm_loadu_ps(tri.v0z + i));
+        const __m128 u = _mm_mul_ps(
+            _mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, px), _mm_mul_ps(ty, py)), _mm_mul_ps(tz, pz)), inv);
+
+        const __m128 qx = _mm_sub_ps(_mm_mul_ps(ty, e1z), _mm_mul_ps(tz, e1y));
+        const __m128 qy = _mm_sub_ps(_mm_mul_ps(tz, e1x), _mm_mul_ps(tx, e1z));
+        const __m128 qz = _mm_sub_ps(_mm_mul_ps(tx, e1y), _mm_mul_ps(ty, e1x));
+        const __m128 v = _mm_mul_ps(
+            _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), inv);
+        const __m128 t = _mm_mul_ps(
+            _mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)),
+            inv);
+
+        __m128 hit = _mm_cmpneq_ps(det, zero);
+        hit = _mm_and_ps(hit, _mm_cmpge_ps(u, zero));
+        hit = _mm_and_ps(hit, _mm_cmple_ps(u, one));
+        hit = _mm_and_ps(hit, _mm_cmpge_ps(v, zero));
+        hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_add_ps(u, v), one));
+        hit = _mm_and_ps(hit, _mm_cmpge_ps(t, tMin));
+        hit = _mm_and_ps(hit, _mm_cmple_ps(t, tMax));
+        _mm_storeu_ps(tHit + i, _mm_or_ps(_mm_and_ps(hit, t), _mm_andnot_ps(hit, inf)));
+    }
+    for (; i < tri.count; ++i) {
+        tHit[i] = intersectRayTriangleScalar(ray, tri, i);
+    }
+}
+
+// Two samples per iteration; each lane gathers the knots of its own span.
+void bsplineBasis(const double* knots, unsigned degree, const double* t, const std::uint32_t* spans,
+                  std::size_t count, double* basis, double* derivatives) {
+    const __m128d zero = _mm_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const std::uint32_t s0 = spans[i];
+        const std::uint32_t s1 = spans[i + 1];
+        const __m128d vt = _mm_loadu_pd(t + i);
+        __m128d left[kMaxBasisDegree + 1];
+        __m128d right[kMaxBasisDegree + 1];
+        __m128d n[kMaxBasisDegree + 1];
+        __m128d temp[kMaxBasisDegree + 1];
+        n[0] = _mm_set1_pd(1.0);
+        for (auto& q : temp) {
+            q = zero;
+        }
+        for (unsigned j = 1; j <= degree; ++j) {
+            left[j] = _mm_sub_pd(vt, _mm_set_pd(knots[s1 + 1 - j], knots[s0 + 1 - j]));
+            right[j] = _mm_sub_pd(_mm_set_pd(knots[s1 + j], knots[s0 + j]), vt);
+            __m128d saved = zero;
+            for (unsigned r = 0; r < j; ++r) {
+                temp[r] = _mm_div_pd(n[r], _mm_add_pd(right[r + 1], left[j - r]));
+                n[r] = _mm_add_pd(saved, _mm_mul_pd(right[r + 1], temp[r]));
+                saved = _mm_mul_pd(left[j - r], temp[r]);
+            }
+            n[j] = saved;
+        }
+        for (unsigned r = 0; r <= degree; ++r) {
+            _mm_storeu_pd(basis + r * count + i, n[r]);
+        }
+        if (derivatives != nullptr) {
+            const __m128d p = _mm_set1_pd(static_cast<double>(degree));
+            for (unsigned r = 0; r <= degree; ++r) {
+                const __m128d lower = r > 0 ? temp[r - 1] : zero;
+                const __m128d upper = r < degree ? temp[r] : zero;
+                _mm_storeu_pd(derivatives + r * count + i, _mm_mul_pd(p, _mm_sub_pd(lower, upper)));
+            }
+        }
+    }
+    for (; i < count; ++i) {
+        bsplineBasisScalar(knots, degree, t[i], spans[i], basis + i, derivatives != nullptr ? derivatives + i : nullptr,
+                           count);
+    }
+}
+
+void trianglePlaneRanges(const Vec3f& normal, float offset, const TriangleBatch& tri, float* lo, float* hi) {
+    const __m128 nx = _mm_set1_ps(normal.x);
+    const __m128 ny = _mm_set1_ps(normal.y);
+    const __m128 nz = _mm_set1_ps(normal.z);
+    const __m128 off = _mm_set1_ps(offset);
+    const __m128 zero = _mm_setzero_ps();
+    std::size_t i = 0;
+    for (; i + 4 <= tri.count; i += 4) {
+        const __m128 d0 = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, _mm_loadu_ps(tri.v0x + i)),
+                                                           _mm_mul_ps(ny, _mm_loadu_ps(tri.v0y + i))),
+                                                _mm_mul_ps(nz, _mm_loadu_ps(tri.v0z + i))),
+                                     off);
+        const __m128 a = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, _mm_loadu_ps(tri.e1x + i)),
+                                               _mm_mul_ps(ny, _mm_loadu_ps(tri.e1y + i))),
+                                    _mm_mul_ps(nz, _mm_loadu_ps(tri.e1z + i)));
+        const __m128 b = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, _mm_loadu_ps(tri.e2x + i)),
+                                               _mm_mul_ps(ny, _mm_loadu_ps(tri.e2y + i))),
+                                    _mm_mul_ps(nz, _mm_loadu_ps(tri.e2z + i)));
+        _mm_storeu_ps(lo + i, _mm_add_ps(d0, _mm_min_ps(_mm_min_ps(a, b), zero)));
+        _mm_storeu_ps(hi + i, _mm_add_ps(d0, _mm_max_ps(_mm_max_ps(a, b), zero)));
+    }
+    for (; i < tri.count; ++i) {
+        trianglePlaneRangeScalar(normal, offset, tri, i, lo[i], hi[i]);
+    }
+}
+
+} // namespace
+
+const KernelTable& sse2Kernels() {
+    static const KernelTable table{transformPoints, transformAabbs, intersectRayTriangles, bsplineBasis,
+                                   trianglePlaneRanges};
+    return table;
+}
+
+} // namespace rebel::math::batch::detail
@@ -0,0 +1,401 @@
+#include "rebel/math/Predicates.hpp"
+
+#include <cmath>
+#include <vector>
+
+namespace rebel::math {
+namespace {
+
+// Shewchuk, "Adaptive Precision Floating-Point Arithmetic and Fast Robust
+// Geometric Predicates" (1997). Requires round-to-nearest double arithmetic
+// without FMA contraction; the build turns contraction off for this file.
+
+constexpr double kEpsilon = 0x1p-53;
+constexpr double kSplitter = 0x1p27 + 1.0;
+constexpr double kOrient2dBound = (3.0 + 16.0 * kEpsilon) * kEpsilon;
+constexpr double kOrient3dBound = (7.0 + 56.0 * kEpsilon) * kEpsilon;
+constexpr double kIncircleBound = (10.0 + 96.0 * kEpsilon) * kEpsilon;
+
+/// Nonoverlapping expansion, components in increasing magnitude, zeros
+/// eliminated. Only built on the (rare) exact path.
+using Expansion = std::vector<double>;
+
+inline void twoSum(double a, double b, double& x, double& y) {
+    x = a + b;
+    const double bv = x - a;
+    const double av = x - bv;
+    y = (a - av) + (b - bv);
+}
+
+inline void fastTwoSum(double a, double b, double& x, double& y) {
+    x = a + b;
+    y = b - (x - a);
+}
+
+inline void twoDiff(double a, double b, double& x, double& y) {
+    x = a - b;
+    const double bv = a - x;
+    const double av = x + bv;
+    y = (a - av) + (bv - b);
+}
+
+inline void split(double a, double& hi, double& lo) {
+    const double c = kSplitter * a;
+    const double big = c - a;
+    hi = c - big;
+    lo = a - hi;
+}
+
+inline void twoProduct(double a, double b, double& x, double& y) {
+    x = a * b;
+    double ahi;
+    double alo;
+    double bhi;
+    double blo;
+    split(a, ahi, alo);
+    split(b, bhi, blo);
+    const double err1 = x - ahi * bhi;
+    const double err2 = err1 - alo * bhi;
+    const double err3 = err2 - ahi * blo;
+    y = alo * blo - err3;
+}
+
+Expansion difference(double a, double b) {
+    double x;
+    double y;
+    twoDiff(a, b, x, y);
+    Expansion e;
+    if (y != 0.0) {
+        e.push_back(y);
+    }
+    if (x != 0.0) {
+        e.push_back(x);
+    }
+    return e;
+}
+
+Expansion grow(const Expansion& e, double b) {
+    Expansion h;
+    h.reserve(e.size() + 1);
+    double q = b;
+    for (double component : e) {
+        double sum;
+        double err;
+        twoSum(q, component, sum, err);
+        if (err != 0.0) {
+            h.push_back(err);
+        }
+        q = sum;
+    }
+    if (q != 0.0) {
+        h.push_back(q);
+    }
+    return h;
+}
+
+Expansion add(Expansion e, const Expansion& f) {
+    for (double component : f) {
+        e = grow(e, component);
+    }
+    return e;
+}
+
+Expansion negate(Expansion e) {
+    for (double& component : e) {
+        component = -component;
+    }
+    return e;
+}
+
+Expansion scale(const Expansion& e, double b) {
+    Expansion h;
+    if (e.empty() || b == 0.0) {
+        return h;
+    }
+    h.reserve(2 * e.size());
+    double q;
+    double err;
+    twoProduct(e[0], b, q, err);
+    if (err != 0.0) {
+        h.push_back(err);
+    }
+    for (std::size_t i = 1; i < e.size(); ++i) {
+        double hi;
+        double lo;
+        twoProduct(e[i], b, hi, lo);
+        double sum;
+        twoSum(q, lo, sum, err);
+        if (err != 0.0) {
+            h.push_back(err);
+        }
+        fastTwoSum(hi, sum, q, err);
+        if (err != 0.0) {
+            h.push_back(err);
+        }
+    }
+    if (q != 0.0) {
+        h.push_back(q);
+    }
+    return h;
+}
+
+Expansion multiply(const Expansion& e, const Expansion& f) {
+    Expansion result;
+    for (double component : f) {
+        result = add(std::move(result), scale(e, component));
+    }
+    return result;
+}
+
+/// The most significant component carries the exact sign.
+double estimate(const Expansion& e) { return e.empty() ? 0.0 : e.back(); }
+
+double orient2dExact(const Vec2d& a, const Vec2d& b, const Vec2d& c) {
+    const Expansion acx = difference(a.x, c.x);
+    const Expansion acy = difference(a.y, c.y);
+    const Expansion bcx = difference(b.x, c.x);
+    const Expansion bcy = difference(b.y, c.y);
+    return estimate(add(multiply(acx, bcy), negate(multiply(acy, bcx))));
+}
+
+/// x1 * y2 - y1 * x2 over expansions.
+Expansion cross2(const Expansion& x1, const Expansion& y1, const Expansion& x2, const Expansion& y2) {
+    return add(multiply(x1, y2), negate(multiply(y1, x2)));
+}
+
+double orient3dExact(const Vec3d& a, const Vec3d& b, const Vec3d& c, const Vec3d& d) {
+    const Expansion adx = difference(a.x, d.x);
+    const Expansion ady = difference(a.y, d.y);
+    const Expansion adz = difference(a.z, d.z);
+    const Expansion bdx = difference(b.x, d.x);
+    const Expansion bdy = difference(b.y, d.y);
+    const Expansion bdz = difference(b.z, d.z);
+    const Expansion cdx = difference(c.x, d.x);
+    const Expansion cdy = difference(c.y, d.y);
+    const Expansion cdz = difference(c.z, d.z);
+    Expansion det = multiply(adz, cross2(bdx, bdy, cdx, cdy));
+    det = add(std::move(det), multiply(bdz, cross2(cdx, cdy, adx, ady)));
+    det = add(std::move(det), multiply(cdz, cross2(adx, ady, bdx, bdy)));
+    return estimate(det);
+}
+
+double incircleExact(const Vec2d& a, const Vec2d& b, const Vec2d& c, const Vec2d& d) {
+    const Expansion adx = difference(a.x, d.x);
+    const Expansion ady = difference(a.y, d.y);
+    const Expansion bdx = difference(b.x, d.x);
+    const Expansion bdy = difference(b.y, d.y);
+    const Expansion cdx = difference(c.x, d.x);
+    const Expansion cdy = difference(c.y, d.y);
+    const Expansion alift = add(multiply(adx, adx), multiply(ady, ady));
+    const Expansion blift = add(multiply(bdx, bdx), multiply(bdy, bdy));
+    const Expansion clift = add(multiply(cdx, cdx), multiply(cdy, cdy));
+    Expansion det = multiply(alift, cross2(bdx, bdy, cdx, cdy));
+    det = add(std::move(det), multiply(blift, cross2(cdx, cdy, adx, ady)));
+    det = add(std::move(det), multiply(clift, cross2(adx, ady, bdx, bdy)));
+    return estimate(det);
+}
+
+int sign(double x) { return (x > 0.0) - (x < 0.0); }
+
+/// `p` on the closed segment [a, b], given that the three are collinear.
+bool onSegment(const Vec2d& a, const Vec2d& b, const Vec2d& p) {
+    return std::fmin(a.x, b.x) <= p.x && p.x <= std::fmax(a.x, b.x) && std::fmin(a.y, b.y) <= p.y &&
+           p.y <= std::fmax(a.y, b.y);
+}
+
+Vec2d dropX(const Vec3d& v) { return {v.y, v.z}; }
+Vec2d dropY(const Vec3d& v) { return {v.z, v.x}; }
+Vec2d dropZ(const Vec3d& v) { return {v.x, v.y}; }
+
+/// Closed segments [a, b] and [c, d] in space meet. Coplanar segments meet
+/// iff they do in every coordinate projection: at least one projection is
+/// one-to-one on their plane (or line), and the others cannot lose contact.
+bool segmentsMeet(const Vec3d& a, const Vec3d& b, const Vec3d& c, const Vec3d& d) {
+    return orient3d(a, b, c, d) == 0.0 &&
+           intersectSegments(dropX(a), dropX(b), dropX(c), dropX(d)) != Intersection::None &&
+           intersectSegments(dropY(a), dropY(b), dropY(c), dropY(d)) != Intersection::None &&
+           intersectSegments(dropZ(a), dropZ(b), dropZ(c), dropZ(d)) != Intersection::None;
+}
+
+} // namespace
+
+double orient2d(const Vec2d& a, const Vec2d& b, const Vec2d& c) {
+    const double left = (a.x - c.x) * (b.y - c.y);
+    const double right = (a.y - c.y) * (b.x - c.x);
+    const double det = left - right;
+    double sum;
+    if (left > 0.0) {
+        if (right <= 0.0) {
+            return det;
+        }
+        sum = left + right;
+    } else if (left < 0.0) {
+        if (right >= 0.0) {
+            return det;
+        }
+        sum = -left - right;
+    } else {
+        return det;
+    }
+    const double bound = kOrient2dBound * sum;
+    if (det >= bound || -det >= bound) {
+        return det;
+    }
+    return orient2dExact(a, b, c);
+}
+
+double orient3d(const Vec3d& a, const Vec3d& b, const Vec3d& c, const Vec3d& d) {
+    const double adx = a.x - d.x;
+    const double bdx = b.x - d.x;
+    const double cdx = c.x - d.x;
+    const double ady = a.y - d.y;
+    const double bdy = b.y - d.y;
+    const double cdy = c.y - d.y;
+    const double adz = a.z - d.z;
+    const double bdz = b.z - d.z;
+    const double cdz = c.z - d.z;
+
+    const double bdxcdy = bdx * cdy;
+    const double cdxbdy = cdx * bdy;
+    const double cdxady = cdx * ady;
+    const double adxcdy = adx * cdy;
+    const double adxbdy = adx * bdy;
+    const double bdxady = bdx * ady;
+
+    const double det = adz * (bdxcdy - cdxbdy) + bdz * (cdxady - adxcdy) + cdz * (adxbdy - bdxady);
+    const double permanent = (std::fabs(bdxcdy) + std::fabs(cdxbdy)) * std::fabs(adz) +
+                             (std::fabs(cdxady) + std::fabs(adxcdy)) * std::fabs(bdz) +
+                             (std::fabs(adxbdy) + std::fabs(bdxady)) * std::fabs(cdz);
+    const double bound = kOrient3dBound * permanent;
+    if (det > bound || -det > bound) {
+        return det;
+    }
+    return orient3dExact(a, b, c, d);
+}
+
+double incircle(const Vec2d& a, const Vec2d& b, const Vec2d& c, const Vec2d& d) {
+    const double adx = a.x - d.x;
+    const double bdx = b.x - d.x;
+    const double cdx = c.x - d.x;
+    const double ady = a.y - d.y;
+    const double bdy = b.y - d.y;
+    const double cdy = c.y - d.y;
+
+    const double bdxcdy = bdx * cdy;
+    const double cdxbdy = cdx * bdy;
+    const double alift = adx * adx + ady * ady;
+    const double cdxady = cdx * ady;
+    const double adxcdy = adx * cdy;
+    const double blift = bdx * bdx + bdy * bdy;
+    const double adxbdy = adx * bdy;
+    const double bdxady = bdx * ady;
+    const double clift = cdx * cdx + cdy * cdy;
+
+    const double det = alift * (bdxcdy - cdxbdy) + blift * (cdxady - adxcdy) + clift * (adxbdy - bdxady);
+    const double permanent = (std::fabs(bdxcdy) + std::fabs(cdxbdy)) * alift +
+                             (std::fabs(cdxady) + std::fabs(adxcdy)) * blift +
+                             (std::fabs(adxbdy) + std::fabs(bdxady)) * clift;
+    const double bound = kIncircleBound * permanent;
+    if (det > bound || -det > bound) {
+        return det;
+    }
+    return incircleExact(a, b, c, d);
+}
+
+Intersection intersectSegments(const Vec2d& a, const Vec2d& b, const Vec2d& c, const Vec2d& d) {
+    const int o1 = sign(orient2d(a, b, c));
+    const int o2 = sign(orient2d(a, b, d));
+    const int o3 = sign(orient2d(c, d, a));
+    const int o4 = sign(orient2d(c, d, b));
+    if (o1 * o2 < 0 && o3 * o4 < 0) {
+        return Intersection::Proper;
+    }
+    if ((o1 == 0 && onSegment(a, b, c)) || (o2 == 0 && onSegment(a, b, d)) || (o3 == 0 && onSegment(c, d, a)) ||
+        (o4 == 0 && onSegment(c, d, b))) {
+        return Intersection::Touching;
+    }
+    return Intersection::None;
+}
+
+Intersection intersectSegmentTriangle(const Vec3d& p, const Vec3d& q, const Vec3d& a, const Vec3d& b,
+                                      const Vec3d& c) {
+    const int sp = sign(orient3d(a, b, c, p));
+    const int sq = sign(orient3d(a, b, c, q));
+    if (sp * sq > 0) {
+        return Intersection::None;
+    }
+
+    if (sp == 0 && sq == 0) {
+        // Coplanar, or a degenerate triangle (every point is coplanar with
+        // it). The projected areas are the normal's components with exact
+        // signs; all zero means a, b, c are collinear, and the triangle is
+        // its edges.
+        const double nx = orient2d(dropX(a), dropX(b), dropX(c));
+        const double ny = orient2d(dropY(a), dropY(b), dropY(c));
+        const double nz = orient2d(dropZ(a), dropZ(b), dropZ(c));
+        if (nx == 0.0 && ny == 0.0 && nz == 0.0) {
+            return segmentsMeet(p, q, a, b) || segmentsMeet(p, q, b, c) || segmentsMeet(p, q, c, a)
+                       ? Intersection::Touching
+                       : Intersection::None;
+        }
+        // Otherwise decide in the projection that drops the dominant normal
+        // axis. Any contact is degenerate.
+        const double ax = std::fabs(nx);
+        const double ay = std::fabs(ny);
+        const double az = std::fabs(nz);
+        const int drop = ax >= ay && ax >= az ? 0 : (ay >= az ? 1 : 2);
+        auto project = [drop](const Vec3d& v) { return drop == 0 ? dropX(v) : drop == 1 ? dropY(v) : dropZ(v); };
+        const Vec2d p2 = project(p);
+        const Vec2d q2 = project(q);
+        const Vec2d a2 = project(a);
+        const Vec2d b2 = project(b);
+        const Vec2d c2 = project(c);
+        if (intersectSegments(p2, q2, a2, b2) != Intersection::None ||
+            intersectSegments(p2, q2, b2, c2) != Intersection::None ||
+            intersectSegments(p2, q2, c2, a2) != Intersection::None) {
+            return Intersection::Touching;
+        }
+        // Entirely inside (then p is strictly inside the triangle).
+        const int e0 = sign(orient2d(a2, b2, p2));
+        const int e1 = sign(orient2d(b2, c2, p2));
+        const int e2 = sign(orient2d(c2, a2, p2));
+        if (e0 != 0 && e0 == e1 && e1 == e2) {
+            return Intersection::Touching;
+        }
+        return Intersection::None;
+    }
+
+    // The segment meets the plane; the line through it pierces the triangle
+    // iff it passes every edge on the same side.
+    const int t0 = sign(orient3d(p, q, a, b));
+    const int t1 = sign(orient3d(p, q, b, c));
+    const int t2 = sign(orient3d(p, q, c, a));
+    if ((t0 > 0 || t1 > 0 || t2 > 0) && (t0 < 0 || t1 < 0 || t2 < 0)) {
+        return Intersection::None;
+    }
+    const bool throughInterior = t0 != 0 && t1 != 0 && t2 != 0;
+    return throughInterior && sp != 0 && sq != 0 ? Intersection::Proper : Intersection::Touching;
+}
+
+Intersection intersectTriangles(const Vec3d& a, const Vec3d& b, const Vec3d& c, const Vec3d& d, const Vec3d& e,
+                                const Vec3d& f) {
+    // Any contact of two triangles meets an edge of one of them, so the six
+    // edge tests are complete.
+    const Vec3d* first[3] = {&a, &b, &c};
+    const Vec3d* second[3] = {&d, &e, &f};
+    Intersection result = Intersection::None;
+    for (int i = 0; i < 3; ++i) {
+        for (const Intersection r : {intersectSegmentTriangle(*first[i], *first[(i + 1) % 3], d, e, f),
+                                     intersectSegmentTriangle(*second[i], *second[(i + 1) % 3], a, b, c)}) {
+            if (r == Intersection::Proper) {
+                return r;
+            }
+            if (r == Intersection::Touching) {
+                result = r;
+            }
+        }
+    }
+    return result;
+}
+
+} // namespace rebel::math
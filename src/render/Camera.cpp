@@ -0,0 +1,36 @@
+#include "rebel/render/Camera.hpp"
+
+namespace rebel::render {
+
+using math::Vec3f;
+
+Camera Camera::perspective(const Vec3f& eye, const Vec3f& target, const Vec3f& up, float fovY,
+                           std::uint32_t width, std::uint32_t height, float near, float far) {
+    Camera camera;
+    const float aspect = height == 0 ? 1.0f : static_cast<float>(width) / static_cast<float>(height);
+    camera.viewProjection = math::Mat4f::perspective(fovY, aspect, near, far) * math::Mat4f::lookAt(eye, target, up);
+    camera.width = width;
+    camera.height = height;
+    return camera;
+}
+
+math::Ray Camera::ray(float x, float y) const {
+    const float nx = 2.0f * x / static_cast<float>(width) - 1.0f;
+    const float ny = 1.0f - 2.0f * y / static_cast<float>(height);
+    const math::Mat4f inverse = viewProjection.inverse();
+    const Vec3f near = inverse.transformProjective({nx, ny, -1.0f});
+    const Vec3f far = inverse.transformProjective({nx, ny, 1.0f});
+    math::Ray ray;
+    ray.origin = near;
+    ray.direction = math::normalize(far - near);
+    ray.tMax = math::length(far - near);
+    return ray;
+}
+
+Vec3f Camera::project(const Vec3f& world) const {
+    const Vec3f ndc = viewProjection.transformProjective(world);
+    return {0.5f * (ndc.x + 1.0f) * static_cast<float>(width), 0.5f * (1.0f - ndc.y) * static_cast<float>(height),
+            ndc.z};
+}
+
+} // namespace rebel::render
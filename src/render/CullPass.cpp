@@ -0,0 +1,362 @@
+#include "rebel/render/CullPass.hpp"
+
+#include "rebel/core/TaskScheduler.hpp"
+#include "rebel/core/Trace.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace rebel::render {
+
+namespace {
+
+constexpr float kInfinity = std::numeric_limits<float>::infinity();
+constexpr std::uint32_t kCulled = 0xFFFFFFFFu;
+
+/// Row of the world-to-clip transform, split into the part dotted with a
+/// box center and its absolute value, dotted with the box extent: over a
+/// box, the row ranges over `center value -/+ extent value`.
+struct Row {
+    float x, y, z, w;
+    float ax, ay, az;
+
+    static Row of(float x, float y, float z, float w) {
+        return {x, y, z, w, std::abs(x), std::abs(y), std::abs(z)};
+    }
+    float center(const float* c) const { return x * c[0] + y * c[1] + z * c[2] + w; }
+    float extent(const float* e) const { return ax * e[0] + ay * e[1] + az * e[2]; }
+};
+
+/// Per-frame constants of the culling kernel.
+struct FrameConstants {
+    /// Clip x, y, z and w rows.
+    Row clip[4];
+    /// Frustum planes (w + x, w - x, w + y, w - y, w + z, w - z); a box is
+    /// outside if it lies entirely on the negative side of one.
+    Row planes[6];
+    float width = 0.0f;
+    float height = 0.0f;
+    /// For perspective projections clip z is `depthScale * w + depthOffset`,
+    /// so the nearest depth over a box follows from its nearest w alone.
+    bool depthFromW = false;
+    float depthScale = 0.0f;
+    float depthOffset = 0.0f;
+
+    explicit FrameConstants(const Camera& camera) {
+        const float* a = camera.viewProjection.m;
+        for (int r = 0; r < 4; ++r) {
+            clip[r] = Row::of(a[r], a[4 + r], a[8 + r], a[12 + r]);
+        }
+        for (int k = 0; k < 3; ++k) {
+            const Row& w = clip[3];
+            const Row& v = clip[k];
+            planes[2 * k] = Row::of(w.x + v.x, w.y + v.y, w.z + v.z, w.w + v.w);
+            planes[2 * k + 1] = Row::of(w.x - v.x, w.y - v.y, w.z - v.z, w.w - v.w);
+        }
+        width = static_cast<float>(camera.width);
+        height = static_cast<float>(camera.height);
+        const Row& z = clip[2];
+        const Row& w = clip[3];
+        const float ww = w.x * w.x + w.y * w.y + w.z * w.z;
+        if (ww > 0.0f) {
+            depthScale = (z.x * w.x + z.y * w.y + z.z * w.z) / ww;
+            depthOffset = z.w - depthScale * w.w;
+            const float rx = z.x - depthScale * w.x;
+            const float ry = z.y - depthScale * w.y;
+            const float rz = z.z - depthScale * w.z;
+            depthFromW = rx * rx + ry * ry + rz * rz <= 1e-10f * (z.x * z.x + z.y * z.y + z.z * z.z);
+        }
+    }
+};
+
+/// Screen extent of a box: a pixel rectangle and nearest NDC depth bounding
+/// its projection, from interval bounds on clip coordinates over the box.
+/// Only computed for boxes in the frustum and in front of the near plane.
+struct Projection {
+    bool outside = false;
+    bool crossesNear = false;
+    float minX = 0.0f;
+    float maxX = 0.0f;
+    float minY = 0.0f;
+    float maxY = 0.0f;
+    float minZ = 0.0f;
+};
+
+/// Smallest and largest `v / w` over `v` in [lo, hi] and `w` in
+/// [1 / inverseNear, 1 / inverseFar], both positive.
+void divideRange(float lo, float hi, float inverseNear, float inverseFar, float& low, float& high) {
+    low = lo * (lo < 0.0f ? inverseNear : inverseFar);
+    high = hi * (hi > 0.0f ? inverseNear : inverseFar);
+}
+
+Projection project(const GpuInstance& instance, const FrameConstants& frame) {
+    const float c[3] = {0.5f * (instance.boundsMin[0] + instance.boundsMax[0]),
+                        0.5f * (instance.boundsMin[1] + instance.boundsMax[1]),
+                        0.5f * (instance.boundsMin[2] + instance.boundsMax[2])};
+    const float e[3] = {0.5f * (instance.boundsMax[0] - instance.boundsMin[0]),
+                        0.5f * (instance.boundsMax[1] - instance.boundsMin[1]),
+                        0.5f * (instance.boundsMax[2] - instance.boundsMin[2])};
+    Projection p;
+    for (const Row& plane : frame.planes) {
+        p.outside = p.outside || plane.center(c) + plane.extent(e) < 0.0f;
+    }
+    if (p.outside) {
+        return p;
+    }
+    // Part of the box may lie behind the near plane (or the eye).
+    const float w = frame.clip[3].center(c);
+    const float we = frame.clip[3].extent(e);
+    const Row& near = frame.planes[4];
+    p.crossesNear = near.center(c) - near.extent(e) < 0.0f || !(w - we > 0.0f);
+    if (p.crossesNear) {
+        return p;
+    }
+    const float inverseNear = 1.0f / (w - we);
+    const float inverseFar = 1.0f / (w + we);
+    float x[2];
+    float y[2];
+    const float xc = frame.clip[0].center(c);
+    const float xe = frame.clip[0].extent(e);
+    const float yc = frame.clip[1].center(c);
+    const float ye = frame.clip[1].extent(e);
+    divideRange(xc - xe, xc + xe, inverseNear, inverseFar, x[0], x[1]);
+    divideRange(yc - ye, yc + ye, inverseNear, inverseFar, y[0], y[1]);
+    if (frame.depthFromW) {
+        p.minZ = frame.depthScale + frame.depthOffset * (frame.depthOffset < 0.0f ? inverseNear : inverseFar);
+    } else {
+        const float zc = frame.clip[2].center(c);
+        const float ze = frame.clip[2].extent(e);
+        float z[2];
+        divideRange(zc - ze, zc + ze, inverseNear, inverseFar, z[0], z[1]);
+        p.minZ = z[0];
+    }
+    p.minX = (x[0] + 1.0f) * 0.5f * frame.width;
+    p.maxX = (x[1] + 1.0f) * 0.5f * frame.width;
+    p.minY = (1.0f - y[1]) * 0.5f * frame.height;
+    p.maxY = (1.0f - y[0]) * 0.5f * frame.height;
+    return p;
+}
+
+/// Per-group tallies, summed once the pass is done.
+struct GroupStats {
+    std::size_t hidden = 0;
+    std::size_t frustumCulled = 0;
+    std::size_t occluded = 0;
+    std::size_t substituted = 0;
+    std::size_t waiting = 0;
+};
+
+} // namespace
+
+void DepthPyramid::build(const float* depth, std::uint32_t width, std::uint32_t height) {
+    levels_.clear();
+    texels_.clear();
+    if (width == 0 || height == 0) {
+        return;
+    }
+    std::size_t total = 0;
+    for (std::uint32_t w = width, h = height;; w = (w + 1) / 2, h = (h + 1) / 2) {
+        levels_.push_back({w, h, total});
+        total += std::size_t(w) * h;
+        if (w == 1 && h == 1) {
+            break;
+        }
+    }
+    texels_.resize(total);
+    for (std::size_t i = 0; i < std::size_t(width) * height; ++i) {
+        texels_[i] = std::min(depth[i], 1.0f);
+    }
+    for (std::size_t level = 1; level < levels_.size(); ++level) {
+        const Level& below = levels_[level - 1];
+        const Level& l = levels_[level];
+        const float* src = texels_.data() + below.offset;
+        float* dst = texels_.data() + l.offset;
+        for (std::uint32_t y = 0; y < l.height; ++y) {
+            const std::uint32_t y0 = 2 * y;
+            const std::uint32_t y1 = std::min(y0 + 1, below.height - 1);
+            for (std::uint32_t x = 0; x < l.width; ++x) {
+                const std::uint32_t x0 = 2 * x;
+                const std::uint32_t x1 = std::min(x0 + 1, below.width - 1);
+                dst[std::size_t(y) * l.width + x] =
+                    std::max({src[std::size_t(y0) * below.width + x0], src[std::size_t(y0) * below.width + x1],
+                              src[std::size_t(y1) * below.width + x0], src[std::size_t(y1) * below.width + x1]});
+            }
+        }
+    }
+}
+
+bool DepthPyramid::occludes(float x0, float y0, float x1, float y1, float nearDepth) const {
+    if (empty()) {
+        return false;
+    }
+    const auto clampTexel = [](float v, std::uint32_t size) {
+        return static_cast<std::uint32_t>(std::clamp(std::floor(v), 0.0f, static_cast<float>(size - 1)));
+    };
+    const std::uint32_t ix0 = clampTexel(x0, width());
+    const std::uint32_t ix1 = clampTexel(x1, width());
+    const std::uint32_t iy0 = clampTexel(y0, height());
+    const std::uint32_t iy1 = clampTexel(y1, height());
+    // Coarsest level at which the rectangle still spans at most 2x2 texels.
+    const std::uint32_t span = std::max(ix1 - ix0, iy1 - iy0);
+    std::size_t level = 0;
+    while ((span >> level) > 0) {
+        ++level;
+    }
+    level = std::min(level, levels_.size() - 1);
+    float farthest = -kInfinity;
+    for (std::uint32_t y = iy0 >> level; y <= (iy1 >> level); ++y) {
+        for (std::uint32_t x = ix0 >> level; x <= (ix1 >> level); ++x) {
+            farthest = std::max(farthest, at(level, x, y));
+        }
+    }
+    return nearDepth > farthest;
+}
+
+void CullPass::run(DrawScene& scene, const Camera& camera, const DepthPyramid* occluders, DrawList& out) {
+    REBEL_TRACE_ZONE("render.cull");
+    scene.beginFrame();
+
+    const std::vector<GpuInstance>& instances = scene.instances();
+    const std::vector<GpuDrawGroup>& groups = scene.groups();
+    const std::vector<GpuPart>& parts = scene.parts();
+    const std::vector<GpuLod>& lods = scene.lods();
+    const std::size_t count = instances.size();
+    selection_.resize(count);
+    if (counterCount_ < scene.commandCount()) {
+        counterCount_ = scene.commandCount();
+        counters_.reset(new std::atomic<std::uint32_t>[counterCount_]);
+    }
+    for (std::size_t c = 0; c < scene.commandCount(); ++c) {
+        counters_[c].store(0, std::memory_order_relaxed);
+    }
+    if (wantedCount_ < lods.size()) {
+        wantedCount_ = lods.size();
+        wanted_.reset(new std::atomic<std::uint8_t>[wantedCount_]);
+    }
+    for (std::size_t l = 0; l < lods.size(); ++l) {
+        wanted_[l].store(0, std::memory_order_relaxed);
+    }
+
+    const FrameConstants frame(camera);
+    const float width = frame.width;
+    const float height = frame.height;
+    const float viewportArea = width * height;
+    const bool occlusion = options_.occlusionCulling && occluders != nullptr && !occluders->empty();
+    const float toPyramidX = occlusion ? static_cast<float>(occluders->width()) / width : 1.0f;
+    const float toPyramidY = occlusion ? static_cast<float>(occluders->height()) / height : 1.0f;
+    const std::size_t groupSize = std::max<std::uint32_t>(options_.groupSize, 1);
+    std::vector<GroupStats> groupStats((count + groupSize - 1) / groupSize);
+
+    // Pass 1: visibility and level per instance, counted per command.
+    core::parallelFor(std::size_t(0), count, groupSize, [&](std::size_t begin, std::size_t end) {
+        GroupStats& tally = groupStats[begin / groupSize];
+        for (std::size_t i = begin; i < end; ++i) {
+            const GpuInstance& instance = instances[i];
+            selection_[i] = kCulled;
+            if (instance.flags & GpuInstance::kHidden) {
+                ++tally.hidden;
+                continue;
+            }
+            const Projection p = project(instance, frame);
+            if (options_.frustumCulling && p.outside) {
+                ++tally.frustumCulled;
+                continue;
+            }
+            if (occlusion && !p.crossesNear &&
+                occluders->occludes(p.minX * toPyramidX, p.minY * toPyramidY, p.maxX * toPyramidX,
+                                    p.maxY * toPyramidY, p.minZ)) {
+                ++tally.occluded;
+                continue;
+            }
+            const float area = p.crossesNear ? viewportArea
+                                             : std::min((p.maxX - p.minX) * (p.maxY - p.minY), viewportArea);
+            const GpuDrawGroup& group = groups[instance.group];
+            const GpuPart& part = parts[group.part];
+            const float budget = area * options_.trianglesPerPixel;
+            std::uint32_t wanted = 0;
+            while (wanted + 1 < part.lodCount &&
+                   static_cast<float>(lods[part.firstLod + wanted].indexCount / 3) > budget) {
+                ++wanted;
+            }
+            // Until the selected level streams in, the nearest resident one
+            // stands in, coarser first.
+            std::uint32_t level = wanted;
+            if (!lods[part.firstLod + wanted].resident()) {
+                wanted_[part.firstLod + wanted].store(1, std::memory_order_relaxed);
+                level = kCulled;
+                for (std::uint32_t k = wanted + 1; k < part.lodCount && level == kCulled; ++k) {
+                    level = lods[part.firstLod + k].resident() ? k : kCulled;
+                }
+                for (std::uint32_t k = wanted; k-- > 0 && level == kCulled;) {
+                    level = lods[part.firstLod + k].resident() ? k : kCulled;
+                }
+                if (level == kCulled) {
+                    ++tally.waiting;
+                    continue;
+                }
+                ++tally.substituted;
+            }
+            const std::uint32_t command = group.firstCommand + level;
+            selection_[i] = command;
+            counters_[command].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    // Pass 2: prefix sum over the counts into compacted commands, batched
+    // by material (groups, and so commands, are sorted by material).
+    out.commands.clear();
+    out.batches.clear();
+    out.stats = CullStats();
+    out.stats.instances = count;
+    std::uint32_t next = 0;
+    for (const GpuDrawGroup& group : groups) {
+        const GpuPart& part = parts[group.part];
+        for (std::uint32_t k = 0; k < group.commandCount; ++k) {
+            const std::uint32_t command = group.firstCommand + k;
+            const std::uint32_t drawn = counters_[command].load(std::memory_order_relaxed);
+            if (drawn == 0) {
+                continue;
+            }
+            const std::uint32_t lod = part.firstLod + k;
+            const GpuLod& range = lods[lod];
+            if (out.batches.empty() || out.batches.back().material != group.material) {
+                out.batches.push_back({group.material, static_cast<std::uint32_t>(out.commands.size()), 0});
+            }
+            ++out.batches.back().commandCount;
+            out.commands.push_back({range.indexCount, drawn, range.firstIndex, range.baseVertex, next});
+            counters_[command].store(next, std::memory_order_relaxed);
+            next += drawn;
+            out.stats.triangles += std::size_t(drawn) * (range.indexCount / 3);
+            scene.touch(lod);
+        }
+    }
+    out.stats.drawn = next;
+
+    // Pass 3: scatter the survivors into the instance buffer.
+    out.instances.resize(next);
+    core::parallelFor(std::size_t(0), count, groupSize, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const std::uint32_t command = selection_[i];
+            if (command != kCulled) {
+                out.instances[counters_[command].fetch_add(1, std::memory_order_relaxed)] =
+                    static_cast<std::uint32_t>(i);
+            }
+        }
+    });
+
+    for (const GroupStats& tally : groupStats) {
+        out.stats.hidden += tally.hidden;
+        out.stats.frustumCulled += tally.frustumCulled;
+        out.stats.occluded += tally.occluded;
+        out.stats.substituted += tally.substituted;
+        out.stats.waiting += tally.waiting;
+    }
+    for (std::uint32_t lod = 0; lod < lods.size(); ++lod) {
+        if (wanted_[lod].load(std::memory_order_relaxed) != 0) {
+            scene.request(lod);
+        }
+    }
+}
+
+} // namespace rebel::render
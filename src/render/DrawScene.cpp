@@ -0,0 +1,518 @@
+#include "rebel/render/DrawScene.hpp"
+
+#include "rebel/core/Trace.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+
+namespace rebel::render {
+
+using math::Vec3f;
+
+namespace {
+
+constexpr std::uint32_t kNoSlot = 0xFFFFFFFFu;
+
+std::uint32_t packSnorm10(float v) {
+    const auto q = static_cast<std::int32_t>(std::lround(std::clamp(v, -1.0f, 1.0f) * 511.0f));
+    return static_cast<std::uint32_t>(q) & 0x3FFu;
+}
+
+std::uint32_t packNormal(const Vec3f& n) {
+    const float length = math::length(n);
+    const Vec3f u = length > 0.0f ? n / length : Vec3f{0.0f, 0.0f, 1.0f};
+    return packSnorm10(u.x) | packSnorm10(u.y) << 10 | packSnorm10(u.z) << 20;
+}
+
+std::size_t geometryBytes(std::size_t vertices, std::size_t indices) {
+    return vertices * sizeof(GpuVertex) + indices * sizeof(std::uint32_t);
+}
+
+bool hiddenInTree(const assembly::Assembly& assembly, assembly::NodeId node) {
+    for (; node != assembly::kInvalidNode; node = assembly.node(node).parent) {
+        if (assembly.node(node).overrides.hidden()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::uint32_t colorOf(const assembly::Overrides& overrides, const DrawSceneOptions& options) {
+    return overrides.hasColor() ? overrides.colorRgba : options.defaultColorRgba;
+}
+
+} // namespace
+
+std::uint32_t DrawScene::RangeAllocator::allocate(std::uint32_t count, std::uint32_t& size) {
+    for (auto it = free_.begin(); it != free_.end(); ++it) {
+        if (it->count >= count) {
+            const std::uint32_t offset = it->offset;
+            it->offset += count;
+            it->count -= count;
+            if (it->count == 0) {
+                free_.erase(it);
+            }
+            return offset;
+        }
+    }
+    // Extend a free range at the end of the pool rather than leave it.
+    std::uint32_t offset = size;
+    if (!free_.empty() && free_.back().offset + free_.back().count == size) {
+        offset = free_.back().offset;
+        free_.pop_back();
+    }
+    size = offset + count;
+    return offset;
+}
+
+void DrawScene::RangeAllocator::release(std::uint32_t offset, std::uint32_t count) {
+    if (count == 0) {
+        return;
+    }
+    auto it = std::lower_bound(free_.begin(), free_.end(), offset,
+                               [](const Range& r, std::uint32_t o) { return r.offset < o; });
+    it = free_.insert(it, {offset, count});
+    if (std::next(it) != free_.end() && it->offset + it->count == std::next(it)->offset) {
+        it->count += std::next(it)->count;
+        free_.erase(std::next(it));
+    }
+    if (it != free_.begin() && std::prev(it)->offset + std::prev(it)->count == it->offset) {
+        std::prev(it)->count += it->count;
+        free_.erase(it);
+    }
+}
+
+DrawScene::DrawScene(const assembly::Assembly& assembly, const assembly::AssemblyIndex& index,
+                     const DrawSceneOptions& options)
+    : assembly_(assembly), index_(index), options_(options), frameStamp_(core::MemoryBudget::stamp()) {
+    rebuild();
+    if (options_.budget != nullptr) {
+        options_.budget->add(this);
+    }
+}
+
+DrawScene::~DrawScene() {
+    if (options_.budget != nullptr) {
+        options_.budget->remove(this);
+    }
+    loads_.cancel();
+    try {
+        loads_.wait();
+    } catch (...) {
+        // Loads report failures through their results, never by throwing.
+    }
+}
+
+void DrawScene::rebuild() {
+    REBEL_TRACE_ZONE("render.scene_rebuild");
+    revision_ = assembly_.revision();
+    const std::size_t count = index_.occurrenceCount();
+    indexedCount_ = count;
+    instances_.assign(count, GpuInstance());
+
+    std::unordered_map<std::uint32_t, std::uint32_t> materialOf;
+    std::unordered_map<std::uint64_t, std::uint32_t> groupOf;
+    materials_.clear();
+    groups_.clear();
+    for (spatial::InstanceId i = 0; i < count; ++i) {
+        const std::uint32_t color = colorOf(assembly_.node(index_.node(i)).overrides, options_);
+        const auto material = materialOf.try_emplace(color, static_cast<std::uint32_t>(materials_.size()));
+        if (material.second) {
+            materials_.push_back({color});
+        }
+        const std::uint32_t slot = partSlot(i);
+        const std::uint64_t key = std::uint64_t(material.first->second) << 32 | slot;
+        const auto group = groupOf.try_emplace(key, static_cast<std::uint32_t>(groups_.size()));
+        if (group.second) {
+            groups_.push_back({slot, material.first->second, 0, 0});
+        }
+        instances_[i].group = group.first->second;
+    }
+
+    // Commands of one material must be contiguous to be one multi-draw.
+    std::vector<std::uint32_t> order(groups_.size());
+    for (std::uint32_t g = 0; g < order.size(); ++g) {
+        order[g] = g;
+    }
+    std::sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) {
+        const GpuDrawGroup& x = groups_[a];
+        const GpuDrawGroup& y = groups_[b];
+        return x.material != y.material ? x.material < y.material : x.part < y.part;
+    });
+    std::vector<GpuDrawGroup> sorted(groups_.size());
+    std::vector<std::uint32_t> rank(groups_.size());
+    for (std::uint32_t r = 0; r < order.size(); ++r) {
+        sorted[r] = groups_[order[r]];
+        rank[order[r]] = r;
+    }
+    groups_ = std::move(sorted);
+    for (GpuInstance& instance : instances_) {
+        instance.group = rank[instance.group];
+    }
+    layoutCommands();
+
+    for (spatial::InstanceId i = 0; i < count; ++i) {
+        writeInstance(i);
+    }
+    markDirty(0, count);
+    tablesDirty_ = true;
+}
+
+void DrawScene::update(const std::vector<assembly::NodeId>& moved) {
+    if (assembly_.structureChangedSince(revision_) || index_.occurrenceCount() != indexedCount_) {
+        rebuild();
+        return;
+    }
+    // A new color moves the instance to another draw group.
+    for (const assembly::NodeId node : moved) {
+        const spatial::InstanceId i = index_.instance(node);
+        if (i != geometry::kInvalidIndex &&
+            colorOf(assembly_.node(node).overrides, options_) !=
+                materials_[groups_[instances_[i].group].material].colorRgba) {
+            rebuild();
+            return;
+        }
+    }
+    revision_ = assembly_.revision();
+    bool levelsChanged = false;
+    for (const assembly::NodeId node : moved) {
+        const spatial::InstanceId i = index_.instance(node);
+        if (i == geometry::kInvalidIndex) {
+            continue;
+        }
+        // The library may have swapped the part's definition in place.
+        const std::uint32_t slot = groups_[instances_[i].group].part;
+        if (!slots_[slot].fromDocument && slots_[slot].definition != &index_.definition(i)) {
+            slots_[slot].definition = &index_.definition(i);
+            setLevels(slot, {index_.sharedDefinition(i)});
+            levelsChanged = true;
+        }
+        writeInstance(i);
+        markDirty(i, i + 1);
+    }
+    if (levelsChanged) {
+        layoutCommands();
+    }
+}
+
+void DrawScene::streamLevels(std::shared_ptr<const io::NativeDocument> document) {
+    REBEL_TRACE_ZONE("render.scene_stream_levels");
+    for (std::uint32_t slot = 0; slot < slots_.size(); ++slot) {
+        const std::uint32_t record = document->findPart(slots_[slot].name);
+        if (record == io::NativeDocument::kNotFound) {
+            continue;
+        }
+        // Levels are zero-copy views into the mapping: nothing is read
+        // until a level is streamed.
+        std::vector<assembly::PartPtr> levels{document->loadPart(record)};
+        const std::size_t lodCount = document->partInfo(record).lodCount;
+        for (std::uint32_t lod = 0; lod < lodCount; ++lod) {
+            levels.push_back(document->loadLod(record, lod));
+        }
+        slots_[slot].fromDocument = true;
+        setLevels(slot, std::move(levels));
+    }
+    layoutCommands();
+}
+
+std::uint32_t DrawScene::partSlot(spatial::InstanceId instance) {
+    const assembly::PartId part = index_.part(instance);
+    if (part >= slotOf_.size()) {
+        slotOf_.resize(std::size_t(part) + 1, kNoSlot);
+    }
+    std::uint32_t& slot = slotOf_[part];
+    if (slot == kNoSlot) {
+        slot = static_cast<std::uint32_t>(parts_.size());
+        parts_.push_back({});
+        slots_.push_back({&index_.definition(instance), index_.definition(instance).name(), false});
+        setLevels(slot, {index_.sharedDefinition(instance)});
+    } else if (!slots_[slot].fromDocument && slots_[slot].definition != &index_.definition(instance)) {
+        slots_[slot].definition = &index_.definition(instance);
+        setLevels(slot, {index_.sharedDefinition(instance)});
+    }
+    return slot;
+}
+
+void DrawScene::setLevels(std::uint32_t slot, std::vector<assembly::PartPtr> levels) {
+    GpuPart& part = parts_[slot];
+    for (std::uint32_t lod = part.firstLod; lod < part.firstLod + part.lodCount; ++lod) {
+        if (lods_[lod].resident()) {
+            evict(lod);
+        }
+        // Loads still running for the old levels are dropped on arrival.
+        ++lodState_[lod].generation;
+        lodState_[lod].source.reset();
+        lodState_[lod].pending = false;
+        lodState_[lod].failed = false;
+        lods_[lod] = GpuLod();
+    }
+    const auto count = static_cast<std::uint32_t>(levels.size());
+    if (count != part.lodCount) {
+        part.firstLod = static_cast<std::uint32_t>(lods_.size());
+        part.lodCount = count;
+        lods_.resize(lods_.size() + count);
+        lodState_.resize(lodState_.size() + count);
+    }
+    for (std::uint32_t k = 0; k < count; ++k) {
+        const std::uint32_t lod = part.firstLod + k;
+        lods_[lod].indexCount = static_cast<std::uint32_t>(levels[k]->mesh().triangleCount * 3);
+        LodState& state = lodState_[lod];
+        state.source = std::move(levels[k]);
+        state.lastDrawn = 0;
+        state.coarsest = k + 1 == count;
+    }
+    tablesDirty_ = true;
+}
+
+void DrawScene::layoutCommands() {
+    std::uint32_t next = 0;
+    for (GpuDrawGroup& group : groups_) {
+        group.firstCommand = next;
+        group.commandCount = parts_[group.part].lodCount;
+        next += group.commandCount;
+    }
+    commandCount_ = next;
+    tablesDirty_ = true;
+}
+
+void DrawScene::writeInstance(spatial::InstanceId instance) {
+    GpuInstance& out = instances_[instance];
+    const spatial::TwoLevelBvh& bvh = index_.bvh();
+    std::memcpy(out.world, bvh.transform(instance).m, sizeof(out.world));
+    const math::Aabb& bounds = bvh.worldBounds(instance);
+    out.boundsMin[0] = bounds.min.x;
+    out.boundsMin[1] = bounds.min.y;
+    out.boundsMin[2] = bounds.min.z;
+    out.boundsMax[0] = bounds.max.x;
+    out.boundsMax[1] = bounds.max.y;
+    out.boundsMax[2] = bounds.max.z;
+    out.flags = hiddenInTree(assembly_, index_.node(instance)) ? GpuInstance::kHidden : 0u;
+}
+
+void DrawScene::request(std::uint32_t lod) {
+    LodState& state = lodState_[lod];
+    if (lods_[lod].resident() || state.pending || state.failed || !state.source) {
+        return;
+    }
+    state.pending = true;
+    ++pending_;
+    loads_.run([this, lod, generation = state.generation, source = state.source] {
+        REBEL_TRACE_ZONE_DETAIL("render.stream_lod", source->name());
+        Loaded loaded;
+        loaded.lod = lod;
+        loaded.generation = generation;
+        try {
+            // Reading the arrays is what pages a mapped level in.
+            const geometry::MeshView& mesh = source->mesh();
+            std::vector<Vec3f> normals;
+            if (!mesh.hasNormals()) {
+                normals.assign(mesh.vertexCount, Vec3f{});
+                for (std::size_t t = 0; t < mesh.triangleCount; ++t) {
+                    const geometry::VertexIndex* c = mesh.corners + 3 * t;
+                    const Vec3f a = mesh.position(c[0]);
+                    const Vec3f n = math::cross(mesh.position(c[1]) - a, mesh.position(c[2]) - a);
+                    for (int k = 0; k < 3; ++k) {
+                        normals[c[k]] = normals[c[k]] + n;
+                    }
+                }
+            }
+            loaded.vertices.resize(mesh.vertexCount);
+            for (std::size_t v = 0; v < mesh.vertexCount; ++v) {
+                const auto i = static_cast<geometry::VertexIndex>(v);
+                loaded.vertices[v] = {mesh.px[v], mesh.py[v], mesh.pz[v],
+                                      packNormal(mesh.hasNormals() ? mesh.normal(i) : normals[v])};
+            }
+            loaded.indices.assign(mesh.corners, mesh.corners + 3 * mesh.triangleCount);
+        } catch (...) {
+            loaded.vertices.clear();
+            loaded.indices.clear();
+            loaded.failed = true;
+        }
+        std::lock_guard<std::mutex> lock(loadedMutex_);
+        loaded_.push_back(std::move(loaded));
+    });
+}
+
+void DrawScene::beginFrame() {
+    REBEL_TRACE_ZONE("render.scene_begin_frame");
+    ++frame_;
+    frameStamp_ = core::MemoryBudget::stamp();
+    std::size_t uploaded = 0;
+    while (uploaded < options_.uploadBytesPerFrame) {
+        Loaded loaded;
+        {
+            std::lock_guard<std::mutex> lock(loadedMutex_);
+            if (loaded_.empty()) {
+                break;
+            }
+            loaded = std::move(loaded_.front());
+            loaded_.pop_front();
+        }
+        uploaded += geometryBytes(loaded.vertices.size(), loaded.indices.size());
+        commit(loaded);
+    }
+    evictOverBudget();
+}
+
+void DrawScene::finishStreaming() {
+    loads_.wait();
+    std::deque<Loaded> loaded;
+    {
+        std::lock_guard<std::mutex> lock(loadedMutex_);
+        loaded.swap(loaded_);
+    }
+    for (Loaded& l : loaded) {
+        commit(l);
+    }
+    evictOverBudget();
+}
+
+void DrawScene::commit(Loaded& loaded) {
+    --pending_;
+    LodState& state = lodState_[loaded.lod];
+    if (loaded.generation != state.generation) {
+        return;
+    }
+    state.pending = false;
+    if (loaded.failed) {
+        state.failed = true;
+        ++failed_;
+        return;
+    }
+    const auto vertexCount = static_cast<std::uint32_t>(loaded.vertices.size());
+    const auto indexCount = static_cast<std::uint32_t>(loaded.indices.size());
+    const std::uint32_t firstVertex = vertexSpace_.allocate(vertexCount, vertexEnd_);
+    const std::uint32_t firstIndex = indexSpace_.allocate(indexCount, indexEnd_);
+    const std::size_t vertexCapacity = vertices_.capacity();
+    const std::size_t indexCapacity = indices_.capacity();
+    if (vertexEnd_ > vertices_.size()) {
+        vertices_.resize(vertexEnd_);
+    }
+    if (indexEnd_ > indices_.size()) {
+        indices_.resize(indexEnd_);
+    }
+    // A reallocated buffer has to be uploaded whole.
+    poolGrew_ = poolGrew_ || vertices_.capacity() != vertexCapacity || indices_.capacity() != indexCapacity;
+    std::copy(loaded.vertices.begin(), loaded.vertices.end(), vertices_.begin() + firstVertex);
+    std::copy(loaded.indices.begin(), loaded.indices.end(), indices_.begin() + firstIndex);
+
+    GpuLod& lod = lods_[loaded.lod];
+    lod.firstIndex = firstIndex;
+    lod.indexCount = indexCount;
+    lod.baseVertex = static_cast<std::int32_t>(firstVertex);
+    lod.flags |= GpuLod::kResident;
+    state.lastDrawn = frame_;
+    state.lastUse = frameStamp_;
+    state.vertexCount = vertexCount;
+    poolBytes_ += geometryBytes(vertexCount, indexCount);
+    ++streamed_;
+    tablesDirty_ = true;
+    recordUpload({firstVertex, vertexCount, firstIndex, indexCount});
+}
+
+bool DrawScene::evictable(std::uint32_t lod) const {
+    const LodState& state = lodState_[lod];
+    return lods_[lod].resident() && !state.coarsest && state.lastDrawn + 1 < frame_;
+}
+
+void DrawScene::evictionCandidates(std::vector<core::MemoryItem>& out) const {
+    for (std::uint32_t lod = 0; lod < lods_.size(); ++lod) {
+        if (evictable(lod)) {
+            out.push_back({lodState_[lod].lastUse, geometryBytes(lodState_[lod].vertexCount, lods_[lod].indexCount)});
+        }
+    }
+}
+
+std::size_t DrawScene::evictOlderThan(std::uint64_t stamp) {
+    const std::size_t before = poolBytes_;
+    for (std::uint32_t lod = 0; lod < lods_.size(); ++lod) {
+        if (evictable(lod) && lodState_[lod].lastUse < stamp) {
+            evict(lod);
+        }
+    }
+    return before - poolBytes_;
+}
+
+void DrawScene::evict(std::uint32_t lod) {
+    GpuLod& l = lods_[lod];
+    const auto vertexCount = static_cast<std::uint32_t>(lodState_[lod].vertexCount);
+    vertexSpace_.release(static_cast<std::uint32_t>(l.baseVertex), vertexCount);
+    indexSpace_.release(l.firstIndex, l.indexCount);
+    poolBytes_ -= geometryBytes(vertexCount, l.indexCount);
+    l.flags &= ~GpuLod::kResident;
+    l.firstIndex = 0;
+    l.baseVertex = 0;
+    ++evicted_;
+    tablesDirty_ = true;
+}
+
+void DrawScene::evictOverBudget() {
+    if (poolBytes_ <= options_.geometryBudgetBytes) {
+        return;
+    }
+    // Levels drawn last frame are in use; the coarsest are the fallback.
+    std::vector<std::uint32_t> candidates;
+    for (std::uint32_t lod = 0; lod < lods_.size(); ++lod) {
+        if (evictable(lod)) {
+            candidates.push_back(lod);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [&](std::uint32_t a, std::uint32_t b) { return lodState_[a].lastDrawn < lodState_[b].lastDrawn; });
+    for (const std::uint32_t lod : candidates) {
+        if (poolBytes_ <= options_.geometryBudgetBytes) {
+            break;
+        }
+        evict(lod);
+    }
+}
+
+void DrawScene::markDirty(std::size_t first, std::size_t last) {
+    if (dirtyBegin_ == dirtyEnd_) {
+        dirtyBegin_ = first;
+        dirtyEnd_ = last;
+    } else {
+        dirtyBegin_ = std::min(dirtyBegin_, first);
+        dirtyEnd_ = std::max(dirtyEnd_, last);
+    }
+}
+
+void DrawScene::recordUpload(const GeometryUpload& upload) {
+    if (poolGrew_) {
+        uploads_.assign(1, {0, vertexEnd_, 0, indexEnd_});
+    } else {
+        uploads_.push_back(upload);
+    }
+}
+
+void DrawScene::markUploaded() {
+    dirtyBegin_ = dirtyEnd_ = 0;
+    uploads_.clear();
+    poolGrew_ = false;
+    tablesDirty_ = false;
+}
+
+DrawSceneStats DrawScene::stats() const {
+    DrawSceneStats s;
+    s.instances = instances_.size();
+    s.groups = groups_.size();
+    s.materials = materials_.size();
+    s.lods = lods_.size();
+    for (const GpuLod& lod : lods_) {
+        s.residentLods += lod.resident() ? 1 : 0;
+    }
+    s.pendingLods = pending_;
+    s.poolVertices = vertices_.size();
+    s.poolIndices = indices_.size();
+    s.poolBytes = poolBytes_;
+    s.streamedLods = streamed_;
+    s.evictedLods = evicted_;
+    s.failedLods = failed_;
+    return s;
+}
+
+} // namespace rebel::render
@@ -0,0 +1,551 @@
+#include "rebel/render/Picker.hpp"
+
+#include "rebel/core/TaskScheduler.hpp"
+#include "rebel/core/Trace.hpp"
+#include "rebel/math/Batch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace rebel::render {
+
+using math::Aabb;
+using math::Mat4f;
+using math::Vec3f;
+
+namespace {
+
+constexpr float kInfinity = std::numeric_limits<float>::infinity();
+/// Node footprints up to this many pixels are depth-tested pixel by pixel.
+constexpr int kDepthTestPixels = 64;
+
+struct Clip {
+    float x, y, z, w;
+};
+
+Clip toClip(const Mat4f& m, const Vec3f& p) {
+    const float* a = m.m;
+    return {a[0] * p.x + a[4] * p.y + a[8] * p.z + a[12], a[1] * p.x + a[5] * p.y + a[9] * p.z + a[13],
+            a[2] * p.x + a[6] * p.y + a[10] * p.z + a[14], a[3] * p.x + a[7] * p.y + a[11] * p.z + a[15]};
+}
+
+/// Pixel rectangle [x0, x1) x [y0, y1).
+struct Rect {
+    int x0 = 0;
+    int y0 = 0;
+    int x1 = 0;
+    int y1 = 0;
+
+    bool empty() const { return x0 >= x1 || y0 >= y1; }
+};
+
+/// Pixel coordinates and NDC depth.
+struct Vertex {
+    float x, y, z;
+};
+
+struct Viewport {
+    float width;
+    float height;
+
+    Vertex toScreen(const Clip& c) const {
+        const float iw = 1.0f / c.w;
+        return {(c.x * iw + 1.0f) * 0.5f * width, (1.0f - c.y * iw) * 0.5f * height, c.z * iw};
+    }
+};
+
+int clampPixel(float v, int lo, int hi) { return static_cast<int>(std::clamp(v, float(lo), float(hi))); }
+
+/// Pixels whose centers lie in [minX, maxX] x [minY, maxY], within `bounds`.
+Rect coveredPixels(float minX, float maxX, float minY, float maxY, const Rect& bounds) {
+    return {clampPixel(std::ceil(minX - 0.5f), bounds.x0, bounds.x1),
+            clampPixel(std::ceil(minY - 0.5f), bounds.y0, bounds.y1),
+            clampPixel(std::floor(maxX - 0.5f) + 1.0f, bounds.x0, bounds.x1),
+            clampPixel(std::floor(maxY - 0.5f) + 1.0f, bounds.y0, bounds.y1)};
+}
+
+/// Screen footprint of a box: the pixels of `bounds` its projection may
+/// cover and its nearest depth. Boxes reaching behind the near plane
+/// cover all of `bounds` at depth -1.
+struct Footprint {
+    Rect pixels;
+    float nearDepth = -1.0f;
+
+    bool visible() const { return !pixels.empty(); }
+};
+
+Footprint footprint(const Aabb& box, const Mat4f& toClipSpace, const Viewport& viewport, const Rect& bounds) {
+    int outside[6] = {};
+    bool behind = false;
+    float minX = kInfinity;
+    float maxX = -kInfinity;
+    float minY = kInfinity;
+    float maxY = -kInfinity;
+    float minZ = kInfinity;
+    // Corners as the min corner plus multiples of the matrix columns.
+    const float* a = toClipSpace.m;
+    const Vec3f e = box.max - box.min;
+    const Clip base = toClip(toClipSpace, box.min);
+    const Clip dx{a[0] * e.x, a[1] * e.x, a[2] * e.x, a[3] * e.x};
+    const Clip dy{a[4] * e.y, a[5] * e.y, a[6] * e.y, a[7] * e.y};
+    const Clip dz{a[8] * e.z, a[9] * e.z, a[10] * e.z, a[11] * e.z};
+    for (int corner = 0; corner < 8; ++corner) {
+        Clip c = base;
+        if (corner & 1) {
+            c = {c.x + dx.x, c.y + dx.y, c.z + dx.z, c.w + dx.w};
+        }
+        if (corner & 2) {
+            c = {c.x + dy.x, c.y + dy.y, c.z + dy.z, c.w + dy.w};
+        }
+        if (corner & 4) {
+            c = {c.x + dz.x, c.y + dz.y, c.z + dz.z, c.w + dz.w};
+        }
+        outside[0] += c.x < -c.w;
+        outside[1] += c.x > c.w;
+        outside[2] += c.y < -c.w;
+        outside[3] += c.y > c.w;
+        outside[4] += c.z < -c.w;
+        outside[5] += c.z > c.w;
+        if (c.z < -c.w || c.w <= 0.0f) {
+            behind = true;
+            continue;
+        }
+        const Vertex v = viewport.toScreen(c);
+        minX = std::min(minX, v.x);
+        maxX = std::max(maxX, v.x);
+        minY = std::min(minY, v.y);
+        maxY = std::max(maxY, v.y);
+        minZ = std::min(minZ, v.z);
+    }
+    Footprint f;
+    for (int plane = 0; plane < 6; ++plane) {
+        if (outside[plane] == 8) {
+            return f;
+        }
+    }
+    if (behind) {
+        f.pixels = bounds;
+        return f;
+    }
+    f.pixels = coveredPixels(minX, maxX, minY, maxY, bounds);
+    f.nearDepth = minZ;
+    return f;
+}
+
+/// One tile of the ID and depth buffers being drawn.
+struct TileTarget {
+    Rect tile;
+    int stride = 0;
+    PickId* ids = nullptr;
+    float* depth = nullptr;
+    bool wrote = false;
+
+    void triangle(Vertex a, Vertex b, Vertex c, const PickId& id) {
+        float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+        if (!(area != 0.0f)) {
+            return;
+        }
+        if (area < 0.0f) {
+            std::swap(b, c);
+            area = -area;
+        }
+        const Rect r = coveredPixels(std::min({a.x, b.x, c.x}), std::max({a.x, b.x, c.x}),
+                                     std::min({a.y, b.y, c.y}), std::max({a.y, b.y, c.y}), tile);
+        const float inverseArea = 1.0f / area;
+        for (int y = r.y0; y < r.y1; ++y) {
+            const float py = static_cast<float>(y) + 0.5f;
+            for (int x = r.x0; x < r.x1; ++x) {
+                const float px = static_cast<float>(x) + 0.5f;
+                const float wa = (c.x - b.x) * (py - b.y) - (c.y - b.y) * (px - b.x);
+                const float wb = (a.x - c.x) * (py - c.y) - (a.y - c.y) * (px - c.x);
+                const float wc = (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+                if (wa < 0.0f || wb < 0.0f || wc < 0.0f) {
+                    continue;
+                }
+                const float z = (wa * a.z + wb * b.z + wc * c.z) * inverseArea;
+                const std::size_t i = static_cast<std::size_t>(y) * stride + x;
+                if (z >= -1.0f && z <= 1.0f && z < depth[i]) {
+                    depth[i] = z;
+                    ids[i] = id;
+                    wrote = true;
+                }
+            }
+        }
+    }
+
+    /// Clips a triangle against the near plane (z >= -w) and draws it.
+    void clipped(const Clip (&c)[3], const Viewport& viewport, const PickId& id) {
+        Clip polygon[4];
+        int n = 0;
+        for (int i = 0; i < 3; ++i) {
+            const Clip& a = c[i];
+            const Clip& b = c[(i + 1) % 3];
+            const float da = a.z + a.w;
+            const float db = b.z + b.w;
+            if (da >= 0.0f) {
+                polygon[n++] = a;
+            }
+            if ((da >= 0.0f) != (db >= 0.0f)) {
+                const float s = da / (da - db);
+                polygon[n++] = {a.x + (b.x - a.x) * s, a.y + (b.y - a.y) * s, a.z + (b.z - a.z) * s,
+                                a.w + (b.w - a.w) * s};
+            }
+        }
+        for (int i = 0; i < n; ++i) {
+            if (!(polygon[i].w > 0.0f)) {
+                return;
+            }
+        }
+        for (int i = 2; i < n; ++i) {
+            triangle(viewport.toScreen(polygon[0]), viewport.toScreen(polygon[i - 1]),
+                     viewport.toScreen(polygon[i]), id);
+        }
+    }
+
+    /// Whether every pixel of `r` already shows something nearer than `z`.
+    bool occludes(const Rect& r, float z) const {
+        for (int y = r.y0; y < r.y1; ++y) {
+            const float* row = depth + static_cast<std::size_t>(y) * stride;
+            for (int x = r.x0; x < r.x1; ++x) {
+                if (row[x] >= z) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /// Farthest depth in `r`; infinity while any of its pixels is empty.
+    float farthest(const Rect& r) const {
+        float result = -kInfinity;
+        for (int y = r.y0; y < r.y1; ++y) {
+            for (int x = r.x0; x < r.x1; ++x) {
+                result = std::max(result, depth[static_cast<std::size_t>(y) * stride + x]);
+            }
+        }
+        return result;
+    }
+};
+
+struct InstanceView {
+    Mat4f toClip;
+    Footprint footprint;
+};
+
+float segmentDistance(float px, float py, const Vertex& a, const Vertex& b) {
+    const float dx = b.x - a.x;
+    const float dy = b.y - a.y;
+    const float len2 = dx * dx + dy * dy;
+    const float s = len2 > 0.0f ? std::clamp(((px - a.x) * dx + (py - a.y) * dy) / len2, 0.0f, 1.0f) : 0.0f;
+    return std::hypot(px - (a.x + s * dx), py - (a.y + s * dy));
+}
+
+} // namespace
+
+Picker::Picker(const spatial::TwoLevelBvh& bvh, const PickerOptions& options) : bvh_(bvh), options_(options) {
+    if (options_.tileSize == 0) {
+        throw std::invalid_argument("Picker: tile size must be positive");
+    }
+}
+
+bool Picker::update(const Camera& camera) {
+    if (valid_ && camera == camera_) {
+        return false;
+    }
+    camera_ = camera;
+    render();
+    valid_ = true;
+    return true;
+}
+
+void Picker::render() {
+    REBEL_TRACE_ZONE("render.pick_buffer");
+    const int width = static_cast<int>(camera_.width);
+    const int height = static_cast<int>(camera_.height);
+    const std::size_t pixelCount = static_cast<std::size_t>(width) * height;
+    ids_.assign(pixelCount, PickId{});
+    depth_.assign(pixelCount, kInfinity);
+    if (pixelCount == 0) {
+        return;
+    }
+    const Viewport viewport{static_cast<float>(width), static_cast<float>(height)};
+    const Rect screen{0, 0, width, height};
+
+    // Every instance's clip transform and screen box.
+    const std::size_t n = bvh_.instanceCount();
+    std::vector<InstanceView> views(n);
+    core::parallelFor(0, n, 1024, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            const auto instance = static_cast<spatial::InstanceId>(i);
+            views[i].toClip = camera_.viewProjection * bvh_.transform(instance);
+            views[i].footprint = footprint(bvh_.worldBounds(instance), camera_.viewProjection, viewport, screen);
+        }
+    });
+
+    // Bin visible instances into the tiles their screen boxes overlap.
+    const int size = static_cast<int>(options_.tileSize);
+    const int tilesX = (width + size - 1) / size;
+    const int tilesY = (height + size - 1) / size;
+    std::vector<std::uint32_t> offsets(static_cast<std::size_t>(tilesX) * tilesY + 1, 0);
+    const auto forTiles = [&](const Rect& r, auto&& fn) {
+        for (int ty = r.y0 / size; ty <= (r.y1 - 1) / size; ++ty) {
+            for (int tx = r.x0 / size; tx <= (r.x1 - 1) / size; ++tx) {
+                fn(static_cast<std::size_t>(ty) * tilesX + tx);
+            }
+        }
+    };
+    for (const InstanceView& v : views) {
+        if (v.footprint.visible()) {
+            forTiles(v.footprint.pixels, [&](std::size_t tile) { ++offsets[tile + 1]; });
+        }
+    }
+    for (std::size_t t = 1; t < offsets.size(); ++t) {
+        offsets[t] += offsets[t - 1];
+    }
+    std::vector<std::uint32_t> binned(offsets.back());
+    std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (std::uint32_t i = 0; i < n; ++i) {
+        if (views[i].footprint.visible()) {
+            forTiles(views[i].footprint.pixels, [&](std::size_t tile) { binned[fill[tile]++] = i; });
+        }
+    }
+
+    core::parallelFor(0, offsets.size() - 1, 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t t = first; t < last; ++t) {
+            const int tx = static_cast<int>(t % tilesX);
+            const int ty = static_cast<int>(t / tilesX);
+            TileTarget target;
+            target.tile = {tx * size, ty * size, std::min(width, (tx + 1) * size), std::min(height, (ty + 1) * size)};
+            target.stride = width;
+            target.ids = ids_.data();
+            target.depth = depth_.data();
+
+            // Nearest first, so farther instances mostly fail the depth test
+            // at their top node.
+            std::uint32_t* begin = binned.data() + offsets[t];
+            std::uint32_t* end = binned.data() + offsets[t + 1];
+            std::sort(begin, end, [&](std::uint32_t a, std::uint32_t b) {
+                const float da = views[a].footprint.nearDepth;
+                const float db = views[b].footprint.nearDepth;
+                return da != db ? da < db : a < b;
+            });
+            float far = kInfinity;
+            for (const std::uint32_t* it = begin; it != end; ++it) {
+                const InstanceView& view = views[*it];
+                if (view.footprint.nearDepth > far) {
+                    continue;
+                }
+                const spatial::MeshBvh& mesh = *bvh_.mesh(*it);
+                const math::batch::TriangleBatch& tris = mesh.triangles();
+                const spatial::BvhView& tree = mesh.bvh();
+                if (tree.empty()) {
+                    continue;
+                }
+                // Small footprints are also tested against the depth under
+                // them, which culls the far side of every part.
+                const auto hidden = [&](const Footprint& f) {
+                    if (f.nearDepth > far) {
+                        return true;
+                    }
+                    const Rect& r = f.pixels;
+                    return (r.x1 - r.x0) * (r.y1 - r.y0) <= kDepthTestPixels && target.occludes(r, f.nearDepth);
+                };
+                // Front-to-back descent: the nearer child is popped first.
+                struct Entry {
+                    std::uint32_t node;
+                    Footprint footprint;
+                };
+                Entry stack[spatial::BvhView::kMaxDepth + 1];
+                int top = 0;
+                const Footprint root = footprint(tree.nodes[0].bounds, view.toClip, viewport, target.tile);
+                if (root.visible()) {
+                    stack[top++] = {0, root};
+                }
+                target.wrote = false;
+                while (top > 0) {
+                    const Entry entry = stack[--top];
+                    if (hidden(entry.footprint)) {
+                        continue;
+                    }
+                    const spatial::BvhNode& node = tree.nodes[entry.node];
+                    if (node.isLeaf()) {
+                        for (std::uint32_t k = node.first; k < node.first + node.count; ++k) {
+                            const Vec3f p0{tris.v0x[k], tris.v0y[k], tris.v0z[k]};
+                            const Vec3f p1 = p0 + Vec3f{tris.e1x[k], tris.e1y[k], tris.e1z[k]};
+                            const Vec3f p2 = p0 + Vec3f{tris.e2x[k], tris.e2y[k], tris.e2z[k]};
+                            const Clip c[3] = {toClip(view.toClip, p0), toClip(view.toClip, p1),
+                                               toClip(view.toClip, p2)};
+                            target.clipped(c, viewport, {*it, tree.primitives[k]});
+                        }
+                        continue;
+                    }
+                    Entry near{node.first, footprint(tree.nodes[node.first].bounds, view.toClip, viewport,
+                                                     entry.footprint.pixels)};
+                    Entry farther{node.first + 1, footprint(tree.nodes[node.first + 1].bounds, view.toClip,
+                                                            viewport, entry.footprint.pixels)};
+                    if (farther.footprint.nearDepth < near.footprint.nearDepth) {
+                        std::swap(near, farther);
+                    }
+                    if (farther.footprint.visible()) {
+                        stack[top++] = farther;
+                    }
+                    if (near.footprint.visible()) {
+                        stack[top++] = near;
+                    }
+                }
+                if (target.wrote) {
+                    far = target.farthest(target.tile);
+                }
+            }
+        }
+    });
+}
+
+PickId Picker::at(std::uint32_t x, std::uint32_t y) const {
+    if (x >= camera_.width || y >= camera_.height || ids_.empty()) {
+        return {};
+    }
+    return ids_[static_cast<std::size_t>(y) * camera_.width + x];
+}
+
+float Picker::depth(std::uint32_t x, std::uint32_t y) const {
+    if (x >= camera_.width || y >= camera_.height || depth_.empty()) {
+        return kInfinity;
+    }
+    return depth_[static_cast<std::size_t>(y) * camera_.width + x];
+}
+
+std::vector<PickId> Picker::selectTriangles(std::uint32_t x0, std::uint32_t y0, std::uint32_t x1,
+                                            std::uint32_t y1) const {
+    std::vector<PickId> result;
+    if (ids_.empty()) {
+        return result;
+    }
+    x1 = std::min(x1, camera_.width);
+    y1 = std::min(y1, camera_.height);
+    for (std::uint32_t y = y0; y < y1; ++y) {
+        for (std::uint32_t x = x0; x < x1; ++x) {
+            const PickId& id = ids_[static_cast<std::size_t>(y) * camera_.width + x];
+            if (id.hit() && (result.empty() || !(result.back() == id))) {
+                result.push_back(id);
+            }
+        }
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+std::vector<spatial::InstanceId> Picker::selectInstances(std::uint32_t x0, std::uint32_t y0, std::uint32_t x1,
+                                                         std::uint32_t y1) const {
+    std::vector<spatial::InstanceId> result;
+    if (ids_.empty()) {
+        return result;
+    }
+    x1 = std::min(x1, camera_.width);
+    y1 = std::min(y1, camera_.height);
+    for (std::uint32_t y = y0; y < y1; ++y) {
+        for (std::uint32_t x = x0; x < x1; ++x) {
+            const PickId& id = ids_[static_cast<std::size_t>(y) * camera_.width + x];
+            if (id.hit() && (result.empty() || result.back() != id.instance)) {
+                result.push_back(id.instance);
+            }
+        }
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+PickHit Picker::pick(float x, float y) const {
+    if (camera_.width == 0 || camera_.height == 0 || bvh_.instanceCount() == 0) {
+        return {};
+    }
+    math::Ray ray = camera_.ray(x, y);
+    PickHit hit;
+    // The instance the buffer shows gives a tight bound first, so the
+    // confirming ray through the hierarchy prunes almost everything.
+    if (valid_ && x >= 0.0f && y >= 0.0f) {
+        const PickId under = at(static_cast<std::uint32_t>(x), static_cast<std::uint32_t>(y));
+        if (under.hit()) {
+            hit = pickInstance(under.instance, ray, x, y);
+            if (hit.hit()) {
+                ray.tMax = hit.t;
+            }
+        }
+    }
+    const spatial::InstanceHit closer = bvh_.raycast(ray);
+    if (closer.hit() && (!hit.hit() || closer.t < hit.t)) {
+        hit = pickInstance(closer.instance, camera_.ray(x, y), x, y);
+    }
+    return hit;
+}
+
+PickHit Picker::pickInstance(spatial::InstanceId instance, const math::Ray& ray, float x, float y) const {
+    const Mat4f& inverse = bvh_.inverseTransform(instance);
+    math::Ray local = ray;
+    local.origin = inverse.transformPoint(ray.origin);
+    local.direction = inverse.transformVector(ray.direction);
+
+    const spatial::MeshBvh& mesh = *bvh_.mesh(instance);
+    constexpr std::uint32_t kLocalScratch = 64;
+    float localScratch[kLocalScratch];
+    std::vector<float> heapScratch;
+    std::uint32_t best = geometry::kInvalidIndex;
+    float bestT = kInfinity;
+    mesh.bvh().raycastLeaves(local, [&](const spatial::BvhNode& leaf, math::Ray& r) {
+        float* scratch = localScratch;
+        if (leaf.count > kLocalScratch) {
+            heapScratch.resize(leaf.count);
+            scratch = heapScratch.data();
+        }
+        float t = 0.0f;
+        const std::size_t k = math::batch::closestRayTriangle(r, mesh.leafBatch(leaf), scratch, &t);
+        if (k < leaf.count && t < bestT) {
+            bestT = t;
+            best = leaf.first + static_cast<std::uint32_t>(k);
+            r.tMax = t;
+        }
+    });
+
+    PickHit hit;
+    if (best == geometry::kInvalidIndex) {
+        return hit;
+    }
+    hit.instance = instance;
+    hit.triangle = mesh.bvh().primitives[best];
+    hit.t = bestT;
+    hit.point = ray.at(bestT);
+
+    const math::batch::TriangleBatch& tris = mesh.triangles();
+    const Vec3f p0{tris.v0x[best], tris.v0y[best], tris.v0z[best]};
+    const Vec3f corners[3] = {p0, p0 + Vec3f{tris.e1x[best], tris.e1y[best], tris.e1z[best]},
+                              p0 + Vec3f{tris.e2x[best], tris.e2y[best], tris.e2z[best]}};
+    const Mat4f toClipSpace = camera_.viewProjection * bvh_.transform(instance);
+    const Viewport viewport{static_cast<float>(camera_.width), static_cast<float>(camera_.height)};
+    Vertex screen[3];
+    bool inFront[3];
+    for (int k = 0; k < 3; ++k) {
+        const Clip c = toClip(toClipSpace, corners[k]);
+        inFront[k] = c.w > 0.0f && c.z >= -c.w;
+        if (inFront[k]) {
+            screen[k] = viewport.toScreen(c);
+        }
+    }
+    for (std::uint8_t k = 0; k < 3; ++k) {
+        const int next = (k + 1) % 3;
+        if (!inFront[k] || !inFront[next]) {
+            continue;
+        }
+        const float d = segmentDistance(x, y, screen[k], screen[next]);
+        if (d < hit.edgeDistance) {
+            hit.edgeDistance = d;
+            hit.edge = k;
+        }
+    }
+    return hit;
+}
+
+} // namespace rebel::render
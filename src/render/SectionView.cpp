@@ -0,0 +1,824 @@
+#include "rebel/render/SectionView.hpp"
+
+#include "rebel/core/TaskScheduler.hpp"
+#include "rebel/core/Trace.hpp"
+#include "rebel/math/Batch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace rebel::render {
+namespace {
+
+using math::Vec2d;
+using math::Vec3d;
+
+constexpr std::uint32_t kNone = 0xFFFFFFFFu;
+
+/// Box and batched triangle tests are padded by this much, relative to the
+/// magnitudes involved, against rounding in float boxes and triangles
+/// rebuilt from edges; the exact test on mesh vertices decides.
+constexpr double kPad = 1e-6;
+
+Vec3d toDouble(const math::Vec3f& v) { return {v.x, v.y, v.z}; }
+math::Vec3f toFloat(const Vec3d& v) { return {float(v.x), float(v.y), float(v.z)}; }
+
+/// Range of a plane's distance over a box, and its padding.
+struct Range {
+    double lo;
+    double hi;
+    double pad;
+
+    bool crosses() const { return lo <= pad && hi >= -pad; }
+    /// Entirely on the cut-away side.
+    bool removed() const { return lo > pad; }
+    bool kept() const { return hi < -pad; }
+};
+
+Range range(const SectionPlane& plane, const Vec3d& min, const Vec3d& max) {
+    const Vec3d c = (min + max) * 0.5;
+    const Vec3d e = (max - min) * 0.5;
+    const double d = plane.distance(c);
+    const double r =
+        std::abs(plane.normal.x) * e.x + std::abs(plane.normal.y) * e.y + std::abs(plane.normal.z) * e.z;
+    return {d - r, d + r, kPad * (std::abs(d) + r + std::abs(plane.offset))};
+}
+
+Range range(const SectionPlane& plane, const math::Aabb& box) {
+    return range(plane, toDouble(box.min), toDouble(box.max));
+}
+
+/// Affine transform in double precision, columns x, y, z and translation.
+struct Affine {
+    double m[12];
+
+    explicit Affine(const math::Mat4f& t) {
+        for (int c = 0; c < 4; ++c) {
+            for (int r = 0; r < 3; ++r) {
+                m[c * 3 + r] = t.m[c * 4 + r];
+            }
+        }
+    }
+
+    Vec3d apply(const Vec3d& p) const {
+        return {m[0] * p.x + m[3] * p.y + m[6] * p.z + m[9], m[1] * p.x + m[4] * p.y + m[7] * p.z + m[10],
+                m[2] * p.x + m[5] * p.y + m[8] * p.z + m[11]};
+    }
+
+    /// The plane in the transform's source space; distances are the same
+    /// but for the normal no longer being unit length.
+    SectionPlane pullBack(const SectionPlane& plane) const {
+        const Vec3d& n = plane.normal;
+        return {{n.x * m[0] + n.y * m[1] + n.z * m[2], n.x * m[3] + n.y * m[4] + n.z * m[5],
+                 n.x * m[6] + n.y * m[7] + n.z * m[8]},
+                plane.offset - (n.x * m[9] + n.y * m[10] + n.z * m[11])};
+    }
+};
+
+/// Slice of one triangle: the two mesh edges it crosses, smaller vertex
+/// first, and the points there.
+struct Segment {
+    std::uint64_t edge[2];
+    Vec3d point[2];
+};
+
+std::uint64_t edgeKey(geometry::VertexIndex a, geometry::VertexIndex b) {
+    return a < b ? (std::uint64_t(a) << 32) | b : (std::uint64_t(b) << 32) | a;
+}
+
+/// Vertices at or beyond the plane count as cut away, so no vertex lies on
+/// it and every crossing is inside an edge. Crossings are computed from the
+/// smaller vertex on, so both triangles sharing an edge get the same point.
+bool sliceTriangle(const geometry::MeshView& mesh, const SectionPlane& plane, std::uint32_t triangle,
+                   std::vector<Segment>& out) {
+    const geometry::VertexIndex* v = mesh.corners + std::size_t(triangle) * 3;
+    bool side[3];
+    for (int k = 0; k < 3; ++k) {
+        side[k] = plane.distance(toDouble(mesh.position(v[k]))) >= 0.0;
+    }
+    if (side[0] == side[1] && side[1] == side[2]) {
+        return false;
+    }
+    Segment s;
+    int found = 0;
+    for (int k = 0; k < 3; ++k) {
+        geometry::VertexIndex a = v[k];
+        geometry::VertexIndex b = v[(k + 1) % 3];
+        if (side[k] == side[(k + 1) % 3]) {
+            continue;
+        }
+        if (b < a) {
+            std::swap(a, b);
+        }
+        const Vec3d pa = toDouble(mesh.position(a));
+        const Vec3d pb = toDouble(mesh.position(b));
+        const double da = plane.distance(pa);
+        const double db = plane.distance(pb);
+        s.edge[found] = edgeKey(a, b);
+        s.point[found] = pa + (pb - pa) * (da / (da - db));
+        ++found;
+    }
+    out.push_back(s);
+    return true;
+}
+
+// ---- Caps --------------------------------------------------------------
+
+double orient(const Vec2d& a, const Vec2d& b, const Vec2d& c) {
+    return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+/// Closed test against a counter-clockwise triangle.
+bool insideTriangle(const Vec2d& a, const Vec2d& b, const Vec2d& c, const Vec2d& p) {
+    return orient(a, b, p) >= 0.0 && orient(b, c, p) >= 0.0 && orient(c, a, p) >= 0.0;
+}
+
+bool insidePolygon(const std::vector<Vec2d>& points, const std::vector<std::uint32_t>& loop, const Vec2d& p) {
+    bool inside = false;
+    for (std::size_t i = 0, j = loop.size() - 1; i < loop.size(); j = i++) {
+        const Vec2d& a = points[loop[i]];
+        const Vec2d& b = points[loop[j]];
+        if ((a.y > p.y) != (b.y > p.y) && p.x < a.x + (p.y - a.y) * (b.x - a.x) / (b.y - a.y)) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+double signedArea(const std::vector<Vec2d>& points, const std::vector<std::uint32_t>& loop) {
+    double area = 0.0;
+    for (std::size_t i = 0, j = loop.size() - 1; i < loop.size(); j = i++) {
+        area += points[loop[j]].x * points[loop[i]].y - points[loop[i]].x * points[loop[j]].y;
+    }
+    return 0.5 * area;
+}
+
+/// Joins `hole` (clockwise) into `polygon` (counter-clockwise) through a
+/// pair of coincident edges from the hole's rightmost vertex to a polygon
+/// vertex it sees (Eberly, "Triangulation by Ear Clipping").
+void bridge(const std::vector<Vec2d>& points, std::vector<std::uint32_t>& polygon,
+            const std::vector<std::uint32_t>& hole) {
+    std::size_t m = 0;
+    for (std::size_t i = 1; i < hole.size(); ++i) {
+        if (points[hole[i]].x > points[hole[m]].x) {
+            m = i;
+        }
+    }
+    const Vec2d h = points[hole[m]];
+    const std::size_t n = polygon.size();
+
+    // Nearest polygon edge hit by the ray from h along +x.
+    double hitX = std::numeric_limits<double>::infinity();
+    std::size_t edge = n;
+    for (std::size_t i = 0; i < n; ++i) {
+        const Vec2d& a = points[polygon[i]];
+        const Vec2d& b = points[polygon[(i + 1) % n]];
+        if ((a.y > h.y) == (b.y > h.y)) {
+            continue;
+        }
+        const double x = a.x + (h.y - a.y) * (b.x - a.x) / (b.y - a.y);
+        if (x >= h.x && x < hitX) {
+            hitX = x;
+            edge = i;
+        }
+    }
+
+    std::size_t p = 0;
+    if (edge == n) {
+        // Only for a hole not inside the polygon after all: nearest vertex.
+        double best = std::numeric_limits<double>::infinity();
+        for (std::size_t i = 0; i < n; ++i) {
+            const Vec2d d = points[polygon[i]] - h;
+            if (d.x * d.x + d.y * d.y < best) {
+                best = d.x * d.x + d.y * d.y;
+                p = i;
+            }
+        }
+    } else {
+        const std::size_t next = (edge + 1) % n;
+        p = points[polygon[edge]].x > points[polygon[next]].x ? edge : next;
+        const Vec2d hit{hitX, h.y};
+        const Vec2d candidate = points[polygon[p]];
+        if (candidate != hit) {
+            // Reflex vertices inside (h, hit, candidate) would block the
+            // view; the one with the least angle to the ray is visible.
+            const bool ccw = orient(h, hit, candidate) > 0.0;
+            const Vec2d& t1 = ccw ? hit : candidate;
+            const Vec2d& t2 = ccw ? candidate : hit;
+            double bestTan = std::numeric_limits<double>::infinity();
+            double bestDistance = std::numeric_limits<double>::infinity();
+            for (std::size_t i = 0; i < n; ++i) {
+                const Vec2d& q = points[polygon[i]];
+                if (i == p || q.x <= h.x || !insideTriangle(h, t1, t2, q) ||
+                    orient(points[polygon[(i + n - 1) % n]], q, points[polygon[(i + 1) % n]]) >= 0.0) {
+                    continue;
+                }
+                const double tan = std::abs(q.y - h.y) / (q.x - h.x);
+                const double distance = q.x - h.x;
+                if (tan < bestTan || (tan == bestTan && distance < bestDistance)) {
+                    bestTan = tan;
+                    bestDistance = distance;
+                    p = i;
+                }
+            }
+        }
+    }
+
+    std::vector<std::uint32_t> merged;
+    merged.reserve(n + hole.size() + 2);
+    merged.insert(merged.end(), polygon.begin(), polygon.begin() + std::ptrdiff_t(p) + 1);
+    for (std::size_t i = 0; i <= hole.size(); ++i) {
+        merged.push_back(hole[(m + i) % hole.size()]);
+    }
+    merged.insert(merged.end(), polygon.begin() + std::ptrdiff_t(p), polygon.end());
+    polygon = std::move(merged);
+}
+
+/// Ear clipping of a counter-clockwise, weakly simple polygon. Only reflex
+/// vertices can lie inside an ear, so only they are tested, which keeps
+/// mostly convex sections close to linear. Triangles go to `out` as point
+/// indices.
+void earClip(const std::vector<Vec2d>& points, const std::vector<std::uint32_t>& polygon,
+             std::vector<std::uint32_t>& out) {
+    const std::size_t n = polygon.size();
+    if (n < 3) {
+        return;
+    }
+    std::vector<std::uint32_t> prev(n);
+    std::vector<std::uint32_t> next(n);
+    std::vector<double> turn(n);
+    std::vector<std::uint8_t> alive(n, 1);
+    auto at = [&](std::uint32_t i) -> const Vec2d& { return points[polygon[i]]; };
+    auto updateTurn = [&](std::uint32_t i) { turn[i] = orient(at(prev[i]), at(i), at(next[i])); };
+    for (std::uint32_t i = 0; i < n; ++i) {
+        prev[i] = std::uint32_t((i + n - 1) % n);
+        next[i] = std::uint32_t((i + 1) % n);
+    }
+    std::vector<std::uint32_t> reflex;
+    for (std::uint32_t i = 0; i < n; ++i) {
+        updateTurn(i);
+        if (turn[i] <= 0.0) {
+            reflex.push_back(i);
+        }
+    }
+
+    auto isEar = [&](std::uint32_t i) {
+        if (turn[i] <= 0.0) {
+            return false;
+        }
+        const Vec2d& a = at(prev[i]);
+        const Vec2d& b = at(i);
+        const Vec2d& c = at(next[i]);
+        const Vec2d lo{std::min({a.x, b.x, c.x}), std::min({a.y, b.y, c.y})};
+        const Vec2d hi{std::max({a.x, b.x, c.x}), std::max({a.y, b.y, c.y})};
+        bool ear = true;
+        std::size_t kept = 0;
+        for (const std::uint32_t r : reflex) {
+            // Ear clipping never turns a convex vertex reflex, so dropping
+            // the ones that became convex is for good.
+            if (alive[r] == 0 || turn[r] > 0.0) {
+                continue;
+            }
+            reflex[kept++] = r;
+            if (!ear || r == prev[i] || r == next[i]) {
+                continue;
+            }
+            const Vec2d& q = at(r);
+            if (q.x < lo.x || q.x > hi.x || q.y < lo.y || q.y > hi.y || q == a || q == b || q == c) {
+                continue;
+            }
+            ear = !insideTriangle(a, b, c, q);
+        }
+        reflex.resize(kept);
+        return ear;
+    };
+
+    std::size_t remaining = n;
+    std::uint32_t i = 0;
+    std::size_t stalled = 0;
+    while (remaining > 3) {
+        // Collinear vertices go without a triangle; a polygon with no ear
+        // left (only if it self-intersects) loses a vertex anyway.
+        if (turn[i] == 0.0 || isEar(i) || stalled > remaining) {
+            const std::uint32_t a = prev[i];
+            const std::uint32_t c = next[i];
+            if (turn[i] > 0.0) {
+                out.insert(out.end(), {polygon[a], polygon[i], polygon[c]});
+            }
+            alive[i] = 0;
+            next[a] = c;
+            prev[c] = a;
+            --remaining;
+            for (const std::uint32_t k : {a, c}) {
+                const bool wasReflex = turn[k] <= 0.0;
+                updateTurn(k);
+                if (!wasReflex && turn[k] <= 0.0) {
+                    reflex.push_back(k);
+                }
+            }
+            i = c;
+            stalled = 0;
+            continue;
+        }
+        i = next[i];
+        ++stalled;
+    }
+    if (orient(at(prev[i]), at(i), at(next[i])) > 0.0) {
+        out.insert(out.end(), {polygon[prev[i]], polygon[i], polygon[next[i]]});
+    }
+}
+
+/// Triangulates the closed `loops` of a cut on `plane` into `cap`. Loops
+/// nest by containment: those inside an even number of others are outer
+/// boundaries, the rest holes of the smallest loop around them.
+void capLoops(const std::vector<std::vector<Vec3d>>& loops, const SectionPlane& plane, std::vector<Vec3d>& cap) {
+    const Vec3d& n = plane.normal;
+    const Vec3d axis = std::abs(n.x) <= std::abs(n.y) && std::abs(n.x) <= std::abs(n.z) ? Vec3d{1.0, 0.0, 0.0}
+                       : std::abs(n.y) <= std::abs(n.z)                                 ? Vec3d{0.0, 1.0, 0.0}
+                                                                                        : Vec3d{0.0, 0.0, 1.0};
+    const Vec3d u = math::normalize(math::cross(n, axis));
+    const Vec3d v = math::cross(n, u);
+
+    std::vector<Vec3d> points3;
+    std::vector<Vec2d> points;
+    std::vector<std::vector<std::uint32_t>> rings;
+    for (const std::vector<Vec3d>& loop : loops) {
+        std::vector<std::uint32_t> ring;
+        for (std::size_t i = 0; i < loop.size(); ++i) {
+            // Crossings next to a vertex on the plane coincide.
+            if (loop[i] == loop[(i + 1) % loop.size()]) {
+                continue;
+            }
+            ring.push_back(std::uint32_t(points.size()));
+            points3.push_back(loop[i]);
+            points.push_back({math::dot(u, loop[i]), math::dot(v, loop[i])});
+        }
+        if (ring.size() >= 3) {
+            rings.push_back(std::move(ring));
+        }
+    }
+
+    struct Info {
+        double area;
+        Vec2d min;
+        Vec2d max;
+        std::uint32_t depth = 0;
+        std::uint32_t parent = kNone;
+    };
+    std::vector<Info> info(rings.size());
+    for (std::size_t i = 0; i < rings.size(); ++i) {
+        Info& r = info[i];
+        r.area = signedArea(points, rings[i]);
+        r.min = r.max = points[rings[i][0]];
+        for (const std::uint32_t k : rings[i]) {
+            r.min = {std::min(r.min.x, points[k].x), std::min(r.min.y, points[k].y)};
+            r.max = {std::max(r.max.x, points[k].x), std::max(r.max.y, points[k].y)};
+        }
+    }
+    for (std::size_t i = 0; i < rings.size(); ++i) {
+        Info& inner = info[i];
+        const Vec2d& p = points[rings[i][0]];
+        for (std::size_t j = 0; j < rings.size(); ++j) {
+            const Info& outer = info[j];
+            if (j == i || std::abs(outer.area) <= std::abs(inner.area) || outer.min.x > inner.min.x ||
+                outer.min.y > inner.min.y || outer.max.x < inner.max.x || outer.max.y < inner.max.y ||
+                !insidePolygon(points, rings[j], p)) {
+                continue;
+            }
+            ++inner.depth;
+            if (inner.parent == kNone || std::abs(outer.area) < std::abs(info[inner.parent].area)) {
+                inner.parent = std::uint32_t(j);
+            }
+        }
+    }
+
+    std::vector<std::vector<std::uint32_t>> holes(rings.size());
+    for (std::size_t i = 0; i < rings.size(); ++i) {
+        if (info[i].depth % 2 == 1 && info[i].area != 0.0) {
+            if (info[i].area > 0.0) {
+                std::reverse(rings[i].begin(), rings[i].end());
+            }
+            holes[info[i].parent].push_back(std::uint32_t(i));
+        }
+    }
+    std::vector<std::uint32_t> triangles;
+    for (std::size_t i = 0; i < rings.size(); ++i) {
+        if (info[i].depth % 2 == 1 || info[i].area == 0.0) {
+            continue;
+        }
+        std::vector<std::uint32_t> polygon = std::move(rings[i]);
+        if (info[i].area < 0.0) {
+            std::reverse(polygon.begin(), polygon.end());
+        }
+        std::sort(holes[i].begin(), holes[i].end(),
+                  [&](std::uint32_t a, std::uint32_t b) { return info[a].max.x > info[b].max.x; });
+        for (const std::uint32_t hole : holes[i]) {
+            bridge(points, polygon, rings[hole]);
+        }
+        triangles.clear();
+        earClip(points, polygon, triangles);
+        for (const std::uint32_t k : triangles) {
+            cap.push_back(points3[k]);
+        }
+    }
+}
+
+/// Sutherland-Hodgman step: the part of convex polygon `in` on the kept
+/// side of `plane`.
+void clipPolygon(const SectionPlane& plane, const std::vector<Vec3d>& in, std::vector<Vec3d>& out) {
+    out.clear();
+    for (std::size_t i = 0; i < in.size(); ++i) {
+        const Vec3d& a = in[i];
+        const Vec3d& b = in[(i + 1) % in.size()];
+        const double da = plane.distance(a);
+        const double db = plane.distance(b);
+        if (da <= 0.0) {
+            out.push_back(a);
+        }
+        if ((da <= 0.0) != (db <= 0.0)) {
+            out.push_back(a + (b - a) * (da / (da - db)));
+        }
+    }
+}
+
+} // namespace
+
+SectionView::SectionView(const assembly::AssemblyIndex& index) : index_(index) {}
+
+void SectionView::setPlane(const SectionPlane& plane) { setPlanes({plane}); }
+
+void SectionView::setBox(const math::Aabb& box) {
+    if (box.empty()) {
+        throw std::invalid_argument("section box is empty");
+    }
+    setPlanes({{{-1.0, 0.0, 0.0}, -double(box.min.x)},
+               {{1.0, 0.0, 0.0}, double(box.max.x)},
+               {{0.0, -1.0, 0.0}, -double(box.min.y)},
+               {{0.0, 1.0, 0.0}, double(box.max.y)},
+               {{0.0, 0.0, -1.0}, -double(box.min.z)},
+               {{0.0, 0.0, 1.0}, double(box.max.z)}});
+}
+
+void SectionView::setPlanes(std::vector<SectionPlane> planes) {
+    for (SectionPlane& plane : planes) {
+        const double length = math::length(plane.normal);
+        if (!(length > 0.0)) {
+            throw std::invalid_argument("section plane normal is zero");
+        }
+        plane.normal = plane.normal / length;
+        plane.offset /= length;
+    }
+    planes_ = std::move(planes);
+}
+
+SectionSide SectionView::side(spatial::InstanceId instance) const {
+    const math::Aabb& box = index_.bvh().worldBounds(instance);
+    bool kept = true;
+    for (const SectionPlane& plane : planes_) {
+        const Range r = range(plane, box);
+        if (r.removed()) {
+            return SectionSide::Removed;
+        }
+        kept = kept && r.kept();
+    }
+    return kept ? SectionSide::Kept : SectionSide::Cut;
+}
+
+const SectionCut* SectionView::cut(spatial::InstanceId instance, std::uint32_t plane) const {
+    const auto it = entries_.find(key(instance, plane));
+    return it == entries_.end() ? nullptr : &it->second.cut;
+}
+
+void SectionView::erase(std::uint64_t k) {
+    const auto it = entries_.find(k);
+    if (it != entries_.end()) {
+        changed_.push_back({it->second.cut.instance, it->second.cut.plane});
+        entries_.erase(it);
+    }
+}
+
+SectionView::Slice SectionView::slice(spatial::InstanceId instance, std::uint32_t plane,
+                                      SectionStats& stats) const {
+    const assembly::Part& part = index_.definition(instance);
+    const geometry::MeshView& mesh = part.mesh();
+    const spatial::MeshBvh& bvh = part.bvh();
+    const Affine world(index_.bvh().transform(instance));
+    const SectionPlane local = world.pullBack(planes_[plane]);
+
+    // Triangle ranges come from float corners rebuilt from edges.
+    const math::Vec3f normal = toFloat(local.normal);
+    const auto offset = float(local.offset);
+    const math::Aabb bounds = bvh.bounds();
+    const Vec3d reach = {std::max(std::abs(bounds.min.x), std::abs(bounds.max.x)),
+                         std::max(std::abs(bounds.min.y), std::abs(bounds.max.y)),
+                         std::max(std::abs(bounds.min.z), std::abs(bounds.max.z))};
+    const double pad = 4.0 * kPad * (math::length(local.normal) * math::length(reach) + std::abs(local.offset));
+    std::vector<float> lo;
+    std::vector<float> hi;
+    std::vector<Segment> segments;
+    bvh.bvh().traverse(
+        [&](const spatial::BvhNode& node) {
+            if (!range(local, node.bounds).crosses()) {
+                return false;
+            }
+            if (!node.isLeaf()) {
+                return true;
+            }
+            const math::batch::TriangleBatch batch = bvh.leafBatch(node);
+            lo.resize(batch.count);
+            hi.resize(batch.count);
+            math::batch::trianglePlaneRanges(normal, offset, batch, lo.data(), hi.data());
+            stats.trianglesTested += batch.count;
+            for (std::size_t i = 0; i < batch.count; ++i) {
+                if (lo[i] <= pad && hi[i] >= -pad &&
+                    sliceTriangle(mesh, local, bvh.bvh().primitives[node.first + i], segments)) {
+                    ++stats.trianglesSliced;
+                }
+            }
+            return false;
+        },
+        [](std::uint32_t) { return true; });
+
+    Slice result;
+    if (segments.empty()) {
+        return result;
+    }
+    std::vector<Vec3d> points(segments.size() * 2);
+    result.edges.reserve(points.size());
+    result.min = result.max = world.apply(segments[0].point[0]);
+    for (std::size_t s = 0; s < segments.size(); ++s) {
+        for (int e = 0; e < 2; ++e) {
+            const Vec3d p = world.apply(segments[s].point[e]);
+            points[s * 2 + e] = p;
+            result.edges.push_back(p);
+            result.min = {std::min(result.min.x, p.x), std::min(result.min.y, p.y), std::min(result.min.z, p.z)};
+            result.max = {std::max(result.max.x, p.x), std::max(result.max.y, p.y), std::max(result.max.z, p.z)};
+        }
+    }
+
+    // Segment ends meet across the mesh edge they share.
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> ends(points.size());
+    for (std::size_t s = 0; s < segments.size(); ++s) {
+        ends[s * 2] = {segments[s].edge[0], std::uint32_t(s * 2)};
+        ends[s * 2 + 1] = {segments[s].edge[1], std::uint32_t(s * 2 + 1)};
+    }
+    std::sort(ends.begin(), ends.end());
+    std::vector<std::uint32_t> partner(points.size(), kNone);
+    for (std::size_t i = 0; i + 1 < ends.size(); ++i) {
+        if (ends[i].first == ends[i + 1].first) {
+            partner[ends[i].second] = ends[i + 1].second;
+            partner[ends[i + 1].second] = ends[i].second;
+            ++i;
+        }
+    }
+
+    // Chains with a free end first, then the closed loops.
+    std::vector<std::uint8_t> visited(segments.size(), 0);
+    std::vector<std::vector<Vec3d>> loops;
+    std::vector<Vec3d> loop;
+    auto walk = [&](std::uint32_t end) {
+        loop.clear();
+        while (true) {
+            visited[end / 2] = 1;
+            loop.push_back(points[end]);
+            const std::uint32_t next = partner[end ^ 1u];
+            if (next == kNone) {
+                return false;
+            }
+            if (visited[next / 2] != 0) {
+                return true;
+            }
+            end = next;
+        }
+    };
+    for (std::uint32_t end = 0; end < points.size(); ++end) {
+        if (partner[end] == kNone && visited[end / 2] == 0) {
+            walk(end);
+            ++result.openChains;
+        }
+    }
+    for (std::uint32_t s = 0; s < segments.size(); ++s) {
+        if (visited[s] == 0 && walk(s * 2)) {
+            loops.push_back(loop);
+        }
+    }
+    capLoops(loops, planes_[plane], result.cap);
+    return result;
+}
+
+void SectionView::trim(Entry& entry) const {
+    const Slice& slice = entry.slice;
+    SectionCut& cut = entry.cut;
+    cut.edges.clear();
+    cut.cap.clear();
+    cut.openChains = slice.openChains;
+    std::vector<const SectionPlane*> trimming;
+    for (std::uint32_t p = 0; p < planes_.size(); ++p) {
+        if (p == cut.plane) {
+            continue;
+        }
+        const Range r = range(planes_[p], slice.min, slice.max);
+        if (r.removed()) {
+            return;
+        }
+        if (!r.kept()) {
+            trimming.push_back(&planes_[p]);
+        }
+    }
+
+    for (std::size_t i = 0; i < slice.edges.size(); i += 2) {
+        Vec3d a = slice.edges[i];
+        Vec3d b = slice.edges[i + 1];
+        bool inside = true;
+        for (const SectionPlane* plane : trimming) {
+            const double da = plane->distance(a);
+            const double db = plane->distance(b);
+            if (da > 0.0 && db > 0.0) {
+                inside = false;
+                break;
+            }
+            if (da > 0.0) {
+                a = a + (b - a) * (da / (da - db));
+            } else if (db > 0.0) {
+                b = b + (a - b) * (db / (db - da));
+            }
+        }
+        if (inside) {
+            cut.edges.push_back(toFloat(a));
+            cut.edges.push_back(toFloat(b));
+        }
+    }
+
+    std::vector<Vec3d> polygon;
+    std::vector<Vec3d> clipped;
+    for (std::size_t i = 0; i < slice.cap.size(); i += 3) {
+        if (trimming.empty()) {
+            for (int k = 0; k < 3; ++k) {
+                cut.cap.push_back(toFloat(slice.cap[i + k]));
+            }
+            continue;
+        }
+        polygon.assign(slice.cap.begin() + std::ptrdiff_t(i), slice.cap.begin() + std::ptrdiff_t(i) + 3);
+        for (const SectionPlane* plane : trimming) {
+            clipPolygon(*plane, polygon, clipped);
+            polygon.swap(clipped);
+        }
+        for (std::size_t k = 1; k + 1 < polygon.size(); ++k) {
+            cut.cap.push_back(toFloat(polygon[0]));
+            cut.cap.push_back(toFloat(polygon[k]));
+            cut.cap.push_back(toFloat(polygon[k + 1]));
+        }
+    }
+}
+
+void SectionView::update(const std::vector<assembly::NodeId>& moved) {
+    REBEL_TRACE_ZONE("render.section");
+    stats_ = {};
+    changed_.clear();
+    const spatial::TwoLevelBvh& bvh = index_.bvh();
+    const std::size_t count = index_.occurrenceCount();
+    const auto planeCount = std::uint32_t(planes_.size());
+
+    std::vector<std::uint8_t> planeMoved(planeCount, 1);
+    const bool samePlanes = sliced_.size() == planes_.size();
+    if (!samePlanes) {
+        while (!entries_.empty()) {
+            erase(entries_.begin()->first);
+        }
+    } else {
+        for (std::uint32_t p = 0; p < planeCount; ++p) {
+            planeMoved[p] = planes_[p] != sliced_[p] ? 1 : 0;
+        }
+    }
+    if (count < instanceCount_) {
+        std::vector<std::uint64_t> gone;
+        for (const auto& entry : entries_) {
+            if (entry.second.cut.instance >= count) {
+                gone.push_back(entry.first);
+            }
+        }
+        for (const std::uint64_t k : gone) {
+            erase(k);
+        }
+    }
+    instanceCount_ = count;
+
+    // A box crossing plane p and not entirely cut away by another.
+    auto crossing = [&](const math::Aabb& box, std::uint32_t p) {
+        if (!range(planes_[p], box).crosses()) {
+            return false;
+        }
+        for (std::uint32_t q = 0; q < planeCount; ++q) {
+            if (q != p && range(planes_[q], box).removed()) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    std::vector<SectionCutId> work;
+    for (std::uint32_t p = 0; p < planeCount; ++p) {
+        if (planeMoved[p] == 0) {
+            continue;
+        }
+        bvh.topLevel().traverse([&](const spatial::BvhNode& node) { return crossing(node.bounds, p); },
+                                [&](std::uint32_t instance) {
+                                    if (crossing(bvh.worldBounds(instance), p)) {
+                                        work.push_back({instance, p});
+                                    }
+                                    return true;
+                                });
+        std::vector<std::uint64_t> left;
+        for (const auto& entry : entries_) {
+            if (entry.second.cut.plane == p && !crossing(bvh.worldBounds(entry.second.cut.instance), p)) {
+                left.push_back(entry.first);
+            }
+        }
+        for (const std::uint64_t k : left) {
+            erase(k);
+        }
+    }
+    for (const assembly::NodeId node : moved) {
+        const spatial::InstanceId instance = index_.instance(node);
+        if (instance == geometry::kInvalidIndex) {
+            continue;
+        }
+        for (std::uint32_t p = 0; p < planeCount; ++p) {
+            if (planeMoved[p] != 0) {
+                continue;
+            }
+            if (crossing(bvh.worldBounds(instance), p)) {
+                work.push_back({instance, p});
+            } else {
+                erase(key(instance, p));
+            }
+        }
+    }
+    std::sort(work.begin(), work.end());
+    work.erase(std::unique(work.begin(), work.end()), work.end());
+
+    std::vector<Slice> slices(work.size());
+    std::vector<SectionStats> workStats(work.size());
+    core::parallelFor(0, work.size(), 4, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            slices[i] = slice(work[i].first, work[i].second, workStats[i]);
+        }
+    });
+
+    std::vector<Entry*> trimmed;
+    std::vector<std::uint64_t> fresh;
+    for (std::size_t i = 0; i < work.size(); ++i) {
+        stats_.trianglesTested += workStats[i].trianglesTested;
+        stats_.trianglesSliced += workStats[i].trianglesSliced;
+        const std::uint64_t k = key(work[i].first, work[i].second);
+        if (slices[i].edges.empty()) {
+            erase(k);
+            continue;
+        }
+        Entry& entry = entries_[k];
+        entry.slice = std::move(slices[i]);
+        entry.cut.instance = work[i].first;
+        entry.cut.plane = work[i].second;
+        trimmed.push_back(&entry);
+        fresh.push_back(k);
+    }
+    stats_.cutsSliced = work.size();
+
+    // Cuts a moved plane passes through, or passed through, trim again.
+    if (samePlanes && std::find(planeMoved.begin(), planeMoved.end(), 1) != planeMoved.end()) {
+        std::sort(fresh.begin(), fresh.end());
+        for (auto& [k, entry] : entries_) {
+            if (std::binary_search(fresh.begin(), fresh.end(), k)) {
+                continue;
+            }
+            for (std::uint32_t p = 0; p < planeCount; ++p) {
+                if (planeMoved[p] == 0 || p == entry.cut.plane) {
+                    continue;
+                }
+                const Range before = range(sliced_[p], entry.slice.min, entry.slice.max);
+                const Range after = range(planes_[p], entry.slice.min, entry.slice.max);
+                if (!(before.kept() && after.kept()) && !(before.removed() && after.removed())) {
+                    trimmed.push_back(&entry);
+                    break;
+                }
+            }
+        }
+    }
+    core::parallelFor(0, trimmed.size(), 4, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            trim(*trimmed[i]);
+        }
+    });
+    for (const Entry* entry : trimmed) {
+        changed_.push_back({entry->cut.instance, entry->cut.plane});
+    }
+    stats_.cutsTrimmed = trimmed.size();
+
+    sliced_ = planes_;
+    std::sort(changed_.begin(), changed_.end());
+    changed_.erase(std::unique(changed_.begin(), changed_.end()), changed_.end());
+}
+
+} // namespace rebel::render
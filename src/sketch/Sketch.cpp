@@ -0,0 +1,1262 @@
+#include "rebel/sketch/Sketch.hpp"
+
+#include "rebel/core/TaskScheduler.hpp"
+#include "rebel/core/Trace.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+namespace rebel::sketch {
+
+namespace {
+
+constexpr std::uint32_t kNone = 0xFFFFFFFFu;
+/// `blockOfParam_` of an unknown no block solves for.
+constexpr std::int32_t kFreeParam = -2;
+/// Block merges per component before falling back to solving it whole.
+constexpr std::size_t kMaxMerges = 8;
+
+enum Kind : std::uint8_t {
+    kDifference,    // x0 - x1
+    kValue,         // x0 - value
+    kDistance,      // |p - q| - value
+    kPointOnCircle, // |p - c| - r
+    kParallel,      // sine between lines u and v
+    kPerpendicular, // cosine between u and v
+    kAngle,         // sine of (angle from u to v) - value
+    kEqualLength,   // |u| - |v|
+    kPointOnLine,   // distance from p to the line through a, b
+    kMidpoint,      // 2 x0 - x1 - x2
+    kTangent,       // signed distance from c to the line through a, b - side r
+};
+
+/// Forward-mode dual number over the (at most eight) parameters of one
+/// equation.
+struct Dual {
+    double v = 0.0;
+    double d[8] = {};
+};
+
+Dual operator+(const Dual& a, const Dual& b) {
+    Dual c;
+    c.v = a.v + b.v;
+    for (int i = 0; i < 8; ++i) {
+        c.d[i] = a.d[i] + b.d[i];
+    }
+    return c;
+}
+
+Dual operator-(const Dual& a, const Dual& b) {
+    Dual c;
+    c.v = a.v - b.v;
+    for (int i = 0; i < 8; ++i) {
+        c.d[i] = a.d[i] - b.d[i];
+    }
+    return c;
+}
+
+Dual operator*(const Dual& a, const Dual& b) {
+    Dual c;
+    c.v = a.v * b.v;
+    for (int i = 0; i < 8; ++i) {
+        c.d[i] = a.d[i] * b.v + a.v * b.d[i];
+    }
+    return c;
+}
+
+Dual operator*(const Dual& a, double s) {
+    Dual c;
+    c.v = a.v * s;
+    for (int i = 0; i < 8; ++i) {
+        c.d[i] = a.d[i] * s;
+    }
+    return c;
+}
+
+Dual operator/(const Dual& a, const Dual& b) {
+    Dual c;
+    c.v = a.v / b.v;
+    for (int i = 0; i < 8; ++i) {
+        c.d[i] = (a.d[i] - c.v * b.d[i]) / b.v;
+    }
+    return c;
+}
+
+Dual sqrt(const Dual& a) {
+    Dual c;
+    c.v = std::sqrt(a.v);
+    for (int i = 0; i < 8; ++i) {
+        c.d[i] = a.d[i] / (2.0 * c.v);
+    }
+    return c;
+}
+
+Dual operator-(const Dual& a, double s) {
+    Dual c = a;
+    c.v -= s;
+    return c;
+}
+
+/// Length with a tiny floor so coincident points keep finite derivatives.
+template <typename T>
+T hypot2(const T& x, const T& y) {
+    using std::sqrt;
+    return sqrt(x * x + y * y + T{1e-24});
+}
+
+template <typename T>
+T residual(std::uint8_t kind, const T* x, double value) {
+    switch (kind) {
+    case kDifference:
+        return x[0] - x[1];
+    case kValue:
+        return x[0] - value;
+    case kDistance:
+        return hypot2(x[0] - x[2], x[1] - x[3]) - value;
+    case kPointOnCircle:
+        return hypot2(x[0] - x[2], x[1] - x[3]) - x[4];
+    case kParallel:
+    case kPerpendicular:
+    case kAngle:
+    case kEqualLength: {
+        const T ux = x[2] - x[0], uy = x[3] - x[1];
+        const T vx = x[6] - x[4], vy = x[7] - x[5];
+        const T lu = hypot2(ux, uy), lv = hypot2(vx, vy);
+        if (kind == kEqualLength) {
+            return lu - lv;
+        }
+        const T cross = ux * vy - uy * vx;
+        const T dot = ux * vx + uy * vy;
+        if (kind == kParallel) {
+            return cross / (lu * lv);
+        }
+        if (kind == kPerpendicular) {
+            return dot / (lu * lv);
+        }
+        return (cross * std::cos(value) - dot * std::sin(value)) / (lu * lv);
+    }
+    case kPointOnLine:
+    case kTangent: {
+        // kPointOnLine: p = x0..1, line x2..5; kTangent: line x0..3,
+        // center x4..5, radius x6.
+        const int line = kind == kPointOnLine ? 2 : 0;
+        const int point = kind == kPointOnLine ? 0 : 4;
+        const T dx = x[line + 2] - x[line], dy = x[line + 3] - x[line + 1];
+        const T px = x[point] - x[line], py = x[point + 1] - x[line + 1];
+        const T distance = (dx * py - dy * px) / hypot2(dx, dy);
+        return kind == kPointOnLine ? distance : distance - x[6] * value;
+    }
+    case kMidpoint:
+        return x[0] * 2.0 - x[1] - x[2];
+    }
+    return T{};
+}
+
+/// Linearized equation: residual and its nonzero partial derivatives with
+/// respect to the block's unknowns (as block columns).
+struct Row {
+    double r = 0.0;
+    std::uint32_t count = 0;
+    std::uint32_t col[8] = {};
+    double j[8] = {};
+};
+
+struct BlockOutcome {
+    bool converged = false;
+    double residual = 0.0;
+};
+
+double maxAbs(const std::vector<Row>& rows) {
+    double m = 0.0;
+    for (const Row& row : rows) {
+        m = std::max(m, std::fabs(row.r));
+    }
+    return m;
+}
+
+double sumSquares(const std::vector<Row>& rows) {
+    double s = 0.0;
+    for (const Row& row : rows) {
+        s += row.r * row.r;
+    }
+    return s;
+}
+
+/// Levenberg-Marquardt on one block. `evaluate(rows)` linearizes the
+/// block's equations at the current `params`; the damped normal equations
+/// are solved by Jacobi-preconditioned conjugate gradients over the sparse
+/// rows, never formed.
+template <typename Evaluate>
+BlockOutcome solveBlock(const std::vector<std::uint32_t>& unknowns, std::vector<double>& params, Evaluate&& evaluate,
+                        const SketchSolveOptions& options) {
+    const std::size_t n = unknowns.size();
+    const std::size_t maxCg = std::min<std::size_t>(2000, 4 * n + 20);
+    std::vector<Row> rows;
+    std::vector<double> gradient(n), diag(n), x(n), r(n), z(n), p(n), ap(n), jp, saved(n);
+
+    BlockOutcome outcome;
+    double lambda = 1e-3;
+    evaluate(rows);
+    double cost = sumSquares(rows);
+    for (std::uint32_t iteration = 0; iteration < options.maxIterations; ++iteration) {
+        outcome.residual = maxAbs(rows);
+        if (outcome.residual <= options.tolerance) {
+            outcome.converged = true;
+            return outcome;
+        }
+        std::fill(gradient.begin(), gradient.end(), 0.0);
+        std::fill(diag.begin(), diag.end(), 0.0);
+        for (const Row& row : rows) {
+            for (std::uint32_t k = 0; k < row.count; ++k) {
+                gradient[row.col[k]] += row.j[k] * row.r;
+                diag[row.col[k]] += row.j[k] * row.j[k];
+            }
+        }
+
+        bool accepted = false;
+        while (!accepted && lambda < 1e12) {
+            const double mu = 1e-12;
+            auto multiply = [&](const std::vector<double>& v, std::vector<double>& out) {
+                jp.resize(rows.size());
+                for (std::size_t i = 0; i < rows.size(); ++i) {
+                    double s = 0.0;
+                    for (std::uint32_t k = 0; k < rows[i].count; ++k) {
+                        s += rows[i].j[k] * v[rows[i].col[k]];
+                    }
+                    jp[i] = s;
+                }
+                for (std::size_t i = 0; i < n; ++i) {
+                    out[i] = (lambda * diag[i] + mu) * v[i];
+                }
+                for (std::size_t i = 0; i < rows.size(); ++i) {
+                    for (std::uint32_t k = 0; k < rows[i].count; ++k) {
+                        out[rows[i].col[k]] += rows[i].j[k] * jp[i];
+                    }
+                }
+            };
+            auto precondition = [&](const std::vector<double>& v, std::vector<double>& out) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    out[i] = v[i] / ((1.0 + lambda) * diag[i] + mu);
+                }
+            };
+
+            std::fill(x.begin(), x.end(), 0.0);
+            for (std::size_t i = 0; i < n; ++i) {
+                r[i] = -gradient[i];
+            }
+            precondition(r, z);
+            p = z;
+            double rz = std::inner_product(r.begin(), r.end(), z.begin(), 0.0);
+            const double stop = 1e-24 * std::inner_product(r.begin(), r.end(), r.begin(), 0.0);
+            for (std::size_t k = 0; k < maxCg && rz > 0.0; ++k) {
+                multiply(p, ap);
+                const double pap = std::inner_product(p.begin(), p.end(), ap.begin(), 0.0);
+                if (pap <= 0.0) {
+                    break;
+                }
+                const double alpha = rz / pap;
+                for (std::size_t i = 0; i < n; ++i) {
+                    x[i] += alpha * p[i];
+                    r[i] -= alpha * ap[i];
+                }
+                if (std::inner_product(r.begin(), r.end(), r.begin(), 0.0) <= stop) {
+                    break;
+                }
+                precondition(r, z);
+                const double next = std::inner_product(r.begin(), r.end(), z.begin(), 0.0);
+                const double beta = next / rz;
+                rz = next;
+                for (std::size_t i = 0; i < n; ++i) {
+                    p[i] = z[i] + beta * p[i];
+                }
+            }
+
+            for (std::size_t i = 0; i < n; ++i) {
+                saved[i] = params[unknowns[i]];
+                params[unknowns[i]] += x[i];
+            }
+            evaluate(rows);
+            const double trial = sumSquares(rows);
+            if (trial < cost) {
+                cost = trial;
+                lambda = std::max(lambda / 3.0, 1e-12);
+                accepted = true;
+            } else {
+                for (std::size_t i = 0; i < n; ++i) {
+                    params[unknowns[i]] = saved[i];
+                }
+                lambda *= 4.0;
+                evaluate(rows);
+            }
+        }
+        if (!accepted) {
+            // No step decreases the cost: an inconsistent block.
+            break;
+        }
+    }
+    outcome.residual = maxAbs(rows);
+    outcome.converged = outcome.residual <= options.tolerance;
+    return outcome;
+}
+
+struct UnionFind {
+    explicit UnionFind(std::size_t n) : parent(n) { std::iota(parent.begin(), parent.end(), 0u); }
+
+    std::uint32_t find(std::uint32_t i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+    void unite(std::uint32_t a, std::uint32_t b) { parent[find(a)] = find(b); }
+
+    std::vector<std::uint32_t> parent;
+};
+
+const char* typeName(EntityType type) {
+    switch (type) {
+    case EntityType::Point:
+        return "point";
+    case EntityType::Line:
+        return "line";
+    case EntityType::Circle:
+        return "circle";
+    case EntityType::Arc:
+        return "arc";
+    }
+    return "entity";
+}
+
+} // namespace
+
+EntityId Sketch::addPoint(const math::Vec2d& position) {
+    const auto id = static_cast<EntityId>(entities_.size());
+    entities_.push_back(Entity{});
+    firstParam_.push_back(static_cast<std::uint32_t>(params_.size()));
+    params_.push_back(position.x);
+    params_.push_back(position.y);
+    fixed_.push_back(0);
+    structureDirty_ = true;
+    return id;
+}
+
+EntityId Sketch::addLine(EntityId start, EntityId end) {
+    requirePoint(start);
+    requirePoint(end);
+    if (start == end) {
+        throw std::invalid_argument("line from point " + std::to_string(start) + " to itself");
+    }
+    const auto id = static_cast<EntityId>(entities_.size());
+    entities_.push_back({EntityType::Line, {start, end, kInvalidEntity}});
+    firstParam_.push_back(kNone);
+    fixed_.push_back(0);
+    structureDirty_ = true;
+    return id;
+}
+
+EntityId Sketch::addCircle(EntityId center, double radius) {
+    requirePoint(center);
+    const auto id = static_cast<EntityId>(entities_.size());
+    entities_.push_back({EntityType::Circle, {center, kInvalidEntity, kInvalidEntity}});
+    firstParam_.push_back(static_cast<std::uint32_t>(params_.size()));
+    params_.push_back(radius);
+    fixed_.push_back(0);
+    structureDirty_ = true;
+    return id;
+}
+
+EntityId Sketch::addArc(EntityId center, EntityId start, EntityId end) {
+    requirePoint(center);
+    requirePoint(start);
+    requirePoint(end);
+    if (center == start || center == end || start == end) {
+        throw std::invalid_argument("arc points must be distinct");
+    }
+    const auto id = static_cast<EntityId>(entities_.size());
+    entities_.push_back({EntityType::Arc, {center, start, end}});
+    firstParam_.push_back(static_cast<std::uint32_t>(params_.size()));
+    const math::Vec2d d = point(start) - point(center);
+    params_.push_back(std::sqrt(d.x * d.x + d.y * d.y));
+    fixed_.push_back(0);
+    structureDirty_ = true;
+    return id;
+}
+
+const Entity& Sketch::entity(EntityId id) const {
+    if (id >= entities_.size()) {
+        throw std::out_of_range("unknown sketch entity " + std::to_string(id));
+    }
+    return entities_[id];
+}
+
+math::Vec2d Sketch::point(EntityId point) const {
+    requirePoint(point);
+    return {params_[firstParam_[point]], params_[firstParam_[point] + 1]};
+}
+
+double Sketch::radius(EntityId circleOrArc) const {
+    requireRound(circleOrArc);
+    return params_[firstParam_[circleOrArc]];
+}
+
+void Sketch::setFixed(EntityId point, bool fixed) {
+    requirePoint(point);
+    if (static_cast<bool>(fixed_[point]) != fixed) {
+        fixed_[point] = fixed ? 1 : 0;
+        structureDirty_ = true;
+    }
+}
+
+bool Sketch::isFixed(EntityId point) const {
+    requirePoint(point);
+    return fixed_[point] != 0;
+}
+
+void Sketch::requireKind(EntityId id, EntityType type) const {
+    if (entity(id).type != type) {
+        throw std::invalid_argument("sketch entity " + std::to_string(id) + " is not a " + typeName(type));
+    }
+}
+
+void Sketch::requirePoint(EntityId id) const { requireKind(id, EntityType::Point); }
+
+void Sketch::requireRound(EntityId id) const {
+    const EntityType type = entity(id).type;
+    if (type != EntityType::Circle && type != EntityType::Arc) {
+        throw std::invalid_argument("sketch entity " + std::to_string(id) + " is not a circle or arc");
+    }
+}
+
+ConstraintId Sketch::addConstraint(const Constraint& constraint) {
+    const EntityId a = constraint.a;
+    const EntityId b = constraint.b;
+    auto pair = [&](auto&& checkA, auto&& checkB) {
+        checkA(a);
+        checkB(b);
+        if (a == b) {
+            throw std::invalid_argument("constraint between sketch entity " + std::to_string(a) + " and itself");
+        }
+    };
+    const auto isPoint = [&](EntityId id) { requirePoint(id); };
+    const auto isLine = [&](EntityId id) { requireKind(id, EntityType::Line); };
+    const auto isRound = [&](EntityId id) { requireRound(id); };
+
+    double side = 1.0;
+    switch (constraint.type) {
+    case ConstraintType::Coincident:
+    case ConstraintType::Distance:
+        pair(isPoint, isPoint);
+        break;
+    case ConstraintType::Horizontal:
+    case ConstraintType::Vertical:
+    case ConstraintType::Length:
+        isLine(a);
+        break;
+    case ConstraintType::Parallel:
+    case ConstraintType::Perpendicular:
+    case ConstraintType::Angle:
+    case ConstraintType::EqualLength:
+        pair(isLine, isLine);
+        break;
+    case ConstraintType::Radius:
+        isRound(a);
+        break;
+    case ConstraintType::EqualRadius:
+        pair(isRound, isRound);
+        break;
+    case ConstraintType::PointOnLine:
+    case ConstraintType::Midpoint:
+        isPoint(a);
+        isLine(b);
+        break;
+    case ConstraintType::PointOnCircle:
+        isPoint(a);
+        isRound(b);
+        break;
+    case ConstraintType::Tangent: {
+        isLine(a);
+        isRound(b);
+        const math::Vec2d p = point(entities_[a].points[0]);
+        const math::Vec2d d = point(entities_[a].points[1]) - p;
+        const math::Vec2d c = point(entities_[b].points[0]) - p;
+        side = d.x * c.y - d.y * c.x < 0.0 ? -1.0 : 1.0;
+        break;
+    }
+    }
+
+    const auto id = static_cast<ConstraintId>(constraints_.size());
+    ConstraintRecord record;
+    record.constraint = constraint;
+    record.side = side;
+    constraints_.push_back(record);
+    ++constraintCount_;
+    structureDirty_ = true;
+    return id;
+}
+
+void Sketch::removeConstraint(ConstraintId id) {
+    if (id >= constraints_.size() || !constraints_[id].active) {
+        throw std::out_of_range("unknown sketch constraint " + std::to_string(id));
+    }
+    constraints_[id].active = false;
+    --constraintCount_;
+    structureDirty_ = true;
+}
+
+const Constraint& Sketch::constraint(ConstraintId id) const {
+    if (id >= constraints_.size() || !constraints_[id].active) {
+        throw std::out_of_range("unknown sketch constraint " + std::to_string(id));
+    }
+    return constraints_[id].constraint;
+}
+
+void Sketch::setValue(ConstraintId id, double value) {
+    if (id >= constraints_.size() || !constraints_[id].active) {
+        throw std::out_of_range("unknown sketch constraint " + std::to_string(id));
+    }
+    ConstraintRecord& record = constraints_[id];
+    if (record.constraint.value == value) {
+        return;
+    }
+    record.constraint.value = value;
+    if (structureDirty_) {
+        return;
+    }
+    for (std::uint32_t e = record.firstEquation; e < record.firstEquation + record.equationCount; ++e) {
+        if (equations_[e].kind != kTangent) {
+            equations_[e].value = value;
+            changed_.push_back(e);
+        }
+    }
+}
+
+void Sketch::hold(EntityId point) {
+    if (held_ == point) {
+        return;
+    }
+    if (!structureDirty_) {
+        holdOnlyChange_ = true;
+        previousHeld_ = held_;
+    }
+    held_ = point;
+    structureDirty_ = true;
+}
+
+void Sketch::rebuild() {
+    REBEL_TRACE_ZONE("sketch.rebuild");
+    // Work left from before the rebuild, by equation. Equations keep their
+    // numbers when only the held point changed.
+    std::vector<char> pending;
+    if (holdOnlyChange_) {
+        pending.assign(equations_.size(), 0);
+        for (const Component& component : components_) {
+            for (std::uint32_t e : component.equations) {
+                pending[e] = pending[e] || component.dirty;
+            }
+        }
+        for (std::uint32_t e : changed_) {
+            pending[e] = 1;
+        }
+    }
+    // Equations, constraint by constraint, then the arcs' own.
+    equations_.clear();
+    auto x = [&](EntityId point) { return firstParam_[point]; };
+    auto y = [&](EntityId point) { return firstParam_[point] + 1; };
+    auto end = [&](EntityId line, int i) { return entities_[line].points[i]; };
+    auto add = [&](Kind kind, std::initializer_list<std::uint32_t> params, double value = 0.0) {
+        Equation e;
+        e.kind = kind;
+        e.value = value;
+        for (std::uint32_t p : params) {
+            e.params[e.paramCount++] = p;
+        }
+        equations_.push_back(e);
+    };
+    auto lines = [&](Kind kind, EntityId a, EntityId b, double value) {
+        add(kind, {x(end(a, 0)), y(end(a, 0)), x(end(a, 1)), y(end(a, 1)), x(end(b, 0)), y(end(b, 0)), x(end(b, 1)),
+                   y(end(b, 1))},
+            value);
+    };
+    for (ConstraintRecord& record : constraints_) {
+        record.firstEquation = static_cast<std::uint32_t>(equations_.size());
+        if (record.active) {
+            const Constraint& c = record.constraint;
+            const EntityId a = c.a;
+            const EntityId b = c.b;
+            switch (c.type) {
+            case ConstraintType::Coincident:
+                add(kDifference, {x(a), x(b)});
+                add(kDifference, {y(a), y(b)});
+                break;
+            case ConstraintType::Horizontal:
+                add(kDifference, {y(end(a, 0)), y(end(a, 1))});
+                break;
+            case ConstraintType::Vertical:
+                add(kDifference, {x(end(a, 0)), x(end(a, 1))});
+                break;
+            case ConstraintType::Parallel:
+                lines(kParallel, a, b, 0.0);
+                break;
+            case ConstraintType::Perpendicular:
+                lines(kPerpendicular, a, b, 0.0);
+                break;
+            case ConstraintType::Angle:
+                lines(kAngle, a, b, c.value);
+                break;
+            case ConstraintType::EqualLength:
+                lines(kEqualLength, a, b, 0.0);
+                break;
+            case ConstraintType::Distance:
+                add(kDistance, {x(a), y(a), x(b), y(b)}, c.value);
+                break;
+            case ConstraintType::Length:
+                add(kDistance, {x(end(a, 0)), y(end(a, 0)), x(end(a, 1)), y(end(a, 1))}, c.value);
+                break;
+            case ConstraintType::Radius:
+                add(kValue, {firstParam_[a]}, c.value);
+                break;
+            case ConstraintType::EqualRadius:
+                add(kDifference, {firstParam_[a], firstParam_[b]});
+                break;
+            case ConstraintType::PointOnLine:
+                add(kPointOnLine, {x(a), y(a), x(end(b, 0)), y(end(b, 0)), x(end(b, 1)), y(end(b, 1))});
+                break;
+            case ConstraintType::PointOnCircle:
+                add(kPointOnCircle, {x(a), y(a), x(end(b, 0)), y(end(b, 0)), firstParam_[b]});
+                break;
+            case ConstraintType::Midpoint:
+                add(kMidpoint, {x(a), x(end(b, 0)), x(end(b, 1))});
+                add(kMidpoint, {y(a), y(end(b, 0)), y(end(b, 1))});
+                break;
+            case ConstraintType::Tangent:
+                add(kTangent,
+                    {x(end(a, 0)), y(end(a, 0)), x(end(a, 1)), y(end(a, 1)), x(end(b, 0)), y(end(b, 0)), firstParam_[b]},
+                    record.side);
+                break;
+            }
+        }
+        record.equationCount = static_cast<std::uint32_t>(equations_.size()) - record.firstEquation;
+    }
+    for (EntityId id = 0; id < entities_.size(); ++id) {
+        if (entities_[id].type == EntityType::Arc) {
+            const EntityId center = end(id, 0);
+            for (int i = 1; i <= 2; ++i) {
+                add(kPointOnCircle, {x(end(id, i)), y(end(id, i)), x(center), y(center), firstParam_[id]});
+            }
+        }
+    }
+
+    // Unknowns: every parameter but those of fixed and held points.
+    std::vector<char> unknown(params_.size(), 1);
+    for (EntityId id = 0; id < entities_.size(); ++id) {
+        if (entities_[id].type == EntityType::Point && (fixed_[id] || id == held_)) {
+            unknown[x(id)] = 0;
+            unknown[y(id)] = 0;
+        }
+    }
+
+    // Components: parameters joined through shared equations.
+    UnionFind sets(params_.size());
+    for (const Equation& e : equations_) {
+        std::uint32_t first = kNone;
+        for (std::uint32_t k = 0; k < e.paramCount; ++k) {
+            if (unknown[e.params[k]]) {
+                if (first == kNone) {
+                    first = e.params[k];
+                } else {
+                    sets.unite(first, e.params[k]);
+                }
+            }
+        }
+    }
+    components_.clear();
+    std::vector<std::uint32_t> componentOfRoot(params_.size(), kNone);
+    componentOf_.assign(equations_.size(), kNone);
+    for (std::uint32_t i = 0; i < equations_.size(); ++i) {
+        const Equation& e = equations_[i];
+        for (std::uint32_t k = 0; k < e.paramCount; ++k) {
+            if (unknown[e.params[k]]) {
+                const std::uint32_t root = sets.find(e.params[k]);
+                if (componentOfRoot[root] == kNone) {
+                    componentOfRoot[root] = static_cast<std::uint32_t>(components_.size());
+                    components_.emplace_back();
+                }
+                componentOf_[i] = componentOfRoot[root];
+                components_[componentOf_[i]].equations.push_back(i);
+                break;
+            }
+        }
+    }
+    for (std::uint32_t p = 0; p < params_.size(); ++p) {
+        // Unknowns no equation touches stay where they are.
+        if (unknown[p] && componentOfRoot[sets.find(p)] != kNone) {
+            components_[componentOfRoot[sets.find(p)]].unknowns.push_back(p);
+        }
+    }
+
+    std::vector<std::int32_t> column(params_.size(), -1);
+    core::parallelFor(0, components_.size(), 16, [&](std::size_t first, std::size_t last) {
+        for (std::size_t c = first; c < last; ++c) {
+            decompose(components_[c], column);
+        }
+    });
+
+    freeParameters_ = 0;
+    redundantEquations_ = 0;
+    blockOf_.assign(equations_.size(), kNone);
+    blockOfParam_.assign(params_.size(), -1);
+    for (Component& component : components_) {
+        for (std::uint32_t b = 0; b < component.blocks.size(); ++b) {
+            const Block& block = component.blocks[b];
+            for (std::uint32_t e : block.equations) {
+                blockOf_[e] = b;
+            }
+            for (std::uint32_t p : block.unknowns) {
+                blockOfParam_[p] = static_cast<std::int32_t>(b);
+            }
+        }
+        // Only the first (over-determined) block can be non-square; the
+        // unknowns left out of every block are the free ones.
+        for (const Block& block : component.blocks) {
+            redundantEquations_ += block.equations.size() - block.unknowns.size();
+        }
+        for (std::uint32_t p : component.unknowns) {
+            if (blockOfParam_[p] < 0) {
+                blockOfParam_[p] = kFreeParam;
+                ++freeParameters_;
+            }
+        }
+        component.dirty = true;
+    }
+    if (holdOnlyChange_) {
+        // Only the components holding or releasing a point differ from the
+        // last solve; the others are the same systems, already solved.
+        auto heldParam = [&](std::uint32_t p) {
+            for (EntityId point : {held_, previousHeld_}) {
+                if (point != kInvalidEntity && (p == x(point) || p == y(point))) {
+                    return true;
+                }
+            }
+            return false;
+        };
+        for (Component& component : components_) {
+            component.dirty = false;
+        }
+        for (std::uint32_t i = 0; i < equations_.size(); ++i) {
+            const Equation& e = equations_[i];
+            if (componentOf_[i] != kNone &&
+                (pending[i] || std::any_of(e.params, e.params + e.paramCount, heldParam))) {
+                components_[componentOf_[i]].dirty = true;
+            }
+        }
+        holdOnlyChange_ = false;
+    }
+    changed_.clear();
+    structureDirty_ = false;
+}
+
+void Sketch::decompose(Component& component, std::vector<std::int32_t>& column) const {
+    const std::size_t m = component.equations.size();
+    const std::size_t n = component.unknowns.size();
+    for (std::size_t j = 0; j < n; ++j) {
+        column[component.unknowns[j]] = static_cast<std::int32_t>(j);
+    }
+
+    // Bipartite graph: equations to the unknowns they involve, ordered by
+    // how strongly the equation depends on each at the current geometry.
+    // The matching only uses the ones it depends on numerically: a length
+    // of a vertical line does not determine an x coordinate even though it
+    // involves one, and matching it there would make its block singular.
+    std::vector<std::uint32_t> rowStart(m + 1, 0), matchEnd(m, 0), rowCols;
+    std::vector<std::pair<double, std::uint32_t>> entries;
+    for (std::size_t i = 0; i < m; ++i) {
+        const Equation& e = equations_[component.equations[i]];
+        Dual x[8];
+        for (std::uint32_t k = 0; k < e.paramCount; ++k) {
+            x[k].v = params_[e.params[k]];
+            x[k].d[k] = 1.0;
+        }
+        const Dual r = residual(e.kind, x, e.value);
+        entries.clear();
+        for (std::uint32_t k = 0; k < e.paramCount; ++k) {
+            const std::int32_t c = column[e.params[k]];
+            if (c < 0) {
+                continue;
+            }
+            const auto col = static_cast<std::uint32_t>(c);
+            const auto same = std::find_if(entries.begin(), entries.end(),
+                                           [&](const auto& entry) { return entry.second == col; });
+            if (same != entries.end()) {
+                same->first += r.d[k];
+            } else {
+                entries.emplace_back(r.d[k], col);
+            }
+        }
+        double largest = 0.0;
+        for (auto& entry : entries) {
+            entry.first = std::fabs(entry.first);
+            largest = std::max(largest, entry.first);
+        }
+        std::stable_sort(entries.begin(), entries.end(),
+                         [](const auto& a, const auto& b) { return a.first > b.first; });
+        for (const auto& entry : entries) {
+            if (entry.first > 1e-6 * largest) {
+                ++matchEnd[i];
+            }
+            rowCols.push_back(entry.second);
+        }
+        matchEnd[i] += rowStart[i];
+        rowStart[i + 1] = static_cast<std::uint32_t>(rowCols.size());
+    }
+
+    // Maximum matching: greedy, then one breadth-first augmenting search
+    // per unmatched equation.
+    std::vector<std::uint32_t> matchRow(m, kNone), matchCol(n, kNone);
+    for (std::uint32_t i = 0; i < m; ++i) {
+        for (std::uint32_t k = rowStart[i]; k < matchEnd[i]; ++k) {
+            if (matchCol[rowCols[k]] == kNone) {
+                matchRow[i] = rowCols[k];
+                matchCol[rowCols[k]] = i;
+                break;
+            }
+        }
+    }
+    std::vector<std::uint32_t> seen(n, kNone), parent(n), queue;
+    for (std::uint32_t root = 0; root < m; ++root) {
+        if (matchRow[root] != kNone) {
+            continue;
+        }
+        queue.assign(1, root);
+        for (std::size_t head = 0; head < queue.size(); ++head) {
+            const std::uint32_t i = queue[head];
+            std::uint32_t freeCol = kNone;
+            for (std::uint32_t k = rowStart[i]; k < matchEnd[i] && freeCol == kNone; ++k) {
+                const std::uint32_t c = rowCols[k];
+                if (seen[c] == root) {
+                    continue;
+                }
+                seen[c] = root;
+                parent[c] = i;
+                if (matchCol[c] == kNone) {
+                    freeCol = c;
+                } else {
+                    queue.push_back(matchCol[c]);
+                }
+            }
+            if (freeCol != kNone) {
+                for (std::uint32_t c = freeCol; c != kNone;) {
+                    const std::uint32_t row = parent[c];
+                    const std::uint32_t previous = matchRow[row];
+                    matchRow[row] = c;
+                    matchCol[c] = row;
+                    c = previous;
+                }
+                break;
+            }
+        }
+    }
+
+    // Coarse decomposition: the over-determined part is what alternating
+    // paths reach from unmatched equations. Its equations involve only its
+    // own unknowns, so it is solved first, in the least-squares sense.
+    enum Part : char { kRest, kOver };
+    std::vector<char> rowPart(m, kRest), colPart(n, kRest);
+    queue.clear();
+    for (std::uint32_t i = 0; i < m; ++i) {
+        if (matchRow[i] == kNone) {
+            rowPart[i] = kOver;
+            queue.push_back(i);
+        }
+    }
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        const std::uint32_t i = queue[head];
+        for (std::uint32_t k = rowStart[i]; k < rowStart[i + 1]; ++k) {
+            const std::uint32_t c = rowCols[k];
+            if (colPart[c] == kRest) {
+                colPart[c] = kOver;
+                if (matchCol[c] != kNone) {
+                    rowPart[matchCol[c]] = kOver;
+                    queue.push_back(matchCol[c]);
+                }
+            }
+        }
+    }
+
+    component.blocks.clear();
+    Block over;
+    for (std::uint32_t i = 0; i < m; ++i) {
+        if (rowPart[i] == kOver) {
+            over.equations.push_back(component.equations[i]);
+        }
+    }
+    for (std::uint32_t c = 0; c < n; ++c) {
+        if (colPart[c] == kOver) {
+            over.unknowns.push_back(component.unknowns[c]);
+        }
+    }
+    if (!over.equations.empty()) {
+        component.blocks.push_back(std::move(over));
+    }
+
+    // Fine decomposition of the rest: strongly connected components of
+    // "equation i needs the unknown matched to equation j" (Tarjan,
+    // iteratively), each emitted after everything it needs. Unknowns the
+    // matching left over are the component's remaining degrees of freedom
+    // and keep their current values, which leaves every block square.
+    std::vector<std::uint32_t> index(m, kNone), low(m, 0), stack;
+    std::vector<char> onStack(m, 0);
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> calls;
+    std::uint32_t counter = 0;
+    for (std::uint32_t start = 0; start < m; ++start) {
+        if (rowPart[start] == kOver || index[start] != kNone) {
+            continue;
+        }
+        calls.emplace_back(start, rowStart[start]);
+        index[start] = low[start] = counter++;
+        stack.push_back(start);
+        onStack[start] = 1;
+        while (!calls.empty()) {
+            auto& [i, k] = calls.back();
+            if (k < rowStart[i + 1]) {
+                const std::uint32_t c = rowCols[k++];
+                if (colPart[c] == kOver || matchCol[c] == kNone || c == matchRow[i]) {
+                    continue;
+                }
+                const std::uint32_t j = matchCol[c];
+                if (index[j] == kNone) {
+                    index[j] = low[j] = counter++;
+                    stack.push_back(j);
+                    onStack[j] = 1;
+                    calls.emplace_back(j, rowStart[j]);
+                } else if (onStack[j]) {
+                    low[i] = std::min(low[i], index[j]);
+                }
+                continue;
+            }
+            const std::uint32_t done = i;
+            calls.pop_back();
+            if (!calls.empty()) {
+                low[calls.back().first] = std::min(low[calls.back().first], low[done]);
+            }
+            if (low[done] == index[done]) {
+                Block block;
+                std::uint32_t j;
+                do {
+                    j = stack.back();
+                    stack.pop_back();
+                    onStack[j] = 0;
+                    block.equations.push_back(component.equations[j]);
+                    block.unknowns.push_back(component.unknowns[matchRow[j]]);
+                } while (j != done);
+                component.blocks.push_back(std::move(block));
+            }
+        }
+    }
+
+    for (std::uint32_t p : component.unknowns) {
+        column[p] = -1;
+    }
+}
+
+SketchSolveResult Sketch::solve(const SketchSolveOptions& options) {
+    hold(kInvalidEntity);
+    return run(options);
+}
+
+SketchSolveResult Sketch::drag(EntityId point, const math::Vec2d& target, const SketchSolveOptions& options) {
+    requirePoint(point);
+    if (fixed_[point]) {
+        return run(options);
+    }
+    hold(point);
+    const std::uint32_t px = firstParam_[point];
+    params_[px] = target.x;
+    params_[px + 1] = target.y;
+    if (!structureDirty_) {
+        for (std::uint32_t i = 0; i < equations_.size(); ++i) {
+            const Equation& e = equations_[i];
+            if (std::any_of(e.params, e.params + e.paramCount,
+                            [&](std::uint32_t p) { return p == px || p == px + 1; })) {
+                changed_.push_back(i);
+            }
+        }
+    }
+    return run(options);
+}
+
+SketchSolveResult Sketch::run(const SketchSolveOptions& options) {
+    REBEL_TRACE_ZONE("sketch.solve");
+    if (structureDirty_) {
+        rebuild();
+    }
+
+    // Blocks to solve: everything in a dirty component; elsewhere the
+    // blocks of changed equations and every later block that uses their
+    // unknowns.
+    std::vector<std::vector<char>> pending(components_.size());
+    std::vector<std::uint32_t> work;
+    for (std::uint32_t c = 0; c < components_.size(); ++c) {
+        if (components_[c].dirty) {
+            pending[c].assign(components_[c].blocks.size(), 1);
+            work.push_back(c);
+        }
+    }
+    for (std::uint32_t e : changed_) {
+        const std::uint32_t c = componentOf_[e];
+        if (c == kNone || components_[c].dirty) {
+            continue;
+        }
+        if (pending[c].empty()) {
+            pending[c].assign(components_[c].blocks.size(), 0);
+            work.push_back(c);
+        }
+        pending[c][blockOf_[e]] = 1;
+    }
+    changed_.clear();
+
+    struct Outcome {
+        bool converged = true;
+        bool fallback = false;
+        std::size_t blocksSolved = 0;
+        std::size_t largestBlock = 0;
+        double residual = 0.0;
+    };
+    std::vector<Outcome> outcomes(work.size());
+    std::vector<std::int32_t> column(params_.size(), -1);
+    std::vector<char> touched(params_.size(), 0);
+
+    core::parallelFor(0, work.size(), 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t w = first; w < last; ++w) {
+            REBEL_TRACE_ZONE("sketch.component");
+            Component& component = components_[work[w]];
+            std::vector<char>& blocks = pending[work[w]];
+            Outcome& outcome = outcomes[w];
+
+            auto solveFor = [&](const std::vector<std::uint32_t>& equations,
+                                const std::vector<std::uint32_t>& unknowns) {
+                for (std::size_t j = 0; j < unknowns.size(); ++j) {
+                    column[unknowns[j]] = static_cast<std::int32_t>(j);
+                }
+                auto evaluate = [&](std::vector<Row>& rows) {
+                    rows.resize(equations.size());
+                    for (std::size_t i = 0; i < equations.size(); ++i) {
+                        const Equation& e = equations_[equations[i]];
+                        Dual x[8];
+                        for (std::uint32_t k = 0; k < e.paramCount; ++k) {
+                            x[k].v = params_[e.params[k]];
+                            x[k].d[k] = column[e.params[k]] >= 0 ? 1.0 : 0.0;
+                        }
+                        const Dual r = residual(e.kind, x, e.value);
+                        Row& row = rows[i];
+                        row.r = r.v;
+                        row.count = 0;
+                        for (std::uint32_t k = 0; k < e.paramCount; ++k) {
+                            const std::int32_t c = column[e.params[k]];
+                            if (c < 0) {
+                                continue;
+                            }
+                            const auto col = static_cast<std::uint32_t>(c);
+                            const auto same = std::find(row.col, row.col + row.count, col);
+                            if (same != row.col + row.count) {
+                                row.j[same - row.col] += r.d[k];
+                            } else {
+                                row.col[row.count] = col;
+                                row.j[row.count++] = r.d[k];
+                            }
+                        }
+                    }
+                };
+                const BlockOutcome result = solveBlock(unknowns, params_, evaluate, options);
+                for (std::uint32_t p : unknowns) {
+                    column[p] = -1;
+                }
+                outcome.blocksSolved += 1;
+                outcome.largestBlock = std::max(outcome.largestBlock, unknowns.size());
+                return result;
+            };
+
+            // Blocks run front to back; one is solved if it is pending or
+            // reads a parameter this run already moved.
+            std::vector<std::uint32_t> moved;
+            auto touch = [&](const std::vector<std::uint32_t>& unknowns) {
+                for (std::uint32_t p : unknowns) {
+                    if (!touched[p]) {
+                        touched[p] = 1;
+                        moved.push_back(p);
+                    }
+                }
+            };
+            auto reads = [&](const Block& block, auto&& predicate) {
+                return std::any_of(block.equations.begin(), block.equations.end(), [&](std::uint32_t e) {
+                    const Equation& eq = equations_[e];
+                    return std::any_of(eq.params, eq.params + eq.paramCount, predicate);
+                });
+            };
+
+            const std::size_t count = component.blocks.size();
+            std::vector<char> done(count, 0), merged(count, 0);
+            std::size_t merges = 0;
+            bool failed = false;
+            for (std::size_t b = 0, next = 0; b < count && !failed; b = next) {
+                next = b + 1;
+                const Block& block = component.blocks[b];
+                if (done[b] || !(blocks[b] || reads(block, [&](std::uint32_t p) { return touched[p] != 0; }))) {
+                    continue;
+                }
+                BlockOutcome result = solveFor(block.equations, block.unknowns);
+                touch(block.unknowns);
+                if (result.converged) {
+                    done[b] = 1;
+                    outcome.residual = std::max(outcome.residual, result.residual);
+                    continue;
+                }
+
+                // The block cannot be met with the free parameters held where
+                // they are (a drag pulling on geometry that is pinned only by
+                // where it happens to be, say). Release the free parameters
+                // upstream of it, nearest first, and solve them together with
+                // every block between them and this one; widen the search
+                // until that works or nothing is left to release.
+                if (++merges > kMaxMerges) {
+                    failed = true;
+                    break;
+                }
+                auto forInputs = [&](std::size_t i, auto&& fn) {
+                    for (std::uint32_t e : component.blocks[i].equations) {
+                        const Equation& eq = equations_[e];
+                        std::for_each(eq.params, eq.params + eq.paramCount, fn);
+                    }
+                };
+                std::vector<std::uint32_t> depth(count, kNone);
+                depth[b] = 0;
+                std::uint32_t deepest = 0;
+                for (std::size_t i = b + 1; i-- > 0;) {
+                    if (depth[i] == kNone) {
+                        continue;
+                    }
+                    deepest = std::max(deepest, depth[i]);
+                    forInputs(i, [&](std::uint32_t p) {
+                        const std::int32_t source = blockOfParam_[p];
+                        if (source >= 0 && static_cast<std::size_t>(source) != i) {
+                            depth[source] = std::min(depth[source], depth[i] + 1);
+                        }
+                    });
+                }
+                std::vector<std::uint32_t> free, group, equations, unknowns;
+                bool solved = false;
+                for (std::uint32_t limit = 1; !solved; limit *= 2) {
+                    const std::size_t released = free.size();
+                    for (std::size_t i = 0; i <= b; ++i) {
+                        if (depth[i] <= limit) {
+                            forInputs(i, [&](std::uint32_t p) {
+                                if (blockOfParam_[p] == kFreeParam && !(touched[p] & 2)) {
+                                    touched[p] |= 2;
+                                    free.push_back(p);
+                                }
+                            });
+                        }
+                    }
+                    if (free.size() == released) {
+                        if (limit > deepest) {
+                            break;
+                        }
+                        continue;
+                    }
+                    // Blocks upstream of this one that are moved by what was
+                    // released.
+                    std::fill(merged.begin(), merged.end(), 0);
+                    group.clear();
+                    for (std::size_t i = 0; i <= b; ++i) {
+                        bool moves = false;
+                        if (depth[i] != kNone) {
+                            forInputs(i, [&](std::uint32_t p) {
+                                const std::int32_t source = blockOfParam_[p];
+                                moves = moves || (touched[p] & 2) ||
+                                        (source >= 0 && static_cast<std::size_t>(source) != i && merged[source]);
+                            });
+                        }
+                        if (moves) {
+                            merged[i] = 1;
+                            group.push_back(static_cast<std::uint32_t>(i));
+                        }
+                    }
+                    if (!merged[b]) {
+                        continue;
+                    }
+                    equations.clear();
+                    unknowns = free;
+                    for (std::uint32_t g : group) {
+                        const Block& member = component.blocks[g];
+                        equations.insert(equations.end(), member.equations.begin(), member.equations.end());
+                        unknowns.insert(unknowns.end(), member.unknowns.begin(), member.unknowns.end());
+                    }
+                    result = solveFor(equations, unknowns);
+                    solved = result.converged;
+                }
+                for (std::uint32_t p : free) {
+                    touched[p] &= 1;
+                }
+                if (!solved) {
+                    failed = true;
+                    break;
+                }
+                touch(unknowns);
+                outcome.residual = std::max(outcome.residual, result.residual);
+                const std::uint32_t first = *std::min_element(group.begin(), group.end());
+                for (std::size_t i = first; i < count; ++i) {
+                    done[i] = merged[i];
+                }
+                next = first;
+            }
+            if (!failed && merges > 0) {
+                // Blocks re-solved after a merge may have pulled on it again.
+                outcome.residual = 0.0;
+                for (std::uint32_t e : component.equations) {
+                    const Equation& eq = equations_[e];
+                    double x[8];
+                    for (std::uint32_t k = 0; k < eq.paramCount; ++k) {
+                        x[k] = params_[eq.params[k]];
+                    }
+                    outcome.residual = std::max(outcome.residual, std::fabs(residual(eq.kind, x, eq.value)));
+                }
+                failed = outcome.residual > options.tolerance;
+            }
+            if (failed) {
+                // Blocks are solved front to back with no way to revise an
+                // earlier choice (one of two intersections, say); give the
+                // whole component one simultaneous try instead.
+                const BlockOutcome result = solveFor(component.equations, component.unknowns);
+                touch(component.unknowns);
+                outcome.fallback = true;
+                outcome.converged = result.converged;
+                outcome.residual = result.residual;
+            }
+            for (std::uint32_t p : moved) {
+                touched[p] = 0;
+            }
+            component.dirty = false;
+        }
+    });
+
+    SketchSolveResult result;
+    for (const Component& component : components_) {
+        result.blockCount += component.blocks.size();
+    }
+    result.freeParameters = freeParameters_;
+    result.redundantEquations = redundantEquations_;
+    for (const Outcome& outcome : outcomes) {
+        result.converged = result.converged && outcome.converged;
+        result.fallbacks += outcome.fallback ? 1 : 0;
+        result.blocksSolved += outcome.blocksSolved;
+        result.largestBlock = std::max(result.largestBlock, outcome.largestBlock);
+        result.residual = std::max(result.residual, outcome.residual);
+    }
+    return result;
+}
+
+} // namespace rebel::sketch
@@ -0,0 +1,280 @@
+#include "rebel/spatial/Bvh.hpp"
+
+#include "rebel/core/TaskScheduler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+namespace rebel::spatial {
+
+using math::Aabb;
+using math::Vec3f;
+
+namespace {
+
+struct Bin {
+    Aabb bounds;
+    std::uint32_t count = 0;
+};
+
+constexpr std::uint32_t kMaxBins = 64;
+
+} // namespace
+
+struct BvhBuilder {
+    const Aabb* bounds;
+    const BvhBuildOptions& options;
+    std::vector<Vec3f> centroids;
+    Bvh& bvh;
+    std::atomic<std::uint32_t> nextNode{1};
+    /// Large subtrees are spawned into this group; null builds serially.
+    core::TaskGroup* group = nullptr;
+
+    BvhBuilder(const Aabb* b, std::size_t count, const BvhBuildOptions& o, Bvh& out)
+        : bounds(b), options(o), centroids(count), bvh(out) {
+        core::parallelFor(0, count, o.parallelThreshold, [&](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) {
+                centroids[i] = b[i].center();
+            }
+        });
+    }
+
+    void makeLeaf(std::uint32_t nodeIndex, std::uint32_t begin, std::uint32_t end) {
+        BvhNode& node = bvh.nodes_[nodeIndex];
+        node.first = begin;
+        node.count = end - begin;
+    }
+
+    void buildNode(std::uint32_t nodeIndex, std::uint32_t begin, std::uint32_t end, int depth) {
+        std::uint32_t* prims = bvh.primitives_.data();
+        Aabb nodeBounds;
+        Aabb centroidBounds;
+        for (std::uint32_t i = begin; i < end; ++i) {
+            nodeBounds.expand(bounds[prims[i]]);
+            centroidBounds.expand(centroids[prims[i]]);
+        }
+        bvh.nodes_[nodeIndex].bounds = nodeBounds;
+
+        const std::uint32_t count = end - begin;
+        if (count <= 1 || depth >= Bvh::kMaxDepth - 2) {
+            makeLeaf(nodeIndex, begin, end);
+            return;
+        }
+
+        // Binned SAH over all three axes.
+        const std::uint32_t binCount = std::clamp<std::uint32_t>(options.binCount, 2, kMaxBins);
+        const Vec3f extent = centroidBounds.extent();
+        float bestCost = std::numeric_limits<float>::infinity();
+        int bestAxis = -1;
+        std::uint32_t bestSplit = 0;
+        for (int axis = 0; axis < 3; ++axis) {
+            if (!(extent[axis] > 0.0f)) {
+                continue;
+            }
+            Bin bins[kMaxBins];
+            const float scale = static_cast<float>(binCount) / extent[axis];
+            for (std::uint32_t i = begin; i < end; ++i) {
+                const std::uint32_t b = binOf(centroids[prims[i]][axis], centroidBounds.min[axis], scale, binCount);
+                bins[b].count++;
+                bins[b].bounds.expand(bounds[prims[i]]);
+            }
+            float rightArea[kMaxBins];
+            std::uint32_t rightCount[kMaxBins];
+            Aabb acc;
+            std::uint32_t n = 0;
+            for (std::uint32_t b = binCount - 1; b > 0; --b) {
+                acc.expand(bins[b].bounds);
+                n += bins[b].count;
+                rightArea[b] = acc.halfArea();
+                rightCount[b] = n;
+            }
+            acc = Aabb{};
+            n = 0;
+            for (std::uint32_t b = 0; b + 1 < binCount; ++b) {
+                acc.expand(bins[b].bounds);
+                n += bins[b].count;
+                if (n == 0 || rightCount[b + 1] == 0) {
+                    continue;
+                }
+                const float cost = acc.halfArea() * static_cast<float>(n) +
+                                   rightArea[b + 1] * static_cast<float>(rightCount[b + 1]);
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = b + 1;
+                }
+            }
+        }
+
+        // Compare in unnormalized units so flat nodes (zero area) stay valid.
+        const float area = nodeBounds.halfArea();
+        const float leafCost = options.intersectionCost * static_cast<float>(count) * area;
+        const float splitCost = options.traversalCost * area + options.intersectionCost * bestCost;
+        const bool mayStayLeaf = count <= options.forcedSplitSize;
+        if (mayStayLeaf && (bestAxis < 0 || (count <= options.maxLeafSize && leafCost <= splitCost))) {
+            makeLeaf(nodeIndex, begin, end);
+            return;
+        }
+
+        std::uint32_t mid = begin;
+        if (bestAxis >= 0) {
+            const float scale = static_cast<float>(binCount) / extent[bestAxis];
+            const float lo = centroidBounds.min[bestAxis];
+            mid = static_cast<std::uint32_t>(
+                std::partition(prims + begin, prims + end,
+                               [&](std::uint32_t p) {
+                                   return binOf(centroids[p][bestAxis], lo, scale, binCount) < bestSplit;
+                               }) -
+                prims);
+        }
+        if (mid == begin || mid == end) {
+            // All centroids coincide (or binning collapsed); split by count.
+            mid = begin + count / 2;
+        }
+
+        const std::uint32_t children = nextNode.fetch_add(2, std::memory_order_relaxed);
+        bvh.nodes_[nodeIndex].first = children;
+        bvh.nodes_[nodeIndex].count = 0;
+
+        if (group && count >= options.parallelThreshold) {
+            // Hand the left subtree to the pool and keep the right one; idle
+            // workers steal the oldest (largest) subtrees first.
+            group->run([this, children, begin, mid, depth] { buildNode(children, begin, mid, depth + 1); });
+            buildNode(children + 1, mid, end, depth + 1);
+        } else {
+            buildNode(children, begin, mid, depth + 1);
+            buildNode(children + 1, mid, end, depth + 1);
+        }
+    }
+
+    static std::uint32_t binOf(float c, float lo, float scale, std::uint32_t binCount) {
+        const auto b = static_cast<std::int64_t>((c - lo) * scale);
+        return static_cast<std::uint32_t>(std::clamp<std::int64_t>(b, 0, binCount - 1));
+    }
+};
+
+Bvh Bvh::build(const Aabb* primitiveBounds, std::size_t count, const BvhBuildOptions& options) {
+    Bvh bvh;
+    if (count == 0) {
+        return bvh;
+    }
+    bvh.primitives_.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        bvh.primitives_[i] = static_cast<std::uint32_t>(i);
+    }
+    bvh.nodes_.resize(2 * count - 1);
+
+    BvhBuilder builder(primitiveBounds, count, options, bvh);
+    core::TaskScheduler& scheduler = core::TaskScheduler::global();
+    if (count >= options.parallelThreshold && scheduler.threadCount() > 1) {
+        core::TaskGroup group(scheduler);
+        builder.group = &group;
+        builder.buildNode(0, 0, static_cast<std::uint32_t>(count), 0);
+        group.wait();
+    } else {
+        builder.buildNode(0, 0, static_cast<std::uint32_t>(count), 0);
+    }
+    bvh.nodes_.resize(builder.nextNode.load());
+    bvh.nodes_.shrink_to_fit();
+    bvh.linkParents();
+    return bvh;
+}
+
+void Bvh::linkParents() {
+    parents_.assign(nodes_.size(), 0);
+    primitiveLeaf_.assign(primitives_.size(), 0);
+    for (std::uint32_t i = 0; i < nodes_.size(); ++i) {
+        const BvhNode& node = nodes_[i];
+        if (node.isLeaf()) {
+            for (std::uint32_t k = 0; k < node.count; ++k) {
+                primitiveLeaf_[primitives_[node.first + k]] = i;
+            }
+        } else {
+            parents_[node.first] = i;
+            parents_[node.first + 1] = i;
+        }
+    }
+}
+
+bool Bvh::refitNode(std::uint32_t index, const Aabb* primitiveBounds) {
+    BvhNode& node = nodes_[index];
+    Aabb box;
+    if (node.isLeaf()) {
+        for (std::uint32_t k = 0; k < node.count; ++k) {
+            box.expand(primitiveBounds[primitives_[node.first + k]]);
+        }
+    } else {
+        box = nodes_[node.first].bounds;
+        box.expand(nodes_[node.first + 1].bounds);
+    }
+    if (box == node.bounds) {
+        return false;
+    }
+    node.bounds = box;
+    return true;
+}
+
+void Bvh::refit(std::uint32_t primitive, const Aabb* primitiveBounds) {
+    std::uint32_t node = primitiveLeaf_[primitive];
+    while (refitNode(node, primitiveBounds) && node != 0) {
+        node = parents_[node];
+    }
+}
+
+void Bvh::refit(const std::uint32_t* moved, std::size_t movedCount, const Aabb* primitiveBounds) {
+    // Children always have larger indices than their parent, and a refit
+    // only ever queues a parent, so popping the largest index first visits
+    // every affected node once, after all of its children.
+    std::vector<std::uint32_t> dirty;
+    dirty.reserve(movedCount);
+    for (std::size_t i = 0; i < movedCount; ++i) {
+        dirty.push_back(primitiveLeaf_[moved[i]]);
+    }
+    std::make_heap(dirty.begin(), dirty.end());
+    while (!dirty.empty()) {
+        std::pop_heap(dirty.begin(), dirty.end());
+        const std::uint32_t node = dirty.back();
+        dirty.pop_back();
+        while (!dirty.empty() && dirty.front() == node) {
+            std::pop_heap(dirty.begin(), dirty.end());
+            dirty.pop_back();
+        }
+        if (refitNode(node, primitiveBounds) && node != 0) {
+            dirty.push_back(parents_[node]);
+            std::push_heap(dirty.begin(), dirty.end());
+        }
+    }
+}
+
+void Bvh::refitAll(const Aabb* primitiveBounds) {
+    for (std::size_t i = nodes_.size(); i-- > 0;) {
+        refitNode(static_cast<std::uint32_t>(i), primitiveBounds);
+    }
+}
+
+float Bvh::sahCost(const BvhBuildOptions& options) const {
+    if (nodes_.empty() || nodes_[0].bounds.halfArea() <= 0.0f) {
+        return 0.0f;
+    }
+    double cost = 0.0;
+    for (const BvhNode& node : nodes_) {
+        const double area = node.bounds.halfArea();
+        cost += node.isLeaf() ? options.intersectionCost * node.count * area : options.traversalCost * area;
+    }
+    return static_cast<float>(cost / nodes_[0].bounds.halfArea());
+}
+
+float intersectRayAabb(const math::Ray& ray, const Vec3f& invDirection, const Aabb& box) {
+    float tNear = ray.tMin;
+    float tFar = ray.tMax;
+    for (int axis = 0; axis < 3; ++axis) {
+        const float t1 = (box.min[axis] - ray.origin[axis]) * invDirection[axis];
+        const float t2 = (box.max[axis] - ray.origin[axis]) * invDirection[axis];
+        tNear = std::max(tNear, std::min(t1, t2));
+        tFar = std::min(tFar, std::max(t1, t2));
+    }
+    return tNear <= tFar ? tNear : std::numeric_limits<float>::infinity();
+}
+
+} // namespace rebel::spatial
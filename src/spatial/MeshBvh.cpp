@@ -0,0 +1,112 @@
+#include "rebel/spatial/MeshBvh.hpp"
+
+#include "rebel/core/TaskScheduler.hpp"
+
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace rebel::spatial {
+
+using math::Aabb;
+
+namespace {
+
+struct OwnedMeshBvh {
+    Bvh bvh;
+    core::AlignedVector<float> v0x, v0y, v0z;
+    core::AlignedVector<float> e1x, e1y, e1z;
+    core::AlignedVector<float> e2x, e2y, e2z;
+};
+
+} // namespace
+
+MeshBvh MeshBvh::build(const geometry::MeshView& mesh, const BvhBuildOptions& options) {
+    auto owned = std::make_shared<OwnedMeshBvh>();
+    std::vector<Aabb> triBounds(mesh.triangleCount);
+    core::parallelFor(0, mesh.triangleCount, options.parallelThreshold, [&](std::size_t first, std::size_t last) {
+        for (std::size_t t = first; t < last; ++t) {
+            triBounds[t] = mesh.triangleBounds(static_cast<geometry::TriangleIndex>(t));
+        }
+    });
+    owned->bvh = Bvh::build(triBounds.data(), triBounds.size(), options);
+
+    const std::vector<std::uint32_t>& order = owned->bvh.primitives();
+    const std::size_t n = order.size();
+    for (auto* a : {&owned->v0x, &owned->v0y, &owned->v0z, &owned->e1x, &owned->e1y, &owned->e1z,
+                    &owned->e2x, &owned->e2y, &owned->e2z}) {
+        a->resize(n);
+    }
+    OwnedMeshBvh& o = *owned;
+    core::parallelFor(0, n, options.parallelThreshold, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            const std::uint32_t t = order[i];
+            const math::Vec3f p0 = mesh.position(mesh.corners[3 * t]);
+            const math::Vec3f e1 = mesh.position(mesh.corners[3 * t + 1]) - p0;
+            const math::Vec3f e2 = mesh.position(mesh.corners[3 * t + 2]) - p0;
+            o.v0x[i] = p0.x;
+            o.v0y[i] = p0.y;
+            o.v0z[i] = p0.z;
+            o.e1x[i] = e1.x;
+            o.e1y[i] = e1.y;
+            o.e1z[i] = e1.z;
+            o.e2x[i] = e2.x;
+            o.e2y[i] = e2.y;
+            o.e2z[i] = e2.z;
+        }
+    });
+    const math::batch::TriangleBatch triangles{o.v0x.data(), o.v0y.data(), o.v0z.data(),
+                                               o.e1x.data(), o.e1y.data(), o.e1z.data(),
+                                               o.e2x.data(), o.e2y.data(), o.e2z.data(), n};
+    const BvhView view = o.bvh.view();
+    return wrap(view, triangles, std::move(owned));
+}
+
+MeshBvh MeshBvh::wrap(const BvhView& bvh, const math::batch::TriangleBatch& triangles,
+                      std::shared_ptr<const void> storage) {
+    if (triangles.count != bvh.primitiveCount) {
+        throw std::invalid_argument("MeshBvh::wrap: one leaf-ordered triangle per primitive required");
+    }
+    MeshBvh result;
+    result.bvh_ = bvh;
+    result.triangles_ = triangles;
+    result.storage_ = std::move(storage);
+    return result;
+}
+
+math::batch::TriangleBatch MeshBvh::leafBatch(const BvhNode& leaf) const {
+    const std::size_t f = leaf.first;
+    const math::batch::TriangleBatch& t = triangles_;
+    return {t.v0x + f, t.v0y + f, t.v0z + f, t.e1x + f, t.e1y + f,
+            t.e1z + f, t.e2x + f, t.e2y + f, t.e2z + f, leaf.count};
+}
+
+RayHit MeshBvh::raycast(const math::Ray& ray) const {
+    constexpr std::uint32_t kLocalScratch = 64;
+    RayHit hit;
+    float localScratch[kLocalScratch];
+    std::vector<float> heapScratch;
+    bvh_.raycastLeaves(ray, [&](const BvhNode& leaf, math::Ray& r) {
+        float* scratch = localScratch;
+        if (leaf.count > kLocalScratch) {
+            heapScratch.resize(leaf.count);
+            scratch = heapScratch.data();
+        }
+        float t = 0.0f;
+        const std::size_t best = math::batch::closestRayTriangle(r, leafBatch(leaf), scratch, &t);
+        if (best < leaf.count && t < hit.t) {
+            hit.t = t;
+            hit.triangle = bvh_.primitives[leaf.first + best];
+            r.tMax = t;
+        }
+    });
+    return hit;
+}
+
+std::size_t MeshBvh::memoryBytes() const {
+    return bvh_.nodeCount * sizeof(BvhNode) +
+           bvh_.primitiveCount * (sizeof(std::uint32_t) * 3 + sizeof(float) * 9);
+}
+
+} // namespace rebel::spatial
@@ -0,0 +1,105 @@
+#include "rebel/spatial/TwoLevelBvh.hpp"
+
+#include "rebel/math/Batch.hpp"
+
+#include <vector>
+
+namespace rebel::spatial {
+
+InstanceId TwoLevelBvh::addInstance(const MeshBvh* mesh, const math::Mat4f& transform) {
+    const auto id = static_cast<InstanceId>(meshes_.size());
+    meshes_.push_back(mesh);
+    transforms_.push_back(transform);
+    inverses_.push_back(transform.inverse());
+    localBounds_.push_back(mesh->bounds());
+    worldBounds_.emplace_back();
+    isDirty_.push_back(0);
+    needsRebuild_ = true;
+    return id;
+}
+
+void TwoLevelBvh::setTransform(InstanceId instance, const math::Mat4f& transform) {
+    transforms_[instance] = transform;
+    inverses_[instance] = transform.inverse();
+    if (!isDirty_[instance]) {
+        isDirty_[instance] = 1;
+        dirty_.push_back(instance);
+    }
+}
+
+void TwoLevelBvh::setMesh(InstanceId instance, const MeshBvh* mesh) {
+    meshes_[instance] = mesh;
+    localBounds_[instance] = mesh->bounds();
+    if (!isDirty_[instance]) {
+        isDirty_[instance] = 1;
+        dirty_.push_back(instance);
+    }
+}
+
+void TwoLevelBvh::updateWorldBounds(const std::uint32_t* instances, std::size_t count) {
+    // Gather into contiguous arrays so the SIMD kernel streams them.
+    std::vector<math::Mat4f> matrices(count);
+    std::vector<math::Aabb> local(count);
+    std::vector<math::Aabb> world(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        matrices[i] = transforms_[instances[i]];
+        local[i] = localBounds_[instances[i]];
+    }
+    math::batch::transformAabbs(matrices.data(), local.data(), world.data(), count);
+    for (std::size_t i = 0; i < count; ++i) {
+        worldBounds_[instances[i]] = world[i];
+    }
+}
+
+void TwoLevelBvh::commit(const BvhBuildOptions& options) {
+    if (needsRebuild_) {
+        rebuild(options);
+        return;
+    }
+    if (dirty_.empty()) {
+        return;
+    }
+    updateWorldBounds(dirty_.data(), dirty_.size());
+    top_.refit(dirty_.data(), dirty_.size(), worldBounds_.data());
+    for (std::uint32_t instance : dirty_) {
+        isDirty_[instance] = 0;
+    }
+    dirty_.clear();
+}
+
+void TwoLevelBvh::rebuild(const BvhBuildOptions& options) {
+    const std::size_t n = meshes_.size();
+    if (n > 0) {
+        math::batch::transformAabbs(transforms_.data(), localBounds_.data(), worldBounds_.data(), n);
+    }
+    top_ = Bvh::build(worldBounds_.data(), n, options);
+    for (std::uint32_t instance : dirty_) {
+        isDirty_[instance] = 0;
+    }
+    dirty_.clear();
+    needsRebuild_ = false;
+}
+
+InstanceHit TwoLevelBvh::raycast(const math::Ray& ray) const {
+    InstanceHit best;
+    top_.raycast(ray, [&](std::uint32_t instance, math::Ray& r) {
+        const math::Mat4f& inv = inverses_[instance];
+        // The direction is transformed but not renormalized, so the ray
+        // parameter t means the same thing in both spaces.
+        math::Ray local;
+        local.origin = inv.transformPoint(r.origin);
+        local.direction = inv.transformVector(r.direction);
+        local.tMin = r.tMin;
+        local.tMax = r.tMax;
+        const RayHit hit = meshes_[instance]->raycast(local);
+        if (hit.hit() && hit.t < best.t) {
+            best.instance = instance;
+            best.triangle = hit.triangle;
+            best.t = hit.t;
+            r.tMax = hit.t;
+        }
+    });
+    return best;
+}
+
+} // namespace rebel::spatial
@@ -0,0 +1,458 @@
+#include "rebel/sync/ChangeSet.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace rebel::sync {
+namespace {
+
+constexpr std::uint32_t kChangeSetMagic = 0x53434252u; // "RBCS"
+constexpr std::uint32_t kGeometryMagic = 0x47504252u;  // "RBPG"
+constexpr std::uint32_t kVersion = 1;
+
+enum class OpTag : std::uint8_t { AddNode = 1, RemoveNode, Transform, Overrides, Parameter };
+enum class ValueTag : std::uint8_t { Number = 1, Integer, Flag, Text };
+
+enum GeometryFlags : std::uint8_t {
+    kNormals = 1u << 0,
+    kUvs = 1u << 1,
+    kConnectivity = 1u << 2,
+};
+
+/// Little-endian output, whatever the host's byte order.
+class Writer {
+public:
+    explicit Writer(std::vector<std::uint8_t>& out) : out_(out) {}
+
+    void byte(std::uint8_t b) { out_.push_back(b); }
+
+    void u32(std::uint32_t v) {
+        for (int i = 0; i < 4; ++i) {
+            out_.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+        }
+    }
+
+    void u64(std::uint64_t v) {
+        for (int i = 0; i < 8; ++i) {
+            out_.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+        }
+    }
+
+    /// LEB128: seven bits per byte, high bit set on all but the last.
+    void varint(std::uint64_t v) {
+        while (v >= 0x80) {
+            out_.push_back(static_cast<std::uint8_t>(v | 0x80));
+            v >>= 7;
+        }
+        out_.push_back(static_cast<std::uint8_t>(v));
+    }
+
+    void f32(float v) {
+        std::uint32_t bits;
+        std::memcpy(&bits, &v, sizeof bits);
+        u32(bits);
+    }
+
+    void f64(double v) {
+        std::uint64_t bits;
+        std::memcpy(&bits, &v, sizeof bits);
+        u64(bits);
+    }
+
+    void string(const std::string& s) {
+        varint(s.size());
+        out_.insert(out_.end(), s.begin(), s.end());
+    }
+
+    void hash(const core::Hash128& h) {
+        u64(h.lo);
+        u64(h.hi);
+    }
+
+    /// Affine transforms (the usual case) drop the constant bottom row.
+    void transform(const math::Mat4f& m) {
+        const bool affine = m.m[3] == 0.0f && m.m[7] == 0.0f && m.m[11] == 0.0f && m.m[15] == 1.0f;
+        byte(affine ? 0 : 1);
+        for (int i = 0; i < 16; ++i) {
+            if (!affine || i % 4 != 3) {
+                f32(m.m[i]);
+            }
+        }
+    }
+
+    template <typename T>
+    void array(const T* data, std::size_t count) {
+        static_assert(std::is_same_v<T, float> || std::is_same_v<T, std::uint32_t>, "arrays of 32-bit values");
+        out_.reserve(out_.size() + count * 4);
+        for (std::size_t i = 0; i < count; ++i) {
+            if constexpr (std::is_same_v<T, float>) {
+                f32(data[i]);
+            } else {
+                u32(data[i]);
+            }
+        }
+    }
+
+private:
+    std::vector<std::uint8_t>& out_;
+};
+
+class Reader {
+public:
+    Reader(const std::uint8_t* data, std::size_t size, const char* what) : data_(data), size_(size), what_(what) {}
+
+    bool done() const { return position_ == size_; }
+
+    std::uint8_t byte() {
+        need(1);
+        return data_[position_++];
+    }
+
+    std::uint32_t u32() {
+        need(4);
+        std::uint32_t v = 0;
+        for (int i = 0; i < 4; ++i) {
+            v |= static_cast<std::uint32_t>(data_[position_++]) << (8 * i);
+        }
+        return v;
+    }
+
+    std::uint64_t u64() {
+        need(8);
+        std::uint64_t v = 0;
+        for (int i = 0; i < 8; ++i) {
+            v |= static_cast<std::uint64_t>(data_[position_++]) << (8 * i);
+        }
+        return v;
+    }
+
+    std::uint64_t varint() {
+        std::uint64_t v = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            const std::uint8_t b = byte();
+            v |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) {
+                return v;
+            }
+        }
+        fail("integer too long");
+    }
+
+    /// A count of items at least `itemBytes` each, checked against what is
+    /// left so a corrupt count cannot trigger a huge allocation.
+    std::size_t count(std::size_t itemBytes) {
+        const std::uint64_t n = varint();
+        if (n > (size_ - position_) / itemBytes) {
+            fail("count exceeds the message");
+        }
+        return static_cast<std::size_t>(n);
+    }
+
+    float f32() {
+        const std::uint32_t bits = u32();
+        float v;
+        std::memcpy(&v, &bits, sizeof v);
+        return v;
+    }
+
+    double f64() {
+        const std::uint64_t bits = u64();
+        double v;
+        std::memcpy(&v, &bits, sizeof v);
+        return v;
+    }
+
+    std::string string() {
+        const std::size_t n = count(1);
+        std::string s(reinterpret_cast<const char*>(data_ + position_), n);
+        position_ += n;
+        return s;
+    }
+
+    core::Hash128 hash() {
+        core::Hash128 h;
+        h.lo = u64();
+        h.hi = u64();
+        return h;
+    }
+
+    math::Mat4f transform() {
+        const bool affine = byte() == 0;
+        math::Mat4f m;
+        for (int i = 0; i < 16; ++i) {
+            if (!affine || i % 4 != 3) {
+                m.m[i] = f32();
+            }
+        }
+        return m;
+    }
+
+    template <typename T>
+    void array(T* data, std::size_t count) {
+        need(count * 4);
+        for (std::size_t i = 0; i < count; ++i) {
+            if constexpr (std::is_same_v<T, float>) {
+                data[i] = f32();
+            } else {
+                data[i] = u32();
+            }
+        }
+    }
+
+    [[noreturn]] void fail(const char* why) const { throw std::runtime_error(std::string(what_) + ": " + why); }
+
+private:
+    void need(std::size_t bytes) const {
+        if (bytes > size_ - position_) {
+            fail("truncated");
+        }
+    }
+
+    const std::uint8_t* data_;
+    std::size_t size_;
+    std::size_t position_ = 0;
+    const char* what_;
+};
+
+void writeValue(Writer& out, const feature::ParameterValue& value) {
+    if (const auto* number = std::get_if<double>(&value)) {
+        out.byte(static_cast<std::uint8_t>(ValueTag::Number));
+        out.f64(*number);
+    } else if (const auto* integer = std::get_if<std::int64_t>(&value)) {
+        out.byte(static_cast<std::uint8_t>(ValueTag::Integer));
+        // Zigzag, so small negative values stay short.
+        out.varint((static_cast<std::uint64_t>(*integer) << 1) ^ static_cast<std::uint64_t>(*integer >> 63));
+    } else if (const auto* flag = std::get_if<bool>(&value)) {
+        out.byte(static_cast<std::uint8_t>(ValueTag::Flag));
+        out.byte(*flag ? 1 : 0);
+    } else {
+        out.byte(static_cast<std::uint8_t>(ValueTag::Text));
+        out.string(std::get<std::string>(value));
+    }
+}
+
+feature::ParameterValue readValue(Reader& in) {
+    switch (static_cast<ValueTag>(in.byte())) {
+    case ValueTag::Number:
+        return in.f64();
+    case ValueTag::Integer: {
+        const std::uint64_t z = in.varint();
+        return static_cast<std::int64_t>((z >> 1) ^ (~(z & 1) + 1));
+    }
+    case ValueTag::Flag:
+        return in.byte() != 0;
+    case ValueTag::Text:
+        return in.string();
+    }
+    in.fail("unknown parameter type");
+}
+
+} // namespace
+
+std::vector<std::uint8_t> encode(const ChangeSet& changes) {
+    std::vector<std::uint8_t> bytes;
+    Writer out(bytes);
+    out.u32(kChangeSetMagic);
+    out.varint(kVersion);
+    out.varint(changes.site);
+    out.varint(changes.serial);
+    out.varint(changes.sequence);
+    out.varint(changes.parts.size());
+    for (const PartRef& part : changes.parts) {
+        out.string(part.name);
+        out.hash(part.geometry);
+    }
+    out.varint(changes.operations.size());
+    for (const Operation& op : changes.operations) {
+        if (const auto* add = std::get_if<AddNodeOp>(&op)) {
+            out.byte(static_cast<std::uint8_t>(OpTag::AddNode));
+            out.varint(add->node);
+            out.varint(add->parent);
+            // Shifted by one so subassemblies (`kNoPart`) take one byte.
+            out.varint(add->part == kNoPart ? 0 : std::uint64_t(add->part) + 1);
+            out.transform(add->local);
+            out.string(add->name);
+        } else if (const auto* remove = std::get_if<RemoveNodeOp>(&op)) {
+            out.byte(static_cast<std::uint8_t>(OpTag::RemoveNode));
+            out.varint(remove->node);
+        } else if (const auto* transform = std::get_if<TransformOp>(&op)) {
+            out.byte(static_cast<std::uint8_t>(OpTag::Transform));
+            out.varint(transform->node);
+            out.transform(transform->local);
+        } else if (const auto* overrides = std::get_if<OverridesOp>(&op)) {
+            out.byte(static_cast<std::uint8_t>(OpTag::Overrides));
+            out.varint(overrides->node);
+            out.byte(overrides->overrides.flags);
+            out.u32(overrides->overrides.colorRgba);
+        } else {
+            const auto& parameter = std::get<ParameterOp>(op);
+            out.byte(static_cast<std::uint8_t>(OpTag::Parameter));
+            out.varint(parameter.feature);
+            out.string(parameter.name);
+            writeValue(out, parameter.value);
+        }
+    }
+    return bytes;
+}
+
+ChangeSet decodeChangeSet(const std::uint8_t* data, std::size_t size) {
+    Reader in(data, size, "change set");
+    if (in.u32() != kChangeSetMagic) {
+        in.fail("not a change set");
+    }
+    if (in.varint() != kVersion) {
+        in.fail("unsupported protocol version");
+    }
+    ChangeSet changes;
+    changes.site = static_cast<SiteId>(in.varint());
+    changes.serial = in.varint();
+    changes.sequence = in.varint();
+    changes.parts.resize(in.count(17));
+    for (PartRef& part : changes.parts) {
+        part.name = in.string();
+        part.geometry = in.hash();
+    }
+    const std::size_t operations = in.count(2);
+    changes.operations.reserve(operations);
+    for (std::size_t i = 0; i < operations; ++i) {
+        switch (static_cast<OpTag>(in.byte())) {
+        case OpTag::AddNode: {
+            AddNodeOp add;
+            add.node = in.varint();
+            add.parent = in.varint();
+            const std::uint64_t part = in.varint();
+            if (part > changes.parts.size()) {
+                in.fail("part index out of range");
+            }
+            add.part = part == 0 ? kNoPart : static_cast<std::uint32_t>(part - 1);
+            add.local = in.transform();
+            add.name = in.string();
+            changes.operations.emplace_back(std::move(add));
+            break;
+        }
+        case OpTag::RemoveNode:
+            changes.operations.emplace_back(RemoveNodeOp{in.varint()});
+            break;
+        case OpTag::Transform: {
+            TransformOp transform;
+            transform.node = in.varint();
+            transform.local = in.transform();
+            changes.operations.emplace_back(transform);
+            break;
+        }
+        case OpTag::Overrides: {
+            OverridesOp overrides;
+            overrides.node = in.varint();
+            overrides.overrides.flags = in.byte();
+            overrides.overrides.colorRgba = in.u32();
+            changes.operations.emplace_back(overrides);
+            break;
+        }
+        case OpTag::Parameter: {
+            ParameterOp parameter;
+            parameter.feature = static_cast<feature::FeatureId>(in.varint());
+            parameter.name = in.string();
+            parameter.value = readValue(in);
+            changes.operations.emplace_back(std::move(parameter));
+            break;
+        }
+        default:
+            in.fail("unknown operation");
+        }
+    }
+    if (!in.done()) {
+        in.fail("trailing bytes");
+    }
+    return changes;
+}
+
+core::Hash128 geometryHash(const geometry::MeshView& mesh) {
+    core::Hasher hasher;
+    hasher.add(static_cast<std::uint64_t>(mesh.vertexCount));
+    hasher.add(static_cast<std::uint64_t>(mesh.triangleCount));
+    for (const float* array : {mesh.px, mesh.py, mesh.pz, mesh.nx, mesh.ny, mesh.nz, mesh.u, mesh.v}) {
+        hasher.add(static_cast<std::uint8_t>(array != nullptr));
+        if (array != nullptr) {
+            hasher.addBytes(array, mesh.vertexCount * sizeof(float));
+        }
+    }
+    hasher.addBytes(mesh.corners, mesh.triangleCount * 3 * sizeof(geometry::VertexIndex));
+    return hasher.finish();
+}
+
+std::vector<std::uint8_t> encodeGeometry(const geometry::MeshView& mesh) {
+    std::vector<std::uint8_t> bytes;
+    Writer out(bytes);
+    out.u32(kGeometryMagic);
+    out.varint(kVersion);
+    out.byte(static_cast<std::uint8_t>((mesh.hasNormals() ? kNormals : 0) | (mesh.hasUvs() ? kUvs : 0) |
+                                       (mesh.hasConnectivity() ? kConnectivity : 0)));
+    out.varint(mesh.vertexCount);
+    out.varint(mesh.triangleCount);
+    out.array(mesh.px, mesh.vertexCount);
+    out.array(mesh.py, mesh.vertexCount);
+    out.array(mesh.pz, mesh.vertexCount);
+    if (mesh.hasNormals()) {
+        out.array(mesh.nx, mesh.vertexCount);
+        out.array(mesh.ny, mesh.vertexCount);
+        out.array(mesh.nz, mesh.vertexCount);
+    }
+    if (mesh.hasUvs()) {
+        out.array(mesh.u, mesh.vertexCount);
+        out.array(mesh.v, mesh.vertexCount);
+    }
+    // The opposite-corner table is derived data; it is rebuilt on arrival.
+    out.array(mesh.corners, mesh.triangleCount * 3);
+    return bytes;
+}
+
+geometry::Mesh decodeGeometry(const std::uint8_t* data, std::size_t size) {
+    Reader in(data, size, "part geometry");
+    if (in.u32() != kGeometryMagic) {
+        in.fail("not part geometry");
+    }
+    if (in.varint() != kVersion) {
+        in.fail("unsupported protocol version");
+    }
+    const std::uint8_t flags = in.byte();
+    const std::size_t vertices = in.count(12);
+    const std::size_t triangles = in.count(12);
+    geometry::Mesh mesh;
+    if ((flags & kNormals) != 0) {
+        mesh.enableNormals();
+    }
+    if ((flags & kUvs) != 0) {
+        mesh.enableUvs();
+    }
+    mesh.resizeVertices(vertices);
+    mesh.resizeTriangles(triangles);
+    in.array(mesh.px(), vertices);
+    in.array(mesh.py(), vertices);
+    in.array(mesh.pz(), vertices);
+    if ((flags & kNormals) != 0) {
+        in.array(mesh.nx(), vertices);
+        in.array(mesh.ny(), vertices);
+        in.array(mesh.nz(), vertices);
+    }
+    if ((flags & kUvs) != 0) {
+        in.array(mesh.u(), vertices);
+        in.array(mesh.v(), vertices);
+    }
+    in.array(mesh.corners(), triangles * 3);
+    if (!in.done()) {
+        in.fail("trailing bytes");
+    }
+    for (std::size_t c = 0; c < triangles * 3; ++c) {
+        if (mesh.corners()[c] >= vertices) {
+            in.fail("vertex index out of range");
+        }
+    }
+    if ((flags & kConnectivity) != 0) {
+        mesh.buildConnectivity();
+    }
+    return mesh;
+}
+
+} // namespace rebel::sync
@@ -0,0 +1,73 @@
+#include "rebel/sync/Hub.hpp"
+
+#include <utility>
+
+namespace rebel::sync {
+
+SharedMessage Hub::submit(const std::uint8_t* data, std::size_t size) {
+    ChangeSet changes = decodeChangeSet(data, size);
+    std::lock_guard<std::mutex> lock(mutex_);
+    changes.sequence = log_.size() + 1;
+    auto message = std::make_shared<const Message>(encode(changes));
+    log_.push_back(message);
+    ++stats_.changeSets;
+    stats_.changeSetBytes += message->size();
+    return message;
+}
+
+std::uint64_t Hub::sequence() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return log_.size();
+}
+
+std::vector<SharedMessage> Hub::since(std::uint64_t sequence) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (sequence >= log_.size()) {
+        return {};
+    }
+    return {log_.begin() + static_cast<std::ptrdiff_t>(sequence), log_.end()};
+}
+
+bool Hub::hasGeometry(const core::Hash128& hash) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return geometry_.count(hash) != 0;
+}
+
+std::vector<core::Hash128> Hub::missingGeometry(const std::vector<core::Hash128>& hashes) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<core::Hash128> missing;
+    for (const core::Hash128& hash : hashes) {
+        if (geometry_.count(hash) == 0) {
+            missing.push_back(hash);
+        }
+    }
+    return missing;
+}
+
+core::Hash128 Hub::putGeometry(const std::uint8_t* data, std::size_t size) {
+    // Hashed from the decoded arrays, so a site cannot file geometry under
+    // another address.
+    const core::Hash128 hash = geometryHash(decodeGeometry(data, size).view());
+    auto message = std::make_shared<const Message>(data, data + size);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!geometry_.emplace(hash, std::move(message)).second) {
+        ++stats_.duplicateGeometries;
+        return hash;
+    }
+    ++stats_.geometries;
+    stats_.geometryBytes += size;
+    return hash;
+}
+
+SharedMessage Hub::geometry(const core::Hash128& hash) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = geometry_.find(hash);
+    return it == geometry_.end() ? nullptr : it->second;
+}
+
+HubStats Hub::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+} // namespace rebel::sync
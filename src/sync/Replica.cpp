@@ -0,0 +1,342 @@
+#include "rebel/sync/Replica.hpp"
+
+#include "rebel/core/Trace.hpp"
+
+#include <stdexcept>
+#include <unordered_set>
+
+namespace rebel::sync {
+namespace {
+
+constexpr std::uint8_t kTransformMask = 0;
+constexpr std::uint8_t kOverridesMask = 1;
+
+bool sameOverrides(const assembly::Overrides& a, const assembly::Overrides& b) {
+    return a.flags == b.flags && a.colorRgba == b.colorRgba;
+}
+
+} // namespace
+
+Replica::Replica(SiteId site, assembly::Assembly& assembly, assembly::PartLibrary& library,
+                 feature::FeatureGraph* features, std::uint64_t sequence)
+    : site_(site), assembly_(assembly), library_(library), features_(features), sequence_(sequence),
+      received_(sequence), shadow_(assembly), documentNodes_(assembly.nodeCount()) {
+    if (site == 0) {
+        throw std::invalid_argument("site 0 is reserved for the opened document");
+    }
+    if (features_ != nullptr) {
+        for (feature::FeatureId f = 0; f < features_->size(); ++f) {
+            shadowParameters_.push_back(features_->parameters(f));
+        }
+    }
+}
+
+NodeKey Replica::key(assembly::NodeId node) const {
+    if (node < documentNodes_) {
+        return makeNodeKey(0, node);
+    }
+    return addedKeys_.at(node - documentNodes_);
+}
+
+assembly::NodeId Replica::node(NodeKey key) const {
+    if (key < documentNodes_) {
+        return static_cast<assembly::NodeId>(key);
+    }
+    const auto it = addedNodes_.find(key);
+    return it == addedNodes_.end() ? assembly::kInvalidNode : it->second;
+}
+
+assembly::NodeId Replica::live(NodeKey key) const {
+    const assembly::NodeId id = node(key);
+    return id != assembly::kInvalidNode && !assembly_.node(id).removed ? id : assembly::kInvalidNode;
+}
+
+void Replica::mask(Mask m) {
+    ++masks_[m];
+    outboxPending_.masks.push_back(m);
+}
+
+void Replica::mask(ParameterMask m) {
+    ++parameterMasks_[m];
+    outboxPending_.parameterMasks.push_back(std::move(m));
+}
+
+void Replica::release(const Pending& pending) {
+    for (const Mask& m : pending.masks) {
+        const auto it = masks_.find(m);
+        if (--it->second == 0) {
+            masks_.erase(it);
+        }
+    }
+    for (const ParameterMask& m : pending.parameterMasks) {
+        const auto it = parameterMasks_.find(m);
+        if (--it->second == 0) {
+            parameterMasks_.erase(it);
+        }
+    }
+}
+
+std::uint32_t Replica::partRef(assembly::PartId part) {
+    const auto known = outboxParts_.find(part);
+    if (known != outboxParts_.end()) {
+        return known->second;
+    }
+    assembly::PartPtr definition = library_.get(part);
+    auto it = partHashes_.find(definition.get());
+    if (it == partHashes_.end()) {
+        const core::Hash128 hash = geometryHash(definition->mesh());
+        it = partHashes_.emplace(definition.get(), std::make_pair(definition, hash)).first;
+        publishedGeometry_.emplace(hash, definition);
+    }
+    const auto index = static_cast<std::uint32_t>(outbox_.parts.size());
+    outbox_.parts.push_back({definition->name(), it->second.second});
+    outboxParts_.emplace(part, index);
+    return index;
+}
+
+void Replica::capture() {
+    REBEL_TRACE_ZONE("sync.capture");
+    std::vector<assembly::NodeId> added;
+    std::vector<assembly::NodeId> removed;
+    assembly_.forEachDifference(shadow_, [&](assembly::NodeId id, const assembly::AssemblyNode& mine,
+                                             const assembly::AssemblyNode* theirs) {
+        if (theirs == nullptr) {
+            added.push_back(id);
+            return;
+        }
+        if (theirs->removed) {
+            return;
+        }
+        if (mine.removed) {
+            // Only the top of a removed subtree goes out.
+            if (!assembly_.node(mine.parent).removed) {
+                removed.push_back(id);
+            }
+            return;
+        }
+        if (!(mine.local == theirs->local)) {
+            outbox_.operations.emplace_back(TransformOp{key(id), mine.local});
+            mask(Mask{key(id), kTransformMask});
+        }
+        if (!sameOverrides(mine.overrides, theirs->overrides)) {
+            outbox_.operations.emplace_back(OverridesOp{key(id), mine.overrides});
+            mask(Mask{key(id), kOverridesMask});
+        }
+    });
+
+    // Parents come before their children in id order.
+    for (const assembly::NodeId id : added) {
+        const NodeKey k = makeNodeKey(site_, nextNodeSerial_++);
+        addedKeys_.push_back(k);
+        addedNodes_.emplace(k, id);
+        const assembly::AssemblyNode& n = assembly_.node(id);
+        if (n.removed) {
+            continue;
+        }
+        AddNodeOp add;
+        add.node = k;
+        add.parent = key(n.parent);
+        add.part = n.isOccurrence() ? partRef(n.part) : kNoPart;
+        add.local = n.local;
+        add.name = assembly_.name(id);
+        outbox_.operations.emplace_back(std::move(add));
+        if (!(n.overrides.flags == 0 && n.overrides.colorRgba == 0)) {
+            outbox_.operations.emplace_back(OverridesOp{k, n.overrides});
+            mask(Mask{k, kOverridesMask});
+        }
+    }
+    for (const assembly::NodeId id : removed) {
+        outbox_.operations.emplace_back(RemoveNodeOp{key(id)});
+    }
+    shadow_ = assembly_;
+
+    if (features_ != nullptr) {
+        for (feature::FeatureId f = 0; f < shadowParameters_.size(); ++f) {
+            const feature::Parameters& current = features_->parameters(f);
+            feature::Parameters& previous = shadowParameters_[f];
+            if (current == previous) {
+                continue;
+            }
+            for (const auto& [name, value] : current.values()) {
+                if (!previous.has(name) || previous.get(name) != value) {
+                    outbox_.operations.emplace_back(ParameterOp{f, name, value});
+                    mask(ParameterMask{f, name});
+                }
+            }
+            previous = current;
+        }
+        // Features added here are not synchronized; track them from now on.
+        for (auto f = static_cast<feature::FeatureId>(shadowParameters_.size()); f < features_->size(); ++f) {
+            shadowParameters_.push_back(features_->parameters(f));
+        }
+    }
+}
+
+Publication Replica::publish() {
+    capture();
+    Publication publication;
+    if (outbox_.operations.empty()) {
+        return publication;
+    }
+    outbox_.site = site_;
+    outbox_.serial = nextChangeSerial_++;
+    publication.changeSet = encode(outbox_);
+    for (const PartRef& part : outbox_.parts) {
+        publication.geometry.push_back(part.geometry);
+    }
+    outboxPending_.serial = outbox_.serial;
+    inFlight_.push_back(std::move(outboxPending_));
+    outboxPending_ = {};
+    outbox_ = {};
+    outboxParts_.clear();
+    ++stats_.published;
+    stats_.publishedBytes += publication.changeSet.size();
+    return publication;
+}
+
+Message Replica::localGeometry(const core::Hash128& hash) const {
+    return encodeGeometry(publishedGeometry_.at(hash)->mesh());
+}
+
+void Replica::receive(const std::uint8_t* data, std::size_t size) {
+    ChangeSet changes = decodeChangeSet(data, size);
+    stats_.receivedBytes += size;
+    if (changes.sequence <= received_) {
+        return;
+    }
+    if (changes.sequence != received_ + 1) {
+        throw std::runtime_error("change set " + std::to_string(changes.sequence) + " arrived before " +
+                                 std::to_string(received_ + 1));
+    }
+    received_ = changes.sequence;
+    waiting_.push_back(std::move(changes));
+    applyWaiting();
+}
+
+bool Replica::resolvable(const ChangeSet& changes) const {
+    for (const PartRef& part : changes.parts) {
+        if (library_.find(part.name) == assembly::kInvalidPart && fetched_.count(part.geometry) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<core::Hash128> Replica::missingGeometry() const {
+    std::vector<core::Hash128> missing;
+    std::unordered_set<core::Hash128> listed;
+    for (const ChangeSet& changes : waiting_) {
+        if (changes.site == site_) {
+            continue;
+        }
+        for (const PartRef& part : changes.parts) {
+            if (library_.find(part.name) == assembly::kInvalidPart && fetched_.count(part.geometry) == 0 &&
+                listed.insert(part.geometry).second) {
+                missing.push_back(part.geometry);
+            }
+        }
+    }
+    return missing;
+}
+
+void Replica::provideGeometry(const std::uint8_t* data, std::size_t size) {
+    auto mesh = std::make_shared<const geometry::Mesh>(decodeGeometry(data, size));
+    fetched_.emplace(geometryHash(mesh->view()), std::move(mesh));
+    stats_.geometryBytes += size;
+    applyWaiting();
+}
+
+void Replica::applyWaiting() {
+    // Local edits go out first, so remote ones never mix with them in the
+    // shadow and pending values are masked.
+    capture();
+    bool changed = false;
+    while (!waiting_.empty()) {
+        ChangeSet& changes = waiting_.front();
+        if (changes.site == site_) {
+            if (inFlight_.empty() || inFlight_.front().serial != changes.serial) {
+                throw std::runtime_error("hub sent back a change set this site did not publish");
+            }
+            release(inFlight_.front());
+            inFlight_.pop_front();
+        } else {
+            if (!resolvable(changes)) {
+                break;
+            }
+            apply(changes);
+            changed = true;
+        }
+        sequence_ = changes.sequence;
+        waiting_.pop_front();
+    }
+    if (changed) {
+        shadow_ = assembly_;
+    }
+    if (waiting_.empty()) {
+        fetched_.clear();
+    }
+}
+
+void Replica::apply(const ChangeSet& changes) {
+    REBEL_TRACE_ZONE("sync.apply");
+    std::vector<assembly::PartId> parts;
+    parts.reserve(changes.parts.size());
+    for (const PartRef& ref : changes.parts) {
+        // Parts are matched by name, whatever detail they were loaded at
+        // here, like `NativeDocument::loadSubassembly` does.
+        assembly::PartId id = library_.find(ref.name);
+        if (id == assembly::kInvalidPart) {
+            id = library_.add(assembly::Part::create(ref.name, geometry::Mesh(*fetched_.at(ref.geometry))));
+        }
+        parts.push_back(id);
+    }
+
+    for (const Operation& op : changes.operations) {
+        if (const auto* add = std::get_if<AddNodeOp>(&op)) {
+            const assembly::NodeId parent = live(add->parent);
+            if (node(add->node) != assembly::kInvalidNode || parent == assembly::kInvalidNode ||
+                assembly_.node(parent).isOccurrence()) {
+                ++stats_.ignored;
+                continue;
+            }
+            const assembly::NodeId id =
+                add->part == kNoPart ? assembly_.addSubassembly(parent, add->local, add->name)
+                                     : assembly_.addOccurrence(parent, parts[add->part], add->local, add->name);
+            addedKeys_.push_back(add->node);
+            addedNodes_.emplace(add->node, id);
+        } else if (const auto* remove = std::get_if<RemoveNodeOp>(&op)) {
+            const assembly::NodeId id = live(remove->node);
+            if (id == assembly::kInvalidNode || id == assembly_.root()) {
+                ++stats_.ignored;
+                continue;
+            }
+            assembly_.remove(id);
+        } else if (const auto* transform = std::get_if<TransformOp>(&op)) {
+            const assembly::NodeId id = live(transform->node);
+            if (id == assembly::kInvalidNode || masks_.count({transform->node, kTransformMask}) != 0) {
+                ++stats_.ignored;
+                continue;
+            }
+            assembly_.setLocalTransform(id, transform->local);
+        } else if (const auto* overrides = std::get_if<OverridesOp>(&op)) {
+            const assembly::NodeId id = live(overrides->node);
+            if (id == assembly::kInvalidNode || masks_.count({overrides->node, kOverridesMask}) != 0) {
+                ++stats_.ignored;
+                continue;
+            }
+            assembly_.setOverrides(id, overrides->overrides);
+        } else {
+            const auto& parameter = std::get<ParameterOp>(op);
+            if (features_ == nullptr || parameter.feature >= shadowParameters_.size() ||
+                parameterMasks_.count({parameter.feature, parameter.name}) != 0) {
+                ++stats_.ignored;
+                continue;
+            }
+            features_->setParameter(parameter.feature, parameter.name, parameter.value);
+            shadowParameters_[parameter.feature].set(parameter.name, parameter.value);
+        }
+    }
+    ++stats_.applied;
+}
+
+} // namespace rebel::sync
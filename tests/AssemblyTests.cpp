@@ -0,0 +1,371 @@
+#include "Fixtures.hpp"
+#include "Test.hpp"
+
+#include "rebel/assembly/AssemblyIndex.hpp"
+#include "rebel/assembly/ClashDetector.hpp"
+#include "rebel/assembly/DistanceQuery.hpp"
+#include "rebel/assembly/MateSolver.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace rebel::test {
+
+namespace {
+
+using assembly::Clash;
+using assembly::Mate;
+using assembly::MateType;
+using math::Mat4f;
+using math::Vec3f;
+
+std::vector<std::tuple<assembly::NodeId, assembly::NodeId, assembly::ClashKind>> pairs(const std::vector<Clash>& c) {
+    std::vector<std::tuple<assembly::NodeId, assembly::NodeId, assembly::ClashKind>> result;
+    for (const Clash& clash : c) {
+        result.emplace_back(clash.a, clash.b, clash.kind);
+    }
+    return result;
+}
+
+void incrementalClashMatchesFull() {
+    assembly::PartLibrary library;
+    const assembly::PartId box = library.add(bodyPart("box", brep::makeBox({0, 0, 0}, {1, 1, 1})));
+    const assembly::PartId ball = library.add(bodyPart("ball", brep::makeSphere({0, 0, 0}, 0.6), 0.02));
+
+    // Unit boxes on a unit grid touch their neighbours face to face; the
+    // balls between them interfere with several each.
+    assembly::Assembly model;
+    std::vector<assembly::NodeId> nodes;
+    for (int x = 0; x < 5; ++x) {
+        for (int y = 0; y < 4; ++y) {
+            const Vec3f at{static_cast<float>(x), static_cast<float>(y), 0.0f};
+            nodes.push_back(model.addOccurrence(model.root(), box, Mat4f::translation(at)));
+            if ((x + y) % 3 == 0) {
+                nodes.push_back(model.addOccurrence(model.root(), ball, Mat4f::translation(at + Vec3f{1, 1, 1})));
+            }
+        }
+    }
+
+    assembly::AssemblyIndex index(model, library);
+    index.update();
+    assembly::ClashOptions options;
+    options.reportContacts = true;
+    assembly::ClashDetector incremental(index, options);
+    incremental.detectAll();
+
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<std::size_t> pick(0, nodes.size() - 1);
+    std::uniform_int_distribution<int> step(-2, 2);
+    bool sawInterference = false;
+    bool sawContact = false;
+    for (int round = 0; round < 25; ++round) {
+        // Half-unit steps move occurrences into and out of contact.
+        for (int k = 0; k < 3; ++k) {
+            const assembly::NodeId node = nodes[pick(rng)];
+            const Vec3f delta{0.5f * step(rng), 0.5f * step(rng), 0.5f * step(rng)};
+            model.setLocalTransform(node, Mat4f::translation(delta) * model.node(node).local);
+        }
+        const std::vector<Clash>& updated = incremental.update(index.update());
+        assembly::ClashDetector full(index, options);
+        REBEL_CHECK(pairs(updated) == pairs(full.detectAll()));
+        for (const Clash& c : updated) {
+            sawInterference = sawInterference || c.kind == assembly::ClashKind::Interference;
+            sawContact = sawContact || c.kind == assembly::ClashKind::Contact;
+        }
+    }
+    REBEL_CHECK(sawInterference && sawContact);
+}
+
+bool contains(const std::vector<assembly::NodeId>& nodes, assembly::NodeId node) {
+    return std::find(nodes.begin(), nodes.end(), node) != nodes.end();
+}
+
+void distancesOnKnownBoxes() {
+    assembly::PartLibrary library;
+    const assembly::PartId box = library.add(bodyPart("box", brep::makeBox({0, 0, 0}, {1, 1, 1})));
+    assembly::Assembly model;
+    auto add = [&](const Mat4f& local) { return model.addOccurrence(model.root(), box, local); };
+    const assembly::NodeId origin = add(Mat4f::identity());
+    const assembly::NodeId apart = add(Mat4f::translation({3, 0, 0}));
+    const assembly::NodeId diagonal = add(Mat4f::translation({3, 3, 3}));
+    // Turned a quarter about z, an edge points at `origin`.
+    const assembly::NodeId turned = add(Mat4f::translation({-1.5f, 0, 0}) * Mat4f::rotation({0, 0, 1}, 0.7853982f));
+    // Doubled in size, which the box gaps must account for.
+    const assembly::NodeId large = add(Mat4f::translation({0, -5, 0}) * Mat4f::scale({2, 2, 2}));
+    const assembly::NodeId stacked = add(Mat4f::translation({0, 0, 1}));
+    const assembly::NodeId inside = add(Mat4f::translation({0.4f, 0.4f, 0.4f}) * Mat4f::scale({0.2f, 0.2f, 0.2f}));
+    assembly::AssemblyIndex index(model, library);
+    index.update();
+
+    assembly::DistanceQuery exact(index);
+    const assembly::DistanceResult gap = exact.distance(apart, origin);
+    REBEL_CHECK(gap.a == origin && gap.b == apart && gap.distance == 2.0);
+    REBEL_CHECK(gap.pointA.x == 1.0 && gap.pointB.x == 3.0);
+    REBEL_CHECK(gap.triangleA != geometry::kInvalidIndex && gap.triangleB != geometry::kInvalidIndex);
+    struct Known {
+        assembly::NodeId a;
+        assembly::NodeId b;
+        double distance;
+    };
+    const double edge = 1.5 - std::sqrt(0.5);
+    const Known known[] = {
+        {origin, diagonal, std::sqrt(12.0)}, {origin, turned, edge}, {origin, large, 3.0}, {origin, stacked, 0.0},
+        {origin, inside, 0.4}, {turned, stacked, edge}, {large, inside, 3.4}, {apart, diagonal, std::sqrt(8.0)},
+    };
+    for (const Known& k : known) {
+        const assembly::DistanceResult r = exact.distance(k.a, k.b);
+        REBEL_CHECK(std::abs(r.distance - k.distance) < 1e-6);
+        REBEL_CHECK(std::abs(math::length(r.pointA - r.pointB) - r.distance) < 1e-9);
+    }
+
+    // Every pair, and the clearance query against it.
+    std::vector<assembly::NodeId> nodes = {origin, apart, diagonal, turned, large, stacked, inside};
+    std::vector<std::pair<assembly::NodeId, assembly::NodeId>> all;
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        for (std::size_t j = i + 1; j < nodes.size(); ++j) {
+            all.emplace_back(nodes[i], nodes[j]);
+        }
+    }
+    const std::vector<assembly::DistanceResult> measured = exact.distances(all);
+    REBEL_CHECK(measured.size() == all.size() && exact.stats().pairs == all.size());
+    for (const double clearance : {0.1, 1.0, 2.5}) {
+        std::vector<std::pair<assembly::NodeId, assembly::NodeId>> closer;
+        for (const assembly::DistanceResult& r : measured) {
+            if (r.distance < clearance) {
+                closer.emplace_back(r.a, r.b);
+            }
+        }
+        std::sort(closer.begin(), closer.end());
+        std::vector<std::pair<assembly::NodeId, assembly::NodeId>> found;
+        for (const assembly::DistanceResult& r : exact.closerThan(clearance)) {
+            REBEL_CHECK(r.distance < clearance);
+            found.emplace_back(r.a, r.b);
+        }
+        REBEL_CHECK(found == closer);
+    }
+    REBEL_CHECK(exact.closerThan(1.0).size() == 5);
+
+    // Approximate distances stay within their tolerance; pairs beyond the
+    // limit are not measured, and pairs under it are, however close.
+    assembly::DistanceOptions options;
+    options.absoluteTolerance = 0.05;
+    options.relativeTolerance = 0.1;
+    options.maxDistance = 2.5;
+    assembly::DistanceQuery approximate(index, options);
+    const std::vector<assembly::DistanceResult> bounded = approximate.distances(all);
+    for (std::size_t k = 0; k < all.size(); ++k) {
+        const double d = measured[k].distance;
+        if (d > 2.5) {
+            REBEL_CHECK(std::isinf(bounded[k].distance));
+        } else {
+            REBEL_CHECK(bounded[k].distance >= d - 1e-9 && bounded[k].distance <= d + 0.05 + 0.1 * d + 1e-9);
+        }
+    }
+    REBEL_CHECK(approximate.closerThan(1.0).size() == 5);
+
+    bool threw = false;
+    try {
+        exact.distance(model.root(), origin);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    REBEL_CHECK(threw);
+}
+
+void restoreReportsOverrides() {
+    assembly::PartLibrary library;
+    const assembly::PartId box = library.add(bodyPart("box", brep::makeBox({0, 0, 0}, {1, 1, 1})));
+    assembly::Assembly model;
+    const assembly::NodeId group = model.addSubassembly(model.root(), Mat4f::identity());
+    const assembly::NodeId a = model.addOccurrence(group, box, Mat4f::identity());
+    const assembly::NodeId b = model.addOccurrence(group, box, Mat4f::translation({2, 0, 0}));
+    const assembly::NodeId c = model.addOccurrence(model.root(), box, Mat4f::translation({4, 0, 0}));
+    assembly::AssemblyIndex index(model, library);
+    index.update();
+
+    const assembly::Assembly before = model;
+    assembly::Overrides red;
+    red.colorRgba = 0xff0000ffu;
+    red.flags = assembly::Overrides::kHasColor;
+    model.setOverrides(b, red);
+    assembly::Overrides hidden;
+    hidden.flags = assembly::Overrides::kHidden;
+    model.setOverrides(group, hidden);
+    std::vector<assembly::NodeId> updated = index.update();
+    REBEL_CHECK(contains(updated, a) && contains(updated, b) && !contains(updated, c));
+    const assembly::Assembly after = model;
+
+    // Undoing the override edits reports the nodes, not a structure change,
+    // and the index hands their occurrences on.
+    const std::uint64_t revision = model.revision();
+    model.restore(before);
+    REBEL_CHECK(model.revision() > revision && !model.structureChangedSince(revision));
+    std::vector<assembly::NodeId> changed;
+    model.changedSince(revision, changed);
+    REBEL_CHECK(contains(changed, b) && contains(changed, group) && !contains(changed, c));
+    REBEL_CHECK(model.node(b).overrides == assembly::Overrides{} && !model.node(group).overrides.hidden());
+    updated = index.update();
+    REBEL_CHECK(contains(updated, a) && contains(updated, b) && !contains(updated, c));
+
+    // Redoing reports them again; restoring an identical tree reports none.
+    model.restore(after);
+    REBEL_CHECK(model.node(b).overrides == red);
+    updated = index.update();
+    REBEL_CHECK(contains(updated, b) && !contains(updated, c));
+    model.restore(after);
+    REBEL_CHECK(index.update().empty());
+}
+
+/// How far `mate` is from holding, measured on the assembly's world
+/// transforms.
+float mateError(const assembly::Assembly& model, const Mate& mate) {
+    const Mat4f wa = model.worldTransform(mate.a.node);
+    const Mat4f wb = model.worldTransform(mate.b.node);
+    const Vec3f pa = wa.transformPoint(Vec3f(mate.a.point));
+    const Vec3f pb = wb.transformPoint(Vec3f(mate.b.point));
+    const Vec3f na = math::normalize(wa.transformVector(Vec3f(mate.a.direction)));
+    const Vec3f nb = math::normalize(wb.transformVector(Vec3f(mate.b.direction)));
+    const float parallel = math::length(math::cross(na, nb));
+    const auto offset = static_cast<float>(mate.value);
+    switch (mate.type) {
+    case MateType::Coincident:
+        return math::length(pb - pa);
+    case MateType::Distance:
+        return std::abs(math::length(pb - pa) - offset);
+    case MateType::Parallel:
+        return parallel;
+    case MateType::Planar:
+        return std::max(parallel, std::abs(math::dot(pb - pa, na) - offset));
+    case MateType::Concentric:
+        return std::max(parallel, math::length(math::cross(pb - pa, na)));
+    case MateType::Lock:
+        break;
+    }
+    return 0.0f;
+}
+
+Mate makeMate(MateType type, assembly::NodeId a, math::Vec3d pa, assembly::NodeId b, math::Vec3d pb,
+              double value = 0.0) {
+    Mate m;
+    m.type = type;
+    m.a = {a, pa, {0, 0, 1}};
+    m.b = {b, pb, {0, 0, 1}};
+    m.value = value;
+    return m;
+}
+
+void mateSolverConverges() {
+    // A fixed base with a pin seated in a hole, a chain of links hinged end
+    // to end with a locked pair at its end, and a free pair held apart.
+    assembly::Assembly model;
+    const assembly::NodeId base = model.addSubassembly(model.root(), Mat4f::identity(), "base");
+    auto place = [&](assembly::NodeId parent, Vec3f at, float turn) {
+        return model.addSubassembly(parent, Mat4f::translation(at) * Mat4f::rotation({1, 1, 0}, turn));
+    };
+    const assembly::NodeId pin = place(model.root(), {3, 1, 2}, 0.4f);
+    const assembly::NodeId link1 = place(model.root(), {5, 1, 0}, 0.3f);
+    const assembly::NodeId link2 = place(model.root(), {6, -1, 1}, -0.5f);
+    const assembly::NodeId link3 = place(model.root(), {7, 0, 0}, 0.2f);
+    const assembly::NodeId cap = place(link3, {1, 0, 0}, 0.0f);
+    const assembly::NodeId left = place(model.root(), {0, 8, 0}, 0.0f);
+    const assembly::NodeId right = place(model.root(), {0.5f, 8.2f, 0}, 0.7f);
+
+    assembly::MateSolver solver(model);
+    solver.setFixed(base);
+    std::vector<Mate> mates = {
+        makeMate(MateType::Concentric, pin, {0, 0, 0}, base, {1, 2, 0}),
+        makeMate(MateType::Planar, base, {0, 0, 1}, pin, {0, 0, 0}),
+        makeMate(MateType::Coincident, link1, {0, 0, 0}, base, {5, 0, 0}),
+        makeMate(MateType::Coincident, link1, {1, 0, 0}, link2, {0, 0, 0}),
+        makeMate(MateType::Parallel, link1, {}, link2, {}),
+        makeMate(MateType::Coincident, link2, {1, 0, 0}, link3, {0, 0, 0}),
+        makeMate(MateType::Parallel, link2, {}, link3, {}),
+        makeMate(MateType::Lock, link3, {}, cap, {}),
+        makeMate(MateType::Distance, left, {0, 0, 0}, right, {0, 0, 0}, 2.0),
+    };
+    for (const Mate& m : mates) {
+        solver.addMate(m);
+    }
+    const Mat4f capLocal = model.node(cap).local;
+    const math::Vec3f leftAt = model.worldTransform(left).transformPoint({});
+
+    const assembly::MateSolveResult solved = solver.solve();
+    REBEL_CHECK(solved.converged && solved.residual <= 1e-9);
+    REBEL_CHECK(solved.clusters == 6 && solved.components == 3 && solved.iterations > 0);
+    for (const Mate& m : mates) {
+        REBEL_CHECK(mateError(model, m) < 1e-4f);
+    }
+    REBEL_CHECK(model.worldTransform(base) == Mat4f::identity());
+    const Vec3f pinAt = model.worldTransform(pin).transformPoint({});
+    REBEL_CHECK(math::length(pinAt - Vec3f{1, 2, 1}) < 1e-4f);
+    // The lock keeps the cap where it was on its link; with nothing fixed
+    // the free pair only moves as far as it has to.
+    REBEL_CHECK(math::length(model.node(cap).local.transformPoint({}) - capLocal.transformPoint({})) < 1e-4f);
+    REBEL_CHECK(math::length(model.worldTransform(left).transformPoint({}) - leftAt) < 1.0f);
+
+    // Solving again starts from the solution.
+    const assembly::MateSolveResult again = solver.solve();
+    REBEL_CHECK(again.converged && again.iterations == 0);
+
+    // Dragging the first link re-solves only the chain: the pin keeps its
+    // exact placement and the chain follows the dragged link.
+    const Mat4f pinWorld = model.worldTransform(pin);
+    const Mat4f target = Mat4f::translation({5, 0, 3}) * Mat4f::rotation({0, 0, 1}, 1.0f);
+    const assembly::MateSolveResult dragged = solver.drag(link1, target);
+    REBEL_CHECK(dragged.converged && dragged.components == 1 && dragged.clusters == 2);
+    REBEL_CHECK(model.worldTransform(pin) == pinWorld);
+    const Vec3f heldAt = model.worldTransform(link1).transformPoint({});
+    REBEL_CHECK(math::length(heldAt - Vec3f{5, 0, 3}) < 1e-4f);
+    for (std::size_t i = 3; i < mates.size() - 1; ++i) {
+        REBEL_CHECK(mateError(model, mates[i]) < 1e-4f);
+    }
+    REBEL_CHECK(mateError(model, mates[2]) > 1.0f);
+}
+
+void mateSolverReportsConflicts() {
+    assembly::Assembly model;
+    const assembly::NodeId base = model.addSubassembly(model.root(), Mat4f::identity(), "base");
+    const assembly::NodeId block = model.addSubassembly(model.root(), Mat4f::translation({0.3f, 0, 0}), "block");
+    assembly::MateSolver solver(model);
+    solver.setFixed(base);
+    solver.addMate(makeMate(MateType::Coincident, block, {0, 0, 0}, base, {0, 0, 0}));
+    const assembly::MateId apart = solver.addMate(makeMate(MateType::Distance, block, {0, 0, 0}, base, {0, 0, 0}, 1));
+
+    // Both cannot hold; the solver settles between them and says so.
+    const assembly::MateSolveResult conflicting = solver.solve();
+    REBEL_CHECK(!conflicting.converged && conflicting.residual > 0.1);
+    solver.removeMate(apart);
+    REBEL_CHECK(solver.mateCount() == 1 && solver.solve().converged);
+    REBEL_CHECK(math::length(model.worldTransform(block).transformPoint({})) < 1e-6f);
+
+    auto throws = [](auto&& fn) {
+        try {
+            fn();
+        } catch (const std::logic_error&) {
+            return true;
+        }
+        return false;
+    };
+    Mate zero = makeMate(MateType::Parallel, block, {}, base, {});
+    zero.b.direction = {};
+    REBEL_CHECK(throws([&] { solver.addMate(zero); }));
+    REBEL_CHECK(throws([&] { solver.addMate(makeMate(MateType::Coincident, block, {}, block, {})); }));
+    REBEL_CHECK(throws([&] { solver.removeMate(apart); }));
+}
+
+} // namespace
+
+void registerAssemblyTests(Registry& registry) {
+    registry.add({"assembly.clash.incremental_matches_full", incrementalClashMatchesFull});
+    registry.add({"assembly.distance.known_boxes", distancesOnKnownBoxes});
+    registry.add({"assembly.mates.converges", mateSolverConverges});
+    registry.add({"assembly.mates.reports_conflicts", mateSolverReportsConflicts});
+    registry.add({"assembly.snapshot.restore_reports_overrides", restoreReportsOverrides});
+}
+
+} // namespace rebel::test
@@ -0,0 +1,110 @@
+#include "Fixtures.hpp"
+#include "Test.hpp"
+
+#include "rebel/boolean/MeshBoolean.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace rebel::test {
+
+namespace {
+
+using boolean::BooleanOp;
+using geometry::Mesh;
+
+/// Signed volume by the divergence theorem, in double.
+double volume(const Mesh& mesh) {
+    double sum = 0.0;
+    for (std::size_t t = 0; t < mesh.triangleCount(); ++t) {
+        const math::Vec3f a = mesh.position(mesh.vertex(static_cast<geometry::CornerIndex>(3 * t)));
+        const math::Vec3f b = mesh.position(mesh.vertex(static_cast<geometry::CornerIndex>(3 * t + 1)));
+        const math::Vec3f c = mesh.position(mesh.vertex(static_cast<geometry::CornerIndex>(3 * t + 2)));
+        sum += double(a.x) * (double(b.y) * c.z - double(b.z) * c.y) -
+               double(a.y) * (double(b.x) * c.z - double(b.z) * c.x) +
+               double(a.z) * (double(b.x) * c.y - double(b.y) * c.x);
+    }
+    return sum / 6.0;
+}
+
+/// Every edge is used exactly once in each direction.
+bool closed(Mesh mesh) {
+    if (mesh.triangleCount() == 0 || mesh.buildConnectivity() != 0) {
+        return false;
+    }
+    const geometry::MeshView view = mesh.view();
+    for (std::size_t c = 0; c < 3 * view.triangleCount; ++c) {
+        if (view.opposites[c] == geometry::kInvalidIndex) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool near(double value, double expected, double tolerance = 1e-5) {
+    return std::abs(value - expected) <= tolerance * std::max(1.0, std::abs(expected));
+}
+
+struct Results {
+    Mesh unite;
+    Mesh intersect;
+    Mesh subtract;
+};
+
+Results allOps(const Mesh& a, const Mesh& b) {
+    return {boolean::meshBoolean(a.view(), b.view(), BooleanOp::Union),
+            boolean::meshBoolean(a.view(), b.view(), BooleanOp::Intersection),
+            boolean::meshBoolean(a.view(), b.view(), BooleanOp::Difference)};
+}
+
+void overlappingBoxes() {
+    const Mesh a = bodyMesh(brep::makeBox({0, 0, 0}, {2, 2, 2}));
+    const Mesh b = bodyMesh(brep::makeBox({1, 1, 1}, {3, 3, 3}));
+    const Results r = allOps(a, b);
+    REBEL_CHECK(closed(r.unite) && closed(r.intersect) && closed(r.subtract));
+    REBEL_CHECK(near(volume(r.unite), 15.0));
+    REBEL_CHECK(near(volume(r.intersect), 1.0));
+    REBEL_CHECK(near(volume(r.subtract), 7.0));
+}
+
+void coplanarAndTouchingBoxes() {
+    // Shares three coplanar faces with the first box, overlapping it in half.
+    const Mesh a = bodyMesh(brep::makeBox({0, 0, 0}, {2, 2, 2}));
+    const Mesh b = bodyMesh(brep::makeBox({1, 0, 0}, {3, 2, 2}));
+    const Results r = allOps(a, b);
+    REBEL_CHECK(closed(r.unite) && closed(r.intersect) && closed(r.subtract));
+    REBEL_CHECK(near(volume(r.unite), 12.0));
+    REBEL_CHECK(near(volume(r.intersect), 4.0));
+    REBEL_CHECK(near(volume(r.subtract), 4.0));
+
+    // Face to face: the union is one solid, the touching faces removed.
+    const Mesh c = bodyMesh(brep::makeBox({2, 0, 0}, {4, 2, 2}));
+    const Mesh joined = boolean::meshBoolean(a.view(), c.view(), BooleanOp::Union);
+    REBEL_CHECK(closed(joined));
+    REBEL_CHECK(near(volume(joined), 16.0));
+    REBEL_CHECK(joined.triangleCount() < a.triangleCount() + c.triangleCount());
+}
+
+void curvedOperands() {
+    // The volume of a tessellated sphere is only approximately known, but
+    // the three results must add up exactly like the solids do.
+    const Mesh a = bodyMesh(brep::makeBox({-1, -1, -1}, {1, 1, 1}));
+    const Mesh b = bodyMesh(brep::makeSphere({1, 0.5, 0.25}, 1.2), 0.005);
+    const Results r = allOps(a, b);
+    REBEL_CHECK(closed(r.unite) && closed(r.intersect) && closed(r.subtract));
+    const double va = volume(a);
+    const double vb = volume(b);
+    REBEL_CHECK(near(volume(r.unite) + volume(r.intersect), va + vb));
+    REBEL_CHECK(near(volume(r.subtract), va - volume(r.intersect)));
+    REBEL_CHECK(volume(r.intersect) > 0.0 && volume(r.intersect) < std::min(va, vb));
+}
+
+} // namespace
+
+void registerBooleanTests(Registry& registry) {
+    registry.add({"boolean.mesh.overlapping_boxes", overlappingBoxes});
+    registry.add({"boolean.mesh.coplanar_and_touching_boxes", coplanarAndTouchingBoxes});
+    registry.add({"boolean.mesh.curved_operands", curvedOperands});
+}
+
+} // namespace rebel::test
@@ -0,0 +1,331 @@
+#include "Test.hpp"
+
+#include "rebel/brep/Nurbs.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace rebel::test {
+
+namespace {
+
+using brep::KnotVector;
+using brep::NurbsCurve;
+using brep::NurbsSurface;
+using math::Vec2d;
+using math::Vec3d;
+
+using Homogeneous = std::array<double, 4>;
+
+Homogeneous homogeneous(const Vec3d& p, double w) {
+    return {p.x * w, p.y * w, p.z * w, w};
+}
+
+Vec3d project(const Homogeneous& h) {
+    return {h[0] / h[3], h[1] / h[3], h[2] / h[3]};
+}
+
+/// Reference evaluation by de Boor's algorithm on homogeneous points, with
+/// its own span search: the last `k` in the domain with
+/// `knots[k] <= t < knots[k + 1]`, the end of the domain falling in the
+/// last non-empty span.
+Homogeneous deBoor(unsigned p, const std::vector<double>& knots, const std::vector<Homogeneous>& points, double t) {
+    const std::size_t n = points.size();
+    std::size_t k = p;
+    for (std::size_t s = p; s < n; ++s) {
+        if (knots[s] < knots[s + 1] && knots[s] <= t) {
+            k = s;
+        }
+    }
+    std::vector<Homogeneous> d(points.begin() + static_cast<std::ptrdiff_t>(k - p),
+                               points.begin() + static_cast<std::ptrdiff_t>(k + 1));
+    for (unsigned r = 1; r <= p; ++r) {
+        for (unsigned j = p; j >= r; --j) {
+            const double lo = knots[j + k - p];
+            const double alpha = (t - lo) / (knots[j + 1 + k - r] - lo);
+            for (int c = 0; c < 4; ++c) {
+                d[j][c] = (1.0 - alpha) * d[j - 1][c] + alpha * d[j][c];
+            }
+        }
+    }
+    return d[p];
+}
+
+/// Tensor-product de Boor: each row of the net along u, then the rows
+/// along v.
+Vec3d deBoorSurface(unsigned pu, const std::vector<double>& uKnots, unsigned pv, const std::vector<double>& vKnots,
+                    const std::vector<Homogeneous>& net, std::size_t uCount, double u, double v) {
+    std::vector<Homogeneous> column;
+    for (std::size_t j = 0; j < net.size() / uCount; ++j) {
+        const std::vector<Homogeneous> row(net.begin() + static_cast<std::ptrdiff_t>(j * uCount),
+                                           net.begin() + static_cast<std::ptrdiff_t>((j + 1) * uCount));
+        column.push_back(deBoor(pu, uKnots, row, u));
+    }
+    return project(deBoor(pv, vKnots, column, v));
+}
+
+bool near(const Vec3d& a, const Vec3d& b, double tolerance) {
+    return math::length(a - b) <= tolerance;
+}
+
+/// Parameters across the domain, including every knot and both ends.
+std::vector<double> parameters(const std::vector<double>& knots, unsigned p, std::mt19937& rng) {
+    const double lo = knots[p];
+    const double hi = knots[knots.size() - p - 1];
+    std::uniform_real_distribution<double> inside(lo, hi);
+    std::vector<double> t;
+    for (std::size_t s = p; s < knots.size() - p; ++s) {
+        t.push_back(knots[s]);
+    }
+    for (int i = 0; i < 60; ++i) {
+        t.push_back(inside(rng));
+    }
+    return t;
+}
+
+void curveMatchesDeBoor() {
+    // Cubic, unclamped, with a double interior knot and uneven weights.
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> coord(-2.0, 2.0);
+    std::uniform_real_distribution<double> weight(0.3, 3.0);
+    const std::vector<double> knots = {-1.0, -0.5, 0.0, 0.25, 1.0, 1.0, 1.5, 2.5, 3.0, 3.25, 4.0, 4.5};
+    std::vector<Vec3d> points;
+    std::vector<double> weights;
+    std::vector<Homogeneous> net;
+    for (std::size_t i = 0; i < knots.size() - 4; ++i) {
+        points.push_back({coord(rng), coord(rng), coord(rng)});
+        weights.push_back(weight(rng));
+        net.push_back(homogeneous(points.back(), weights.back()));
+    }
+    const NurbsCurve curve(KnotVector(3, knots), points, weights);
+    REBEL_CHECK(curve.knots().first() == 0.25 && curve.knots().last() == 3.0);
+
+    std::vector<double> t = parameters(knots, 3, rng);
+    std::vector<Vec3d> batch(t.size());
+    std::vector<Vec3d> tangents(t.size());
+    for (bool sorted : {false, true}) {
+        if (sorted) {
+            std::sort(t.begin(), t.end());
+        }
+        curve.evaluate(t.data(), t.size(), batch.data(), tangents.data());
+        for (std::size_t i = 0; i < t.size(); ++i) {
+            const Vec3d expected = project(deBoor(3, knots, net, t[i]));
+            REBEL_CHECK(near(curve.point(t[i]), expected, 1e-12));
+            REBEL_CHECK(near(batch[i], expected, 1e-12));
+            // The double knot leaves the curve C1, so central differences
+            // hold everywhere inside.
+            const double h = 1e-6;
+            const double a = std::max(t[i] - h, 0.25);
+            const double b = std::min(t[i] + h, 3.0);
+            const Vec3d step = project(deBoor(3, knots, net, b)) - project(deBoor(3, knots, net, a));
+            const Vec3d slope = step * (1.0 / (b - a));
+            REBEL_CHECK(near(tangents[i], slope, 1e-4 * std::max(1.0, math::length(slope))));
+        }
+    }
+
+    // Outside the domain evaluation clamps.
+    const double outside[] = {-3.0, 7.0};
+    Vec3d clamped[2];
+    curve.evaluate(outside, 2, clamped);
+    REBEL_CHECK(near(clamped[0], curve.point(0.25), 1e-12) && near(clamped[1], curve.point(3.0), 1e-12));
+}
+
+void circleIsExact() {
+    // Quadratic rational quarter arcs: every point lies on the unit circle.
+    const double w = std::sqrt(0.5);
+    const std::vector<Vec3d> points = {{1, 0, 0}, {1, 1, 0}, {0, 1, 0}, {-1, 1, 0}, {-1, 0, 0},
+                                       {-1, -1, 0}, {0, -1, 0}, {1, -1, 0}, {1, 0, 0}};
+    const NurbsCurve circle(KnotVector(2, {0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 4}), points, {1, w, 1, w, 1, w, 1, w, 1});
+    for (int i = 0; i <= 400; ++i) {
+        const double t = 4.0 * i / 400.0;
+        REBEL_CHECK(std::abs(math::length(circle.point(t)) - 1.0) < 1e-14);
+    }
+    REBEL_CHECK(near(circle.point(1.0), {0, 1, 0}, 1e-15) && near(circle.point(0.5), {w, w, 0}, 1e-15));
+}
+
+struct SurfaceFixture {
+    std::vector<double> uKnots = {0, 0, 0, 0.4, 0.4, 1, 1.7, 2, 2, 2};
+    std::vector<double> vKnots = {-1, -0.5, 0, 0.5, 1.5, 2, 2.5, 3};
+    std::size_t uCount = uKnots.size() - 3;
+    std::size_t vCount = vKnots.size() - 4;
+    std::vector<Homogeneous> net;
+    NurbsSurface surface;
+
+    explicit SurfaceFixture(std::mt19937& rng) : surface(make(rng)) {}
+
+    NurbsSurface make(std::mt19937& rng) {
+        // Degree 2 clamped in u with a double knot, degree 3 unclamped in
+        // v; a wavy height field with uneven weights.
+        std::uniform_real_distribution<double> bump(-0.4, 0.4);
+        std::uniform_real_distribution<double> weight(0.5, 2.0);
+        std::vector<Vec3d> points;
+        std::vector<double> weights;
+        for (std::size_t j = 0; j < vCount; ++j) {
+            for (std::size_t i = 0; i < uCount; ++i) {
+                const double x = static_cast<double>(i) + bump(rng);
+                const double y = static_cast<double>(j) + bump(rng);
+                points.push_back({x, y, 2.0 * bump(rng)});
+                weights.push_back(weight(rng));
+                net.push_back(homogeneous(points.back(), weights.back()));
+            }
+        }
+        return NurbsSurface(KnotVector(2, uKnots), KnotVector(3, vKnots), points, weights);
+    }
+
+    Vec3d reference(double u, double v) const { return deBoorSurface(2, uKnots, 3, vKnots, net, uCount, u, v); }
+};
+
+void surfaceMatchesDeBoor() {
+    std::mt19937 rng(5);
+    const SurfaceFixture f(rng);
+    const NurbsSurface& s = f.surface;
+    const std::vector<double> u = parameters(f.uKnots, 2, rng);
+    const std::vector<double> v = parameters(f.vKnots, 3, rng);
+
+    std::vector<Vec2d> uv;
+    for (std::size_t i = 0; i < u.size(); ++i) {
+        for (std::size_t j = i % 3; j < v.size(); j += 3) {
+            uv.push_back({u[i], v[j]});
+        }
+    }
+    std::vector<Vec3d> points(uv.size()), du(uv.size()), dv(uv.size()), normals(uv.size());
+    brep::SurfaceSamples samples;
+    samples.points = points.data();
+    samples.du = du.data();
+    samples.dv = dv.data();
+    samples.normals = normals.data();
+    s.evaluate(uv.data(), uv.size(), samples);
+    const double h = 1e-6;
+    for (std::size_t k = 0; k < uv.size(); ++k) {
+        const Vec3d expected = f.reference(uv[k].x, uv[k].y);
+        REBEL_CHECK(near(s.point(uv[k].x, uv[k].y), expected, 1e-12));
+        REBEL_CHECK(near(points[k], expected, 1e-12));
+        const brep::SurfaceDerivatives d = s.derivatives(uv[k].x, uv[k].y);
+        REBEL_CHECK(near(d.point, expected, 1e-12));
+        REBEL_CHECK(near(d.du, du[k], 1e-9) && near(d.dv, dv[k], 1e-9));
+
+        // Derivatives against central differences, away from the double
+        // knot in u, where the surface is only C0; the v domain is
+        // [0.5, 1.5].
+        const double ua = std::max(uv[k].x - h, 0.0), ub = std::min(uv[k].x + h, 2.0);
+        const double va = std::max(uv[k].y - h, 0.5), vb = std::min(uv[k].y + h, 1.5);
+        if (std::abs(uv[k].x - 0.4) > 2 * h) {
+            const Vec3d slope = (f.reference(ub, uv[k].y) - f.reference(ua, uv[k].y)) * (1.0 / (ub - ua));
+            REBEL_CHECK(near(du[k], slope, 1e-4 * std::max(1.0, math::length(slope))));
+            const Vec3d bend = (s.derivatives(ub, uv[k].y).du - s.derivatives(ua, uv[k].y).du) * (1.0 / (ub - ua));
+            // Second derivatives jump at every interior knot in u.
+            if (std::abs(uv[k].x - 0.4) > 1e-3 && std::abs(uv[k].x - 1.0) > 1e-3 && std::abs(uv[k].x - 1.7) > 1e-3) {
+                REBEL_CHECK(near(d.duu, bend, 1e-3 * std::max(1.0, math::length(bend))));
+            }
+        }
+        const Vec3d slope = (f.reference(uv[k].x, vb) - f.reference(uv[k].x, va)) * (1.0 / (vb - va));
+        REBEL_CHECK(near(dv[k], slope, 1e-4 * std::max(1.0, math::length(slope))));
+        const Vec3d twist = (s.derivatives(uv[k].x, vb).du - s.derivatives(uv[k].x, va).du) * (1.0 / (vb - va));
+        REBEL_CHECK(near(d.duv, twist, 1e-3 * std::max(1.0, math::length(twist))));
+        const Vec3d n = math::normalize(math::cross(du[k], dv[k]));
+        REBEL_CHECK(near(normals[k], n, 1e-9));
+    }
+
+    // Grids agree with scattered samples.
+    std::vector<Vec3d> grid(u.size() * v.size()), gridNormals(grid.size());
+    s.evaluateGrid(u.data(), u.size(), v.data(), v.size(), grid.data(), gridNormals.data());
+    for (std::size_t j = 0; j < v.size(); ++j) {
+        for (std::size_t i = 0; i < u.size(); ++i) {
+            REBEL_CHECK(near(grid[j * u.size() + i], f.reference(u[i], v[j]), 1e-12));
+            REBEL_CHECK(near(gridNormals[j * u.size() + i], s.normal(u[i], v[j]), 1e-9));
+        }
+    }
+}
+
+void closestPointFindsNearest() {
+    // On a quarter cylinder of radius 1 about z, the nearest point to
+    // (r cos a, r sin a, z) is (cos a, sin a, z), at distance |r - 1|.
+    const double w = std::sqrt(0.5);
+    const std::vector<Vec3d> cylinder = {{1, 0, -1}, {1, 1, -1}, {0, 1, -1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}};
+    const NurbsSurface quarter(KnotVector(2, {0, 0, 0, 1, 1, 1}), KnotVector(1, {0, 0, 1, 1}), cylinder,
+                               {1, w, 1, 1, w, 1});
+    for (const double r : {0.2, 0.9, 1.5, 4.0}) {
+        for (const double a : {0.1, 0.5, 1.2}) {
+            const Vec3d query{r * std::cos(a), r * std::sin(a), 0.3};
+            const brep::SurfaceClosestPoint c = quarter.closestPoint(query);
+            REBEL_CHECK(std::abs(c.distance - std::abs(r - 1.0)) < 1e-9);
+            REBEL_CHECK(near(c.point, {std::cos(a), std::sin(a), 0.3}, 1e-9));
+            REBEL_CHECK(near(quarter.point(c.uv.x, c.uv.y), c.point, 1e-12) && std::abs(c.uv.y - 0.65) < 1e-9);
+        }
+    }
+    // Beyond the edge the nearest point is on the boundary.
+    const brep::SurfaceClosestPoint edge = quarter.closestPoint({2.0, -1.0, 3.0});
+    REBEL_CHECK(near(edge.point, {1, 0, 1}, 1e-9) && std::abs(edge.distance - std::sqrt(6.0)) < 1e-9);
+
+    // On the wavy surface nothing a dense sampling finds is nearer, and the
+    // batch agrees with single queries.
+    std::mt19937 rng(3);
+    const SurfaceFixture f(rng);
+    std::vector<Vec3d> samples;
+    const int n = 300;
+    for (int j = 0; j <= n; ++j) {
+        for (int i = 0; i <= n; ++i) {
+            samples.push_back(f.surface.point(2.0 * i / n, 0.5 + 1.0 * j / n));
+        }
+    }
+    std::uniform_real_distribution<double> spread(-1.0, 6.0);
+    std::vector<Vec3d> queries;
+    for (int k = 0; k < 40; ++k) {
+        queries.push_back({spread(rng), spread(rng), 0.5 * spread(rng)});
+    }
+    std::vector<brep::SurfaceClosestPoint> found(queries.size());
+    f.surface.closestPoints(queries.data(), queries.size(), found.data());
+    for (std::size_t k = 0; k < queries.size(); ++k) {
+        double sampled = 1e300;
+        for (const Vec3d& p : samples) {
+            sampled = std::min(sampled, math::length(p - queries[k]));
+        }
+        REBEL_CHECK(found[k].distance <= sampled + 1e-9);
+        REBEL_CHECK(std::abs(found[k].distance - math::length(found[k].point - queries[k])) < 1e-12);
+        REBEL_CHECK(near(f.surface.point(found[k].uv.x, found[k].uv.y), found[k].point, 1e-12));
+        REBEL_CHECK(found[k].distance == f.surface.closestPoint(queries[k]).distance);
+    }
+}
+
+void knotVectorValidates() {
+    auto rejects = [](unsigned degree, std::vector<double> knots) {
+        try {
+            KnotVector k(degree, std::move(knots));
+        } catch (const std::invalid_argument&) {
+            return true;
+        }
+        return false;
+    };
+    REBEL_CHECK(rejects(2, {0, 0, 0, 1, 0.5, 1, 1}));
+    REBEL_CHECK(rejects(2, {0, 0, 0, 1, 1}));
+    REBEL_CHECK(rejects(1, {0, 1, 1, 1}));
+    REBEL_CHECK(rejects(8, std::vector<double>(18, 0.0)));
+    REBEL_CHECK(!rejects(1, {0, 0, 1, 1}));
+
+    // Span lookups with and without a hint agree, also at the ends.
+    const KnotVector k(2, {0, 0, 0, 0.5, 0.5, 1, 2, 2, 3, 3, 3});
+    for (int i = -5; i <= 65; ++i) {
+        const double t = i / 20.0;
+        for (std::uint32_t hint = 2; hint < k.controlCount(); ++hint) {
+            REBEL_CHECK(k.span(t, hint) == k.span(t));
+        }
+    }
+    REBEL_CHECK(k.span(3.0) == 7 && k.span(0.5) == 4 && k.span(2.0) == 7);
+}
+
+} // namespace
+
+void registerBrepTests(Registry& registry) {
+    registry.add({"brep.nurbs.curve_matches_de_boor", curveMatchesDeBoor});
+    registry.add({"brep.nurbs.circle_is_exact", circleIsExact});
+    registry.add({"brep.nurbs.surface_matches_de_boor", surfaceMatchesDeBoor});
+    registry.add({"brep.nurbs.closest_point_finds_nearest", closestPointFindsNearest});
+    registry.add({"brep.nurbs.knot_vector_validates", knotVectorValidates});
+}
+
+} // namespace rebel::test
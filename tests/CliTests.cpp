@@ -0,0 +1,109 @@
+#include "Fixtures.hpp"
+#include "Test.hpp"
+
+#include "Session.hpp"
+
+#include "rebel/io/NativeFile.hpp"
+
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace rebel::test {
+
+namespace {
+
+using core::Json;
+
+/// Runs `job` and checks it succeeded.
+Json run(cli::Session& session, Json job) {
+    Json result = session.run(job);
+    if (!result["ok"].asBool()) {
+        fail(__FILE__, __LINE__, "job failed: " + result.dump());
+    }
+    return result;
+}
+
+Json job(const char* op, const std::string& model) {
+    Json j = Json::object();
+    j["op"] = op;
+    j["model"] = model;
+    return j;
+}
+
+std::size_t count(const Json& result, std::string_view key) { return static_cast<std::size_t>(result[key].asNumber()); }
+
+void sharedPartIdsKeepTheirMeshes() {
+    // One native file with two overlapping spheres: the stored part, a
+    // coarser level of detail and the B-rep all tessellate differently.
+    TempDirectory directory;
+    const std::string path = directory.file("spheres.rbl");
+    const brep::Body sphere = brep::makeSphere({0, 0, 0}, 1.0);
+    const assembly::PartPtr stored = bodyPart("sphere", sphere, 0.05);
+    const assembly::PartPtr lod = bodyPart("sphere", sphere, 0.2);
+    const std::size_t storedTriangles = stored->mesh().triangleCount;
+    const std::size_t lodTriangles = lod->mesh().triangleCount;
+    {
+        assembly::PartLibrary library;
+        const assembly::PartId id = library.add(stored);
+        assembly::Assembly model;
+        model.addOccurrence(model.root(), id, math::Mat4f::identity());
+        model.addOccurrence(model.root(), id, math::Mat4f::translation({1.5f, 0, 0}));
+        io::NativeWriter writer;
+        writer.addPart(stored, &sphere, {lod});
+        writer.setAssembly(model, library);
+        writer.write(path);
+    }
+
+    // `a` installs a fine tessellation in library `la`. `b` opens the same
+    // file graphics-only into `lb`, where the sphere has the same part id;
+    // `c` does so into `la`, next to `a`.
+    cli::Session session;
+    auto open = [&](const char* model, const char* library, bool graphics) {
+        Json j = job("open", model);
+        j["library"] = library;
+        j["input"] = path;
+        j["graphics"] = graphics;
+        run(session, j);
+    };
+    open("a", "la", false);
+    Json tessellate = job("tessellate", "a");
+    tessellate["chordalTolerance"] = 0.005;
+    tessellate["levels"] = 1;
+    const std::size_t fine = count(run(session, tessellate), "triangles");
+    REBEL_CHECK(fine != storedTriangles && fine != lodTriangles);
+    open("b", "lb", true);
+    open("c", "la", true);
+
+    auto exportStl = [&](const char* model) {
+        Json j = job("export", model);
+        j["output"] = directory.file(std::string(model) + ".stl");
+        return run(session, j);
+    };
+    auto clash = [&](const char* model) { return run(session, job("clash", model)); };
+    const Json before = clash("a");
+    REBEL_CHECK(count(before, "interferences") == 1);
+    REBEL_CHECK(count(exportStl("a"), "triangles") == 2 * fine);
+
+    // `b` has nothing installed in its own library, so its part comes in
+    // full; `a`'s tessellation in the other library does not count.
+    Json b = exportStl("b");
+    REBEL_CHECK(count(b, "promoted") == 1 && count(b, "triangles") == 2 * storedTriangles);
+
+    // `c` shares `a`'s tessellation instead of promoting over it.
+    Json c = exportStl("c");
+    REBEL_CHECK(count(c, "promoted") == 0 && count(c, "triangles") == 2 * fine);
+
+    REBEL_CHECK(count(exportStl("a"), "triangles") == 2 * fine);
+    REBEL_CHECK(count(clash("a"), "trianglePairs") == count(before, "trianglePairs"));
+    b = exportStl("b");
+    REBEL_CHECK(count(b, "triangles") == 2 * storedTriangles);
+}
+
+} // namespace
+
+void registerCliTests(Registry& registry) {
+    registry.add({"cli.session.shared_part_ids_keep_their_meshes", sharedPartIdsKeepTheirMeshes});
+}
+
+} // namespace rebel::test
@@ -0,0 +1,536 @@
+#include "Test.hpp"
+
+#include "rebel/core/Arena.hpp"
+#include "rebel/core/MemoryBudget.hpp"
+#include "rebel/core/PersistentVector.hpp"
+#include "rebel/core/TaskScheduler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace rebel::test {
+
+namespace {
+
+using core::ArenaPool;
+using core::ArenaScope;
+using core::ArenaSet;
+using core::CancellationToken;
+using core::MemoryBudget;
+using core::MonotonicArena;
+using core::PersistentVector;
+using core::TaskGroup;
+using core::TaskScheduler;
+
+/// Runs a test on a global scheduler of `threadCount` workers, restoring
+/// the previous size afterwards.
+class GlobalThreadsScope {
+public:
+    explicit GlobalThreadsScope(unsigned threadCount) : previous_(TaskScheduler::global().threadCount()) {
+        TaskScheduler::setGlobalThreadCount(threadCount);
+    }
+    ~GlobalThreadsScope() { TaskScheduler::setGlobalThreadCount(previous_); }
+
+    GlobalThreadsScope(const GlobalThreadsScope&) = delete;
+    GlobalThreadsScope& operator=(const GlobalThreadsScope&) = delete;
+
+private:
+    unsigned previous_;
+};
+
+/// Appends its id to `log` when destroyed.
+struct Tracked {
+    Tracked(std::vector<int>* l, int i) : log(l), id(i) {}
+    ~Tracked() { log->push_back(id); }
+
+    std::vector<int>* log;
+    int id;
+};
+
+struct ThrowsOnConstruction {
+    explicit ThrowsOnConstruction(std::vector<int>* l) : log(l) { throw std::runtime_error("constructor failed"); }
+    ~ThrowsOnConstruction() { log->push_back(-1); }
+
+    std::vector<int>* log;
+};
+
+void markerRollback() {
+    MonotonicArena arena(1024);
+    arena.allocate(100);
+    const MonotonicArena::Marker marker = arena.mark();
+    const std::size_t used = arena.bytesUsed();
+
+    // Spill over several blocks so the rollback has to rewind across them.
+    std::vector<void*> first;
+    for (int i = 0; i < 8; ++i) {
+        first.push_back(arena.allocate(600));
+    }
+    const std::size_t reserved = arena.bytesReserved();
+    REBEL_CHECK(reserved >= 8 * 600);
+    REBEL_CHECK(arena.bytesUsed() > used);
+
+    arena.rollback(marker);
+    REBEL_CHECK(arena.bytesUsed() == used);
+    REBEL_CHECK(arena.bytesReserved() == reserved);
+
+    // The same sequence lands on the same memory without new blocks.
+    for (int i = 0; i < 8; ++i) {
+        REBEL_CHECK(arena.allocate(600) == first[static_cast<std::size_t>(i)]);
+    }
+    REBEL_CHECK(arena.bytesReserved() == reserved);
+
+    // Scopes nest and also roll back when unwinding.
+    arena.rollback(marker);
+    try {
+        const ArenaScope outer(arena);
+        arena.allocate(300);
+        {
+            const ArenaScope inner(arena);
+            arena.allocate(2000);
+        }
+        REBEL_CHECK(arena.bytesUsed() == used + 300);
+        throw std::runtime_error("abandoned");
+    } catch (const std::runtime_error&) {
+    }
+    REBEL_CHECK(arena.bytesUsed() == used);
+
+    const auto* wide = arena.allocateArray<double>(3);
+    REBEL_CHECK(reinterpret_cast<std::uintptr_t>(wide) % alignof(double) == 0);
+    REBEL_CHECK(reinterpret_cast<std::uintptr_t>(arena.allocate(8, 256)) % 256 == 0);
+
+    arena.reset();
+    REBEL_CHECK(arena.bytesUsed() == 0 && arena.bytesReserved() > 0);
+    arena.release();
+    REBEL_CHECK(arena.bytesReserved() == 0);
+}
+
+void destructorOrder() {
+    std::vector<int> log;
+    {
+        MonotonicArena arena(1024);
+        arena.create<Tracked>(&log, 1);
+        arena.create<Tracked>(&log, 2);
+        const MonotonicArena::Marker marker = arena.mark();
+        for (int id = 3; id <= 40; ++id) {
+            arena.create<Tracked>(&log, id);
+        }
+        REBEL_CHECK(log.empty());
+
+        arena.rollback(marker);
+        REBEL_CHECK(log.size() == 38);
+        for (std::size_t i = 0; i < log.size(); ++i) {
+            REBEL_CHECK(log[i] == 40 - static_cast<int>(i));
+        }
+
+        // A constructor that throws leaves nothing to destroy.
+        log.clear();
+        bool threw = false;
+        try {
+            arena.create<ThrowsOnConstruction>(&log);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        REBEL_CHECK(threw);
+
+        arena.create<Tracked>(&log, 5);
+        arena.reset();
+        REBEL_CHECK((log == std::vector<int>{5, 2, 1}));
+
+        log.clear();
+        arena.create<Tracked>(&log, 7);
+    }
+    // The destructor runs what is left.
+    REBEL_CHECK((log == std::vector<int>{7}));
+}
+
+void poolReuse() {
+    struct Fragment {
+        double t0;
+        double t1;
+        std::uint32_t edge;
+    };
+    MonotonicArena arena(1024);
+    ArenaPool<Fragment> pool(arena);
+    Fragment* a = pool.create(Fragment{0.0, 1.0, 1});
+    Fragment* b = pool.create(Fragment{1.0, 2.0, 2});
+    REBEL_CHECK(a != b);
+    const std::size_t used = arena.bytesUsed();
+
+    // Freed slots come back, most recent first, without touching the arena.
+    pool.destroy(a);
+    Fragment* c = pool.create(Fragment{2.0, 3.0, 3});
+    REBEL_CHECK(c == a && c->edge == 3);
+    pool.destroy(b);
+    pool.destroy(c);
+    REBEL_CHECK(pool.create(Fragment{}) == c);
+    REBEL_CHECK(pool.create(Fragment{}) == b);
+    REBEL_CHECK(arena.bytesUsed() == used);
+    REBEL_CHECK(pool.create(Fragment{}) != a);
+    REBEL_CHECK(arena.bytesUsed() > used);
+
+    // After a rollback the free list points into released memory.
+    pool.destroy(b);
+    arena.reset();
+    pool.clear();
+    Fragment* d = pool.create(Fragment{});
+    REBEL_CHECK(d == a);
+    REBEL_CHECK(pool.create(Fragment{}) == b);
+}
+
+void setPerWorker() {
+    const GlobalThreadsScope threads(4);
+    ArenaSet arenas(1024);
+
+    // Every chunk fills scratch from its own arena, yields so other chunks
+    // interleave, and checks nothing overwrote it.
+    std::mutex mutex;
+    std::map<MonotonicArena*, std::thread::id> owners;
+    bool shared = false;
+    bool clobbered = false;
+    core::parallelFor(0, 256, 1, [&](std::size_t begin, std::size_t) {
+        MonotonicArena& arena = arenas.local();
+        REBEL_CHECK(&arenas.local() == &arena);
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            const auto [it, inserted] = owners.emplace(&arena, std::this_thread::get_id());
+            shared = shared || (!inserted && it->second != std::this_thread::get_id());
+        }
+        auto* values = arena.allocateArray<std::size_t>(200);
+        for (std::size_t i = 0; i < 200; ++i) {
+            values[i] = begin;
+        }
+        std::this_thread::yield();
+        for (std::size_t i = 0; i < 200; ++i) {
+            if (values[i] != begin) {
+                const std::lock_guard<std::mutex> lock(mutex);
+                clobbered = true;
+            }
+        }
+    });
+    REBEL_CHECK(!shared && !clobbered);
+    REBEL_CHECK(owners.size() >= 1 && owners.size() <= 5);
+    REBEL_CHECK(arenas.bytesUsed() >= 256 * 200 * sizeof(std::size_t));
+
+    // The calling thread gets the dedicated outside slot.
+    MonotonicArena& outside = arenas.local();
+    const auto found = owners.find(&outside);
+    REBEL_CHECK(found == owners.end() || found->second == std::this_thread::get_id());
+
+    const std::size_t reserved = arenas.bytesReserved();
+    arenas.reset();
+    REBEL_CHECK(arenas.bytesUsed() == 0 && arenas.bytesReserved() == reserved);
+}
+
+void failureLeavesCallerToken() {
+    TaskScheduler scheduler(4);
+    const CancellationToken token;
+    std::atomic<int> ran{0};
+    std::string message;
+    {
+        TaskGroup group(scheduler, token);
+        for (int i = 0; i < 32; ++i) {
+            group.run([&ran, i] {
+                if (i == 5) {
+                    throw std::logic_error("task failed");
+                }
+                ran.fetch_add(1);
+            });
+        }
+        try {
+            group.wait();
+        } catch (const std::logic_error& e) {
+            message = e.what();
+        }
+        REBEL_CHECK(group.isCancelled());
+    }
+    REBEL_CHECK(message == "task failed");
+    REBEL_CHECK(!token.isCancelled());
+
+    // Other work sharing the token still runs, as does a graph after a
+    // failing one.
+    ran = 0;
+    TaskGroup next(scheduler, token);
+    for (int i = 0; i < 8; ++i) {
+        next.run([&ran] { ran.fetch_add(1); });
+    }
+    next.wait();
+    REBEL_CHECK(ran.load() == 8);
+
+    core::TaskGraph graph;
+    const core::TaskGraph::NodeId first = graph.add([] { throw std::runtime_error("node failed"); });
+    const core::TaskGraph::NodeId second = graph.add([&ran] { ran.fetch_add(1); });
+    graph.precede(first, second);
+    bool threw = false;
+    try {
+        graph.run(scheduler, token);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    REBEL_CHECK(threw && ran.load() == 8 && !token.isCancelled());
+
+    // Cooperative cancellation is not an error; the caller's cancel skips
+    // what has not started.
+    TaskGroup stopping(scheduler, token);
+    stopping.run([] { throw core::OperationCancelled(); });
+    stopping.wait();
+    token.cancel();
+    stopping.run([&ran] { ran.fetch_add(1); });
+    stopping.wait();
+    REBEL_CHECK(ran.load() == 8 && stopping.isCancelled());
+}
+
+/// Spawns `fanout` children per level and waits on them from inside the
+/// task, so every worker ends up blocked in a nested wait.
+void spawnTree(TaskScheduler& scheduler, int depth, std::atomic<int>& leaves) {
+    if (depth == 0) {
+        leaves.fetch_add(1);
+        return;
+    }
+    TaskGroup group(scheduler);
+    for (int i = 0; i < 4; ++i) {
+        group.run([&scheduler, depth, &leaves] { spawnTree(scheduler, depth - 1, leaves); });
+    }
+    group.wait();
+}
+
+void nestedWaitsFinish() {
+    for (unsigned threads : {1u, 2u, 4u}) {
+        TaskScheduler scheduler(threads);
+        std::atomic<int> leaves{0};
+        spawnTree(scheduler, 6, leaves);
+        REBEL_CHECK(leaves.load() == 4096);
+
+        // Nested parallel loops, with the inner one stolen across workers.
+        std::atomic<std::size_t> sum{0};
+        core::parallelFor(
+            0, 16, 1,
+            [&](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; ++i) {
+                    core::parallelFor(
+                        0, 64, 4,
+                        [&](std::size_t b, std::size_t e) {
+                            for (std::size_t j = b; j < e; ++j) {
+                                sum.fetch_add(i * 64 + j);
+                            }
+                        },
+                        scheduler);
+                }
+            },
+            scheduler);
+        REBEL_CHECK(sum.load() == 1024 * 1023 / 2);
+    }
+}
+
+void snapshotEditDifference() {
+    PersistentVector<int> values;
+    for (int i = 0; i < 5000; ++i) {
+        values.push_back(i);
+    }
+    const PersistentVector<int> snapshot = values;
+    REBEL_CHECK(snapshot.identical(values));
+
+    // Edits copy the shared paths once; the snapshot keeps its values.
+    const std::set<std::size_t> edited{3, 17, 40, 1333, 4999};
+    for (const std::size_t i : edited) {
+        values.set(i, -1);
+    }
+    values.mutate(17) = -2;
+    REBEL_CHECK(!snapshot.identical(values));
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        REBEL_CHECK(snapshot[i] == static_cast<int>(i));
+        const int expected = i == 17 ? -2 : edited.count(i) != 0 ? -1 : static_cast<int>(i);
+        REBEL_CHECK(values[i] == expected);
+    }
+
+    // Only the edited leaves are visited, and every edit is among them.
+    std::set<std::size_t> leaves;
+    std::set<std::size_t> differing;
+    values.forEachDifference(snapshot, [&](std::size_t i, int mine, int theirs) {
+        leaves.insert(i / PersistentVector<int>::kWidth);
+        if (mine != theirs) {
+            differing.insert(i);
+        }
+    });
+    REBEL_CHECK(differing == edited);
+    REBEL_CHECK((leaves == std::set<std::size_t>{0, 1, 41, 156}));
+
+    // Shared nodes are counted once across the two.
+    std::unordered_set<const void*> seen;
+    const std::size_t both = snapshot.memoryBytes(&seen) + values.memoryBytes(&seen);
+    REBEL_CHECK(both < 3 * snapshot.memoryBytes() / 2);
+
+    // Sparse growth reads as zero and compares against a grown snapshot.
+    PersistentVector<int> sparse = values;
+    sparse.extend(100000);
+    PersistentVector<int> grown = values;
+    grown.extend(100000);
+    REBEL_CHECK(sparse[99999] == 0 && sparse.at(5000) == 0);
+    sparse.set(70000, 7);
+    std::size_t reported = 0;
+    sparse.forEachDifference(grown, [&](std::size_t i, int mine, int theirs) {
+        reported += mine != theirs ? 1 : 0;
+        REBEL_CHECK(i / PersistentVector<int>::kWidth == 70000 / PersistentVector<int>::kWidth);
+    });
+    REBEL_CHECK(reported == 1);
+    bool threw = false;
+    try {
+        sparse.forEachDifference(snapshot, [](std::size_t, int, int) {});
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    REBEL_CHECK(threw);
+
+    // A reader summing a snapshot on another thread, then dropping it, while
+    // the original keeps being edited.
+    for (int round = 0; round < 20; ++round) {
+        auto copy = std::make_unique<PersistentVector<int>>(values);
+        long long expected = 0;
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            expected += values[i];
+        }
+        long long sum = 0;
+        std::thread reader([&sum, copy = std::move(copy)]() mutable {
+            for (std::size_t i = 0; i < copy->size(); ++i) {
+                sum += (*copy)[i];
+            }
+            copy.reset();
+        });
+        for (std::size_t i = 0; i < values.size(); i += 7) {
+            values.mutate(i) += 1;
+        }
+        reader.join();
+        REBEL_CHECK(sum == expected);
+    }
+}
+
+/// Cache of named items for the budget to evict, logging evictions to a
+/// log shared between consumers. `pinned` bytes are held but never
+/// offered.
+class FakeConsumer final : public core::MemoryConsumer {
+public:
+    FakeConsumer(std::string name, std::vector<std::string>& log) : name_(std::move(name)), log_(log) {}
+
+    void use(const std::string& item, std::size_t bytes) { items_[item] = {MemoryBudget::stamp(), bytes}; }
+    void pin(std::size_t bytes) { pinned_ = bytes; }
+
+    std::string_view memoryName() const override { return name_; }
+    std::size_t memoryBytes() const override {
+        std::size_t bytes = pinned_;
+        for (const auto& [name, item] : items_) {
+            bytes += item.bytes;
+        }
+        return bytes;
+    }
+    void evictionCandidates(std::vector<core::MemoryItem>& out) const override {
+        for (const auto& [name, item] : items_) {
+            out.push_back(item);
+        }
+    }
+    std::size_t evictOlderThan(std::uint64_t stamp) override {
+        std::size_t freed = 0;
+        for (auto it = items_.begin(); it != items_.end();) {
+            if (it->second.lastUse < stamp) {
+                log_.push_back(name_ + "." + it->first);
+                freed += it->second.bytes;
+                it = items_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        return freed;
+    }
+
+private:
+    std::string name_;
+    std::vector<std::string>& log_;
+    std::map<std::string, core::MemoryItem> items_;
+    std::size_t pinned_ = 0;
+};
+
+void evictionOrder() {
+    std::vector<std::string> log;
+    FakeConsumer meshes("meshes", log);
+    FakeConsumer results("results", log);
+    MemoryBudget budget(300);
+    budget.add(&meshes);
+    budget.add(&results);
+    budget.add(&meshes);
+
+    // Uses alternate between the caches; the two oldest go, one from each.
+    meshes.use("a", 100);
+    results.use("b", 100);
+    meshes.use("c", 100);
+    results.use("d", 100);
+    meshes.use("e", 100);
+    REBEL_CHECK(budget.enforce() == 200);
+    std::sort(log.begin(), log.end());
+    REBEL_CHECK((log == std::vector<std::string>{"meshes.a", "results.b"}));
+    const core::MemoryBudgetStats stats = budget.stats();
+    REBEL_CHECK(stats.limitBytes == 300 && stats.usedBytes == 300 && stats.overruns == 1 && stats.evictedBytes == 200);
+
+    // Within the limit nothing goes.
+    log.clear();
+    REBEL_CHECK(budget.enforce() == 0 && log.empty() && budget.stats().overruns == 1);
+
+    // A use makes an item the newest: after touching c, d is the oldest,
+    // and freeing it alone covers the overrun.
+    meshes.use("c", 100);
+    results.use("f", 50);
+    REBEL_CHECK(budget.enforce() == 100);
+    REBEL_CHECK((log == std::vector<std::string>{"results.d"}));
+
+    // Eviction stops once the overrun is covered: the oldest item goes,
+    // not the large one just used.
+    log.clear();
+    results.use("g", 10);
+    results.use("h", 10);
+    meshes.use("e", 400);
+    meshes.use("i", 10);
+    const std::vector<core::MemoryUsage> usage = budget.usage();
+    REBEL_CHECK(usage.size() == 2 && usage[0].name == "meshes" && usage[0].bytes == 510 && usage[1].bytes == 70);
+    budget.setLimit(500);
+    REBEL_CHECK(budget.enforce() == 100 && budget.stats().usedBytes == 480);
+    REBEL_CHECK((log == std::vector<std::string>{"meshes.c"}));
+
+    // Pinned bytes are counted but not evictable: everything else goes and
+    // the budget stays exceeded.
+    log.clear();
+    results.pin(1000);
+    REBEL_CHECK(budget.enforce() == 480 && log.size() == 5);
+    REBEL_CHECK(budget.stats().usedBytes == 1000 && budget.stats().evictedBytes == 200 + 100 + 100 + 480);
+
+    // Removed consumers and an unlimited budget are left alone.
+    budget.remove(&results);
+    meshes.use("j", 600);
+    budget.setLimit(0);
+    REBEL_CHECK(budget.enforce() == 0 && budget.stats().usedBytes == 600);
+    budget.setLimit(100);
+    REBEL_CHECK(budget.enforce() == 600 && budget.usage().size() == 1);
+    REBEL_CHECK(MemoryBudget::stamp() < MemoryBudget::stamp());
+}
+
+} // namespace
+
+void registerCoreTests(Registry& registry) {
+    registry.add({"core.arena.marker_rollback", markerRollback});
+    registry.add({"core.arena.destructor_order", destructorOrder});
+    registry.add({"core.arena.pool_reuse", poolReuse});
+    registry.add({"core.arena.set_per_worker", setPerWorker});
+    registry.add({"core.memory_budget.eviction_order", evictionOrder});
+    registry.add({"core.persistent_vector.snapshot_edit_difference", snapshotEditDifference});
+    registry.add({"core.tasks.failure_leaves_caller_token", failureLeavesCallerToken});
+    registry.add({"core.tasks.nested_waits_finish", nestedWaitsFinish});
+}
+
+} // namespace rebel::test
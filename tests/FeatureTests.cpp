@@ -0,0 +1,287 @@
+#include "Fixtures.hpp"
+#include "Test.hpp"
+
+#include "rebel/feature/FeatureGraph.hpp"
+#include "rebel/feature/ResultCache.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace rebel::test {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+using feature::FeatureGraph;
+using feature::FeatureId;
+using feature::MeshResult;
+using feature::Parameters;
+using feature::RegenerationStats;
+using feature::ResultCache;
+using feature::ResultCacheOptions;
+using feature::ValueResult;
+
+ResultCacheOptions onDisk(const TempDirectory& directory, bool readOnly = false) {
+    ResultCacheOptions options;
+    options.directory = directory.path();
+    options.readOnly = readOnly;
+    return options;
+}
+
+core::Hash128 keyOf(const char* name) { return core::hashBytes(name, std::strlen(name)); }
+
+/// First file in `directory` that is not in `before`.
+fs::path newFile(const TempDirectory& directory, const std::vector<fs::path>& before) {
+    for (const fs::directory_entry& entry : fs::recursive_directory_iterator(directory.path())) {
+        if (entry.is_regular_file() && std::find(before.begin(), before.end(), entry.path()) == before.end()) {
+            return entry.path();
+        }
+    }
+    return {};
+}
+
+std::vector<fs::path> filesIn(const TempDirectory& directory) {
+    std::vector<fs::path> files;
+    for (const fs::directory_entry& entry : fs::recursive_directory_iterator(directory.path())) {
+        if (entry.is_regular_file()) {
+            files.push_back(entry.path());
+        }
+    }
+    return files;
+}
+
+bool sameFloats(const float* a, const float* b, std::size_t count) {
+    return (a == nullptr) == (b == nullptr) && (a == nullptr || std::memcmp(a, b, count * sizeof(float)) == 0);
+}
+
+bool sameMesh(const geometry::Mesh& a, const geometry::Mesh& b) {
+    const geometry::MeshView x = a.view();
+    const geometry::MeshView y = b.view();
+    if (x.vertexCount != y.vertexCount || x.triangleCount != y.triangleCount) {
+        return false;
+    }
+    const std::size_t n = x.vertexCount;
+    return sameFloats(x.px, y.px, n) && sameFloats(x.py, y.py, n) && sameFloats(x.pz, y.pz, n) &&
+           sameFloats(x.nx, y.nx, n) && sameFloats(x.ny, y.ny, n) && sameFloats(x.nz, y.nz, n) &&
+           sameFloats(x.u, y.u, n) && sameFloats(x.v, y.v, n) &&
+           std::memcmp(x.corners, y.corners, x.triangleCount * 3 * sizeof(geometry::VertexIndex)) == 0;
+}
+
+geometry::Mesh shadedMesh(const brep::Body& body) {
+    geometry::Mesh mesh = bodyMesh(body);
+    if (!mesh.hasNormals()) {
+        mesh.computeVertexNormals();
+    }
+    return mesh;
+}
+
+void roundTrip() {
+    TempDirectory directory;
+    const auto box = std::make_shared<MeshResult>(shadedMesh(brep::makeBox({0, 0, 0}, {3, 2, 1})));
+    const auto values = std::make_shared<ValueResult>(std::vector<double>{1.5, -0.0, 1e300, 42.0});
+    {
+        ResultCache cache(onDisk(directory));
+        cache.store(keyOf("box"), box);
+        cache.store(keyOf("values"), values);
+        REBEL_CHECK(cache.stats().stores == 2);
+    }
+    REBEL_CHECK(filesIn(directory).size() == 2);
+
+    // A fresh cache, as in another process, finds both on disk.
+    ResultCache cache(onDisk(directory));
+    const auto loadedBox = std::dynamic_pointer_cast<const MeshResult>(cache.find(keyOf("box")));
+    const auto loadedValues = std::dynamic_pointer_cast<const ValueResult>(cache.find(keyOf("values")));
+    REBEL_CHECK(loadedBox != nullptr && loadedValues != nullptr);
+    REBEL_CHECK(cache.stats().diskHits == 2 && cache.stats().misses == 0 && cache.stats().corrupt == 0);
+    REBEL_CHECK(loadedBox->contentHash() == box->contentHash());
+    REBEL_CHECK(loadedBox->mesh().hasNormals());
+    REBEL_CHECK(sameMesh(loadedBox->mesh(), box->mesh()));
+    REBEL_CHECK(loadedValues->contentHash() == values->contentHash());
+    REBEL_CHECK(std::memcmp(loadedValues->values().data(), values->values().data(), 4 * sizeof(double)) == 0);
+
+    // Loaded entries stay in memory.
+    REBEL_CHECK(cache.find(keyOf("box")) == loadedBox);
+    REBEL_CHECK(cache.stats().memoryHits == 1);
+    REBEL_CHECK(cache.find(keyOf("absent")) == nullptr);
+    REBEL_CHECK(cache.stats().misses == 1 && cache.stats().corrupt == 0);
+}
+
+void damagedEntriesMiss() {
+    TempDirectory directory;
+    const geometry::Mesh mesh = shadedMesh(brep::makeSphere({0, 0, 0}, 1.0));
+    const std::size_t vertices = mesh.vertexCount();
+    const std::size_t cornerBytes = mesh.triangleCount() * 3 * sizeof(geometry::VertexIndex);
+    const std::size_t normalBytes = 3 * vertices * sizeof(float);
+
+    std::vector<fs::path> paths;
+    {
+        ResultCache cache(onDisk(directory));
+        for (const char* name : {"position", "normal", "truncated", "foreign"}) {
+            const std::vector<fs::path> before = filesIn(directory);
+            cache.store(keyOf(name), std::make_shared<MeshResult>(mesh));
+            paths.push_back(newFile(directory, before));
+            REBEL_CHECK(!paths.back().empty());
+        }
+    }
+    // The payload is counts, positions, normals and corners; offsets are
+    // taken from the end so they do not depend on the header size.
+    std::vector<std::uint8_t> data = readFile(paths[0]);
+    const std::size_t positions = data.size() - cornerBytes - 2 * normalBytes;
+    data[positions + normalBytes / 2] ^= 0x10;
+    writeFile(paths[0], data);
+
+    // Normals are not part of the content hash; the payload hash catches them.
+    data = readFile(paths[1]);
+    data[data.size() - cornerBytes - normalBytes / 2] ^= 0x01;
+    writeFile(paths[1], data);
+
+    data = readFile(paths[2]);
+    data.resize(data.size() - 1);
+    writeFile(paths[2], data);
+
+    data = readFile(paths[3]);
+    data[0] ^= 0xff;
+    writeFile(paths[3], data);
+
+    ResultCache cache(onDisk(directory));
+    for (const char* name : {"position", "normal", "truncated", "foreign"}) {
+        REBEL_CHECK(cache.find(keyOf(name)) == nullptr);
+    }
+    REBEL_CHECK(cache.stats().corrupt == 4 && cache.stats().misses == 4 && cache.stats().diskHits == 0);
+}
+
+void readOnlyLeavesDiskAlone() {
+    TempDirectory directory;
+    const auto box = std::make_shared<MeshResult>(shadedMesh(brep::makeBox({0, 0, 0}, {1, 1, 1})));
+    {
+        ResultCache cache(onDisk(directory));
+        cache.store(keyOf("shared"), box);
+    }
+    ResultCache cache(onDisk(directory, true));
+    cache.store(keyOf("local"), box);
+    REBEL_CHECK(filesIn(directory).size() == 1);
+    REBEL_CHECK(cache.find(keyOf("local")) == box);
+    const auto shared = std::dynamic_pointer_cast<const MeshResult>(cache.find(keyOf("shared")));
+    REBEL_CHECK(shared != nullptr && sameMesh(shared->mesh(), box->mesh()));
+    REBEL_CHECK(cache.stats().memoryHits == 1 && cache.stats().diskHits == 1);
+}
+
+/// Test op counting its evaluations: `value` passes its parameter on,
+/// `round` rounds its input to a whole number, `sum` adds its inputs.
+class CountingOp final : public feature::FeatureOp {
+public:
+    explicit CountingOp(std::string kind) : kind_(std::move(kind)) {}
+
+    std::string_view type() const override { return kind_; }
+    feature::ResultPtr evaluate(const Parameters& p, const std::vector<feature::ResultPtr>& inputs) const override {
+        evaluations.fetch_add(1);
+        double value = 0.0;
+        if (kind_ == "value") {
+            if (p.number("x") < 0.0) {
+                throw std::runtime_error("negative value");
+            }
+            value = p.number("x");
+        } else {
+            for (const feature::ResultPtr& input : inputs) {
+                value += static_cast<const ValueResult&>(*input).values()[0];
+            }
+            value = kind_ == "round" ? std::round(value) : value;
+        }
+        return std::make_shared<ValueResult>(std::vector<double>{value});
+    }
+
+    mutable std::atomic<int> evaluations{0};
+
+private:
+    std::string kind_;
+};
+
+Parameters withX(double x) {
+    Parameters p;
+    p.set("x", x);
+    return p;
+}
+
+double valueOf(const FeatureGraph& graph, FeatureId id) {
+    return static_cast<const ValueResult&>(*graph.result(id)).values()[0];
+}
+
+bool counts(const RegenerationStats& s, std::size_t visited, std::size_t evaluated, std::size_t reused,
+            std::size_t cached) {
+    return s.visited == visited && s.evaluated == evaluated && s.reused == reused && s.cached == cached;
+}
+
+void regenerationSkipsUnchangedHashes() {
+    const auto value = std::make_shared<CountingOp>("value");
+    const auto round = std::make_shared<CountingOp>("round");
+    const auto sum = std::make_shared<CountingOp>("sum");
+    // a -> rounded -> total <- b
+    FeatureGraph graph;
+    graph.setCache(std::make_shared<ResultCache>(ResultCacheOptions{}));
+    const FeatureId a = graph.add("a", value, withX(1.2));
+    const FeatureId b = graph.add("b", value, withX(10.0));
+    const FeatureId rounded = graph.add("rounded", round, {}, {a});
+    const FeatureId total = graph.add("total", sum, {}, {rounded, b});
+    REBEL_CHECK(counts(graph.regenerate(), 4, 4, 0, 0));
+    REBEL_CHECK(valueOf(graph, total) == 11.0);
+
+    // Nothing dirty, and setting a value it already has is no edit.
+    REBEL_CHECK(counts(graph.regenerate(), 0, 0, 0, 0));
+    graph.setParameter(a, "x", 1.2);
+    REBEL_CHECK(!graph.needsRegeneration());
+
+    // Rounding absorbs the edit: `total` hashes the same and is not run,
+    // and `b`, outside the cone, is not even visited.
+    const core::Hash128 totalHash = graph.inputHash(total);
+    graph.setParameter(a, "x", 1.3);
+    REBEL_CHECK(counts(graph.regenerate(), 3, 2, 1, 0));
+    REBEL_CHECK(sum->evaluations.load() == 1 && value->evaluations.load() == 3);
+    REBEL_CHECK(graph.inputHash(total) == totalHash && valueOf(graph, total) == 11.0);
+
+    // A change that survives rounding propagates.
+    graph.setParameter(a, "x", 2.4);
+    REBEL_CHECK(counts(graph.regenerate(), 3, 3, 0, 0));
+    REBEL_CHECK(valueOf(graph, total) == 12.0 && !(graph.inputHash(total) == totalHash));
+
+    // Returning to earlier inputs finds the results in the cache.
+    graph.setParameter(a, "x", 1.3);
+    REBEL_CHECK(counts(graph.regenerate(), 3, 0, 0, 3));
+    REBEL_CHECK(valueOf(graph, total) == 11.0);
+
+    // Invalidation forces a run although the hash is unchanged; a released
+    // result comes back from the cache.
+    graph.invalidate(total);
+    REBEL_CHECK(counts(graph.regenerate(), 1, 1, 0, 0));
+    graph.release(rounded);
+    REBEL_CHECK(graph.result(rounded) == nullptr);
+    REBEL_CHECK(counts(graph.regenerate(), 2, 0, 1, 1));
+    REBEL_CHECK(valueOf(graph, rounded) == 1.0);
+
+    // A failure fails the cone, and recovers once fixed.
+    graph.setParameter(a, "x", -1.0);
+    const RegenerationStats failed = graph.regenerate();
+    REBEL_CHECK(failed.failed == 3 && graph.state(total) == feature::FeatureState::Failed);
+    REBEL_CHECK(graph.state(b) == feature::FeatureState::UpToDate);
+    graph.setParameter(a, "x", 1.3);
+    graph.regenerate();
+    REBEL_CHECK(graph.state(total) == feature::FeatureState::UpToDate && valueOf(graph, total) == 11.0);
+}
+
+} // namespace
+
+void registerFeatureTests(Registry& registry) {
+    registry.add({"feature.graph.regeneration_skips_unchanged_hashes", regenerationSkipsUnchangedHashes});
+    registry.add({"feature.result_cache.disk_round_trip", roundTrip});
+    registry.add({"feature.result_cache.damaged_entries_miss", damagedEntriesMiss});
+    registry.add({"feature.result_cache.read_only_leaves_disk_alone", readOnlyLeavesDiskAlone});
+}
+
+} // namespace rebel::test
@@ -0,0 +1,43 @@
+#include "Fixtures.hpp"
+
+#include "rebel/brep/Tessellator.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <system_error>
+#include <utility>
+
+namespace rebel::test {
+
+geometry::Mesh bodyMesh(const brep::Body& body, double chordalTolerance) {
+    brep::TessellationOptions options;
+    options.chordalTolerance = chordalTolerance;
+    return brep::tessellateLevel(body, options, 0).merged();
+}
+
+assembly::PartPtr bodyPart(std::string name, const brep::Body& body, double chordalTolerance) {
+    return assembly::Part::create(std::move(name), bodyMesh(body, chordalTolerance));
+}
+
+TempDirectory::TempDirectory()
+    : path_(std::filesystem::temp_directory_path() / ("rebelcad-tests-" + std::to_string(std::random_device{}()))) {
+    std::filesystem::create_directories(path_);
+}
+
+TempDirectory::~TempDirectory() {
+    std::error_code error;
+    std::filesystem::remove_all(path_, error);
+}
+
+std::vector<std::uint8_t> readFile(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+void writeFile(const std::filesystem::path& path, const std::vector<std::uint8_t>& data) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+}
+
+} // namespace rebel::test
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "rebel/assembly/Part.hpp"
+#include "rebel/brep/Body.hpp"
+#include "rebel/geometry/Mesh.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace rebel::test {
+
+/// Welded level-0 tessellation of `body` (closed for a closed body).
+geometry::Mesh bodyMesh(const brep::Body& body, double chordalTolerance = 0.01);
+
+/// Part holding the tessellation of `body`.
+assembly::PartPtr bodyPart(std::string name, const brep::Body& body, double chordalTolerance = 0.01);
+
+/// Fresh directory under the system temporary directory, removed with
+/// everything in it.
+class TempDirectory {
+public:
+    TempDirectory();
+    ~TempDirectory();
+
+    TempDirectory(const TempDirectory&) = delete;
+    TempDirectory& operator=(const TempDirectory&) = delete;
+
+    std::string path() const { return path_.string(); }
+    std::string file(const std::string& name) const { return (path_ / name).string(); }
+
+private:
+    std::filesystem::path path_;
+};
+
+std::vector<std::uint8_t> readFile(const std::filesystem::path& path);
+void writeFile(const std::filesystem::path& path, const std::vector<std::uint8_t>& data);
+
+} // namespace rebel::test
@@ -0,0 +1,631 @@
+#include "Fixtures.hpp"
+#include "Test.hpp"
+
+#include "rebel/core/Hash.hpp"
+#include "rebel/core/Json.hpp"
+#include "rebel/io/MeshExport.hpp"
+#include "rebel/io/NativeFile.hpp"
+#include "rebel/io/ResourceBundle.hpp"
+#include "rebel/io/StepImport.hpp"
+#include "rebel/spatial/Bvh.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace rebel::test {
+
+namespace {
+
+using io::NativeDocument;
+
+/// Clean native file holding one tessellated sphere with connectivity, and
+/// its bytes.
+struct NativeFixture {
+    TempDirectory directory;
+    std::string path = directory.file("clean.rbl");
+    std::vector<std::uint8_t> bytes;
+    io::layout::PartRecord record;
+
+    NativeFixture() {
+        geometry::Mesh mesh = bodyMesh(brep::makeSphere({0, 0, 0}, 1.0));
+        mesh.buildConnectivity();
+        io::NativeWriter writer;
+        writer.addPart(assembly::Part::create("ball", std::move(mesh)));
+        writer.write(path);
+        bytes = readFile(path);
+        io::layout::FileHeader header;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        std::memcpy(&record, bytes.data() + header.parts.offset, sizeof(record));
+    }
+
+    std::uint64_t offsetOf(io::layout::PartArray array) const {
+        REBEL_CHECK(record.arrays[array].count > 0);
+        return record.arrays[array].offset;
+    }
+
+    /// Copy of the file with `size` bytes at `offset` replaced by `value`.
+    std::string damaged(const std::string& name, std::uint64_t offset, const void* value, std::size_t size) const {
+        std::vector<std::uint8_t> copy = bytes;
+        std::memcpy(copy.data() + offset, value, size);
+        const std::string damagedPath = directory.file(name);
+        writeFile(damagedPath, copy);
+        return damagedPath;
+    }
+};
+
+bool loadRejected(const std::string& path) {
+    const std::shared_ptr<const NativeDocument> document = NativeDocument::open(path);
+    try {
+        document->loadPart(0);
+    } catch (const std::runtime_error&) {
+        return !document->verifyPart(0);
+    }
+    return false;
+}
+
+void cleanFileLoads() {
+    const NativeFixture fixture;
+    const std::shared_ptr<const NativeDocument> document = NativeDocument::open(fixture.path);
+    REBEL_CHECK(document->partCount() == 1);
+    REBEL_CHECK(document->verifyPart(0));
+    const assembly::PartPtr part = document->loadPart(0);
+    REBEL_CHECK(part->mesh().triangleCount == fixture.record.triangleCount);
+    REBEL_CHECK(part->mesh().vertexCount == fixture.record.vertexCount);
+}
+
+void corruptSectionsRejected() {
+    const NativeFixture fixture;
+    using io::layout::PartArray;
+    const std::uint32_t farVertex = 0xffffff;
+    REBEL_CHECK(loadRejected(fixture.damaged("corner.rbl", fixture.offsetOf(PartArray::kCorners) + 4, &farVertex,
+                                             sizeof(farVertex))));
+
+    const auto pastCorners = static_cast<std::uint32_t>(3 * fixture.record.triangleCount);
+    REBEL_CHECK(loadRejected(fixture.damaged("opposite.rbl", fixture.offsetOf(PartArray::kOpposites), &pastCorners,
+                                             sizeof(pastCorners))));
+
+    const std::uint32_t farPrimitive = 0xfffffff0u;
+    REBEL_CHECK(loadRejected(fixture.damaged("primitive.rbl", fixture.offsetOf(PartArray::kBvhPrimitives),
+                                             &farPrimitive, sizeof(farPrimitive))));
+
+    // The root's children pointing back at the root would loop forever.
+    const std::uint64_t root = fixture.offsetOf(PartArray::kBvhNodes) + offsetof(spatial::BvhNode, first);
+    const std::uint32_t self = 0;
+    REBEL_CHECK(loadRejected(fixture.damaged("cycle.rbl", root, &self, sizeof(self))));
+
+    // A root leaf claiming far more primitives than the part has.
+    const std::uint32_t hugeLeaf[2] = {5, 0xfffffff0u};
+    REBEL_CHECK(loadRejected(fixture.damaged("leaf.rbl", root, hugeLeaf, sizeof(hugeLeaf))));
+}
+
+void truncatedFileRejected() {
+    const NativeFixture fixture;
+    std::vector<std::uint8_t> copy = fixture.bytes;
+    copy.resize(copy.size() / 2);
+    const std::string path = fixture.directory.file("truncated.rbl");
+    writeFile(path, copy);
+    bool rejected = false;
+    try {
+        NativeDocument::open(path);
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    REBEL_CHECK(rejected);
+}
+
+template <typename T>
+T load(const std::vector<std::uint8_t>& bytes, std::size_t offset) {
+    REBEL_CHECK(offset + sizeof(T) <= bytes.size());
+    T value;
+    std::memcpy(&value, bytes.data() + offset, sizeof(T));
+    return value;
+}
+
+std::size_t countOf(std::string_view text, std::string_view pattern) {
+    std::size_t n = 0;
+    for (std::size_t at = text.find(pattern); at != std::string_view::npos; at = text.find(pattern, at + 1)) {
+        ++n;
+    }
+    return n;
+}
+
+/// Two boxes, one of them mirrored, a colored ball and a lone triangle;
+/// a hidden and a suppressed box are left out of every export.
+struct ExportFixture {
+    TempDirectory directory;
+    assembly::PartLibrary library;
+    assembly::Assembly model;
+    std::size_t boxTriangles = 0;
+    std::size_t ballTriangles = 0;
+
+    ExportFixture() {
+        const assembly::PartPtr box = bodyPart("box & co", brep::makeBox({0, 0, 0}, {1, 1, 1}));
+        const assembly::PartPtr ball = bodyPart("ball", brep::makeSphere({0, 0, 0}, 0.5));
+        geometry::Mesh triangle;
+        triangle.addTriangle(triangle.addVertex({0, 0, 0}), triangle.addVertex({1, 0, 0}),
+                             triangle.addVertex({0, 1, 0}));
+        boxTriangles = box->mesh().triangleCount;
+        ballTriangles = ball->mesh().triangleCount;
+        const assembly::PartId boxId = library.add(box);
+        const assembly::PartId ballId = library.add(ball);
+        const assembly::PartId flagId = library.add(assembly::Part::create("flag", std::move(triangle)));
+
+        using math::Mat4f;
+        model.addOccurrence(model.root(), boxId, Mat4f::identity());
+        model.addOccurrence(model.root(), boxId, Mat4f::translation({-3, 0, 0}) * Mat4f::scale({-1, 1, 1}));
+        const assembly::NodeId colored = model.addOccurrence(model.root(), ballId, Mat4f::translation({0, 3, 0}));
+        model.addOccurrence(model.root(), flagId, Mat4f::identity());
+        assembly::Overrides red;
+        red.colorRgba = 0xff0000ffu;
+        red.flags = assembly::Overrides::kHasColor;
+        model.setOverrides(colored, red);
+        assembly::Overrides hidden;
+        hidden.flags = assembly::Overrides::kHidden;
+        model.setOverrides(model.addOccurrence(model.root(), boxId, Mat4f::identity()), hidden);
+        assembly::Overrides suppressed;
+        suppressed.flags = assembly::Overrides::kSuppressed;
+        model.setOverrides(model.addOccurrence(model.root(), boxId, Mat4f::identity()), suppressed);
+    }
+
+    std::vector<std::uint8_t> exported(const std::string& name, io::MeshFormat format,
+                                       const io::MeshExportOptions& options, io::MeshExportStats* stats = nullptr) {
+        const std::string path = directory.file(name);
+        const io::MeshExportStats s = io::exportMesh(model, library, path, format, options);
+        std::vector<std::uint8_t> bytes = readFile(path);
+        REBEL_CHECK(s.bytes == bytes.size() && s.occurrences == 4);
+        if (stats != nullptr) {
+            *stats = s;
+        }
+        return bytes;
+    }
+};
+
+void crcCombine() {
+    const std::string check = "123456789";
+    const auto* text = reinterpret_cast<const std::uint8_t*>(check.data());
+    REBEL_CHECK(io::detail::crc32(text, check.size()) == 0xCBF43926u);
+
+    std::vector<std::uint8_t> data(100000);
+    std::uint32_t x = 1;
+    for (std::uint8_t& byte : data) {
+        x = x * 1664525u + 1013904223u;
+        byte = static_cast<std::uint8_t>(x >> 24);
+    }
+    const std::uint32_t whole = io::detail::crc32(data.data(), data.size());
+    for (const std::size_t split : {std::size_t(0), std::size_t(1), std::size_t(7), std::size_t(4096),
+                                    std::size_t(65537), data.size() - 1, data.size()}) {
+        const std::uint32_t a = io::detail::crc32(data.data(), split);
+        const std::uint32_t b = io::detail::crc32(data.data() + split, data.size() - split);
+        REBEL_CHECK(io::detail::crc32Combine(a, b, data.size() - split) == whole);
+    }
+}
+
+void stlTriangles() {
+    ExportFixture fixture;
+    io::MeshExportStats stats;
+    const std::vector<std::uint8_t> bytes = fixture.exported("model.stl", io::MeshFormat::Stl, {}, &stats);
+    const std::size_t triangles = 2 * fixture.boxTriangles + fixture.ballTriangles + 1;
+    REBEL_CHECK(stats.triangles == triangles && stats.meshes == 4);
+    REBEL_CHECK(load<std::uint32_t>(bytes, 80) == triangles);
+    REBEL_CHECK(bytes.size() == 84 + 50 * triangles);
+
+    // The soup encloses both boxes and the ball with outward windings, the
+    // mirrored box included; the triangle lies in a plane through the origin.
+    double volume = 0.0;
+    for (std::size_t t = 0; t < triangles; ++t) {
+        const std::size_t at = 84 + 50 * t + 12;
+        math::Vec3f p[3];
+        for (int k = 0; k < 3; ++k) {
+            p[k] = {load<float>(bytes, at + 12 * k), load<float>(bytes, at + 12 * k + 4),
+                    load<float>(bytes, at + 12 * k + 8)};
+        }
+        volume += math::dot(p[0], math::cross(p[1], p[2])) / 6.0;
+    }
+    const double ball = 4.0 / 3.0 * 3.14159265358979 * 0.125;
+    REBEL_CHECK(volume > 2.0 + 0.95 * ball && volume < 2.0 + ball + 1e-3);
+}
+
+struct ZipRecord {
+    std::string name;
+    std::uint32_t crc = 0;
+    std::size_t data = 0;
+    std::size_t size = 0;
+};
+
+/// Central directory of a ZIP without ZIP64 records, each entry checked
+/// against its local header and, when streamed, its data descriptor.
+std::vector<ZipRecord> readZip(const std::vector<std::uint8_t>& bytes) {
+    const std::size_t end = bytes.size() - 22;
+    REBEL_CHECK(load<std::uint32_t>(bytes, end) == 0x06054B50u);
+    const std::uint16_t count = load<std::uint16_t>(bytes, end + 10);
+    const std::uint32_t directorySize = load<std::uint32_t>(bytes, end + 12);
+    const std::uint32_t directory = load<std::uint32_t>(bytes, end + 16);
+    REBEL_CHECK(directory + directorySize == end);
+
+    std::vector<ZipRecord> records;
+    std::size_t at = directory;
+    for (std::uint16_t i = 0; i < count; ++i) {
+        REBEL_CHECK(load<std::uint32_t>(bytes, at) == 0x02014B50u);
+        REBEL_CHECK(load<std::uint16_t>(bytes, at + 6) == 20);
+        const std::uint16_t flags = load<std::uint16_t>(bytes, at + 8);
+        REBEL_CHECK(load<std::uint16_t>(bytes, at + 10) == 0);
+        ZipRecord record;
+        record.crc = load<std::uint32_t>(bytes, at + 16);
+        record.size = load<std::uint32_t>(bytes, at + 20);
+        REBEL_CHECK(load<std::uint32_t>(bytes, at + 24) == record.size);
+        const std::uint16_t nameLength = load<std::uint16_t>(bytes, at + 28);
+        const std::size_t local = load<std::uint32_t>(bytes, at + 42);
+        record.name.assign(reinterpret_cast<const char*>(bytes.data() + at + 46), nameLength);
+        at += 46 + nameLength + load<std::uint16_t>(bytes, at + 30) + load<std::uint16_t>(bytes, at + 32);
+
+        REBEL_CHECK(load<std::uint32_t>(bytes, local) == 0x04034B50u);
+        REBEL_CHECK(load<std::uint16_t>(bytes, local + 26) == nameLength);
+        REBEL_CHECK(std::memcmp(bytes.data() + local + 30, record.name.data(), nameLength) == 0);
+        record.data = local + 30 + nameLength + load<std::uint16_t>(bytes, local + 28);
+        REBEL_CHECK(record.data + record.size <= directory);
+        if ((flags & 0x0008) != 0) {
+            const std::size_t descriptor = record.data + record.size;
+            REBEL_CHECK(load<std::uint32_t>(bytes, descriptor) == 0x08074B50u);
+            REBEL_CHECK(load<std::uint32_t>(bytes, descriptor + 4) == record.crc);
+            REBEL_CHECK(load<std::uint32_t>(bytes, descriptor + 8) == record.size);
+        } else {
+            REBEL_CHECK(load<std::uint32_t>(bytes, local + 14) == record.crc);
+            REBEL_CHECK(load<std::uint32_t>(bytes, local + 18) == record.size);
+        }
+        records.push_back(std::move(record));
+    }
+    REBEL_CHECK(at == end);
+    return records;
+}
+
+void threeMfPackage() {
+    ExportFixture fixture;
+    // A small window streams the model in many windows, so its checksum is
+    // combined from many pieces.
+    io::MeshExportOptions small;
+    small.windowBytes = 4096;
+    io::MeshExportStats stats;
+    const std::vector<std::uint8_t> bytes = fixture.exported("small.3mf", io::MeshFormat::ThreeMf, small, &stats);
+    REBEL_CHECK(bytes == fixture.exported("large.3mf", io::MeshFormat::ThreeMf, {}));
+    REBEL_CHECK(stats.meshes == 3 && stats.triangles == fixture.boxTriangles + fixture.ballTriangles + 1);
+
+    const std::vector<ZipRecord> records = readZip(bytes);
+    REBEL_CHECK(records.size() == 3);
+    REBEL_CHECK(records[0].name == "[Content_Types].xml" && records[1].name == "_rels/.rels");
+    REBEL_CHECK(records[2].name == "3D/3dmodel.model" && records[2].size > 4 * small.windowBytes);
+    for (const ZipRecord& record : records) {
+        REBEL_CHECK(io::detail::crc32(bytes.data() + record.data, record.size) == record.crc);
+    }
+
+    const std::string_view xml(reinterpret_cast<const char*>(bytes.data() + records[2].data), records[2].size);
+    REBEL_CHECK(countOf(xml, "<object ") == 3 && countOf(xml, "<item ") == 4);
+    REBEL_CHECK(countOf(xml, "<triangle ") == stats.triangles);
+    REBEL_CHECK(countOf(xml, "name=\"box &amp; co\"") == 1);
+}
+
+void glbChunks() {
+    ExportFixture fixture;
+    io::MeshExportStats stats;
+    const std::vector<std::uint8_t> bytes = fixture.exported("model.glb", io::MeshFormat::Gltf, {}, &stats);
+    REBEL_CHECK(stats.meshes == 3);
+    REBEL_CHECK(load<std::uint32_t>(bytes, 0) == 0x46546C67u && load<std::uint32_t>(bytes, 4) == 2);
+    REBEL_CHECK(load<std::uint32_t>(bytes, 8) == bytes.size());
+
+    const std::uint32_t jsonLength = load<std::uint32_t>(bytes, 12);
+    REBEL_CHECK(load<std::uint32_t>(bytes, 16) == 0x4E4F534Au && jsonLength % 4 == 0);
+    const std::size_t bin = 20 + std::size_t(jsonLength);
+    const std::uint32_t binLength = load<std::uint32_t>(bytes, bin);
+    REBEL_CHECK(load<std::uint32_t>(bytes, bin + 4) == 0x004E4942u && binLength % 4 == 0);
+    REBEL_CHECK(bin + 8 + binLength == bytes.size());
+
+    const core::Json gltf =
+        core::Json::parse(std::string_view(reinterpret_cast<const char*>(bytes.data() + 20), jsonLength));
+    REBEL_CHECK(gltf["buffers"].asArray().at(0)["byteLength"].asNumber() == binLength);
+    // Every view starts on a 4-byte boundary, the lone triangle's 6 bytes
+    // of indices included, and ends inside the chunk.
+    bool sawShortIndices = false;
+    for (const core::Json& view : gltf["bufferViews"].asArray()) {
+        const auto offset = static_cast<std::size_t>(view["byteOffset"].asNumber());
+        const auto length = static_cast<std::size_t>(view["byteLength"].asNumber());
+        REBEL_CHECK(offset % 4 == 0 && offset + length <= binLength);
+        sawShortIndices = sawShortIndices || length == 6;
+    }
+    REBEL_CHECK(sawShortIndices);
+}
+
+/// Writes a small AP242 file: an assembly placing a tetrahedron twice, once
+/// moved and once turned a quarter about z, next to a strip-and-fan quad
+/// set, an exact-only product and one with a broken face. The assembly's
+/// description is a long multi-line string and the data section opens with
+/// a long comment, both full of terminators, so indexing in the smallest
+/// chunks starts chunks inside each.
+std::string writeStepFixture(const TempDirectory& directory) {
+    std::string filler;
+    for (int line = 0; line < 120; ++line) {
+        filler += "; not a statement, /* nor a comment */ nor ''quoted'' #" + std::to_string(line) + "=X();\n";
+    }
+    std::string comment;
+    for (int line = 0; line < 120; ++line) {
+        comment += "  ; 'not a string; #" + std::to_string(line) + "=PRODUCT('x','x',$,());\n";
+    }
+    const std::string text = "ISO-10303-21;\n"
+                             "HEADER;\n"
+                             "FILE_DESCRIPTION(('fixture'),'2;1');\n"
+                             "FILE_NAME('pair.stp','',(''),(''),'','','');\n"
+                             "FILE_SCHEMA(('AP242_MANAGED_MODEL_BASED_3D_ENGINEERING_MIM_LF'));\n"
+                             "ENDSEC;\n"
+                             "DATA;\n"
+                             "/*\n" +
+                             comment +
+                             "*/\n"
+                             "#1=PRODUCT('asm','pair; ''tet'' and quad','\n" +
+                             filler +
+                             "',());\n"
+                             "#2=PRODUCT_DEFINITION_FORMATION('','',#1);\n"
+                             "#3=PRODUCT_DEFINITION('design','',#2,$);\n"
+                             "#4=PRODUCT('tet','',$,());\n"
+                             "#5=PRODUCT_DEFINITION_FORMATION('','',#4);\n"
+                             "#6=PRODUCT_DEFINITION('design','',#5,$);\n"
+                             "#7=PRODUCT('quad','quad',$,());\n"
+                             "#8=PRODUCT_DEFINITION_FORMATION('','',#7);\n"
+                             "#9=PRODUCT_DEFINITION('design','',#8,$);\n"
+                             "#10=PRODUCT('bolt','bolt',$,());\n"
+                             "#11=PRODUCT_DEFINITION_FORMATION('','',#10);\n"
+                             "#12=PRODUCT_DEFINITION('design','',#11,$);\n"
+                             "#13=PRODUCT('bad','bad',$,());\n"
+                             "#14=PRODUCT_DEFINITION_FORMATION('','',#13);\n"
+                             "#15=PRODUCT_DEFINITION('design','',#14,$);\n"
+                             // Placements: identity, moved, turned.
+                             "#20=CARTESIAN_POINT('',(0.,0.,0.));\n"
+                             "#21=CARTESIAN_POINT('',(10.,0.,0.));\n"
+                             "#22=DIRECTION('',(0.,0.,1.));\n"
+                             "#23=DIRECTION('',(0.,1.,0.));\n"
+                             "#24=AXIS2_PLACEMENT_3D('',#20,$,$);\n"
+                             "#25=AXIS2_PLACEMENT_3D('',#21,$,$);\n"
+                             "#26=AXIS2_PLACEMENT_3D('',#20,#22,#23);\n"
+                             // Shapes.
+                             "#30=SHAPE_REPRESENTATION('',(#24,#25,#26),$);\n"
+                             "#31=PRODUCT_DEFINITION_SHAPE('','',#3);\n"
+                             "#32=SHAPE_DEFINITION_REPRESENTATION(#31,#30);\n"
+                             "#40=COORDINATES_LIST('',4,((0.,0.,0.),(1.,0.,0.),(0.,1.,0.),(0.,0.,1.)));\n"
+                             "#41=TRIANGULATED_FACE('',#40,4,((0.,0.,2.)),$,$,((1,3,2),(1,2,4),(2,3,4),(1,4,3)));\n"
+                             "#42=TESSELLATED_SOLID('',(#41),$);\n"
+                             "#43=SHAPE_REPRESENTATION('',(#24),$);\n"
+                             "#44=TESSELLATED_SHAPE_REPRESENTATION('',(#42),$);\n"
+                             "#45=SHAPE_REPRESENTATION_RELATIONSHIP('','',#43,#44);\n"
+                             "#46=PRODUCT_DEFINITION_SHAPE('','',#6);\n"
+                             "#47=SHAPE_DEFINITION_REPRESENTATION(#46,#43);\n"
+                             "#50=COORDINATES_LIST('',4,((0.,0.,0.),(1.,0.,0.),(0.,1.,0.),(1.,1.,0.)));\n"
+                             "#51=COMPLEX_TRIANGULATED_SURFACE_SET('',#50,4,(),$,((1,2,3,4)),((1,4,3)));\n"
+                             "#52=TESSELLATED_SHAPE_REPRESENTATION('',(#51),$);\n"
+                             "#53=PRODUCT_DEFINITION_SHAPE('','',#9);\n"
+                             "#54=SHAPE_DEFINITION_REPRESENTATION(#53,#52);\n"
+                             "#60=MANIFOLD_SOLID_BREP('',#61);\n"
+                             "#61=CLOSED_SHELL('',());\n"
+                             "#62=ADVANCED_BREP_SHAPE_REPRESENTATION('',(#60),$);\n"
+                             "#63=PRODUCT_DEFINITION_SHAPE('','',#12);\n"
+                             "#64=SHAPE_DEFINITION_REPRESENTATION(#63,#62);\n"
+                             "#70=TRIANGULATED_FACE('',#40,0,(),$,$,((1,2,9)));\n"
+                             "#71=TESSELLATED_SHAPE_REPRESENTATION('',(#70),$);\n"
+                             "#72=PRODUCT_DEFINITION_SHAPE('','',#15);\n"
+                             "#73=SHAPE_DEFINITION_REPRESENTATION(#72,#71);\n"
+                             // Usages: a complex and a simple transformed relationship
+                             // for the tetrahedra, none for the rest.
+                             "#80=NEXT_ASSEMBLY_USAGE_OCCURRENCE('u1','moved','',#3,#6,$);\n"
+                             "#81=NEXT_ASSEMBLY_USAGE_OCCURRENCE('u2','','',#3,#6,$);\n"
+                             "#82=NEXT_ASSEMBLY_USAGE_OCCURRENCE('u3','flat','',#3,#9,$);\n"
+                             "#83=NEXT_ASSEMBLY_USAGE_OCCURRENCE('u4','','',#3,#12,$);\n"
+                             "#84=NEXT_ASSEMBLY_USAGE_OCCURRENCE('u5','','',#3,#15,$);\n"
+                             "#85=ITEM_DEFINED_TRANSFORMATION('','',#24,#25);\n"
+                             "#86=ITEM_DEFINED_TRANSFORMATION('','',#24,#26);\n"
+                             "#87=(REPRESENTATION_RELATIONSHIP('','',#43,#30)\n"
+                             "REPRESENTATION_RELATIONSHIP_WITH_TRANSFORMATION(#85)\n"
+                             "SHAPE_REPRESENTATION_RELATIONSHIP());\n"
+                             "#88=SHAPE_REPRESENTATION_RELATIONSHIP_WITH_TRANSFORMATION('','',#43,#30,#86);\n"
+                             "#89=PRODUCT_DEFINITION_SHAPE('','',#80);\n"
+                             "#90=PRODUCT_DEFINITION_SHAPE('','',#81);\n"
+                             "#91=CONTEXT_DEPENDENT_SHAPE_REPRESENTATION(#87,#89);\n"
+                             "#92=CONTEXT_DEPENDENT_SHAPE_REPRESENTATION(#88,#90);\n"
+                             "ENDSEC;\n"
+                             "END-ISO-10303-21;\n";
+    const std::string path = directory.file("pair.stp");
+    writeFile(path, std::vector<std::uint8_t>(text.begin(), text.end()));
+    return path;
+}
+
+void stepImportFixture() {
+    TempDirectory directory;
+    const std::string path = writeStepFixture(directory);
+    for (const std::size_t chunkBytes : {std::size_t{1}, std::size_t{8} << 20}) {
+        io::StepIndexOptions indexOptions;
+        indexOptions.chunkBytes = chunkBytes;
+        const auto file = io::StepFile::open(path, indexOptions);
+        REBEL_CHECK(file->entityCount() == 60);
+        REBEL_CHECK(file->schemas().size() == 1 && file->schemas()[0].rfind("AP242", 0) == 0);
+        REBEL_CHECK(file->entity(1).type == "PRODUCT" && file->entity(2).type == "PRODUCT_DEFINITION_FORMATION");
+        REBEL_CHECK(file->entity(87).isComplex() && !file->entity(19).valid());
+
+        assembly::Assembly target;
+        assembly::PartLibrary library;
+        io::StepImportOptions options;
+        options.index = indexOptions;
+        options.lengthScale = 2.0;
+        const io::StepImportResult result = io::importStep(*file, target, target.root(), library, options);
+        REBEL_CHECK(result.products == 5 && result.parts == 2 && result.occurrences == 3);
+        REBEL_CHECK(result.triangles == 4 + 3 && result.unsupportedShapes == 1);
+        REBEL_CHECK(result.warningCount == 1 && result.warnings[0].find("#70") != std::string::npos);
+        REBEL_CHECK(library.size() == 2);
+        REBEL_CHECK(target.name(result.root) == "pair; 'tet' and quad");
+
+        // Both tetrahedra share one part; placements are scaled with the
+        // geometry, and an unnamed usage goes by its id.
+        const assembly::PartId tet = library.find("tet");
+        REBEL_CHECK(tet != assembly::kInvalidPart && library.get(tet)->mesh().triangleCount == 4);
+        REBEL_CHECK(library.get(library.find("quad"))->mesh().triangleCount == 3);
+        const math::Vec3f tip = library.get(tet)->mesh().position(1);
+        REBEL_CHECK(tip.x == 2.0f && tip.y == 0.0f && tip.z == 0.0f);
+        std::vector<std::string> placed;
+        target.forEachOccurrence([&](const assembly::Occurrence& o) {
+            const math::Vec3f p = o.world.transformPoint(math::Vec3f{2.0f, 0.0f, 0.0f});
+            placed.push_back(target.name(o.node) + (o.part == tet ? " tet " : " quad ") +
+                             std::to_string(static_cast<int>(std::lround(p.x))) + "," +
+                             std::to_string(static_cast<int>(std::lround(p.y))));
+        });
+        std::sort(placed.begin(), placed.end());
+        REBEL_CHECK((placed == std::vector<std::string>{"flat quad 2,0", "moved tet 22,0", "u2 tet 0,2"}));
+
+        // Importing again reuses the library's parts.
+        const io::StepImportResult again = io::importStep(*file, target, target.root(), library, options);
+        REBEL_CHECK(again.parts == 0 && again.occurrences == 3 && library.size() == 2);
+    }
+
+    // Not STEP at all.
+    const std::string other = directory.file("other.stp");
+    writeFile(other, {'s', 'o', 'l', 'i', 'd', ' ', 'x', '\n'});
+    bool threw = false;
+    try {
+        io::StepFile::open(other);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    REBEL_CHECK(threw);
+}
+
+std::vector<std::uint8_t> bytesOf(std::string_view text) {
+    return {text.begin(), text.end()};
+}
+
+bool openRejected(const std::string& path) {
+    try {
+        io::ResourceBundle::open(path);
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+void bundleRoundTrip() {
+    TempDirectory directory;
+    const std::string source = directory.file("icon.png");
+    writeFile(source, std::vector<std::uint8_t>(300, 0x7f));
+    io::ResourceBundleWriter writer;
+    writer.add("shaders/mesh.vert", bytesOf("void main() {}"));
+    writer.add("shaders/mesh.frag", bytesOf("stale"));
+    writer.add("shaders/mesh.frag", bytesOf("out vec4 color;"));
+    writer.add("shadersX", bytesOf("not a shader"));
+    writer.add("empty", nullptr, 0);
+    writer.addFile("icons/app.png", source);
+    REBEL_CHECK(writer.size() == 5);
+    const std::string path = directory.file("startup.bundle");
+    writer.write(path);
+
+    const auto bundle = io::ResourceBundle::open(path);
+    REBEL_CHECK(bundle->size() == 5);
+    for (std::uint32_t i = 0; i < bundle->size(); ++i) {
+        const io::Resource r = bundle->resource(i);
+        REBEL_CHECK(i == 0 || bundle->resource(i - 1).name < r.name);
+        REBEL_CHECK(bundle->find(r.name) == i && bundle->verify(i));
+        REBEL_CHECK(r.size == 0 || (r.data - bundle->file().data()) % 64 == 0);
+    }
+    REBEL_CHECK(bundle->get("shaders/mesh.frag").text() == "out vec4 color;");
+    REBEL_CHECK(bundle->get("icons/app.png").size == 300 && bundle->get("icons/app.png").data[299] == 0x7f);
+    REBEL_CHECK(bundle->get("empty").size == 0);
+    REBEL_CHECK(bundle->find("shaders/") == io::ResourceBundle::kNotFound);
+    const auto shaders = bundle->range("shaders/");
+    REBEL_CHECK(shaders.second - shaders.first == 2 && bundle->resource(shaders.first).name == "shaders/mesh.frag");
+    REBEL_CHECK(bundle->range("shaders").second - bundle->range("shaders").first == 3);
+    REBEL_CHECK(bundle->range("textures/").first == bundle->range("textures/").second);
+    bundle->prefetch(shaders.first, shaders.second);
+    bool threw = false;
+    try {
+        bundle->get("missing");
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    REBEL_CHECK(threw);
+
+    // Carried forward with a new blob and written over itself, while the
+    // old bundle stays mapped and readable.
+    io::ResourceBundleWriter update;
+    update.addBundle(bundle);
+    update.add("cache/device-1", bytesOf("pipeline"));
+    update.write(path);
+    const auto updated = io::ResourceBundle::open(path);
+    REBEL_CHECK(updated->size() == 6 && updated->get("cache/device-1").text() == "pipeline");
+    REBEL_CHECK(updated->get("shaders/mesh.vert").text() == "void main() {}");
+    REBEL_CHECK(bundle->size() == 5 && bundle->get("shaders/mesh.vert").text() == "void main() {}");
+}
+
+void corruptBundleRejected() {
+    TempDirectory directory;
+    io::ResourceBundleWriter writer;
+    writer.add("a", bytesOf("alpha"));
+    writer.add("b", bytesOf("bravo"));
+    const std::string path = directory.file("clean.bundle");
+    writer.write(path);
+    const std::vector<std::uint8_t> clean = readFile(path);
+    auto damaged = [&](const std::string& name, auto&& edit) {
+        std::vector<std::uint8_t> copy = clean;
+        edit(copy);
+        const std::string damagedPath = directory.file(name);
+        writeFile(damagedPath, copy);
+        return damagedPath;
+    };
+
+    // Header fields: magic, version, byte order, file size. The tables
+    // follow at the offsets the header records.
+    REBEL_CHECK(openRejected(damaged("magic.bundle", [](auto& b) { b[0] = 'X'; })));
+    REBEL_CHECK(openRejected(damaged("version.bundle", [](auto& b) { b[8] = 2; })));
+    REBEL_CHECK(openRejected(damaged("order.bundle", [](auto& b) { std::swap(b[12], b[15]); })));
+    REBEL_CHECK(openRejected(damaged("truncated.bundle", [](auto& b) { b.pop_back(); })));
+    REBEL_CHECK(openRejected(damaged("short.bundle", [](auto& b) { b.resize(100); })));
+    REBEL_CHECK(openRejected(directory.file("missing.bundle")));
+    const auto entries = load<io::layout::ArrayRef>(clean, 24);
+    const auto strings = load<io::layout::ArrayRef>(clean, 40);
+    REBEL_CHECK(entries.count == 2 && strings.count == 2);
+    REBEL_CHECK(openRejected(damaged("tables.bundle", [&](auto& b) { b[entries.offset + 8] ^= 1; })));
+    REBEL_CHECK(openRejected(damaged("names.bundle", [&](auto& b) { b[strings.offset] = 'c'; })));
+    REBEL_CHECK(openRejected(damaged("range.bundle", [&](auto& b) { b[24 + 8] = 200; })));
+
+    // A table consistent with its hash but pointing past the end.
+    REBEL_CHECK(openRejected(damaged("past.bundle", [&](auto& b) {
+        const std::uint64_t huge = b.size();
+        std::memcpy(b.data() + entries.offset + 16, &huge, sizeof(huge));
+        const core::Hash128 hash = core::Hasher()
+                                       .addBytes(b.data() + entries.offset, strings.offset - entries.offset)
+                                       .addBytes(b.data() + strings.offset, strings.count)
+                                       .finish();
+        std::memcpy(b.data() + 56, &hash, sizeof(hash));
+    })));
+
+    // Damaged resource bytes pass the open but fail verification.
+    const auto bundle = io::ResourceBundle::open(path);
+    const std::uint64_t second = static_cast<std::uint64_t>(bundle->get("b").data - bundle->file().data());
+    const auto flipped = io::ResourceBundle::open(damaged("bytes.bundle", [&](auto& b) { b[second] ^= 0x20; }));
+    REBEL_CHECK(flipped->verify(0) && !flipped->verify(1) && flipped->get("b").text() == "Bravo");
+}
+
+} // namespace
+
+void registerIoTests(Registry& registry) {
+    registry.add({"io.bundle.round_trip", bundleRoundTrip});
+    registry.add({"io.bundle.corrupt_rejected", corruptBundleRejected});
+    registry.add({"io.export.crc_combine", crcCombine});
+    registry.add({"io.export.stl_triangles", stlTriangles});
+    registry.add({"io.export.three_mf_package", threeMfPackage});
+    registry.add({"io.export.glb_chunks", glbChunks});
+    registry.add({"io.native.clean_file_loads", cleanFileLoads});
+    registry.add({"io.native.corrupt_sections_rejected", corruptSectionsRejected});
+    registry.add({"io.native.truncated_file_rejected", truncatedFileRejected});
+    registry.add({"io.step.import_fixture", stepImportFixture});
+}
+
+} // namespace rebel::test
@@ -0,0 +1,304 @@
+#include "Test.hpp"
+
+#include "rebel/math/Batch.hpp"
+#include "rebel/math/Predicates.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace rebel::test {
+
+namespace {
+
+using math::Aabb;
+using math::Intersection;
+using math::Mat4f;
+using math::Vec2d;
+using math::Vec3d;
+using math::Vec3f;
+namespace batch = math::batch;
+
+template <typename T>
+bool bitIdentical(const std::vector<T>& a, const std::vector<T>& b) {
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+}
+
+/// Restores the dispatched backend when a test forcing others ends.
+class BackendScope {
+public:
+    BackendScope() : saved_(batch::activeBackend()) {}
+    ~BackendScope() { batch::setBackend(saved_); }
+
+private:
+    batch::Backend saved_;
+};
+
+std::vector<batch::Backend> simdBackends() {
+    std::vector<batch::Backend> backends;
+    for (batch::Backend b : {batch::Backend::Sse2, batch::Backend::Avx2, batch::Backend::Neon}) {
+        if (batch::isSupported(b)) {
+            backends.push_back(b);
+        }
+    }
+    return backends;
+}
+
+/// Triangle soup mixing random triangles with ones the ray hits exactly on
+/// an edge or a vertex, degenerate ones and ones parallel to it. The count
+/// is odd so every backend runs its scalar tail too.
+struct Soup {
+    explicit Soup(std::size_t count) {
+        std::mt19937 rng(17);
+        std::uniform_real_distribution<float> u(-2.0f, 2.0f);
+        for (std::size_t i = 0; i < count; ++i) {
+            Vec3f v0{u(rng), u(rng), u(rng) + 5.0f};
+            Vec3f e1{u(rng), u(rng), u(rng)};
+            Vec3f e2{u(rng), u(rng), u(rng)};
+            switch (i % 5) {
+            case 1:
+                // The ray along +z through the origin crosses edge v0-v1.
+                v0 = {-1.0f, 0.0f, 3.0f};
+                e1 = {2.0f, 0.0f, 0.0f};
+                e2 = {1.0f, 1.0f, 0.0f};
+                break;
+            case 2:
+                v0 = {0.0f, 0.0f, 4.0f};
+                e1 = {1.0f, 0.0f, 0.0f};
+                e2 = {0.0f, 1.0f, 0.0f};
+                break;
+            case 3:
+                e2 = e1 * 2.0f;
+                break;
+            case 4:
+                e1.z = 0.0f;
+                e2 = {0.0f, 0.0f, 1.0f};
+                break;
+            default:
+                break;
+            }
+            v0x.push_back(v0.x);
+            v0y.push_back(v0.y);
+            v0z.push_back(v0.z);
+            e1x.push_back(e1.x);
+            e1y.push_back(e1.y);
+            e1z.push_back(e1.z);
+            e2x.push_back(e2.x);
+            e2y.push_back(e2.y);
+            e2z.push_back(e2.z);
+        }
+    }
+
+    batch::TriangleBatch view() const {
+        return {v0x.data(), v0y.data(), v0z.data(), e1x.data(), e1y.data(),
+                e1z.data(), e2x.data(), e2y.data(), e2z.data(), v0x.size()};
+    }
+
+    std::vector<float> v0x, v0y, v0z, e1x, e1y, e1z, e2x, e2y, e2z;
+};
+
+/// Every kernel's output for one backend, compared bit for bit.
+struct KernelOutputs {
+    std::vector<float> px, py, pz;
+    std::vector<Aabb> boxes;
+    std::vector<float> tHit;
+    std::size_t closest = 0;
+    float tClosest = 0.0f;
+    std::vector<float> lo, hi;
+    std::vector<double> basis, derivatives;
+
+    bool operator==(const KernelOutputs& o) const {
+        return bitIdentical(px, o.px) && bitIdentical(py, o.py) && bitIdentical(pz, o.pz) &&
+               bitIdentical(boxes, o.boxes) && bitIdentical(tHit, o.tHit) && closest == o.closest &&
+               std::memcmp(&tClosest, &o.tClosest, sizeof(float)) == 0 && bitIdentical(lo, o.lo) &&
+               bitIdentical(hi, o.hi) && bitIdentical(basis, o.basis) && bitIdentical(derivatives, o.derivatives);
+    }
+};
+
+KernelOutputs runKernels(batch::Backend backend) {
+    batch::setBackend(backend);
+    constexpr std::size_t kCount = 1037;
+    const Soup soup(kCount);
+    const batch::TriangleBatch tri = soup.view();
+    const Mat4f m = Mat4f::translation({0.25f, -3.0f, 7.5f}) * Mat4f::rotation({1.0f, 2.0f, 3.0f}, 0.7f) *
+                    Mat4f::scale({1.5f, -0.5f, 2.0f});
+
+    KernelOutputs out;
+    out.px.resize(kCount);
+    out.py.resize(kCount);
+    out.pz.resize(kCount);
+    batch::transformPoints(m, tri.v0x, tri.v0y, tri.v0z, out.px.data(), out.py.data(), out.pz.data(), kCount);
+
+    std::vector<Mat4f> matrices(kCount);
+    std::vector<Aabb> local(kCount);
+    for (std::size_t i = 0; i < kCount; ++i) {
+        matrices[i] = Mat4f::rotation({0.0f, 0.0f, 1.0f}, 0.01f * static_cast<float>(i)) * m;
+        const Vec3f v0{tri.v0x[i], tri.v0y[i], tri.v0z[i]};
+        local[i] = {v0, v0 + Vec3f{1.0f, 2.0f, 0.0f}};
+    }
+    out.boxes.resize(kCount);
+    batch::transformAabbs(matrices.data(), local.data(), out.boxes.data(), kCount);
+
+    math::Ray ray;
+    ray.origin = {0.0f, 0.0f, 0.0f};
+    ray.direction = {0.0f, 0.0f, 1.0f};
+    out.tHit.resize(kCount);
+    batch::intersectRayTriangles(ray, tri, out.tHit.data());
+    std::vector<float> scratch(kCount);
+    ray.direction = {0.1f, -0.05f, 1.0f};
+    out.closest = batch::closestRayTriangle(ray, tri, scratch.data(), &out.tClosest);
+
+    out.lo.resize(kCount);
+    out.hi.resize(kCount);
+    batch::trianglePlaneRanges({0.3f, 0.4f, 0.866f}, 2.5f, tri, out.lo.data(), out.hi.data());
+
+    constexpr unsigned kDegree = 3;
+    constexpr std::size_t kSamples = 101;
+    std::vector<double> knots{0, 0, 0, 0, 1, 2, 2.5, 4, 5, 5, 5, 5};
+    std::vector<double> t(kSamples);
+    std::vector<std::uint32_t> spans(kSamples);
+    for (std::size_t i = 0; i < kSamples; ++i) {
+        t[i] = 5.0 * static_cast<double>(i) / kSamples;
+        std::uint32_t s = kDegree;
+        while (knots[s + 1] <= t[i]) {
+            ++s;
+        }
+        spans[i] = s;
+    }
+    out.basis.resize((kDegree + 1) * kSamples);
+    out.derivatives.resize((kDegree + 1) * kSamples);
+    batch::bsplineBasis(knots.data(), kDegree, t.data(), spans.data(), kSamples, out.basis.data(),
+                        out.derivatives.data());
+    return out;
+}
+
+void simdMatchesScalar() {
+    const BackendScope scope;
+    const KernelOutputs scalar = runKernels(batch::Backend::Scalar);
+    // The soup must exercise hits, misses and edge hits alike.
+    std::size_t hits = 0;
+    for (float t : scalar.tHit) {
+        hits += t < std::numeric_limits<float>::infinity() ? 1 : 0;
+    }
+    REBEL_CHECK(hits > 0 && hits < scalar.tHit.size());
+    REBEL_CHECK(scalar.closest < scalar.tHit.size());
+    for (batch::Backend backend : simdBackends()) {
+        REBEL_CHECK(runKernels(backend) == scalar);
+    }
+}
+
+int sign(double v) {
+    return v > 0.0 ? 1 : v < 0.0 ? -1 : 0;
+}
+
+void orient2dNearCollinear() {
+    // Points a few ulps off the line y = x, far from the other two points:
+    // the naive determinant gets the sign wrong for many of them.
+    const double ulp = std::nextafter(0.5, 1.0) - 0.5;
+    const Vec2d q{12.0, 12.0};
+    const Vec2d r{24.0, 24.0};
+    for (int i = 0; i < 32; ++i) {
+        for (int j = 0; j < 32; ++j) {
+            const Vec2d p{0.5 + i * ulp, 0.5 + j * ulp};
+            REBEL_CHECK(sign(math::orient2d(p, q, r)) == sign(j - i));
+        }
+    }
+    REBEL_CHECK(math::orient2d({0.0, 0.0}, {1.0, 0.0}, {0.0, 1.0}) > 0.0);
+    REBEL_CHECK(math::orient2d({0.0, 0.0}, {0.0, 1.0}, {1.0, 0.0}) < 0.0);
+}
+
+void orient3dNearCoplanar() {
+    // Large coordinates on the plane z = x + 2y, where every point is
+    // exactly representable, and the fourth point nudged by one ulp.
+    const Vec3d a{1e15, 3.0, 1e15 + 6.0};
+    const Vec3d b{-7e14, 5e14, 3e14};
+    const Vec3d c{2.5, -1e14, -2e14 + 2.5};
+    const Vec3d d{4e14, 4e14, 1.2e15};
+    REBEL_CHECK(math::orient3d(a, b, c, d) == 0.0);
+    const int below = sign(math::orient3d(a, b, c, {d.x, d.y, std::nextafter(d.z, -INFINITY)}));
+    const int above = sign(math::orient3d(a, b, c, {d.x, d.y, std::nextafter(d.z, INFINITY)}));
+    REBEL_CHECK(below != 0 && above == -below);
+    // a, b, c counter-clockwise seen from +z: +z is above.
+    REBEL_CHECK(math::orient3d({0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0.25, 0.25, -1e-300}) > 0.0);
+}
+
+void incircleCocircular() {
+    REBEL_CHECK(math::incircle({1, 0}, {0, 1}, {-1, 0}, {0, -1}) == 0.0);
+    REBEL_CHECK(math::incircle({1, 0}, {0, 1}, {-1, 0}, {0, std::nextafter(-1.0, 0.0)}) > 0.0);
+    REBEL_CHECK(math::incircle({1, 0}, {0, 1}, {-1, 0}, {0, std::nextafter(-1.0, -2.0)}) < 0.0);
+}
+
+void segmentDegeneracies() {
+    using math::intersectSegments;
+    REBEL_CHECK(intersectSegments({0, 0}, {2, 2}, {0, 2}, {2, 0}) == Intersection::Proper);
+    // Endpoint on the other segment, shared endpoints, collinear overlap.
+    REBEL_CHECK(intersectSegments({0, 0}, {2, 0}, {1, 0}, {1, 5}) == Intersection::Touching);
+    REBEL_CHECK(intersectSegments({0, 0}, {2, 0}, {2, 0}, {3, 1}) == Intersection::Touching);
+    REBEL_CHECK(intersectSegments({0, 0}, {2, 0}, {1, 0}, {3, 0}) == Intersection::Touching);
+    // Collinear but apart, parallel, and near misses.
+    REBEL_CHECK(intersectSegments({0, 0}, {1, 0}, {2, 0}, {3, 0}) == Intersection::None);
+    REBEL_CHECK(intersectSegments({0, 0}, {1, 0}, {0, 1}, {1, 1}) == Intersection::None);
+    REBEL_CHECK(intersectSegments({0, 0}, {2, 0}, {1, std::nextafter(0.0, 1.0)}, {1, 5}) == Intersection::None);
+}
+
+void segmentTriangleDegeneracies() {
+    using math::intersectSegmentTriangle;
+    const Vec3d a{0, 0, 0};
+    const Vec3d b{4, 0, 0};
+    const Vec3d c{0, 4, 0};
+    REBEL_CHECK(intersectSegmentTriangle({1, 1, -1}, {1, 1, 1}, a, b, c) == Intersection::Proper);
+    // Ending on the face, crossing an edge or a vertex, lying in the plane.
+    REBEL_CHECK(intersectSegmentTriangle({1, 1, 0}, {1, 1, 1}, a, b, c) == Intersection::Touching);
+    REBEL_CHECK(intersectSegmentTriangle({2, 0, -1}, {2, 0, 1}, a, b, c) == Intersection::Touching);
+    REBEL_CHECK(intersectSegmentTriangle({0, 0, -1}, {0, 0, 1}, a, b, c) == Intersection::Touching);
+    REBEL_CHECK(intersectSegmentTriangle({-1, 1, 0}, {5, 1, 0}, a, b, c) == Intersection::Touching);
+    REBEL_CHECK(intersectSegmentTriangle({5, 5, -1}, {5, 5, 1}, a, b, c) == Intersection::None);
+    REBEL_CHECK(intersectSegmentTriangle({1, 1, 0.5}, {1, 1, 1}, a, b, c) == Intersection::None);
+
+    // Collinear triangles have no normal to project along; only their
+    // edges can be met.
+    const Vec3d onX{2, 0, 0};
+    REBEL_CHECK(intersectSegmentTriangle({1, -1, 0}, {1, 1, 0}, a, b, onX) == Intersection::Touching);
+    REBEL_CHECK(intersectSegmentTriangle({3, 0, -1}, {3, 0, 1}, a, onX, b) == Intersection::Touching);
+    REBEL_CHECK(intersectSegmentTriangle({10, -1, -1}, {10, 1, 1}, a, b, onX) == Intersection::None);
+    REBEL_CHECK(intersectSegmentTriangle({1, -1, 1}, {1, 1, 1}, a, b, onX) == Intersection::None);
+    const Vec3d yz0{0, 2, 2};
+    const Vec3d yz1{0, 1, 1};
+    REBEL_CHECK(intersectSegmentTriangle({5, 1, 1}, {5, 2, 2}, a, yz0, yz1) == Intersection::None);
+    REBEL_CHECK(intersectSegmentTriangle({0, 0, 1}, {0, 2, 1}, a, yz0, yz1) == Intersection::Touching);
+    REBEL_CHECK(intersectSegmentTriangle({-1, 3, 3}, {1, 3, 3}, a, yz0, yz1) == Intersection::None);
+    const Vec3d point{1, 1, 1};
+    REBEL_CHECK(intersectSegmentTriangle({0, 0, 0}, {2, 2, 2}, point, point, point) == Intersection::Touching);
+    REBEL_CHECK(intersectSegmentTriangle({0, 0, 0}, {2, 2, 1}, point, point, point) == Intersection::None);
+}
+
+void triangleDegeneracies() {
+    using math::intersectTriangles;
+    const Vec3d a{0, 0, 0};
+    const Vec3d b{4, 0, 0};
+    const Vec3d c{0, 4, 0};
+    // One triangle piercing the other.
+    REBEL_CHECK(intersectTriangles(a, b, c, {1, 1, -1}, {1, 1, 1}, {3, -3, 0.5}) == Intersection::Proper);
+    // Neighbours sharing an edge, meeting at a vertex, coplanar overlap.
+    REBEL_CHECK(intersectTriangles(a, b, c, a, b, {2, -1, 3}) == Intersection::Touching);
+    REBEL_CHECK(intersectTriangles(a, b, c, b, {6, 1, 1}, {6, -1, 1}) == Intersection::Touching);
+    REBEL_CHECK(intersectTriangles(a, b, c, {1, 1, 0}, {5, 1, 0}, {1, 5, 0}) == Intersection::Touching);
+    REBEL_CHECK(intersectTriangles(a, b, c, {0, 0, 1}, {4, 0, 1}, {0, 4, 1}) == Intersection::None);
+    REBEL_CHECK(intersectTriangles(a, b, c, {5, 5, 0}, {8, 5, 0}, {5, 8, 0}) == Intersection::None);
+}
+
+} // namespace
+
+void registerMathTests(Registry& registry) {
+    registry.add({"math.simd.bit_identical_to_scalar", simdMatchesScalar});
+    registry.add({"math.predicates.orient2d_near_collinear", orient2dNearCollinear});
+    registry.add({"math.predicates.orient3d_near_coplanar", orient3dNearCoplanar});
+    registry.add({"math.predicates.incircle_cocircular", incircleCocircular});
+    registry.add({"math.predicates.segment_degeneracies", segmentDegeneracies});
+    registry.add({"math.predicates.segment_triangle_degeneracies", segmentTriangleDegeneracies});
+    registry.add({"math.predicates.triangle_degeneracies", triangleDegeneracies});
+}
+
+} // namespace rebel::test
@@ -0,0 +1,202 @@
+#include "Fixtures.hpp"
+#include "Test.hpp"
+
+#include "rebel/render/SectionView.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace rebel::test {
+
+namespace {
+
+using math::Mat4f;
+using math::Vec3d;
+using math::Vec3f;
+using render::SectionPlane;
+using render::SectionView;
+
+/// Area of a cut's cap, and whether every cap triangle faces along `normal`
+/// (slivers left by ear clipping and trimming may round either way).
+double capArea(const render::SectionCut& cut, const Vec3d& normal, bool& facing) {
+    double area = 0.0;
+    facing = true;
+    for (std::size_t k = 0; k + 2 < cut.cap.size(); k += 3) {
+        const Vec3d a(cut.cap[k]);
+        const Vec3d n = math::cross(Vec3d(cut.cap[k + 1]) - a, Vec3d(cut.cap[k + 2]) - a);
+        area += 0.5 * math::length(n);
+        facing = facing && math::dot(n, normal) > -1e-6;
+    }
+    return area;
+}
+
+double outlineLength(const render::SectionCut& cut) {
+    double length = 0.0;
+    for (std::size_t k = 0; k + 1 < cut.edges.size(); k += 2) {
+        length += math::length(Vec3d(cut.edges[k + 1]) - Vec3d(cut.edges[k]));
+    }
+    return length;
+}
+
+/// A unit cube, one below and one above it, a torus beside it, and an open
+/// cube missing its x = 0 face.
+struct SectionFixture {
+    assembly::PartLibrary library;
+    assembly::Assembly model;
+    assembly::NodeId cube;
+    assembly::NodeId below;
+    assembly::NodeId above;
+    assembly::NodeId torus;
+    assembly::NodeId open;
+    assembly::AssemblyIndex index{model, library};
+
+    SectionFixture() {
+        const assembly::PartId box = library.add(bodyPart("box", brep::makeBox({0, 0, 0}, {1, 1, 1})));
+        const assembly::PartId ring = library.add(bodyPart("ring", brep::makeTorus({0, 0, 0}, 2.0, 0.5), 0.001));
+        const geometry::Mesh closed = bodyMesh(brep::makeBox({0, 0, 0}, {1, 1, 1}));
+        geometry::Mesh sliced;
+        for (std::size_t v = 0; v < closed.vertexCount(); ++v) {
+            sliced.addVertex(closed.position(static_cast<geometry::VertexIndex>(v)));
+        }
+        for (std::size_t t = 0; t < closed.triangleCount(); ++t) {
+            geometry::VertexIndex v[3];
+            bool onFace = true;
+            for (int k = 0; k < 3; ++k) {
+                v[k] = closed.vertex(static_cast<geometry::CornerIndex>(3 * t + k));
+                onFace = onFace && closed.position(v[k]).x == 0.0f;
+            }
+            if (!onFace) {
+                sliced.addTriangle(v[0], v[1], v[2]);
+            }
+        }
+        const assembly::PartId hollow = library.add(assembly::Part::create("open", std::move(sliced)));
+
+        cube = model.addOccurrence(model.root(), box, Mat4f::identity());
+        below = model.addOccurrence(model.root(), box, Mat4f::translation({0, 0, -5}));
+        above = model.addOccurrence(model.root(), box, Mat4f::translation({0, 0, 5}));
+        torus = model.addOccurrence(model.root(), ring, Mat4f::translation({10, 0, 0}));
+        open = model.addOccurrence(model.root(), hollow, Mat4f::translation({0, 10, 0}));
+        index.update();
+    }
+
+    const render::SectionCut* cut(const SectionView& view, assembly::NodeId node, std::uint32_t plane = 0) const {
+        return view.cut(index.instance(node), plane);
+    }
+};
+
+void planeCutsCube() {
+    SectionFixture f;
+    SectionView view(f.index);
+    view.setPlane({{0, 0, 1}, 0.5});
+    view.update();
+    REBEL_CHECK(view.side(f.index.instance(f.cube)) == render::SectionSide::Cut);
+    REBEL_CHECK(view.side(f.index.instance(f.below)) == render::SectionSide::Kept);
+    REBEL_CHECK(view.side(f.index.instance(f.above)) == render::SectionSide::Removed);
+    REBEL_CHECK(!f.cut(view, f.below) && !f.cut(view, f.above));
+
+    // A unit square: four sides of outline at the cut height, capped.
+    const render::SectionCut* square = f.cut(view, f.cube);
+    REBEL_CHECK(square && square->openChains == 0 && !square->edges.empty());
+    for (const Vec3f& p : square->edges) {
+        const bool onSide = p.x == 0.0f || p.x == 1.0f || p.y == 0.0f || p.y == 1.0f;
+        REBEL_CHECK(p.z == 0.5f && onSide);
+    }
+    REBEL_CHECK(std::abs(outlineLength(*square) - 4.0) < 1e-6);
+    bool facing = false;
+    REBEL_CHECK(std::abs(capArea(*square, {0, 0, 1}, facing) - 1.0) < 1e-6 && facing);
+
+    // Tilted through the centre, the cut is a regular hexagon of side
+    // sqrt(1/2).
+    const Vec3d tilt = math::normalize(Vec3d{1, 1, 1});
+    view.setPlane({{1, 1, 1}, 1.5});
+    view.update();
+    const render::SectionCut* hexagon = f.cut(view, f.cube);
+    REBEL_CHECK(hexagon && hexagon->openChains == 0);
+    REBEL_CHECK(std::abs(outlineLength(*hexagon) - 6.0 * std::sqrt(0.5)) < 1e-5);
+    REBEL_CHECK(std::abs(capArea(*hexagon, tilt, facing) - 0.75 * std::sqrt(3.0)) < 1e-5 && facing);
+}
+
+void capsHolesAndOpenChains() {
+    SectionFixture f;
+    SectionView view(f.index);
+    view.setPlane({{0, 0, 1}, 0.5 * 0.5});
+    view.update();
+
+    // Halfway up its tube the torus cuts to an annulus; the cap leaves the
+    // hole open.
+    const double r = std::sqrt(0.5 * 0.5 - 0.25 * 0.25);
+    const double annulus = 3.14159265358979 * ((2.0 + r) * (2.0 + r) - (2.0 - r) * (2.0 - r));
+    const render::SectionCut* ring = f.cut(view, f.torus);
+    bool facing = false;
+    REBEL_CHECK(ring && ring->openChains == 0);
+    REBEL_CHECK(std::abs(capArea(*ring, {0, 0, 1}, facing) - annulus) < 0.01 * annulus && facing);
+    for (std::size_t k = 0; k + 2 < ring->cap.size(); k += 3) {
+        const Vec3f centroid = (ring->cap[k] + ring->cap[k + 1] + ring->cap[k + 2]) * (1.0f / 3.0f);
+        REBEL_CHECK(std::hypot(centroid.x - 10.0f, centroid.y) > 2.0 - r - 0.01);
+    }
+
+    // The open cube's loop runs into the missing face: outlined, not capped.
+    const render::SectionCut* open = f.cut(view, f.open);
+    REBEL_CHECK(open && open->openChains == 1 && open->cap.empty());
+    REBEL_CHECK(std::abs(outlineLength(*open) - 3.0) < 1e-6);
+}
+
+void boxUpdatesOnlyWhatMoved() {
+    SectionFixture f;
+    SectionView view(f.index);
+    // Only the -x face crosses the cube.
+    view.setBox({{0.5f, -1, -1}, {2, 2, 2}});
+    view.update();
+    REBEL_CHECK(view.planes().size() == 6 && view.cutCount() == 1);
+    const render::SectionCut* side = f.cut(view, f.cube, 0);
+    bool facing = false;
+    REBEL_CHECK(side && std::abs(capArea(*side, {-1, 0, 0}, facing) - 1.0) < 1e-6 && facing);
+
+    // Pulling the +y face into the cube slices it there alone, and trims the
+    // -x cut to it.
+    view.setBox({{0.5f, -1, -1}, {2, 0.6f, 2}});
+    view.update();
+    REBEL_CHECK(view.cutCount() == 2 && view.stats().cutsSliced == 1);
+    const std::vector<render::SectionCutId> both = {{f.index.instance(f.cube), 0}, {f.index.instance(f.cube), 3}};
+    REBEL_CHECK(view.changed() == both);
+    REBEL_CHECK(std::abs(capArea(*f.cut(view, f.cube, 0), {-1, 0, 0}, facing) - 0.6) < 1e-6 && facing);
+    REBEL_CHECK(std::abs(capArea(*f.cut(view, f.cube, 3), {0, 1, 0}, facing) - 0.5) < 1e-6 && facing);
+    for (const Vec3f& p : f.cut(view, f.cube, 0)->edges) {
+        REBEL_CHECK(p.y <= 0.6f);
+    }
+
+    // Nothing changed, nothing redone.
+    view.update();
+    REBEL_CHECK(view.changed().empty() && view.stats().cutsSliced == 0 && view.stats().cutsTrimmed == 0);
+
+    // Moving the cube re-slices its cuts.
+    f.model.setLocalTransform(f.cube, Mat4f::translation({0.2f, 0, 0}));
+    view.update(f.index.update());
+    REBEL_CHECK(view.stats().cutsSliced == 2 && view.changed() == both);
+    REBEL_CHECK(std::abs(capArea(*f.cut(view, f.cube, 0), {-1, 0, 0}, facing) - 0.6) < 1e-5);
+    REBEL_CHECK(std::abs(capArea(*f.cut(view, f.cube, 3), {0, 1, 0}, facing) - 0.7) < 1e-5);
+
+    // Inside the cube every face is cut and capped in full, but trimmed to
+    // the box the outline on the cube's faces is gone.
+    view.setBox({{0.45f, 0.25f, 0.25f}, {0.95f, 0.75f, 0.75f}});
+    view.update();
+    REBEL_CHECK(view.cutCount() == 6);
+    view.forEachCut([&](const render::SectionCut& cut) {
+        REBEL_CHECK(std::abs(capArea(cut, view.planes()[cut.plane].normal, facing) - 0.25) < 1e-5 && facing);
+        REBEL_CHECK(cut.edges.empty());
+    });
+    view.clear();
+    view.update();
+    REBEL_CHECK(view.cutCount() == 0 && view.side(f.index.instance(f.cube)) == render::SectionSide::Kept);
+}
+
+} // namespace
+
+void registerRenderTests(Registry& registry) {
+    registry.add({"render.section.plane_cuts_cube", planeCutsCube});
+    registry.add({"render.section.caps_holes_and_open_chains", capsHolesAndOpenChains});
+    registry.add({"render.section.box_updates_only_what_moved", boxUpdatesOnlyWhatMoved});
+}
+
+} // namespace rebel::test
@@ -0,0 +1,135 @@
+#include "Test.hpp"
+
+#include "rebel/sketch/Sketch.hpp"
+
+#include <cmath>
+#include <vector>
+
+namespace rebel::test {
+
+namespace {
+
+using math::Vec2d;
+using sketch::ConstraintType;
+
+/// Rectangle with its lower left corner at `origin`, fixed there unless
+/// `fixed` is false, and left somewhat off its dimensions so the solver has
+/// work to do.
+struct Rectangle {
+    sketch::EntityId corners[4];
+    sketch::ConstraintId width;
+    sketch::ConstraintId height;
+};
+
+Rectangle addRectangle(sketch::Sketch& s, const Vec2d& origin, double w, double h, bool fixed = true) {
+    Rectangle r;
+    r.corners[0] = s.addPoint(origin);
+    r.corners[1] = s.addPoint(origin + Vec2d{w * 1.2, 0.1});
+    r.corners[2] = s.addPoint(origin + Vec2d{w * 0.9, h * 1.3});
+    r.corners[3] = s.addPoint(origin + Vec2d{-0.2, h * 0.8});
+    s.setFixed(r.corners[0], fixed);
+    sketch::EntityId edges[4];
+    for (int i = 0; i < 4; ++i) {
+        edges[i] = s.addLine(r.corners[i], r.corners[(i + 1) % 4]);
+    }
+    s.addConstraint({ConstraintType::Horizontal, edges[0]});
+    s.addConstraint({ConstraintType::Vertical, edges[1]});
+    s.addConstraint({ConstraintType::Horizontal, edges[2]});
+    s.addConstraint({ConstraintType::Vertical, edges[3]});
+    r.width = s.addConstraint({ConstraintType::Length, edges[0], sketch::kInvalidEntity, w});
+    r.height = s.addConstraint({ConstraintType::Length, edges[1], sketch::kInvalidEntity, h});
+    return r;
+}
+
+bool near(const Vec2d& a, const Vec2d& b) {
+    return std::abs(a.x - b.x) < 1e-8 && std::abs(a.y - b.y) < 1e-8;
+}
+
+bool hasShape(const sketch::Sketch& s, const Rectangle& r, const Vec2d& origin, double w, double h) {
+    return near(s.point(r.corners[0]), origin) && near(s.point(r.corners[1]), origin + Vec2d{w, 0}) &&
+           near(s.point(r.corners[2]), origin + Vec2d{w, h}) && near(s.point(r.corners[3]), origin + Vec2d{0, h});
+}
+
+void solverConverges() {
+    sketch::Sketch s;
+    const Rectangle r = addRectangle(s, {1, 2}, 4, 3);
+    // A circle through one corner, centered on the opposite one.
+    const sketch::EntityId circle = s.addCircle(r.corners[0], 4.5);
+    s.addConstraint({ConstraintType::PointOnCircle, r.corners[2], circle});
+
+    const sketch::SketchSolveResult result = s.solve();
+    REBEL_CHECK(result.converged);
+    REBEL_CHECK(result.residual <= 1e-10);
+    REBEL_CHECK(result.freeParameters == 0 && result.redundantEquations == 0);
+    REBEL_CHECK(hasShape(s, r, {1, 2}, 4, 3));
+    REBEL_CHECK(std::abs(s.radius(circle) - 5.0) < 1e-8);
+}
+
+void editResolvesOnlyAffectedCluster() {
+    sketch::Sketch s;
+    std::vector<Rectangle> rectangles;
+    for (int i = 0; i < 8; ++i) {
+        // The last one is free to move as a whole.
+        rectangles.push_back(addRectangle(s, {10.0 * i, 0}, 2, 1, i != 7));
+    }
+    const sketch::SketchSolveResult first = s.solve();
+    REBEL_CHECK(first.converged && first.blocksSolved == first.blockCount);
+
+    std::vector<Vec2d> before;
+    for (sketch::EntityId p = 0; p < s.entityCount(); ++p) {
+        if (s.entity(p).type == sketch::EntityType::Point) {
+            before.push_back(s.point(p));
+        }
+    }
+    auto othersUntouched = [&](std::size_t changed) {
+        std::size_t k = 0;
+        for (sketch::EntityId p = 0; p < s.entityCount(); ++p) {
+            if (s.entity(p).type != sketch::EntityType::Point) {
+                continue;
+            }
+            const bool mine = p >= rectangles[changed].corners[0] && p <= rectangles[changed].corners[3];
+            if (!mine && !(s.point(p) == before[k])) {
+                return false;
+            }
+            ++k;
+        }
+        return true;
+    };
+
+    // A dimension edit re-solves a few blocks of its own rectangle only.
+    s.setValue(rectangles[3].width, 5.0);
+    const sketch::SketchSolveResult edit = s.solve();
+    REBEL_CHECK(edit.converged);
+    REBEL_CHECK(edit.blocksSolved > 0 && edit.blocksSolved * 8 <= first.blockCount);
+    REBEL_CHECK(hasShape(s, rectangles[3], {30, 0}, 5, 1));
+    REBEL_CHECK(othersUntouched(3));
+
+    // Dragging a corner of the free rectangle moves only that one, in
+    // shape.
+    for (sketch::EntityId p = 0, k = 0; p < s.entityCount(); ++p) {
+        if (s.entity(p).type == sketch::EntityType::Point) {
+            before[k++] = s.point(p);
+        }
+    }
+    const sketch::SketchSolveResult drag = s.drag(rectangles[7].corners[2], {83, 4});
+    REBEL_CHECK(drag.converged);
+    REBEL_CHECK(drag.blocksSolved * 8 <= first.blockCount);
+    REBEL_CHECK(hasShape(s, rectangles[7], {81, 3}, 2, 1));
+    REBEL_CHECK(othersUntouched(7));
+
+    // An edit still pending when another point is grabbed is not lost.
+    s.setValue(rectangles[1].height, 2.0);
+    REBEL_CHECK(s.drag(rectangles[7].corners[0], {82, 3.5}).converged);
+    REBEL_CHECK(hasShape(s, rectangles[1], {10, 0}, 2, 2));
+    REBEL_CHECK(hasShape(s, rectangles[7], {82, 3.5}, 2, 1));
+    REBEL_CHECK(s.solve().converged);
+}
+
+} // namespace
+
+void registerSketchTests(Registry& registry) {
+    registry.add({"sketch.solver.converges", solverConverges});
+    registry.add({"sketch.solver.edit_resolves_affected_cluster", editResolvesOnlyAffectedCluster});
+}
+
+} // namespace rebel::test
@@ -0,0 +1,198 @@
+#include "Test.hpp"
+
+#include "rebel/spatial/Bvh.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace rebel::test {
+
+namespace {
+
+using math::Aabb;
+using math::Vec3f;
+using spatial::Bvh;
+using spatial::BvhNode;
+
+/// Union of the current boxes of every primitive below `node`.
+Aabb subtreeBounds(const Bvh& bvh, const std::vector<Aabb>& boxes, std::uint32_t index) {
+    const BvhNode& node = bvh.nodes()[index];
+    Aabb box;
+    if (node.isLeaf()) {
+        for (std::uint32_t k = 0; k < node.count; ++k) {
+            box.expand(boxes[bvh.primitives()[node.first + k]]);
+        }
+    } else {
+        box = subtreeBounds(bvh, boxes, node.first);
+        box.expand(subtreeBounds(bvh, boxes, node.first + 1));
+    }
+    return box;
+}
+
+/// Every node's box is exactly the union of its primitives.
+bool tight(const Bvh& bvh, const std::vector<Aabb>& boxes) {
+    for (std::uint32_t i = 0; i < bvh.nodeCount(); ++i) {
+        if (!(bvh.nodes()[i].bounds == subtreeBounds(bvh, boxes, i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int depthOf(const Bvh& bvh, std::uint32_t index) {
+    const BvhNode& node = bvh.nodes()[index];
+    return node.isLeaf() ? 0 : 1 + std::max(depthOf(bvh, node.first), depthOf(bvh, node.first + 1));
+}
+
+/// Overlap query refined per primitive, as callers do: the tree reports
+/// every primitive of an overlapping leaf.
+std::vector<std::uint32_t> overlapping(const Bvh& bvh, const std::vector<Aabb>& boxes, const Aabb& box) {
+    std::vector<std::uint32_t> found;
+    bvh.queryOverlap(box, [&](std::uint32_t primitive) {
+        if (boxes[primitive].overlaps(box)) {
+            found.push_back(primitive);
+        }
+        return true;
+    });
+    std::sort(found.begin(), found.end());
+    return found;
+}
+
+std::vector<std::uint32_t> overlappingBruteForce(const std::vector<Aabb>& boxes, const Aabb& box) {
+    std::vector<std::uint32_t> found;
+    for (std::uint32_t i = 0; i < boxes.size(); ++i) {
+        if (boxes[i].overlaps(box)) {
+            found.push_back(i);
+        }
+    }
+    return found;
+}
+
+void refitSharedAncestors() {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<Aabb> boxes;
+    for (int x = 0; x < 12; ++x) {
+        for (int y = 0; y < 12; ++y) {
+            for (int z = 0; z < 8; ++z) {
+                const Vec3f lo{static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)};
+                boxes.push_back({lo, lo + Vec3f{0.5f + 0.4f * unit(rng), 0.6f, 0.5f}});
+            }
+        }
+    }
+    Bvh bvh = Bvh::build(boxes.data(), boxes.size());
+    REBEL_CHECK(tight(bvh, boxes));
+
+    for (int round = 0; round < 20; ++round) {
+        // A run in leaf order shares leaves and ancestors; add a few strays
+        // and a duplicate.
+        const auto start = static_cast<std::size_t>(unit(rng) * static_cast<float>(boxes.size() - 32));
+        std::vector<std::uint32_t> moved(bvh.primitives().begin() + static_cast<std::ptrdiff_t>(start),
+                                         bvh.primitives().begin() + static_cast<std::ptrdiff_t>(start + 24));
+        for (int k = 0; k < 4; ++k) {
+            moved.push_back(static_cast<std::uint32_t>(unit(rng) * static_cast<float>(boxes.size() - 1)));
+        }
+        moved.push_back(moved.front());
+
+        // Some boxes grow or jump away, others shrink in place, so some
+        // ancestors change and others stop the walk early.
+        for (std::size_t k = 0; k < moved.size(); ++k) {
+            Aabb& box = boxes[moved[k]];
+            if (k % 3 == 0) {
+                box.max = box.min + Vec3f{0.1f, 0.1f, 0.1f};
+            } else {
+                const Vec3f shift{4.0f * unit(rng) - 2.0f, 4.0f * unit(rng) - 2.0f, 3.0f * unit(rng)};
+                box = {box.min + shift, box.max + shift};
+            }
+        }
+        bvh.refit(moved.data(), moved.size(), boxes.data());
+        REBEL_CHECK(tight(bvh, boxes));
+
+        // A full refit and a fresh build agree with the incremental one.
+        Bvh full = bvh;
+        full.refitAll(boxes.data());
+        for (std::size_t i = 0; i < bvh.nodeCount(); ++i) {
+            REBEL_CHECK(full.nodes()[i].bounds == bvh.nodes()[i].bounds);
+        }
+        REBEL_CHECK(Bvh::build(boxes.data(), boxes.size()).bounds() == bvh.bounds());
+
+        const Vec3f probe{12.0f * unit(rng), 12.0f * unit(rng), 8.0f * unit(rng)};
+        const Aabb query{probe, probe + Vec3f{1.5f, 1.5f, 1.5f}};
+        REBEL_CHECK(overlapping(bvh, boxes, query) == overlappingBruteForce(boxes, query));
+    }
+
+    // Single-primitive refits keep the tree tight as well.
+    const std::uint32_t one = bvh.primitives()[10];
+    boxes[one] = {{-5.0f, -5.0f, -5.0f}, {-4.0f, -4.0f, -4.0f}};
+    bvh.refit(one, boxes.data());
+    REBEL_CHECK(tight(bvh, boxes));
+    boxes[one] = {{3.0f, 3.0f, 3.0f}, {3.1f, 3.1f, 3.1f}};
+    bvh.refit(one, boxes.data());
+    REBEL_CHECK(tight(bvh, boxes));
+}
+
+/// Checks that traversal, overlap queries and rays reach every primitive.
+void reachesAll(const Bvh& bvh, const std::vector<Aabb>& boxes) {
+    std::size_t leaves = 0;
+    bvh.traverse([](const BvhNode&) { return true; },
+                 [&](std::uint32_t) {
+                     ++leaves;
+                     return true;
+                 });
+    REBEL_CHECK(leaves == boxes.size());
+
+    Aabb all;
+    for (const Aabb& box : boxes) {
+        all.expand(box);
+    }
+    REBEL_CHECK(overlapping(bvh, boxes, all).size() == boxes.size());
+
+    // The boxes all straddle the positive x axis.
+    std::size_t hits = 0;
+    bvh.raycast(math::Ray{{-1.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}}, [&](std::uint32_t, math::Ray&) { ++hits; });
+    REBEL_CHECK(hits == boxes.size());
+}
+
+void depthCap() {
+    // Four coincident copies at every power of two in the float range; with
+    // two bins each split peels off only the largest value, so the build
+    // runs into the depth cap.
+    std::vector<Aabb> chain;
+    for (int e = -149; e <= 127; ++e) {
+        const float x = std::ldexp(1.0f, e);
+        for (int copy = 0; copy < 4; ++copy) {
+            chain.push_back({{x, -1.0f, -1.0f}, {x, 1.0f, 1.0f}});
+        }
+    }
+    spatial::BvhBuildOptions options;
+    options.binCount = 2;
+    options.forcedSplitSize = 1;
+    const Bvh capped = Bvh::build(chain.data(), chain.size(), options);
+    REBEL_CHECK(depthOf(capped, 0) == Bvh::kMaxDepth - 2);
+    reachesAll(capped, chain);
+
+    // Entirely coincident input is split by count.
+    const std::vector<Aabb> point(5000, Aabb{{1.0f, -1.0f, -1.0f}, {1.0f, 1.0f, 1.0f}});
+    for (const std::uint32_t forcedSplitSize : {1u, 64u}) {
+        spatial::BvhBuildOptions pointOptions;
+        pointOptions.forcedSplitSize = forcedSplitSize;
+        const Bvh bvh = Bvh::build(point.data(), point.size(), pointOptions);
+        REBEL_CHECK(depthOf(bvh, 0) <= Bvh::kMaxDepth - 2);
+        for (const BvhNode& node : bvh.nodes()) {
+            REBEL_CHECK(node.count <= forcedSplitSize);
+        }
+        reachesAll(bvh, point);
+    }
+}
+
+} // namespace
+
+void registerSpatialTests(Registry& registry) {
+    registry.add({"spatial.bvh.refit_shared_ancestors", refitSharedAncestors});
+    registry.add({"spatial.bvh.depth_cap", depthCap});
+}
+
+} // namespace rebel::test
@@ -0,0 +1,176 @@
+#include "Fixtures.hpp"
+#include "Test.hpp"
+
+#include "rebel/sync/Replica.hpp"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace rebel::test {
+
+namespace {
+
+using math::Mat4f;
+using math::Vec3f;
+
+/// One site: its own copy of the document and its end of the session.
+struct Site {
+    assembly::PartLibrary library;
+    assembly::Assembly model;
+    std::unique_ptr<sync::Replica> replica;
+};
+
+void publishTo(sync::Hub& hub, Site& site) {
+    const sync::Publication publication = site.replica->publish();
+    if (publication.changeSet.empty()) {
+        return;
+    }
+    for (const core::Hash128& hash : hub.missingGeometry(publication.geometry)) {
+        const sync::Message geometry = site.replica->localGeometry(hash);
+        hub.putGeometry(geometry.data(), geometry.size());
+    }
+    hub.submit(publication.changeSet.data(), publication.changeSet.size());
+}
+
+void catchUp(const sync::Hub& hub, Site& site) {
+    for (const sync::SharedMessage& message : hub.since(site.replica->sequence())) {
+        site.replica->receive(message->data(), message->size());
+        for (const core::Hash128& hash : site.replica->missingGeometry()) {
+            const sync::SharedMessage geometry = hub.geometry(hash);
+            site.replica->provideGeometry(geometry->data(), geometry->size());
+        }
+    }
+}
+
+/// Live nodes of `b` match those of `a` one to one by shared key, with
+/// the same parent, part, transform and overrides.
+bool sameDocument(const Site& a, const Site& b) {
+    std::size_t live = 0;
+    for (assembly::NodeId id = 0; id < a.model.nodeCount(); ++id) {
+        const assembly::AssemblyNode& mine = a.model.node(id);
+        if (mine.removed) {
+            continue;
+        }
+        ++live;
+        const assembly::NodeId other = b.replica->node(a.replica->key(id));
+        if (other == assembly::kInvalidNode || b.model.node(other).removed) {
+            return false;
+        }
+        const assembly::AssemblyNode& theirs = b.model.node(other);
+        const bool sameParent = mine.parent == assembly::kInvalidNode
+                                    ? theirs.parent == assembly::kInvalidNode
+                                    : theirs.parent != assembly::kInvalidNode &&
+                                          a.replica->key(mine.parent) == b.replica->key(theirs.parent);
+        const bool samePart = mine.isOccurrence() == theirs.isOccurrence() &&
+                              (!mine.isOccurrence() ||
+                               a.library.get(mine.part)->name() == b.library.get(theirs.part)->name());
+        if (!sameParent || !samePart || !(mine.local == theirs.local) || mine.overrides != theirs.overrides) {
+            return false;
+        }
+    }
+    std::size_t otherLive = 0;
+    for (assembly::NodeId id = 0; id < b.model.nodeCount(); ++id) {
+        otherLive += b.model.node(id).removed ? 0 : 1;
+    }
+    return live == otherLive;
+}
+
+void replicasConverge() {
+    const assembly::PartPtr box = bodyPart("box", brep::makeBox({0, 0, 0}, {1, 1, 1}), 0.05);
+    const assembly::PartPtr ball = bodyPart("ball", brep::makeSphere({0, 0, 0}, 0.5), 0.05);
+    constexpr std::size_t kSites = 3;
+    std::vector<std::unique_ptr<Site>> sites;
+    for (std::size_t s = 0; s < kSites; ++s) {
+        auto site = std::make_unique<Site>();
+        const assembly::PartId parts[2] = {site->library.add(box), site->library.add(ball)};
+        const assembly::NodeId group = site->model.addSubassembly(site->model.root(), Mat4f::identity(), "group");
+        for (int i = 0; i < 12; ++i) {
+            site->model.addOccurrence(i % 2 == 0 ? site->model.root() : group, parts[i % 3 == 0],
+                                      Mat4f::translation({static_cast<float>(i), 0, 0}));
+        }
+        site->replica = std::make_unique<sync::Replica>(static_cast<sync::SiteId>(s + 1), site->model, site->library);
+        sites.push_back(std::move(site));
+    }
+    sync::Hub hub;
+
+    std::mt19937 rng(29);
+    auto liveNode = [&](const Site& site) {
+        for (;;) {
+            const auto id = static_cast<assembly::NodeId>(rng() % site.model.nodeCount());
+            if (id != site.model.root() && !site.model.node(id).removed) {
+                return id;
+            }
+        }
+    };
+    for (int round = 0; round < 30; ++round) {
+        // Every site edits concurrently, often the same nodes, before any
+        // of them hears from the others.
+        for (auto& site : sites) {
+            for (int k = 0; k < 4; ++k) {
+                const assembly::NodeId node = liveNode(*site);
+                switch (rng() % 6) {
+                case 0:
+                case 1:
+                    site->model.setLocalTransform(node, Mat4f::translation({0, 0.5f * (rng() % 5), 0}) *
+                                                            site->model.node(node).local);
+                    break;
+                case 2: {
+                    assembly::Overrides overrides;
+                    overrides.flags = static_cast<std::uint8_t>(rng() % 2 ? assembly::Overrides::kHidden
+                                                                          : assembly::Overrides::kHasColor);
+                    overrides.colorRgba = static_cast<std::uint32_t>(rng());
+                    site->model.setOverrides(node, overrides);
+                    break;
+                }
+                case 3:
+                case 4: {
+                    const assembly::NodeId parent = site->model.node(node).isOccurrence() ? site->model.root() : node;
+                    site->model.addOccurrence(parent, static_cast<assembly::PartId>(rng() % 2),
+                                              Mat4f::translation({0, 0, static_cast<float>(round)}));
+                    break;
+                }
+                default:
+                    if (site->model.nodeCount() > 8) {
+                        site->model.remove(node);
+                    }
+                    break;
+                }
+            }
+        }
+        if (round == 10) {
+            // A part only one site has: the others fetch its geometry.
+            Site& owner = *sites[1];
+            const assembly::PartId extra =
+                owner.library.add(bodyPart("extra", brep::makeCylinder({0, 0, 0}, 0.3, 2.0), 0.05));
+            owner.model.addOccurrence(owner.model.root(), extra, Mat4f::identity());
+        }
+        // The hub orders the publications as they arrive; sites catch up
+        // at different times.
+        for (std::size_t s = 0; s < kSites; ++s) {
+            publishTo(hub, *sites[(s + round) % kSites]);
+            catchUp(hub, *sites[(s + 2 * round) % kSites]);
+        }
+    }
+    for (auto& site : sites) {
+        catchUp(hub, *site);
+    }
+
+    for (const auto& site : sites) {
+        REBEL_CHECK(site->replica->unacknowledged() == 0 && site->replica->waiting() == 0);
+        REBEL_CHECK(site->replica->sequence() == hub.sequence());
+        REBEL_CHECK(site->library.find("extra") != assembly::kInvalidPart);
+    }
+    for (std::size_t s = 1; s < kSites; ++s) {
+        REBEL_CHECK(sameDocument(*sites[0], *sites[s]));
+        REBEL_CHECK(sameDocument(*sites[s], *sites[0]));
+    }
+}
+
+} // namespace
+
+void registerSyncTests(Registry& registry) {
+    registry.add({"sync.replica.concurrent_edits_converge", replicasConverge});
+}
+
+} // namespace rebel::test
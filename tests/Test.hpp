@@ -0,0 +1,58 @@
+#pragma once
+
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace rebel::test {
+
+/// One behavior test. `run()` fails by throwing, usually through
+/// `REBEL_CHECK`; any exception counts as a failure.
+struct TestCase {
+    /// `suite.case`; the runner selects tests by name prefix, and CMake
+    /// registers one ctest entry per suite.
+    std::string name;
+    std::function<void()> run;
+};
+
+class Registry {
+public:
+    void add(TestCase test) { tests_.push_back(std::move(test)); }
+    const std::vector<TestCase>& all() const { return tests_; }
+
+private:
+    std::vector<TestCase> tests_;
+};
+
+class Failure : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+[[noreturn]] void fail(const char* file, int line, const std::string& what);
+
+/// Registration hooks, one per module.
+void registerCoreTests(Registry& registry);
+void registerMathTests(Registry& registry);
+void registerAssemblyTests(Registry& registry);
+void registerBooleanTests(Registry& registry);
+void registerBrepTests(Registry& registry);
+/// Only with the cli built (`REBELCAD_TESTS_CLI`).
+void registerCliTests(Registry& registry);
+void registerRenderTests(Registry& registry);
+void registerSketchTests(Registry& registry);
+void registerSpatialTests(Registry& registry);
+void registerSyncTests(Registry& registry);
+void registerFeatureTests(Registry& registry);
+void registerIoTests(Registry& registry);
+
+} // namespace rebel::test
+
+/// Fails the running test with the source location and the condition text.
+#define REBEL_CHECK(condition)                                                                                         \
+    do {                                                                                                               \
+        if (!(condition)) {                                                                                            \
+            ::rebel::test::fail(__FILE__, __LINE__, #condition);                                                       \
+        }                                                                                                              \
+    } while (false)
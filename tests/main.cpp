@@ -0,0 +1,84 @@
+#include "Test.hpp"
+
+#include <cstdio>
+#include <exception>
+#include <string>
+#include <vector>
+
+namespace rebel::test {
+
+void fail(const char* file, int line, const std::string& what) {
+    throw Failure(std::string(file) + ":" + std::to_string(line) + ": check failed: " + what);
+}
+
+} // namespace rebel::test
+
+namespace {
+
+void usage() {
+    std::fprintf(stderr,
+                 "usage: rebelcad-tests [--list] [PREFIX...]\n"
+                 "  runs the tests whose name starts with any PREFIX (all without one)\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    using namespace rebel;
+    test::Registry registry;
+    test::registerCoreTests(registry);
+    test::registerMathTests(registry);
+    test::registerAssemblyTests(registry);
+    test::registerBooleanTests(registry);
+    test::registerBrepTests(registry);
+    test::registerRenderTests(registry);
+    test::registerSketchTests(registry);
+    test::registerSpatialTests(registry);
+    test::registerSyncTests(registry);
+    test::registerFeatureTests(registry);
+    test::registerIoTests(registry);
+#ifdef REBELCAD_TESTS_CLI
+    test::registerCliTests(registry);
+#endif
+
+    std::vector<std::string> prefixes;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--list") {
+            for (const test::TestCase& t : registry.all()) {
+                std::printf("%s\n", t.name.c_str());
+            }
+            return 0;
+        } else if (arg.rfind("-", 0) == 0) {
+            usage();
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+        prefixes.push_back(arg);
+    }
+
+    std::size_t run = 0;
+    std::size_t failed = 0;
+    for (const test::TestCase& t : registry.all()) {
+        bool selected = prefixes.empty();
+        for (const std::string& prefix : prefixes) {
+            selected = selected || t.name.rfind(prefix, 0) == 0;
+        }
+        if (!selected) {
+            continue;
+        }
+        ++run;
+        try {
+            t.run();
+            std::printf("ok   %s\n", t.name.c_str());
+        } catch (const std::exception& e) {
+            ++failed;
+            std::printf("FAIL %s\n     %s\n", t.name.c_str(), e.what());
+        }
+    }
+    if (run == 0) {
+        std::fprintf(stderr, "no tests match\n");
+        return 1;
+    }
+    std::printf("%zu of %zu tests passed\n", run - failed, run);
+    return failed == 0 ? 0 : 1;
+}